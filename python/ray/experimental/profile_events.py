@@ -0,0 +1,160 @@
+"""Convert binary profiling events to the Chrome trace format.
+
+Components such as the local scheduler can record profiling events in the
+binary format described in src/common/profile_events.h, either to a local file
+or to Redis lists named "PROFILE:<component ID>". This module reads them and
+writes a trace that can be viewed by going to chrome://tracing in the Chrome
+web browser and loading the file.
+
+Usage:
+    python -m ray.experimental.profile_events -o trace.json events.bin
+    python -m ray.experimental.profile_events -o trace.json \
+        --redis-address 127.0.0.1:6379
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import json
+import struct
+
+from ray.utils import binary_to_hex
+
+PROFILE_EVENT_MAGIC = b"RAYPROF\0"
+PROFILE_EVENT_VERSION = 1
+# The header of a batch: magic, version, record size, source ID and padding.
+HEADER_FORMAT = struct.Struct("<8sII20s4x")
+# A record: start time, duration, event type and task or object ID.
+RECORD_FORMAT = struct.Struct("<qqI20s")
+
+# These must be kept up-to-date with ProfileEventType in profile_events.h.
+EVENT_TYPE_NAMES = {
+    1: "submit_task",
+    2: "assign_task",
+    3: "execute_task",
+    4: "reconstruct_object",
+}
+
+# The prefix of the Redis lists that hold profiling events.
+PROFILE_EVENT_PREFIX = b"PROFILE:"
+
+
+def parse_profile_events(data):
+    """Parse profiling events in the binary format.
+
+    Args:
+        data: The contents of an event file, or one batch from Redis. Either
+            starts with a header that is followed by the records.
+
+    Returns:
+        A list of dictionaries with the keys "source_id", "start_time_us",
+            "duration_us", "type" and "id". IDs are hex strings.
+    """
+    if len(data) == 0:
+        # Nothing was recorded.
+        return []
+    (magic, version, record_size,
+     source_id) = HEADER_FORMAT.unpack_from(data, 0)
+    if magic != PROFILE_EVENT_MAGIC:
+        raise Exception("Profiling events are not in the expected format.")
+    if version != PROFILE_EVENT_VERSION:
+        raise Exception("Unsupported profiling event format version {}."
+                        .format(version))
+    if record_size < RECORD_FORMAT.size:
+        raise Exception("Invalid profiling event size {}.".format(record_size))
+    events = []
+    # Ignore a partially written record at the end of a file.
+    num_records = (len(data) - HEADER_FORMAT.size) // record_size
+    for i in range(num_records):
+        (start_time_us, duration_us, event_type,
+         object_id) = RECORD_FORMAT.unpack_from(
+             data, HEADER_FORMAT.size + i * record_size)
+        events.append({
+            "source_id": binary_to_hex(source_id),
+            "start_time_us": start_time_us,
+            "duration_us": duration_us,
+            "type": EVENT_TYPE_NAMES.get(event_type, str(event_type)),
+            "id": binary_to_hex(object_id),
+        })
+    return events
+
+
+def read_profile_events_from_redis(redis_client):
+    """Read all of the profiling events that were written to Redis.
+
+    Args:
+        redis_client: A client for the primary Redis shard.
+
+    Returns:
+        A list of events, as returned by parse_profile_events.
+    """
+    events = []
+    for key in redis_client.keys(PROFILE_EVENT_PREFIX + b"*"):
+        for batch in redis_client.lrange(key, 0, -1):
+            events += parse_profile_events(batch)
+    return events
+
+
+def chrome_trace(events):
+    """Convert profiling events to Chrome trace events.
+
+    Args:
+        events: A list of events, as returned by parse_profile_events.
+
+    Returns:
+        A list of Chrome trace events, with one row per event type for each
+            component that recorded events.
+    """
+    trace = []
+    for event in events:
+        trace_event = {
+            "cat": event["type"],
+            "name": event["type"],
+            "pid": event["source_id"],
+            "tid": event["type"],
+            "ts": event["start_time_us"],
+            "args": {
+                "id": event["id"]
+            },
+        }
+        if event["duration_us"] > 0:
+            trace_event["ph"] = "X"
+            trace_event["dur"] = event["duration_us"]
+        else:
+            trace_event["ph"] = "i"
+            trace_event["s"] = "t"
+        trace.append(trace_event)
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert binary Ray profiling events to a Chrome trace.")
+    parser.add_argument(
+        "files", nargs="*", help="Files of profiling events to convert.")
+    parser.add_argument(
+        "--redis-address",
+        help="The address of the primary Redis shard to read events from.")
+    parser.add_argument(
+        "-o", "--output", required=True, help="The trace file to write.")
+    args = parser.parse_args()
+
+    events = []
+    for path in args.files:
+        with open(path, "rb") as f:
+            events += parse_profile_events(f.read())
+    if args.redis_address is not None:
+        import redis
+        host, port = args.redis_address.split(":")
+        events += read_profile_events_from_redis(
+            redis.StrictRedis(host=host, port=int(port)))
+    events.sort(key=lambda event: event["start_time_us"])
+    with open(args.output, "w") as f:
+        json.dump(chrome_trace(events), f)
+    print("Wrote {} events to {}.".format(len(events), args.output))
+
+
+if __name__ == "__main__":
+    main()
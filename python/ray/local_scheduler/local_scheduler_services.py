@@ -25,7 +25,9 @@ def start_local_scheduler(plasma_store_name,
                           stdout_file=None,
                           stderr_file=None,
                           static_resources=None,
-                          num_workers=0):
+                          num_workers=0,
+                          profile_events_path=None,
+                          profile_events_to_redis=False):
     """Start a local scheduler process.
 
     Args:
@@ -57,6 +59,11 @@ def start_local_scheduler(plasma_store_name,
             integers or floats.
         num_workers (int): The number of workers that the local scheduler
             should start.
+        profile_events_path (str): A file to write the local scheduler's
+            profiling events to. See ray.experimental.profile_events.
+        profile_events_to_redis (bool): True if the local scheduler should
+            write its profiling events to Redis. This is ignored if
+            profile_events_path is provided.
 
     Return:
         A tuple of the name of the local scheduler socket and the process ID of
@@ -98,6 +105,10 @@ def start_local_scheduler(plasma_store_name,
         command += ["-r", redis_address]
     if plasma_address is not None:
         command += ["-a", plasma_address]
+    if profile_events_path is not None:
+        command += ["-P", profile_events_path]
+    elif profile_events_to_redis:
+        command += ["-R"]
     if static_resources is not None:
         resource_argument = ""
         for resource_name, resource_quantity in static_resources.items():
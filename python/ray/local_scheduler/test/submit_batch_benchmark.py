@@ -0,0 +1,69 @@
+"""Measure how batching affects the rate of task submission.
+
+Usage: python submit_batch_benchmark.py [num_tasks]
+
+This starts a plasma store and a local scheduler with no workers, and submits
+tasks that take no arguments, first one at a time with submit and then with
+submit_batch for several batch sizes. The tasks are never run, so the rate
+covers building the messages, writing them to the socket, and queueing the
+tasks in the local scheduler.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+import sys
+import time
+
+import ray.local_scheduler as local_scheduler
+import ray.plasma as plasma
+
+ID_SIZE = 20
+
+NIL_WORKER_ID = 20 * b"\xff"
+
+
+def random_id():
+    return local_scheduler.ObjectID(np.random.bytes(ID_SIZE))
+
+
+def make_tasks(function_id, num_tasks):
+    return [
+        local_scheduler.Task(random_id(), function_id, [], 1, random_id(), 0)
+        for _ in range(num_tasks)
+    ]
+
+
+def main(num_tasks):
+    plasma_store_name, p1 = plasma.start_plasma_store()
+    scheduler_name, p2 = local_scheduler.start_local_scheduler(
+        plasma_store_name)
+    try:
+        client = local_scheduler.LocalSchedulerClient(scheduler_name,
+                                                      NIL_WORKER_ID, False)
+        function_id = random_id()
+
+        tasks = make_tasks(function_id, num_tasks)
+        start = time.time()
+        for task in tasks:
+            client.submit(task)
+        elapsed = time.time() - start
+        print("submit: {:.0f} tasks per second".format(num_tasks / elapsed))
+
+        for batch_size in [1, 10, 100, 1000]:
+            tasks = make_tasks(function_id, num_tasks)
+            start = time.time()
+            for i in range(0, num_tasks, batch_size):
+                client.submit_batch(tasks[i:i + batch_size])
+            elapsed = time.time() - start
+            print("submit_batch with batch size {}: {:.0f} tasks per second"
+                  .format(batch_size, num_tasks / elapsed))
+    finally:
+        p2.kill()
+        p1.kill()
+
+
+if __name__ == "__main__":
+    main(int(sys.argv[1]) if len(sys.argv) > 1 else 10000)
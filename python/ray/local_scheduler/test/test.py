@@ -118,6 +118,31 @@ class TestLocalSchedulerClient(unittest.TestCase):
             for num_return_vals in [0, 1, 2, 3, 5, 10, 100]:
                 new_task = self.local_scheduler_client.get_task()
 
+    def test_submit_batch(self):
+        function_id = random_function_id()
+        args_list = [[], [1], 10 * ["a"], [random_object_id()]]
+        # The argument that is an object ID must be available before the task
+        # can be scheduled.
+        object_id = args_list[3][0]
+        self.plasma_client.create(pa.plasma.ObjectID(object_id.id()), 0)
+        self.plasma_client.seal(pa.plasma.ObjectID(object_id.id()))
+        tasks = [
+            local_scheduler.Task(random_driver_id(), function_id, args, 1,
+                                 random_task_id(), 0) for args in args_list
+        ]
+        self.local_scheduler_client.submit_batch(tasks)
+        # The tasks are scheduled in the order in which they were batched.
+        for task in tasks:
+            new_task = self.local_scheduler_client.get_task()
+            self.assertEqual(task.task_id().id(), new_task.task_id().id())
+            self.assertEqual(task.returns()[0].id(),
+                             new_task.returns()[0].id())
+        # An empty batch is a no-op.
+        self.local_scheduler_client.submit_batch([])
+        # A batch must only contain tasks.
+        with self.assertRaises(TypeError):
+            self.local_scheduler_client.submit_batch(tasks + [1])
+
     def test_scheduling_when_objects_ready(self):
         # Create a task and submit it.
         object_id = random_object_id()
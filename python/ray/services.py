@@ -898,6 +898,7 @@ def start_raylet(redis_address,
                  node_ip_address,
                  plasma_store_name,
                  worker_path,
+                 object_store_memory,
                  resources=None,
                  num_workers=0,
                  stdout_file=None,
@@ -913,6 +914,9 @@ def start_raylet(redis_address,
             to.
         worker_path (str): The path of the script to use when the local
             scheduler starts up new workers.
+        object_store_memory (int): The amount of memory (in bytes) that the
+            object store was started with. The raylet uses this to avoid
+            running more tasks at once than their outputs fit in the store.
         stdout_file: A file handle opened for writing to redirect stdout to. If
             no redirection should happen, then this should be None.
         stderr_file: A file handle opened for writing to redirect stderr to. If
@@ -955,6 +959,7 @@ def start_raylet(redis_address,
         str(num_workers),
         start_worker_command,
         resource_argument,
+        str(object_store_memory),
     ]
     pid = subprocess.Popen(command, stdout=stdout_file, stderr=stderr_file)
 
@@ -966,6 +971,43 @@ def start_raylet(redis_address,
     return raylet_name
 
 
+def default_object_store_memory():
+    """Compute how much memory to start an object store with by default.
+
+    Returns:
+        The amount of memory in bytes.
+    """
+    # Compute a fraction of the system memory for the Plasma store to use.
+    system_memory = psutil.virtual_memory().total
+    if sys.platform == "linux" or sys.platform == "linux2":
+        # On linux we use /dev/shm, its size is half the size of the
+        # physical memory. To not overflow it, we set the plasma memory
+        # limit to 0.4 times the size of the physical memory.
+        objstore_memory = int(system_memory * 0.4)
+        # Compare the requested memory size to the memory available in
+        # /dev/shm.
+        shm_fd = os.open("/dev/shm", os.O_RDONLY)
+        try:
+            shm_fs_stats = os.fstatvfs(shm_fd)
+            # The value shm_fs_stats.f_bsize is the block size and the
+            # value shm_fs_stats.f_bavail is the number of available
+            # blocks.
+            shm_avail = shm_fs_stats.f_bsize * shm_fs_stats.f_bavail
+            if objstore_memory > shm_avail:
+                print("Warning: Reducing object store memory because "
+                      "/dev/shm has only {} bytes available. You may be "
+                      "able to free up space by deleting files in "
+                      "/dev/shm. If you are inside a Docker container, "
+                      "you may need to pass an argument with the flag "
+                      "'--shm-size' to 'docker run'.".format(shm_avail))
+                objstore_memory = int(shm_avail * 0.8)
+        finally:
+            os.close(shm_fd)
+    else:
+        objstore_memory = int(system_memory * 0.8)
+    return objstore_memory
+
+
 def start_objstore(node_ip_address,
                    redis_address,
                    object_manager_port=None,
@@ -1013,34 +1055,7 @@ def start_objstore(node_ip_address,
             name, and the plasma manager port.
     """
     if objstore_memory is None:
-        # Compute a fraction of the system memory for the Plasma store to use.
-        system_memory = psutil.virtual_memory().total
-        if sys.platform == "linux" or sys.platform == "linux2":
-            # On linux we use /dev/shm, its size is half the size of the
-            # physical memory. To not overflow it, we set the plasma memory
-            # limit to 0.4 times the size of the physical memory.
-            objstore_memory = int(system_memory * 0.4)
-            # Compare the requested memory size to the memory available in
-            # /dev/shm.
-            shm_fd = os.open("/dev/shm", os.O_RDONLY)
-            try:
-                shm_fs_stats = os.fstatvfs(shm_fd)
-                # The value shm_fs_stats.f_bsize is the block size and the
-                # value shm_fs_stats.f_bavail is the number of available
-                # blocks.
-                shm_avail = shm_fs_stats.f_bsize * shm_fs_stats.f_bavail
-                if objstore_memory > shm_avail:
-                    print("Warning: Reducing object store memory because "
-                          "/dev/shm has only {} bytes available. You may be "
-                          "able to free up space by deleting files in "
-                          "/dev/shm. If you are inside a Docker container, "
-                          "you may need to pass an argument with the flag "
-                          "'--shm-size' to 'docker run'.".format(shm_avail))
-                    objstore_memory = int(shm_avail * 0.8)
-            finally:
-                os.close(shm_fd)
-        else:
-            objstore_memory = int(system_memory * 0.8)
+        objstore_memory = default_object_store_memory()
     # Start the Plasma store.
     plasma_store_name, p1 = ray.plasma.start_plasma_store(
         plasma_store_memory=objstore_memory,
@@ -1385,6 +1400,10 @@ def start_ray_processes(address_info=None,
         object_manager_ports = num_local_schedulers * [object_manager_ports]
     assert len(object_manager_ports) == num_local_schedulers
 
+    # The raylets need to know how much memory their object stores have.
+    if object_store_memory is None:
+        object_store_memory = default_object_store_memory()
+
     # Start any object stores that do not yet exist.
     for i in range(num_local_schedulers - len(object_store_addresses)):
         # Start Plasma.
@@ -1462,6 +1481,7 @@ def start_ray_processes(address_info=None,
                     node_ip_address,
                     object_store_addresses[i].name,
                     worker_path,
+                    object_store_memory,
                     resources=resources[i],
                     num_workers=workers_per_local_scheduler[i],
                     stdout_file=raylet_stdout_file,
@@ -222,6 +222,9 @@ class Worker(object):
         self.make_actor = None
         self.actors = {}
         self.actor_task_counter = 0
+        # True if this worker should ask the local scheduler for its next task
+        # once the task that it is executing returns.
+        self.prefetch_next_task = False
         # A set of all of the actor class keys that have been imported by the
         # import thread. It is safe to convert this worker into an actor of
         # these types.
@@ -869,6 +872,9 @@ class Worker(object):
                                               e, traceback_str)
             return
 
+        # The task has returned, so it cannot wait for any other task anymore.
+        self._prefetch_next_task()
+
         # Store the outputs in the local object store.
         try:
             with log_span("ray:task:store_outputs", worker=self):
@@ -884,8 +890,20 @@ class Worker(object):
                 function_id, return_object_ids, e,
                 ray.utils.format_error_message(traceback.format_exc()))
 
+    def _prefetch_next_task(self):
+        """Ask the local scheduler to send this worker its next task early.
+
+        This must only be called once the current task can no longer block in
+        ray.get or ray.wait. Otherwise, the local scheduler may send us a task
+        that the current task is waiting for, and neither could ever finish.
+        """
+        if self.prefetch_next_task:
+            self.prefetch_next_task = False
+            self.local_scheduler_client.prefetch_task()
+
     def _handle_process_task_failure(self, function_id, return_object_ids,
                                      error, backtrace):
+        self._prefetch_next_task()
         function_name = self.function_execution_info[self.task_driver_id.id()][
             function_id.id()].function_name
         failure_object = RayTaskError(function_name, error, backtrace)
@@ -949,6 +967,19 @@ class Worker(object):
         with log_span("ray:wait_for_function", worker=self):
             self._wait_for_function(function_id, driver_id)
 
+        # Ask the local scheduler for our next task once this task is about
+        # to return, so that the next task is waiting for us once this one
+        # finishes. Actors are already sent their tasks ahead of time, and a
+        # worker that will exit after this task must not be sent another one.
+        max_calls = (self.function_execution_info[driver_id][
+            function_id.id()].max_calls)
+        num_executions = self.num_task_executions[driver_id][function_id.id()]
+        will_exit = max_calls != 0 and num_executions + 1 == max_calls
+        self.prefetch_next_task = (
+            self.use_raylet and ray._config.worker_prefetch_tasks()
+            and task.actor_id() == ray.ObjectID(NIL_ACTOR_ID)
+            and not will_exit)
+
         # Execute the task.
         # TODO(rkn): Consider acquiring this lock with a timeout and pushing a
         # warning to the user if we are waiting too long to acquire the lock
@@ -2106,7 +2137,7 @@ def connect(info,
         local_scheduler_socket = info["raylet_socket_name"]
 
     worker.local_scheduler_client = ray.local_scheduler.LocalSchedulerClient(
-        local_scheduler_socket, worker.worker_id, is_worker)
+        local_scheduler_socket, worker.worker_id, is_worker, worker.use_raylet)
 
     # If this is a driver, set the current task ID, the task driver ID, and set
     # the task index to 0.
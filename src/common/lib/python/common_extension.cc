@@ -121,6 +121,7 @@ PyObject *PyTask_from_string(PyObject *self, PyObject *args) {
   result = (PyTask *) PyObject_Init((PyObject *) result, &PyTaskType);
   result->size = size;
   result->spec = TaskSpec_copy((TaskSpec *) data, size);
+  result->buffer = nullptr;
   /* The created task does not include any execution dependencies. */
   result->execution_dependencies = new std::vector<ObjectID>();
   /* TODO(pcm): Use flatbuffers validation here. */
@@ -385,6 +386,7 @@ static int PyTask_init(PyTask *self, PyObject *args, PyObject *kwds) {
   }
   self->spec = nullptr;
   self->task_spec = nullptr;
+  self->buffer = nullptr;
 
   // Create the task spec.
   if (!use_raylet) {
@@ -471,7 +473,9 @@ static int PyTask_init(PyTask *self, PyObject *args, PyObject *kwds) {
 }
 
 static void PyTask_dealloc(PyTask *self) {
-  if (!use_raylet(self)) {
+  if (self->buffer != nullptr) {
+    free(self->buffer);
+  } else if (!use_raylet(self)) {
     TaskSpec_free(self->spec);
   } else {
     delete self->task_spec;
@@ -767,11 +771,14 @@ PyTypeObject PyTaskType = {
 };
 
 /* Create a PyTask from a C struct. The resulting PyTask takes ownership of the
- * TaskSpec and will deallocate the TaskSpec in the PyTask destructor. */
-PyObject *PyTask_make(TaskSpec *task_spec, int64_t task_size) {
+ * TaskSpec and will deallocate the TaskSpec in the PyTask destructor. If buffer
+ * is not NULL, the TaskSpec points into it, and the PyTask takes ownership of
+ * the buffer instead. */
+PyObject *PyTask_make(TaskSpec *task_spec, int64_t task_size, uint8_t *buffer) {
   PyTask *result = PyObject_New(PyTask, &PyTaskType);
   result = (PyTask *) PyObject_Init((PyObject *) result, &PyTaskType);
   result->spec = task_spec;
+  result->buffer = buffer;
   result->size = task_size;
   /* The created task does not include any execution dependencies. */
   result->execution_dependencies = new std::vector<ObjectID>();
@@ -26,6 +26,9 @@ typedef struct {
   int64_t size;
   // The task spec to use in the non-raylet case.
   TaskSpec *spec;
+  // If not null, the buffer that spec points into, which is freed instead of
+  // spec.
+  uint8_t *buffer;
   // The task spec to use in the raylet case.
   ray::raylet::TaskSpecification *task_spec;
   std::vector<ray::ObjectID> *execution_dependencies;
@@ -60,6 +63,8 @@ PyObject *check_simple_value(PyObject *self, PyObject *args);
 PyObject *PyTask_to_string(PyObject *, PyObject *args);
 PyObject *PyTask_from_string(PyObject *, PyObject *args);
 
-PyObject *PyTask_make(TaskSpec *task_spec, int64_t task_size);
+PyObject *PyTask_make(TaskSpec *task_spec,
+                      int64_t task_size,
+                      uint8_t *buffer = nullptr);
 
 #endif /* COMMON_EXTENSION_H */
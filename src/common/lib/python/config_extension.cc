@@ -119,6 +119,10 @@ PyObject *PyRayConfig_L3_cache_size_bytes(PyObject *self) {
   return PyLong_FromLongLong(RayConfig::instance().L3_cache_size_bytes());
 }
 
+PyObject *PyRayConfig_worker_prefetch_tasks(PyObject *self) {
+  return PyBool_FromLong(RayConfig::instance().worker_prefetch_tasks());
+}
+
 static PyMethodDef PyRayConfig_methods[] = {
     {"ray_protocol_version", (PyCFunction) PyRayConfig_ray_protocol_version,
      METH_NOARGS, "Return ray_protocol_version"},
@@ -184,6 +188,8 @@ static PyMethodDef PyRayConfig_methods[] = {
      "Return plasma_default_release_delay"},
     {"L3_cache_size_bytes", (PyCFunction) PyRayConfig_L3_cache_size_bytes,
      METH_NOARGS, "Return L3_cache_size_bytes"},
+    {"worker_prefetch_tasks", (PyCFunction) PyRayConfig_worker_prefetch_tasks,
+     METH_NOARGS, "Return worker_prefetch_tasks"},
     {NULL} /* Sentinel */
 };
 
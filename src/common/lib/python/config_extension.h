@@ -42,5 +42,6 @@ PyObject *PyRayConfig_redis_db_connect_retries(PyObject *self);
 PyObject *PyRayConfig_redis_db_connect_wait_milliseconds(PyObject *self);
 PyObject *PyRayConfig_plasma_default_release_delay(PyObject *self);
 PyObject *PyRayConfig_L3_cache_size_bytes(PyObject *self);
+PyObject *PyRayConfig_worker_prefetch_tasks(PyObject *self);
 
 #endif /* CONFIG_EXTENSION_H */
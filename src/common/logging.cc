@@ -10,6 +10,7 @@
 #include "io.h"
 #include <iostream>
 #include <string>
+#include <vector>
 
 static const char *log_levels[5] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
 static const char *log_fmt =
@@ -97,11 +98,29 @@ void RayLogger_log_event(DBHandle *db,
                          uint8_t *value,
                          int64_t value_length,
                          double timestamp) {
-  std::string timestamp_string = std::to_string(timestamp);
-  int status = redisAsyncCommand(db->context, NULL, NULL, "ZADD %b %s %b", key,
-                                 key_length, timestamp_string.c_str(), value,
-                                 value_length);
-  if ((status == REDIS_ERR) || db->context->err) {
-    LOG_REDIS_DEBUG(db->context, "error while logging message to event log");
+  db->pending_events[std::string((char *) key, key_length)].emplace_back(
+      std::to_string(timestamp), std::string((char *) value, value_length));
+}
+
+void RayLogger_flush_events(DBHandle *db) {
+  std::vector<const char *> argv;
+  std::vector<size_t> argvlen;
+  for (const auto &key_events : db->pending_events) {
+    /* Add all of the key's events with a single ZADD key score member
+     * [score member ...]. */
+    argv.assign({"ZADD", key_events.first.data()});
+    argvlen.assign({4, key_events.first.size()});
+    for (const auto &event : key_events.second) {
+      argv.push_back(event.first.data());
+      argvlen.push_back(event.first.size());
+      argv.push_back(event.second.data());
+      argvlen.push_back(event.second.size());
+    }
+    int status = redisAsyncCommandArgv(db->context, NULL, NULL, argv.size(),
+                                       argv.data(), argvlen.data());
+    if ((status == REDIS_ERR) || db->context->err) {
+      LOG_REDIS_DEBUG(db->context, "error while logging message to event log");
+    }
   }
+  db->pending_events.clear();
 }
@@ -39,7 +39,8 @@ void RayLogger_log(RayLogger *logger,
                    const char *message);
 
 /**
- * Log an event to the event log.
+ * Log an event to the event log. The event is buffered in the database handle
+ * and only written to Redis by the next call to RayLogger_flush_events.
  *
  * @param db The database handle.
  * @param key The key in Redis to store the event in.
@@ -55,4 +56,14 @@ void RayLogger_log_event(DBHandle *db,
                          int64_t value_length,
                          double time);
 
+/**
+ * Write the buffered events to the event log, with one ZADD for each key.
+ * Events that are still buffered when the database handle is freed are
+ * dropped.
+ *
+ * @param db The database handle.
+ * @return Void.
+ */
+void RayLogger_flush_events(DBHandle *db);
+
 #endif /* LOGGING_H */
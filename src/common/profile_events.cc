@@ -0,0 +1,261 @@
+#include "profile_events.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "ray/util/logging.h"
+#include "state/ray_config.h"
+
+ProfileEventRing::ProfileEventRing(size_t capacity)
+    : mask_([capacity]() {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+          rounded *= 2;
+        }
+        return rounded - 1;
+      }()),
+      slots_(new Slot[mask_ + 1]),
+      record_position_(0),
+      drain_position_(0),
+      num_dropped_(0) {
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool ProfileEventRing::Record(const ProfileEvent &event) {
+  size_t position = record_position_.load(std::memory_order_relaxed);
+  Slot *slot;
+  while (true) {
+    slot = &slots_[position & mask_];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      /* The slot is free. Claim it, unless another thread got there first. */
+      if (record_position_.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position) {
+      /* The slot still holds an event from the previous lap, so the ring is
+       * full. */
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      /* Another thread claimed this position. */
+      position = record_position_.load(std::memory_order_relaxed);
+    }
+  }
+  slot->event = event;
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+size_t ProfileEventRing::Drain(std::vector<ProfileEvent> *events) {
+  size_t num_drained = 0;
+  while (true) {
+    Slot &slot = slots_[drain_position_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != drain_position_ + 1) {
+      /* The next event has not been written yet. */
+      break;
+    }
+    events->push_back(slot.event);
+    /* Free the slot for the next lap. */
+    slot.sequence.store(drain_position_ + mask_ + 1, std::memory_order_release);
+    drain_position_++;
+    num_drained++;
+  }
+  return num_drained;
+}
+
+int64_t ProfileEventRing::NumDropped() const {
+  return num_dropped_.load(std::memory_order_relaxed);
+}
+
+namespace {
+
+template <typename T>
+void append_little_endian(std::string *buffer, T value) {
+  for (size_t i = 0; i < sizeof(T); i++) {
+    buffer->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+}  // namespace
+
+std::string profile_events_serialize(const ray::UniqueID &source_id,
+                                     const std::vector<ProfileEvent> &events,
+                                     bool with_header) {
+  std::string buffer;
+  buffer.reserve((with_header ? 40 : 0) + events.size() * sizeof(ProfileEvent));
+  if (with_header) {
+    buffer.append(kProfileEventMagic, sizeof(kProfileEventMagic));
+    append_little_endian<uint32_t>(&buffer, kProfileEventVersion);
+    append_little_endian<uint32_t>(&buffer, sizeof(ProfileEvent));
+    buffer.append(reinterpret_cast<const char *>(source_id.data()),
+                  kUniqueIDSize);
+    append_little_endian<uint32_t>(&buffer, 0);
+  }
+  for (const auto &event : events) {
+    append_little_endian<uint64_t>(&buffer, event.start_time_us);
+    append_little_endian<uint64_t>(&buffer, event.duration_us);
+    append_little_endian<uint32_t>(&buffer, event.type);
+    buffer.append(reinterpret_cast<const char *>(event.id), kUniqueIDSize);
+  }
+  return buffer;
+}
+
+ProfileEventFileSink::ProfileEventFileSink(const std::string &path)
+    : file_(fopen(path.c_str(), "wb")), wrote_header_(false) {
+  RAY_CHECK(file_ != NULL) << "Could not open " << path
+                           << " for profiling events";
+}
+
+ProfileEventFileSink::~ProfileEventFileSink() {
+  fclose(file_);
+}
+
+void ProfileEventFileSink::Write(const ray::UniqueID &source_id,
+                                 const std::vector<ProfileEvent> &events) {
+  std::string batch =
+      profile_events_serialize(source_id, events, !wrote_header_);
+  wrote_header_ = true;
+  if (fwrite(batch.data(), 1, batch.size(), file_) != batch.size() ||
+      fflush(file_) != 0) {
+    RAY_LOG(WARNING) << "Failed to write " << events.size()
+                     << " profiling events: " << strerror(errno);
+  }
+}
+
+ProfileEventRedisSink::ProfileEventRedisSink(const std::string &address,
+                                             int port)
+    : context_(redisConnect(address.c_str(), port)) {
+  RAY_CHECK(context_ != NULL && !context_->err)
+      << "Could not connect to Redis at " << address << ":" << port
+      << " for profiling events";
+}
+
+ProfileEventRedisSink::~ProfileEventRedisSink() {
+  redisFree(context_);
+}
+
+void ProfileEventRedisSink::Write(const ray::UniqueID &source_id,
+                                  const std::vector<ProfileEvent> &events) {
+  std::string key = "PROFILE:" + source_id.binary();
+  std::string batch = profile_events_serialize(source_id, events, true);
+  redisReply *reply = reinterpret_cast<redisReply *>(
+      redisCommand(context_, "RPUSH %b %b", key.data(), key.size(),
+                   batch.data(), batch.size()));
+  if (reply == NULL || reply->type == REDIS_REPLY_ERROR) {
+    RAY_LOG(WARNING) << "Failed to write " << events.size()
+                     << " profiling events to Redis";
+  }
+  if (reply != NULL) {
+    freeReplyObject(reply);
+  }
+}
+
+namespace {
+
+/** Records the profiling events of this process and writes them out from a
+ *  background thread. */
+class ProfileEventRecorder {
+ public:
+  ProfileEventRecorder(const ray::UniqueID &source_id,
+                       std::unique_ptr<ProfileEventSink> sink)
+      : ring(RayConfig::instance().profile_event_buffer_size()),
+        source_id_(source_id),
+        sink_(std::move(sink)),
+        stopped_(false),
+        thread_([this]() { Run(); }) {}
+
+  ~ProfileEventRecorder() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+  }
+
+  ProfileEventRing ring;
+
+ private:
+  void Run() {
+    const std::chrono::milliseconds flush_period(
+        RayConfig::instance().profile_event_flush_period_milliseconds());
+    std::vector<ProfileEvent> events;
+    int64_t num_dropped = 0;
+    bool stopped = false;
+    while (!stopped) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait_for(lock, flush_period, [this]() { return stopped_; });
+        stopped = stopped_;
+      }
+      ring.Drain(&events);
+      if (!events.empty()) {
+        sink_->Write(source_id_, events);
+        events.clear();
+      }
+      if (ring.NumDropped() > num_dropped) {
+        RAY_LOG(WARNING) << ring.NumDropped() - num_dropped
+                         << " profiling events were dropped because they "
+                         << "were recorded faster than they were written";
+        num_dropped = ring.NumDropped();
+      }
+    }
+  }
+
+  const ray::UniqueID source_id_;
+  std::unique_ptr<ProfileEventSink> sink_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopped_;
+  std::thread thread_;
+};
+
+/** The recorder of this process, if recording was started. */
+std::atomic<ProfileEventRecorder *> g_profile_event_recorder(nullptr);
+
+}  // namespace
+
+void profile_events_start(const ray::UniqueID &source_id,
+                          std::unique_ptr<ProfileEventSink> sink) {
+  RAY_CHECK(g_profile_event_recorder.load() == nullptr);
+  g_profile_event_recorder.store(
+      new ProfileEventRecorder(source_id, std::move(sink)));
+}
+
+void profile_events_stop() {
+  /* Callers must not record events concurrently with stopping. */
+  delete g_profile_event_recorder.exchange(nullptr);
+}
+
+void profile_event_record(ProfileEventType type,
+                          const ray::UniqueID &id,
+                          int64_t start_time_us,
+                          int64_t duration_us) {
+  ProfileEventRecorder *recorder =
+      g_profile_event_recorder.load(std::memory_order_acquire);
+  if (recorder == nullptr) {
+    return;
+  }
+  ProfileEvent event;
+  event.start_time_us = start_time_us;
+  event.duration_us = duration_us;
+  event.type = type;
+  memcpy(event.id, id.data(), kUniqueIDSize);
+  recorder->ring.Record(event);
+}
+
+int64_t profile_event_time_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
@@ -0,0 +1,224 @@
+#ifndef PROFILE_EVENTS_H
+#define PROFILE_EVENTS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ray/id.h"
+
+#include "hiredis/hiredis.h"
+
+/**
+ * Profiling events are recorded as fixed-size binary records into a ring
+ * buffer, and a background thread writes them out in large batches, either to
+ * a local file or to Redis.
+ *
+ * Both destinations use the same format. All integers are little-endian.
+ *
+ * A batch starts with a 40 byte header:
+ *   - 8 bytes: the magic string "RAYPROF\0".
+ *   - 4 bytes: the format version, currently 1.
+ *   - 4 bytes: the size of each record that follows, currently 40.
+ *   - 20 bytes: the ID of the process that recorded the events, for example
+ *     the local scheduler's DB client ID.
+ *   - 4 bytes: padding.
+ * It is followed by records of this size, which are the fields of
+ * ProfileEvent in order:
+ *   - 8 bytes: the start time of the event, in microseconds since the Unix
+ *     epoch.
+ *   - 8 bytes: the duration of the event in microseconds, or 0 for an
+ *     instantaneous event.
+ *   - 4 bytes: the event type, one of ProfileEventType.
+ *   - 20 bytes: the ID of the task or object that the event is about.
+ *
+ * A file holds one header followed by every record written to it. In Redis,
+ * each batch is one element of the list "PROFILE:<process ID>", and has its
+ * own header. python/ray/experimental/profile_events.py converts either to
+ * the Chrome trace format.
+ */
+
+/** The types of profiling events. Their values are part of the format. */
+enum ProfileEventType : uint32_t {
+  /** A task was submitted to the local scheduler. */
+  PROFILE_EVENT_SUBMIT_TASK = 1,
+  /** A task was assigned to a worker. */
+  PROFILE_EVENT_ASSIGN_TASK = 2,
+  /** A worker executed a task, from assignment until it asked for another. */
+  PROFILE_EVENT_EXECUTE_TASK = 3,
+  /** An object was reconstructed. */
+  PROFILE_EVENT_RECONSTRUCT_OBJECT = 4,
+};
+
+/** A single profiling event. */
+struct ProfileEvent {
+  int64_t start_time_us;
+  int64_t duration_us;
+  uint32_t type;
+  uint8_t id[kUniqueIDSize];
+};
+
+static_assert(sizeof(ProfileEvent) == 40,
+              "ProfileEvent is written to disk as is and must stay 40 bytes");
+
+/** The magic string at the start of each batch of profiling events. */
+constexpr char kProfileEventMagic[8] = {'R', 'A', 'Y', 'P', 'R', 'O', 'F', 0};
+/** The version of the format. */
+constexpr uint32_t kProfileEventVersion = 1;
+
+/**
+ * A fixed-capacity ring buffer of profiling events. Any number of threads can
+ * record events without taking a lock, but only one thread may drain them. If
+ * the ring is full, new events are dropped, so recording never blocks.
+ */
+class ProfileEventRing {
+ public:
+  /**
+   * @param capacity The number of events that the ring holds. This is rounded
+   *        up to a power of two.
+   */
+  explicit ProfileEventRing(size_t capacity);
+
+  /**
+   * Record an event.
+   *
+   * @return True if the event was recorded and false if the ring was full.
+   */
+  bool Record(const ProfileEvent &event);
+
+  /**
+   * Move the recorded events out of the ring, oldest first. This must only be
+   * called from one thread at a time.
+   *
+   * @param events The events are appended to this vector.
+   * @return The number of events that were appended.
+   */
+  size_t Drain(std::vector<ProfileEvent> *events);
+
+  /** The number of events that were dropped because the ring was full. */
+  int64_t NumDropped() const;
+
+ private:
+  struct Slot {
+    /** Equal to the slot's position when it is free to be written, and to the
+     *  position plus one when it holds an event to drain. */
+    std::atomic<size_t> sequence;
+    ProfileEvent event;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  /** The position that the next recorded event is written to. */
+  std::atomic<size_t> record_position_;
+  /** The position that the next drained event is read from. */
+  size_t drain_position_;
+  std::atomic<int64_t> num_dropped_;
+};
+
+/** A destination for batches of profiling events. */
+class ProfileEventSink {
+ public:
+  virtual ~ProfileEventSink() {}
+
+  /**
+   * Write out a batch of events.
+   *
+   * @param source_id The ID of the process that recorded the events.
+   * @param events The events to write.
+   * @return Void.
+   */
+  virtual void Write(const ray::UniqueID &source_id,
+                     const std::vector<ProfileEvent> &events) = 0;
+};
+
+/** Writes profiling events to a local file. */
+class ProfileEventFileSink : public ProfileEventSink {
+ public:
+  /** Create the file, replacing any file at the same path. */
+  explicit ProfileEventFileSink(const std::string &path);
+
+  ~ProfileEventFileSink();
+
+  void Write(const ray::UniqueID &source_id,
+             const std::vector<ProfileEvent> &events) override;
+
+ private:
+  FILE *file_;
+  /** Whether the header has been written yet. */
+  bool wrote_header_;
+};
+
+/** Appends batches of profiling events to a list in Redis. */
+class ProfileEventRedisSink : public ProfileEventSink {
+ public:
+  /** Connect to Redis. This connection is only used by the sink. */
+  ProfileEventRedisSink(const std::string &address, int port);
+
+  ~ProfileEventRedisSink();
+
+  void Write(const ray::UniqueID &source_id,
+             const std::vector<ProfileEvent> &events) override;
+
+ private:
+  redisContext *context_;
+};
+
+/**
+ * Serialize a batch of profiling events in the format described above.
+ *
+ * @param source_id The ID of the process that recorded the events.
+ * @param events The events to serialize.
+ * @param with_header Whether to start the batch with a header.
+ * @return The serialized batch.
+ */
+std::string profile_events_serialize(const ray::UniqueID &source_id,
+                                     const std::vector<ProfileEvent> &events,
+                                     bool with_header);
+
+/**
+ * Start recording profiling events in this process. A background thread
+ * writes the recorded events to the sink every
+ * RayConfig::profile_event_flush_period_milliseconds.
+ *
+ * @param source_id The ID of this process, which is written with the events.
+ * @param sink The destination of the events.
+ * @return Void.
+ */
+void profile_events_start(const ray::UniqueID &source_id,
+                          std::unique_ptr<ProfileEventSink> sink);
+
+/**
+ * Stop recording profiling events, after writing out the events that were
+ * already recorded.
+ *
+ * @return Void.
+ */
+void profile_events_stop();
+
+/**
+ * Record a profiling event. This does nothing if recording was not started.
+ *
+ * @param type The type of the event.
+ * @param id The ID of the task or object that the event is about.
+ * @param start_time_us The start time of the event, in microseconds since the
+ *        Unix epoch.
+ * @param duration_us The duration of the event in microseconds.
+ * @return Void.
+ */
+void profile_event_record(ProfileEventType type,
+                          const ray::UniqueID &id,
+                          int64_t start_time_us,
+                          int64_t duration_us);
+
+/**
+ * Return the current time for a profiling event.
+ *
+ * @return The number of microseconds since the Unix epoch.
+ */
+int64_t profile_event_time_us();
+
+#endif /* PROFILE_EVENTS_H */
@@ -428,6 +428,9 @@ int ObjectTableLookup_RedisCommand(RedisModuleCtx *ctx,
  * @param ctx The Redis context.
  * @param client_id The ID of the client that is being notified.
  * @param object_id The object ID of interest.
+ * @param data_size The size of the object.
+ * @param hash The hash of the object's contents. This may be NULL if the hash
+ *        is not known.
  * @param key The opened key for the entry in the object table corresponding to
  *        the object ID of interest.
  * @return True if the publish was successful and false otherwise.
@@ -436,6 +439,7 @@ bool PublishObjectNotification(RedisModuleCtx *ctx,
                                RedisModuleString *client_id,
                                RedisModuleString *object_id,
                                RedisModuleString *data_size,
+                               RedisModuleString *hash,
                                RedisModuleKey *key) {
   flatbuffers::FlatBufferBuilder fbb;
 
@@ -456,9 +460,16 @@ bool PublishObjectNotification(RedisModuleCtx *ctx,
     manager_ids.push_back(RedisStringToFlatbuf(fbb, curr));
   } while (RedisModule_ZsetRangeNext(key));
 
+  flatbuffers::Offset<flatbuffers::String> hash_str;
+  if (hash == NULL) {
+    hash_str = fbb.CreateString("", strlen(""));
+  } else {
+    hash_str = RedisStringToFlatbuf(fbb, hash);
+  }
+
   auto message = CreateSubscribeToNotificationsReply(
       fbb, RedisStringToFlatbuf(fbb, object_id), data_size_value,
-      fbb.CreateVector(manager_ids));
+      fbb.CreateVector(manager_ids), hash_str);
   fbb.Finish(message);
 
   /* Publish the notification to the clients notification channel.
@@ -1045,7 +1056,7 @@ int ObjectTableAdd_RedisCommand(RedisModuleCtx *ctx,
   RedisModuleString *bcast_client_str =
       RedisModule_CreateString(ctx, OBJECT_BCAST, strlen(OBJECT_BCAST));
   bool success = PublishObjectNotification(ctx, bcast_client_str, object_id,
-                                           data_size, table_key);
+                                           data_size, new_hash, table_key);
   if (!success) {
     /* The publish failed somehow. */
     return RedisModule_ReplyWithError(ctx, "PUBLISH BCAST unsuccessful");
@@ -1074,7 +1085,7 @@ int ObjectTableAdd_RedisCommand(RedisModuleCtx *ctx,
        * constructions in the multiple calls to PublishObjectNotification
        * together. */
       bool success = PublishObjectNotification(ctx, client_id, object_id,
-                                               data_size, table_key);
+                                               data_size, new_hash, table_key);
       if (!success) {
         /* The publish failed somehow. */
         return RedisModule_ReplyWithError(ctx, "PUBLISH unsuccessful");
@@ -1192,15 +1203,18 @@ int ObjectTableRequestNotifications_RedisCommand(RedisModuleCtx *ctx,
         return RedisModule_ReplyWithError(ctx, "requested object not found");
       }
       RedisModuleString *existing_data_size;
+      RedisModuleString *existing_hash;
       RedisModule_HashGet(object_info_key, REDISMODULE_HASH_CFIELDS,
-                          "data_size", &existing_data_size, NULL);
+                          "data_size", &existing_data_size, "hash",
+                          &existing_hash, NULL);
       if (existing_data_size == NULL) {
         return RedisModule_ReplyWithError(ctx,
                                           "no data_size field in object info");
       }
 
-      bool success = PublishObjectNotification(ctx, client_id, object_id,
-                                               existing_data_size, key);
+      bool success =
+          PublishObjectNotification(ctx, client_id, object_id,
+                                    existing_data_size, existing_hash, key);
       if (!success) {
         /* The publish failed somehow. */
         return RedisModule_ReplyWithError(ctx, "PUBLISH unsuccessful");
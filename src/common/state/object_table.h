@@ -21,11 +21,14 @@ typedef void (*object_table_lookup_done_callback)(
     const std::vector<DBClientID> &manager_ids,
     void *user_context);
 
-/* Callback called when object ObjectID is available. */
+/* Callback called when object ObjectID is available. The digest is the hash of
+ * the object's contents that was added to the object table with the object,
+ * or an empty string if it is not known. */
 typedef void (*object_table_object_available_callback)(
     ObjectID object_id,
     int64_t data_size,
     const std::vector<DBClientID> &manager_ids,
+    const std::string &digest,
     void *user_context);
 
 /**
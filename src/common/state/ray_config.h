@@ -44,6 +44,10 @@ class RayConfig {
 
   int64_t max_num_to_reconstruct() const { return max_num_to_reconstruct_; }
 
+  int64_t max_reconstructions_in_flight() const {
+    return max_reconstructions_in_flight_;
+  }
+
   int64_t local_scheduler_fetch_request_size() const {
     return local_scheduler_fetch_request_size_;
   }
@@ -58,6 +62,20 @@ class RayConfig {
 
   int64_t buf_size() const { return buf_size_; }
 
+  int64_t manager_chunk_size() const { return manager_chunk_size_; }
+
+  int64_t manager_connections_per_peer() const {
+    return manager_connections_per_peer_;
+  }
+
+  int64_t manager_receive_timeout_milliseconds() const {
+    return manager_receive_timeout_milliseconds_;
+  }
+
+  int64_t manager_dedup_max_object_size() const {
+    return manager_dedup_max_object_size_;
+  }
+
   int64_t max_time_for_handler_milliseconds() const {
     return max_time_for_handler_milliseconds_;
   }
@@ -104,6 +122,86 @@ class RayConfig {
     return object_manager_default_chunk_size_;
   }
 
+  uint64_t object_manager_max_inflight_pull_bytes() const {
+    return object_manager_max_inflight_pull_bytes_;
+  }
+
+  int object_manager_chunk_timeout_ms() const {
+    return object_manager_chunk_timeout_ms_;
+  }
+
+  int object_manager_max_pull_attempts() const {
+    return object_manager_max_pull_attempts_;
+  }
+
+  int object_manager_compression_codec() const {
+    return object_manager_compression_codec_;
+  }
+
+  int64_t object_manager_compression_min_chunk_bytes() const {
+    return object_manager_compression_min_chunk_bytes_;
+  }
+
+  bool object_manager_streaming() const { return object_manager_streaming_; }
+
+  int async_write_max_messages() const { return async_write_max_messages_; }
+
+  int64_t async_write_high_water_mark_bytes() const {
+    return async_write_high_water_mark_bytes_;
+  }
+
+  int64_t async_write_low_water_mark_bytes() const {
+    return async_write_low_water_mark_bytes_;
+  }
+
+  int64_t worker_submission_ring_bytes() const {
+    return worker_submission_ring_bytes_;
+  }
+
+  int64_t worker_submission_ring_timeout_milliseconds() const {
+    return worker_submission_ring_timeout_milliseconds_;
+  }
+
+  int64_t raylet_submission_ring_max_drain() const {
+    return raylet_submission_ring_max_drain_;
+  }
+
+  int64_t object_reconstruction_lease_milliseconds() const {
+    return object_reconstruction_lease_milliseconds_;
+  }
+
+  int64_t actor_max_pipelined_tasks() const {
+    return actor_max_pipelined_tasks_;
+  }
+
+  bool worker_prefetch_tasks() const { return worker_prefetch_tasks_; }
+
+  int64_t profile_event_buffer_size() const {
+    return profile_event_buffer_size_;
+  }
+
+  int64_t profile_event_flush_period_milliseconds() const {
+    return profile_event_flush_period_milliseconds_;
+  }
+
+  int raylet_client_io_threads() const { return raylet_client_io_threads_; }
+
+  int64_t raylet_client_message_batch_size() const {
+    return raylet_client_message_batch_size_;
+  }
+
+  int64_t prefetch_window_min_tasks() const {
+    return prefetch_window_min_tasks_;
+  }
+
+  int64_t prefetch_window_max_tasks() const {
+    return prefetch_window_max_tasks_;
+  }
+
+  int64_t object_store_default_output_bytes() const {
+    return object_store_default_output_bytes_;
+  }
+
  private:
   RayConfig()
       : ray_protocol_version_(0x0000000000000000),
@@ -118,10 +216,15 @@ class RayConfig {
         local_scheduler_fetch_timeout_milliseconds_(1000),
         local_scheduler_reconstruction_timeout_milliseconds_(1000),
         max_num_to_reconstruct_(10000),
+        max_reconstructions_in_flight_(1000),
         local_scheduler_fetch_request_size_(10000),
         kill_worker_timeout_milliseconds_(100),
         manager_timeout_milliseconds_(1000),
         buf_size_(80 * 1024),
+        manager_chunk_size_(1024 * 1024),
+        manager_connections_per_peer_(4),
+        manager_receive_timeout_milliseconds_(10000),
+        manager_dedup_max_object_size_(64 * 1024),
         max_time_for_handler_milliseconds_(1000),
         size_limit_(10000),
         num_elements_limit_(10000),
@@ -139,7 +242,29 @@ class RayConfig {
         object_manager_max_sends_(2),
         object_manager_max_receives_(2),
         object_manager_max_push_retries_(1000),
-        object_manager_default_chunk_size_(100000000) {}
+        object_manager_default_chunk_size_(100000000),
+        object_manager_max_inflight_pull_bytes_(2000000000),
+        object_manager_chunk_timeout_ms_(10000),
+        object_manager_max_pull_attempts_(5),
+        object_manager_compression_codec_(0),
+        object_manager_compression_min_chunk_bytes_(64 * 1024),
+        object_manager_streaming_(false),
+        async_write_max_messages_(128),
+        async_write_high_water_mark_bytes_(16 * 1024 * 1024),
+        async_write_low_water_mark_bytes_(4 * 1024 * 1024),
+        worker_submission_ring_bytes_(1024 * 1024),
+        worker_submission_ring_timeout_milliseconds_(10000),
+        raylet_submission_ring_max_drain_(256),
+        object_reconstruction_lease_milliseconds_(1000),
+        actor_max_pipelined_tasks_(16),
+        worker_prefetch_tasks_(true),
+        profile_event_buffer_size_(64 * 1024),
+        profile_event_flush_period_milliseconds_(1000),
+        raylet_client_io_threads_(2),
+        raylet_client_message_batch_size_(256),
+        prefetch_window_min_tasks_(32),
+        prefetch_window_max_tasks_(4096),
+        object_store_default_output_bytes_(1024 * 1024) {}
 
   ~RayConfig() {}
 
@@ -181,6 +306,10 @@ class RayConfig {
   /// reconstruct calls for in a single pass through the reconstruct object
   /// timeout handler.
   int64_t max_num_to_reconstruct_;
+  /// The maximum number of objects that the local scheduler will be looking
+  /// up or claiming for reconstruction at once. Further reconstruction
+  /// requests are queued and started as earlier ones complete.
+  int64_t max_reconstructions_in_flight_;
   /// The maximum number of objects to include in a single fetch request in the
   /// regular local scheduler fetch timeout handler.
   int64_t local_scheduler_fetch_request_size_;
@@ -193,6 +322,24 @@ class RayConfig {
   int64_t manager_timeout_milliseconds_;
   int64_t buf_size_;
 
+  /// The size of the chunks that the plasma manager splits objects into when
+  /// sending them to another manager.
+  int64_t manager_chunk_size_;
+
+  /// The maximum number of connections that the plasma manager opens to each
+  /// other manager, to send the chunks of large objects in parallel.
+  int64_t manager_connections_per_peer_;
+
+  /// Time after which the plasma manager discards an object whose chunks
+  /// stopped arriving, for example because the sending manager died, so that
+  /// the object is fetched again.
+  int64_t manager_receive_timeout_milliseconds_;
+
+  /// The largest object, in bytes, that the plasma manager hashes with SHA-256
+  /// when it is sealed, and that a fetch may copy from a local object with the
+  /// same hash. Both happen on the event loop, so this bounds their cost.
+  int64_t manager_dedup_max_object_size_;
+
   /// This is a timeout used to cause failures in the plasma manager and local
   /// scheduler when certain event loop handlers take too long.
   int64_t max_time_for_handler_milliseconds_;
@@ -240,6 +387,113 @@ class RayConfig {
   /// In the object manager, no single thread is permitted to transfer more
   /// data than what is specified by the chunk size.
   uint64_t object_manager_default_chunk_size_;
+
+  /// Maximum total size of the objects that the object manager has requested
+  /// from remote nodes but that have not arrived yet. Pulls beyond this wait
+  /// until earlier ones complete, so that the local object store is not asked
+  /// to receive more than it can hold.
+  uint64_t object_manager_max_inflight_pull_bytes_;
+
+  /// Timeout, in milliseconds, after which an object that the object manager
+  /// requested and that has received no new chunks is requested again. Only
+  /// the chunks that have not arrived are requested again.
+  int object_manager_chunk_timeout_ms_;
+
+  /// Maximum number of times that the object manager requests an object
+  /// before giving up on the pull and discarding the partially received
+  /// object.
+  int object_manager_max_pull_attempts_;
+
+  /// The codec that the object manager compresses the chunks that it sends
+  /// with, if the receiving object manager supports it: 0 for none, 1 for LZ4
+  /// and 2 for zstd. Chunks that are smaller than the minimum size, or whose
+  /// samples do not compress well, are sent uncompressed.
+  int object_manager_compression_codec_;
+  int64_t object_manager_compression_min_chunk_bytes_;
+
+  /// Whether the object manager sends the chunks of an object in order, and
+  /// lets readers in the raylet process wait for byte ranges of objects that
+  /// are being received. Those readers can then start on an object before all
+  /// of it has arrived, at the cost of sending each object's chunks on a single
+  /// thread. Workers only see sealed objects, so they do not benefit.
+  bool object_manager_streaming_;
+
+  /// Maximum number of queued messages that a connection coalesces into a
+  /// single asynchronous gather write.
+  int async_write_max_messages_;
+
+  /// Once this many bytes are queued for asynchronous writes on a connection,
+  /// the connection reports that it is above its high-water mark, and callers
+  /// should defer messages that they can send later.
+  int64_t async_write_high_water_mark_bytes_;
+
+  /// Once a connection that went above its high-water mark has drained to this
+  /// many queued bytes, callers resume sending the messages they deferred.
+  int64_t async_write_low_water_mark_bytes_;
+
+  /// The size of the shared memory ring that each worker uses to send messages
+  /// to the raylet without a system call per message. If this is 0, workers
+  /// send every message on their socket.
+  int64_t worker_submission_ring_bytes_;
+
+  /// The time that a worker waits for the raylet to make room in its
+  /// submission ring before the submission fails.
+  int64_t worker_submission_ring_timeout_milliseconds_;
+
+  /// The maximum number of messages that the raylet handles from one
+  /// submission ring before it lets other events run. The rest of the ring is
+  /// drained afterwards. With raylet I/O threads, this is the number of
+  /// messages that an I/O thread parses from a ring before it waits for the
+  /// main thread to handle them.
+  int64_t raylet_submission_ring_max_drain_;
+
+  /// The duration that the raylet waits for an object that a queued task needs
+  /// to be created before it reconstructs the object. Objects that were
+  /// created but whose copies are all gone are reconstructed without waiting.
+  int64_t object_reconstruction_lease_milliseconds_;
+
+  /// The maximum number of tasks that the raylet sends to a local actor ahead
+  /// of the one that the actor is executing. The actor reads them as soon as
+  /// it finishes its current task, instead of waiting for the raylet to reply.
+  int64_t actor_max_pipelined_tasks_;
+
+  /// Whether workers ask the raylet for their next task while they execute
+  /// their current one. The raylet sends a worker its next task ahead of time
+  /// if the task is waiting for the resources that the worker's current task
+  /// holds, so that the worker starts it without a round trip.
+  bool worker_prefetch_tasks_;
+
+  /// The number of profiling events that a process buffers before they are
+  /// written out. Events recorded while the buffer is full are dropped.
+  int64_t profile_event_buffer_size_;
+
+  /// The period at which a process writes out its buffered profiling events.
+  /// The local scheduler also writes out the workers' event logs at this
+  /// period.
+  int64_t profile_event_flush_period_milliseconds_;
+
+  /// The number of threads that read and parse the messages of the raylet's
+  /// local clients. Only the handling of the parsed messages runs on the
+  /// raylet's main thread. If this is 0, the main thread also reads the
+  /// messages.
+  int raylet_client_io_threads_;
+
+  /// The maximum number of parsed client messages that the raylet's main
+  /// thread handles before it lets other events run.
+  int64_t raylet_client_message_batch_size_;
+
+  /// The bounds on the number of queued tasks, in dispatch order, whose
+  /// missing objects the scheduler fetches ahead of time. The objects of the
+  /// tasks behind them are fetched once the tasks move up. The window starts
+  /// at the lower bound, grows while fetched objects arrive, and is halved
+  /// whenever the object store evicts an object that a queued task needs.
+  int64_t prefetch_window_min_tasks_;
+  int64_t prefetch_window_max_tasks_;
+
+  /// The number of bytes of object store memory that the raylet reserves for
+  /// the outputs of a task whose function has not returned any outputs on the
+  /// node yet.
+  int64_t object_store_default_output_bytes_;
 };
 
 #endif  // RAY_CONFIG_H
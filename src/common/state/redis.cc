@@ -731,12 +731,18 @@ void object_table_redis_subscribe_to_notifications_callback(
       manager_ids.push_back(manager_id);
     }
 
+    /* Extract the digest. Notifications from older servers do not have one. */
+    std::string digest;
+    if (message->digest() != nullptr) {
+      digest = message->digest()->str();
+    }
+
     /* Call the subscribe callback. */
     ObjectTableSubscribeData *data =
         (ObjectTableSubscribeData *) callback_data->data->Get();
     if (data->object_available_callback) {
-      data->object_available_callback(obj_id, data_size, manager_ids,
-                                      data->subscribe_context);
+      data->object_available_callback(obj_id, data_size, manager_ids, digest,
+                                       data->subscribe_context);
     }
   } else if (strcmp(message_type->str, "subscribe") == 0) {
     /* The reply for the initial SUBSCRIBE command. */
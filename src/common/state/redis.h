@@ -1,7 +1,10 @@
 #ifndef REDIS_H
 #define REDIS_H
 
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "db.h"
 #include "db_client_table.h"
@@ -52,6 +55,12 @@ struct DBHandle {
   /** Redis context for synchronous connections. This should only be used very
    *  rarely, it is not asynchronous. */
   redisContext *sync_context;
+  /** Event log entries that have not been written to Redis yet. This maps
+   *  each key to the (timestamp, value) pairs logged under it, in order. See
+   *  RayLogger_log_event. */
+  std::unordered_map<std::string,
+                     std::vector<std::pair<std::string, std::string>>>
+      pending_events;
 };
 
 /**
@@ -32,6 +32,119 @@ ObjectID task_compute_put_id(TaskID task_id, int64_t put_index) {
   return put_id;
 }
 
+/* The size in bytes of the digest of a by-value argument. */
+#define ARGUMENT_DIGEST_SIZE 16
+
+static inline uint64_t rotl64(uint64_t x, int8_t r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+/**
+ * Compute a 128-bit digest of a by-value task argument. This is
+ * MurmurHash3_x64_128, which processes 16 bytes per iteration and so costs a
+ * small fraction of SHA-256 on large arguments. The digest only has to be
+ * deterministic and to spread different arguments apart: task IDs are already
+ * unique through the parent task ID and counter, and the digest is itself fed
+ * into SHA-256 along with the rest of the task.
+ *
+ * @param value The argument bytes.
+ * @param length The number of argument bytes.
+ * @param digest The buffer to write the digest to.
+ * @return Void.
+ */
+static void argument_digest(const uint8_t *value,
+                            int64_t length,
+                            uint8_t digest[ARGUMENT_DIGEST_SIZE]) {
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  int64_t num_blocks = length / 16;
+  for (int64_t i = 0; i < num_blocks; i++) {
+    uint64_t k1;
+    uint64_t k2;
+    memcpy(&k1, value + 16 * i, sizeof(k1));
+    memcpy(&k2, value + 16 * i + 8, sizeof(k2));
+    k1 *= c1;
+    k1 = rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = rotl64(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+    k2 *= c2;
+    k2 = rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+    h2 = rotl64(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+  /* Mix in the remaining 0 to 15 bytes. */
+  const uint8_t *tail = value + 16 * num_blocks;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  switch (length & 15) {
+  case 15:
+    k2 ^= ((uint64_t) tail[14]) << 48;
+  case 14:
+    k2 ^= ((uint64_t) tail[13]) << 40;
+  case 13:
+    k2 ^= ((uint64_t) tail[12]) << 32;
+  case 12:
+    k2 ^= ((uint64_t) tail[11]) << 24;
+  case 11:
+    k2 ^= ((uint64_t) tail[10]) << 16;
+  case 10:
+    k2 ^= ((uint64_t) tail[9]) << 8;
+  case 9:
+    k2 ^= ((uint64_t) tail[8]);
+    k2 *= c2;
+    k2 = rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+  case 8:
+    k1 ^= ((uint64_t) tail[7]) << 56;
+  case 7:
+    k1 ^= ((uint64_t) tail[6]) << 48;
+  case 6:
+    k1 ^= ((uint64_t) tail[5]) << 40;
+  case 5:
+    k1 ^= ((uint64_t) tail[4]) << 32;
+  case 4:
+    k1 ^= ((uint64_t) tail[3]) << 24;
+  case 3:
+    k1 ^= ((uint64_t) tail[2]) << 16;
+  case 2:
+    k1 ^= ((uint64_t) tail[1]) << 8;
+  case 1:
+    k1 ^= ((uint64_t) tail[0]);
+    k1 *= c1;
+    k1 = rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+  h1 ^= (uint64_t) length;
+  h2 ^= (uint64_t) length;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+  h1 += h2;
+  h2 += h1;
+  memcpy(digest, &h1, sizeof(h1));
+  memcpy(digest + sizeof(h1), &h2, sizeof(h2));
+}
+
 class TaskBuilder {
  public:
   void Start(UniqueID driver_id,
@@ -83,7 +196,11 @@ class TaskBuilder {
     auto arg = fbb.CreateString((const char *) value, length);
     auto empty_ids = fbb.CreateVectorOfStrings({});
     args.push_back(CreateArg(fbb, empty_ids, arg));
-    sha256_update(&ctx, (BYTE *) value, length);
+    /* Only a digest of the argument goes through SHA-256, so that the cost of
+     * the task ID does not grow with the size of the argument. */
+    uint8_t digest[ARGUMENT_DIGEST_SIZE];
+    argument_digest(value, length, digest);
+    sha256_update(&ctx, (BYTE *) digest, sizeof(digest));
   }
 
   void SetRequiredResource(const std::string &resource_name, double value) {
@@ -228,6 +228,7 @@ int subscribe_failed = 0;
 void subscribe_done_callback(ObjectID object_id,
                              int64_t data_size,
                              const std::vector<DBClientID> &manager_vector,
+                             const std::string &digest,
                              void *user_context) {
   /* The done callback should not be called. */
   RAY_CHECK(0);
@@ -593,10 +594,13 @@ void subscribe_success_object_available_callback(
     ObjectID object_id,
     int64_t data_size,
     const std::vector<DBClientID> &manager_vector,
+    const std::string &digest,
     void *user_context) {
   RAY_CHECK(user_context == (void *) subscribe_success_context);
   RAY_CHECK(object_id == subscribe_id);
   RAY_CHECK(manager_vector.size() == 1);
+  /* The notification carries the digest that the object was added with. */
+  RAY_CHECK(digest == std::string((const char *) NIL_DIGEST, DIGEST_SIZE));
   subscribe_success_succeeded = 1;
 }
 
@@ -653,6 +657,7 @@ void subscribe_object_present_object_available_callback(
     ObjectID object_id,
     int64_t data_size,
     const std::vector<DBClientID> &manager_vector,
+    const std::string &digest,
     void *user_context) {
   subscribe_object_present_context_t *ctx =
       (subscribe_object_present_context_t *) user_context;
@@ -721,6 +726,7 @@ void subscribe_object_not_present_object_available_callback(
     ObjectID object_id,
     int64_t data_size,
     const std::vector<DBClientID> &manager_vector,
+    const std::string &digest,
     void *user_context) {
   /* This should not be called. */
   RAY_CHECK(0);
@@ -770,6 +776,7 @@ void subscribe_object_available_later_object_available_callback(
     ObjectID object_id,
     int64_t data_size,
     const std::vector<DBClientID> &manager_vector,
+    const std::string &digest,
     void *user_context) {
   subscribe_object_present_context_t *myctx =
       (subscribe_object_present_context_t *) user_context;
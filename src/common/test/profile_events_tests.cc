@@ -0,0 +1,139 @@
+#include "greatest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profile_events.h"
+
+SUITE(profile_events_tests);
+
+ProfileEvent make_event(int64_t start_time_us, uint32_t type) {
+  ProfileEvent event;
+  event.start_time_us = start_time_us;
+  event.duration_us = 0;
+  event.type = type;
+  memset(event.id, 0, sizeof(event.id));
+  return event;
+}
+
+TEST ring_order_test(void) {
+  ProfileEventRing ring(16);
+  for (int i = 0; i < 10; i++) {
+    ASSERT(ring.Record(make_event(i, 0)));
+  }
+  std::vector<ProfileEvent> events;
+  ASSERT_EQ(ring.Drain(&events), 10);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(events[i].start_time_us, i);
+  }
+  ASSERT_EQ(ring.Drain(&events), 0);
+  PASS();
+}
+
+TEST ring_full_test(void) {
+  /* The capacity is rounded up to 4. */
+  ProfileEventRing ring(3);
+  for (int i = 0; i < 4; i++) {
+    ASSERT(ring.Record(make_event(i, 0)));
+  }
+  ASSERT_FALSE(ring.Record(make_event(4, 0)));
+  ASSERT_EQ(ring.NumDropped(), 1);
+  /* Draining makes room for more events. */
+  std::vector<ProfileEvent> events;
+  ASSERT_EQ(ring.Drain(&events), 4);
+  for (int i = 5; i < 8; i++) {
+    ASSERT(ring.Record(make_event(i, 0)));
+  }
+  events.clear();
+  ASSERT_EQ(ring.Drain(&events), 3);
+  ASSERT_EQ(events[0].start_time_us, 5);
+  ASSERT_EQ(events[2].start_time_us, 7);
+  PASS();
+}
+
+TEST ring_concurrent_test(void) {
+  const int num_threads = 4;
+  const int num_events = 10000;
+  ProfileEventRing ring(1024);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ring, t, num_events]() {
+      for (int i = 0; i < num_events; i++) {
+        /* Retry until the drainer makes room. */
+        while (!ring.Record(make_event(i, t))) {
+        }
+      }
+    });
+  }
+  /* Each thread's events must be drained in the order it recorded them. */
+  std::vector<int64_t> next(num_threads, 0);
+  int64_t num_drained = 0;
+  std::vector<ProfileEvent> events;
+  while (num_drained < num_threads * num_events) {
+    events.clear();
+    ring.Drain(&events);
+    for (const auto &event : events) {
+      ASSERT_EQ(event.start_time_us, next[event.type]);
+      next[event.type]++;
+    }
+    num_drained += events.size();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  PASS();
+}
+
+TEST file_sink_test(void) {
+  const char *path = "profile-events-test.bin";
+  ray::UniqueID source_id = ray::UniqueID::from_random();
+  ray::UniqueID task_id = ray::UniqueID::from_random();
+  profile_events_start(source_id, std::unique_ptr<ProfileEventSink>(
+                                      new ProfileEventFileSink(path)));
+  profile_event_record(PROFILE_EVENT_ASSIGN_TASK, task_id, 100, 0);
+  profile_event_record(PROFILE_EVENT_EXECUTE_TASK, task_id, 100, 25);
+  /* Stopping writes out the recorded events. */
+  profile_events_stop();
+  /* Recording is stopped, so this is not written. */
+  profile_event_record(PROFILE_EVENT_SUBMIT_TASK, task_id, 200, 0);
+
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  std::string data = contents.str();
+  std::vector<ProfileEvent> expected = {
+      make_event(100, PROFILE_EVENT_ASSIGN_TASK),
+      make_event(100, PROFILE_EVENT_EXECUTE_TASK)};
+  expected[1].duration_us = 25;
+  for (auto &event : expected) {
+    memcpy(event.id, task_id.data(), sizeof(event.id));
+  }
+  ASSERT_EQ(data.size(), 40 + 2 * sizeof(ProfileEvent));
+  ASSERT_EQ(data, profile_events_serialize(source_id, expected, true));
+  ASSERT_EQ(memcmp(data.data(), "RAYPROF", 8), 0);
+  ASSERT_EQ(memcmp(data.data() + 16, source_id.data(), kUniqueIDSize), 0);
+  unlink(path);
+  PASS();
+}
+
+SUITE(profile_events_tests) {
+  RUN_TEST(ring_order_test);
+  RUN_TEST(ring_full_test);
+  RUN_TEST(ring_concurrent_test);
+  RUN_TEST(file_sink_test);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char **argv) {
+  GREATEST_MAIN_BEGIN();
+  RUN_SUITE(profile_events_tests);
+  GREATEST_MAIN_END();
+}
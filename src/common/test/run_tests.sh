@@ -37,6 +37,7 @@ if [ -z "$RAY_USE_NEW_GCS" ]; then
   ./src/common/redis_tests
   ./src/common/task_table_tests
   ./src/common/object_table_tests
+  ./src/common/profile_events_tests
 fi
 
 ./src/common/thirdparty/redis/src/redis-cli -p 6379 shutdown
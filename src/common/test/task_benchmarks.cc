@@ -0,0 +1,69 @@
+#include "greatest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "common.h"
+#include "test_common.h"
+#include "task.h"
+
+SUITE(task_benchmarks);
+
+TEST task_id_argument_size_benchmark(void) {
+  TaskBuilder *builder = make_task_builder();
+  TaskID parent_task_id = TaskID::from_random();
+  FunctionID func_id = FunctionID::from_random();
+  int64_t sizes[] = {8, 1024, 100 * 1024, 1024 * 1024};
+  for (int64_t size : sizes) {
+    std::vector<uint8_t> arg(size, 1);
+    int num_tasks = std::max<int64_t>(10, 10 * 1024 * 1024 / size);
+    /* Time the submission path: building a task spec with one value argument.
+     * This includes copying the argument into the spec. */
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_tasks; i++) {
+      TaskSpec_start_construct(builder, DriverID::nil(), parent_task_id, i,
+                               ActorID::nil(), ObjectID::nil(), ActorID::nil(),
+                               ActorID::nil(), 0, false, func_id, 1);
+      TaskSpec_args_add_val(builder, arg.data(), size);
+      int64_t spec_size;
+      TaskSpec *spec = TaskSpec_finish_construct(builder, &spec_size);
+      TaskSpec_free(spec);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double build_us =
+        std::chrono::duration<double, std::micro>(end - start).count() /
+        num_tasks;
+    /* For comparison, time SHA-256 over the argument bytes, which is what
+     * the task ID used to cost per value argument. */
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_tasks; i++) {
+      SHA256_CTX ctx;
+      BYTE buff[DIGEST_SIZE];
+      sha256_init(&ctx);
+      sha256_update(&ctx, (BYTE *) arg.data(), size);
+      sha256_final(&ctx, buff);
+    }
+    end = std::chrono::steady_clock::now();
+    double sha256_us =
+        std::chrono::duration<double, std::micro>(end - start).count() /
+        num_tasks;
+    printf("%" PRId64 " byte argument: %.2f us to build the task, "
+           "%.2f us to SHA-256 the argument\n",
+           size, build_us, sha256_us);
+  }
+  free_task_builder(builder);
+  PASS();
+}
+
+SUITE(task_benchmarks) {
+  RUN_TEST(task_id_argument_size_benchmark);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char **argv) {
+  GREATEST_MAIN_BEGIN();
+  RUN_SUITE(task_benchmarks);
+  GREATEST_MAIN_END();
+}
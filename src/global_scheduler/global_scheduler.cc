@@ -6,6 +6,7 @@
 #include "event_loop.h"
 #include "global_scheduler.h"
 #include "global_scheduler_algorithm.h"
+#include "global_scheduler_workers.h"
 #include "net.h"
 #include "state/db_client_table.h"
 #include "state/local_scheduler_table.h"
@@ -145,10 +146,16 @@ GlobalSchedulerState *GlobalSchedulerState_init(event_loop *loop,
                                          redis_primary_port));
   RAY_CHECK_OK(state->gcs_client.context()->AttachToEventLoop(loop));
   state->policy_state = GlobalSchedulerPolicyState_init();
+  state->workers = NULL;
+  state->load_snapshot_dirty = false;
   return state;
 }
 
 void GlobalSchedulerState_free(GlobalSchedulerState *state) {
+  /* Stop the placement threads. This frees the tasks that they have not placed
+   * yet. */
+  delete state->workers;
+  state->workers = NULL;
   db_disconnect(state->db);
   state->local_schedulers.clear();
   GlobalSchedulerPolicyState_free(state->policy_state);
@@ -197,6 +204,12 @@ void signal_handler(int signal) {
 void process_task_waiting(Task *waiting_task, void *user_context) {
   GlobalSchedulerState *state = (GlobalSchedulerState *) user_context;
   RAY_LOG(DEBUG) << "Task waiting callback is called.";
+  if (state->workers != NULL) {
+    /* Hand the task to the placement thread that owns its partition. The
+     * decision comes back through process_placement_decision. */
+    state->workers->Submit(Task_copy(waiting_task));
+    return;
+  }
   bool successfully_assigned =
       handle_task_waiting(state, state->policy_state, waiting_task);
   /* If the task was not successfully submitted to a local scheduler, add the
@@ -208,6 +221,52 @@ void process_task_waiting(Task *waiting_task, void *user_context) {
   }
 }
 
+/**
+ * Publish a snapshot of the current local scheduler load to the placement
+ * threads, if there are any.
+ *
+ * @param state The global scheduler state.
+ * @return Void.
+ */
+void publish_load_snapshot(GlobalSchedulerState *state) {
+  if (state->workers == NULL) {
+    return;
+  }
+  state->workers->PublishSnapshot(std::unique_ptr<const LoadSnapshot>(
+      new LoadSnapshot(state->local_schedulers)));
+  state->load_snapshot_dirty = false;
+}
+
+/**
+ * Apply a placement decision made by one of the placement threads. This runs on
+ * the event loop thread.
+ *
+ * @param state The global scheduler state.
+ * @param task The task that was placed. This function takes ownership of it.
+ * @param local_scheduler_id The local scheduler chosen for the task, or nil if
+ *        the task is infeasible.
+ * @return Void.
+ */
+void process_placement_decision(GlobalSchedulerState *state,
+                                Task *task,
+                                const DBClientID &local_scheduler_id) {
+  /* The task is no longer queued on the local scheduler that it was spilled
+   * back from. The placement thread only adjusted its own view of the load. */
+  handle_task_spilled_back(state, state->policy_state, task);
+  /* The snapshot that the decision was based on may be stale, so the local
+   * scheduler may have been removed in the meantime. */
+  if (local_scheduler_id.is_nil() ||
+      state->local_schedulers.count(local_scheduler_id) == 0) {
+    /* The global scheduler will periodically resubmit the tasks in this
+     * array. */
+    state->pending_tasks.push_back(task);
+    return;
+  }
+  assign_task_to_local_scheduler(state, task, local_scheduler_id);
+  handle_task_assigned(state, state->policy_state, local_scheduler_id);
+  Task_free(task);
+}
+
 void add_local_scheduler(GlobalSchedulerState *state,
                          DBClientID db_client_id,
                          const char *manager_address) {
@@ -227,8 +286,12 @@ void add_local_scheduler(GlobalSchedulerState *state,
   local_scheduler.num_heartbeats_missed = 0;
   local_scheduler.num_tasks_sent = 0;
   local_scheduler.num_recent_tasks_sent = 0;
+  local_scheduler.num_heartbeats_received = 0;
   local_scheduler.info.task_queue_length = 0;
   local_scheduler.info.available_workers = 0;
+  /* Publish right away rather than on the next timer tick, so that the
+   * placement threads do not find tasks infeasible in the meantime. */
+  publish_load_snapshot(state);
 
   /* Allow the scheduling algorithm to process this event. */
   handle_new_local_scheduler(state, state->policy_state, db_client_id);
@@ -248,6 +311,9 @@ std::unordered_map<DBClientID, LocalScheduler>::iterator remove_local_scheduler(
       state->local_scheduler_plasma_map[local_scheduler_id];
   state->local_scheduler_plasma_map.erase(local_scheduler_id);
   state->plasma_local_scheduler_map.erase(manager_address);
+  /* Publish right away, so that the placement threads stop choosing the
+   * removed local scheduler. */
+  publish_load_snapshot(state);
 
   handle_local_scheduler_removed(state, state->policy_state,
                                  local_scheduler_id);
@@ -294,12 +360,14 @@ void process_new_db_client(DBClient *db_client, void *user_context) {
  * @param data_size The object size.
  * @param manager_count The number of locations for this object.
  * @param manager_ids The vector of Plasma Manager client IDs.
+ * @param digest The hash of the object's contents (unused).
  * @param user_context The user context.
  * @return Void.
  */
 void object_table_subscribe_callback(ObjectID object_id,
                                      int64_t data_size,
                                      const std::vector<DBClientID> &manager_ids,
+                                     const std::string &digest,
                                      void *user_context) {
   /* Extract global scheduler state from the callback context. */
   GlobalSchedulerState *state = (GlobalSchedulerState *) user_context;
@@ -343,7 +411,6 @@ void local_scheduler_table_handler(DBClientID client_id,
                                    void *user_context) {
   /* Extract global scheduler state from the callback context. */
   GlobalSchedulerState *state = (GlobalSchedulerState *) user_context;
-  ARROW_UNUSED(state);
   RAY_LOG(DEBUG) << "Local scheduler heartbeat from db_client_id " << client_id;
   RAY_LOG(DEBUG) << "total workers = " << info.total_num_workers
                  << ", task queue length = " << info.task_queue_length
@@ -363,7 +430,17 @@ void local_scheduler_table_handler(DBClientID client_id,
       LocalScheduler &local_scheduler = it->second;
       local_scheduler.num_heartbeats_missed = 0;
       local_scheduler.num_recent_tasks_sent = 0;
+      local_scheduler.num_heartbeats_received += 1;
       local_scheduler.info = info;
+      if (local_scheduler.num_heartbeats_received == 1) {
+        /* The first heartbeat reports the local scheduler's resources, which
+         * tasks cannot be placed without. */
+        publish_load_snapshot(state);
+      } else {
+        state->load_snapshot_dirty = true;
+      }
+      /* Allow the scheduling algorithm to process this event. */
+      handle_local_scheduler_heartbeat(state, state->policy_state, client_id);
     }
   } else {
     RAY_LOG(WARNING) << "client_id didn't match any cached local scheduler "
@@ -393,6 +470,19 @@ int task_cleanup_handler(event_loop *loop, timer_id id, void *context) {
   return GLOBAL_SCHEDULER_TASK_CLEANUP_MILLISECONDS;
 }
 
+int load_snapshot_handler(event_loop *loop, timer_id id, void *context) {
+  GlobalSchedulerState *state = (GlobalSchedulerState *) context;
+  /* Publish a new snapshot of the local scheduler load to the placement
+   * threads. Heartbeats that arrive within one period are batched into a
+   * single snapshot. */
+  if (state->load_snapshot_dirty) {
+    publish_load_snapshot(state);
+  } else {
+    state->workers->ReclaimSnapshots();
+  }
+  return GLOBAL_SCHEDULER_LOAD_SNAPSHOT_MILLISECONDS;
+}
+
 int heartbeat_timeout_handler(event_loop *loop, timer_id id, void *context) {
   GlobalSchedulerState *state = (GlobalSchedulerState *) context;
   /* Check for local schedulers that have missed a number of heartbeats. If any
@@ -424,10 +514,25 @@ int heartbeat_timeout_handler(event_loop *loop, timer_id id, void *context) {
 
 void start_server(const char *node_ip_address,
                   const char *redis_primary_addr,
-                  int redis_primary_port) {
+                  int redis_primary_port,
+                  int num_placement_threads) {
   event_loop *loop = event_loop_create();
   g_state = GlobalSchedulerState_init(loop, node_ip_address, redis_primary_addr,
                                       redis_primary_port);
+  if (num_placement_threads > 0) {
+    GlobalSchedulerState *state = g_state;
+    /* The threads start with a snapshot of the local schedulers that are
+     * already known, before any waiting tasks are subscribed to. */
+    state->workers = new GlobalSchedulerWorkers(
+        loop, num_placement_threads,
+        std::unique_ptr<const LoadSnapshot>(
+            new LoadSnapshot(state->local_schedulers)),
+        [state](Task *task, const DBClientID &local_scheduler_id) {
+          process_placement_decision(state, task, local_scheduler_id);
+        });
+    event_loop_add_timer(loop, GLOBAL_SCHEDULER_LOAD_SNAPSHOT_MILLISECONDS,
+                         load_snapshot_handler, g_state);
+  }
   /* TODO(rkn): subscribe to notifications from the object table. */
   /* Subscribe to notifications about new local schedulers. TODO(rkn): this
    * needs to also get all of the clients that registered with the database
@@ -464,14 +569,20 @@ void start_server(const char *node_ip_address,
   event_loop_run(loop);
 }
 
+/* Only declare the main function if we are not in testing mode, since the test
+ * suite has its own declaration of main. */
+#ifndef GLOBAL_SCHEDULER_TEST
 int main(int argc, char *argv[]) {
   signal(SIGTERM, signal_handler);
   /* IP address and port of the primary redis instance. */
   char *redis_primary_addr_port = NULL;
   /* The IP address of the node that this global scheduler is running on. */
   char *node_ip_address = NULL;
+  /* The number of threads used to place tasks. If this is 0, tasks are placed
+   * on the event loop thread. */
+  int num_placement_threads = 0;
   int c;
-  while ((c = getopt(argc, argv, "h:r:")) != -1) {
+  while ((c = getopt(argc, argv, "h:r:t:")) != -1) {
     switch (c) {
     case 'r':
       redis_primary_addr_port = optarg;
@@ -479,6 +590,9 @@ int main(int argc, char *argv[]) {
     case 'h':
       node_ip_address = optarg;
       break;
+    case 't':
+      num_placement_threads = atoi(optarg);
+      break;
     default:
       RAY_LOG(FATAL) << "unknown option " << c;
     }
@@ -495,5 +609,7 @@ int main(int argc, char *argv[]) {
   if (!node_ip_address) {
     RAY_LOG(FATAL) << "specify the node IP address with the -h switch";
   }
-  start_server(node_ip_address, redis_primary_addr, redis_primary_port);
+  start_server(node_ip_address, redis_primary_addr, redis_primary_port,
+               num_placement_threads);
 }
+#endif
@@ -13,6 +13,11 @@
  * that haven't been scheduled yet. */
 #define GLOBAL_SCHEDULER_TASK_CLEANUP_MILLISECONDS 100
 
+/* The frequency with which the global scheduler publishes a new snapshot of the
+ * local scheduler load to its placement threads, if any heartbeats arrived.
+ * Local schedulers that join or leave are published right away. */
+#define GLOBAL_SCHEDULER_LOAD_SNAPSHOT_MILLISECONDS 10
+
 /** Contains all information that is associated with a local scheduler. */
 typedef struct {
   /** The ID of the local scheduler in Redis. */
@@ -26,12 +31,17 @@ typedef struct {
   /** The number of tasks sent from the global scheduler to this local scheduler
    *  since the last heartbeat arrived. */
   int64_t num_recent_tasks_sent;
+  /** The number of heartbeats received from this local scheduler. Placement
+   *  threads use this to tell which of their task counts have been folded
+   *  into the latest heartbeat. */
+  int64_t num_heartbeats_received;
   /** The latest information about the local scheduler capacity. This is updated
    *  every time a new local scheduler heartbeat arrives. */
   LocalSchedulerInfo info;
 } LocalScheduler;
 
 typedef class GlobalSchedulerPolicyState GlobalSchedulerPolicyState;
+typedef class GlobalSchedulerWorkers GlobalSchedulerWorkers;
 
 /**
  * This defines a hash table used to cache information about different objects.
@@ -66,6 +76,12 @@ typedef struct {
   std::unordered_map<ObjectID, SchedulerObjectInfo> scheduler_object_info_table;
   /** An array of tasks that haven't been scheduled yet. */
   std::vector<Task *> pending_tasks;
+  /** The threads that place waiting tasks. If this is NULL, then tasks are
+   *  placed on the event loop thread. */
+  GlobalSchedulerWorkers *workers;
+  /** Whether a local scheduler has sent a heartbeat since the last load
+   *  snapshot was published to the workers. */
+  bool load_snapshot_dirty;
 } GlobalSchedulerState;
 
 /**
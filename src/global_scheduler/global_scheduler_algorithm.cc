@@ -1,4 +1,4 @@
-#include <limits.h>
+#include <algorithm>
 
 #include "task.h"
 #include "state/task_table.h"
@@ -15,25 +15,27 @@ void GlobalSchedulerPolicyState_free(GlobalSchedulerPolicyState *policy_state) {
 }
 
 /**
- * Checks if the given local scheduler satisfies the task's hard constraints.
+ * Checks if a set of static resources satisfies a task's resource
+ * requirements.
  *
- * @param scheduler Local scheduler.
- * @param spec Task specification.
- * @return True if all tasks's resource constraints are satisfied. False
+ * @param static_resources The static resources of a local scheduler.
+ * @param required_resources The resources required by the task.
+ * @return True if all of the task's resource constraints are satisfied. False
  *         otherwise.
  */
-bool constraints_satisfied_hard(const LocalScheduler *scheduler,
-                                const TaskSpec *spec) {
-  if (scheduler->info.static_resources.count("CPU") == 1 &&
-      scheduler->info.static_resources.at("CPU") == 0) {
+template <typename ResourceMap>
+static bool resources_satisfy_hard(
+    const ResourceMap &static_resources,
+    const std::unordered_map<std::string, double> &required_resources) {
+  auto cpus = static_resources.find("CPU");
+  if (cpus != static_resources.end() && cpus->second == 0) {
     // Don't give tasks to local schedulers that have 0 CPUs. This can be an
     // issue for actor creation tasks that require 0 CPUs (but the subsequent
     // actor methods require some CPUs).
     return false;
   }
 
-  for (auto const &resource_pair : TaskSpec_get_required_resources(spec)) {
-    std::string resource_name = resource_pair.first;
+  for (auto const &resource_pair : required_resources) {
     double resource_quantity = resource_pair.second;
 
     // Continue on if the task doesn't actually require this resource.
@@ -41,20 +43,30 @@ bool constraints_satisfied_hard(const LocalScheduler *scheduler,
       continue;
     }
 
-    // Check if the local scheduler has this resource.
-    if (scheduler->info.static_resources.count(resource_name) == 0) {
-      return false;
-    }
-
-    // Check if the local scheduler has enough of the resource.
-    if (scheduler->info.static_resources.at(resource_name) <
-        resource_quantity) {
+    // Check if the local scheduler has this resource and has enough of it.
+    auto available = static_resources.find(resource_pair.first);
+    if (available == static_resources.end() ||
+        available->second < resource_quantity) {
       return false;
     }
   }
   return true;
 }
 
+/**
+ * Checks if the given local scheduler satisfies the task's hard constraints.
+ *
+ * @param scheduler Local scheduler.
+ * @param spec Task specification.
+ * @return True if all tasks's resource constraints are satisfied. False
+ *         otherwise.
+ */
+bool constraints_satisfied_hard(const LocalScheduler *scheduler,
+                                const TaskSpec *spec) {
+  return resources_satisfy_hard(scheduler->info.static_resources,
+                                TaskSpec_get_required_resources(spec));
+}
+
 int64_t locally_available_data_size(const GlobalSchedulerState *state,
                                     DBClientID local_scheduler_id,
                                     TaskSpec *task_spec) {
@@ -110,12 +122,11 @@ int64_t locally_available_data_size(const GlobalSchedulerState *state,
   return task_data_size;
 }
 
-double calculate_cost_pending(const GlobalSchedulerState *state,
-                              const LocalScheduler *scheduler,
-                              TaskSpec *task_spec) {
-  /* Calculate how much data is already present on this machine. TODO(rkn): Note
-   * that this information is not being used yet. Fix this. */
-  locally_available_data_size(state, scheduler->id, task_spec);
+double calculate_cost_pending(const LocalScheduler *scheduler) {
+  /* TODO(rkn): The amount of data already present on this machine (see
+   * locally_available_data_size) is not taken into account yet. Since the cost
+   * only depends on the local scheduler, it can be maintained incrementally in
+   * the LocalSchedulerIndex. */
   /* TODO(rkn): This logic does not load balance properly when the different
    * machines have different sizes. Fix this. */
   double cost_pending = scheduler->num_recent_tasks_sent +
@@ -124,6 +135,208 @@ double calculate_cost_pending(const GlobalSchedulerState *state,
   return cost_pending;
 }
 
+void LocalSchedulerIndex::Update(const LocalScheduler &local_scheduler) {
+  ResourceShape shape(local_scheduler.info.static_resources.begin(),
+                      local_scheduler.info.static_resources.end());
+  double cost = calculate_cost_pending(&local_scheduler);
+
+  auto it = entries_.find(local_scheduler.id);
+  if (it != entries_.end()) {
+    Entry &entry = it->second;
+    if (entry.bucket->first == shape) {
+      // The common case: only the load changed, so reposition the local
+      // scheduler within its bucket.
+      if (entry.cost != cost) {
+        entry.bucket->second.erase(CostEntry(entry.cost, local_scheduler.id));
+        entry.bucket->second.insert(CostEntry(cost, local_scheduler.id));
+        entry.cost = cost;
+      }
+      return;
+    }
+    EraseFromBucket(local_scheduler.id, entry);
+    entries_.erase(it);
+  }
+
+  auto bucket = buckets_.emplace(std::move(shape), Bucket()).first;
+  bucket->second.insert(CostEntry(cost, local_scheduler.id));
+  entries_[local_scheduler.id] = Entry{bucket, cost};
+}
+
+void LocalSchedulerIndex::Remove(const DBClientID &local_scheduler_id) {
+  auto it = entries_.find(local_scheduler_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  EraseFromBucket(local_scheduler_id, it->second);
+  entries_.erase(it);
+}
+
+void LocalSchedulerIndex::EraseFromBucket(const DBClientID &local_scheduler_id,
+                                          const Entry &entry) {
+  entry.bucket->second.erase(CostEntry(entry.cost, local_scheduler_id));
+  if (entry.bucket->second.empty()) {
+    buckets_.erase(entry.bucket);
+  }
+}
+
+DBClientID LocalSchedulerIndex::FindBest(const TaskSpec *spec,
+                                         const DBClientID &excluded_id) const {
+  const std::unordered_map<std::string, double> required_resources =
+      TaskSpec_get_required_resources(spec);
+
+  const CostEntry *best = nullptr;
+  for (const auto &bucket : buckets_) {
+    if (!resources_satisfy_hard(bucket.first, required_resources)) {
+      continue;
+    }
+    // The cheapest member of the bucket is the first one, unless that is the
+    // excluded local scheduler.
+    auto candidate = bucket.second.begin();
+    if (candidate->second == excluded_id) {
+      ++candidate;
+      if (candidate == bucket.second.end()) {
+        continue;
+      }
+    }
+    if (best == nullptr || candidate->first < best->first) {
+      best = &(*candidate);
+    }
+  }
+
+  if (best == nullptr) {
+    return DBClientID::nil();
+  }
+  return best->second;
+}
+
+int64_t LoadDeltas::Get(const DBClientID &local_scheduler_id,
+                        int64_t heartbeat_epoch) const {
+  auto it = deltas_.find(local_scheduler_id);
+  if (it == deltas_.end() || it->second.first != heartbeat_epoch) {
+    return 0;
+  }
+  return it->second.second;
+}
+
+void LoadDeltas::Add(const DBClientID &local_scheduler_id,
+                     int64_t heartbeat_epoch,
+                     int64_t delta) {
+  auto &entry = deltas_[local_scheduler_id];
+  if (entry.first != heartbeat_epoch) {
+    // A heartbeat arrived since the last delta was recorded, and the tasks
+    // counted so far are reflected in the local scheduler's reported load.
+    entry.first = heartbeat_epoch;
+    entry.second = 0;
+  }
+  entry.second += delta;
+}
+
+LoadSnapshot::LoadSnapshot(
+    const std::unordered_map<DBClientID, LocalScheduler> &local_schedulers) {
+  for (const auto &it : local_schedulers) {
+    const LocalScheduler &local_scheduler = it.second;
+    ResourceShape shape(local_scheduler.info.static_resources.begin(),
+                        local_scheduler.info.static_resources.end());
+    // The tasks sent since the last heartbeat are accounted for by the
+    // placement threads' deltas, so only the reported load is included here.
+    double cost = local_scheduler.info.task_queue_length -
+                  local_scheduler.info.available_workers;
+    int64_t heartbeat_epoch = local_scheduler.num_heartbeats_received;
+    buckets_[shape].push_back(Node{local_scheduler.id, cost, heartbeat_epoch});
+    heartbeat_epochs_[local_scheduler.id] = heartbeat_epoch;
+  }
+  for (auto &bucket : buckets_) {
+    std::sort(bucket.second.begin(), bucket.second.end(),
+              [](const Node &lhs, const Node &rhs) {
+                return lhs.cost < rhs.cost;
+              });
+  }
+}
+
+DBClientID LoadSnapshot::FindBest(const TaskSpec *spec,
+                                  const DBClientID &excluded_id,
+                                  const LoadDeltas &deltas,
+                                  int64_t *heartbeat_epoch) const {
+  const std::unordered_map<std::string, double> required_resources =
+      TaskSpec_get_required_resources(spec);
+
+  const Node *best = nullptr;
+  double best_cost = 0;
+  for (const auto &bucket : buckets_) {
+    if (!resources_satisfy_hard(bucket.first, required_resources)) {
+      continue;
+    }
+    for (const Node &node : bucket.second) {
+      // Nodes are sorted by reported load and deltas are clamped at zero, so
+      // nothing later in this bucket can beat the current best.
+      if (best != nullptr && node.cost >= best_cost) {
+        break;
+      }
+      if (node.id == excluded_id) {
+        continue;
+      }
+      double cost =
+          node.cost +
+          std::max<int64_t>(0, deltas.Get(node.id, node.heartbeat_epoch));
+      if (best == nullptr || cost < best_cost) {
+        best = &node;
+        best_cost = cost;
+      }
+    }
+  }
+
+  if (best == nullptr) {
+    return DBClientID::nil();
+  }
+  *heartbeat_epoch = best->heartbeat_epoch;
+  return best->id;
+}
+
+int64_t LoadSnapshot::HeartbeatEpoch(
+    const DBClientID &local_scheduler_id) const {
+  auto it = heartbeat_epochs_.find(local_scheduler_id);
+  if (it == heartbeat_epochs_.end()) {
+    return -1;
+  }
+  return it->second;
+}
+
+/**
+ * Refresh the position of a local scheduler in the policy's index after its
+ * load counters have changed.
+ *
+ * @param state The global scheduler state.
+ * @param policy_state The state managed by the scheduling policy.
+ * @param local_scheduler_id The ID of the local scheduler to refresh.
+ * @return Void.
+ */
+static void update_local_scheduler_index(
+    GlobalSchedulerState *state,
+    GlobalSchedulerPolicyState *policy_state,
+    const DBClientID &local_scheduler_id) {
+  auto it = state->local_schedulers.find(local_scheduler_id);
+  RAY_CHECK(it != state->local_schedulers.end());
+  policy_state->getLocalSchedulerIndex().Update(it->second);
+}
+
+void handle_task_spilled_back(GlobalSchedulerState *state,
+                              GlobalSchedulerPolicyState *policy_state,
+                              Task *task) {
+  // For tasks already seen by the global scheduler (spillback > 1),
+  // adjust scheduled task counts for the source local scheduler.
+  if (task->execution_spec->SpillbackCount() <= 1) {
+    return;
+  }
+  auto it = state->local_schedulers.find(task->local_scheduler_id);
+  if (it == state->local_schedulers.end()) {
+    // The local scheduler was removed since it spilled the task back.
+    return;
+  }
+  LocalScheduler &src_local_scheduler = it->second;
+  src_local_scheduler.num_recent_tasks_sent -= 1;
+  policy_state->getLocalSchedulerIndex().Update(src_local_scheduler);
+}
+
 bool handle_task_waiting_random(GlobalSchedulerState *state,
                                 GlobalSchedulerPolicyState *policy_state,
                                 Task *task) {
@@ -158,6 +371,7 @@ bool handle_task_waiting_random(GlobalSchedulerState *state,
       << "Task is feasible, but doesn't have a local scheduler assigned.";
   // A local scheduler ID was found, so assign the task.
   assign_task_to_local_scheduler(state, task, local_scheduler_id);
+  update_local_scheduler_index(state, policy_state, local_scheduler_id);
   return true;
 }
 
@@ -165,70 +379,31 @@ bool handle_task_waiting_cost(GlobalSchedulerState *state,
                               GlobalSchedulerPolicyState *policy_state,
                               Task *task) {
   TaskSpec *task_spec = Task_task_execution_spec(task)->Spec();
-  int64_t curtime = current_time_ms();
 
   RAY_CHECK(task_spec != NULL)
       << "task wait handler encounted a task with NULL spec";
 
-  // For tasks already seen by the global scheduler (spillback > 1),
-  // adjust scheduled task counts for the source local scheduler.
-  if (task->execution_spec->SpillbackCount() > 1) {
-    auto it = state->local_schedulers.find(task->local_scheduler_id);
-    // Task's previous local scheduler must be present and known.
-    RAY_CHECK(it != state->local_schedulers.end());
-    LocalScheduler &src_local_scheduler = it->second;
-    src_local_scheduler.num_recent_tasks_sent -= 1;
-  }
+  handle_task_spilled_back(state, policy_state, task);
 
-  bool task_feasible = false;
-
-  // Go through all the nodes, calculate the score for each, pick max score.
-  double best_local_scheduler_score = INT32_MIN;
-  RAY_CHECK(best_local_scheduler_score < 0)
-      << "We might have a floating point underflow";
-  RAY_LOG(INFO) << "ct[" << curtime << "] task from "
-                << task->local_scheduler_id << " spillback "
-                << task->execution_spec->SpillbackCount();
-
-  // The best node to send this task.
-  DBClientID best_local_scheduler_id = DBClientID::nil();
-
-  for (auto it = state->local_schedulers.begin();
-       it != state->local_schedulers.end(); it++) {
-    // For each local scheduler, calculate its score. Check hard constraints
-    // first.
-    LocalScheduler *scheduler = &(it->second);
-    if (!constraints_satisfied_hard(scheduler, task_spec)) {
-      continue;
-    }
-    // Skip the local scheduler the task came from.
-    if (task->local_scheduler_id == scheduler->id) {
-      continue;
-    }
-    task_feasible = true;
-    // This node satisfies the hard capacity constraint. Calculate its score.
-    double score = -1 * calculate_cost_pending(state, scheduler, task_spec);
-    RAY_LOG(INFO) << "ct[" << curtime << "][" << scheduler->id << "][q"
-                  << scheduler->info.task_queue_length << "][w"
-                  << scheduler->info.available_workers << "]: score " << score
-                  << " bestscore " << best_local_scheduler_score;
-    if (score >= best_local_scheduler_score) {
-      best_local_scheduler_score = score;
-      best_local_scheduler_id = scheduler->id;
-    }
-  }
+  RAY_LOG(DEBUG) << "task from " << task->local_scheduler_id << " spillback "
+                 << task->execution_spec->SpillbackCount();
+
+  // Pick the cheapest node that satisfies the hard constraints, skipping the
+  // local scheduler the task came from.
+  DBClientID best_local_scheduler_id =
+      policy_state->getLocalSchedulerIndex().FindBest(task_spec,
+                                                      task->local_scheduler_id);
 
-  if (!task_feasible) {
+  if (best_local_scheduler_id.is_nil()) {
     RAY_LOG(ERROR) << "Infeasible task. No nodes satisfy hard constraints for "
                    << "task = " << Task_task_id(task);
     // TODO(atumanov): propagate this error to the task's driver and/or
     // cache the task in case new local schedulers satisfy it in the future.
     return false;
   }
-  RAY_CHECK(!best_local_scheduler_id.is_nil())
-      << "Task is feasible, but doesn't have a local scheduler assigned.";
   // A local scheduler ID was found, so assign the task.
   assign_task_to_local_scheduler(state, task, best_local_scheduler_id);
+  update_local_scheduler_index(state, policy_state, best_local_scheduler_id);
   return true;
 }
 
@@ -244,14 +419,26 @@ void handle_object_available(GlobalSchedulerState *state,
   /* Do nothing for now. */
 }
 
+void handle_task_assigned(GlobalSchedulerState *state,
+                          GlobalSchedulerPolicyState *policy_state,
+                          DBClientID db_client_id) {
+  update_local_scheduler_index(state, policy_state, db_client_id);
+}
+
+void handle_local_scheduler_heartbeat(GlobalSchedulerState *state,
+                                      GlobalSchedulerPolicyState *policy_state,
+                                      DBClientID db_client_id) {
+  update_local_scheduler_index(state, policy_state, db_client_id);
+}
+
 void handle_new_local_scheduler(GlobalSchedulerState *state,
                                 GlobalSchedulerPolicyState *policy_state,
                                 DBClientID db_client_id) {
-  /* Do nothing for now. */
+  update_local_scheduler_index(state, policy_state, db_client_id);
 }
 
 void handle_local_scheduler_removed(GlobalSchedulerState *state,
                                     GlobalSchedulerPolicyState *policy_state,
                                     DBClientID db_client_id) {
-  /* Do nothing for now. */
+  policy_state->getLocalSchedulerIndex().Remove(db_client_id);
 }
@@ -1,7 +1,10 @@
 #ifndef GLOBAL_SCHEDULER_ALGORITHM_H
 #define GLOBAL_SCHEDULER_ALGORITHM_H
 
+#include <map>
 #include <random>
+#include <set>
+#include <unordered_map>
 
 #include "common.h"
 #include "global_scheduler.h"
@@ -21,6 +24,164 @@ typedef enum {
   SCHED_ALGORITHM_MAX
 } global_scheduler_algorithm;
 
+/// The static resources of a local scheduler, ordered by resource name so that
+/// they can be used as a key when grouping local schedulers.
+typedef std::map<std::string, double> ResourceShape;
+
+/// An index over the known local schedulers. Local schedulers are bucketed by
+/// the shape of their static resources, and each bucket is ordered by the
+/// pending cost of its members. This allows the cost policy to make a
+/// placement decision by checking the hard constraints once per distinct
+/// resource shape instead of once per local scheduler.
+class LocalSchedulerIndex {
+ public:
+  /// Insert a local scheduler into the index, or refresh its position if it is
+  /// already present. This must be called whenever the local scheduler's
+  /// static resources or load counters change.
+  ///
+  /// @param local_scheduler The local scheduler to index.
+  void Update(const LocalScheduler &local_scheduler);
+
+  /// Remove a local scheduler from the index. This is a no-op if the local
+  /// scheduler is not indexed.
+  ///
+  /// @param local_scheduler_id The ID of the local scheduler to remove.
+  void Remove(const DBClientID &local_scheduler_id);
+
+  /// Find the cheapest local scheduler that satisfies the hard constraints of
+  /// a task.
+  ///
+  /// @param spec The task specification.
+  /// @param excluded_id A local scheduler that should not be returned, e.g.,
+  ///        the one that the task was spilled back from.
+  /// @return The ID of the cheapest feasible local scheduler, or nil if no
+  ///         local scheduler satisfies the task's hard constraints.
+  DBClientID FindBest(const TaskSpec *spec,
+                      const DBClientID &excluded_id) const;
+
+  /// Return the number of indexed local schedulers.
+  ///
+  /// @return The number of indexed local schedulers.
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  /// A (cost, local scheduler ID) pair. Buckets are ordered by these.
+  typedef std::pair<double, DBClientID> CostEntry;
+
+  struct CostEntryLess {
+    bool operator()(const CostEntry &lhs, const CostEntry &rhs) const {
+      if (lhs.first != rhs.first) {
+        return lhs.first < rhs.first;
+      }
+      return memcmp(lhs.second.data(), rhs.second.data(), lhs.second.size()) <
+             0;
+    }
+  };
+
+  typedef std::set<CostEntry, CostEntryLess> Bucket;
+
+  /// Where a local scheduler currently lives in the index.
+  struct Entry {
+    /// The bucket that contains the local scheduler.
+    std::map<ResourceShape, Bucket>::iterator bucket;
+    /// The cost that the local scheduler was inserted with.
+    double cost;
+  };
+
+  /// Remove an entry from its bucket, dropping the bucket if it is now empty.
+  void EraseFromBucket(const DBClientID &local_scheduler_id,
+                       const Entry &entry);
+
+  /// The buckets of local schedulers, keyed by resource shape.
+  std::map<ResourceShape, Bucket> buckets_;
+  /// The position of every indexed local scheduler.
+  std::unordered_map<DBClientID, Entry> entries_;
+};
+
+/// The number of tasks that one placement thread has sent to each local
+/// scheduler since that local scheduler's last heartbeat. Each placement thread
+/// owns one of these, so it is never shared between threads.
+class LoadDeltas {
+ public:
+  /// Return the number of tasks sent to a local scheduler since the given
+  /// heartbeat.
+  ///
+  /// @param local_scheduler_id The ID of the local scheduler.
+  /// @param heartbeat_epoch The number of heartbeats received from the local
+  ///        scheduler at the time of the snapshot being consulted.
+  /// @return The number of tasks sent. Counts recorded before the given
+  ///         heartbeat have been merged into the heartbeat, so they are
+  ///         ignored.
+  int64_t Get(const DBClientID &local_scheduler_id,
+              int64_t heartbeat_epoch) const;
+
+  /// Record that tasks were sent to a local scheduler.
+  ///
+  /// @param local_scheduler_id The ID of the local scheduler.
+  /// @param heartbeat_epoch The number of heartbeats received from the local
+  ///        scheduler at the time of the snapshot being consulted.
+  /// @param delta The number of tasks sent. This is negative if tasks were
+  ///        spilled back from the local scheduler.
+  void Add(const DBClientID &local_scheduler_id,
+           int64_t heartbeat_epoch,
+           int64_t delta);
+
+ private:
+  /// A map from local scheduler ID to the heartbeat epoch that the delta was
+  /// recorded against and the delta itself.
+  std::unordered_map<DBClientID, std::pair<int64_t, int64_t>> deltas_;
+};
+
+/// An immutable copy of the load on every local scheduler, as of the last
+/// heartbeats. The main thread publishes a new snapshot whenever heartbeats
+/// arrive, and placement threads read it without taking a lock. See
+/// GlobalSchedulerWorkers for when a snapshot is reclaimed.
+class LoadSnapshot {
+ public:
+  /// Build a snapshot of the given local schedulers.
+  ///
+  /// @param local_schedulers The local schedulers known to the global
+  ///        scheduler.
+  LoadSnapshot(
+      const std::unordered_map<DBClientID, LocalScheduler> &local_schedulers);
+
+  /// Find the cheapest local scheduler that satisfies the hard constraints of
+  /// a task, taking the tasks recently sent by the calling thread into account.
+  ///
+  /// @param spec The task specification.
+  /// @param excluded_id A local scheduler that should not be returned.
+  /// @param deltas The tasks sent by the calling thread.
+  /// @param heartbeat_epoch If a local scheduler is found, this is set to the
+  ///        heartbeat epoch that the choice was based on.
+  /// @return The ID of the cheapest feasible local scheduler, or nil if no
+  ///         local scheduler satisfies the task's hard constraints.
+  DBClientID FindBest(const TaskSpec *spec,
+                      const DBClientID &excluded_id,
+                      const LoadDeltas &deltas,
+                      int64_t *heartbeat_epoch) const;
+
+  /// Return the heartbeat epoch of a local scheduler in this snapshot.
+  ///
+  /// @param local_scheduler_id The ID of the local scheduler.
+  /// @return The heartbeat epoch, or -1 if the local scheduler is unknown.
+  int64_t HeartbeatEpoch(const DBClientID &local_scheduler_id) const;
+
+ private:
+  struct Node {
+    DBClientID id;
+    /// The load reported by the last heartbeat.
+    double cost;
+    /// The number of heartbeats received from this local scheduler.
+    int64_t heartbeat_epoch;
+  };
+
+  /// The local schedulers grouped by resource shape, each group sorted by
+  /// ascending cost.
+  std::map<ResourceShape, std::vector<Node>> buckets_;
+  /// The heartbeat epoch of every local scheduler in the snapshot.
+  std::unordered_map<DBClientID, int64_t> heartbeat_epochs_;
+};
+
 /// The class encapsulating state managed by the global scheduling policy.
 class GlobalSchedulerPolicyState {
  public:
@@ -39,6 +200,13 @@ class GlobalSchedulerPolicyState {
   /// @return The round robin index.
   int64_t getRoundRobinIndex() const { return round_robin_index_; }
 
+  /// Return the index of local schedulers maintained by the policy.
+  ///
+  /// @return The local scheduler index.
+  LocalSchedulerIndex &getLocalSchedulerIndex() {
+    return local_scheduler_index_;
+  }
+
  private:
   /// The index of the next local scheduler to assign a task to.
   int64_t round_robin_index_;
@@ -46,6 +214,8 @@ class GlobalSchedulerPolicyState {
   std::random_device rd_;
   /// Internally maintained random number generator.
   std::mt19937_64 gen_;
+  /// Local schedulers bucketed by resource shape and ordered by cost.
+  LocalSchedulerIndex local_scheduler_index_;
 };
 
 /**
@@ -77,6 +247,21 @@ bool handle_task_waiting(GlobalSchedulerState *state,
                          GlobalSchedulerPolicyState *policy_state,
                          Task *task);
 
+/**
+ * Handle a task that a local scheduler spilled back to the global scheduler.
+ * The task is no longer queued on that local scheduler, so this takes it out of
+ * the count of tasks recently sent there. This is a no-op for tasks that were
+ * not spilled back.
+ *
+ * @param state Global scheduler state.
+ * @param policy_state State specific to the scheduling policy.
+ * @param task The task that is being placed.
+ * @return Void.
+ */
+void handle_task_spilled_back(GlobalSchedulerState *state,
+                              GlobalSchedulerPolicyState *policy_state,
+                              Task *task);
+
 /**
  * Handle the fact that a new object is available.
  *
@@ -90,15 +275,30 @@ void handle_object_available(GlobalSchedulerState *state,
                              ObjectID object_id);
 
 /**
- * Handle a heartbeat message from a local scheduler. TODO(rkn): this is a
- * placeholder for now.
+ * Handle the fact that a task was assigned to a local scheduler outside of
+ * handle_task_waiting, e.g., by one of the placement threads.
+ *
+ * @param state The global scheduler state.
+ * @param policy_state The state managed by the scheduling policy.
+ * @param db_client_id The db client ID of the local scheduler.
+ * @return Void.
+ */
+void handle_task_assigned(GlobalSchedulerState *state,
+                          GlobalSchedulerPolicyState *policy_state,
+                          DBClientID db_client_id);
+
+/**
+ * Handle a heartbeat message from a local scheduler. This is called after the
+ * cached information for the local scheduler has been updated.
  *
  * @param state The global scheduler state.
  * @param policy_state The state managed by the scheduling policy.
+ * @param db_client_id The db client ID of the local scheduler.
  * @return Void.
  */
 void handle_local_scheduler_heartbeat(GlobalSchedulerState *state,
-                                      GlobalSchedulerPolicyState *policy_state);
+                                      GlobalSchedulerPolicyState *policy_state,
+                                      DBClientID db_client_id);
 
 /**
  * Handle the presence of a new local scheduler. Currently, this just adds the
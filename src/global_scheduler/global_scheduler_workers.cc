@@ -0,0 +1,170 @@
+#include "global_scheduler_workers.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+GlobalSchedulerWorkers::GlobalSchedulerWorkers(
+    event_loop *loop,
+    int num_threads,
+    std::unique_ptr<const LoadSnapshot> snapshot,
+    const PlacementCallback &callback)
+    : loop_(loop),
+      callback_(callback),
+      snapshot_(snapshot.release()),
+      snapshot_epoch_(1) {
+  RAY_CHECK(num_threads > 0);
+  RAY_CHECK(pipe(wakeup_fds_) == 0);
+  for (int i = 0; i < 2; ++i) {
+    int flags = fcntl(wakeup_fds_[i], F_GETFL, 0);
+    RAY_CHECK(fcntl(wakeup_fds_[i], F_SETFL, flags | O_NONBLOCK) == 0);
+  }
+  event_loop_add_file(loop_, wakeup_fds_[0], EVENT_LOOP_READ,
+                      GlobalSchedulerWorkers::HandleCompletions, this);
+  for (int i = 0; i < num_threads; ++i) {
+    partitions_.emplace_back(new Partition());
+  }
+  for (auto &partition : partitions_) {
+    partition->thread = std::thread(&GlobalSchedulerWorkers::RunPartition, this,
+                                    partition.get());
+  }
+}
+
+GlobalSchedulerWorkers::~GlobalSchedulerWorkers() {
+  for (auto &partition : partitions_) {
+    {
+      std::lock_guard<std::mutex> lock(partition->mutex);
+      partition->stop = true;
+    }
+    partition->cv.notify_one();
+  }
+  for (auto &partition : partitions_) {
+    partition->thread.join();
+    for (Task *task : partition->tasks) {
+      Task_free(task);
+    }
+  }
+  for (auto &completed : completed_) {
+    Task_free(completed.first);
+  }
+  for (auto &retired : retired_snapshots_) {
+    delete retired.second;
+  }
+  delete snapshot_.load();
+  event_loop_remove_file(loop_, wakeup_fds_[0]);
+  close(wakeup_fds_[0]);
+  close(wakeup_fds_[1]);
+}
+
+void GlobalSchedulerWorkers::Submit(Task *task) {
+  size_t index = Task_task_id(task).hash() % partitions_.size();
+  Partition *partition = partitions_[index].get();
+  {
+    std::lock_guard<std::mutex> lock(partition->mutex);
+    partition->tasks.push_back(task);
+  }
+  partition->cv.notify_one();
+}
+
+void GlobalSchedulerWorkers::PublishSnapshot(
+    std::unique_ptr<const LoadSnapshot> snapshot) {
+  const LoadSnapshot *replaced = snapshot_.exchange(snapshot.release());
+  int64_t epoch = snapshot_epoch_.fetch_add(1) + 1;
+  retired_snapshots_.push_back(std::make_pair(epoch, replaced));
+  ReclaimSnapshots();
+}
+
+void GlobalSchedulerWorkers::ReclaimSnapshots() {
+  // A thread that started its batch at epoch E may be reading any snapshot
+  // that was replaced after E, but none that was replaced at or before E.
+  int64_t oldest_reader_epoch = snapshot_epoch_.load();
+  for (auto &partition : partitions_) {
+    int64_t reader_epoch = partition->reader_epoch.load();
+    if (reader_epoch != 0) {
+      oldest_reader_epoch = std::min(oldest_reader_epoch, reader_epoch);
+    }
+  }
+  auto it = retired_snapshots_.begin();
+  while (it != retired_snapshots_.end() && it->first <= oldest_reader_epoch) {
+    delete it->second;
+    it++;
+  }
+  retired_snapshots_.erase(retired_snapshots_.begin(), it);
+}
+
+void GlobalSchedulerWorkers::RunPartition(Partition *partition) {
+  std::deque<Task *> tasks;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(partition->mutex);
+      partition->cv.wait(lock, [partition] {
+        return partition->stop || !partition->tasks.empty();
+      });
+      if (partition->stop) {
+        return;
+      }
+      tasks.swap(partition->tasks);
+    }
+
+    // Place the whole batch against the same snapshot. The epoch is recorded
+    // before the snapshot is loaded, so the event loop thread does not free the
+    // snapshot while this thread reads it.
+    partition->reader_epoch.store(snapshot_epoch_.load());
+    const LoadSnapshot *snapshot = snapshot_.load();
+    for (Task *task : tasks) {
+      TaskSpec *spec = Task_task_execution_spec(task)->Spec();
+      // For tasks already seen by the global scheduler (spillback > 1), the
+      // task is no longer queued on the local scheduler it came from.
+      if (task->execution_spec->SpillbackCount() > 1) {
+        int64_t epoch = snapshot->HeartbeatEpoch(task->local_scheduler_id);
+        partition->deltas.Add(task->local_scheduler_id, epoch, -1);
+      }
+      int64_t heartbeat_epoch = 0;
+      DBClientID local_scheduler_id =
+          snapshot->FindBest(spec, task->local_scheduler_id, partition->deltas,
+                             &heartbeat_epoch);
+      if (!local_scheduler_id.is_nil()) {
+        partition->deltas.Add(local_scheduler_id, heartbeat_epoch, 1);
+      }
+      Complete(task, local_scheduler_id);
+    }
+    partition->reader_epoch.store(0);
+    tasks.clear();
+  }
+}
+
+void GlobalSchedulerWorkers::Complete(Task *task,
+                                      const DBClientID &local_scheduler_id) {
+  bool wake_up;
+  {
+    std::lock_guard<std::mutex> lock(completed_mutex_);
+    wake_up = completed_.empty();
+    completed_.push_back(std::make_pair(task, local_scheduler_id));
+  }
+  // Only the first decision in a batch needs to wake up the event loop, since
+  // the handler drains everything that has completed.
+  if (wake_up) {
+    char byte = 0;
+    ssize_t written = write(wakeup_fds_[1], &byte, 1);
+    ARROW_UNUSED(written);
+  }
+}
+
+void GlobalSchedulerWorkers::HandleCompletions(event_loop *loop,
+                                               int fd,
+                                               void *context,
+                                               int events) {
+  GlobalSchedulerWorkers *workers = (GlobalSchedulerWorkers *) context;
+  char buffer[64];
+  while (read(fd, buffer, sizeof(buffer)) > 0) {
+  }
+  std::vector<std::pair<Task *, DBClientID>> completed;
+  {
+    std::lock_guard<std::mutex> lock(workers->completed_mutex_);
+    completed.swap(workers->completed_);
+  }
+  for (auto &decision : completed) {
+    workers->callback_(decision.first, decision.second);
+  }
+}
@@ -0,0 +1,133 @@
+#ifndef GLOBAL_SCHEDULER_WORKERS_H
+#define GLOBAL_SCHEDULER_WORKERS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "event_loop.h"
+#include "global_scheduler_algorithm.h"
+#include "task.h"
+
+/// A pool of threads that place waiting tasks on local schedulers.
+///
+/// Waiting tasks are partitioned across the threads by task ID, and each thread
+/// has its own queue, so submitting a task only contends with the one thread
+/// that owns its partition. The threads read the load on the local schedulers
+/// from an immutable LoadSnapshot that the event loop thread replaces as
+/// heartbeats arrive. Each thread counts the tasks it has sent to every local
+/// scheduler since that local scheduler's last heartbeat.
+///
+/// Snapshots are reclaimed with epoch-based RCU, so the placement threads
+/// never take a lock or touch a reference count to read them. Each publish
+/// advances the snapshot epoch. A thread records the epoch when it starts on
+/// a batch of tasks and clears it when it is done. A replaced snapshot is
+/// freed once no thread is still on a batch that started before it was
+/// replaced.
+///
+/// The threads only make placement decisions. The decisions are handed back to
+/// the event loop thread, which owns the Redis connections and the global
+/// scheduler state, and which performs the actual assignment.
+class GlobalSchedulerWorkers {
+ public:
+  /// Callback that is invoked on the event loop thread with the placement
+  /// decision for a task. The local scheduler ID is nil if no local scheduler
+  /// satisfies the task's hard constraints. The callback takes ownership of the
+  /// task.
+  using PlacementCallback = std::function<void(Task *, const DBClientID &)>;
+
+  /// Start the placement threads.
+  ///
+  /// @param loop The event loop that placement decisions are delivered on.
+  /// @param num_threads The number of placement threads.
+  /// @param snapshot The load snapshot to place the first tasks with.
+  /// @param callback The callback to invoke with each placement decision.
+  GlobalSchedulerWorkers(event_loop *loop,
+                         int num_threads,
+                         std::unique_ptr<const LoadSnapshot> snapshot,
+                         const PlacementCallback &callback);
+
+  /// Stop and join the placement threads. Tasks that have not been placed yet
+  /// are freed.
+  ~GlobalSchedulerWorkers();
+
+  /// Queue a task for placement. This must be called from the event loop
+  /// thread.
+  ///
+  /// @param task The task to place. The workers take ownership of the task.
+  void Submit(Task *task);
+
+  /// Replace the load snapshot that the placement threads consult. This must be
+  /// called from the event loop thread.
+  ///
+  /// @param snapshot The new snapshot.
+  void PublishSnapshot(std::unique_ptr<const LoadSnapshot> snapshot);
+
+  /// Free the replaced snapshots that no placement thread can still be
+  /// reading. This must be called from the event loop thread.
+  void ReclaimSnapshots();
+
+  /// Return the number of placement threads.
+  ///
+  /// @return The number of placement threads.
+  int NumThreads() const { return partitions_.size(); }
+
+ private:
+  /// The state owned by a single placement thread.
+  struct Partition {
+    /// Protects the task queue and the stop flag.
+    std::mutex mutex;
+    std::condition_variable cv;
+    /// The tasks waiting to be placed by this thread.
+    std::deque<Task *> tasks;
+    /// Whether the thread should exit.
+    bool stop = false;
+    /// The snapshot epoch when the thread started on its current batch of
+    /// tasks, or 0 if it is not placing any tasks.
+    std::atomic<int64_t> reader_epoch{0};
+    /// The tasks this thread has sent to each local scheduler. Only accessed by
+    /// the thread itself.
+    LoadDeltas deltas;
+    std::thread thread;
+  };
+
+  /// The body of a placement thread.
+  void RunPartition(Partition *partition);
+
+  /// Hand a placement decision back to the event loop thread.
+  void Complete(Task *task, const DBClientID &local_scheduler_id);
+
+  /// Event loop handler that drains the completed placement decisions.
+  static void HandleCompletions(event_loop *loop,
+                                int fd,
+                                void *context,
+                                int events);
+
+  /// The event loop that placement decisions are delivered on.
+  event_loop *loop_;
+  /// The callback to invoke with each placement decision.
+  PlacementCallback callback_;
+  /// The current load snapshot, which is owned by this object.
+  std::atomic<const LoadSnapshot *> snapshot_;
+  /// The number of snapshots published so far, including the first one.
+  std::atomic<int64_t> snapshot_epoch_;
+  /// The snapshots that were replaced, each with the epoch that replaced it.
+  /// Only accessed by the event loop thread.
+  std::vector<std::pair<int64_t, const LoadSnapshot *>> retired_snapshots_;
+  /// One partition per placement thread.
+  std::vector<std::unique_ptr<Partition>> partitions_;
+  /// Protects the completed placement decisions.
+  std::mutex completed_mutex_;
+  /// Placement decisions that have not been delivered to the callback yet.
+  std::vector<std::pair<Task *, DBClientID>> completed_;
+  /// A pipe used to wake up the event loop when decisions are completed. The
+  /// placement threads write to the second descriptor.
+  int wakeup_fds_[2];
+};
+
+#endif /* GLOBAL_SCHEDULER_WORKERS_H */
@@ -0,0 +1,128 @@
+#include "greatest.h"
+
+#include <chrono>
+#include <vector>
+
+#include "common.h"
+#include "event_loop.h"
+#include "task.h"
+#include "test/example_task.h"
+
+#include "global_scheduler.h"
+#include "global_scheduler_algorithm.h"
+#include "global_scheduler_workers.h"
+#include "global_scheduler_test_util.h"
+
+/* Benchmarks for the global scheduler's placement. These are kept out of
+ * global_scheduler_tests so that the tests stay fast under valgrind. */
+
+SUITE(global_scheduler_benchmarks);
+
+TaskBuilder *g_task_builder = NULL;
+
+/* Replay a stream of placement decisions interleaved with heartbeats against a
+ * large cluster and report the decision rate. */
+TEST local_scheduler_index_replay_benchmark(void) {
+  const int num_nodes = 1000;
+  const int num_decisions = 100000;
+  LocalSchedulerIndex index;
+  std::vector<LocalScheduler> nodes;
+  for (int i = 0; i < num_nodes; ++i) {
+    nodes.push_back(make_local_scheduler(4 + (i % 4) * 4, i % 8 == 0, i % 16));
+    index.Update(nodes.back());
+  }
+  std::vector<TaskSpec *> specs = {
+      task_spec_with_resources({{"CPU", 1}}),
+      task_spec_with_resources({{"CPU", 8}}),
+      task_spec_with_resources({{"CPU", 1}, {"GPU", 1}})};
+
+  std::unordered_map<DBClientID, LocalScheduler *> nodes_by_id;
+  for (auto &node : nodes) {
+    nodes_by_id[node.id] = &node;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_decisions; ++i) {
+    DBClientID best =
+        index.FindBest(specs[i % specs.size()], DBClientID::nil());
+    ASSERT(!best.is_nil());
+    LocalScheduler *node = nodes_by_id[best];
+    node->num_recent_tasks_sent += 1;
+    index.Update(*node);
+    /* Every node sends a heartbeat once per num_nodes decisions. */
+    LocalScheduler &heartbeat = nodes[i % num_nodes];
+    heartbeat.num_recent_tasks_sent = 0;
+    heartbeat.info.task_queue_length = i % 16;
+    index.Update(heartbeat);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  printf("%d placement decisions over %d nodes: %.0f decisions per second\n",
+         num_decisions, num_nodes, num_decisions / seconds);
+
+  for (auto spec : specs) {
+    TaskSpec_free(spec);
+  }
+  PASS();
+}
+
+/* Submit a burst of waiting tasks to the placement threads and report the
+ * placement rate for increasing numbers of threads. */
+TEST placement_threads_scaling_benchmark(void) {
+  const int num_nodes = 1000;
+  const int num_tasks = 100000;
+  std::unordered_map<DBClientID, LocalScheduler> local_schedulers;
+  for (int i = 0; i < num_nodes; ++i) {
+    LocalScheduler local_scheduler =
+        make_local_scheduler(4 + (i % 4) * 4, i % 8 == 0, i % 16);
+    local_schedulers[local_scheduler.id] = local_scheduler;
+  }
+  for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+    std::vector<Task *> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+      tasks.push_back(example_task(1, 1, TASK_STATUS_WAITING));
+    }
+    PlacementDriver driver = {event_loop_create(), num_tasks, 0};
+    PlacementDriver *driver_ptr = &driver;
+    GlobalSchedulerWorkers *workers = new GlobalSchedulerWorkers(
+        driver.loop, num_threads,
+        std::unique_ptr<const LoadSnapshot>(new LoadSnapshot(local_schedulers)),
+        [driver_ptr](Task *task, const DBClientID &local_scheduler_id) {
+          RAY_CHECK(!local_scheduler_id.is_nil());
+          Task_free(task);
+          driver_ptr->num_placed += 1;
+          if (driver_ptr->num_placed == driver_ptr->num_expected) {
+            event_loop_stop(driver_ptr->loop);
+          }
+        });
+
+    auto start = std::chrono::steady_clock::now();
+    for (Task *task : tasks) {
+      workers->Submit(task);
+    }
+    event_loop_run(driver.loop);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%d placement threads: %.0f tasks per second\n", num_threads,
+           num_tasks / seconds);
+
+    ASSERT_EQ(driver.num_placed, num_tasks);
+    delete workers;
+    event_loop_destroy(driver.loop);
+  }
+  PASS();
+}
+
+SUITE(global_scheduler_benchmarks) {
+  RUN_TEST(local_scheduler_index_replay_benchmark);
+  RUN_TEST(placement_threads_scaling_benchmark);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char **argv) {
+  g_task_builder = make_task_builder();
+  GREATEST_MAIN_BEGIN();
+  RUN_SUITE(global_scheduler_benchmarks);
+  GREATEST_MAIN_END();
+}
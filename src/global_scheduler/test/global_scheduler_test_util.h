@@ -0,0 +1,63 @@
+#ifndef GLOBAL_SCHEDULER_TEST_UTIL_H
+#define GLOBAL_SCHEDULER_TEST_UTIL_H
+
+#include <string>
+#include <unordered_map>
+
+#include "common.h"
+#include "event_loop.h"
+#include "task.h"
+
+#include "global_scheduler.h"
+
+extern TaskBuilder *g_task_builder;
+
+/**
+ * Create a task spec that requires the given resources. The returned spec must
+ * be freed with TaskSpec_free.
+ */
+static inline TaskSpec *task_spec_with_resources(
+    const std::unordered_map<std::string, double> &resources) {
+  TaskSpec_start_construct(g_task_builder, UniqueID::nil(),
+                           TaskID::from_random(), 0, ActorID::nil(),
+                           ObjectID::nil(), ActorID::nil(), ActorID::nil(), 0,
+                           false, FunctionID::from_random(), 1);
+  for (auto const &resource_pair : resources) {
+    TaskSpec_set_required_resource(g_task_builder, resource_pair.first,
+                                   resource_pair.second);
+  }
+  int64_t size;
+  return TaskSpec_finish_construct(g_task_builder, &size);
+}
+
+/**
+ * Create a local scheduler with the given resources and reported task queue
+ * length.
+ */
+static inline LocalScheduler make_local_scheduler(double num_cpus,
+                                                  double num_gpus,
+                                                  int task_queue_length) {
+  LocalScheduler local_scheduler;
+  local_scheduler.id = DBClientID::from_random();
+  local_scheduler.num_heartbeats_missed = 0;
+  local_scheduler.num_tasks_sent = 0;
+  local_scheduler.num_recent_tasks_sent = 0;
+  local_scheduler.num_heartbeats_received = 0;
+  local_scheduler.info.total_num_workers = 0;
+  local_scheduler.info.task_queue_length = task_queue_length;
+  local_scheduler.info.available_workers = 0;
+  local_scheduler.info.static_resources["CPU"] = num_cpus;
+  local_scheduler.info.static_resources["GPU"] = num_gpus;
+  local_scheduler.info.is_dead = false;
+  return local_scheduler;
+}
+
+/* The synthetic driver for the placement threads. The counters are only
+ * accessed on the event loop thread. */
+typedef struct {
+  event_loop *loop;
+  int num_expected;
+  int num_placed;
+} PlacementDriver;
+
+#endif /* GLOBAL_SCHEDULER_TEST_UTIL_H */
@@ -0,0 +1,156 @@
+#include "greatest.h"
+
+#include <vector>
+
+#include "common.h"
+#include "event_loop.h"
+#include "task.h"
+#include "test/example_task.h"
+
+#include "global_scheduler.h"
+#include "global_scheduler_algorithm.h"
+#include "global_scheduler_workers.h"
+#include "global_scheduler_test_util.h"
+
+SUITE(global_scheduler_tests);
+
+TaskBuilder *g_task_builder = NULL;
+
+/* Test that the index returns the cheapest local scheduler that satisfies the
+ * task's hard constraints, and that it follows updates and removals. */
+TEST local_scheduler_index_test(void) {
+  LocalSchedulerIndex index;
+  LocalScheduler cpu_busy = make_local_scheduler(4, 0, 10);
+  LocalScheduler cpu_idle = make_local_scheduler(4, 0, 1);
+  LocalScheduler gpu_busy = make_local_scheduler(4, 1, 5);
+  LocalScheduler no_cpus = make_local_scheduler(0, 0, 0);
+  index.Update(cpu_busy);
+  index.Update(cpu_idle);
+  index.Update(gpu_busy);
+  index.Update(no_cpus);
+  ASSERT_EQ(index.Size(), 4);
+
+  TaskSpec *cpu_task = task_spec_with_resources({{"CPU", 1}});
+  TaskSpec *gpu_task = task_spec_with_resources({{"CPU", 1}, {"GPU", 1}});
+  TaskSpec *big_task = task_spec_with_resources({{"CPU", 8}});
+
+  /* The cheapest feasible node wins, across resource shapes. */
+  ASSERT(index.FindBest(cpu_task, DBClientID::nil()) == cpu_idle.id);
+  ASSERT(index.FindBest(gpu_task, DBClientID::nil()) == gpu_busy.id);
+  ASSERT(index.FindBest(big_task, DBClientID::nil()).is_nil());
+  /* The excluded node is skipped. */
+  ASSERT(index.FindBest(cpu_task, cpu_idle.id) == gpu_busy.id);
+  ASSERT(index.FindBest(gpu_task, gpu_busy.id).is_nil());
+
+  /* Load updates reorder the bucket. */
+  cpu_idle.num_recent_tasks_sent = 20;
+  index.Update(cpu_idle);
+  ASSERT(index.FindBest(cpu_task, DBClientID::nil()) == gpu_busy.id);
+  /* A change of resource shape moves the node to a different bucket. */
+  cpu_idle.info.static_resources["CPU"] = 8;
+  index.Update(cpu_idle);
+  ASSERT_EQ(index.Size(), 4);
+  ASSERT(index.FindBest(big_task, DBClientID::nil()) == cpu_idle.id);
+
+  index.Remove(cpu_idle.id);
+  index.Remove(cpu_idle.id);
+  ASSERT_EQ(index.Size(), 3);
+  ASSERT(index.FindBest(big_task, DBClientID::nil()).is_nil());
+
+  TaskSpec_free(cpu_task);
+  TaskSpec_free(gpu_task);
+  TaskSpec_free(big_task);
+  PASS();
+}
+
+/* Test that the per-thread task counts are dropped once a heartbeat arrives. */
+TEST load_deltas_test(void) {
+  LoadDeltas deltas;
+  DBClientID local_scheduler_id = DBClientID::from_random();
+  ASSERT_EQ(deltas.Get(local_scheduler_id, 0), 0);
+  deltas.Add(local_scheduler_id, 0, 1);
+  deltas.Add(local_scheduler_id, 0, 1);
+  ASSERT_EQ(deltas.Get(local_scheduler_id, 0), 2);
+  ASSERT_EQ(deltas.Get(local_scheduler_id, 1), 0);
+  deltas.Add(local_scheduler_id, 1, 1);
+  ASSERT_EQ(deltas.Get(local_scheduler_id, 1), 1);
+  ASSERT_EQ(deltas.Get(local_scheduler_id, 0), 0);
+  PASS();
+}
+
+/* Test that a placement thread spreads tasks across equally loaded local
+ * schedulers using its own task counts. */
+TEST load_snapshot_test(void) {
+  std::unordered_map<DBClientID, LocalScheduler> local_schedulers;
+  for (int i = 0; i < 2; ++i) {
+    LocalScheduler local_scheduler = make_local_scheduler(4, 0, 0);
+    local_schedulers[local_scheduler.id] = local_scheduler;
+  }
+  LoadSnapshot snapshot(local_schedulers);
+  LoadDeltas deltas;
+  TaskSpec *spec = task_spec_with_resources({{"CPU", 1}});
+  int64_t epoch = -1;
+  DBClientID first = snapshot.FindBest(spec, DBClientID::nil(), deltas, &epoch);
+  ASSERT_EQ(epoch, 0);
+  deltas.Add(first, epoch, 1);
+  DBClientID second =
+      snapshot.FindBest(spec, DBClientID::nil(), deltas, &epoch);
+  ASSERT(!first.is_nil() && !second.is_nil());
+  ASSERT_FALSE(first == second);
+  ASSERT(snapshot.FindBest(spec, second, deltas, &epoch) == first);
+  ASSERT_EQ(snapshot.HeartbeatEpoch(DBClientID::from_random()), -1);
+  TaskSpec_free(spec);
+  PASS();
+}
+
+
+/* Test that the placement threads place tasks with the snapshot they start
+ * with, and keep placing them while new snapshots replace the old ones. */
+TEST placement_threads_test(void) {
+  const int num_tasks = 1000;
+  std::unordered_map<DBClientID, LocalScheduler> local_schedulers;
+  LocalScheduler local_scheduler = make_local_scheduler(4, 0, 0);
+  local_schedulers[local_scheduler.id] = local_scheduler;
+  PlacementDriver driver = {event_loop_create(), num_tasks, 0};
+  PlacementDriver *driver_ptr = &driver;
+  GlobalSchedulerWorkers *workers = new GlobalSchedulerWorkers(
+      driver.loop, 4,
+      std::unique_ptr<const LoadSnapshot>(new LoadSnapshot(local_schedulers)),
+      [driver_ptr](Task *task, const DBClientID &local_scheduler_id) {
+        RAY_CHECK(!local_scheduler_id.is_nil());
+        Task_free(task);
+        driver_ptr->num_placed += 1;
+        if (driver_ptr->num_placed == driver_ptr->num_expected) {
+          event_loop_stop(driver_ptr->loop);
+        }
+      });
+  for (int i = 0; i < num_tasks; ++i) {
+    workers->Submit(example_task(1, 1, TASK_STATUS_WAITING));
+    if (i % 10 == 0) {
+      workers->PublishSnapshot(std::unique_ptr<const LoadSnapshot>(
+          new LoadSnapshot(local_schedulers)));
+    }
+  }
+  event_loop_run(driver.loop);
+  workers->ReclaimSnapshots();
+  ASSERT_EQ(driver.num_placed, num_tasks);
+  delete workers;
+  event_loop_destroy(driver.loop);
+  PASS();
+}
+
+SUITE(global_scheduler_tests) {
+  RUN_TEST(local_scheduler_index_test);
+  RUN_TEST(load_deltas_test);
+  RUN_TEST(load_snapshot_test);
+  RUN_TEST(placement_threads_test);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char **argv) {
+  g_task_builder = make_task_builder();
+  GREATEST_MAIN_BEGIN();
+  RUN_SUITE(global_scheduler_tests);
+  GREATEST_MAIN_END();
+}
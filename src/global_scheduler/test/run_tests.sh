@@ -0,0 +1,8 @@
+#!/usr/bin/env bash
+
+# This needs to be run in the build tree, which is normally ray/build
+
+# Cause the script to exit if a single command fails.
+set -e
+
+./src/global_scheduler/global_scheduler_tests
@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+
+# This needs to be run in the build tree, which is normally ray/build
+
+set -x
+
+# Cause the script to exit if a single command fails.
+set -e
+
+valgrind --track-origins=yes --leak-check=full --show-leak-kinds=all --leak-check-heuristics=stdstring --error-exitcode=1 ./src/global_scheduler/global_scheduler_tests
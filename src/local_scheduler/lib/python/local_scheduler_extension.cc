@@ -3,6 +3,7 @@
 #include "common_extension.h"
 #include "config_extension.h"
 #include "local_scheduler_client.h"
+#include "state/ray_config.h"
 #include "task.h"
 
 PyObject *LocalSchedulerError;
@@ -20,14 +21,21 @@ static int PyLocalSchedulerClient_init(PyLocalSchedulerClient *self,
   char *socket_name;
   UniqueID client_id;
   PyObject *is_worker;
-  if (!PyArg_ParseTuple(args, "sO&O", &socket_name, PyStringToUniqueID,
-                        &client_id, &is_worker)) {
+  PyObject *use_raylet = NULL;
+  if (!PyArg_ParseTuple(args, "sO&O|O", &socket_name, PyStringToUniqueID,
+                        &client_id, &is_worker, &use_raylet)) {
     self->local_scheduler_connection = NULL;
     return -1;
   }
   /* Connect to the local scheduler. */
   self->local_scheduler_connection = LocalSchedulerConnection_init(
       socket_name, client_id, (bool) PyObject_IsTrue(is_worker));
+  /* Only the raylet can read messages from a submission ring. */
+  int64_t ring_bytes = RayConfig::instance().worker_submission_ring_bytes();
+  if (use_raylet != NULL && PyObject_IsTrue(use_raylet) && ring_bytes > 0) {
+    local_scheduler_use_submission_ring(self->local_scheduler_connection,
+                                        ring_bytes);
+  }
   return 0;
 }
 
@@ -44,6 +52,7 @@ static PyObject *PyLocalSchedulerClient_disconnect(PyObject *self) {
   Py_RETURN_NONE;
 }
 
+// clang-format off
 static PyObject *PyLocalSchedulerClient_submit(PyObject *self, PyObject *args) {
   PyObject *py_task;
   if (!PyArg_ParseTuple(args, "O", &py_task)) {
@@ -54,33 +63,132 @@ static PyObject *PyLocalSchedulerClient_submit(PyObject *self, PyObject *args) {
           ->local_scheduler_connection;
   PyTask *task = reinterpret_cast<PyTask *>(py_task);
 
+  int status;
+  /* Write the task without the GIL, since this waits if the local scheduler
+   * has not made room for it in the submission ring yet. */
+  Py_BEGIN_ALLOW_THREADS
   if (!use_raylet(task)) {
     TaskExecutionSpec execution_spec = TaskExecutionSpec(
         *task->execution_dependencies, task->spec, task->size);
-    local_scheduler_submit(connection, execution_spec);
+    status = local_scheduler_submit(connection, execution_spec);
   } else {
-    local_scheduler_submit_raylet(connection, *task->execution_dependencies,
-                                  *task->task_spec);
+    status = local_scheduler_submit_raylet(
+        connection, *task->execution_dependencies, *task->task_spec);
+  }
+  Py_END_ALLOW_THREADS
+  if (status != 0) {
+    PyErr_SetString(CommonError,
+                    "Failed to submit the task to the local scheduler");
+    return NULL;
   }
 
   Py_RETURN_NONE;
 }
 
-// clang-format off
+static PyObject *PyLocalSchedulerClient_submit_batch(PyObject *self,
+                                                     PyObject *args) {
+  PyObject *py_tasks;
+  if (!PyArg_ParseTuple(args, "O", &py_tasks)) {
+    return NULL;
+  }
+  PyObject *sequence =
+      PySequence_Fast(py_tasks, "submit_batch expects a sequence of tasks");
+  if (sequence == NULL) {
+    return NULL;
+  }
+  LocalSchedulerConnection *connection =
+      reinterpret_cast<PyLocalSchedulerClient *>(self)
+          ->local_scheduler_connection;
+
+  /* Hold a reference to each task, since another thread may modify the
+   * sequence once the GIL is released. */
+  Py_ssize_t num_tasks = PySequence_Fast_GET_SIZE(sequence);
+  std::vector<PyTask *> tasks;
+  tasks.reserve(num_tasks);
+  bool raylet = false;
+  for (Py_ssize_t i = 0; i < num_tasks; ++i) {
+    PyObject *item = PySequence_Fast_GET_ITEM(sequence, i);
+    if (!PyObject_TypeCheck(item, &PyTaskType)) {
+      PyErr_SetString(PyExc_TypeError, "submit_batch expects Task objects");
+      break;
+    }
+    PyTask *task = reinterpret_cast<PyTask *>(item);
+    if (i == 0) {
+      raylet = use_raylet(task);
+    } else if (use_raylet(task) != raylet) {
+      PyErr_SetString(PyExc_ValueError,
+                      "submit_batch cannot mix raylet and non-raylet tasks");
+      break;
+    }
+    Py_INCREF(item);
+    tasks.push_back(task);
+  }
+  Py_DECREF(sequence);
+
+  if (!PyErr_Occurred() && !tasks.empty()) {
+    int status;
+    /* Build the batch and write it without the GIL, so that other Python
+     * threads can run while the message is serialized and sent. */
+    Py_BEGIN_ALLOW_THREADS
+    if (!raylet) {
+      std::vector<TaskExecutionSpec> execution_specs;
+      execution_specs.reserve(tasks.size());
+      for (PyTask *task : tasks) {
+        execution_specs.emplace_back(*task->execution_dependencies,
+                                     task->spec, task->size);
+      }
+      status = local_scheduler_submit_batch(connection, execution_specs);
+    } else {
+      std::vector<std::vector<ObjectID>> execution_dependencies;
+      std::vector<ray::raylet::TaskSpecification> task_specs;
+      execution_dependencies.reserve(tasks.size());
+      task_specs.reserve(tasks.size());
+      for (PyTask *task : tasks) {
+        execution_dependencies.push_back(*task->execution_dependencies);
+        task_specs.push_back(*task->task_spec);
+      }
+      status = local_scheduler_submit_batch_raylet(
+          connection, execution_dependencies, task_specs);
+    }
+    Py_END_ALLOW_THREADS
+    if (status != 0) {
+      PyErr_SetString(CommonError,
+                      "Failed to submit the tasks to the local scheduler");
+    }
+  }
+
+  for (PyTask *task : tasks) {
+    Py_DECREF(task);
+  }
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
 static PyObject *PyLocalSchedulerClient_get_task(PyObject *self) {
   TaskSpec *task_spec;
   int64_t task_size;
+  uint8_t *buffer;
   /* Drop the global interpreter lock while we get a task because
    * local_scheduler_get_task may block for a long time. */
   Py_BEGIN_ALLOW_THREADS
-  task_spec = local_scheduler_get_task(
+  task_spec = local_scheduler_get_task_zero_copy(
       ((PyLocalSchedulerClient *) self)->local_scheduler_connection,
-      &task_size);
+      &task_size, &buffer);
   Py_END_ALLOW_THREADS
-  return PyTask_make(task_spec, task_size);
+  /* The task refers to the message that it arrived in, so it takes ownership
+   * of the message instead of copying the task out of it. */
+  return PyTask_make(task_spec, task_size, buffer);
 }
 // clang-format on
 
+static PyObject *PyLocalSchedulerClient_prefetch_task(PyObject *self) {
+  local_scheduler_prefetch_task(
+      ((PyLocalSchedulerClient *) self)->local_scheduler_connection);
+  Py_RETURN_NONE;
+}
+
 static PyObject *PyLocalSchedulerClient_reconstruct_object(PyObject *self,
                                                            PyObject *args) {
   ObjectID object_id;
@@ -184,8 +292,15 @@ static PyMethodDef PyLocalSchedulerClient_methods[] = {
      "Notify the local scheduler that this client is exiting gracefully."},
     {"submit", (PyCFunction) PyLocalSchedulerClient_submit, METH_VARARGS,
      "Submit a task to the local scheduler."},
+    {"submit_batch", (PyCFunction) PyLocalSchedulerClient_submit_batch,
+     METH_VARARGS,
+     "Submit a sequence of tasks to the local scheduler in one message."},
     {"get_task", (PyCFunction) PyLocalSchedulerClient_get_task, METH_NOARGS,
      "Get a task from the local scheduler."},
+    {"prefetch_task", (PyCFunction) PyLocalSchedulerClient_prefetch_task,
+     METH_NOARGS,
+     "Ask the local scheduler to send the next task before the current one "
+     "finishes."},
     {"reconstruct_object",
      (PyCFunction) PyLocalSchedulerClient_reconstruct_object, METH_VARARGS,
      "Ask the local scheduler to reconstruct an object."},
@@ -20,6 +20,7 @@
 #include "local_scheduler.h"
 #include "local_scheduler_algorithm.h"
 #include "net.h"
+#include "profile_events.h"
 #include "state/actor_notification_table.h"
 #include "state/db.h"
 #include "state/db_client_table.h"
@@ -216,6 +217,9 @@ void LocalSchedulerState_free(LocalSchedulerState *state) {
     state->config.start_worker_command = NULL;
   }
 
+  /* Write out the remaining profiling events, if they are being recorded. */
+  profile_events_stop();
+
   /* Free the algorithm state. */
   SchedulingAlgorithmState_free(state->algorithm_state);
   state->algorithm_state = NULL;
@@ -399,6 +403,7 @@ LocalSchedulerState *LocalSchedulerState_init(
 
   /* Initialize the time at which the previous heartbeat was sent. */
   state->previous_heartbeat_time = current_time_ms();
+  state->reconstruction_stats = {0, 0, 0, 0};
 
   return state;
 }
@@ -552,6 +557,9 @@ void assign_task_to_worker(LocalSchedulerState *state,
    * process_message when the worker sends a GetTask message to the local
    * scheduler. */
   worker->task_in_progress = Task_copy(task);
+  worker->task_start_time_us = profile_event_time_us();
+  profile_event_record(PROFILE_EVENT_ASSIGN_TASK, TaskSpec_task_id(spec),
+                       worker->task_start_time_us, 0);
   /* Update the global task table. */
   if (state->db != NULL) {
 #if !RAY_USE_NEW_GCS
@@ -573,6 +581,9 @@ void allow_task_table_update_failure(UniqueID id,
 void finish_task(LocalSchedulerState *state, LocalSchedulerClient *worker) {
   if (worker->task_in_progress != NULL) {
     TaskSpec *spec = Task_task_execution_spec(worker->task_in_progress)->Spec();
+    profile_event_record(PROFILE_EVENT_EXECUTE_TASK, TaskSpec_task_id(spec),
+                         worker->task_start_time_us,
+                         profile_event_time_us() - worker->task_start_time_us);
     // Return dynamic resources back for the task in progress.
     if (TaskSpec_is_actor_creation_task(spec)) {
       // Resources required by the actor creation task are acquired for the
@@ -673,6 +684,51 @@ void process_plasma_notification(event_loop *loop,
   free(notification);
 }
 
+/**
+ * Start as many queued reconstructions as the in-flight limit allows. The GCS
+ * lookups for all of them are sent in the same event loop iteration, so the
+ * Redis client pipelines them instead of waiting for each reply in turn.
+ *
+ * @param state The local scheduler state.
+ * @return Void.
+ */
+void start_queued_reconstructions(LocalSchedulerState *state);
+
+/**
+ * Mark the end of the lookups for an object's reconstruction. If the object's
+ * creating task needs to be claimed, the reconstruction continues under the
+ * task's ID.
+ *
+ * @param state The local scheduler state.
+ * @param object_id The ID of the object.
+ * @return Void.
+ */
+void finish_object_reconstruction(LocalSchedulerState *state,
+                                  ObjectID object_id) {
+  state->objects_being_reconstructed.erase(object_id);
+  start_queued_reconstructions(state);
+}
+
+/**
+ * Mark the end of an attempt to claim a task for re-execution.
+ *
+ * @param state The local scheduler state.
+ * @param task_id The ID of the task.
+ * @param resubmitted Whether the task was resubmitted.
+ * @return Void.
+ */
+void finish_task_reconstruction(LocalSchedulerState *state,
+                                TaskID task_id,
+                                bool resubmitted) {
+  state->tasks_being_reconstructed.erase(task_id);
+  if (resubmitted) {
+    state->reconstruction_stats.num_resubmitted++;
+  } else {
+    state->reconstruction_stats.num_suppressed++;
+  }
+  start_queued_reconstructions(state);
+}
+
 void reconstruct_task_update_callback(Task *task,
                                       void *user_context,
                                       bool updated) {
@@ -703,10 +759,12 @@ void reconstruct_task_update_callback(Task *task,
             }));
         Task_free(task);
 #endif
+        return;
       }
     }
     /* The test-and-set failed, so it is not safe to resubmit the task for
      * execution. Suppress the request. */
+    finish_task_reconstruction(state, Task_task_id(task), false);
     return;
   }
 
@@ -720,7 +778,10 @@ void reconstruct_task_update_callback(Task *task,
     handle_actor_task_submitted(state, state->algorithm_state, *execution_spec);
   }
 
-  /* Recursively reconstruct the task's inputs, if necessary. */
+  /* Recursively reconstruct the task's inputs, if necessary. The inputs are
+   * queued behind the objects that were requested before them, so each level
+   * of the lineage is looked up as one wave. */
+  finish_task_reconstruction(state, TaskSpec_task_id(spec), true);
   int64_t num_dependencies = execution_spec->NumDependencies();
   for (int64_t i = 0; i < num_dependencies; ++i) {
     int count = execution_spec->DependencyIdCount(i);
@@ -761,6 +822,7 @@ void reconstruct_put_task_update_callback(Task *task,
             }));
         Task_free(task);
 #endif
+        return;
       } else if (Task_state(task) == TASK_STATUS_RUNNING) {
         /* (1) The task is still executing on a live node. The object created
          * by `ray.put` was not able to be reconstructed, and the workload will
@@ -787,6 +849,7 @@ void reconstruct_put_task_update_callback(Task *task,
       push_error(state->db, TaskSpec_driver_id(spec),
                  PUT_RECONSTRUCTION_ERROR_INDEX, error_message.str());
     }
+    finish_task_reconstruction(state, Task_task_id(task), false);
   } else {
     /* The update to TASK_STATUS_RECONSTRUCTING succeeded, so continue with
      * reconstruction as usual. */
@@ -801,6 +864,13 @@ void reconstruct_evicted_result_lookup_callback(ObjectID reconstruct_object_id,
   RAY_CHECK(!task_id.is_nil())
       << "No task information found for object during reconstruction";
   LocalSchedulerState *state = (LocalSchedulerState *) user_context;
+  /* Objects created by the same task share a single claim on the task. */
+  bool first_claim = state->tasks_being_reconstructed.insert(task_id).second;
+  finish_object_reconstruction(state, reconstruct_object_id);
+  if (!first_claim) {
+    state->reconstruction_stats.num_deduplicated++;
+    return;
+  }
 
   task_table_test_and_update_callback done_callback;
   if (is_put) {
@@ -840,6 +910,7 @@ void reconstruct_failed_result_lookup_callback(ObjectID reconstruct_object_id,
                                                TaskID task_id,
                                                bool is_put,
                                                void *user_context) {
+  LocalSchedulerState *state = (LocalSchedulerState *) user_context;
   if (task_id.is_nil()) {
     /* NOTE(swang): For some reason, the result table update sometimes happens
      * after this lookup returns, possibly due to concurrent clients. In most
@@ -847,9 +918,17 @@ void reconstruct_failed_result_lookup_callback(ObjectID reconstruct_object_id,
      * pending, so for now, we log a warning and suppress reconstruction. */
     RAY_LOG(WARNING) << "No task information found for object during "
                      << "reconstruction (no object entry yet)";
+    state->reconstruction_stats.num_suppressed++;
+    finish_object_reconstruction(state, reconstruct_object_id);
+    return;
+  }
+  /* Objects created by the same task share a single claim on the task. */
+  bool first_claim = state->tasks_being_reconstructed.insert(task_id).second;
+  finish_object_reconstruction(state, reconstruct_object_id);
+  if (!first_claim) {
+    state->reconstruction_stats.num_deduplicated++;
     return;
   }
-  LocalSchedulerState *state = (LocalSchedulerState *) user_context;
   /* If the task failed to finish, it's safe for us to claim responsibility for
    * reconstruction. */
 #if !RAY_USE_NEW_GCS
@@ -905,22 +984,72 @@ void reconstruct_object_lookup_callback(
       result_table_lookup(state->db, reconstruct_object_id, NULL,
                           reconstruct_evicted_result_lookup_callback,
                           (void *) state);
+    } else {
+      state->reconstruction_stats.num_suppressed++;
+      finish_object_reconstruction(state, reconstruct_object_id);
+    }
+  }
+}
+
+void start_queued_reconstructions(LocalSchedulerState *state) {
+  int64_t max_in_flight =
+      RayConfig::instance().max_reconstructions_in_flight();
+  while (!state->queued_reconstructions.empty() &&
+         static_cast<int64_t>(state->objects_being_reconstructed.size() +
+                              state->tasks_being_reconstructed.size()) <
+             max_in_flight) {
+    ObjectID object_id = state->queued_reconstructions.front();
+    state->queued_reconstructions.pop_front();
+    state->queued_reconstruction_ids.erase(object_id);
+    /* The object may have appeared while it was queued. */
+    if (object_locally_available(state->algorithm_state, object_id)) {
+      state->reconstruction_stats.num_suppressed++;
+      continue;
     }
+    RAY_LOG(DEBUG) << "Starting reconstruction";
+    state->objects_being_reconstructed.insert(object_id);
+    /* Determine if reconstruction is necessary by checking if the object
+     * exists on a node. */
+    RAY_CHECK(state->db != NULL);
+    object_table_lookup(state->db, object_id, NULL,
+                        reconstruct_object_lookup_callback, (void *) state);
   }
 }
 
+bool object_reconstruction_pending(LocalSchedulerState *state,
+                                   ObjectID object_id) {
+  return state->queued_reconstruction_ids.count(object_id) > 0 ||
+         state->objects_being_reconstructed.count(object_id) > 0;
+}
+
 void reconstruct_object(LocalSchedulerState *state,
                         ObjectID reconstruct_object_id) {
-  RAY_LOG(DEBUG) << "Starting reconstruction";
   /* If the object is locally available, no need to reconstruct. */
   if (object_locally_available(state->algorithm_state, reconstruct_object_id)) {
     return;
   }
-  /* Determine if reconstruction is necessary by checking if the object exists
-   * on a node. */
-  RAY_CHECK(state->db != NULL);
-  object_table_lookup(state->db, reconstruct_object_id, NULL,
-                      reconstruct_object_lookup_callback, (void *) state);
+  state->reconstruction_stats.num_requested++;
+  if (object_reconstruction_pending(state, reconstruct_object_id)) {
+    state->reconstruction_stats.num_deduplicated++;
+    return;
+  }
+  profile_event_record(PROFILE_EVENT_RECONSTRUCT_OBJECT, reconstruct_object_id,
+                       profile_event_time_us(), 0);
+  state->queued_reconstructions.push_back(reconstruct_object_id);
+  state->queued_reconstruction_ids.insert(reconstruct_object_id);
+  start_queued_reconstructions(state);
+}
+
+void print_reconstruction_progress(LocalSchedulerState *state) {
+  const ReconstructionStats &stats = state->reconstruction_stats;
+  RAY_LOG(INFO) << "Reconstruction progress: " << stats.num_resubmitted
+                << " tasks resubmitted, "
+                << state->objects_being_reconstructed.size() +
+                       state->tasks_being_reconstructed.size()
+                << " in flight, " << state->queued_reconstructions.size()
+                << " queued (" << stats.num_requested << " requested, "
+                << stats.num_deduplicated << " deduplicated, "
+                << stats.num_suppressed << " suppressed)";
 }
 
 void handle_client_register(LocalSchedulerState *state,
@@ -1066,6 +1195,42 @@ void handle_set_actor_frontier(LocalSchedulerState *state,
                      frontier_dependencies);
 }
 
+/**
+ * Handle a task submitted by a worker or driver.
+ *
+ * @param state The state of the local scheduler.
+ * @param message The task submission.
+ * @return Void.
+ */
+void handle_submit_task_request(LocalSchedulerState *state,
+                                const SubmitTaskRequest *message) {
+  TaskExecutionSpec execution_spec =
+      TaskExecutionSpec(from_flatbuf(*message->execution_dependencies()),
+                        (TaskSpec *) message->task_spec()->data(),
+                        message->task_spec()->size());
+  /* Set the tasks's local scheduler entrypoint time. */
+  execution_spec.SetLastTimeStamp(current_time_ms());
+  TaskSpec *spec = execution_spec.Spec();
+  profile_event_record(PROFILE_EVENT_SUBMIT_TASK, TaskSpec_task_id(spec),
+                       profile_event_time_us(), 0);
+  /* Update the result table, which holds mappings of object ID -> ID of the
+   * task that created it. */
+  if (state->db != NULL) {
+    TaskID task_id = TaskSpec_task_id(spec);
+    for (int64_t i = 0; i < TaskSpec_num_returns(spec); ++i) {
+      ObjectID return_id = TaskSpec_return(spec, i);
+      result_table_add(state->db, return_id, task_id, false, NULL, NULL, NULL);
+    }
+  }
+
+  /* Handle the task submission. */
+  if (TaskSpec_actor_id(spec).is_nil()) {
+    handle_task_submitted(state, state->algorithm_state, execution_spec);
+  } else {
+    handle_actor_task_submitted(state, state->algorithm_state, execution_spec);
+  }
+}
+
 void process_message(event_loop *loop,
                      int client_sock,
                      void *context,
@@ -1084,30 +1249,14 @@ void process_message(event_loop *loop,
   switch (type) {
   case MessageType_SubmitTask: {
     auto message = flatbuffers::GetRoot<SubmitTaskRequest>(input);
-    TaskExecutionSpec execution_spec =
-        TaskExecutionSpec(from_flatbuf(*message->execution_dependencies()),
-                          (TaskSpec *) message->task_spec()->data(),
-                          message->task_spec()->size());
-    /* Set the tasks's local scheduler entrypoint time. */
-    execution_spec.SetLastTimeStamp(current_time_ms());
-    TaskSpec *spec = execution_spec.Spec();
-    /* Update the result table, which holds mappings of object ID -> ID of the
-     * task that created it. */
-    if (state->db != NULL) {
-      TaskID task_id = TaskSpec_task_id(spec);
-      for (int64_t i = 0; i < TaskSpec_num_returns(spec); ++i) {
-        ObjectID return_id = TaskSpec_return(spec, i);
-        result_table_add(state->db, return_id, task_id, false, NULL, NULL,
-                         NULL);
-      }
-    }
-
-    /* Handle the task submission. */
-    if (TaskSpec_actor_id(spec).is_nil()) {
-      handle_task_submitted(state, state->algorithm_state, execution_spec);
-    } else {
-      handle_actor_task_submitted(state, state->algorithm_state,
-                                  execution_spec);
+    handle_submit_task_request(state, message);
+  } break;
+  case MessageType_SubmitTaskBatch: {
+    /* Submit each task in the batch in order, exactly as if it had been sent
+     * in its own SubmitTask message. */
+    auto message = flatbuffers::GetRoot<SubmitTaskBatchRequest>(input);
+    for (const auto request : *message->tasks()) {
+      handle_submit_task_request(state, request);
     }
   } break;
   case MessageType_TaskDone: {
@@ -1251,6 +1400,7 @@ void new_client_connection(event_loop *loop,
   worker->is_worker = true;
   worker->client_id = WorkerID::nil();
   worker->task_in_progress = NULL;
+  worker->task_start_time_us = 0;
   worker->is_blocked = false;
   worker->pid = 0;
   worker->is_child = false;
@@ -1389,6 +1539,12 @@ int heartbeat_handler(event_loop *loop, timer_id id, void *context) {
   return RayConfig::instance().heartbeat_timeout_milliseconds();
 }
 
+int flush_event_log_handler(event_loop *loop, timer_id id, void *context) {
+  LocalSchedulerState *state = (LocalSchedulerState *) context;
+  RayLogger_flush_events(state->db);
+  return RayConfig::instance().profile_event_flush_period_milliseconds();
+}
+
 void start_server(
     const char *node_ip_address,
     const char *socket_name,
@@ -1400,7 +1556,9 @@ void start_server(
     bool global_scheduler_exists,
     const std::unordered_map<std::string, double> &static_resource_conf,
     const char *start_worker_command,
-    int num_workers) {
+    int num_workers,
+    const char *profile_events_path,
+    bool profile_events_to_redis) {
   /* Ignore SIGPIPE signals. If we don't do this, then when we attempt to write
    * to a client that has already died, the local scheduler could die. */
   signal(SIGPIPE, SIG_IGN);
@@ -1414,6 +1572,20 @@ void start_server(
       socket_name, plasma_store_socket_name, plasma_manager_socket_name,
       plasma_manager_address, global_scheduler_exists, static_resource_conf,
       start_worker_command, num_workers);
+  /* Start recording profiling events if they were asked for. */
+  UniqueID profile_source_id =
+      g_state->db != NULL ? get_db_client_id(g_state->db) : UniqueID::nil();
+  if (profile_events_path != NULL) {
+    profile_events_start(
+        profile_source_id,
+        std::unique_ptr<ProfileEventSink>(
+            new ProfileEventFileSink(profile_events_path)));
+  } else if (profile_events_to_redis && g_state->db != NULL) {
+    profile_events_start(
+        profile_source_id,
+        std::unique_ptr<ProfileEventSink>(new ProfileEventRedisSink(
+            std::string(redis_primary_addr), redis_primary_port)));
+  }
   /* Register a callback for registering new clients. */
   event_loop_add_file(loop, fd, EVENT_LOOP_READ, new_client_connection,
                       g_state);
@@ -1448,6 +1620,12 @@ void start_server(
   if (g_state->db != NULL) {
     db_client_table_cache_init(g_state->db);
   }
+  /* Create a timer for writing the workers' buffered event logs to Redis. */
+  if (g_state->db != NULL) {
+    event_loop_add_timer(
+        loop, RayConfig::instance().profile_event_flush_period_milliseconds(),
+        flush_event_log_handler, g_state);
+  }
   /* Create a timer for fetching queued tasks' missing object dependencies. */
   event_loop_add_timer(
       loop, RayConfig::instance().local_scheduler_fetch_timeout_milliseconds(),
@@ -1493,9 +1671,13 @@ int main(int argc, char *argv[]) {
   char *start_worker_command = NULL;
   /* The number of workers to start. */
   char *num_workers_str = NULL;
+  /* The file to write profiling events to. */
+  char *profile_events_path = NULL;
+  /* Whether to write profiling events to Redis. */
+  bool profile_events_to_redis = false;
   int c;
   bool global_scheduler_exists = true;
-  while ((c = getopt(argc, argv, "s:r:p:m:ga:h:c:w:n:")) != -1) {
+  while ((c = getopt(argc, argv, "s:r:p:m:ga:h:c:w:n:P:R")) != -1) {
     switch (c) {
     case 's':
       scheduler_socket_name = optarg;
@@ -1527,6 +1709,12 @@ int main(int argc, char *argv[]) {
     case 'n':
       num_workers_str = optarg;
       break;
+    case 'P':
+      profile_events_path = optarg;
+      break;
+    case 'R':
+      profile_events_to_redis = true;
+      break;
     default:
       RAY_LOG(FATAL) << "unknown option " << c;
     }
@@ -1596,6 +1784,7 @@ int main(int argc, char *argv[]) {
   start_server(node_ip_address, scheduler_socket_name, redis_addr, redis_port,
                plasma_store_socket_name, plasma_manager_socket_name,
                plasma_manager_address, global_scheduler_exists,
-               static_resource_conf, start_worker_command, num_workers);
+               static_resource_conf, start_worker_command, num_workers,
+               profile_events_path, profile_events_to_redis);
 }
 #endif
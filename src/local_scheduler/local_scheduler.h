@@ -77,6 +77,26 @@ void process_plasma_notification(event_loop *loop,
  */
 void reconstruct_object(LocalSchedulerState *state, ObjectID object_id);
 
+/**
+ * Check whether an object's reconstruction has been requested and has not
+ * finished looking up the object yet.
+ *
+ * @param state The local scheduler state.
+ * @param object_id The ID of the object.
+ * @return True if the object is queued for reconstruction or its lookups are
+ *         in flight.
+ */
+bool object_reconstruction_pending(LocalSchedulerState *state,
+                                   ObjectID object_id);
+
+/**
+ * Log the progress of object reconstruction.
+ *
+ * @param state The local scheduler state.
+ * @return Void.
+ */
+void print_reconstruction_progress(LocalSchedulerState *state);
+
 void print_resource_info(const LocalSchedulerState *s, const TaskSpec *spec);
 
 /**
@@ -13,6 +13,7 @@
 #include "local_scheduler_shared.h"
 #include "local_scheduler.h"
 #include "common/task.h"
+#include "ray/id_map.h"
 
 /* Declared for convenience. */
 void remove_actor(SchedulingAlgorithmState *algorithm_state, ActorID actor_id);
@@ -44,6 +45,9 @@ struct ObjectEntry {
    *  to true for all objects except for actor dummy objects, where the object
    *  must be generated by executing the task locally. */
   bool request_transfer;
+  /** Whether a fetch was issued for this object, because a task in the
+   *  prefetch window depends on it. */
+  bool fetched;
 };
 
 /** This struct contains information about a specific actor. This struct will be
@@ -89,7 +93,7 @@ struct SchedulingAlgorithmState {
    *  The purpose is to make it easier to dispatch tasks without looping over
    *  all of the actors. Note that this is an optimization and is not strictly
    *  necessary. */
-  std::unordered_set<ActorID> actors_with_pending_tasks;
+  ray::IdSet actors_with_pending_tasks;
   /** A vector of actor tasks that have been submitted but this local scheduler
    *  doesn't know which local scheduler is responsible for them, so cannot
    *  assign them to the correct local scheduler yet. Whenever a notification
@@ -111,13 +115,29 @@ struct SchedulingAlgorithmState {
   std::vector<LocalSchedulerClient *> blocked_workers;
   /** A hash map of the objects that are available in the local Plasma store.
    *  The key is the object ID. This information could be a little stale. */
-  std::unordered_map<ObjectID, ObjectEntry> local_objects;
+  ray::IdMap<ObjectEntry> local_objects;
   /** A hash map of the objects that are not available locally. These are
    *  currently being fetched by this local scheduler. The key is the object
    *  ID. Every local_scheduler_fetch_timeout_milliseconds, a Plasma fetch
    *  request will be sent the object IDs in this table. Each entry also holds
    *  an array of queued tasks that are dependent on it. */
-  std::unordered_map<ObjectID, ObjectEntry> remote_objects;
+  ray::IdMap<ObjectEntry> remote_objects;
+  /** The number of tasks at the front of the waiting queue whose missing
+   *  objects are fetched. The objects of the tasks behind them are fetched
+   *  once the tasks move up. This grows by one for every fetched object that
+   *  arrives, and is halved whenever an object that a waiting task needs is
+   *  evicted. */
+  int64_t prefetch_window;
+  /** The number of fetched objects that arrived while a task still needed
+   *  them. */
+  int64_t num_prefetch_hits;
+  /** The number of objects that were evicted while a waiting task still
+   *  needed them. */
+  int64_t num_prefetch_misses;
+  /** The value of num_prefetch_hits at the last report. */
+  int64_t num_reported_prefetch_hits;
+  /** The value of num_prefetch_misses at the last report. */
+  int64_t num_reported_prefetch_misses;
 };
 
 SchedulingAlgorithmState *SchedulingAlgorithmState_init(void) {
@@ -125,6 +145,8 @@ SchedulingAlgorithmState *SchedulingAlgorithmState_init(void) {
   /* Initialize the local data structures used for queuing tasks and workers. */
   algorithm_state->waiting_task_queue = new std::list<TaskExecutionSpec>();
   algorithm_state->dispatch_task_queue = new std::list<TaskExecutionSpec>();
+  algorithm_state->prefetch_window =
+      RayConfig::instance().prefetch_window_min_tasks();
 
   return algorithm_state;
 }
@@ -546,6 +568,8 @@ void queue_actor_task(LocalSchedulerState *state,
  *        other plasma managers. This should be set to false for execution
  *        dependencies, which should be fulfilled by executing the
  *        corresponding task locally.
+ * @param in_window Whether the task is in the prefetch window. If not, the
+ *        object is only fetched once the task enters the window.
  * @returns Void.
  */
 void fetch_missing_dependency(
@@ -553,11 +577,12 @@ void fetch_missing_dependency(
     SchedulingAlgorithmState *algorithm_state,
     std::list<TaskExecutionSpec>::iterator task_entry_it,
     plasma::ObjectID obj_id,
-    bool request_transfer) {
+    bool request_transfer,
+    bool in_window) {
   if (algorithm_state->remote_objects.count(obj_id) == 0) {
     /* We weren't actively fetching this object. Try the fetch once
-     * immediately. */
-    if (state->plasma_conn->get_manager_fd() != -1) {
+     * immediately, if the task is going to run soon. */
+    if (in_window && state->plasma_conn->get_manager_fd() != -1) {
       auto arrow_status = state->plasma_conn->Fetch(1, &obj_id);
       if (!arrow_status.ok()) {
         LocalSchedulerState_free(state);
@@ -576,6 +601,7 @@ void fetch_missing_dependency(
      * subsequently removed locally. */
     ObjectEntry entry;
     entry.request_transfer = request_transfer;
+    entry.fetched = in_window;
     algorithm_state->remote_objects[obj_id] = entry;
   }
   algorithm_state->remote_objects[obj_id].dependent_tasks.push_back(
@@ -590,12 +616,14 @@ void fetch_missing_dependency(
  * @param state The scheduler state.
  * @param algorithm_state The scheduling algorithm state.
  * @param task_entry_it A reference to the task entry in the waiting queue.
+ * @param in_window Whether the task is in the prefetch window.
  * @returns Void.
  */
 void fetch_missing_dependencies(
     LocalSchedulerState *state,
     SchedulingAlgorithmState *algorithm_state,
-    std::list<TaskExecutionSpec>::iterator task_entry_it) {
+    std::list<TaskExecutionSpec>::iterator task_entry_it,
+    bool in_window) {
   int64_t num_dependencies = task_entry_it->NumDependencies();
   int num_missing_dependencies = 0;
   for (int64_t i = 0; i < num_dependencies; ++i) {
@@ -608,7 +636,8 @@ void fetch_missing_dependencies(
          * execution dependency. */
         bool request_transfer = task_entry_it->IsStaticDependency(i);
         fetch_missing_dependency(state, algorithm_state, task_entry_it,
-                                 obj_id.to_plasma_id(), request_transfer);
+                                 obj_id.to_plasma_id(), request_transfer,
+                                 in_window);
         ++num_missing_dependencies;
       }
     }
@@ -689,22 +718,45 @@ bool object_locally_available(SchedulingAlgorithmState *algorithm_state,
   return algorithm_state->local_objects.count(object_id) == 1;
 }
 
-/* TODO(swang): This method is not covered by any valgrind tests. */
-int fetch_object_timeout_handler(event_loop *loop, timer_id id, void *context) {
-  int64_t start_time = current_time_ms();
-
-  LocalSchedulerState *state = (LocalSchedulerState *) context;
-  /* Only try the fetches if we are connected to the object store manager. */
+/**
+ * Fetch the missing objects of the tasks in the prefetch window. Only these
+ * objects are fetched, so that the objects of tasks that will not run for a
+ * long time do not evict the objects of the tasks that are about to run.
+ *
+ * @param state The scheduler state.
+ * @param algorithm_state The scheduling algorithm state.
+ * @param refetch Whether to fetch the objects that were already fetched
+ *        again. If false, only the objects of the tasks that entered the
+ *        window since the last fetch are fetched.
+ * @return The number of objects that were fetched.
+ */
+int64_t fetch_prefetch_window(LocalSchedulerState *state,
+                              SchedulingAlgorithmState *algorithm_state,
+                              bool refetch) {
   if (state->plasma_conn->get_manager_fd() == -1) {
-    RAY_LOG(INFO)
-        << "Local scheduler is not connected to a object store manager";
-    return RayConfig::instance().local_scheduler_fetch_timeout_milliseconds();
+    return 0;
   }
-
   std::vector<ObjectID> object_id_vec;
-  for (auto const &entry : state->algorithm_state->remote_objects) {
-    if (entry.second.request_transfer) {
-      object_id_vec.push_back(entry.first);
+  ray::IdSet requested_object_ids;
+  int64_t num_tasks = 0;
+  for (auto it = algorithm_state->waiting_task_queue->begin();
+       it != algorithm_state->waiting_task_queue->end() &&
+       num_tasks < algorithm_state->prefetch_window;
+       ++it, ++num_tasks) {
+    int64_t num_dependencies = it->NumDependencies();
+    for (int64_t i = 0; i < num_dependencies; ++i) {
+      int count = it->DependencyIdCount(i);
+      for (int j = 0; j < count; ++j) {
+        ObjectID obj_id = it->DependencyId(i, j);
+        auto entry = algorithm_state->remote_objects.find(obj_id);
+        if (entry != algorithm_state->remote_objects.end() &&
+            entry->second.request_transfer &&
+            (refetch || !entry->second.fetched) &&
+            requested_object_ids.insert(obj_id).second) {
+          entry->second.fetched = true;
+          object_id_vec.push_back(obj_id);
+        }
+      }
     }
   }
 
@@ -730,6 +782,41 @@ int fetch_object_timeout_handler(event_loop *loop, timer_id id, void *context) {
                      << arrow_status.ToString();
     }
   }
+  return num_object_ids;
+}
+
+/* TODO(swang): This method is not covered by any valgrind tests. */
+int fetch_object_timeout_handler(event_loop *loop, timer_id id, void *context) {
+  int64_t start_time = current_time_ms();
+
+  LocalSchedulerState *state = (LocalSchedulerState *) context;
+  /* Only try the fetches if we are connected to the object store manager. */
+  if (state->plasma_conn->get_manager_fd() == -1) {
+    RAY_LOG(INFO)
+        << "Local scheduler is not connected to a object store manager";
+    return RayConfig::instance().local_scheduler_fetch_timeout_milliseconds();
+  }
+
+  /* Retry the fetches for the whole window, in case a fetch was lost. */
+  SchedulingAlgorithmState *algorithm_state = state->algorithm_state;
+  int64_t num_object_ids = fetch_prefetch_window(state, algorithm_state, true);
+
+  /* Report the prefetch hits and misses since the last report. */
+  int64_t num_new_hits = algorithm_state->num_prefetch_hits -
+                         algorithm_state->num_reported_prefetch_hits;
+  int64_t num_new_misses = algorithm_state->num_prefetch_misses -
+                           algorithm_state->num_reported_prefetch_misses;
+  if (num_new_hits != 0 || num_new_misses != 0) {
+    RAY_LOG(INFO) << "Prefetch window: " << algorithm_state->prefetch_window
+                  << " tasks, " << num_new_hits << " hits, " << num_new_misses
+                  << " misses (" << algorithm_state->num_prefetch_hits
+                  << " hits, " << algorithm_state->num_prefetch_misses
+                  << " misses in total)";
+    algorithm_state->num_reported_prefetch_hits =
+        algorithm_state->num_prefetch_hits;
+    algorithm_state->num_reported_prefetch_misses =
+        algorithm_state->num_prefetch_misses;
+  }
 
   /* Print a warning if this method took too long. */
   int64_t end_time = current_time_ms();
@@ -773,9 +860,11 @@ int reconstruct_object_timeout_handler(event_loop *loop,
   int64_t num_reconstructed = 0;
   for (size_t i = 0; i < object_ids_to_reconstruct.size(); i++) {
     ObjectID object_id = object_ids_to_reconstruct[i];
-    /* Only call reconstruct if we are still missing the object. */
+    /* Only call reconstruct if we are still missing the object and it is not
+     * already being reconstructed. */
     if (state->algorithm_state->remote_objects.find(object_id) !=
-        state->algorithm_state->remote_objects.end()) {
+            state->algorithm_state->remote_objects.end() &&
+        !object_reconstruction_pending(state, object_id)) {
       reconstruct_object(state, object_id);
     }
     num_reconstructed++;
@@ -787,6 +876,13 @@ int reconstruct_object_timeout_handler(event_loop *loop,
       object_ids_to_reconstruct.begin(),
       object_ids_to_reconstruct.begin() + num_reconstructed);
 
+  /* Report progress while there are reconstructions outstanding. */
+  if (!state->queued_reconstructions.empty() ||
+      !state->objects_being_reconstructed.empty() ||
+      !state->tasks_being_reconstructed.empty()) {
+    print_reconstruction_progress(state);
+  }
+
   /* Print a warning if this method took too long. */
   int64_t end_time = current_time_ms();
   if (end_time - start_time >
@@ -1071,7 +1167,11 @@ void queue_waiting_task(LocalSchedulerState *state,
   RAY_LOG(DEBUG) << "Queueing task in waiting queue";
   auto it = queue_task(state, algorithm_state->waiting_task_queue,
                        execution_spec, from_global_scheduler);
-  fetch_missing_dependencies(state, algorithm_state, it);
+  /* The task is at the back of the waiting queue. */
+  bool in_window = static_cast<int64_t>(
+                       algorithm_state->waiting_task_queue->size()) <=
+                   algorithm_state->prefetch_window;
+  fetch_missing_dependencies(state, algorithm_state, it, in_window);
 }
 
 /**
@@ -1614,6 +1714,13 @@ void handle_object_available(LocalSchedulerState *state,
     /* Remove the object from the active fetch requests. */
     entry = object_entry_it->second;
     algorithm_state->remote_objects.erase(object_id);
+    /* The object was fetched in time. Try to prefetch for one more task. */
+    if (entry.fetched) {
+      algorithm_state->num_prefetch_hits++;
+      algorithm_state->prefetch_window =
+          std::min(algorithm_state->prefetch_window + 1,
+                   RayConfig::instance().prefetch_window_max_tasks());
+    }
   }
 
   /* Add the entry to the set of locally available objects. */
@@ -1641,6 +1748,10 @@ void handle_object_available(LocalSchedulerState *state,
     /* Clean up the records for dependent tasks. */
     entry.dependent_tasks.clear();
   }
+  /* The window may have grown or moved past the tasks that left the waiting
+   * queue, so fetch the objects of the tasks that entered it now rather than
+   * on the next fetch timeout. */
+  fetch_prefetch_window(state, algorithm_state, false);
 }
 
 void handle_object_removed(LocalSchedulerState *state,
@@ -1701,8 +1812,10 @@ void handle_object_removed(LocalSchedulerState *state,
 
   /* Track the dependency for tasks that are in the waiting queue, including
    * those that were just moved from the dispatch queue. */
+  int64_t queue_position = 0;
   for (auto it = algorithm_state->waiting_task_queue->begin();
-       it != algorithm_state->waiting_task_queue->end(); ++it) {
+       it != algorithm_state->waiting_task_queue->end();
+       ++it, ++queue_position) {
     int64_t num_dependencies = it->NumDependencies();
     for (int64_t i = 0; i < num_dependencies; ++i) {
       int count = it->DependencyIdCount(i);
@@ -1712,13 +1825,23 @@ void handle_object_removed(LocalSchedulerState *state,
           /* Do not request a transfer from other plasma managers if this is an
            * execution dependency. */
           bool request_transfer = it->IsStaticDependency(i);
-          fetch_missing_dependency(state, algorithm_state, it,
-                                   removed_object_id.to_plasma_id(),
-                                   request_transfer);
+          fetch_missing_dependency(
+              state, algorithm_state, it, removed_object_id.to_plasma_id(),
+              request_transfer,
+              queue_position < algorithm_state->prefetch_window);
         }
       }
     }
   }
+
+  /* The object store evicted an object that a waiting task needs, so it is
+   * holding more than it can. Prefetch for fewer tasks. */
+  if (algorithm_state->remote_objects.count(removed_object_id) == 1) {
+    algorithm_state->num_prefetch_misses++;
+    algorithm_state->prefetch_window =
+        std::max(algorithm_state->prefetch_window / 2,
+                 RayConfig::instance().prefetch_window_min_tasks());
+  }
 }
 
 void handle_driver_removed(LocalSchedulerState *state,
@@ -1773,6 +1896,9 @@ void handle_driver_removed(LocalSchedulerState *state,
     }
   }
 
+  /* Fetch for the waiting tasks that moved up into the prefetch window. */
+  fetch_prefetch_window(state, algorithm_state, false);
+
   // Remove this driver's tasks from the cached actor tasks. Note that this loop
   // could be very slow if the vector of cached actor tasks is very long.
   for (auto it = algorithm_state->cached_submitted_actor_tasks.begin();
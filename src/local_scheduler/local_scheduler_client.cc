@@ -5,10 +5,96 @@
 
 #include "common/io.h"
 #include "common/task.h"
+#include <poll.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <functional>
+
+/**
+ * Wait until the local scheduler has drained enough of the submission ring.
+ * The local scheduler usually drains the ring quickly, so this first yields
+ * the CPU a few times. Then it sleeps in short polls of the socket, so that a
+ * busy local scheduler does not cost this client a whole CPU, and so that a
+ * local scheduler that died is noticed.
+ *
+ * @param conn The connection information. Its write mutex must be held.
+ * @param ready Returns whether the ring has been drained enough.
+ * @return 0 once ready returns true, or -1 if the local scheduler closed the
+ *         socket or did not drain the ring for
+ *         worker_submission_ring_timeout_milliseconds.
+ */
+static int wait_for_submission_ring(LocalSchedulerConnection *conn,
+                                    const std::function<bool()> &ready) {
+  const int num_yields = 100;
+  for (int i = 0; i < num_yields; ++i) {
+    if (ready()) {
+      return 0;
+    }
+    sched_yield();
+  }
+  const int64_t timeout_ms =
+      RayConfig::instance().worker_submission_ring_timeout_milliseconds();
+  int64_t start_time = current_time_ms();
+  while (!ready()) {
+    if (current_time_ms() - start_time > timeout_ms) {
+      RAY_LOG(ERROR) << "The local scheduler did not drain the submission "
+                     << "ring for " << timeout_ms << "ms";
+      return -1;
+    }
+    /* Only wait for the socket to fail or hang up, since replies that were
+     * not read yet may be waiting on it. */
+    struct pollfd poll_fd = {conn->conn, 0, 0};
+    if (poll(&poll_fd, 1, 1) > 0) {
+      RAY_LOG(ERROR) << "The local scheduler closed the connection";
+      return -1;
+    }
+  }
+  return 0;
+}
+/**
+ * Send a message to the local scheduler. If the connection has a submission
+ * ring, the message goes through the ring when it fits, and the local scheduler
+ * is only woken up on the socket if it was waiting for messages. Messages that
+ * are too large for the ring go on the socket once the local scheduler has
+ * handled everything in the ring, so that it sees all messages in order.
+ *
+ * @param conn The connection information.
+ * @param type The message type.
+ * @param length The length of the message.
+ * @param message The message bytes.
+ * @return 0 if the message was sent, -1 if the socket write failed or the
+ *         ring was not drained in time.
+ */
+static int send_message(LocalSchedulerConnection *conn,
+                        int64_t type,
+                        int64_t length,
+                        uint8_t *message) {
+  std::lock_guard<std::mutex> lock(conn->write_mutex);
+  ray::SubmissionRing *ring = conn->submission_ring.get();
+  if (ring == nullptr) {
+    return write_message(conn->conn, type, length, message);
+  }
+  if (length <= ring->MaxMessageLength()) {
+    if (wait_for_submission_ring(
+            conn, [ring, length]() { return ring->HasSpace(length); }) != 0) {
+      return -1;
+    }
+    if (ring->Write(type, length, message)) {
+      return write_message(conn->conn, MessageType_SubmissionRingDoorbell, 0,
+                           NULL);
+    }
+    return 0;
+  }
+  if (wait_for_submission_ring(conn, [ring]() { return ring->IsEmpty(); }) !=
+      0) {
+    return -1;
+  }
+  return write_message(conn->conn, type, length, message);
+}
+
 LocalSchedulerConnection *LocalSchedulerConnection_init(
     const char *local_scheduler_socket,
     UniqueID client_id,
@@ -36,12 +122,36 @@ void LocalSchedulerConnection_free(LocalSchedulerConnection *conn) {
   delete conn;
 }
 
+void local_scheduler_use_submission_ring(LocalSchedulerConnection *conn,
+                                         int64_t capacity) {
+  std::string name = "/ray_submission_ring_" + std::to_string(getpid()) + "_" +
+                     UniqueID::from_random().hex();
+  std::unique_ptr<ray::SubmissionRing> ring;
+  ray::Status status = ray::SubmissionRing::Create(name, capacity, &ring);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to create a submission ring, sending all "
+                     << "messages on the socket: " << status.ToString();
+    return;
+  }
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message =
+      CreateRegisterSubmissionRingRequest(fbb, fbb.CreateString(name));
+  fbb.Finish(message);
+  /* Register the ring on the socket before any message goes into it. */
+  std::lock_guard<std::mutex> lock(conn->write_mutex);
+  RAY_CHECK(conn->submission_ring == nullptr);
+  int success = write_message(conn->conn, MessageType_RegisterSubmissionRing,
+                              fbb.GetSize(), fbb.GetBufferPointer());
+  RAY_CHECK(success == 0) << "Unable to register submission ring";
+  conn->submission_ring = std::move(ring);
+}
+
 void local_scheduler_disconnect_client(LocalSchedulerConnection *conn) {
   flatbuffers::FlatBufferBuilder fbb;
   auto message = CreateDisconnectClient(fbb);
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_DisconnectClient, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  send_message(conn, MessageType_DisconnectClient, fbb.GetSize(),
+               fbb.GetBufferPointer());
 }
 
 void local_scheduler_log_event(LocalSchedulerConnection *conn,
@@ -56,12 +166,12 @@ void local_scheduler_log_event(LocalSchedulerConnection *conn,
   auto message =
       CreateEventLogMessage(fbb, key_string, value_string, timestamp);
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_EventLogMessage, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  send_message(conn, MessageType_EventLogMessage, fbb.GetSize(),
+               fbb.GetBufferPointer());
 }
 
-void local_scheduler_submit(LocalSchedulerConnection *conn,
-                            TaskExecutionSpec &execution_spec) {
+int local_scheduler_submit(LocalSchedulerConnection *conn,
+                           TaskExecutionSpec &execution_spec) {
   flatbuffers::FlatBufferBuilder fbb;
   auto execution_dependencies =
       to_flatbuf(fbb, execution_spec.ExecutionDependencies());
@@ -71,11 +181,11 @@ void local_scheduler_submit(LocalSchedulerConnection *conn,
   auto message =
       CreateSubmitTaskRequest(fbb, execution_dependencies, task_spec);
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_SubmitTask, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  return send_message(conn, MessageType_SubmitTask, fbb.GetSize(),
+                      fbb.GetBufferPointer());
 }
 
-void local_scheduler_submit_raylet(
+int local_scheduler_submit_raylet(
     LocalSchedulerConnection *conn,
     const std::vector<ObjectID> &execution_dependencies,
     ray::raylet::TaskSpecification task_spec) {
@@ -84,18 +194,61 @@ void local_scheduler_submit_raylet(
   auto message = CreateSubmitTaskRequest(fbb, execution_dependencies_message,
                                          task_spec.ToFlatbuffer(fbb));
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_SubmitTask, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  return send_message(conn, MessageType_SubmitTask, fbb.GetSize(),
+                      fbb.GetBufferPointer());
 }
 
-TaskSpec *local_scheduler_get_task(LocalSchedulerConnection *conn,
-                                   int64_t *task_size) {
-  write_message(conn->conn, MessageType_GetTask, 0, NULL);
+int local_scheduler_submit_batch(
+    LocalSchedulerConnection *conn,
+    const std::vector<TaskExecutionSpec> &execution_specs) {
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<SubmitTaskRequest>> requests;
+  requests.reserve(execution_specs.size());
+  for (const auto &execution_spec : execution_specs) {
+    auto execution_dependencies =
+        to_flatbuf(fbb, execution_spec.ExecutionDependencies());
+    auto task_spec =
+        fbb.CreateString(reinterpret_cast<char *>(execution_spec.Spec()),
+                         execution_spec.SpecSize());
+    requests.push_back(
+        CreateSubmitTaskRequest(fbb, execution_dependencies, task_spec));
+  }
+  auto message = CreateSubmitTaskBatchRequest(fbb, fbb.CreateVector(requests));
+  fbb.Finish(message);
+  return send_message(conn, MessageType_SubmitTaskBatch, fbb.GetSize(),
+                      fbb.GetBufferPointer());
+}
+
+int local_scheduler_submit_batch_raylet(
+    LocalSchedulerConnection *conn,
+    const std::vector<std::vector<ObjectID>> &execution_dependencies,
+    const std::vector<ray::raylet::TaskSpecification> &task_specs) {
+  RAY_CHECK(execution_dependencies.size() == task_specs.size());
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<SubmitTaskRequest>> requests;
+  requests.reserve(task_specs.size());
+  for (size_t i = 0; i < task_specs.size(); i++) {
+    auto execution_dependencies_message =
+        to_flatbuf(fbb, execution_dependencies[i]);
+    requests.push_back(CreateSubmitTaskRequest(
+        fbb, execution_dependencies_message, task_specs[i].ToFlatbuffer(fbb)));
+  }
+  auto message = CreateSubmitTaskBatchRequest(fbb, fbb.CreateVector(requests));
+  fbb.Finish(message);
+  return send_message(conn, MessageType_SubmitTaskBatch, fbb.GetSize(),
+                      fbb.GetBufferPointer());
+}
+
+TaskSpec *local_scheduler_get_task_zero_copy(LocalSchedulerConnection *conn,
+                                             int64_t *task_size,
+                                             uint8_t **buffer) {
+  send_message(conn, MessageType_GetTask, 0, NULL);
   int64_t type;
   int64_t reply_size;
   uint8_t *reply;
   /* Receive a task from the local scheduler. This will block until the local
-   * scheduler gives this client a task. */
+   * scheduler gives this client a task. If the local scheduler sent the task
+   * ahead of time, it is already waiting on the socket. */
   read_message(conn->conn, &type, &reply_size, &reply);
   if (type == DISCONNECT_CLIENT) {
     RAY_LOG(DEBUG) << "Exiting because local scheduler closed connection.";
@@ -106,10 +259,8 @@ TaskSpec *local_scheduler_get_task(LocalSchedulerConnection *conn,
   /* Parse the flatbuffer object. */
   auto reply_message = flatbuffers::GetRoot<GetTaskReply>(reply);
 
-  /* Create a copy of the task spec so we can free the reply. */
   *task_size = reply_message->task_spec()->size();
-  TaskSpec *data = (TaskSpec *) reply_message->task_spec()->data();
-  TaskSpec *spec = TaskSpec_copy(data, *task_size);
+  TaskSpec *spec = (TaskSpec *) reply_message->task_spec()->data();
 
   // Set the GPU IDs for this task. We only do this for non-actor tasks because
   // for actors the GPUs are associated with the actor itself and not with the
@@ -121,14 +272,29 @@ TaskSpec *local_scheduler_get_task(LocalSchedulerConnection *conn,
     }
   }
 
+  /* Pass ownership of the message, which holds the task spec, to the caller. */
+  *buffer = reply;
+  return spec;
+}
+
+TaskSpec *local_scheduler_get_task(LocalSchedulerConnection *conn,
+                                   int64_t *task_size) {
+  uint8_t *reply;
+  TaskSpec *data = local_scheduler_get_task_zero_copy(conn, task_size, &reply);
+  /* Create a copy of the task spec so we can free the reply. */
+  TaskSpec *spec = TaskSpec_copy(data, *task_size);
   /* Free the original message from the local scheduler. */
   free(reply);
   /* Return the copy of the task spec and pass ownership to the caller. */
   return spec;
 }
 
+void local_scheduler_prefetch_task(LocalSchedulerConnection *conn) {
+  send_message(conn, MessageType_PrefetchTask, 0, NULL);
+}
+
 void local_scheduler_task_done(LocalSchedulerConnection *conn) {
-  write_message(conn->conn, MessageType_TaskDone, 0, NULL);
+  send_message(conn, MessageType_TaskDone, 0, NULL);
 }
 
 void local_scheduler_reconstruct_object(LocalSchedulerConnection *conn,
@@ -136,17 +302,17 @@ void local_scheduler_reconstruct_object(LocalSchedulerConnection *conn,
   flatbuffers::FlatBufferBuilder fbb;
   auto message = CreateReconstructObject(fbb, to_flatbuf(fbb, object_id));
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_ReconstructObject, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  send_message(conn, MessageType_ReconstructObject, fbb.GetSize(),
+               fbb.GetBufferPointer());
   /* TODO(swang): Propagate the error. */
 }
 
 void local_scheduler_log_message(LocalSchedulerConnection *conn) {
-  write_message(conn->conn, MessageType_EventLogMessage, 0, NULL);
+  send_message(conn, MessageType_EventLogMessage, 0, NULL);
 }
 
 void local_scheduler_notify_unblocked(LocalSchedulerConnection *conn) {
-  write_message(conn->conn, MessageType_NotifyUnblocked, 0, NULL);
+  send_message(conn, MessageType_NotifyUnblocked, 0, NULL);
 }
 
 void local_scheduler_put_object(LocalSchedulerConnection *conn,
@@ -157,8 +323,8 @@ void local_scheduler_put_object(LocalSchedulerConnection *conn,
                                  to_flatbuf(fbb, object_id));
   fbb.Finish(message);
 
-  write_message(conn->conn, MessageType_PutObject, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  send_message(conn, MessageType_PutObject, fbb.GetSize(),
+               fbb.GetBufferPointer());
 }
 
 const std::vector<uint8_t> local_scheduler_get_actor_frontier(
@@ -167,8 +333,8 @@ const std::vector<uint8_t> local_scheduler_get_actor_frontier(
   flatbuffers::FlatBufferBuilder fbb;
   auto message = CreateGetActorFrontierRequest(fbb, to_flatbuf(fbb, actor_id));
   fbb.Finish(message);
-  write_message(conn->conn, MessageType_GetActorFrontierRequest, fbb.GetSize(),
-                fbb.GetBufferPointer());
+  send_message(conn, MessageType_GetActorFrontierRequest, fbb.GetSize(),
+               fbb.GetBufferPointer());
 
   int64_t type;
   std::vector<uint8_t> reply;
@@ -183,6 +349,6 @@ const std::vector<uint8_t> local_scheduler_get_actor_frontier(
 
 void local_scheduler_set_actor_frontier(LocalSchedulerConnection *conn,
                                         const std::vector<uint8_t> &frontier) {
-  write_message(conn->conn, MessageType_SetActorFrontier, frontier.size(),
-                const_cast<uint8_t *>(frontier.data()));
+  send_message(conn, MessageType_SetActorFrontier, frontier.size(),
+               const_cast<uint8_t *>(frontier.data()));
 }
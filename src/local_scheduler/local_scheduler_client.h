@@ -1,8 +1,12 @@
 #ifndef LOCAL_SCHEDULER_CLIENT_H
 #define LOCAL_SCHEDULER_CLIENT_H
 
+#include <memory>
+#include <mutex>
+
 #include "common/task.h"
 #include "local_scheduler_shared.h"
+#include "ray/common/submission_ring.h"
 #include "ray/raylet/task_spec.h"
 
 struct LocalSchedulerConnection {
@@ -11,6 +15,14 @@ struct LocalSchedulerConnection {
   int conn;
   /** The IDs of the GPUs that this client can use. */
   std::vector<int> gpu_ids;
+  /** Serializes writes to the socket. Batched submissions are written without
+   *  holding the Python GIL, so they may race with writes from other threads.
+   */
+  std::mutex write_mutex;
+  /** If set, messages to the local scheduler go through this shared memory
+   *  ring instead of the socket whenever they fit. Replies still arrive on the
+   *  socket. */
+  std::unique_ptr<ray::SubmissionRing> submission_ring;
 };
 
 /**
@@ -36,23 +48,60 @@ LocalSchedulerConnection *LocalSchedulerConnection_init(
  */
 void LocalSchedulerConnection_free(LocalSchedulerConnection *conn);
 
+/**
+ * Send messages to the local scheduler through a shared memory ring from now
+ * on, and use the socket only for messages that do not fit and to wake the
+ * local scheduler up. This is only supported by the raylet. If the ring cannot
+ * be created, messages keep going on the socket.
+ *
+ * @param conn The connection information.
+ * @param capacity The size in bytes of the ring.
+ * @return Void.
+ */
+void local_scheduler_use_submission_ring(LocalSchedulerConnection *conn,
+                                         int64_t capacity);
+
 /**
  * Submit a task to the local scheduler.
  *
  * @param conn The connection information.
  * @param execution_spec The execution spec for the task to submit.
- * @return Void.
+ * @return 0 if the task was sent, -1 otherwise.
  */
-void local_scheduler_submit(LocalSchedulerConnection *conn,
-                            TaskExecutionSpec &execution_spec);
+int local_scheduler_submit(LocalSchedulerConnection *conn,
+                           TaskExecutionSpec &execution_spec);
+
+/**
+ * Submit a batch of tasks to the local scheduler in a single message. The
+ * local scheduler handles the tasks in order, as if each had been submitted
+ * with local_scheduler_submit.
+ *
+ * @param conn The connection information.
+ * @param execution_specs The execution specs for the tasks to submit.
+ * @return 0 if the tasks were sent, -1 otherwise.
+ */
+int local_scheduler_submit_batch(
+    LocalSchedulerConnection *conn,
+    const std::vector<TaskExecutionSpec> &execution_specs);
+
+/// Submit a batch of tasks in a single message using the raylet code path.
+///
+/// \param conn The connection information.
+/// \param execution_dependencies The execution dependencies of each task.
+/// \param task_specs The task specifications, in submission order.
+/// \return 0 if the tasks were sent, -1 otherwise.
+int local_scheduler_submit_batch_raylet(
+    LocalSchedulerConnection *conn,
+    const std::vector<std::vector<ObjectID>> &execution_dependencies,
+    const std::vector<ray::raylet::TaskSpecification> &task_specs);
 
 /// Submit a task using the raylet code path.
 ///
 /// \param The connection information.
 /// \param The execution dependencies.
 /// \param The task specification.
-/// \return Void.
-void local_scheduler_submit_raylet(
+/// \return 0 if the task was sent, -1 otherwise.
+int local_scheduler_submit_raylet(
     LocalSchedulerConnection *conn,
     const std::vector<ObjectID> &execution_dependencies,
     ray::raylet::TaskSpecification task_spec);
@@ -102,6 +151,37 @@ void local_scheduler_log_event(LocalSchedulerConnection *conn,
 TaskSpec *local_scheduler_get_task(LocalSchedulerConnection *conn,
                                    int64_t *task_size);
 
+/**
+ * Get next task for this client, like local_scheduler_get_task, but without
+ * copying the task out of the message that the local scheduler sent. The
+ * returned task points into the message buffer, which the caller owns and must
+ * free with free() once it is done with the task.
+ *
+ * @param conn The connection information.
+ * @param task_size A pointer to fill out with the task size.
+ * @param buffer A pointer to fill out with the message buffer.
+ * @return The address of the assigned task, inside the message buffer.
+ */
+TaskSpec *local_scheduler_get_task_zero_copy(LocalSchedulerConnection *conn,
+                                             int64_t *task_size,
+                                             uint8_t **buffer);
+
+/**
+ * Tell the local scheduler that this worker will ask for another task as soon
+ * as it finishes its current one. The local scheduler may then send the next
+ * task ahead of time, so that the next call to local_scheduler_get_task
+ * returns without waiting for the local scheduler. This is only supported by
+ * the raylet, and must not be called by actors.
+ *
+ * This must only be called once the current task has returned. A task that
+ * is still running may block on the task that is sent ahead, which the worker
+ * would never get to.
+ *
+ * @param conn The connection information.
+ * @return Void.
+ */
+void local_scheduler_prefetch_task(LocalSchedulerConnection *conn);
+
 /**
  * Tell the local scheduler that the client has finished executing a task.
  *
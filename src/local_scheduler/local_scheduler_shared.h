@@ -7,6 +7,7 @@
 #include "plasma/client.h"
 #include "ray/gcs/client.h"
 
+#include <deque>
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
@@ -21,6 +22,21 @@ struct ActorMapEntry {
   DBClientID local_scheduler_id;
 };
 
+/** Counters that track the progress of object reconstruction. */
+struct ReconstructionStats {
+  /** The number of objects whose reconstruction was requested. */
+  int64_t num_requested;
+  /** The number of requests that were dropped because the object, or another
+   *  object created by the same task, was already being reconstructed. */
+  int64_t num_deduplicated;
+  /** The number of tasks that were resubmitted for re-execution. */
+  int64_t num_resubmitted;
+  /** The number of reconstructions that ended without resubmitting a task,
+   *  because the object was still available or the task was claimed by
+   *  another local scheduler. */
+  int64_t num_suppressed;
+};
+
 /** Internal state of the scheduling algorithm. */
 typedef struct SchedulingAlgorithmState SchedulingAlgorithmState;
 
@@ -82,6 +98,20 @@ struct LocalSchedulerState {
   /** The time (in milliseconds since the Unix epoch) when the most recent
    *  heartbeat was sent. */
   int64_t previous_heartbeat_time;
+  /** Objects whose reconstruction was requested but has not started yet,
+   *  because max_reconstructions_in_flight reconstructions were already in
+   *  progress. Objects are started in the order that they were requested, so
+   *  the inputs of resubmitted tasks are reconstructed in waves. */
+  std::deque<ObjectID> queued_reconstructions;
+  /** The objects in queued_reconstructions. */
+  std::unordered_set<ObjectID> queued_reconstruction_ids;
+  /** Objects whose locations or creating tasks are being looked up. */
+  std::unordered_set<ObjectID> objects_being_reconstructed;
+  /** Tasks that are being claimed for re-execution. Objects created by the
+   *  same task share a single claim. */
+  std::unordered_set<TaskID> tasks_being_reconstructed;
+  /** Counters that track the progress of object reconstruction. */
+  ReconstructionStats reconstruction_stats;
 };
 
 /** Contains all information associated with a local scheduler client. */
@@ -103,6 +133,9 @@ struct LocalSchedulerClient {
    *  no task is running on the worker, this will be NULL. This is used to
    *  update the task table. */
   Task *task_in_progress;
+  /** The time at which task_in_progress was assigned to the client, in
+   *  microseconds since the Unix epoch. */
+  int64_t task_start_time_us;
   /** An array of resource counts currently in use by the worker.  */
   std::unordered_map<std::string, double> resources_in_use;
   /** A vector of the IDs of the GPUs that the worker is currently using. If the
@@ -262,6 +262,98 @@ TEST object_reconstruction_test(void) {
   }
 }
 
+/**
+ * Test that reconstructing several objects created by the same task only
+ * claims and resubmits the task once.
+ */
+TEST object_reconstruction_siblings_test(void) {
+  LocalSchedulerMock *local_scheduler = LocalSchedulerMock_init(0, 1);
+  LocalSchedulerConnection *worker = local_scheduler->conns[0];
+  LocalSchedulerState *state = local_scheduler->local_scheduler_state;
+
+  /* Create a task with zero dependencies and two return values. */
+  const int NUM_RETURNS = 2;
+  TaskExecutionSpec execution_spec =
+      example_task_execution_spec(0, NUM_RETURNS);
+  TaskSpec *spec = execution_spec.Spec();
+  int64_t task_size = execution_spec.SpecSize();
+
+  /* Add empty object table entries for the return values, to simulate them
+   * having been created and evicted. */
+  const char *client_id = "clientid";
+  std::vector<std::string> db_shards_addresses;
+  std::vector<int> db_shards_ports;
+  redisContext *context = redisConnect("127.0.0.1", 6379);
+  get_redis_shards(context, db_shards_addresses, db_shards_ports);
+  redisFree(context);
+  ASSERT(db_shards_addresses.size() == 1);
+  context = redisConnect(db_shards_addresses[0].c_str(), db_shards_ports[0]);
+  for (int i = 0; i < NUM_RETURNS; ++i) {
+    ObjectID return_id = TaskSpec_return(spec, i);
+    redisReply *reply = (redisReply *) redisCommand(
+        context, "RAY.OBJECT_TABLE_ADD %b %ld %b %s", return_id.data(),
+        sizeof(return_id), 1, NIL_DIGEST, (size_t) DIGEST_SIZE, client_id);
+    freeReplyObject(reply);
+    reply = (redisReply *) redisCommand(
+        context, "RAY.OBJECT_TABLE_REMOVE %b %s", return_id.data(),
+        sizeof(return_id), client_id);
+    freeReplyObject(reply);
+  }
+  redisFree(context);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    /* Make sure we receive the task twice. First from the initial submission,
+     * and second from the reconstruction of both return values. */
+    int64_t task_assigned_size;
+    local_scheduler_submit(worker, execution_spec);
+    TaskSpec *task_assigned =
+        local_scheduler_get_task(worker, &task_assigned_size);
+    ASSERT_EQ(memcmp(task_assigned, spec, task_size), 0);
+    int64_t reconstruct_task_size;
+    TaskSpec *reconstruct_task =
+        local_scheduler_get_task(worker, &reconstruct_task_size);
+    ASSERT_EQ(memcmp(reconstruct_task, spec, task_size), 0);
+    /* Clean up. */
+    free(reconstruct_task);
+    free(task_assigned);
+    LocalSchedulerMock_free(local_scheduler);
+    exit(0);
+  } else {
+    event_loop_add_timer(local_scheduler->loop, 500,
+                         (event_loop_timer_handler) timeout_handler, NULL);
+    event_loop_run(local_scheduler->loop);
+    /* Set the task's status to TASK_STATUS_DONE to prevent the race condition
+     * that would suppress object reconstruction. */
+    Task *task = Task_alloc(execution_spec, TASK_STATUS_DONE,
+                            get_db_client_id(state->db));
+#if !RAY_USE_NEW_GCS
+    task_table_add_task(state->db, task, NULL, NULL, NULL);
+#else
+    RAY_CHECK_OK(TaskTableAdd(&state->gcs_client, task));
+    Task_free(task);
+#endif
+
+    /* Reconstruct both return values at once, and run the event loop again. */
+    for (int i = 0; i < NUM_RETURNS; ++i) {
+      reconstruct_object(state, TaskSpec_return(spec, i));
+    }
+    event_loop_add_timer(local_scheduler->loop, 500,
+                         (event_loop_timer_handler) timeout_handler, NULL);
+    event_loop_run(local_scheduler->loop);
+    wait(NULL);
+    /* The second return value should have shared the first one's claim on the
+     * task. */
+    ASSERT_EQ(state->reconstruction_stats.num_requested, NUM_RETURNS);
+    ASSERT_EQ(state->reconstruction_stats.num_resubmitted, 1);
+    ASSERT_EQ(state->reconstruction_stats.num_deduplicated, NUM_RETURNS - 1);
+    ASSERT_EQ(state->objects_being_reconstructed.size(), 0);
+    ASSERT_EQ(state->tasks_being_reconstructed.size(), 0);
+    LocalSchedulerMock_free(local_scheduler);
+    PASS();
+  }
+}
+
 /**
  * Test that object reconstruction gets recursively called. In a chain of
  * tasks, if all inputs are lost, then reconstruction of the final object
@@ -695,6 +787,7 @@ TEST start_kill_workers_test(void) {
 
 SUITE(local_scheduler_tests) {
   RUN_REDIS_TEST(object_reconstruction_test);
+  RUN_REDIS_TEST(object_reconstruction_siblings_test);
   RUN_REDIS_TEST(object_reconstruction_recursive_test);
   RUN_REDIS_TEST(object_reconstruction_suppression_test);
   RUN_REDIS_TEST(task_dependency_test);
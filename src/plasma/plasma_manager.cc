@@ -14,6 +14,7 @@
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <strings.h>
 #include <poll.h>
@@ -21,6 +22,7 @@
 #include <netinet/in.h>
 
 /* C++ includes. */
+#include <algorithm>
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
@@ -123,9 +125,9 @@ void process_transfer_request(event_loop *loop,
                               ClientConnection *conn);
 
 /**
- * Receive object_id requested by this Plamsa Manager from the remote Plasma
- * Manager identified by client_sock. The object_id is sent via the data request
- * message.
+ * Receive a chunk of object_id requested by this Plamsa Manager from the
+ * remote Plasma Manager identified by client_sock. The chunk is sent after the
+ * data reply message.
  *
  * @param loop The event data structure.
  * @param client_sock The sender's socket.
@@ -203,6 +205,29 @@ struct WaitRequest {
   int64_t num_satisfied;
 };
 
+/** The state of an object whose chunks are being received from other plasma
+ *  managers. */
+struct ObjectReceive {
+  /** The buffer that the data and metadata of the object are received into.
+   */
+  uint8_t *data;
+  /** The total size of the data and metadata of the object. */
+  int64_t size;
+  /** The offsets of the chunks that have been received. */
+  std::unordered_set<int64_t> received_chunks;
+  /** The offsets of the chunks that connections are reading into the buffer.
+   *  Other copies of these chunks are discarded. */
+  std::unordered_set<int64_t> reading_chunks;
+  /** The number of bytes in the chunks that have been received. */
+  int64_t bytes_received;
+  /** Whether reading a chunk failed. If so, the object is aborted once no
+   *  connection is reading into it. */
+  bool failed;
+  /** The time (in milliseconds since the Unix epoch) when a chunk of the
+   *  object was last started or received. */
+  int64_t last_progress_time;
+};
+
 struct PlasmaManagerState {
   /** Event loop. */
   event_loop *loop;
@@ -210,8 +235,10 @@ struct PlasmaManagerState {
   plasma::PlasmaClient *plasma_conn;
   /** Hash table of all contexts for active connections to
    *  other plasma managers. These are used for writing data to
-   *  other plasma stores. */
-  std::unordered_map<std::string, ClientConnection *> manager_connections;
+   *  other plasma stores. There may be several connections to the same
+   *  manager, so that the chunks of large objects are sent in parallel. */
+  std::unordered_map<std::string, std::vector<ClientConnection *>>
+      manager_connections;
   DBHandle *db;
   /** The handle to the GCS (modern version of the above). */
   ray::gcs::AsyncGcsClient gcs_client;
@@ -243,11 +270,22 @@ struct PlasmaManagerState {
    *  successfully created for the corresponding object.
    *  The ObjectID is removed in process_add_object_notification, which is
    *  triggered by the corresponding notification from the plasma store.
-   *  If an object transfer fails, only the ObjectID of the corresponding
-   *  object is removed. If object transfers between managers is parallelized,
-   *  then all objects being received from a remote manager will need to be
-   *  removed if the connection to the remote manager fails. */
+   *  If an object transfer fails or stalls, only the ObjectID of the
+   *  corresponding object is removed. */
   std::unordered_set<ObjectID> receives_in_progress;
+  /** The objects whose chunks are being received, including the ones that a
+   *  failed transfer is still being cleaned up for. */
+  std::unordered_map<ObjectID, ObjectReceive> object_receives;
+  /** Index of the local objects by the SHA-256 digest of their contents. A
+   *  fetch for an object whose digest is in this index is completed by
+   *  copying one of the local objects instead of transferring the object. */
+  std::unordered_map<std::string, std::vector<ObjectID>>
+      local_objects_by_digest;
+  /** The digest of each local object in local_objects_by_digest, so that the
+   *  object can be removed from the index when it is deleted. */
+  std::unordered_map<ObjectID, std::string> local_object_digests;
+  /** Counters for the deduplication of objects with identical contents. */
+  DedupStats dedup_stats;
 };
 
 PlasmaManagerState *g_manager_state = NULL;
@@ -262,12 +300,10 @@ struct ClientConnection {
   /** Linked list of buffers to read or write. */
   /* TODO(swang): Split into two queues, data transfers and data requests. */
   std::list<PlasmaRequestBuffer *> transfer_queue;
-  /* A set of object IDs which are queued in the transfer_queue and waiting to
-   * be sent. This is used to avoid sending the same object ID to the same
-   * manager multiple times. */
-  std::unordered_map<ObjectID, PlasmaRequestBuffer *> pending_object_transfers;
-  /** Buffer used to receive transfers (data fetches) we want to ignore */
-  PlasmaRequestBuffer *ignore_buffer;
+  /* The number of chunks of each object which are queued in the
+   * transfer_queue and waiting to be sent. This is used to avoid sending the
+   * same object ID to the same manager multiple times. */
+  std::unordered_map<ObjectID, int64_t> pending_object_transfers;
   /** File descriptor for the socket connected to the other
    *  plasma manager. */
   int fd;
@@ -516,12 +552,10 @@ void PlasmaManagerState_free(PlasmaManagerState *state) {
   }
 
   /* We have to be careful here because ClientConnection_free modifies
-   * state->manager_connections in place. */
-  auto cc_it = state->manager_connections.begin();
-  while (cc_it != state->manager_connections.end()) {
-    auto next_it = std::next(cc_it, 1);
-    ClientConnection_free(cc_it->second);
-    cc_it = next_it;
+   * state->manager_connections in place. It removes the key of a connection
+   * along with the last connection under that key. */
+  while (!state->manager_connections.empty()) {
+    ClientConnection_free(state->manager_connections.begin()->second.front());
   }
 
   /* We have to be careful here because remove_fetch_request modifies
@@ -544,6 +578,10 @@ void PlasmaManagerState_free(PlasmaManagerState *state) {
   delete state;
 }
 
+DedupStats get_dedup_stats(PlasmaManagerState *state) {
+  return state->dedup_stats;
+}
+
 bool is_receiving_or_received(const PlasmaManagerState *state,
                               const ObjectID &object_id) {
   return state->local_available_objects.count(object_id) > 0 ||
@@ -561,30 +599,62 @@ void process_message(event_loop *loop,
                      void *context,
                      int events);
 
+/**
+ * Set whether reads and writes on a connection to another plasma manager block
+ * until the socket is ready. Object chunks are read and written without
+ * blocking the event loop. The control messages before them are small, and
+ * are read and written with the blocking helpers from io.h and plasma, which
+ * would spin if the socket were non-blocking. So a connection is only
+ * non-blocking while it reads or writes a chunk.
+ *
+ * @param fd The socket connected to the other plasma manager.
+ * @param blocking Whether reads and writes should block.
+ * @return Void.
+ */
+void set_blocking(int fd, bool blocking) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  RAY_CHECK(flags != -1);
+  flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+  RAY_CHECK(fcntl(fd, F_SETFL, flags) == 0);
+}
+
 int write_object_chunk(ClientConnection *conn, PlasmaRequestBuffer *buf) {
-  ssize_t r, s;
-  /* Try to write one buf_size at a time. */
-  s = buf->data_size + buf->metadata_size - conn->cursor;
-  if (s > RayConfig::instance().buf_size()) {
-    s = RayConfig::instance().buf_size();
-  }
-  r = write(conn->fd, buf->data + conn->cursor, s);
-
-  int err;
-  if (r <= 0) {
-    RAY_LOG(ERROR) << "Write error";
-    err = errno;
-  } else {
-    conn->cursor += r;
-    RAY_CHECK(conn->cursor <= buf->data_size + buf->metadata_size);
-    /* If we've finished writing this buffer, reset the cursor. */
-    if (conn->cursor == buf->data_size + buf->metadata_size) {
-      RAY_LOG(DEBUG) << "writing on channel " << conn->fd << " finished";
-      ClientConnection_finish_request(conn);
+  const int64_t header_size = sizeof(buf->chunk);
+  const int64_t total_size = header_size + buf->chunk.length;
+  /* Write as much of the header and data as the socket accepts, so that large
+   * chunks take few wakeups of the event loop. */
+  while (conn->cursor < total_size) {
+    struct iovec iov[2];
+    int iovcnt = 0;
+    if (conn->cursor < header_size) {
+      iov[iovcnt].iov_base = (uint8_t *) &buf->chunk + conn->cursor;
+      iov[iovcnt].iov_len = header_size - conn->cursor;
+      iovcnt++;
+    }
+    int64_t data_cursor = std::max(conn->cursor - header_size, int64_t(0));
+    if (data_cursor < buf->chunk.length) {
+      iov[iovcnt].iov_base = buf->data + buf->chunk.offset + data_cursor;
+      iov[iovcnt].iov_len = buf->chunk.length - data_cursor;
+      iovcnt++;
+    }
+    ssize_t r = writev(conn->fd, iov, iovcnt);
+    if (r < 0) {
+      int err = errno;
+      if (err == EINTR) {
+        continue;
+      }
+      if (err == EAGAIN || err == EWOULDBLOCK) {
+        /* Wait until the socket is writable again. */
+        return 0;
+      }
+      RAY_LOG(ERROR) << "Write error";
+      return err;
     }
-    err = 0;
+    conn->cursor += r;
   }
-  return err;
+  RAY_LOG(DEBUG) << "writing on channel " << conn->fd << " finished";
+  ClientConnection_finish_request(conn);
+  return 0;
 }
 
 void send_queued_request(event_loop *loop,
@@ -614,17 +684,23 @@ void send_queued_request(event_loop *loop,
   case MessageType_PlasmaDataReply:
     RAY_LOG(DEBUG) << "Transferring object to manager";
     if (ClientConnection_request_finished(conn)) {
-      /* If the cursor is not set, we haven't sent any requests for this object
-       * yet, so send the initial data request. */
+      /* If the cursor is not set, we haven't sent any requests for this chunk
+       * yet, so send the initial data request. Then write the chunk without
+       * blocking. */
       err = handle_sigpipe(
           plasma::SendDataReply(conn->fd, buf->object_id.to_plasma_id(),
                                 buf->data_size, buf->metadata_size),
           conn->fd);
       ClientConnection_start_request(conn);
+      set_blocking(conn->fd, false);
     }
     if (err == 0) {
       err = write_object_chunk(conn, buf);
     }
+    if (err == 0 && ClientConnection_request_finished(conn)) {
+      /* The next message on this connection starts with a control message. */
+      set_blocking(conn->fd, true);
+    }
     break;
   default:
     RAY_LOG(FATAL) << "Buffered request has unknown type.";
@@ -632,24 +708,31 @@ void send_queued_request(event_loop *loop,
 
   /* If the other side hung up, stop sending to this manager. */
   if (err != 0) {
-    if (buf->type == MessageType_PlasmaDataReply) {
-      /* We errored while sending the object, so release it before removing the
-       * connection. The corresponding call to plasma_get occurred in
-       * process_transfer_request. */
-      ARROW_CHECK_OK(conn->manager_state->plasma_conn->Release(
-          buf->object_id.to_plasma_id()));
+    /* We errored while sending, so release the objects whose chunks are queued
+     * on this connection before removing it. The corresponding calls to
+     * plasma_get occurred in process_transfer_request. */
+    for (auto queued_buf : conn->transfer_queue) {
+      if (queued_buf->type == MessageType_PlasmaDataReply) {
+        ARROW_CHECK_OK(conn->manager_state->plasma_conn->Release(
+            queued_buf->object_id.to_plasma_id()));
+      }
     }
     event_loop_remove_file(loop, conn->fd);
     ClientConnection_free(conn);
   } else if (ClientConnection_request_finished(conn)) {
     /* If we are done with this request, remove it from the transfer queue. */
     if (buf->type == MessageType_PlasmaDataReply) {
-      /* We are done sending the object, so release it. The corresponding call
-       * to plasma_get occurred in process_transfer_request. */
+      /* We are done sending the chunk, so release the object. The
+       * corresponding call to plasma_get occurred in process_transfer_request.
+       */
       ARROW_CHECK_OK(conn->manager_state->plasma_conn->Release(
           buf->object_id.to_plasma_id()));
-      /* Remove the object from the hash table of pending transfer requests. */
-      conn->pending_object_transfers.erase(buf->object_id);
+      /* Remove the object from the hash table of pending transfer requests
+       * once all of its chunks on this connection have been sent. */
+      auto pending_it = conn->pending_object_transfers.find(buf->object_id);
+      if (--pending_it->second == 0) {
+        conn->pending_object_transfers.erase(pending_it);
+      }
     }
     conn->transfer_queue.pop_front();
     delete buf;
@@ -657,30 +740,145 @@ void send_queued_request(event_loop *loop,
 }
 
 int read_object_chunk(ClientConnection *conn, PlasmaRequestBuffer *buf) {
-  ssize_t r, s;
   RAY_CHECK(buf != NULL);
-  /* Try to read one buf_size at a time. */
-  s = buf->data_size + buf->metadata_size - conn->cursor;
-  if (s > RayConfig::instance().buf_size()) {
-    s = RayConfig::instance().buf_size();
+  /* The buffer that discarded chunks are read into. */
+  static std::vector<uint8_t> discard_buffer(RayConfig::instance().buf_size());
+  const int64_t header_size = sizeof(buf->chunk);
+  const bool reading_header = conn->cursor < header_size;
+  const int64_t end = header_size + (reading_header ? 0 : buf->chunk.length);
+  while (conn->cursor < end) {
+    uint8_t *destination;
+    int64_t s = end - conn->cursor;
+    if (reading_header) {
+      destination = (uint8_t *) &buf->chunk + conn->cursor;
+    } else if (buf->data == NULL) {
+      destination = discard_buffer.data();
+      s = std::min(s, static_cast<int64_t>(discard_buffer.size()));
+    } else {
+      destination =
+          buf->data + buf->chunk.offset + (conn->cursor - header_size);
+    }
+    ssize_t r = read(conn->fd, destination, s);
+    if (r < 0) {
+      int err = errno;
+      if (err == EINTR) {
+        continue;
+      }
+      if (err == EAGAIN || err == EWOULDBLOCK) {
+        /* Wait until more data arrives on the socket. */
+        return 0;
+      }
+      RAY_LOG(ERROR) << "Read error";
+      return err;
+    } else if (r == 0) {
+      RAY_LOG(ERROR) << "Connection closed while reading an object chunk";
+      return ECONNRESET;
+    }
+    conn->cursor += r;
   }
-  r = read(conn->fd, buf->data + conn->cursor, s);
 
-  int err;
-  if (r <= 0) {
-    RAY_LOG(ERROR) << "Read error";
-    err = errno;
-  } else {
-    conn->cursor += r;
-    RAY_CHECK(conn->cursor <= buf->data_size + buf->metadata_size);
-    /* If the cursor is equal to the full object size, reset the cursor and
-     * we're done. */
-    if (conn->cursor == buf->data_size + buf->metadata_size) {
-      ClientConnection_finish_request(conn);
+  if (reading_header) {
+    /* Check that the chunk lies within the object before reading its data. */
+    int64_t object_size = buf->data_size + buf->metadata_size;
+    if (buf->chunk.offset < 0 || buf->chunk.length < 0 ||
+        buf->chunk.offset > object_size - buf->chunk.length) {
+      RAY_LOG(ERROR) << "Received a chunk at offset " << buf->chunk.offset
+                     << " of length " << buf->chunk.length
+                     << " for an object of size " << object_size;
+      return EINVAL;
     }
-    err = 0;
+    return 0;
+  }
+  /* If we've read the whole chunk, reset the cursor and we're done. */
+  ClientConnection_finish_request(conn);
+  return 0;
+}
+
+/**
+ * Abort an object that was being received, so that it is fetched again.
+ *
+ * @param state The plasma manager state.
+ * @param object_id The ID of the object to abort.
+ * @return Void.
+ */
+void abort_object_receive(PlasmaManagerState *state, ObjectID object_id) {
+  /* Remove the object from the receives_in_progress set so that retries are
+   * processed. */
+  state->receives_in_progress.erase(object_id);
+  state->object_receives.erase(object_id);
+  /* The release corresponds to the call to plasma_create that occurred in
+   * process_data_request. */
+  ARROW_CHECK_OK(state->plasma_conn->Release(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(state->plasma_conn->Abort(object_id.to_plasma_id()));
+}
+
+/**
+ * Choose where to read a chunk whose header has just been read. The chunk is
+ * read into the object if this manager is receiving the object and no copy of
+ * the chunk has been received or is being read yet. Otherwise, it is
+ * discarded.
+ *
+ * @param state The plasma manager state.
+ * @param buf The buffer of the chunk. Its data is set to the buffer of the
+ *        object, if the chunk should be read into it.
+ * @return Void.
+ */
+void start_chunk_receive(PlasmaManagerState *state, PlasmaRequestBuffer *buf) {
+  auto receive_it = state->object_receives.find(buf->object_id);
+  if (receive_it == state->object_receives.end()) {
+    return;
+  }
+  ObjectReceive &receive = receive_it->second;
+  if (receive.failed || receive.size != buf->data_size + buf->metadata_size ||
+      receive.received_chunks.count(buf->chunk.offset) > 0 ||
+      receive.reading_chunks.count(buf->chunk.offset) > 0) {
+    return;
+  }
+  receive.reading_chunks.insert(buf->chunk.offset);
+  receive.last_progress_time = current_time_ms();
+  buf->data = receive.data;
+}
+
+/**
+ * Account for a chunk that was read into an object, or that failed to be read.
+ * Once all chunks of the object have been received, the object is sealed, and
+ * if a chunk failed, the object is aborted once no connection is reading into
+ * it anymore.
+ *
+ * @param state The plasma manager state.
+ * @param buf The buffer of the chunk.
+ * @param success Whether the whole chunk was read.
+ * @return Void.
+ */
+void finish_chunk_receive(PlasmaManagerState *state,
+                          PlasmaRequestBuffer *buf,
+                          bool success) {
+  auto receive_it = state->object_receives.find(buf->object_id);
+  RAY_CHECK(receive_it != state->object_receives.end());
+  ObjectReceive &receive = receive_it->second;
+  receive.reading_chunks.erase(buf->chunk.offset);
+  if (success) {
+    receive.received_chunks.insert(buf->chunk.offset);
+    receive.bytes_received += buf->chunk.length;
+    receive.last_progress_time = current_time_ms();
+  } else {
+    receive.failed = true;
+  }
+  if (!receive.reading_chunks.empty()) {
+    return;
+  }
+  if (receive.failed) {
+    abort_object_receive(state, buf->object_id);
+  } else if (receive.bytes_received == receive.size) {
+    /* If we're done receiving the object, seal the object and release it. The
+     * release corresponds to the call to plasma_create that occurred in
+     * process_data_request. The seal also triggers notification of clients
+     * for fetch or wait requests, see process_object_notification. */
+    RAY_LOG(DEBUG) << "receiving object " << buf->object_id << " finished";
+    state->object_receives.erase(receive_it);
+    ARROW_CHECK_OK(state->plasma_conn->Seal(buf->object_id.to_plasma_id()));
+    ARROW_CHECK_OK(state->plasma_conn->Release(buf->object_id.to_plasma_id()));
   }
-  return err;
 }
 
 void process_data_chunk(event_loop *loop,
@@ -689,36 +887,37 @@ void process_data_chunk(event_loop *loop,
                         int events) {
   /* Read the object chunk. */
   ClientConnection *conn = (ClientConnection *) context;
+  PlasmaManagerState *state = conn->manager_state;
   PlasmaRequestBuffer *buf = conn->transfer_queue.front();
+  const int64_t header_size = sizeof(buf->chunk);
+  const bool header_was_read = conn->cursor >= header_size;
   int err = read_object_chunk(conn, buf);
-  auto plasma_conn = conn->manager_state->plasma_conn;
+  if (err == 0 && !header_was_read && conn->cursor == header_size) {
+    /* Now that we know which chunk this is, read its data into the object or
+     * discard it. */
+    start_chunk_receive(state, buf);
+    err = read_object_chunk(conn, buf);
+  }
   if (err != 0) {
-    // Remove the object from the receives_in_progress set so that
-    // retries are processed.
-    // TODO(hme): Remove all ObjectIDs associated with this manager if we
-    // allow parallel object transfers.
-    conn->manager_state->receives_in_progress.erase(buf->object_id);
-    /* Abort the object that we were trying to read from the remote plasma
+    /* Fail the object that we were trying to read from the remote plasma
      * manager. */
-    ARROW_CHECK_OK(plasma_conn->Release(buf->object_id.to_plasma_id()));
-    ARROW_CHECK_OK(plasma_conn->Abort(buf->object_id.to_plasma_id()));
+    if (buf->data != NULL) {
+      finish_chunk_receive(state, buf, false);
+    }
     /* Remove the bad connection. */
     event_loop_remove_file(loop, data_sock);
     ClientConnection_free(conn);
   } else if (ClientConnection_request_finished(conn)) {
-    /* If we're done receiving the object, seal the object and release it. The
-     * release corresponds to the call to plasma_create that occurred in
-     * process_data_request. */
     RAY_LOG(DEBUG) << "reading on channel " << data_sock << " finished";
-    /* The following seal also triggers notification of clients for fetch or
-     * wait requests, see process_object_notification. */
-    ARROW_CHECK_OK(plasma_conn->Seal(buf->object_id.to_plasma_id()));
-    ARROW_CHECK_OK(plasma_conn->Release(buf->object_id.to_plasma_id()));
-    /* Remove the request buffer used for reading this object's data. */
+    if (buf->data != NULL) {
+      finish_chunk_receive(state, buf, true);
+    }
+    /* Remove the request buffer used for reading this chunk. */
     conn->transfer_queue.pop_front();
     delete buf;
     /* Switch to listening for requests from this socket, instead of reading
-     * object data. */
+     * object data. Requests are read with blocking reads. */
+    set_blocking(data_sock, true);
     event_loop_remove_file(loop, data_sock);
     bool success = event_loop_add_file(loop, data_sock, EVENT_LOOP_READ,
                                        process_message, conn);
@@ -728,31 +927,27 @@ void process_data_chunk(event_loop *loop,
   }
 }
 
-void ignore_data_chunk(event_loop *loop,
-                       int data_sock,
-                       void *context,
-                       int events) {
-  /* Read the object chunk. */
-  ClientConnection *conn = (ClientConnection *) context;
-  PlasmaRequestBuffer *buf = conn->ignore_buffer;
-
-  /* Just read the transferred data into ignore_buf and then drop (free) it. */
-  int err = read_object_chunk(conn, buf);
-  if (err != 0) {
-    event_loop_remove_file(loop, data_sock);
-    ClientConnection_free(conn);
-  } else if (ClientConnection_request_finished(conn)) {
-    free(buf->data);
-    delete buf;
-    /* Switch to listening for requests from this socket, instead of reading
-     * object data. */
-    event_loop_remove_file(loop, data_sock);
-    bool success = event_loop_add_file(loop, data_sock, EVENT_LOOP_READ,
-                                       process_message, conn);
-    if (!success) {
-      ClientConnection_free(conn);
-    }
+/**
+ * Open a new connection to the remote manager at the specified address.
+ *
+ * @param state Our plasma manager state.
+ * @param ip_addr The IP address of the remote manager we want to connect to.
+ * @param port The port that the remote manager is listening on.
+ * @return A pointer to the connection, or NULL if we could not connect.
+ */
+ClientConnection *open_manager_connection(PlasmaManagerState *state,
+                                          const char *ip_addr,
+                                          int port) {
+  int fd = connect_inet_sock(ip_addr, port);
+  if (fd < 0) {
+    return NULL;
   }
+  std::string ip_addr_port = std::string(ip_addr) + ":" + std::to_string(port);
+  return ClientConnection_init(state, fd, ip_addr_port);
+}
+
+bool queued_request_less(ClientConnection *conn1, ClientConnection *conn2) {
+  return conn1->transfer_queue.size() < conn2->transfer_queue.size();
 }
 
 ClientConnection *get_manager_connection(PlasmaManagerState *state,
@@ -761,20 +956,59 @@ ClientConnection *get_manager_connection(PlasmaManagerState *state,
   /* TODO(swang): Should probably check whether ip_addr and port belong to us.
    */
   std::string ip_addr_port = std::string(ip_addr) + ":" + std::to_string(port);
-  ClientConnection *manager_conn;
   auto cc_it = state->manager_connections.find(ip_addr_port);
   if (cc_it == state->manager_connections.end()) {
     /* If we don't already have a connection to this manager, start one. */
-    int fd = connect_inet_sock(ip_addr, port);
-    if (fd < 0) {
-      return NULL;
-    }
+    return open_manager_connection(state, ip_addr, port);
+  }
+  return *std::min_element(cc_it->second.begin(), cc_it->second.end(),
+                           queued_request_less);
+}
 
-    manager_conn = ClientConnection_init(state, fd, ip_addr_port);
-  } else {
-    manager_conn = cc_it->second;
+/**
+ * Get the connections to the remote manager at the specified address to send
+ * the chunks of an object on. While fewer connections than chunks are idle,
+ * this opens new connections to the manager, up to
+ * manager_connections_per_peer of them.
+ *
+ * @param state Our plasma manager state.
+ * @param ip_addr The IP address of the remote manager we want to connect to.
+ * @param port The port that the remote manager is listening on.
+ * @param num_chunks The number of chunks to send.
+ * @return The connections to the remote manager, least busy first. This is
+ *         empty if there are none and we could not connect.
+ */
+std::vector<ClientConnection *> get_manager_connections(
+    PlasmaManagerState *state,
+    const char *ip_addr,
+    int port,
+    int64_t num_chunks) {
+  std::string ip_addr_port = std::string(ip_addr) + ":" + std::to_string(port);
+  std::vector<ClientConnection *> manager_conns;
+  auto cc_it = state->manager_connections.find(ip_addr_port);
+  if (cc_it != state->manager_connections.end()) {
+    manager_conns = cc_it->second;
+  }
+  int64_t num_idle = 0;
+  for (auto manager_conn : manager_conns) {
+    if (manager_conn->transfer_queue.size() == 0) {
+      num_idle++;
+    }
+  }
+  while (num_idle < num_chunks &&
+         static_cast<int64_t>(manager_conns.size()) <
+             RayConfig::instance().manager_connections_per_peer()) {
+    ClientConnection *manager_conn =
+        open_manager_connection(state, ip_addr, port);
+    if (manager_conn == NULL) {
+      break;
+    }
+    manager_conns.push_back(manager_conn);
+    num_idle++;
   }
-  return manager_conn;
+  std::stable_sort(manager_conns.begin(), manager_conns.end(),
+                   queued_request_less);
+  return manager_conns;
 }
 
 void process_transfer_request(event_loop *loop,
@@ -782,25 +1016,24 @@ void process_transfer_request(event_loop *loop,
                               const char *addr,
                               int port,
                               ClientConnection *conn) {
-  ClientConnection *manager_conn =
-      get_manager_connection(conn->manager_state, addr, port);
-  if (manager_conn == NULL) {
-    return;
-  }
-
-  /* If there is already a request in the transfer queue with the same object
-   * ID, do not add the transfer request. */
-  auto pending_it = manager_conn->pending_object_transfers.find(obj_id);
-  if (pending_it != manager_conn->pending_object_transfers.end()) {
-    return;
+  PlasmaManagerState *state = conn->manager_state;
+  /* If there are already chunks in the transfer queues to this manager with
+   * the same object ID, do not add the transfer request. */
+  std::string ip_addr_port = std::string(addr) + ":" + std::to_string(port);
+  auto cc_it = state->manager_connections.find(ip_addr_port);
+  if (cc_it != state->manager_connections.end()) {
+    for (auto manager_conn : cc_it->second) {
+      if (manager_conn->pending_object_transfers.count(obj_id) > 0) {
+        return;
+      }
+    }
   }
 
   /* Allocate and append the request to the transfer queue. */
   plasma::ObjectBuffer object_buffer;
   plasma::ObjectID object_id = obj_id.to_plasma_id();
   /* We pass in 0 to indicate that the command should return immediately. */
-  ARROW_CHECK_OK(
-      conn->manager_state->plasma_conn->Get(&object_id, 1, 0, &object_buffer));
+  ARROW_CHECK_OK(state->plasma_conn->Get(&object_id, 1, 0, &object_buffer));
   if (object_buffer.data == nullptr) {
     /* If the object wasn't locally available, exit immediately. If the object
      * later appears locally, the requesting plasma manager should request the
@@ -809,37 +1042,65 @@ void process_transfer_request(event_loop *loop,
                      << "manager, object not local.";
     return;
   }
-
+  RAY_CHECK(object_buffer.metadata->data() ==
+            object_buffer.data->data() + object_buffer.data->size());
+  int64_t object_size =
+      object_buffer.data->size() + object_buffer.metadata->size();
+  int64_t chunk_size = RayConfig::instance().manager_chunk_size();
+  int64_t num_chunks =
+      std::max((object_size + chunk_size - 1) / chunk_size, int64_t(1));
+
+  std::vector<ClientConnection *> manager_conns =
+      get_manager_connections(state, addr, port, num_chunks);
   /* If we already have a connection to this manager and its inactive,
    * (re)register it with the event loop again. */
-  if (manager_conn->transfer_queue.size() == 0) {
-    bool success = event_loop_add_file(loop, manager_conn->fd, EVENT_LOOP_WRITE,
-                                       send_queued_request, manager_conn);
-    if (!success) {
+  for (auto it = manager_conns.begin(); it != manager_conns.end();) {
+    ClientConnection *manager_conn = *it;
+    if (manager_conn->transfer_queue.size() == 0 &&
+        !event_loop_add_file(loop, manager_conn->fd, EVENT_LOOP_WRITE,
+                             send_queued_request, manager_conn)) {
       ClientConnection_free(manager_conn);
-      return;
+      it = manager_conns.erase(it);
+    } else {
+      ++it;
     }
   }
+  if (manager_conns.empty()) {
+    ARROW_CHECK_OK(state->plasma_conn->Release(object_id));
+    return;
+  }
 
-  RAY_CHECK(object_buffer.metadata->data() ==
-            object_buffer.data->data() + object_buffer.data->size());
-  PlasmaRequestBuffer *buf = new PlasmaRequestBuffer();
-  buf->type = MessageType_PlasmaDataReply;
-  buf->object_id = obj_id;
-  /* We treat buf->data as a pointer to the concatenated data and metadata, so
-   * we don't actually use buf->metadata. */
-  buf->data = const_cast<uint8_t *>(object_buffer.data->data());
-  buf->data_size = object_buffer.data->size();
-  buf->metadata_size = object_buffer.metadata->size();
-
-  manager_conn->transfer_queue.push_back(buf);
-  manager_conn->pending_object_transfers[object_id] = buf;
+  /* Spread the chunks over the connections, starting with the least busy
+   * one. */
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    if (i > 0) {
+      /* Each chunk holds a reference to the object until it has been sent. The
+       * object is still local, since we hold the reference of the first chunk.
+       */
+      ARROW_CHECK_OK(state->plasma_conn->Get(&object_id, 1, 0, &object_buffer));
+      RAY_CHECK(object_buffer.data != nullptr);
+    }
+    ClientConnection *manager_conn = manager_conns[i % manager_conns.size()];
+    PlasmaRequestBuffer *buf = new PlasmaRequestBuffer();
+    buf->type = MessageType_PlasmaDataReply;
+    buf->object_id = obj_id;
+    /* We treat buf->data as a pointer to the concatenated data and metadata,
+     * so we don't actually use buf->metadata. */
+    buf->data = const_cast<uint8_t *>(object_buffer.data->data());
+    buf->data_size = object_buffer.data->size();
+    buf->metadata_size = object_buffer.metadata->size();
+    buf->chunk.offset = i * chunk_size;
+    buf->chunk.length = std::min(chunk_size, object_size - buf->chunk.offset);
+
+    manager_conn->transfer_queue.push_back(buf);
+    manager_conn->pending_object_transfers[obj_id] += 1;
+  }
 }
 
 /**
- * Receive object_id requested by this Plamsa Manager from the remote Plasma
- * Manager identified by client_sock. The object_id is sent via the data requst
- * message.
+ * Receive a chunk of object_id requested by this Plamsa Manager from the
+ * remote Plasma Manager identified by client_sock. The chunk is sent after the
+ * data reply message.
  *
  * @param loop The event data structure.
  * @param client_sock The sender's socket.
@@ -855,55 +1116,53 @@ void process_data_request(event_loop *loop,
                           int64_t data_size,
                           int64_t metadata_size,
                           ClientConnection *conn) {
+  PlasmaManagerState *state = conn->manager_state;
   PlasmaRequestBuffer *buf = new PlasmaRequestBuffer();
   buf->object_id = object_id;
   buf->data_size = data_size;
   buf->metadata_size = metadata_size;
-
-  /* The corresponding call to plasma_release should happen in
-   * process_data_chunk. */
-  std::shared_ptr<Buffer> data;
-  plasma::Status s = conn->manager_state->plasma_conn->Create(
-      object_id.to_plasma_id(), data_size, NULL, metadata_size, &data);
-
-  /* If success_create == true, a new object has been created.
-   * If success_create == false the object creation has failed, possibly
-   * due to an object with the same ID already existing in the Plasma Store. */
-  if (s.ok()) {
-    /* Add buffer where the fetched data is to be stored to
-     * conn->transfer_queue. */
-    conn->transfer_queue.push_back(buf);
+  /* The buffer to read the chunk into is chosen once its header has been read,
+   * in start_chunk_receive. */
+  buf->data = NULL;
+
+  /* The object is created when its first chunk arrives. The other chunks are
+   * read into the same object, whichever connection they arrive on. */
+  if (state->object_receives.count(object_id) == 0) {
+    /* The corresponding call to plasma_release should happen once all chunks
+     * have been received, or when the receive is aborted. */
+    std::shared_ptr<Buffer> data;
+    plasma::Status s = state->plasma_conn->Create(
+        object_id.to_plasma_id(), data_size, NULL, metadata_size, &data);
+    /* If the object creation has failed, possibly due to an object with the
+     * same ID already existing in the Plasma Store, the chunk is read and
+     * discarded. */
+    if (s.ok()) {
+      // Monitor objects that are in progress of being received.
+      // If a read fails while receiving this object, its
+      // ObjectID will be removed. If the object is successfully
+      // received, its ObjectID is removed by process_add_object_notification.
+      // If a shared buffer for the object cannot be created,
+      // then the receive is ignored, and the corresponding ObjectID
+      // is not inserted into receives_in_progress.
+      state->receives_in_progress.insert(object_id);
+      ObjectReceive &receive = state->object_receives[object_id];
+      receive.data = data->mutable_data();
+      receive.size = data_size + metadata_size;
+      receive.bytes_received = 0;
+      receive.failed = false;
+      receive.last_progress_time = current_time_ms();
+    }
   }
+  conn->transfer_queue.push_back(buf);
   RAY_CHECK(ClientConnection_request_finished(conn));
   ClientConnection_start_request(conn);
 
-  /* Switch to reading the data from this socket, instead of listening for
-   * other requests. */
+  /* Switch to reading the data from this socket without blocking, instead of
+   * listening for other requests. */
+  set_blocking(client_sock, false);
   event_loop_remove_file(loop, client_sock);
-  event_loop_file_handler data_chunk_handler;
-  if (s.ok()) {
-    // Monitor objects that are in progress of being received.
-    // If a read fails while receiving this object, its
-    // ObjectID will be removed. If the object is successfully
-    // received, its ObjectID is removed by process_add_object_notification.
-    // If a shared buffer for the object cannot be created,
-    // then the receive is ignored, and the corresponding ObjectID
-    // is not inserted into receives_in_progress.
-    conn->manager_state->receives_in_progress.insert(object_id);
-    buf->data = data->mutable_data();
-    data_chunk_handler = process_data_chunk;
-  } else {
-    /* Since plasma_create() has failed, we ignore the data transfer. We will
-     * receive this transfer in g_ignore_buf and then drop it. Allocate memory
-     * for data and metadata, if needed. All memory associated with
-     * buf/g_ignore_buf will be freed in ignore_data_chunkc(). */
-    conn->ignore_buffer = buf;
-    buf->data = (uint8_t *) malloc(buf->data_size + buf->metadata_size);
-    data_chunk_handler = ignore_data_chunk;
-  }
-
   bool success = event_loop_add_file(loop, client_sock, EVENT_LOOP_READ,
-                                     data_chunk_handler, conn);
+                                     process_data_chunk, conn);
   if (!success) {
     ClientConnection_free(conn);
   }
@@ -956,6 +1215,25 @@ void request_transfer_from(PlasmaManagerState *manager_state,
 int fetch_timeout_handler(event_loop *loop, timer_id id, void *context) {
   PlasmaManagerState *manager_state = (PlasmaManagerState *) context;
 
+  /* Abort the objects whose chunks stopped arriving, for example because the
+   * sending manager died between chunks, so that they are fetched again. We
+   * have to be careful here because abort_object_receive modifies
+   * manager_state->object_receives in place. */
+  int64_t current_time = current_time_ms();
+  auto receive_it = manager_state->object_receives.begin();
+  while (receive_it != manager_state->object_receives.end()) {
+    auto next_it = std::next(receive_it, 1);
+    const ObjectReceive &receive = receive_it->second;
+    if (receive.reading_chunks.empty() &&
+        current_time - receive.last_progress_time >
+            RayConfig::instance().manager_receive_timeout_milliseconds()) {
+      RAY_LOG(WARNING) << "Receiving object " << receive_it->first
+                       << " stalled, fetching it again.";
+      abort_object_receive(manager_state, receive_it->first);
+    }
+    receive_it = next_it;
+  }
+
   /* Allocate a vector of object IDs to resend requests for location
    * notifications. */
   int num_object_ids_to_request = 0;
@@ -1047,6 +1325,84 @@ void request_transfer(ObjectID object_id,
   }
 }
 
+/**
+ * Get the key under which objects are indexed by their contents. Only SHA-256
+ * digests are used, since two objects with the same one can be assumed to
+ * have the same contents. The plasma store's digests are too short for that,
+ * and the object table stores them padded with zeros, which a SHA-256 digest
+ * is practically never.
+ *
+ * @param digest The digest of an object's contents, as stored in the object
+ *        table.
+ * @return The key, or an empty string if the digest does not identify the
+ *         object's contents.
+ */
+std::string digest_key(const std::string &digest) {
+  const size_t padding_size = DIGEST_SIZE - plasma::kDigestSize;
+  if (digest.size() != DIGEST_SIZE ||
+      digest.compare(plasma::kDigestSize, padding_size,
+                     std::string(padding_size, '\0')) == 0) {
+    return std::string();
+  }
+  return digest;
+}
+
+bool fetch_from_local_duplicate(PlasmaManagerState *manager_state,
+                                ObjectID object_id,
+                                int64_t object_size,
+                                const std::string &digest) {
+  /* The copy runs on the event loop, so only small objects are copied. */
+  if (object_size > RayConfig::instance().manager_dedup_max_object_size()) {
+    return false;
+  }
+  auto it = manager_state->local_objects_by_digest.find(digest_key(digest));
+  if (it == manager_state->local_objects_by_digest.end()) {
+    return false;
+  }
+  plasma::PlasmaClient *plasma_conn = manager_state->plasma_conn;
+  for (ObjectID source_id : it->second) {
+    plasma::ObjectBuffer source;
+    plasma::ObjectID plasma_source_id = source_id.to_plasma_id();
+    /* We pass in 0 to indicate that the command should return immediately. */
+    ARROW_CHECK_OK(plasma_conn->Get(&plasma_source_id, 1, 0, &source));
+    if (source.data == nullptr) {
+      /* The object was evicted, and we have not processed the notification
+       * yet. */
+      continue;
+    }
+    RAY_CHECK(source.metadata->data() ==
+              source.data->data() + source.data->size());
+    int64_t data_size = source.data->size();
+    int64_t metadata_size = source.metadata->size();
+    bool copied = false;
+    if (data_size + metadata_size == object_size) {
+      std::shared_ptr<Buffer> data;
+      plasma::Status s = plasma_conn->Create(object_id.to_plasma_id(),
+                                             data_size, NULL, metadata_size,
+                                             &data);
+      if (s.ok()) {
+        /* As in a transfer, the data and metadata are copied together. */
+        memcpy(data->mutable_data(), source.data->data(), object_size);
+        /* The object is received once the plasma store notifies us that it
+         * was sealed, as for a transfer. */
+        manager_state->receives_in_progress.insert(object_id);
+        ARROW_CHECK_OK(plasma_conn->Seal(object_id.to_plasma_id()));
+        ARROW_CHECK_OK(plasma_conn->Release(object_id.to_plasma_id()));
+        manager_state->dedup_stats.num_fetch_hits += 1;
+        manager_state->dedup_stats.num_bytes_saved += object_size;
+        RAY_LOG(DEBUG) << "Fetched " << object_id << " by copying local object "
+                       << source_id << " with the same contents";
+        copied = true;
+      }
+    }
+    ARROW_CHECK_OK(plasma_conn->Release(plasma_source_id));
+    if (copied) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /* This method is only called from the tests. */
 void call_request_transfer(ObjectID object_id,
                            const std::vector<std::string> &manager_vector,
@@ -1070,6 +1426,7 @@ void fatal_table_callback(ObjectID id, void *user_context, void *user_data) {
 void object_table_subscribe_callback(ObjectID object_id,
                                      int64_t data_size,
                                      const std::vector<DBClientID> &manager_ids,
+                                     const std::string &digest,
                                      void *context) {
   PlasmaManagerState *manager_state = (PlasmaManagerState *) context;
   const std::vector<std::string> managers =
@@ -1078,7 +1435,13 @@ void object_table_subscribe_callback(ObjectID object_id,
   auto it = manager_state->fetch_requests.find(object_id);
 
   if (it != manager_state->fetch_requests.end()) {
-    request_transfer(object_id, managers, context);
+    /* If a local object has the same contents, copy it instead of
+     * transferring the object from a remote manager. */
+    if (is_receiving_or_received(manager_state, object_id) ||
+        !fetch_from_local_duplicate(manager_state, object_id, data_size,
+                                    digest)) {
+      request_transfer(object_id, managers, context);
+    }
   }
   /* Run the callback for wait requests. */
   update_object_wait_requests(manager_state, object_id,
@@ -1281,9 +1644,45 @@ void process_status_request(ClientConnection *client_conn,
                       request_status_done, client_conn);
 }
 
+void remove_object_digest(PlasmaManagerState *state, ObjectID object_id) {
+  auto it = state->local_object_digests.find(object_id);
+  if (it == state->local_object_digests.end()) {
+    return;
+  }
+  auto digest_it = state->local_objects_by_digest.find(it->second);
+  RAY_CHECK(digest_it != state->local_objects_by_digest.end());
+  std::vector<ObjectID> &object_ids = digest_it->second;
+  object_ids.erase(
+      std::find(object_ids.begin(), object_ids.end(), object_id));
+  if (object_ids.empty()) {
+    state->local_objects_by_digest.erase(digest_it);
+  }
+  state->local_object_digests.erase(it);
+}
+
+void add_object_digest(PlasmaManagerState *state,
+                       ObjectID object_id,
+                       const std::string &digest) {
+  std::string key = digest_key(digest);
+  if (key.empty() || state->local_object_digests.count(object_id) > 0) {
+    return;
+  }
+  std::vector<ObjectID> &object_ids = state->local_objects_by_digest[key];
+  if (!object_ids.empty()) {
+    /* The plasma store cannot map two object IDs to the same buffer, so the
+     * duplicate is only counted, and fetches may copy either object. */
+    state->dedup_stats.num_duplicate_objects += 1;
+    RAY_LOG(DEBUG) << "Object " << object_id << " has the same contents as "
+                   << object_ids.front();
+  }
+  object_ids.push_back(object_id);
+  state->local_object_digests[object_id] = key;
+}
+
 void process_delete_object_notification(PlasmaManagerState *state,
                                         ObjectID object_id) {
   state->local_available_objects.erase(object_id);
+  remove_object_digest(state, object_id);
 
   /* Remove this object from the (redis) object table. */
   if (state->db) {
@@ -1355,12 +1754,52 @@ void log_object_hash_mismatch_error_object_callback(ObjectID object_id,
                       log_object_hash_mismatch_error_result_callback, state);
 }
 
+/**
+ * Replace the digest of a newly sealed object with the SHA-256 of its data and
+ * metadata, so that fetches of objects with the same contents can copy it. The
+ * object is hashed on the event loop, so this is only done for objects of at
+ * most manager_dedup_max_object_size bytes. Larger objects keep the plasma
+ * store's digest.
+ *
+ * @param state The state of the plasma manager.
+ * @param object_id The ID of the sealed object.
+ * @param object_size The total size of the object's data and metadata.
+ * @param digest The plasma store's digest of the object, padded with zeros.
+ *        This is overwritten with the SHA-256 digest.
+ * @return False if the object should have been hashed but was evicted before
+ *         it could be read, and true otherwise.
+ */
+bool hash_object_contents(PlasmaManagerState *state,
+                          ObjectID object_id,
+                          int64_t object_size,
+                          unsigned char digest[DIGEST_SIZE]) {
+  if (object_size > RayConfig::instance().manager_dedup_max_object_size()) {
+    return true;
+  }
+  plasma::ObjectBuffer object_buffer;
+  plasma::ObjectID plasma_id = object_id.to_plasma_id();
+  /* We pass in 0 to indicate that the command should return immediately. */
+  ARROW_CHECK_OK(state->plasma_conn->Get(&plasma_id, 1, 0, &object_buffer));
+  if (object_buffer.data == nullptr) {
+    return false;
+  }
+  /* The data and metadata are contiguous, so they are hashed together. */
+  SHA256_CTX ctx;
+  sha256_init(&ctx);
+  sha256_update(&ctx, object_buffer.data->data(), object_size);
+  sha256_final(&ctx, digest);
+  ARROW_CHECK_OK(state->plasma_conn->Release(plasma_id));
+  return true;
+}
+
 void process_add_object_notification(PlasmaManagerState *state,
                                      ObjectID object_id,
                                      int64_t data_size,
                                      int64_t metadata_size,
                                      unsigned char *digest) {
   state->local_available_objects.insert(object_id);
+  add_object_digest(state, object_id,
+                    std::string((char *) digest, DIGEST_SIZE));
   if (state->receives_in_progress.count(object_id) > 0) {
     // This object is now locally available, so remove it from the
     // receives_in_progress set.
@@ -1405,10 +1844,25 @@ void process_object_notification(event_loop *loop,
   if (object_info->is_deletion()) {
     process_delete_object_notification(state, object_id);
   } else {
-    process_add_object_notification(
-        state, object_id, object_info->data_size(),
-        object_info->metadata_size(),
-        (unsigned char *) object_info->digest()->data());
+    /* The object table stores digests of DIGEST_SIZE bytes, which is larger
+     * than the digests that the plasma store computes, so pad the digest
+     * with zeros. */
+    unsigned char digest[DIGEST_SIZE] = {0};
+    memcpy(digest, object_info->digest()->data(),
+           std::min<size_t>(object_info->digest()->size(), DIGEST_SIZE));
+    if (hash_object_contents(
+            state, object_id,
+            object_info->data_size() + object_info->metadata_size(), digest)) {
+      process_add_object_notification(state, object_id,
+                                      object_info->data_size(),
+                                      object_info->metadata_size(), digest);
+    } else {
+      /* The object is already gone, and the notification of its deletion
+       * follows. Publishing the store's digest instead of its hash could make
+       * the object table report a hash mismatch, so it is not added. If it
+       * was being received, it can be fetched again. */
+      state->receives_in_progress.erase(object_id);
+    }
   }
   free(notification);
 }
@@ -1427,7 +1881,7 @@ ClientConnection *ClientConnection_init(PlasmaManagerState *state,
   conn->num_return_objects = 0;
 
   conn->ip_addr_port = client_key;
-  state->manager_connections[client_key] = conn;
+  state->manager_connections[client_key].push_back(conn);
   return conn;
 }
 
@@ -1448,7 +1902,15 @@ ClientConnection *ClientConnection_listen(event_loop *loop,
 
 void ClientConnection_free(ClientConnection *client_conn) {
   PlasmaManagerState *state = client_conn->manager_state;
-  state->manager_connections.erase(client_conn->ip_addr_port);
+  auto cc_it = state->manager_connections.find(client_conn->ip_addr_port);
+  if (cc_it != state->manager_connections.end()) {
+    std::vector<ClientConnection *> &conns = cc_it->second;
+    conns.erase(std::remove(conns.begin(), conns.end(), client_conn),
+                conns.end());
+    if (conns.empty()) {
+      state->manager_connections.erase(cc_it);
+    }
+  }
 
   client_conn->pending_object_transfers.clear();
 
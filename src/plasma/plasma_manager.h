@@ -12,6 +12,18 @@
 typedef struct PlasmaManagerState PlasmaManagerState;
 typedef struct ClientConnection ClientConnection;
 
+/** Counters for the deduplication of objects with identical contents. */
+typedef struct {
+  /** The number of sealed objects whose contents are identical to those of
+   *  an object that was already local. */
+  int64_t num_duplicate_objects;
+  /** The number of fetches that were completed by copying a local object
+   *  with identical contents, without transferring the object. */
+  int64_t num_fetch_hits;
+  /** The number of bytes that these fetches did not transfer. */
+  int64_t num_bytes_saved;
+} DedupStats;
+
 /**
  * Initializes the plasma manager state. This connects the manager to the local
  * plasma store, starts the manager listening for client connections, and
@@ -36,6 +48,14 @@ PlasmaManagerState *PlasmaManagerState_init(const char *store_socket_name,
                                             const char *db_addr,
                                             int db_port);
 
+/**
+ * Get the deduplication counters of the plasma manager.
+ *
+ * @param state The state of the plasma manager.
+ * @return The counters.
+ */
+DedupStats get_dedup_stats(PlasmaManagerState *state);
+
 /**
  * Destroys the plasma manager state and its connections.
  *
@@ -87,9 +107,10 @@ void process_data(event_loop *loop,
                   ClientConnection *conn);
 
 /**
- * Read the next chunk of the object in transit from the plasma manager
- * connected to the given socket. Once all data for this object has been read,
- * the socket switches to listening for the next plasma request.
+ * Read the next part of the object chunk in transit from the plasma manager
+ * connected to the given socket. Once all data for this chunk has been read,
+ * the socket switches to listening for the next plasma request, and the object
+ * is sealed if this was the last of its chunks to arrive.
  *
  * @param loop This is the event loop of the plasma manager.
  * @param data_sock The connection to the other plasma manager.
@@ -154,6 +175,14 @@ ClientConnection *ClientConnection_listen(event_loop *loop,
  * internally by the plasma manager code.
  */
 
+/* The header that precedes each chunk of object data that a plasma manager
+ * sends after a data reply. The offset is into the concatenated data and
+ * metadata of the object. */
+typedef struct {
+  int64_t offset;
+  int64_t length;
+} PlasmaChunkHeader;
+
 /* Buffer for requests between plasma managers. */
 typedef struct PlasmaRequestBuffer {
   int type;
@@ -162,6 +191,8 @@ typedef struct PlasmaRequestBuffer {
   int64_t data_size;
   uint8_t *metadata;
   int64_t metadata_size;
+  /* The chunk of the object that is sent or received with this buffer. */
+  PlasmaChunkHeader chunk;
 } PlasmaRequestBuffer;
 
 /**
@@ -187,8 +218,9 @@ void call_request_transfer(ray::ObjectID object_id,
 int fetch_timeout_handler(event_loop *loop, timer_id id, void *context);
 
 /**
- * Get a connection to the remote manager at the specified address. Creates a
- * new connection to this manager if one doesn't already exist.
+ * Get a connection to the remote manager at the specified address. If there
+ * are several connections to this manager, this returns the least busy one.
+ * Creates a new connection to this manager if one doesn't already exist.
  *
  * @param state Our plasma manager state.
  * @param ip_addr The IP address of the remote manager we want to connect to.
@@ -201,24 +233,30 @@ ClientConnection *get_manager_connection(PlasmaManagerState *state,
 
 /**
  * Reads an object chunk sent by the given client into a buffer. This is the
- * complement to write_object_chunk.
+ * complement to write_object_chunk. This reads as much as is available on the
+ * socket, but returns as soon as the chunk header has been read into
+ * buf->chunk, so that the caller can choose where the data goes before calling
+ * this again.
  *
  * @param conn The connection to the client who's sending the data. The
  *        connection's cursor will be reset if this is the last read for the
- *        current object.
- * @param buf The buffer to write the data into.
+ *        current chunk.
+ * @param buf The buffer to write the data into, at the chunk's offset. If the
+ *        data is NULL, the chunk is read and discarded.
  * @return The errno set, if the read wasn't successful.
  */
 int read_object_chunk(ClientConnection *conn, PlasmaRequestBuffer *buf);
 
 /**
- * Writes an object chunk from a buffer to the given client. This is the
- * complement to read_object_chunk.
+ * Writes an object chunk from a buffer to the given client, preceded by its
+ * header. This is the complement to read_object_chunk. The connection must be
+ * non-blocking, and this writes as much of the chunk as the socket accepts.
  *
  * @param conn The connection to the client who's receiving the data. The
  *        connection's cursor will be reset if this is the last write for the
- *        current object.
- * @param buf The buffer to read data from.
+ *        current chunk.
+ * @param buf The buffer to read data from, whose chunk field says which part
+ *        of the object to write.
  * @return The errno set, if the write wasn't successful.
  */
 int write_object_chunk(ClientConnection *conn, PlasmaRequestBuffer *buf);
@@ -274,4 +312,23 @@ int get_client_sock(ClientConnection *conn);
  */
 bool is_object_local(PlasmaManagerState *state, ray::ObjectID object_id);
 
+/**
+ * Try to complete a fetch by copying a local object whose contents have the
+ * same SHA-256 digest, instead of transferring the object from a remote
+ * manager. Only objects of at most manager_dedup_max_object_size bytes are
+ * copied, since the copy runs on the event loop.
+ *
+ * @param manager_state The state of the plasma manager.
+ * @param object_id The ID of the object to fetch.
+ * @param object_size The total size of the object's data and metadata.
+ * @param digest The digest of the object's contents, as stored in the object
+ *        table.
+ * @return True if the object was created from a local copy and false
+ *         otherwise.
+ */
+bool fetch_from_local_duplicate(PlasmaManagerState *manager_state,
+                                ray::ObjectID object_id,
+                                int64_t object_size,
+                                const std::string &digest);
+
 #endif /* PLASMA_MANAGER_H */
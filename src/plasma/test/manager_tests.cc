@@ -8,6 +8,7 @@
 #include <fcntl.h>
 
 #include <string>
+#include <vector>
 
 #include "common.h"
 #include "test/test_common.h"
@@ -217,6 +218,8 @@ TEST read_write_object_chunk_test(void) {
   remote_buf.data_size = data_size;
   remote_buf.metadata = (uint8_t *) data + data_size;
   remote_buf.metadata_size = metadata_size;
+  remote_buf.chunk.offset = 0;
+  remote_buf.chunk.length = data_size + metadata_size;
   PlasmaRequestBuffer local_buf;
   local_buf.object_id = object_id;
   local_buf.data_size = data_size;
@@ -224,7 +227,7 @@ TEST read_write_object_chunk_test(void) {
   local_buf.data = (uint8_t *) malloc(data_size);
   /* The test:
    * - Write the object data from the remote manager to the local.
-   * - Read the object data on the local manager.
+   * - Read the chunk header and then the object data on the local manager.
    * - Check that the data matches.
    */
   ClientConnection_start_request(remote_mock->write_conn);
@@ -236,6 +239,11 @@ TEST read_write_object_chunk_test(void) {
   ClientConnection_start_request(remote_mock->read_conn);
   int err = read_object_chunk(remote_mock->read_conn, &local_buf);
   ASSERT_EQ(err, 0);
+  ASSERT_FALSE(ClientConnection_request_finished(remote_mock->read_conn));
+  ASSERT_EQ(local_buf.chunk.offset, 0);
+  ASSERT_EQ(local_buf.chunk.length, data_size + metadata_size);
+  err = read_object_chunk(remote_mock->read_conn, &local_buf);
+  ASSERT_EQ(err, 0);
   ASSERT(ClientConnection_request_finished(remote_mock->read_conn));
   ASSERT_EQ(memcmp(remote_buf.data, local_buf.data, data_size), 0);
   /* Clean up. */
@@ -245,6 +253,60 @@ TEST read_write_object_chunk_test(void) {
   PASS();
 }
 
+/**
+ * This test checks that the chunks of an object can arrive in any order, and
+ * that chunks can be discarded.
+ * - Write the second, first and again the second half of an object from the
+ *   local to the remote manager.
+ * - Read the chunks into a buffer on the remote manager, except for the
+ *   repeated one, which is discarded.
+ * - Expect to see the same data.
+ */
+TEST read_write_object_chunks_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  plasma_mock *remote_mock = init_plasma_mock(local_mock);
+  /* Create a mock object buffer to transfer. */
+  const char *data = "Hello chunked world!";
+  const int data_size = strlen(data) + 1;
+  const int half_size = data_size / 2;
+  PlasmaRequestBuffer remote_buf;
+  remote_buf.type = MessageType_PlasmaDataReply;
+  remote_buf.object_id = object_id;
+  remote_buf.data = (uint8_t *) data;
+  remote_buf.data_size = data_size;
+  remote_buf.metadata = (uint8_t *) data + data_size;
+  remote_buf.metadata_size = 0;
+  PlasmaRequestBuffer local_buf;
+  local_buf.object_id = object_id;
+  local_buf.data_size = data_size;
+  local_buf.metadata_size = 0;
+  uint8_t *local_data = (uint8_t *) malloc(data_size);
+  int64_t offsets[] = {half_size, 0, half_size};
+  for (int i = 0; i < 3; ++i) {
+    remote_buf.chunk.offset = offsets[i];
+    remote_buf.chunk.length =
+        offsets[i] == 0 ? half_size : data_size - half_size;
+    ClientConnection_start_request(remote_mock->write_conn);
+    write_object_chunk(remote_mock->write_conn, &remote_buf);
+    ASSERT(ClientConnection_request_finished(remote_mock->write_conn));
+    /* Read the chunk header, and then the chunk into the object or, if we
+     * already have it, nowhere. */
+    wait_for_pollin(get_client_sock(remote_mock->read_conn));
+    ClientConnection_start_request(remote_mock->read_conn);
+    ASSERT_EQ(read_object_chunk(remote_mock->read_conn, &local_buf), 0);
+    ASSERT_EQ(local_buf.chunk.offset, offsets[i]);
+    local_buf.data = i < 2 ? local_data : NULL;
+    ASSERT_EQ(read_object_chunk(remote_mock->read_conn, &local_buf), 0);
+    ASSERT(ClientConnection_request_finished(remote_mock->read_conn));
+  }
+  ASSERT_EQ(memcmp(data, local_data, data_size), 0);
+  /* Clean up. */
+  free(local_data);
+  destroy_plasma_mock(remote_mock);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
 TEST object_notifications_test(void) {
   plasma_mock *local_mock = init_plasma_mock(NULL);
   /* Open a non-blocking socket pair to mock the object notifications from the
@@ -254,11 +316,19 @@ TEST object_notifications_test(void) {
   int flags = fcntl(fd[1], F_GETFL, 0);
   RAY_CHECK(fcntl(fd[1], F_SETFL, flags | O_NONBLOCK) == 0);
 
+  /* The manager hashes small objects when it is notified of them, so put the
+   * object in the store. */
   ObjectID object_id = ObjectID::from_random();
+  uint8_t metadata[] = {0};
+  std::shared_ptr<Buffer> data;
+  ARROW_CHECK_OK(local_mock->plasma_client->Create(
+      object_id.to_plasma_id(), 10, metadata, sizeof(metadata), &data));
+  ARROW_CHECK_OK(local_mock->plasma_client->Seal(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(local_mock->plasma_client->Release(object_id.to_plasma_id()));
   ObjectInfoT info;
   info.object_id = object_id.binary();
   info.data_size = 10;
-  info.metadata_size = 1;
+  info.metadata_size = sizeof(metadata);
   info.create_time = 0;
   info.construct_duration = 0;
   info.digest = std::string("0");
@@ -293,12 +363,591 @@ TEST object_notifications_test(void) {
   PASS();
 }
 
+/**
+ * Send a notification about an object from a mock plasma store to the plasma
+ * manager.
+ */
+void send_object_notification(plasma_mock *mock,
+                              int fd[2],
+                              ObjectInfoT *info) {
+  auto notification = plasma::create_object_info_buffer(info);
+  int64_t size = *((int64_t *) notification.get());
+  send(fd[1], notification.get(), sizeof(int64_t) + size, 0);
+  process_object_notification(mock->loop, fd[0], mock->state, 0);
+}
+
+/**
+ * Create an object in the plasma store of a mock plasma manager.
+ */
+void create_object(plasma_mock *mock,
+                   ObjectID object_id,
+                   const std::vector<uint8_t> &data,
+                   const std::vector<uint8_t> &metadata) {
+  std::shared_ptr<Buffer> buffer;
+  ARROW_CHECK_OK(mock->plasma_client->Create(object_id.to_plasma_id(),
+                                             data.size(), metadata.data(),
+                                             metadata.size(), &buffer));
+  memcpy(buffer->mutable_data(), data.data(), data.size());
+  ARROW_CHECK_OK(mock->plasma_client->Seal(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(mock->plasma_client->Release(object_id.to_plasma_id()));
+}
+
+/**
+ * This test checks that fetches of objects whose contents are identical to
+ * those of a local object are completed by copying the local object. The test:
+ * - Create two objects with the same contents in the plasma store, and notify
+ *   the manager of them and of an object that is not in the store.
+ * - Expect a fetch of an object with the same SHA-256 digest and size to copy
+ *   one of the objects in the store, and to be counted.
+ * - Expect fetches of objects with other sizes or digests, or with only the
+ *   plasma store's digest, to fail.
+ */
+TEST dedup_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  int fd[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fd);
+  int flags = fcntl(fd[1], F_GETFL, 0);
+  RAY_CHECK(fcntl(fd[1], F_SETFL, flags | O_NONBLOCK) == 0);
+
+  /* Create two objects with the same contents in the local plasma store. */
+  std::vector<uint8_t> data(100);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = i;
+  }
+  std::vector<uint8_t> metadata = {42};
+  ObjectID source_ids[] = {ObjectID::from_random(), ObjectID::from_random()};
+  for (const ObjectID &source_id : source_ids) {
+    create_object(local_mock, source_id, data, metadata);
+  }
+
+  /* Notify the manager of an evicted object and of the objects in the store.
+   * The evicted object cannot be hashed, so it is not added. */
+  ObjectInfoT info;
+  info.data_size = data.size();
+  info.metadata_size = metadata.size();
+  info.create_time = 0;
+  info.construct_duration = 0;
+  info.digest = std::string("digest01");
+  info.is_deletion = false;
+  ObjectID evicted_id = ObjectID::from_random();
+  info.object_id = evicted_id.binary();
+  send_object_notification(local_mock, fd, &info);
+  ASSERT(!is_object_local(local_mock->state, evicted_id));
+  for (const ObjectID &source_id : source_ids) {
+    info.object_id = source_id.binary();
+    send_object_notification(local_mock, fd, &info);
+  }
+  ASSERT_EQ(get_dedup_stats(local_mock->state).num_duplicate_objects, 1);
+
+  /* The object table stores the SHA-256 digest of the data and metadata. */
+  std::vector<uint8_t> contents = data;
+  contents.insert(contents.end(), metadata.begin(), metadata.end());
+  unsigned char sha256_digest[DIGEST_SIZE];
+  SHA256_CTX ctx;
+  sha256_init(&ctx);
+  sha256_update(&ctx, contents.data(), contents.size());
+  sha256_final(&ctx, sha256_digest);
+  std::string digest((char *) sha256_digest, DIGEST_SIZE);
+  const int64_t object_size = contents.size();
+  ObjectID object_id = ObjectID::from_random();
+  ASSERT(fetch_from_local_duplicate(local_mock->state, object_id, object_size,
+                                    digest));
+  DedupStats stats = get_dedup_stats(local_mock->state);
+  ASSERT_EQ(stats.num_fetch_hits, 1);
+  ASSERT_EQ(stats.num_bytes_saved, object_size);
+
+  /* Check that the copy has the same data and metadata. */
+  plasma::ObjectBuffer object_buffer;
+  plasma::ObjectID plasma_id = object_id.to_plasma_id();
+  ARROW_CHECK_OK(
+      local_mock->plasma_client->Get(&plasma_id, 1, 0, &object_buffer));
+  ASSERT(object_buffer.data != nullptr);
+  ASSERT_EQ(object_buffer.data->size(), (int64_t) data.size());
+  ASSERT_EQ(memcmp(object_buffer.data->data(), data.data(), data.size()), 0);
+  ASSERT_EQ(object_buffer.metadata->size(), (int64_t) metadata.size());
+  ASSERT_EQ(object_buffer.metadata->data()[0], metadata[0]);
+  ARROW_CHECK_OK(local_mock->plasma_client->Release(plasma_id));
+
+  /* Objects with other sizes or digests are not copied. Neither are objects
+   * whose digest is the plasma store's, which is too short to trust. */
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size + 1, digest));
+  std::string other_digest = digest;
+  other_digest[0] ^= 1;
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size, other_digest));
+  std::string store_digest =
+      digest.substr(0, 8) + std::string(DIGEST_SIZE - 8, '\0');
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size, store_digest));
+  /* Deleted objects are removed from the index. */
+  info.is_deletion = true;
+  for (const ObjectID &source_id : source_ids) {
+    info.object_id = source_id.binary();
+    send_object_notification(local_mock, fd, &info);
+  }
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size, digest));
+  ASSERT_EQ(get_dedup_stats(local_mock->state).num_fetch_hits, 1);
+
+  /* Clean up. */
+  close(fd[0]);
+  close(fd[1]);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+SUITE(plasma_manager_tests);
+
+const char *plasma_store_socket_name = "/tmp/plasma_store_socket_1";
+const char *plasma_manager_socket_name_format = "/tmp/plasma_manager_socket_%d";
+const char *manager_addr = "127.0.0.1";
+ObjectID object_id;
+
+void wait_for_pollin(int fd) {
+  struct pollfd poll_list[1];
+  poll_list[0].fd = fd;
+  poll_list[0].events = POLLIN;
+  int retval = poll(poll_list, (unsigned long) 1, -1);
+  RAY_CHECK(retval > 0);
+}
+
+int test_done_handler(event_loop *loop, timer_id id, void *context) {
+  event_loop_stop(loop);
+  return AE_NOMORE;
+}
+
+typedef struct {
+  int port;
+  /** Connection to the manager's TCP socket. */
+  int manager_remote_fd;
+  /** Connection to the manager's Unix socket. */
+  int manager_local_fd;
+  int local_store;
+  int manager;
+  PlasmaManagerState *state;
+  event_loop *loop;
+  /* Accept a connection from the local manager on the remote manager. */
+  ClientConnection *write_conn;
+  ClientConnection *read_conn;
+  /* Connect a new client to the local plasma manager and mock a request to an
+   * object. */
+  plasma::PlasmaClient *plasma_client;
+  ClientConnection *client_conn;
+} plasma_mock;
+
+plasma_mock *init_plasma_mock(plasma_mock *remote_mock) {
+  plasma_mock *mock = (plasma_mock *) malloc(sizeof(plasma_mock));
+  /* Start listening on all the ports and initiate the local plasma manager. */
+  mock->port = bind_inet_sock_retry(&mock->manager_remote_fd);
+  mock->local_store = connect_ipc_sock_retry(plasma_store_socket_name, 5, 100);
+  std::string manager_socket_name = bind_ipc_sock_retry(
+      plasma_manager_socket_name_format, &mock->manager_local_fd);
+
+  RAY_CHECK(mock->manager_local_fd >= 0 && mock->local_store >= 0);
+
+  mock->state = PlasmaManagerState_init(plasma_store_socket_name,
+                                        manager_socket_name.c_str(),
+                                        manager_addr, mock->port, NULL, 0);
+  mock->loop = get_event_loop(mock->state);
+  /* Accept a connection from the local manager on the remote manager. */
+  if (remote_mock != NULL) {
+    mock->write_conn =
+        get_manager_connection(remote_mock->state, manager_addr, mock->port);
+    wait_for_pollin(mock->manager_remote_fd);
+    mock->read_conn = ClientConnection_listen(
+        mock->loop, mock->manager_remote_fd, mock->state,
+        plasma::kPlasmaDefaultReleaseDelay);
+  } else {
+    mock->write_conn = NULL;
+    mock->read_conn = NULL;
+  }
+  /* Connect a new client to the local plasma manager and mock a request to an
+   * object. */
+  mock->plasma_client = new plasma::PlasmaClient();
+  ARROW_CHECK_OK(mock->plasma_client->Connect(plasma_store_socket_name,
+                                              manager_socket_name.c_str(), 0));
+  wait_for_pollin(mock->manager_local_fd);
+  mock->client_conn = ClientConnection_listen(
+      mock->loop, mock->manager_local_fd, mock->state, 0);
+  return mock;
+}
+
+void destroy_plasma_mock(plasma_mock *mock) {
+  PlasmaManagerState_free(mock->state);
+  ARROW_CHECK_OK(mock->plasma_client->Disconnect());
+  delete mock->plasma_client;
+  close(mock->local_store);
+  close(mock->manager_local_fd);
+  close(mock->manager_remote_fd);
+  free(mock);
+}
+
+/**
+ * This test checks correct behavior of request_transfer in a non-failure
+ * scenario. Specifically, when one plasma manager calls request_transfer, the
+ * correct remote manager should receive the correct message. The test:
+ * - Buffer a transfer request for the remote manager.
+ * - Start and stop the event loop to make sure that we send the buffered
+ *   request.
+ * - Expect to see a MessageType_PlasmaDataRequest message on the remote manager
+ *   with the correct object ID.
+ */
+TEST request_transfer_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  plasma_mock *remote_mock = init_plasma_mock(local_mock);
+  std::vector<std::string> manager_vector;
+  manager_vector.push_back(std::string("127.0.0.1:") +
+                           std::to_string(remote_mock->port));
+  call_request_transfer(object_id, manager_vector, local_mock->state);
+  event_loop_add_timer(local_mock->loop,
+                       RayConfig::instance().manager_timeout_milliseconds(),
+                       test_done_handler, local_mock->state);
+  event_loop_run(local_mock->loop);
+  int read_fd = get_client_sock(remote_mock->read_conn);
+  std::vector<uint8_t> request_data;
+  ARROW_CHECK_OK(plasma::PlasmaReceive(read_fd, MessageType_PlasmaDataRequest,
+                                       &request_data));
+  plasma::ObjectID object_id2;
+  char *address;
+  int port;
+  ARROW_CHECK_OK(plasma::ReadDataRequest(
+      request_data.data(), request_data.size(), &object_id2, &address, &port));
+  ASSERT(object_id == object_id2);
+  free(address);
+  /* Clean up. */
+  destroy_plasma_mock(remote_mock);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+/**
+ * This test checks correct behavior of request_transfer in a scenario when the
+ * first manager we try times out. Specifically, when one plasma manager calls
+ * request_transfer on a list of remote managers and the first manager isn't
+ * reachable, the second remote manager should receive the correct message
+ * after the timeout. The test:
+ * - Buffer a transfer request for the remote managers.
+ * - Start and stop the event loop after a timeout to make sure that we
+ *   trigger the timeout on the first manager.
+ * - Expect to see a MessageType_PlasmaDataRequest message on the second remote
+ *   manager with the correct object ID.
+ */
+TEST request_transfer_retry_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  plasma_mock *remote_mock1 = init_plasma_mock(local_mock);
+  plasma_mock *remote_mock2 = init_plasma_mock(local_mock);
+
+  std::vector<std::string> manager_vector;
+  manager_vector.push_back(std::string("127.0.0.1:") +
+                           std::to_string(remote_mock1->port));
+  manager_vector.push_back(std::string("127.0.0.1:") +
+                           std::to_string(remote_mock2->port));
+
+  call_request_transfer(object_id, manager_vector, local_mock->state);
+  event_loop_add_timer(local_mock->loop,
+                       RayConfig::instance().manager_timeout_milliseconds() * 2,
+                       test_done_handler, local_mock->state);
+  /* Register the fetch timeout handler. This is normally done when the plasma
+   * manager is started. It is needed here so that retries will happen when
+   * fetch requests time out. */
+  event_loop_add_timer(local_mock->loop,
+                       RayConfig::instance().manager_timeout_milliseconds(),
+                       fetch_timeout_handler, local_mock->state);
+  event_loop_run(local_mock->loop);
+
+  int read_fd = get_client_sock(remote_mock2->read_conn);
+  std::vector<uint8_t> request_data;
+  ARROW_CHECK_OK(plasma::PlasmaReceive(read_fd, MessageType_PlasmaDataRequest,
+                                       &request_data));
+  plasma::ObjectID object_id2;
+  char *address;
+  int port;
+  ARROW_CHECK_OK(plasma::ReadDataRequest(
+      request_data.data(), request_data.size(), &object_id2, &address, &port));
+  free(address);
+  ASSERT(object_id == object_id2);
+  /* Clean up. */
+  destroy_plasma_mock(remote_mock2);
+  destroy_plasma_mock(remote_mock1);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+/**
+ * This test checks correct behavior of reading and writing an object chunk
+ * from one manager to another.
+ * - Write a one-chunk object from the local to the remote manager.
+ * - Read the object chunk on the remote manager.
+ * - Expect to see the same data.
+ */
+TEST read_write_object_chunk_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  plasma_mock *remote_mock = init_plasma_mock(local_mock);
+  /* Create a mock object buffer to transfer. */
+  const char *data = "Hello world!";
+  const int data_size = strlen(data) + 1;
+  const int metadata_size = 0;
+  PlasmaRequestBuffer remote_buf;
+  remote_buf.type = MessageType_PlasmaDataReply;
+  remote_buf.object_id = object_id;
+  remote_buf.data = (uint8_t *) data;
+  remote_buf.data_size = data_size;
+  remote_buf.metadata = (uint8_t *) data + data_size;
+  remote_buf.metadata_size = metadata_size;
+  remote_buf.chunk.offset = 0;
+  remote_buf.chunk.length = data_size + metadata_size;
+  PlasmaRequestBuffer local_buf;
+  local_buf.object_id = object_id;
+  local_buf.data_size = data_size;
+  local_buf.metadata_size = metadata_size;
+  local_buf.data = (uint8_t *) malloc(data_size);
+  /* The test:
+   * - Write the object data from the remote manager to the local.
+   * - Read the chunk header and then the object data on the local manager.
+   * - Check that the data matches.
+   */
+  ClientConnection_start_request(remote_mock->write_conn);
+  write_object_chunk(remote_mock->write_conn, &remote_buf);
+  ASSERT(ClientConnection_request_finished(remote_mock->write_conn));
+  /* Wait until the data is ready to be read. */
+  wait_for_pollin(get_client_sock(remote_mock->read_conn));
+  /* Read the data. */
+  ClientConnection_start_request(remote_mock->read_conn);
+  int err = read_object_chunk(remote_mock->read_conn, &local_buf);
+  ASSERT_EQ(err, 0);
+  ASSERT_FALSE(ClientConnection_request_finished(remote_mock->read_conn));
+  ASSERT_EQ(local_buf.chunk.offset, 0);
+  ASSERT_EQ(local_buf.chunk.length, data_size + metadata_size);
+  err = read_object_chunk(remote_mock->read_conn, &local_buf);
+  ASSERT_EQ(err, 0);
+  ASSERT(ClientConnection_request_finished(remote_mock->read_conn));
+  ASSERT_EQ(memcmp(remote_buf.data, local_buf.data, data_size), 0);
+  /* Clean up. */
+  free(local_buf.data);
+  destroy_plasma_mock(remote_mock);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+/**
+ * This test checks that the chunks of an object can arrive in any order, and
+ * that chunks can be discarded.
+ * - Write the second, first and again the second half of an object from the
+ *   local to the remote manager.
+ * - Read the chunks into a buffer on the remote manager, except for the
+ *   repeated one, which is discarded.
+ * - Expect to see the same data.
+ */
+TEST read_write_object_chunks_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  plasma_mock *remote_mock = init_plasma_mock(local_mock);
+  /* Create a mock object buffer to transfer. */
+  const char *data = "Hello chunked world!";
+  const int data_size = strlen(data) + 1;
+  const int half_size = data_size / 2;
+  PlasmaRequestBuffer remote_buf;
+  remote_buf.type = MessageType_PlasmaDataReply;
+  remote_buf.object_id = object_id;
+  remote_buf.data = (uint8_t *) data;
+  remote_buf.data_size = data_size;
+  remote_buf.metadata = (uint8_t *) data + data_size;
+  remote_buf.metadata_size = 0;
+  PlasmaRequestBuffer local_buf;
+  local_buf.object_id = object_id;
+  local_buf.data_size = data_size;
+  local_buf.metadata_size = 0;
+  uint8_t *local_data = (uint8_t *) malloc(data_size);
+  int64_t offsets[] = {half_size, 0, half_size};
+  for (int i = 0; i < 3; ++i) {
+    remote_buf.chunk.offset = offsets[i];
+    remote_buf.chunk.length =
+        offsets[i] == 0 ? half_size : data_size - half_size;
+    ClientConnection_start_request(remote_mock->write_conn);
+    write_object_chunk(remote_mock->write_conn, &remote_buf);
+    ASSERT(ClientConnection_request_finished(remote_mock->write_conn));
+    /* Read the chunk header, and then the chunk into the object or, if we
+     * already have it, nowhere. */
+    wait_for_pollin(get_client_sock(remote_mock->read_conn));
+    ClientConnection_start_request(remote_mock->read_conn);
+    ASSERT_EQ(read_object_chunk(remote_mock->read_conn, &local_buf), 0);
+    ASSERT_EQ(local_buf.chunk.offset, offsets[i]);
+    local_buf.data = i < 2 ? local_data : NULL;
+    ASSERT_EQ(read_object_chunk(remote_mock->read_conn, &local_buf), 0);
+    ASSERT(ClientConnection_request_finished(remote_mock->read_conn));
+  }
+  ASSERT_EQ(memcmp(data, local_data, data_size), 0);
+  /* Clean up. */
+  free(local_data);
+  destroy_plasma_mock(remote_mock);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+TEST object_notifications_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  /* Open a non-blocking socket pair to mock the object notifications from the
+   * plasma store. */
+  int fd[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fd);
+  int flags = fcntl(fd[1], F_GETFL, 0);
+  RAY_CHECK(fcntl(fd[1], F_SETFL, flags | O_NONBLOCK) == 0);
+
+  /* The manager hashes small objects when it is notified of them, so put the
+   * object in the store. */
+  ObjectID object_id = ObjectID::from_random();
+  uint8_t metadata[] = {0};
+  std::shared_ptr<Buffer> data;
+  ARROW_CHECK_OK(local_mock->plasma_client->Create(
+      object_id.to_plasma_id(), 10, metadata, sizeof(metadata), &data));
+  ARROW_CHECK_OK(local_mock->plasma_client->Seal(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(local_mock->plasma_client->Release(object_id.to_plasma_id()));
+  ObjectInfoT info;
+  info.object_id = object_id.binary();
+  info.data_size = 10;
+  info.metadata_size = sizeof(metadata);
+  info.create_time = 0;
+  info.construct_duration = 0;
+  info.digest = std::string("0");
+  info.is_deletion = false;
+
+  /* Check that the object is not local at first. */
+  bool is_local = is_object_local(local_mock->state, object_id);
+  ASSERT(!is_local);
+
+  /* Check that the object is local after receiving an object notification. */
+  auto notification = plasma::create_object_info_buffer(&info);
+  int64_t size = *((int64_t *) notification.get());
+  send(fd[1], notification.get(), sizeof(int64_t) + size, 0);
+  process_object_notification(local_mock->loop, fd[0], local_mock->state, 0);
+  is_local = is_object_local(local_mock->state, object_id);
+  ASSERT(is_local);
+
+  /* Check that the object is not local after receiving a notification about
+   * the object deletion. */
+  info.is_deletion = true;
+  notification = plasma::create_object_info_buffer(&info);
+  size = *((int64_t *) notification.get());
+  send(fd[1], notification.get(), sizeof(int64_t) + size, 0);
+  process_object_notification(local_mock->loop, fd[0], local_mock->state, 0);
+  is_local = is_object_local(local_mock->state, object_id);
+  ASSERT(!is_local);
+
+  /* Clean up. */
+  close(fd[0]);
+  close(fd[1]);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
+/**
+ * Send a notification about an object from a mock plasma store to the plasma
+ * manager.
+ */
+void send_object_notification(plasma_mock *mock,
+                              int fd[2],
+                              ObjectInfoT *info) {
+  auto notification = plasma::create_object_info_buffer(info);
+  int64_t size = *((int64_t *) notification.get());
+  send(fd[1], notification.get(), sizeof(int64_t) + size, 0);
+  process_object_notification(mock->loop, fd[0], mock->state, 0);
+}
+
+/**
+ * This test checks that fetches of objects whose contents are identical to
+ * those of a local object are completed by copying the local object. The test:
+ * - Create an object in the plasma store and notify the manager of it, after
+ *   a notification about another object with the same digest that is not in
+ *   the store.
+ * - Expect a fetch of an object with the same digest and size to copy the
+ *   object that is in the store, and to be counted.
+ * - Expect fetches of objects with other sizes or digests to fail.
+ */
+TEST dedup_test(void) {
+  plasma_mock *local_mock = init_plasma_mock(NULL);
+  int fd[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fd);
+  int flags = fcntl(fd[1], F_GETFL, 0);
+  RAY_CHECK(fcntl(fd[1], F_SETFL, flags | O_NONBLOCK) == 0);
+
+  /* Create an object in the local plasma store. */
+  const int64_t data_size = 100;
+  uint8_t metadata[] = {42};
+  ObjectID source_id = ObjectID::from_random();
+  std::shared_ptr<Buffer> data;
+  ARROW_CHECK_OK(local_mock->plasma_client->Create(
+      source_id.to_plasma_id(), data_size, metadata, sizeof(metadata), &data));
+  for (int64_t i = 0; i < data_size; i++) {
+    data->mutable_data()[i] = i;
+  }
+  ARROW_CHECK_OK(local_mock->plasma_client->Seal(source_id.to_plasma_id()));
+  ARROW_CHECK_OK(local_mock->plasma_client->Release(source_id.to_plasma_id()));
+
+  /* Notify the manager of an evicted object and of the object in the store,
+   * with the same digest. */
+  ObjectInfoT info;
+  info.data_size = data_size;
+  info.metadata_size = sizeof(metadata);
+  info.create_time = 0;
+  info.construct_duration = 0;
+  info.digest = std::string("digest01");
+  info.is_deletion = false;
+  info.object_id = ObjectID::from_random().binary();
+  send_object_notification(local_mock, fd, &info);
+  info.object_id = source_id.binary();
+  send_object_notification(local_mock, fd, &info);
+  ASSERT_EQ(get_dedup_stats(local_mock->state).num_duplicate_objects, 1);
+
+  /* The object table stores the digest padded with zeros. */
+  std::string digest = info.digest + std::string(DIGEST_SIZE - 8, '\0');
+  const int64_t object_size = data_size + sizeof(metadata);
+  ObjectID object_id = ObjectID::from_random();
+  ASSERT(fetch_from_local_duplicate(local_mock->state, object_id, object_size,
+                                    digest));
+  DedupStats stats = get_dedup_stats(local_mock->state);
+  ASSERT_EQ(stats.num_fetch_hits, 1);
+  ASSERT_EQ(stats.num_bytes_saved, object_size);
+
+  /* Check that the copy has the same data and metadata. */
+  plasma::ObjectBuffer object_buffer;
+  plasma::ObjectID plasma_id = object_id.to_plasma_id();
+  ARROW_CHECK_OK(
+      local_mock->plasma_client->Get(&plasma_id, 1, 0, &object_buffer));
+  ASSERT(object_buffer.data != nullptr);
+  ASSERT_EQ(object_buffer.data->size(), data_size);
+  ASSERT_EQ(memcmp(object_buffer.data->data(), data->data(), data_size), 0);
+  ASSERT_EQ(object_buffer.metadata->size(), (int64_t) sizeof(metadata));
+  ASSERT_EQ(object_buffer.metadata->data()[0], metadata[0]);
+  ARROW_CHECK_OK(local_mock->plasma_client->Release(plasma_id));
+
+  /* Objects with other sizes or digests are not copied. */
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size + 1, digest));
+  std::string other_digest = std::string("digest02") + digest.substr(8);
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size, other_digest));
+  /* Deleted objects are removed from the index. */
+  info.is_deletion = true;
+  send_object_notification(local_mock, fd, &info);
+  ASSERT(!fetch_from_local_duplicate(local_mock->state, ObjectID::from_random(),
+                                     object_size, digest));
+  ASSERT_EQ(get_dedup_stats(local_mock->state).num_fetch_hits, 1);
+
+  /* Clean up. */
+  close(fd[0]);
+  close(fd[1]);
+  destroy_plasma_mock(local_mock);
+  PASS();
+}
+
 SUITE(plasma_manager_tests) {
   memset(&object_id, 1, sizeof(object_id));
   RUN_TEST(request_transfer_test);
   RUN_TEST(request_transfer_retry_test);
   RUN_TEST(read_write_object_chunk_test);
+  RUN_TEST(read_write_object_chunks_test);
   RUN_TEST(object_notifications_test);
+  RUN_TEST(dedup_test);
 }
 
 GREATEST_MAIN_DEFS();
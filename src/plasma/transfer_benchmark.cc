@@ -0,0 +1,108 @@
+/* Measure the rate at which one plasma manager sends objects to another.
+ *
+ * Usage: plasma_transfer_benchmark [object_size_mib] [num_objects]
+ *
+ * Start the stores, the managers and Redis like src/plasma/test/run_tests.sh
+ * does for client_tests, so that /tmp/store1 and /tmp/manager1 are on one
+ * node and /tmp/store2 and /tmp/manager2 are on the other. The benchmark puts
+ * objects of the given size (256MiB by default) into the first store, one at a
+ * time, and fetches each of them through the second manager. It reports the
+ * time from the fetch until the object is local on the second node, so the
+ * rate includes the data request, the transfer between the managers over
+ * loopback, and the seal. The object contents are random, so the managers
+ * cannot complete a fetch by copying an identical local object. Objects that
+ * were sent are evicted to make room for the next ones. To compare two
+ * versions of the transfer code, run the benchmark against the managers that
+ * each version builds. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "plasma/client.h"
+#include "plasma/common.h"
+#include "plasma/plasma.h"
+
+using namespace plasma;
+
+namespace {
+
+/* Fill a buffer with random bytes. */
+void fill_random(uint8_t *data, int64_t size, std::mt19937_64 &generator) {
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t value = generator();
+    memcpy(data + i, &value, 8);
+  }
+  for (; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(generator());
+  }
+}
+
+/* Wait until the manager of the client knows where the object is. */
+void wait_for_status(PlasmaClient &client, ObjectID object_id, int status) {
+  int object_status;
+  ARROW_CHECK_OK(client.Info(object_id, &object_status));
+  while (object_status != status) {
+    usleep(1000);
+    ARROW_CHECK_OK(client.Info(object_id, &object_status));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int64_t object_size = (argc > 1 ? atoll(argv[1]) : 256) * 1024 * 1024;
+  int num_objects = argc > 2 ? atoi(argv[2]) : 8;
+
+  PlasmaClient client1;
+  ARROW_CHECK_OK(client1.Connect("/tmp/store1", "/tmp/manager1",
+                                 plasma::kPlasmaDefaultReleaseDelay));
+  PlasmaClient client2;
+  ARROW_CHECK_OK(client2.Connect("/tmp/store2", "/tmp/manager2",
+                                 plasma::kPlasmaDefaultReleaseDelay));
+  std::mt19937_64 generator(0);
+  std::vector<double> seconds;
+  for (int i = 0; i < num_objects; ++i) {
+    ObjectID object_id = ObjectID::from_random();
+    std::shared_ptr<Buffer> data;
+    ARROW_CHECK_OK(client1.Create(object_id, object_size, NULL, 0, &data));
+    fill_random(data->mutable_data(), object_size, generator);
+    ARROW_CHECK_OK(client1.Seal(object_id));
+    ARROW_CHECK_OK(client1.Release(object_id));
+    /* Start timing once the second manager can find the object. */
+    wait_for_status(client2, object_id, ObjectStatus_Remote);
+
+    auto start = std::chrono::steady_clock::now();
+    ARROW_CHECK_OK(client2.Fetch(1, &object_id));
+    ObjectRequest request;
+    request.object_id = object_id;
+    request.type = PLASMA_QUERY_LOCAL;
+    int num_ready = 0;
+    while (num_ready == 0) {
+      ARROW_CHECK_OK(client2.Wait(1, &request, 1, 1000, &num_ready));
+    }
+    seconds.push_back(std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+  }
+  ARROW_CHECK_OK(client1.Disconnect());
+  ARROW_CHECK_OK(client2.Disconnect());
+
+  double total_seconds = 0;
+  printf("%8s %12s %12s\n", "object", "time (ms)", "rate (GB/s)");
+  for (size_t i = 0; i < seconds.size(); ++i) {
+    total_seconds += seconds[i];
+    printf("%8zu %12.1f %12.2f\n", i, seconds[i] * 1000,
+           object_size / seconds[i] / 1e9);
+  }
+  printf("%lldMiB objects: %.2f GB/s on average\n",
+         static_cast<long long>(object_size >> 20),
+         object_size * seconds.size() / total_seconds / 1e9);
+  return 0;
+}
@@ -1,5 +1,9 @@
 #include "client_connection.h"
 
+#include <chrono>
+#include <future>
+#include <thread>
+
 #include <boost/bind.hpp>
 
 #include "common.h"
@@ -22,8 +26,20 @@ ray::Status TcpConnect(boost::asio::ip::tcp::socket &socket,
 }
 
 template <class T>
-ServerConnection<T>::ServerConnection(boost::asio::basic_stream_socket<T> &&socket)
-    : socket_(std::move(socket)) {}
+std::shared_ptr<ServerConnection<T>> ServerConnection<T>::Create(
+    boost::asio::basic_stream_socket<T> &&socket) {
+  std::shared_ptr<ServerConnection<T>> self(new ServerConnection(std::move(socket)));
+  return self;
+}
+
+template <class T>
+ServerConnection<T>::ServerConnection(boost::asio::basic_stream_socket<T> &&socket,
+                                      boost::asio::io_service *owner_service)
+    : socket_(std::move(socket)),
+      owner_service_(owner_service),
+      async_write_queue_(),
+      async_write_queue_bytes_(0),
+      async_write_in_flight_(false) {}
 
 template <class T>
 void ServerConnection<T>::WriteBuffer(
@@ -73,6 +89,53 @@ void ServerConnection<T>::ReadBuffer(
 template <class T>
 ray::Status ServerConnection<T>::WriteMessage(int64_t type, int64_t length,
                                               const uint8_t *message) {
+  if (owner_service_ == nullptr) {
+    return DoWriteMessage(type, length, message);
+  }
+  if (owner_service_->stopped()) {
+    return ray::Status::IOError("The event loop of the connection has stopped");
+  }
+  // Only the owner's thread may use the socket, since it may be reading from
+  // the socket at the same time. Write from there and wait for the result.
+  // This runs the write right away if we are on the owner's thread already.
+  // The message is copied, since we stop waiting if the owner's event loop
+  // stops, and the write may still run later.
+  auto message_copy = std::make_shared<std::vector<uint8_t>>(message, message + length);
+  auto status = std::make_shared<std::promise<ray::Status>>();
+  std::future<ray::Status> future = status->get_future();
+  auto this_ptr = this->shared_from_this();
+  const std::thread::id caller_id = std::this_thread::get_id();
+  owner_service_->dispatch([this_ptr, type, message_copy, status, caller_id]() {
+    if (!this_ptr->async_write_queue_.empty() &&
+        std::this_thread::get_id() != caller_id) {
+      // The caller is blocked on another thread, so queue the message behind
+      // the asynchronous writes and let the caller wait for it to be written.
+      this_ptr->QueueWriteMessage(
+          type, std::move(*message_copy),
+          [status](const ray::Status &write_status) { status->set_value(write_status); });
+      return;
+    }
+    status->set_value(
+        this_ptr->DoWriteMessage(type, message_copy->size(), message_copy->data()));
+  });
+  while (future.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+    if (owner_service_->stopped()) {
+      return ray::Status::IOError("The event loop of the connection has stopped");
+    }
+  }
+  return future.get();
+}
+
+template <class T>
+ray::Status ServerConnection<T>::DoWriteMessage(int64_t type, int64_t length,
+                                                const uint8_t *message) {
+  if (!async_write_queue_.empty()) {
+    // A blocking write now would interleave with the queued messages, and this
+    // thread cannot wait for them, since it runs their completion handlers.
+    return ray::Status::Invalid(
+        "Cannot write a message synchronously while asynchronous writes are queued");
+  }
+
   std::vector<boost::asio::const_buffer> message_buffers;
   auto write_version = RayConfig::instance().ray_protocol_version();
   message_buffers.push_back(boost::asio::buffer(&write_version, sizeof(write_version)));
@@ -80,7 +143,6 @@ ray::Status ServerConnection<T>::WriteMessage(int64_t type, int64_t length,
   message_buffers.push_back(boost::asio::buffer(&length, sizeof(length)));
   message_buffers.push_back(boost::asio::buffer(message, length));
   // Write the message and then wait for more messages.
-  // TODO(swang): Does this need to be an async write?
   boost::system::error_code error;
   WriteBuffer(message_buffers, error);
   if (error) {
@@ -90,12 +152,119 @@ ray::Status ServerConnection<T>::WriteMessage(int64_t type, int64_t length,
   }
 }
 
+template <class T>
+void ServerConnection<T>::WriteMessageAsync(
+    int64_t type, int64_t length, const uint8_t *message,
+    const std::function<void(const ray::Status &)> &handler) {
+  if (owner_service_ == nullptr) {
+    QueueWriteMessage(type, std::vector<uint8_t>(message, message + length), handler);
+    return;
+  }
+  // Only the owner's thread may use the socket and the write queue. Copy the
+  // message now, since the caller may free it before the owner's thread runs.
+  auto message_copy = std::make_shared<std::vector<uint8_t>>(message, message + length);
+  auto this_ptr = this->shared_from_this();
+  owner_service_->dispatch([this_ptr, type, message_copy, handler]() {
+    this_ptr->QueueWriteMessage(type, std::move(*message_copy), handler);
+  });
+}
+
+template <class T>
+void ServerConnection<T>::QueueWriteMessage(
+    int64_t type, std::vector<uint8_t> &&message,
+    const std::function<void(const ray::Status &)> &handler) {
+  std::unique_ptr<AsyncWriteBuffer> write_buffer(new AsyncWriteBuffer());
+  write_buffer->write_version = RayConfig::instance().ray_protocol_version();
+  write_buffer->write_type = type;
+  write_buffer->write_length = message.size();
+  write_buffer->write_message = std::move(message);
+  write_buffer->handler = handler;
+  async_write_queue_bytes_ += write_buffer->write_length;
+  async_write_queue_.push_back(std::move(write_buffer));
+  if (!async_write_in_flight_) {
+    DoAsyncWrites();
+  }
+}
+
+template <class T>
+bool ServerConnection<T>::IsAboveHighWaterMark() const {
+  return async_write_queue_bytes_ >
+         RayConfig::instance().async_write_high_water_mark_bytes();
+}
+
+template <class T>
+bool ServerConnection<T>::IsBelowLowWaterMark() const {
+  return async_write_queue_bytes_ <=
+         RayConfig::instance().async_write_low_water_mark_bytes();
+}
+
+template <class T>
+void ServerConnection<T>::DoAsyncWrites() {
+  // Gather the headers and payloads of the messages at the front of the queue
+  // into a single write. The buffers stay valid until the write completes
+  // because the queue owns each message through a unique_ptr.
+  size_t num_messages = std::min(
+      async_write_queue_.size(),
+      static_cast<size_t>(RayConfig::instance().async_write_max_messages()));
+  std::vector<boost::asio::const_buffer> message_buffers;
+  message_buffers.reserve(4 * num_messages);
+  for (size_t i = 0; i < num_messages; i++) {
+    const auto &write_buffer = async_write_queue_[i];
+    message_buffers.push_back(boost::asio::buffer(&write_buffer->write_version,
+                                                  sizeof(write_buffer->write_version)));
+    message_buffers.push_back(boost::asio::buffer(&write_buffer->write_type,
+                                                  sizeof(write_buffer->write_type)));
+    message_buffers.push_back(boost::asio::buffer(&write_buffer->write_length,
+                                                  sizeof(write_buffer->write_length)));
+    message_buffers.push_back(boost::asio::buffer(write_buffer->write_message));
+  }
+  async_write_in_flight_ = true;
+  auto this_ptr = this->shared_from_this();
+  boost::asio::async_write(
+      socket_, message_buffers,
+      [this_ptr, num_messages](const boost::system::error_code &error,
+                               size_t bytes_transferred) {
+        this_ptr->HandleAsyncWrites(error, num_messages);
+      });
+}
+
+template <class T>
+void ServerConnection<T>::HandleAsyncWrites(const boost::system::error_code &error,
+                                            size_t num_messages) {
+  async_write_in_flight_ = false;
+  ray::Status status = ray::Status::OK();
+  if (error) {
+    status = ray::Status::IOError(error.message());
+    // The connection is broken, so fail every queued message, not just the
+    // ones that were part of this write.
+    num_messages = async_write_queue_.size();
+  }
+  // Remove the messages from the queue before running their handlers, since a
+  // handler may queue more messages.
+  std::vector<std::unique_ptr<AsyncWriteBuffer>> written;
+  written.reserve(num_messages);
+  for (size_t i = 0; i < num_messages; i++) {
+    async_write_queue_bytes_ -= async_write_queue_.front()->write_length;
+    written.push_back(std::move(async_write_queue_.front()));
+    async_write_queue_.pop_front();
+  }
+  if (!async_write_queue_.empty()) {
+    DoAsyncWrites();
+  }
+  for (const auto &write_buffer : written) {
+    if (write_buffer->handler) {
+      write_buffer->handler(status);
+    }
+  }
+}
+
 template <class T>
 std::shared_ptr<ClientConnection<T>> ClientConnection<T>::Create(
     ClientHandler<T> &client_handler, MessageHandler<T> &message_handler,
-    boost::asio::basic_stream_socket<T> &&socket) {
+    boost::asio::basic_stream_socket<T> &&socket,
+    boost::asio::io_service *owner_service) {
   std::shared_ptr<ClientConnection<T>> self(
-      new ClientConnection(message_handler, std::move(socket)));
+      new ClientConnection(message_handler, std::move(socket), owner_service));
   // Let our manager process our new connection.
   client_handler(*self);
   return self;
@@ -103,8 +272,16 @@ std::shared_ptr<ClientConnection<T>> ClientConnection<T>::Create(
 
 template <class T>
 ClientConnection<T>::ClientConnection(MessageHandler<T> &message_handler,
-                                      boost::asio::basic_stream_socket<T> &&socket)
-    : ServerConnection<T>(std::move(socket)), message_handler_(message_handler) {}
+                                      boost::asio::basic_stream_socket<T> &&socket,
+                                      boost::asio::io_service *owner_service)
+    : ServerConnection<T>(std::move(socket), owner_service),
+      message_handler_(message_handler) {}
+
+template <class T>
+std::shared_ptr<ClientConnection<T>>
+ClientConnection<T>::shared_ClientConnection_from_this() {
+  return std::static_pointer_cast<ClientConnection<T>>(this->shared_from_this());
+}
 
 template <class T>
 const ClientID &ClientConnection<T>::GetClientID() {
@@ -116,8 +293,24 @@ void ClientConnection<T>::SetClientID(const ClientID &client_id) {
   client_id_ = client_id;
 }
 
+template <class T>
+int64_t ClientConnection<T>::GetMessageLength() const {
+  return read_length_;
+}
+
 template <class T>
 void ClientConnection<T>::ProcessMessages() {
+  if (this->owner_service_ == nullptr) {
+    ReadMessageHeader();
+    return;
+  }
+  // Start the read on the owner's thread, which may be writing to the socket.
+  auto this_ptr = shared_ClientConnection_from_this();
+  this->owner_service_->dispatch([this_ptr]() { this_ptr->ReadMessageHeader(); });
+}
+
+template <class T>
+void ClientConnection<T>::ReadMessageHeader() {
   // Wait for a message header from the client. The message header includes the
   // protocol version, the message type, and the length of the message.
   std::vector<boost::asio::mutable_buffer> header;
@@ -126,8 +319,8 @@ void ClientConnection<T>::ProcessMessages() {
   header.push_back(boost::asio::buffer(&read_length_, sizeof(read_length_)));
   boost::asio::async_read(
       ServerConnection<T>::socket_, header,
-      boost::bind(&ClientConnection<T>::ProcessMessageHeader, this->shared_from_this(),
-                  boost::asio::placeholders::error));
+      boost::bind(&ClientConnection<T>::ProcessMessageHeader,
+                  shared_ClientConnection_from_this(), boost::asio::placeholders::error));
 }
 
 template <class T>
@@ -147,8 +340,8 @@ void ClientConnection<T>::ProcessMessageHeader(const boost::system::error_code &
   // Wait for the message to be read.
   boost::asio::async_read(
       ServerConnection<T>::socket_, boost::asio::buffer(read_message_),
-      boost::bind(&ClientConnection<T>::ProcessMessage, this->shared_from_this(),
-                  boost::asio::placeholders::error));
+      boost::bind(&ClientConnection<T>::ProcessMessage,
+                  shared_ClientConnection_from_this(), boost::asio::placeholders::error));
 }
 
 template <class T>
@@ -156,7 +349,7 @@ void ClientConnection<T>::ProcessMessage(const boost::system::error_code &error)
   if (error) {
     read_type_ = protocol::MessageType_DisconnectClient;
   }
-  message_handler_(this->shared_from_this(), read_type_, read_message_.data());
+  message_handler_(shared_ClientConnection_from_this(), read_type_, read_message_.data());
 }
 
 template class ServerConnection<boost::asio::local::stream_protocol>;
@@ -1,6 +1,7 @@
 #ifndef RAY_COMMON_CLIENT_CONNECTION_H
 #define RAY_COMMON_CLIENT_CONNECTION_H
 
+#include <deque>
 #include <memory>
 
 #include <boost/asio.hpp>
@@ -9,6 +10,7 @@
 
 #include "ray/id.h"
 #include "ray/status.h"
+#include "ray/util/macros.h"
 
 namespace ray {
 
@@ -24,14 +26,35 @@ ray::Status TcpConnect(boost::asio::ip::tcp::socket &socket,
 /// \typename ServerConnection
 ///
 /// A generic type representing a client connection to a server. This typename
-/// can be used to write messages synchronously to the server.
+/// can be used to write messages to the server, either synchronously or
+/// through a queue of asynchronous writes.
+///
+/// A connection may be owned by an event loop that runs on another thread. In
+/// that case, WriteMessage, WriteMessageAsync and
+/// ClientConnection::ProcessMessages may be called from any thread, and run on
+/// the owner's thread. Everything else must be called from the owner's thread.
 template <typename T>
-class ServerConnection {
+class ServerConnection : public std::enable_shared_from_this<ServerConnection<T>> {
  public:
-  /// Create a connection to the server.
-  ServerConnection(boost::asio::basic_stream_socket<T> &&socket);
+  /// Allocate a new server connection.
+  ///
+  /// \param socket A reference to the server socket.
+  /// \return std::shared_ptr<ServerConnection>.
+  static std::shared_ptr<ServerConnection<T>> Create(
+      boost::asio::basic_stream_socket<T> &&socket);
 
-  /// Write a message to the client.
+  /// Write a message to the client and block until it has been written.
+  ///
+  /// If the connection is owned by an event loop on another thread, the write
+  /// runs on that thread and this waits for it. Messages that are queued for
+  /// asynchronous writes are written first, so that messages are never
+  /// interleaved on the wire. If the owner's event loop stops before the
+  /// message is written, this returns an IOError instead of waiting for it.
+  ///
+  /// NOTE: Otherwise, the thread that calls this also completes the
+  /// asynchronous writes, so it cannot wait for them. If asynchronous writes
+  /// are queued, this returns an Invalid status without writing the message.
+  /// Use WriteMessageAsync for every message on such a connection instead.
   ///
   /// \param type The message type (e.g., a flatbuffer enum).
   /// \param length The size in bytes of the message.
@@ -39,6 +62,35 @@ class ServerConnection {
   /// \return Status.
   ray::Status WriteMessage(int64_t type, int64_t length, const uint8_t *message);
 
+  /// Write a message to the client without blocking. The message is copied
+  /// into the connection's write queue, and queued messages are coalesced into
+  /// a single gather write.
+  ///
+  /// If the connection is owned by an event loop on another thread, the
+  /// message is queued on that thread, and the handler runs there.
+  ///
+  /// \param type The message type (e.g., a flatbuffer enum).
+  /// \param length The size in bytes of the message.
+  /// \param message A pointer to the message buffer.
+  /// \param handler A callback to run once the message has been written, or
+  /// once the write has failed.
+  void WriteMessageAsync(int64_t type, int64_t length, const uint8_t *message,
+                         const std::function<void(const ray::Status &)> &handler);
+
+  /// Whether the bytes queued for asynchronous writes exceed the high-water
+  /// mark. Callers that can defer their messages should stop writing to this
+  /// connection until this returns false again.
+  ///
+  /// \return True if the peer is not keeping up with the writes to it.
+  bool IsAboveHighWaterMark() const;
+
+  /// Whether the bytes queued for asynchronous writes have drained to the
+  /// low-water mark. Callers that deferred messages because the connection was
+  /// above its high-water mark should resume once this returns true.
+  ///
+  /// \return True if the peer has caught up with the writes to it.
+  bool IsBelowLowWaterMark() const;
+
   /// Write a buffer to this connection.
   ///
   /// \param buffer The buffer.
@@ -54,8 +106,56 @@ class ServerConnection {
                   boost::system::error_code &ec);
 
  protected:
+  /// A private constructor for a server connection.
+  ///
+  /// \param socket The socket.
+  /// \param owner_service The event loop that the socket was created on, if it
+  /// runs on another thread than the callers of WriteMessage. Otherwise,
+  /// nullptr.
+  ServerConnection(boost::asio::basic_stream_socket<T> &&socket,
+                   boost::asio::io_service *owner_service = nullptr);
+
+  /// Write a message on the calling thread, as described in WriteMessage.
+  ray::Status DoWriteMessage(int64_t type, int64_t length, const uint8_t *message);
+
+  /// Queue a message to be written asynchronously on the calling thread, as
+  /// described in WriteMessageAsync.
+  void QueueWriteMessage(int64_t type, std::vector<uint8_t> &&message,
+                         const std::function<void(const ray::Status &)> &handler);
+
+  /// A message that is queued to be written asynchronously.
+  struct AsyncWriteBuffer {
+    int64_t write_version;
+    int64_t write_type;
+    uint64_t write_length;
+    std::vector<uint8_t> write_message;
+    std::function<void(const ray::Status &)> handler;
+  };
+
+  /// Write as many queued messages as possible in a single gather write.
+  void DoAsyncWrites();
+
+  /// Run the handlers of the messages written by the last gather write, then
+  /// start the next one.
+  ///
+  /// \param error The error from the gather write, if any.
+  /// \param num_messages The number of queued messages that it covered.
+  void HandleAsyncWrites(const boost::system::error_code &error, size_t num_messages);
+
   /// The socket connection to the server.
   boost::asio::basic_stream_socket<T> socket_;
+  /// The event loop on another thread that owns socket_, or nullptr.
+  boost::asio::io_service *owner_service_;
+  /// Queue of messages that have not been fully written yet. The messages at
+  /// the front of the queue may belong to the gather write in flight.
+  std::deque<std::unique_ptr<AsyncWriteBuffer>> async_write_queue_;
+  /// The total size in bytes of the messages in async_write_queue_.
+  int64_t async_write_queue_bytes_;
+  /// Whether a gather write is currently in flight.
+  bool async_write_in_flight_;
+
+ private:
+  RAY_DISALLOW_COPY_AND_ASSIGN(ServerConnection);
 };
 
 template <typename T>
@@ -73,18 +173,21 @@ using MessageHandler =
 /// writing messages to the client, like in ServerConnection, this typename can
 /// also be used to process messages asynchronously from client.
 template <typename T>
-class ClientConnection : public ServerConnection<T>,
-                         public std::enable_shared_from_this<ClientConnection<T>> {
+class ClientConnection : public ServerConnection<T> {
  public:
   /// Allocate a new node client connection.
   ///
   /// \param new_client_handler A reference to the client handler.
   /// \param message_handler A reference to the message handler.
   /// \param socket The client socket.
+  /// \param owner_service The event loop that the socket was created on, if it
+  /// runs on another thread than the client handler. Messages are then read,
+  /// and the message handler runs, on that event loop's thread.
   /// \return std::shared_ptr<ClientConnection>.
   static std::shared_ptr<ClientConnection<T>> Create(
       ClientHandler<T> &new_client_handler, MessageHandler<T> &message_handler,
-      boost::asio::basic_stream_socket<T> &&socket);
+      boost::asio::basic_stream_socket<T> &&socket,
+      boost::asio::io_service *owner_service = nullptr);
 
   /// \return The ClientID of the remote client.
   const ClientID &GetClientID();
@@ -97,10 +200,19 @@ class ClientConnection : public ServerConnection<T>,
   /// ProcessClientMessage handler will be called.
   void ProcessMessages();
 
+  /// \return The size in bytes of the message that is being processed. This
+  /// is only valid while the message handler runs.
+  int64_t GetMessageLength() const;
+
  private:
   /// A private constructor for a node client connection.
   ClientConnection(MessageHandler<T> &message_handler,
-                   boost::asio::basic_stream_socket<T> &&socket);
+                   boost::asio::basic_stream_socket<T> &&socket,
+                   boost::asio::io_service *owner_service);
+  /// Start reading the next message header on the calling thread.
+  void ReadMessageHeader();
+  /// \return A shared pointer to this connection as a ClientConnection.
+  std::shared_ptr<ClientConnection<T>> shared_ClientConnection_from_this();
   /// Process an error from the last operation, then process the  message
   /// header from the client.
   void ProcessMessageHeader(const boost::system::error_code &error);
@@ -0,0 +1,274 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <list>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include <boost/asio.hpp>
+#include <boost/asio/error.hpp>
+
+#include "common/state/ray_config.h"
+#include "ray/common/client_connection.h"
+
+namespace ray {
+
+class ClientConnectionTest : public ::testing::Test {
+ public:
+  ClientConnectionTest() : io_service_(), in_(io_service_), out_(io_service_) {
+    boost::asio::local::connect_pair(in_, out_);
+  }
+
+  /// Read one message from the reading end of the socket pair and check that
+  /// it has the expected type and contents.
+  void ReadMessage(int64_t expected_type, const std::vector<uint8_t> &expected) {
+    int64_t version;
+    int64_t type;
+    uint64_t length;
+    std::vector<boost::asio::mutable_buffer> header;
+    header.push_back(boost::asio::buffer(&version, sizeof(version)));
+    header.push_back(boost::asio::buffer(&type, sizeof(type)));
+    header.push_back(boost::asio::buffer(&length, sizeof(length)));
+    boost::asio::read(out_, header);
+    ASSERT_EQ(version, RayConfig::instance().ray_protocol_version());
+    ASSERT_EQ(type, expected_type);
+    ASSERT_EQ(length, expected.size());
+    std::vector<uint8_t> message(length);
+    boost::asio::read(out_, boost::asio::buffer(message));
+    ASSERT_EQ(message, expected);
+  }
+
+ protected:
+  ClientHandler<boost::asio::local::stream_protocol> client_handler_ =
+      [](LocalClientConnection &client) {};
+  MessageHandler<boost::asio::local::stream_protocol> message_handler_ =
+      [](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+         const uint8_t *data) {};
+  boost::asio::io_service io_service_;
+  boost::asio::local::stream_protocol::socket in_;
+  boost::asio::local::stream_protocol::socket out_;
+};
+
+TEST_F(ClientConnectionTest, AsyncWriteTest) {
+  auto connection = LocalServerConnection::Create(std::move(in_));
+  std::vector<uint8_t> message = {1, 2, 3, 4, 5};
+  int num_messages = 1000;
+  int num_written = 0;
+  for (int i = 0; i < num_messages; i++) {
+    connection->WriteMessageAsync(i, message.size(), message.data(),
+                                  [&num_written](const ray::Status &status) {
+                                    ASSERT_TRUE(status.ok());
+                                    num_written++;
+                                  });
+  }
+  // A blocking write cannot wait for the pending asynchronous writes on this
+  // thread, so it fails without writing anything.
+  ASSERT_FALSE(
+      connection->WriteMessage(num_messages, message.size(), message.data()).ok());
+  io_service_.run();
+  ASSERT_EQ(num_written, num_messages);
+  for (int i = 0; i < num_messages; i++) {
+    ReadMessage(i, message);
+  }
+  // Once the queue is empty, blocking writes work again.
+  RAY_CHECK_OK(connection->WriteMessage(num_messages, message.size(), message.data()));
+  ReadMessage(num_messages, message);
+}
+
+TEST_F(ClientConnectionTest, AsyncWriteStalledPeerTest) {
+  auto connection = LocalServerConnection::Create(std::move(in_));
+  // Queue more data than the socket buffers can hold while the peer is not
+  // reading. None of these calls may block.
+  std::vector<uint8_t> message(1024 * 1024, 7);
+  int num_messages = 0;
+  int num_written = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (!connection->IsAboveHighWaterMark()) {
+    connection->WriteMessageAsync(num_messages, message.size(), message.data(),
+                                  [&num_written](const ray::Status &status) {
+                                    ASSERT_TRUE(status.ok());
+                                    num_written++;
+                                  });
+    num_messages++;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_LT(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count(), 1);
+
+  // The event loop keeps running other handlers while the peer is stalled.
+  int num_timer_fired = 0;
+  std::list<boost::asio::deadline_timer> timers;
+  for (int i = 0; i < 10; i++) {
+    timers.emplace_back(io_service_, boost::posix_time::milliseconds(i));
+    timers.back().async_wait(
+        [&num_timer_fired](const boost::system::error_code &) { num_timer_fired++; });
+  }
+  while (num_timer_fired < 10) {
+    io_service_.run_one();
+  }
+  ASSERT_LT(num_written, num_messages);
+  ASSERT_TRUE(connection->IsAboveHighWaterMark());
+  ASSERT_FALSE(connection->IsBelowLowWaterMark());
+
+  // Once the peer starts reading again, every message arrives intact and in
+  // order, and the connection drops below its high-water mark.
+  std::thread reader([this, num_messages, &message]() {
+    for (int i = 0; i < num_messages; i++) {
+      ReadMessage(i, message);
+    }
+  });
+  io_service_.run();
+  reader.join();
+  ASSERT_EQ(num_written, num_messages);
+  ASSERT_FALSE(connection->IsAboveHighWaterMark());
+  ASSERT_TRUE(connection->IsBelowLowWaterMark());
+}
+
+TEST_F(ClientConnectionTest, AsyncWriteErrorTest) {
+  auto connection = LocalServerConnection::Create(std::move(in_));
+  out_.close();
+  std::vector<uint8_t> message = {1, 2, 3};
+  int num_failed = 0;
+  for (int i = 0; i < 10; i++) {
+    connection->WriteMessageAsync(i, message.size(), message.data(),
+                                  [&num_failed](const ray::Status &status) {
+                                    ASSERT_FALSE(status.ok());
+                                    num_failed++;
+                                  });
+  }
+  io_service_.run();
+  ASSERT_EQ(num_failed, 10);
+}
+
+TEST_F(ClientConnectionTest, OwnerThreadTest) {
+  // The connection's socket belongs to an event loop on another thread.
+  boost::asio::io_service owner_service;
+  boost::asio::io_service::work work(owner_service);
+  std::thread owner_thread([&owner_service]() { owner_service.run(); });
+  boost::asio::local::stream_protocol::socket owner_in(owner_service);
+  boost::asio::local::stream_protocol::socket owner_out(io_service_);
+  boost::asio::local::connect_pair(owner_in, owner_out);
+
+  std::vector<uint8_t> message = {1, 2, 3};
+  int num_messages = 100;
+  std::thread::id owner_id = owner_thread.get_id();
+  std::promise<int> num_received;
+  int received = 0;
+  ClientHandler<boost::asio::local::stream_protocol> client_handler =
+      [](LocalClientConnection &client) { client.ProcessMessages(); };
+  MessageHandler<boost::asio::local::stream_protocol> message_handler =
+      [&](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+          const uint8_t *data) {
+        // Messages are read on the owner's thread.
+        ASSERT_EQ(std::this_thread::get_id(), owner_id);
+        if (message_type == 0) {
+          num_received.set_value(received);
+          return;
+        }
+        received++;
+        client->ProcessMessages();
+      };
+  auto connection = LocalClientConnection::Create(client_handler, message_handler,
+                                                  std::move(owner_in), &owner_service);
+
+  // Write from this thread while the owner's thread reads from the socket. The
+  // peer echoes each message back, and the last one tells the connection to
+  // stop reading.
+  std::thread peer([this, &owner_out, &message, num_messages]() {
+    for (int i = 1; i <= num_messages + 1; i++) {
+      int64_t version;
+      int64_t type;
+      uint64_t length;
+      std::vector<boost::asio::mutable_buffer> header;
+      header.push_back(boost::asio::buffer(&version, sizeof(version)));
+      header.push_back(boost::asio::buffer(&type, sizeof(type)));
+      header.push_back(boost::asio::buffer(&length, sizeof(length)));
+      boost::asio::read(owner_out, header);
+      std::vector<uint8_t> data(length);
+      boost::asio::read(owner_out, boost::asio::buffer(data));
+      if (i > num_messages) {
+        type = 0;
+      }
+      boost::asio::write(owner_out, header);
+      boost::asio::write(owner_out, boost::asio::buffer(data));
+    }
+  });
+  for (int i = 1; i <= num_messages + 1; i++) {
+    RAY_CHECK_OK(connection->WriteMessage(i, message.size(), message.data()));
+  }
+  peer.join();
+  ASSERT_EQ(num_received.get_future().get(), num_messages);
+  owner_service.stop();
+  owner_thread.join();
+}
+
+TEST_F(ClientConnectionTest, OwnerThreadQueuedWriteTest) {
+  boost::asio::io_service owner_service;
+  boost::asio::io_service::work work(owner_service);
+  std::thread owner_thread([&owner_service]() { owner_service.run(); });
+  boost::asio::local::stream_protocol::socket owner_in(owner_service);
+  out_.close();
+  boost::asio::local::connect_pair(owner_in, out_);
+  auto connection = LocalClientConnection::Create(client_handler_, message_handler_,
+                                                  std::move(owner_in), &owner_service);
+
+  // Queue more data than the socket buffers can hold while the peer is not
+  // reading, then write a message from this thread. The message is written
+  // after the queued ones, and only once it has been written does the
+  // blocking write return.
+  std::vector<uint8_t> message(1024 * 1024, 7);
+  int num_messages = 16;
+  std::atomic<int> num_written(0);
+  for (int i = 0; i < num_messages; i++) {
+    connection->WriteMessageAsync(i, message.size(), message.data(),
+                                  [&num_written](const ray::Status &status) {
+                                    ASSERT_TRUE(status.ok());
+                                    num_written++;
+                                  });
+  }
+  std::thread reader([this, num_messages, &message]() {
+    for (int i = 0; i <= num_messages; i++) {
+      ReadMessage(i, message);
+    }
+  });
+  RAY_CHECK_OK(connection->WriteMessage(num_messages, message.size(), message.data()));
+  ASSERT_EQ(num_written, num_messages);
+  reader.join();
+  owner_service.stop();
+  owner_thread.join();
+}
+
+TEST_F(ClientConnectionTest, StoppedOwnerTest) {
+  boost::asio::io_service owner_service;
+  boost::asio::io_service::work work(owner_service);
+  std::thread owner_thread([&owner_service]() { owner_service.run(); });
+  boost::asio::local::stream_protocol::socket owner_in(owner_service);
+  out_.close();
+  boost::asio::local::connect_pair(owner_in, out_);
+  auto connection = LocalClientConnection::Create(client_handler_, message_handler_,
+                                                  std::move(owner_in), &owner_service);
+
+  // Stall a write behind a peer that does not read, then stop the owner's
+  // event loop while a blocking write waits for it. The write must fail
+  // instead of waiting forever.
+  std::vector<uint8_t> message(16 * 1024 * 1024, 7);
+  connection->WriteMessageAsync(0, message.size(), message.data(), nullptr);
+  std::thread stopper([&owner_service]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    owner_service.stop();
+  });
+  ASSERT_FALSE(connection->WriteMessage(1, message.size(), message.data()).ok());
+  stopper.join();
+  owner_thread.join();
+  // Writes to a connection whose event loop has already stopped fail right
+  // away.
+  ASSERT_FALSE(connection->WriteMessage(1, message.size(), message.data()).ok());
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
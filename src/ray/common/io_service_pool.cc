@@ -0,0 +1,38 @@
+#include "ray/common/io_service_pool.h"
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+IoServicePool::IoServicePool(int num_threads) : next_(0) {
+  RAY_CHECK(num_threads > 0);
+  for (int i = 0; i < num_threads; i++) {
+    io_services_.emplace_back(new boost::asio::io_service());
+    work_.emplace_back(new boost::asio::io_service::work(*io_services_.back()));
+  }
+  for (const auto &io_service : io_services_) {
+    boost::asio::io_service *service = io_service.get();
+    threads_.emplace_back([service]() { service->run(); });
+  }
+}
+
+IoServicePool::~IoServicePool() { Stop(); }
+
+boost::asio::io_service &IoServicePool::Next() {
+  boost::asio::io_service &io_service = *io_services_[next_];
+  next_ = (next_ + 1) % io_services_.size();
+  return io_service;
+}
+
+void IoServicePool::Stop() {
+  work_.clear();
+  for (const auto &io_service : io_services_) {
+    io_service->stop();
+  }
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+}  // namespace ray
@@ -0,0 +1,52 @@
+#ifndef RAY_COMMON_IO_SERVICE_POOL_H
+#define RAY_COMMON_IO_SERVICE_POOL_H
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "ray/util/macros.h"
+
+namespace ray {
+
+/// \class IoServicePool
+///
+/// A fixed set of event loops, each run by its own thread. Connections are
+/// spread across the loops by creating their sockets on the loop returned by
+/// Next, so that each connection's reads and handlers run on one thread.
+class IoServicePool {
+ public:
+  /// Start the threads.
+  ///
+  /// \param num_threads The number of event loops and threads. This must be
+  /// at least 1.
+  explicit IoServicePool(int num_threads);
+
+  /// Stop the threads, if they are still running.
+  ~IoServicePool();
+
+  /// Get the next event loop, in round-robin order.
+  ///
+  /// \return The event loop.
+  boost::asio::io_service &Next();
+
+  /// Stop every event loop and wait for its thread to exit. Handlers that did
+  /// not run yet are dropped.
+  void Stop();
+
+ private:
+  std::vector<std::unique_ptr<boost::asio::io_service>> io_services_;
+  /// Keeps each event loop running while it has no pending work.
+  std::vector<std::unique_ptr<boost::asio::io_service::work>> work_;
+  std::vector<std::thread> threads_;
+  /// The index of the event loop that Next returns.
+  size_t next_;
+
+  RAY_DISALLOW_COPY_AND_ASSIGN(IoServicePool);
+};
+
+}  // namespace ray
+
+#endif  // RAY_COMMON_IO_SERVICE_POOL_H
@@ -0,0 +1,80 @@
+#ifndef RAY_COMMON_MPSC_QUEUE_H
+#define RAY_COMMON_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+#include "ray/util/macros.h"
+
+namespace ray {
+
+/// \class MpscQueue
+///
+/// An unbounded multiple-producer, single-consumer FIFO queue. Any number of
+/// threads can push without taking a lock, and each push is a single atomic
+/// exchange. Only one thread may pop.
+///
+/// The values that one thread pushes are popped in the order that it pushed
+/// them. While a push is halfway done, Pop may report that the queue is empty
+/// even though values that were pushed after it are complete. Producers that
+/// need to wake the consumer must therefore do so after their push returns.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load()) {}
+
+  ~MpscQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+    delete tail_;
+  }
+
+  /// Append a value to the queue. This may be called from any thread.
+  ///
+  /// \param value The value to append.
+  void Push(T value) {
+    Node *node = new Node();
+    node->value = std::move(value);
+    // Claim the head of the queue, then link the previous head to the new
+    // node. The consumer stops at the previous head until it is linked.
+    Node *previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  /// Remove the oldest value from the queue. Only the consumer may call this.
+  ///
+  /// \param value The removed value.
+  /// \return True if a value was removed, false if the queue was empty.
+  bool Pop(T *value) {
+    // The tail is a node whose value was already popped. The oldest value in
+    // the queue is in the node after it.
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *value = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    std::atomic<Node *> next;
+    T value;
+  };
+
+  /// The most recently pushed node.
+  std::atomic<Node *> head_;
+  /// The node before the oldest value. This is only accessed by the consumer.
+  Node *tail_;
+
+  RAY_DISALLOW_COPY_AND_ASSIGN(MpscQueue);
+};
+
+}  // namespace ray
+
+#endif  // RAY_COMMON_MPSC_QUEUE_H
@@ -0,0 +1,69 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ray/common/mpsc_queue.h"
+
+namespace ray {
+
+TEST(MpscQueueTest, OrderTest) {
+  MpscQueue<int> queue;
+  int value;
+  ASSERT_FALSE(queue.Pop(&value));
+  for (int i = 0; i < 10; i++) {
+    queue.Push(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(queue.Pop(&value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(queue.Pop(&value));
+}
+
+TEST(MpscQueueTest, DestroyNonEmptyTest) {
+  // Values that were never popped are destroyed along with the queue.
+  auto value = std::make_shared<int>(1);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(value);
+    queue.Push(value);
+    ASSERT_EQ(value.use_count(), 3);
+  }
+  ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueueTest, ConcurrentPushTest) {
+  const int num_threads = 4;
+  const int num_values = 100000;
+  // Each value holds the index of the thread that pushed it in the high bits.
+  MpscQueue<int64_t> queue;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&queue, t, num_values]() {
+      for (int i = 0; i < num_values; i++) {
+        queue.Push((static_cast<int64_t>(t) << 32) | i);
+      }
+    });
+  }
+  // Each thread's values must be popped in the order that it pushed them.
+  std::vector<int64_t> next(num_threads, 0);
+  int64_t num_popped = 0;
+  while (num_popped < num_threads * num_values) {
+    int64_t value;
+    if (queue.Pop(&value)) {
+      int thread = value >> 32;
+      ASSERT_EQ(value & 0xffffffff, next[thread]);
+      next[thread]++;
+      num_popped++;
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int64_t value;
+  ASSERT_FALSE(queue.Pop(&value));
+}
+
+}  // namespace ray
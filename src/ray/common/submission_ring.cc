@@ -0,0 +1,221 @@
+#include "ray/common/submission_ring.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace {
+
+/// Identifies a mapped segment as a submission ring.
+constexpr uint64_t kRingMagic = 0x52415952494e4731;
+/// Every record starts with this header and is padded to a multiple of it.
+struct RecordHeader {
+  int64_t type;
+  int64_t length;
+};
+constexpr uint64_t kRecordAlignment = sizeof(RecordHeader);
+/// The type of a record that pads out the end of the buffer, so that the next
+/// record starts at the beginning.
+constexpr int64_t kWrapRecordType = -1;
+/// The offset of the message buffer from the start of the segment.
+constexpr int64_t kBufferOffset = 256;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "The ring is shared between processes, so its atomics must be "
+              "lock-free");
+
+uint64_t RecordSize(int64_t length) {
+  return sizeof(RecordHeader) +
+         (length + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+}  // namespace
+
+ray::Status SubmissionRing::Create(const std::string &name, int64_t capacity,
+                                   std::unique_ptr<SubmissionRing> *ring) {
+  RAY_CHECK(capacity > 0);
+  static_assert(sizeof(Header) <= kBufferOffset, "ring header is too large");
+  int64_t rounded_capacity = 4 * kRecordAlignment;
+  while (rounded_capacity < capacity) {
+    rounded_capacity *= 2;
+  }
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return ray::Status::IOError("shm_open " + name + ": " + std::strerror(errno));
+  }
+  int64_t segment_size = kBufferOffset + rounded_capacity;
+  if (ftruncate(fd, segment_size) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return ray::Status::IOError("ftruncate " + name + ": " + std::strerror(errno));
+  }
+  void *segment =
+      mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return ray::Status::IOError("mmap " + name + ": " + std::strerror(errno));
+  }
+  // The segment starts out zeroed, so the atomics only need their values set.
+  Header *header = reinterpret_cast<Header *>(segment);
+  header->capacity = rounded_capacity;
+  header->head.store(0);
+  header->tail.store(0);
+  // The consumer starts out idle, so the first message rings the doorbell.
+  header->consumer_waiting.store(1);
+  header->magic = kRingMagic;
+  ring->reset(new SubmissionRing(name, static_cast<uint8_t *>(segment), segment_size));
+  return ray::Status::OK();
+}
+
+ray::Status SubmissionRing::Open(const std::string &name,
+                                 std::unique_ptr<SubmissionRing> *ring) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return ray::Status::IOError("shm_open " + name + ": " + std::strerror(errno));
+  }
+  // Nobody else needs to find the segment by name now.
+  shm_unlink(name.c_str());
+  struct stat segment_stat;
+  if (fstat(fd, &segment_stat) != 0 || segment_stat.st_size <= kBufferOffset) {
+    close(fd);
+    return ray::Status::IOError("invalid submission ring " + name);
+  }
+  int64_t segment_size = segment_stat.st_size;
+  void *segment =
+      mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    return ray::Status::IOError("mmap " + name + ": " + std::strerror(errno));
+  }
+  Header *header = reinterpret_cast<Header *>(segment);
+  if (header->magic != kRingMagic ||
+      header->capacity != segment_size - kBufferOffset) {
+    munmap(segment, segment_size);
+    return ray::Status::IOError("invalid submission ring " + name);
+  }
+  ring->reset(new SubmissionRing(name, static_cast<uint8_t *>(segment), segment_size));
+  return ray::Status::OK();
+}
+
+SubmissionRing::SubmissionRing(const std::string &name, uint8_t *segment,
+                               int64_t segment_size)
+    : name_(name),
+      segment_(segment),
+      segment_size_(segment_size),
+      header_(reinterpret_cast<Header *>(segment)),
+      buffer_(segment + kBufferOffset),
+      peeked_record_size_(0) {}
+
+SubmissionRing::~SubmissionRing() {
+  // The consumer normally unlinks the name as soon as it maps the segment, but
+  // the producer unlinks it too in case the consumer never did.
+  shm_unlink(name_.c_str());
+  munmap(segment_, segment_size_);
+}
+
+int64_t SubmissionRing::MaxMessageLength() const {
+  // A record and the padding before it must fit in the buffer together.
+  return header_->capacity / 2 - sizeof(RecordHeader);
+}
+
+uint64_t SubmissionRing::BytesToWrite(uint64_t head, int64_t length) const {
+  const uint64_t capacity = header_->capacity;
+  const uint64_t record_size = RecordSize(length);
+  uint64_t contiguous = capacity - (head & (capacity - 1));
+  return contiguous < record_size ? contiguous + record_size : record_size;
+}
+
+bool SubmissionRing::HasSpace(int64_t length) const {
+  RAY_CHECK(length >= 0 && length <= MaxMessageLength());
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t tail = header_->tail.load(std::memory_order_acquire);
+  return header_->capacity - (head - tail) >= BytesToWrite(head, length);
+}
+
+bool SubmissionRing::Write(int64_t type, int64_t length, const uint8_t *message) {
+  RAY_CHECK(length >= 0 && length <= MaxMessageLength());
+  const uint64_t capacity = header_->capacity;
+  const uint64_t record_size = RecordSize(length);
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t offset = head & (capacity - 1);
+  uint64_t padding = BytesToWrite(head, length) - record_size;
+  // Wait for the consumer to free enough space.
+  while (!HasSpace(length)) {
+    sched_yield();
+  }
+  if (padding != 0) {
+    RecordHeader wrap = {kWrapRecordType, 0};
+    std::memcpy(buffer_ + offset, &wrap, sizeof(wrap));
+    head += padding;
+    offset = 0;
+  }
+  RecordHeader record = {type, length};
+  std::memcpy(buffer_ + offset, &record, sizeof(record));
+  if (length > 0) {
+    std::memcpy(buffer_ + offset + sizeof(record), message, length);
+  }
+  head += record_size;
+  // Publish the record, then check whether the consumer went to sleep. Both
+  // are sequentially consistent so that this pairs with PrepareToWait: either
+  // the consumer sees the new head, or the producer sees the consumer waiting.
+  header_->head.store(head, std::memory_order_seq_cst);
+  return header_->consumer_waiting.exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+bool SubmissionRing::IsEmpty() const {
+  return header_->tail.load(std::memory_order_acquire) ==
+         header_->head.load(std::memory_order_acquire);
+}
+
+bool SubmissionRing::Peek(int64_t *type, int64_t *length, const uint8_t **message) {
+  const uint64_t capacity = header_->capacity;
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  while (tail != header_->head.load(std::memory_order_acquire)) {
+    uint64_t offset = tail & (capacity - 1);
+    RecordHeader record;
+    std::memcpy(&record, buffer_ + offset, sizeof(record));
+    if (record.type == kWrapRecordType) {
+      // Skip the padding at the end of the buffer.
+      tail += capacity - offset;
+      header_->tail.store(tail, std::memory_order_release);
+      continue;
+    }
+    RAY_CHECK(record.length >= 0 && RecordSize(record.length) <= capacity - offset)
+        << "Corrupt submission ring " << name_;
+    *type = record.type;
+    *length = record.length;
+    *message = buffer_ + offset + sizeof(record);
+    peeked_record_size_ = RecordSize(record.length);
+    return true;
+  }
+  return false;
+}
+
+void SubmissionRing::Pop() {
+  RAY_CHECK(peeked_record_size_ != 0);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  header_->tail.store(tail + peeked_record_size_, std::memory_order_release);
+  peeked_record_size_ = 0;
+}
+
+bool SubmissionRing::PrepareToWait() {
+  header_->consumer_waiting.store(1, std::memory_order_seq_cst);
+  if (header_->head.load(std::memory_order_seq_cst) !=
+      header_->tail.load(std::memory_order_relaxed)) {
+    // A message arrived before the producer could see that we are waiting.
+    header_->consumer_waiting.store(0, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ray
@@ -0,0 +1,140 @@
+#ifndef RAY_COMMON_SUBMISSION_RING_H
+#define RAY_COMMON_SUBMISSION_RING_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "ray/status.h"
+#include "ray/util/macros.h"
+
+namespace ray {
+
+/// \class SubmissionRing
+///
+/// A single-producer, single-consumer ring of messages in a named shared memory
+/// segment. A worker writes the messages that it would otherwise send to its
+/// local scheduler's socket into the ring, and the local scheduler reads them
+/// without a system call or an allocation per message.
+///
+/// The ring has no doorbell of its own. When the consumer runs out of
+/// messages, it marks itself as waiting with PrepareToWait. The next Write then
+/// tells the producer to wake the consumer, which the worker does by sending a
+/// doorbell message on the socket that the consumer is already polling. While
+/// the consumer is busy, the producer writes without any system call.
+class SubmissionRing {
+ public:
+  /// Create a new ring in a named shared memory segment. This is called by the
+  /// producer.
+  ///
+  /// \param name The name of the shared memory segment, e.g.
+  /// "/ray_submission_ring_1234".
+  /// \param capacity The size in bytes of the message buffer. This is rounded
+  /// up to a power of two.
+  /// \param ring The created ring.
+  /// \return Status.
+  static ray::Status Create(const std::string &name, int64_t capacity,
+                            std::unique_ptr<SubmissionRing> *ring);
+
+  /// Map a ring that another process created. This is called by the consumer.
+  /// The name of the segment is unlinked once it is mapped, so that the
+  /// segment is freed once both processes have unmapped it.
+  ///
+  /// \param name The name of the shared memory segment.
+  /// \param ring The opened ring.
+  /// \return Status.
+  static ray::Status Open(const std::string &name, std::unique_ptr<SubmissionRing> *ring);
+
+  ~SubmissionRing();
+
+  /// \return The name of the shared memory segment.
+  const std::string &Name() const { return name_; }
+
+  /// \return The largest message length that Write accepts.
+  int64_t MaxMessageLength() const;
+
+  /// Check whether Write would append a message right away. Only the producer
+  /// may call this, and the answer stays true until it writes again.
+  ///
+  /// \param length The length of the message.
+  /// \return True if the ring has room for the message.
+  bool HasSpace(int64_t length) const;
+
+  /// Append a message to the ring. If the ring is full, this spins until the
+  /// consumer has made enough room. Only the producer may call this. A producer
+  /// that must not wait for a stalled consumer checks HasSpace first.
+  ///
+  /// \param type The message type.
+  /// \param length The length of the message. This must not exceed
+  /// MaxMessageLength().
+  /// \param message The message bytes.
+  /// \return True if the consumer was waiting, in which case the caller must
+  /// wake it up.
+  bool Write(int64_t type, int64_t length, const uint8_t *message);
+
+  /// \return True if the consumer has popped every message written so far.
+  bool IsEmpty() const;
+
+  /// Get the oldest message in the ring without removing it. Only the
+  /// consumer may call this.
+  ///
+  /// \param type The message type.
+  /// \param length The length of the message.
+  /// \param message A pointer to the message bytes. This stays valid until the
+  /// next call to Pop.
+  /// \return True if there was a message, false if the ring is empty.
+  bool Peek(int64_t *type, int64_t *length, const uint8_t **message);
+
+  /// Remove the message returned by the last successful Peek, and return its
+  /// space to the producer.
+  void Pop();
+
+  /// Mark the consumer as waiting for a doorbell. The consumer must call this
+  /// once Peek returns false and before it stops polling the ring.
+  ///
+  /// \return True if the consumer may stop polling. False if messages arrived
+  /// in the meantime, in which case the consumer must keep draining the ring.
+  bool PrepareToWait();
+
+ private:
+  /// The control block at the start of the shared memory segment. The
+  /// positions are byte offsets that only ever grow; their value modulo the
+  /// capacity is the offset into the message buffer.
+  struct Header {
+    uint64_t magic;
+    int64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<int32_t> consumer_waiting;
+  };
+
+  SubmissionRing(const std::string &name, uint8_t *segment, int64_t segment_size);
+
+  /// Get the number of bytes that writing a message takes, including the
+  /// padding that moves it to the start of the buffer if it does not fit at
+  /// the end.
+  ///
+  /// \param head The producer's position.
+  /// \param length The length of the message.
+  /// \return The number of bytes.
+  uint64_t BytesToWrite(uint64_t head, int64_t length) const;
+
+  /// The name of the shared memory segment.
+  std::string name_;
+  /// The mapped shared memory segment.
+  uint8_t *segment_;
+  /// The size in bytes of the mapping.
+  int64_t segment_size_;
+  /// The control block, at the start of the segment.
+  Header *header_;
+  /// The message buffer, after the control block.
+  uint8_t *buffer_;
+  /// The size in bytes of the record returned by the last Peek, or 0.
+  uint64_t peeked_record_size_;
+
+  RAY_DISALLOW_COPY_AND_ASSIGN(SubmissionRing);
+};
+
+}  // namespace ray
+
+#endif  // RAY_COMMON_SUBMISSION_RING_H
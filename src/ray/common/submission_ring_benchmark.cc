@@ -0,0 +1,241 @@
+// Compare submitting messages through a SubmissionRing against writing them to
+// a Unix domain socket, the way a worker submits tasks to its local scheduler.
+//
+// Usage: submission_ring_benchmark [num_messages] [message_length]
+//
+// The producer and consumer run in separate processes. For the ring, the
+// producer writes a one-byte doorbell to a socket only when the consumer was
+// waiting, like the worker does. This reports the submission rate, the number
+// of socket writes, and the average round-trip latency of a single message when
+// the consumer replies to each one over the socket.
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ray/common/submission_ring.h"
+
+namespace ray {
+
+namespace {
+
+constexpr int64_t kRingCapacity = 1 << 20;
+
+void ReadFully(int fd, void *data, size_t length) {
+  uint8_t *bytes = static_cast<uint8_t *>(data);
+  while (length > 0) {
+    ssize_t n = read(fd, bytes, length);
+    if (n <= 0) {
+      std::abort();
+    }
+    bytes += n;
+    length -= n;
+  }
+}
+
+void WriteSocketMessage(int fd, int64_t type, const std::vector<uint8_t> &message) {
+  int64_t header[2] = {type, static_cast<int64_t>(message.size())};
+  struct iovec iov[2];
+  iov[0].iov_base = header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = const_cast<uint8_t *>(message.data());
+  iov[1].iov_len = message.size();
+  ssize_t expected = sizeof(header) + message.size();
+  if (writev(fd, iov, 2) != expected) {
+    std::abort();
+  }
+}
+
+int64_t ReadSocketMessage(int fd, std::vector<uint8_t> *message) {
+  int64_t header[2];
+  ReadFully(fd, header, sizeof(header));
+  message->resize(header[1]);
+  ReadFully(fd, message->data(), header[1]);
+  return header[0];
+}
+
+/// Run the consumer in a child process and the producer in this one, and
+/// return the producer's elapsed time in seconds.
+template <typename Producer, typename Consumer>
+double RunInTwoProcesses(Producer producer, Consumer consumer) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    consumer();
+    _exit(0);
+  }
+  auto start = std::chrono::steady_clock::now();
+  producer();
+  int status;
+  waitpid(pid, &status, 0);
+  auto end = std::chrono::steady_clock::now();
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::abort();
+  }
+  return std::chrono::duration<double>(end - start).count();
+}
+
+/// Drain the ring until the consumer would go to sleep, calling handler on
+/// each message. Returns the number of messages handled.
+template <typename Handler>
+int64_t DrainRing(SubmissionRing &ring, Handler handler) {
+  int64_t num_handled = 0;
+  do {
+    int64_t type;
+    int64_t length;
+    const uint8_t *message;
+    while (ring.Peek(&type, &length, &message)) {
+      handler(type, length, message);
+      ring.Pop();
+      num_handled++;
+    }
+  } while (!ring.PrepareToWait());
+  return num_handled;
+}
+
+void BenchmarkSocket(int64_t num_messages, const std::vector<uint8_t> &message) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::abort();
+  }
+  double seconds = RunInTwoProcesses(
+      [&]() {
+        for (int64_t i = 0; i < num_messages; i++) {
+          WriteSocketMessage(fds[0], i, message);
+        }
+        // Wait for the consumer to acknowledge the last message.
+        char ack;
+        ReadFully(fds[0], &ack, 1);
+      },
+      [&]() {
+        std::vector<uint8_t> received;
+        for (int64_t i = 0; i < num_messages; i++) {
+          ReadSocketMessage(fds[1], &received);
+        }
+        char ack = 0;
+        if (write(fds[1], &ack, 1) != 1) {
+          std::abort();
+        }
+      });
+  double round_trip = RunInTwoProcesses(
+      [&]() {
+        std::vector<uint8_t> reply;
+        for (int64_t i = 0; i < num_messages / 10; i++) {
+          WriteSocketMessage(fds[0], i, message);
+          ReadSocketMessage(fds[0], &reply);
+        }
+      },
+      [&]() {
+        std::vector<uint8_t> received;
+        for (int64_t i = 0; i < num_messages / 10; i++) {
+          int64_t type = ReadSocketMessage(fds[1], &received);
+          WriteSocketMessage(fds[1], type, std::vector<uint8_t>());
+        }
+      });
+  printf("%-8s %12.0f %14lld %14.2f\n", "socket", num_messages / seconds,
+         static_cast<long long>(num_messages), round_trip * 1e6 / (num_messages / 10));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+void BenchmarkRing(int64_t num_messages, const std::vector<uint8_t> &message) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::abort();
+  }
+  std::string name = "/ray_submission_ring_benchmark_" + std::to_string(getpid());
+  int64_t num_doorbells = 0;
+  std::unique_ptr<SubmissionRing> ring;
+  if (!SubmissionRing::Create(name, kRingCapacity, &ring).ok()) {
+    std::abort();
+  }
+  double seconds = RunInTwoProcesses(
+      [&]() {
+        for (int64_t i = 0; i < num_messages; i++) {
+          if (ring->Write(i, message.size(), message.data())) {
+            char doorbell = 0;
+            if (write(fds[0], &doorbell, 1) != 1) {
+              std::abort();
+            }
+            num_doorbells++;
+          }
+        }
+        char ack;
+        ReadFully(fds[0], &ack, 1);
+      },
+      [&]() {
+        std::unique_ptr<SubmissionRing> consumer;
+        if (!SubmissionRing::Open(name, &consumer).ok()) {
+          std::abort();
+        }
+        int64_t num_received = 0;
+        while (num_received < num_messages) {
+          char doorbell;
+          ReadFully(fds[1], &doorbell, 1);
+          num_received += DrainRing(*consumer, [](int64_t, int64_t, const uint8_t *) {});
+        }
+        char ack = 0;
+        if (write(fds[1], &ack, 1) != 1) {
+          std::abort();
+        }
+      });
+  // Each run needs a fresh ring, because the consumer unlinks its name.
+  ring.reset();
+  if (!SubmissionRing::Create(name, kRingCapacity, &ring).ok()) {
+    std::abort();
+  }
+  double round_trip = RunInTwoProcesses(
+      [&]() {
+        std::vector<uint8_t> reply;
+        for (int64_t i = 0; i < num_messages / 10; i++) {
+          if (ring->Write(i, message.size(), message.data())) {
+            char doorbell = 0;
+            if (write(fds[0], &doorbell, 1) != 1) {
+              std::abort();
+            }
+          }
+          ReadSocketMessage(fds[0], &reply);
+        }
+      },
+      [&]() {
+        std::unique_ptr<SubmissionRing> consumer;
+        if (!SubmissionRing::Open(name, &consumer).ok()) {
+          std::abort();
+        }
+        int64_t num_received = 0;
+        while (num_received < num_messages / 10) {
+          char doorbell;
+          ReadFully(fds[1], &doorbell, 1);
+          num_received += DrainRing(
+              *consumer, [&](int64_t type, int64_t, const uint8_t *) {
+                WriteSocketMessage(fds[1], type, std::vector<uint8_t>());
+              });
+        }
+      });
+  printf("%-8s %12.0f %14lld %14.2f\n", "ring", num_messages / seconds,
+         static_cast<long long>(num_doorbells), round_trip * 1e6 / (num_messages / 10));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+}  // namespace
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  int64_t num_messages = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 1000000;
+  int64_t message_length = argc > 2 ? std::strtoll(argv[2], nullptr, 10) : 256;
+  std::vector<uint8_t> message(message_length, 1);
+  printf("%-8s %12s %14s %14s\n", "channel", "messages/s", "socket writes",
+         "round trip");
+  printf("%-8s %12s %14s %14s\n", "", "", "", "(us)");
+  ray::BenchmarkSocket(num_messages, message);
+  ray::BenchmarkRing(num_messages, message);
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ray/common/submission_ring.h"
+
+namespace ray {
+
+class SubmissionRingTest : public ::testing::Test {
+ public:
+  SubmissionRingTest()
+      : name_("/ray_submission_ring_test_" + std::to_string(getpid())) {}
+
+  /// Create a ring and open it again as the consumer.
+  void CreateRing(int64_t capacity) {
+    RAY_CHECK_OK(SubmissionRing::Create(name_, capacity, &producer_));
+    RAY_CHECK_OK(SubmissionRing::Open(name_, &consumer_));
+  }
+
+  /// Pop one message from the consumer and check its type and contents.
+  void PopMessage(int64_t expected_type, const std::vector<uint8_t> &expected) {
+    int64_t type;
+    int64_t length;
+    const uint8_t *message;
+    ASSERT_TRUE(consumer_->Peek(&type, &length, &message));
+    ASSERT_EQ(type, expected_type);
+    ASSERT_EQ(std::vector<uint8_t>(message, message + length), expected);
+    consumer_->Pop();
+  }
+
+ protected:
+  std::string name_;
+  std::unique_ptr<SubmissionRing> producer_;
+  std::unique_ptr<SubmissionRing> consumer_;
+};
+
+TEST_F(SubmissionRingTest, WrapAroundTest) {
+  CreateRing(1024);
+  ASSERT_EQ(producer_->MaxMessageLength(), consumer_->MaxMessageLength());
+  // The name is unlinked as soon as the consumer has mapped the segment.
+  std::unique_ptr<SubmissionRing> other;
+  ASSERT_FALSE(SubmissionRing::Open(name_, &other).ok());
+
+  // Messages of varying lengths, so that the records hit the end of the buffer
+  // at different offsets.
+  for (int i = 0; i < 1000; i++) {
+    std::vector<uint8_t> message(i % producer_->MaxMessageLength(), i % 256);
+    producer_->Write(i, message.size(), message.data());
+    PopMessage(i, message);
+    ASSERT_TRUE(consumer_->IsEmpty());
+  }
+}
+
+TEST_F(SubmissionRingTest, OrderingTest) {
+  CreateRing(4096);
+  // Fill the ring without popping, then drain it.
+  std::vector<std::vector<uint8_t>> messages;
+  for (int i = 0; i < 50; i++) {
+    messages.push_back(std::vector<uint8_t>(i, i));
+    producer_->Write(i, i, messages.back().data());
+  }
+  ASSERT_FALSE(producer_->IsEmpty());
+  for (int i = 0; i < 50; i++) {
+    PopMessage(i, messages[i]);
+  }
+  int64_t type;
+  int64_t length;
+  const uint8_t *message;
+  ASSERT_FALSE(consumer_->Peek(&type, &length, &message));
+  ASSERT_TRUE(producer_->IsEmpty());
+}
+
+TEST_F(SubmissionRingTest, HasSpaceTest) {
+  CreateRing(1024);
+  std::vector<uint8_t> message(producer_->MaxMessageLength(), 1);
+  // The ring is full after two messages of the largest length, and has room
+  // again once the first one is popped.
+  producer_->Write(0, message.size(), message.data());
+  ASSERT_TRUE(producer_->HasSpace(message.size()));
+  producer_->Write(1, message.size(), message.data());
+  ASSERT_FALSE(producer_->HasSpace(0));
+  PopMessage(0, message);
+  ASSERT_TRUE(producer_->HasSpace(message.size()));
+  PopMessage(1, message);
+  // A message that does not fit at the end of the buffer also needs room for
+  // the padding before it. Once the small message is popped, there is room for
+  // the record, but not for the padding too.
+  std::vector<uint8_t> small(100, 2);
+  producer_->Write(2, small.size(), small.data());
+  producer_->Write(3, message.size(), message.data());
+  PopMessage(2, small);
+  ASSERT_TRUE(producer_->HasSpace(small.size()));
+  ASSERT_FALSE(producer_->HasSpace(message.size()));
+  PopMessage(3, message);
+  ASSERT_TRUE(producer_->HasSpace(message.size()));
+}
+
+TEST_F(SubmissionRingTest, DoorbellTest) {
+  CreateRing(1024);
+  std::vector<uint8_t> message = {1, 2, 3};
+  // The consumer starts out waiting, so the first write rings the doorbell and
+  // the writes after it do not.
+  ASSERT_TRUE(producer_->Write(0, message.size(), message.data()));
+  ASSERT_FALSE(producer_->Write(1, message.size(), message.data()));
+  // The consumer may not wait while there are messages in the ring.
+  ASSERT_FALSE(consumer_->PrepareToWait());
+  PopMessage(0, message);
+  PopMessage(1, message);
+  ASSERT_TRUE(consumer_->PrepareToWait());
+  // Once the consumer is waiting, the next write rings the doorbell again.
+  ASSERT_TRUE(producer_->Write(2, message.size(), message.data()));
+  ASSERT_FALSE(producer_->Write(3, message.size(), message.data()));
+}
+
+TEST_F(SubmissionRingTest, ProducerConsumerTest) {
+  CreateRing(4096);
+  int num_messages = 20000;
+  int num_doorbells = 0;
+  std::thread producer([this, num_messages, &num_doorbells]() {
+    for (int i = 0; i < num_messages; i++) {
+      std::vector<uint8_t> message(i % 100, i % 256);
+      if (producer_->Write(i, message.size(), message.data())) {
+        num_doorbells++;
+      }
+    }
+  });
+  // Drain the ring the way the local scheduler does, but yield instead of
+  // sleeping on a doorbell. No message may be lost or reordered.
+  int i = 0;
+  while (i < num_messages) {
+    int64_t type;
+    int64_t length;
+    const uint8_t *message;
+    while (consumer_->Peek(&type, &length, &message)) {
+      ASSERT_EQ(type, i);
+      ASSERT_EQ(length, i % 100);
+      for (int64_t j = 0; j < length; j++) {
+        ASSERT_EQ(message[j], i % 256);
+      }
+      consumer_->Pop();
+      i++;
+    }
+    if (consumer_->PrepareToWait()) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  ASSERT_TRUE(consumer_->IsEmpty());
+  ASSERT_GE(num_doorbells, 1);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -46,6 +46,25 @@ class PubsubInterface {
   virtual ~PubsubInterface(){};
 };
 
+/// \class LogInterface
+///
+/// The interface for an append-only log. The client of a storage system that
+/// implements this interface can read a log and append to it conditionally.
+template <typename ID, typename Data>
+class LogInterface {
+ public:
+  using DataT = typename Data::NativeTableType;
+  using Callback = std::function<void(AsyncGcsClient *client, const ID &id,
+                                      const std::vector<DataT> &data)>;
+  using WriteCallback =
+      std::function<void(AsyncGcsClient *client, const ID &id, const DataT &data)>;
+  virtual Status AppendAt(const JobID &job_id, const ID &id, std::shared_ptr<DataT> &data,
+                          const WriteCallback &done, const WriteCallback &failure,
+                          int log_length) = 0;
+  virtual Status Lookup(const JobID &job_id, const ID &id, const Callback &lookup) = 0;
+  virtual ~LogInterface(){};
+};
+
 /// \class Log
 ///
 /// A GCS table where every entry is an append-only log. This class is not
@@ -59,14 +78,12 @@ class PubsubInterface {
 ///   ClientTable: Stores a log of which GCS clients have been added or deleted
 ///                from the system.
 template <typename ID, typename Data>
-class Log : virtual public PubsubInterface<ID> {
+class Log : public LogInterface<ID, Data>, virtual public PubsubInterface<ID> {
  public:
-  using DataT = typename Data::NativeTableType;
-  using Callback = std::function<void(AsyncGcsClient *client, const ID &id,
-                                      const std::vector<DataT> &data)>;
+  using DataT = typename LogInterface<ID, Data>::DataT;
+  using Callback = typename LogInterface<ID, Data>::Callback;
   /// The callback to call when a write to a key succeeds.
-  using WriteCallback =
-      std::function<void(AsyncGcsClient *client, const ID &id, const DataT &data)>;
+  using WriteCallback = typename LogInterface<ID, Data>::WriteCallback;
   /// The callback to call when a SUBSCRIBE call completes and we are ready to
   /// request and receive notifications.
   using SubscriptionCallback = std::function<void(AsyncGcsClient *client)>;
@@ -200,8 +217,13 @@ class TableInterface {
  public:
   using DataT = typename Data::NativeTableType;
   using WriteCallback = typename Log<ID, Data>::WriteCallback;
+  using Callback =
+      std::function<void(AsyncGcsClient *client, const ID &id, const DataT &data)>;
+  using FailureCallback = std::function<void(AsyncGcsClient *client, const ID &id)>;
   virtual Status Add(const JobID &job_id, const ID &task_id, std::shared_ptr<DataT> &data,
                      const WriteCallback &done) = 0;
+  virtual Status Lookup(const JobID &job_id, const ID &id, const Callback &lookup,
+                        const FailureCallback &failure) = 0;
   virtual ~TableInterface(){};
 };
 
@@ -220,11 +242,10 @@ class Table : private Log<ID, Data>,
               virtual public PubsubInterface<ID> {
  public:
   using DataT = typename Log<ID, Data>::DataT;
-  using Callback =
-      std::function<void(AsyncGcsClient *client, const ID &id, const DataT &data)>;
+  using Callback = typename TableInterface<ID, Data>::Callback;
   using WriteCallback = typename Log<ID, Data>::WriteCallback;
   /// The callback to call when a Lookup call returns an empty entry.
-  using FailureCallback = std::function<void(AsyncGcsClient *client, const ID &id)>;
+  using FailureCallback = typename TableInterface<ID, Data>::FailureCallback;
   /// The callback to call when a Subscribe call completes and we are ready to
   /// request and receive notifications.
   using SubscriptionCallback = typename Log<ID, Data>::SubscriptionCallback;
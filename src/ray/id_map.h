@@ -0,0 +1,547 @@
+#ifndef RAY_ID_MAP_H_
+#define RAY_ID_MAP_H_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "ray/id.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace internal {
+
+static_assert(kUniqueIDSize == 20, "The ID tables are specialized for 20-byte IDs");
+
+/// Hash all bytes of an ID. Unlike UniqueID::hash, which deliberately ignores
+/// the object index so that a task and its objects map to the same Redis
+/// shard, this mixes every byte, so the objects created by one task do not
+/// collide.
+///
+/// \param id The ID to hash.
+/// \return The hash of the ID.
+inline uint64_t IdTableHash(const UniqueID &id) {
+  const uint8_t *data = id.data();
+  uint64_t a, b;
+  uint32_t c;
+  std::memcpy(&a, data, sizeof(a));
+  std::memcpy(&b, data + 8, sizeof(b));
+  std::memcpy(&c, data + 16, sizeof(c));
+  uint64_t h = (a ^ 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+  h ^= (b + (h >> 29)) * 0x94d049bb133111ebULL;
+  h ^= (static_cast<uint64_t>(c) + (h >> 32)) * 0xff51afd7ed558ccdULL;
+  h ^= h >> 31;
+  return h;
+}
+
+/// Compare two IDs for equality, using SSE2 for the first 16 bytes when it is
+/// available.
+///
+/// \param lhs The first ID.
+/// \param rhs The second ID.
+/// \return Whether the IDs are equal.
+inline bool IdTableEqual(const UniqueID &lhs, const UniqueID &rhs) {
+  const uint8_t *l = lhs.data();
+  const uint8_t *r = rhs.data();
+#ifdef __SSE2__
+  __m128i lv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l));
+  __m128i rv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(lv, rv)) != 0xffff) {
+    return false;
+  }
+  uint32_t lt, rt;
+  std::memcpy(&lt, l + 16, sizeof(lt));
+  std::memcpy(&rt, r + 16, sizeof(rt));
+  return lt == rt;
+#else
+  return std::memcmp(l, r, kUniqueIDSize) == 0;
+#endif
+}
+
+/// The key of a map slot.
+template <typename Value>
+const UniqueID &SlotKey(const std::pair<const UniqueID, Value> &slot) {
+  return slot.first;
+}
+
+/// The key of a set slot.
+inline const UniqueID &SlotKey(const UniqueID &slot) { return slot; }
+
+/// An open-addressing hash table for ID keys. The slots are stored inline in a
+/// single array, next to an array of one-byte control words. Control words are
+/// probed 16 at a time with SSE2 when it is available. This is the shared
+/// implementation behind IdMap and IdSet.
+///
+/// Inserting may rehash the table, which invalidates all iterators and
+/// references. Erasing leaves a tombstone, so it never moves other elements
+/// and only invalidates iterators and references to the erased element.
+template <typename Slot>
+class IdTable {
+ public:
+  class const_iterator;
+
+  class iterator {
+   public:
+    iterator() : table_(nullptr), index_(0) {}
+    Slot &operator*() const { return table_->slots_[index_]; }
+    Slot *operator->() const { return &table_->slots_[index_]; }
+    iterator &operator++() {
+      index_ = table_->NextFull(index_ + 1);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it = *this;
+      ++(*this);
+      return it;
+    }
+    bool operator==(const iterator &other) const { return index_ == other.index_; }
+    bool operator!=(const iterator &other) const { return index_ != other.index_; }
+
+   private:
+    friend class IdTable;
+    friend class const_iterator;
+    iterator(IdTable *table, size_t index) : table_(table), index_(index) {}
+    IdTable *table_;
+    size_t index_;
+  };
+
+  class const_iterator {
+   public:
+    const_iterator() : table_(nullptr), index_(0) {}
+    const_iterator(const iterator &it) : table_(it.table_), index_(it.index_) {}
+    const Slot &operator*() const { return table_->slots_[index_]; }
+    const Slot *operator->() const { return &table_->slots_[index_]; }
+    const_iterator &operator++() {
+      index_ = table_->NextFull(index_ + 1);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator it = *this;
+      ++(*this);
+      return it;
+    }
+    bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+    bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+
+   private:
+    friend class IdTable;
+    const_iterator(const IdTable *table, size_t index) : table_(table), index_(index) {}
+    const IdTable *table_;
+    size_t index_;
+  };
+
+  IdTable() : ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), tombstones_(0) {}
+
+  IdTable(const IdTable &other) : IdTable() {
+    Reserve(other.size_);
+    for (const auto &slot : other) {
+      Emplace(slot);
+    }
+  }
+
+  IdTable(IdTable &&other) : IdTable() { Swap(other); }
+
+  IdTable &operator=(const IdTable &other) {
+    if (this != &other) {
+      IdTable copy(other);
+      Swap(copy);
+    }
+    return *this;
+  }
+
+  IdTable &operator=(IdTable &&other) {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+
+  ~IdTable() { Release(); }
+
+  iterator begin() { return iterator(this, NextFull(0)); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, NextFull(0)); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator find(const UniqueID &key) { return iterator(this, Find(key)); }
+  const_iterator find(const UniqueID &key) const {
+    return const_iterator(this, Find(key));
+  }
+  size_t count(const UniqueID &key) const { return Find(key) != capacity_ ? 1 : 0; }
+
+  /// Erase the element that an iterator points to.
+  ///
+  /// \param it An iterator to an element of this table.
+  /// \return An iterator to the next element.
+  iterator erase(const_iterator it) {
+    EraseAt(it.index_);
+    return iterator(this, NextFull(it.index_ + 1));
+  }
+
+  size_t erase(const UniqueID &key) {
+    size_t index = Find(key);
+    if (index == capacity_) {
+      return 0;
+    }
+    EraseAt(index);
+    return 1;
+  }
+
+  void clear() { Clear(); }
+
+  void reserve(size_t count) { Reserve(count); }
+
+  void swap(IdTable &other) { Swap(other); }
+
+ protected:
+  /// Insert a slot constructed from the given arguments if the key is not
+  /// present yet.
+  ///
+  /// \param key The key of the slot.
+  /// \param args The arguments to construct the slot with.
+  /// \return An iterator to the slot with the given key, and whether it was
+  /// inserted.
+  template <typename... Args>
+  std::pair<iterator, bool> EmplaceKey(const UniqueID &key, Args &&... args) {
+    uint64_t hash = IdTableHash(key);
+    size_t index = Find(key, hash);
+    if (index != capacity_) {
+      return std::make_pair(iterator(this, index), false);
+    }
+    if ((size_ + tombstones_ + 1) * 8 > capacity_ * 7) {
+      // Grow if the table is mostly live elements, otherwise just clear out the
+      // tombstones.
+      Rehash(size_ * 2 + 2 > capacity_ ? capacity_ * 2 : capacity_);
+    }
+    index = FindInsertSlot(hash);
+    if (ctrl_[index] == kDeleted) {
+      tombstones_--;
+    }
+    ctrl_[index] = Tag(hash);
+    new (&slots_[index]) Slot(std::forward<Args>(args)...);
+    size_++;
+    return std::make_pair(iterator(this, index), true);
+  }
+
+  template <typename SlotArg>
+  std::pair<iterator, bool> Emplace(SlotArg &&slot) {
+    const UniqueID &key = SlotKey(slot);
+    return EmplaceKey(key, std::forward<SlotArg>(slot));
+  }
+
+ private:
+  /// The number of control words that are probed at once.
+  static constexpr size_t kGroupSize = 16;
+  /// The control word of a slot that has never been used since the last
+  /// rehash.
+  static constexpr int8_t kEmpty = -128;
+  /// The control word of a slot whose element was erased.
+  static constexpr int8_t kDeleted = -2;
+  // The control word of a full slot holds the low 7 bits of the hash, so its
+  // high bit is never set.
+
+  static int8_t Tag(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+  /// Return a bit mask of the slots in the group starting at the given index
+  /// whose control word equals the given value.
+  uint32_t MatchGroup(size_t group_start, int8_t value) const {
+#ifdef __SSE2__
+    __m128i ctrl =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl_ + group_start));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+      if (ctrl_[group_start + i] == value) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+#endif
+  }
+
+  /// Return a bit mask of the slots in the group starting at the given index
+  /// that are empty or deleted.
+  uint32_t MatchFree(size_t group_start) const {
+#ifdef __SSE2__
+    __m128i ctrl =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl_ + group_start));
+    return _mm_movemask_epi8(ctrl);
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+      if (ctrl_[group_start + i] < 0) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+#endif
+  }
+
+  static int LowestBit(uint32_t mask) { return __builtin_ctz(mask); }
+
+  /// The group that a probe for the given hash starts at.
+  size_t FirstGroup(uint64_t hash) const {
+    return ((hash >> 7) & (capacity_ / kGroupSize - 1)) * kGroupSize;
+  }
+
+  size_t NextGroup(size_t group_start) const {
+    return (group_start + kGroupSize) & (capacity_ - 1);
+  }
+
+  size_t Find(const UniqueID &key) const { return Find(key, IdTableHash(key)); }
+
+  /// Return the index of the slot with the given key, or capacity_ if there is
+  /// none.
+  size_t Find(const UniqueID &key, uint64_t hash) const {
+    if (capacity_ == 0) {
+      return capacity_;
+    }
+    int8_t tag = Tag(hash);
+    size_t group = FirstGroup(hash);
+    while (true) {
+      uint32_t matches = MatchGroup(group, tag);
+      while (matches != 0) {
+        size_t index = group + LowestBit(matches);
+        if (IdTableEqual(SlotKey(slots_[index]), key)) {
+          return index;
+        }
+        matches &= matches - 1;
+      }
+      // A probe never continues past a group with an empty slot.
+      if (MatchGroup(group, kEmpty) != 0) {
+        return capacity_;
+      }
+      group = NextGroup(group);
+    }
+  }
+
+  /// Return the index of the first free slot on the probe sequence of the
+  /// given hash. The table must have a free slot.
+  size_t FindInsertSlot(uint64_t hash) const {
+    size_t group = FirstGroup(hash);
+    while (true) {
+      uint32_t free = MatchFree(group);
+      if (free != 0) {
+        return group + LowestBit(free);
+      }
+      group = NextGroup(group);
+    }
+  }
+
+  /// Return the index of the first full slot at or after the given index, or
+  /// capacity_ if there is none.
+  size_t NextFull(size_t index) const {
+    while (index < capacity_ && ctrl_[index] < 0) {
+      index++;
+    }
+    return index;
+  }
+
+  void EraseAt(size_t index) {
+    slots_[index].~Slot();
+    size_--;
+    // If the group still has an empty slot, then no probe has ever continued
+    // past it, so this slot can be marked empty instead of deleted.
+    size_t group = index & ~(kGroupSize - 1);
+    if (MatchGroup(group, kEmpty) != 0) {
+      ctrl_[index] = kEmpty;
+    } else {
+      ctrl_[index] = kDeleted;
+      tombstones_++;
+    }
+  }
+
+  void Reserve(size_t count) {
+    if (count == 0) {
+      return;
+    }
+    size_t capacity = capacity_ == 0 ? kGroupSize : capacity_;
+    while (count * 8 > capacity * 7) {
+      capacity *= 2;
+    }
+    if (capacity != capacity_) {
+      Rehash(capacity);
+    }
+  }
+
+  /// Move all elements into a new table of the given capacity, which must be a
+  /// power of two that is at least kGroupSize.
+  void Rehash(size_t capacity) {
+    if (capacity < kGroupSize) {
+      capacity = kGroupSize;
+    }
+    int8_t *old_ctrl = ctrl_;
+    Slot *old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_ = new int8_t[capacity];
+    std::memset(ctrl_, kEmpty, capacity);
+    slots_ = std::allocator<Slot>().allocate(capacity);
+    capacity_ = capacity;
+    tombstones_ = 0;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] >= 0) {
+        uint64_t hash = IdTableHash(SlotKey(old_slots[i]));
+        size_t index = FindInsertSlot(hash);
+        ctrl_[index] = Tag(hash);
+        new (&slots_[index]) Slot(std::move(old_slots[i]));
+        old_slots[i].~Slot();
+      }
+    }
+    if (old_capacity != 0) {
+      delete[] old_ctrl;
+      std::allocator<Slot>().deallocate(old_slots, old_capacity);
+    }
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (ctrl_[i] >= 0) {
+        slots_[i].~Slot();
+      }
+    }
+    if (capacity_ != 0) {
+      std::memset(ctrl_, kEmpty, capacity_);
+    }
+    size_ = 0;
+    tombstones_ = 0;
+  }
+
+  void Release() {
+    Clear();
+    if (capacity_ != 0) {
+      delete[] ctrl_;
+      std::allocator<Slot>().deallocate(slots_, capacity_);
+    }
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+  }
+
+  void Swap(IdTable &other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(tombstones_, other.tombstones_);
+  }
+
+  /// One control word per slot.
+  int8_t *ctrl_;
+  /// The slots. Only the slots whose control word is non-negative hold a
+  /// constructed element.
+  Slot *slots_;
+  /// The number of slots. This is zero or a power of two that is at least
+  /// kGroupSize.
+  size_t capacity_;
+  /// The number of elements.
+  size_t size_;
+  /// The number of deleted slots.
+  size_t tombstones_;
+};
+
+}  // namespace internal
+
+/// \class IdMap
+///
+/// A flat hash map from IDs to values, for use in place of
+/// std::unordered_map<UniqueID, Value> on hot paths. Elements are stored
+/// inline in one array instead of in separately allocated nodes.
+///
+/// Note that, unlike std::unordered_map, inserting may invalidate references
+/// to other elements.
+template <typename Value>
+class IdMap : public internal::IdTable<std::pair<const UniqueID, Value>> {
+  using Table = internal::IdTable<std::pair<const UniqueID, Value>>;
+
+ public:
+  using key_type = UniqueID;
+  using mapped_type = Value;
+  using value_type = std::pair<const UniqueID, Value>;
+  using iterator = typename Table::iterator;
+  using const_iterator = typename Table::const_iterator;
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return this->EmplaceKey(value.first, value);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&value) {
+    const UniqueID key = value.first;
+    return this->EmplaceKey(key, std::move(value));
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(const UniqueID &key, Args &&... args) {
+    return this->EmplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  std::pair<iterator, bool> emplace(std::pair<UniqueID, Value> &&pair) {
+    return insert(value_type(std::move(pair)));
+  }
+
+  Value &operator[](const UniqueID &key) {
+    return this->EmplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key),
+                            std::forward_as_tuple())
+        .first->second;
+  }
+
+  Value &at(const UniqueID &key) {
+    auto it = this->find(key);
+    RAY_CHECK(it != this->end());
+    return it->second;
+  }
+
+  const Value &at(const UniqueID &key) const {
+    auto it = this->find(key);
+    RAY_CHECK(it != this->end());
+    return it->second;
+  }
+};
+
+/// \class IdSet
+///
+/// A flat hash set of IDs, for use in place of std::unordered_set<UniqueID>
+/// on hot paths.
+class IdSet : public internal::IdTable<UniqueID> {
+  using Table = internal::IdTable<UniqueID>;
+
+ public:
+  using key_type = UniqueID;
+  using value_type = UniqueID;
+  using iterator = Table::iterator;
+  using const_iterator = Table::const_iterator;
+
+  IdSet() {}
+
+  template <typename InputIt>
+  IdSet(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  std::pair<iterator, bool> insert(const UniqueID &id) {
+    return this->EmplaceKey(id, id);
+  }
+
+  std::pair<iterator, bool> emplace(const UniqueID &id) { return insert(id); }
+};
+
+}  // namespace ray
+
+#endif  // RAY_ID_MAP_H_
@@ -0,0 +1,128 @@
+// Compare IdMap and IdSet against std::unordered_map and std::unordered_set.
+//
+// Usage: id_map_benchmark [max_num_keys]
+//
+// For each container size from 10^4 up to max_num_keys (10^7 by default), this
+// reports the average time per insert, successful lookup, failed lookup and
+// erase.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ray/id_map.h"
+
+namespace ray {
+
+namespace {
+
+/// Create object IDs the way tasks do: ten return values per task, so that
+/// the keys differ only in their object index.
+std::vector<ObjectID> MakeKeys(size_t num_keys) {
+  std::vector<ObjectID> keys;
+  keys.reserve(num_keys);
+  while (keys.size() < num_keys) {
+    TaskID task_id = FinishTaskId(TaskID::from_random());
+    for (int64_t i = 1; i <= 10 && keys.size() < num_keys; i++) {
+      keys.push_back(ComputeReturnId(task_id, i));
+    }
+  }
+  return keys;
+}
+
+template <typename Function>
+double NanosPerOp(size_t num_ops, Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / num_ops;
+}
+
+template <typename Map>
+void BenchmarkMap(const char *name, const std::vector<ObjectID> &keys,
+                  const std::vector<ObjectID> &missing_keys) {
+  Map map;
+  size_t found = 0;
+  double insert = NanosPerOp(keys.size(), [&]() {
+    for (size_t i = 0; i < keys.size(); i++) {
+      map.emplace(keys[i], i);
+    }
+  });
+  double hit = NanosPerOp(keys.size(), [&]() {
+    for (const auto &key : keys) {
+      found += map.count(key);
+    }
+  });
+  double miss = NanosPerOp(missing_keys.size(), [&]() {
+    for (const auto &key : missing_keys) {
+      found += map.count(key);
+    }
+  });
+  double erase = NanosPerOp(keys.size(), [&]() {
+    for (const auto &key : keys) {
+      map.erase(key);
+    }
+  });
+  if (found != keys.size()) {
+    std::abort();
+  }
+  printf("%10zu %-28s %8.1f %8.1f %8.1f %8.1f\n", keys.size(), name, insert, hit, miss,
+         erase);
+}
+
+template <typename Set>
+void BenchmarkSet(const char *name, const std::vector<ObjectID> &keys,
+                  const std::vector<ObjectID> &missing_keys) {
+  Set set;
+  size_t found = 0;
+  double insert = NanosPerOp(keys.size(), [&]() {
+    for (const auto &key : keys) {
+      set.insert(key);
+    }
+  });
+  double hit = NanosPerOp(keys.size(), [&]() {
+    for (const auto &key : keys) {
+      found += set.count(key);
+    }
+  });
+  double miss = NanosPerOp(missing_keys.size(), [&]() {
+    for (const auto &key : missing_keys) {
+      found += set.count(key);
+    }
+  });
+  double erase = NanosPerOp(keys.size(), [&]() {
+    for (const auto &key : keys) {
+      set.erase(key);
+    }
+  });
+  if (found != keys.size()) {
+    std::abort();
+  }
+  printf("%10zu %-28s %8.1f %8.1f %8.1f %8.1f\n", keys.size(), name, insert, hit, miss,
+         erase);
+}
+
+}  // namespace
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  size_t max_num_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  printf("%10s %-28s %8s %8s %8s %8s\n", "keys", "container", "insert", "hit", "miss",
+         "erase");
+  printf("%10s %-28s %8s %8s %8s %8s\n", "", "", "(ns)", "(ns)", "(ns)", "(ns)");
+  for (size_t num_keys = 10000; num_keys <= max_num_keys; num_keys *= 10) {
+    auto keys = ray::MakeKeys(num_keys);
+    auto missing_keys = ray::MakeKeys(num_keys);
+    ray::BenchmarkMap<std::unordered_map<ray::ObjectID, size_t>>(
+        "std::unordered_map", keys, missing_keys);
+    ray::BenchmarkMap<ray::IdMap<size_t>>("ray::IdMap", keys, missing_keys);
+    ray::BenchmarkSet<std::unordered_set<ray::ObjectID>>("std::unordered_set", keys,
+                                                         missing_keys);
+    ray::BenchmarkSet<ray::IdSet>("ray::IdSet", keys, missing_keys);
+  }
+  return 0;
+}
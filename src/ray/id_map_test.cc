@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ray/id_map.h"
+
+namespace ray {
+
+/// Make an ID that differs from others created with the same task ID only in
+/// the object index, like the return values of one task.
+ObjectID MakeObjectId(const TaskID &task_id, int64_t index) {
+  return ComputeReturnId(task_id, index);
+}
+
+TEST(IdMapTest, TestBasicOperations) {
+  IdMap<int> map;
+  ASSERT_TRUE(map.empty());
+  ObjectID id1 = ObjectID::from_random();
+  ObjectID id2 = ObjectID::from_random();
+  ASSERT_TRUE(map.emplace(id1, 1).second);
+  ASSERT_FALSE(map.emplace(id1, 2).second);
+  ASSERT_EQ(map.at(id1), 1);
+  map[id2] += 3;
+  ASSERT_EQ(map.size(), 2);
+  ASSERT_EQ(map.count(id2), 1);
+  ASSERT_EQ(map.find(id2)->second, 3);
+  ASSERT_EQ(map.erase(id1), 1);
+  ASSERT_EQ(map.erase(id1), 0);
+  ASSERT_TRUE(map.find(id1) == map.end());
+  IdMap<int> copy = map;
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(copy.size(), 1);
+  ASSERT_EQ(copy[id2], 3);
+}
+
+TEST(IdMapTest, TestMatchesStdContainers) {
+  // Apply the same random operations to an IdMap and an std::unordered_map.
+  // Keys share task IDs so that they only differ in the object index.
+  std::mt19937 gen(0);
+  std::vector<ObjectID> keys;
+  for (int i = 0; i < 500; i++) {
+    TaskID task_id = FinishTaskId(TaskID::from_random());
+    for (int j = 1; j <= 10; j++) {
+      keys.push_back(MakeObjectId(task_id, j));
+    }
+  }
+  IdMap<int> map;
+  IdSet set;
+  std::unordered_map<ObjectID, int> expected_map;
+  std::unordered_set<ObjectID> expected_set;
+  std::uniform_int_distribution<int> key_dist(0, keys.size() - 1);
+  for (int i = 0; i < 100000; i++) {
+    const ObjectID &key = keys[key_dist(gen)];
+    switch (gen() % 3) {
+    case 0:
+      map[key] = i;
+      expected_map[key] = i;
+      set.insert(key);
+      expected_set.insert(key);
+      break;
+    case 1:
+      ASSERT_EQ(map.erase(key), expected_map.erase(key));
+      ASSERT_EQ(set.erase(key), expected_set.erase(key));
+      break;
+    default:
+      ASSERT_EQ(map.count(key), expected_map.count(key));
+      ASSERT_EQ(set.count(key), expected_set.count(key));
+      if (expected_map.count(key) == 1) {
+        ASSERT_EQ(map.at(key), expected_map.at(key));
+      }
+    }
+    ASSERT_EQ(map.size(), expected_map.size());
+    ASSERT_EQ(set.size(), expected_set.size());
+  }
+
+  // Iteration visits every element exactly once, including while erasing.
+  size_t visited = 0;
+  for (const auto &entry : map) {
+    ASSERT_EQ(expected_map.at(entry.first), entry.second);
+    visited++;
+  }
+  ASSERT_EQ(visited, expected_map.size());
+  for (auto it = set.begin(); it != set.end();) {
+    ASSERT_EQ(expected_set.erase(*it), 1);
+    it = set.erase(it);
+  }
+  ASSERT_TRUE(set.empty());
+  ASSERT_TRUE(expected_set.empty());
+}
+
+TEST(IdMapTest, TestNonTrivialValues) {
+  IdMap<std::vector<ObjectID>> map;
+  std::vector<ObjectID> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(ObjectID::from_random());
+    map[keys.back()].push_back(keys.back());
+  }
+  for (const auto &key : keys) {
+    ASSERT_EQ(map[key].size(), 1);
+    ASSERT_EQ(map[key][0], key);
+  }
+  IdMap<std::vector<ObjectID>> moved = std::move(map);
+  ASSERT_EQ(moved.size(), keys.size());
+  ASSERT_TRUE(map.empty());
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
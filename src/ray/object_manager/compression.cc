@@ -0,0 +1,138 @@
+#include "ray/object_manager/compression.h"
+
+#include <string>
+
+#ifdef RAY_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef RAY_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+/// The number of samples that ShouldCompress compresses, and their size.
+constexpr uint64_t kNumSamples = 4;
+constexpr uint64_t kSampleSize = 16 * 1024;
+
+/// Data whose samples compress to more than this fraction of their size is not
+/// worth compressing.
+constexpr double kMaxSampleCompressionRatio = 0.9;
+
+#ifdef RAY_WITH_ZSTD
+/// The zstd compression level. Low levels compress several hundred megabytes
+/// per second, which keeps up with the network.
+constexpr int kZstdLevel = 1;
+#endif
+
+}  // namespace
+
+namespace ray {
+
+std::vector<CompressionCodec> SupportedCompressionCodecs() {
+  std::vector<CompressionCodec> codecs;
+#ifdef RAY_WITH_LZ4
+  codecs.push_back(CompressionCodec::CompressionCodec_LZ4);
+#endif
+#ifdef RAY_WITH_ZSTD
+  codecs.push_back(CompressionCodec::CompressionCodec_ZSTD);
+#endif
+  return codecs;
+}
+
+bool ShouldCompress(CompressionCodec codec, const uint8_t *data, uint64_t size) {
+  if (size == 0) {
+    return false;
+  }
+  // Sample evenly spaced blocks, or all of the data if it is small.
+  std::vector<uint8_t> samples;
+  if (size <= kNumSamples * kSampleSize) {
+    samples.assign(data, data + size);
+  } else {
+    const uint64_t stride = (size - kSampleSize) / (kNumSamples - 1);
+    samples.reserve(kNumSamples * kSampleSize);
+    for (uint64_t i = 0; i < kNumSamples; i++) {
+      const uint8_t *sample = data + i * stride;
+      samples.insert(samples.end(), sample, sample + kSampleSize);
+    }
+  }
+  std::vector<uint8_t> compressed;
+  if (!Compress(codec, samples.data(), samples.size(), &compressed).ok()) {
+    return false;
+  }
+  return compressed.size() <= kMaxSampleCompressionRatio * samples.size();
+}
+
+ray::Status Compress(CompressionCodec codec, const uint8_t *data, uint64_t size,
+                     std::vector<uint8_t> *compressed) {
+  switch (codec) {
+#ifdef RAY_WITH_LZ4
+  case CompressionCodec::CompressionCodec_LZ4: {
+    if (size > static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE)) {
+      return ray::Status::Invalid("Data is too large for LZ4");
+    }
+    compressed->resize(LZ4_compressBound(static_cast<int>(size)));
+    int compressed_size = LZ4_compress_default(
+        reinterpret_cast<const char *>(data),
+        reinterpret_cast<char *>(compressed->data()), static_cast<int>(size),
+        static_cast<int>(compressed->size()));
+    if (compressed_size <= 0) {
+      return ray::Status::Invalid("LZ4 compression failed");
+    }
+    compressed->resize(compressed_size);
+    return ray::Status::OK();
+  }
+#endif
+#ifdef RAY_WITH_ZSTD
+  case CompressionCodec::CompressionCodec_ZSTD: {
+    compressed->resize(ZSTD_compressBound(size));
+    size_t compressed_size =
+        ZSTD_compress(compressed->data(), compressed->size(), data, size, kZstdLevel);
+    if (ZSTD_isError(compressed_size)) {
+      return ray::Status::Invalid(std::string("zstd compression failed: ") +
+                                  ZSTD_getErrorName(compressed_size));
+    }
+    compressed->resize(compressed_size);
+    return ray::Status::OK();
+  }
+#endif
+  default:
+    return ray::Status::Invalid(std::string("Unsupported compression codec ") +
+                                std::to_string(static_cast<int>(codec)));
+  }
+}
+
+ray::Status Decompress(CompressionCodec codec, const uint8_t *data, uint64_t size,
+                       uint8_t *out, uint64_t out_size) {
+  switch (codec) {
+#ifdef RAY_WITH_LZ4
+  case CompressionCodec::CompressionCodec_LZ4: {
+    if (size > static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE) ||
+        out_size > static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE)) {
+      return ray::Status::IOError("Data is too large for LZ4");
+    }
+    int decompressed_size = LZ4_decompress_safe(
+        reinterpret_cast<const char *>(data), reinterpret_cast<char *>(out),
+        static_cast<int>(size), static_cast<int>(out_size));
+    if (decompressed_size < 0 || static_cast<uint64_t>(decompressed_size) != out_size) {
+      return ray::Status::IOError("Corrupt LZ4 data");
+    }
+    return ray::Status::OK();
+  }
+#endif
+#ifdef RAY_WITH_ZSTD
+  case CompressionCodec::CompressionCodec_ZSTD: {
+    size_t decompressed_size = ZSTD_decompress(out, out_size, data, size);
+    if (ZSTD_isError(decompressed_size) || decompressed_size != out_size) {
+      return ray::Status::IOError("Corrupt zstd data");
+    }
+    return ray::Status::OK();
+  }
+#endif
+  default:
+    return ray::Status::IOError(std::string("Unsupported compression codec ") +
+                                std::to_string(static_cast<int>(codec)));
+  }
+}
+
+}  // namespace ray
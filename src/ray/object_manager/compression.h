@@ -0,0 +1,55 @@
+#ifndef RAY_OBJECT_MANAGER_COMPRESSION_H
+#define RAY_OBJECT_MANAGER_COMPRESSION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ray/object_manager/format/object_manager_generated.h"
+#include "ray/status.h"
+
+namespace ray {
+
+using CompressionCodec = object_manager::protocol::CompressionCodec;
+
+/// Get the codecs that chunks can be compressed and decompressed with. LZ4 and
+/// zstd are only available if Ray was built with RAY_WITH_LZ4 and
+/// RAY_WITH_ZSTD respectively.
+///
+/// \return The supported codecs, not including CompressionCodec_None.
+std::vector<CompressionCodec> SupportedCompressionCodecs();
+
+/// Guess whether compressing some data with a codec is worth the time, by
+/// compressing a few samples spread across the data.
+///
+/// \param codec The codec.
+/// \param data The data.
+/// \param size The size of the data in bytes.
+/// \return Whether the samples compress well.
+bool ShouldCompress(CompressionCodec codec, const uint8_t *data, uint64_t size);
+
+/// Compress data.
+///
+/// \param codec The codec. This must be a supported codec.
+/// \param data The data.
+/// \param size The size of the data in bytes.
+/// \param compressed The buffer to write the compressed data to. It is resized
+/// to the compressed size, and its capacity is reused across calls.
+/// \return Status::Invalid if the codec cannot compress the data.
+ray::Status Compress(CompressionCodec codec, const uint8_t *data, uint64_t size,
+                     std::vector<uint8_t> *compressed);
+
+/// Decompress data into a buffer of the exact decompressed size.
+///
+/// \param codec The codec that the data was compressed with.
+/// \param data The compressed data.
+/// \param size The size of the compressed data in bytes.
+/// \param out The buffer to decompress into.
+/// \param out_size The size of the decompressed data in bytes.
+/// \return Status::IOError if the codec is not supported, or if the data is
+/// corrupt or does not decompress to exactly out_size bytes.
+ray::Status Decompress(CompressionCodec codec, const uint8_t *data, uint64_t size,
+                       uint8_t *out, uint64_t out_size);
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_COMPRESSION_H
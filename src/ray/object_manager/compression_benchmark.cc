@@ -0,0 +1,243 @@
+// Measure how compressing object manager chunks affects the transfer rate over
+// a link of limited bandwidth.
+//
+// Usage: compression_benchmark [megabits_per_second] [chunk_size_bytes]
+//
+// A sender thread writes 256MiB of chunks over a loopback socket pair to a
+// receiver thread, throttled to the given bandwidth (10000, about 10GbE, by
+// default). Like the object manager, the sender compresses each chunk that is
+// large enough and whose samples compress well, and the receiver decompresses
+// it straight into its destination buffer. For sparse arrays, text and random
+// bytes, this reports the rate at which uncompressed data arrives for each
+// codec that Ray was built with, next to the compression ratio. Random bytes
+// show the cost of the sampling heuristic, since they are sent uncompressed.
+// A single thread compresses here, while the object manager compresses on
+// each of its send threads, so on fast links the rates here are a lower bound.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ray/object_manager/compression.h"
+
+namespace ray {
+
+namespace {
+
+constexpr uint64_t kTotalBytes = 256 * 1024 * 1024;
+
+/// The header that precedes each chunk on the socket.
+struct ChunkHeader {
+  CompressionCodec codec;
+  uint64_t size;
+};
+
+/// A float64 array that is mostly zeros.
+std::vector<uint8_t> MakeSparseData(uint64_t size) {
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> values(0, 1);
+  std::vector<double> array(size / sizeof(double), 0);
+  for (auto &value : array) {
+    if (values(generator) < 0.05) {
+      value = values(generator);
+    }
+  }
+  std::vector<uint8_t> data(size, 0);
+  memcpy(data.data(), array.data(), array.size() * sizeof(double));
+  return data;
+}
+
+/// Text made of words drawn from a small vocabulary.
+std::vector<uint8_t> MakeTextData(uint64_t size) {
+  const std::vector<std::string> words = {"object", "manager", "chunk", "plasma",
+                                          "raylet", "task",    "actor", "push",
+                                          "pull",   "store",   "seal",  "buffer"};
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<size_t> index(0, words.size() - 1);
+  std::vector<uint8_t> data;
+  data.reserve(size);
+  while (data.size() < size) {
+    const std::string &word = words[index(generator)];
+    data.insert(data.end(), word.begin(), word.end());
+    data.push_back(' ');
+  }
+  data.resize(size);
+  return data;
+}
+
+/// Random bytes, which do not compress.
+std::vector<uint8_t> MakeRandomData(uint64_t size) {
+  std::mt19937 generator(0);
+  std::vector<uint8_t> data(size);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(generator());
+  }
+  return data;
+}
+
+void WriteAll(int fd, const uint8_t *data, uint64_t size) {
+  while (size > 0) {
+    ssize_t num_written = write(fd, data, size);
+    if (num_written <= 0) {
+      std::abort();
+    }
+    data += num_written;
+    size -= num_written;
+  }
+}
+
+void ReadAll(int fd, uint8_t *data, uint64_t size) {
+  while (size > 0) {
+    ssize_t num_read = read(fd, data, size);
+    if (num_read <= 0) {
+      std::abort();
+    }
+    data += num_read;
+    size -= num_read;
+  }
+}
+
+/// Write data no faster than the given rate, in small enough slices that the
+/// rate holds over short intervals too.
+class ThrottledWriter {
+ public:
+  ThrottledWriter(int fd, double bytes_per_second)
+      : fd_(fd),
+        bytes_per_second_(bytes_per_second),
+        start_(std::chrono::steady_clock::now()),
+        bytes_written_(0) {}
+
+  void Write(const uint8_t *data, uint64_t size) {
+    constexpr uint64_t kSliceSize = 64 * 1024;
+    while (size > 0) {
+      uint64_t slice = std::min(size, kSliceSize);
+      const std::chrono::duration<double> elapsed(bytes_written_ / bytes_per_second_);
+      std::this_thread::sleep_until(
+          start_ +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(elapsed));
+      WriteAll(fd_, data, slice);
+      bytes_written_ += slice;
+      data += slice;
+      size -= slice;
+    }
+  }
+
+  uint64_t BytesWritten() const { return bytes_written_; }
+
+ private:
+  int fd_;
+  double bytes_per_second_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t bytes_written_;
+};
+
+struct Result {
+  /// The rate at which uncompressed data arrived, in megabytes per second.
+  double megabytes_per_second;
+  /// The uncompressed size divided by the size that was sent.
+  double ratio;
+};
+
+/// Send kTotalBytes of chunks with a codec, and receive them on another thread.
+Result BenchmarkTransfer(const std::vector<uint8_t> &chunk, CompressionCodec codec,
+                         double bytes_per_second) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::abort();
+  }
+  const uint64_t num_chunks = kTotalBytes / chunk.size();
+  std::thread receiver([&chunk, num_chunks, fds]() {
+    std::vector<uint8_t> destination(chunk.size());
+    std::vector<uint8_t> compressed;
+    for (uint64_t i = 0; i < num_chunks; i++) {
+      ChunkHeader header;
+      ReadAll(fds[1], reinterpret_cast<uint8_t *>(&header), sizeof(header));
+      if (header.codec == CompressionCodec::CompressionCodec_None) {
+        ReadAll(fds[1], destination.data(), header.size);
+        continue;
+      }
+      compressed.resize(header.size);
+      ReadAll(fds[1], compressed.data(), compressed.size());
+      if (!Decompress(header.codec, compressed.data(), compressed.size(),
+                      destination.data(), destination.size())
+               .ok()) {
+        std::abort();
+      }
+    }
+    if (destination != chunk) {
+      std::abort();
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  ThrottledWriter writer(fds[0], bytes_per_second);
+  std::vector<uint8_t> compressed;
+  for (uint64_t i = 0; i < num_chunks; i++) {
+    ChunkHeader header = {CompressionCodec::CompressionCodec_None, chunk.size()};
+    const uint8_t *data = chunk.data();
+    if (codec != CompressionCodec::CompressionCodec_None &&
+        ShouldCompress(codec, chunk.data(), chunk.size()) &&
+        Compress(codec, chunk.data(), chunk.size(), &compressed).ok() &&
+        compressed.size() < chunk.size()) {
+      header = {codec, compressed.size()};
+      data = compressed.data();
+    }
+    writer.Write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+    writer.Write(data, header.size);
+  }
+  receiver.join();
+  auto end = std::chrono::steady_clock::now();
+  close(fds[0]);
+  close(fds[1]);
+
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  return {num_chunks * chunk.size() / seconds / 1e6,
+          static_cast<double>(num_chunks * chunk.size()) / writer.BytesWritten()};
+}
+
+}  // namespace
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  double megabits_per_second = argc > 1 ? std::strtod(argv[1], nullptr) : 10000;
+  uint64_t chunk_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8 * 1024 * 1024;
+  if (megabits_per_second <= 0 || chunk_size == 0 || chunk_size > ray::kTotalBytes) {
+    fprintf(stderr, "Usage: %s [megabits_per_second] [chunk_size_bytes]\n", argv[0]);
+    return 1;
+  }
+  const double bytes_per_second = megabits_per_second * 1e6 / 8;
+
+  std::vector<std::pair<std::string, ray::CompressionCodec>> codecs = {
+      {"none", ray::CompressionCodec::CompressionCodec_None}};
+  for (auto codec : ray::SupportedCompressionCodecs()) {
+    codecs.emplace_back(ray::object_manager::protocol::EnumNameCompressionCodec(codec),
+                        codec);
+  }
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> chunks = {
+      {"sparse", ray::MakeSparseData(chunk_size)},
+      {"text", ray::MakeTextData(chunk_size)},
+      {"random", ray::MakeRandomData(chunk_size)}};
+
+  printf("%.0f Mbit/s, %lu byte chunks\n", megabits_per_second,
+         static_cast<unsigned long>(chunk_size));
+  printf("%10s %10s %15s %10s\n", "data", "codec", "rate (MB/s)", "ratio");
+  for (const auto &chunk : chunks) {
+    for (const auto &codec : codecs) {
+      auto result = ray::BenchmarkTransfer(chunk.second, codec.second, bytes_per_second);
+      printf("%10s %10s %15.1f %10.2f\n", chunk.first.c_str(), codec.first.c_str(),
+             result.megabytes_per_second, result.ratio);
+    }
+  }
+  return 0;
+}
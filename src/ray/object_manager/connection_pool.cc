@@ -62,6 +62,17 @@ ray::Status ConnectionPool::ReleaseSender(ConnectionType type,
   return ray::Status::OK();
 }
 
+ray::Status ConnectionPool::RemoveSender(ConnectionType type,
+                                         std::shared_ptr<SenderConnection> conn) {
+  std::unique_lock<std::mutex> guard(connection_mutex);
+  // The connection is borrowed, so it is only in the map of all connections.
+  SenderMapType &conn_map = (type == ConnectionType::MESSAGE)
+                                ? message_send_connections_
+                                : transfer_send_connections_;
+  Remove(conn_map, conn->GetClientID(), conn);
+  return ray::Status::OK();
+}
+
 void ConnectionPool::Add(ReceiverMapType &conn_map, const ClientID &client_id,
                          std::shared_ptr<TcpClientConnection> conn) {
   conn_map[client_id].push_back(std::move(conn));
@@ -87,6 +98,19 @@ void ConnectionPool::Remove(ReceiverMapType &conn_map, const ClientID &client_id
   connections.erase(connections.begin() + pos);
 }
 
+void ConnectionPool::Remove(SenderMapType &conn_map, const ClientID &client_id,
+                            std::shared_ptr<SenderConnection> &conn) {
+  auto it = conn_map.find(client_id);
+  if (it == conn_map.end()) {
+    return;
+  }
+  auto &connections = it->second;
+  auto conn_it = std::find(connections.begin(), connections.end(), conn);
+  if (conn_it != connections.end()) {
+    connections.erase(conn_it);
+  }
+}
+
 uint64_t ConnectionPool::Count(SenderMapType &conn_map, const ClientID &client_id) {
   auto it = conn_map.find(client_id);
   if (it == conn_map.end()) {
@@ -108,6 +108,10 @@ class ConnectionPool {
   void Remove(ReceiverMapType &conn_map, const ClientID &client_id,
               std::shared_ptr<TcpClientConnection> &conn);
 
+  /// Removes the given sender for ClientID from the given map.
+  void Remove(SenderMapType &conn_map, const ClientID &client_id,
+              std::shared_ptr<SenderConnection> &conn);
+
   /// Returns the count of sender connections to ClientID.
   uint64_t Count(SenderMapType &conn_map, const ClientID &client_id);
 
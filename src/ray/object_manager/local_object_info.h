@@ -0,0 +1,24 @@
+#ifndef RAY_OBJECT_MANAGER_LOCAL_OBJECT_INFO_H
+#define RAY_OBJECT_MANAGER_LOCAL_OBJECT_INFO_H
+
+#include <cstdint>
+
+#include "ray/id.h"
+
+namespace ray {
+
+/// Information about an object that was sealed in the local object store. This
+/// is read straight out of a store notification, without unpacking the rest of
+/// the notification.
+struct LocalObjectInfo {
+  /// The ID of the object.
+  ObjectID object_id;
+  /// The size of the object's data in bytes.
+  int64_t data_size;
+  /// The size of the object's metadata in bytes.
+  int64_t metadata_size;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_LOCAL_OBJECT_INFO_H
@@ -21,6 +21,15 @@ ObjectBufferPool::~ObjectBufferPool() {
   }
   RAY_CHECK(get_buffer_state_.empty());
   RAY_CHECK(create_buffer_state_.empty());
+  RAY_CHECK(pinned_objects_.empty());
+  ReadyCallbacks ready;
+  while (!range_requests_.empty()) {
+    FailRangeCallbacks(range_requests_.begin()->first,
+                       ray::Status::IOError("Object buffer pool was destroyed."), &ready);
+  }
+  for (const auto &callback : ready) {
+    callback();
+  }
   ARROW_CHECK_OK(store_client_.Disconnect());
 }
 
@@ -107,9 +116,15 @@ std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> ObjectBufferPool::Cr
     uint64_t num_chunks = GetNumChunks(data_size);
     create_buffer_state_.emplace(
         std::piecewise_construct, std::forward_as_tuple(object_id),
-        std::forward_as_tuple(BuildChunks(object_id, mutable_data, data_size)));
+        std::forward_as_tuple(BuildChunks(object_id, mutable_data, data_size),
+                              data_size, metadata_size));
     RAY_CHECK(create_buffer_state_[object_id].chunk_info.size() == num_chunks);
   }
+  if (create_buffer_state_[object_id].canceled) {
+    // The object is being discarded, so nothing more may be written to it.
+    return std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status>(
+        errored_chunk_, ray::Status::IOError("Object create was canceled."));
+  }
   if (create_buffer_state_[object_id].chunk_state[chunk_index] !=
       CreateChunkState::AVAILABLE) {
     // There can be only one reference to this chunk at any given time.
@@ -128,6 +143,10 @@ void ObjectBufferPool::AbortCreateChunk(const ObjectID &object_id,
   RAY_CHECK(create_buffer_state_[object_id].chunk_state[chunk_index] ==
             CreateChunkState::REFERENCED);
   create_buffer_state_[object_id].chunk_state[chunk_index] = CreateChunkState::AVAILABLE;
+  if (create_buffer_state_[object_id].canceled) {
+    MaybeAbortCanceledCreate(object_id);
+    return;
+  }
   if (create_buffer_state_[object_id].num_seals_remaining ==
       create_buffer_state_[object_id].chunk_state.size()) {
     // If chunk_state is AVAILABLE at every chunk_index and
@@ -137,6 +156,8 @@ void ObjectBufferPool::AbortCreateChunk(const ObjectID &object_id,
     for (auto chunk_state : create_buffer_state_[object_id].chunk_state) {
       abort &= chunk_state == CreateChunkState::AVAILABLE;
     }
+    // Readers may hold references to an empty range at the start of the buffer.
+    abort &= create_buffer_state_[object_id].num_pins == 0;
     if (abort) {
       AbortCreate(object_id);
     }
@@ -144,19 +165,108 @@ void ObjectBufferPool::AbortCreateChunk(const ObjectID &object_id,
 }
 
 void ObjectBufferPool::SealChunk(const ObjectID &object_id, const uint64_t chunk_index) {
-  std::lock_guard<std::mutex> lock(pool_mutex_);
+  ReadyCallbacks ready;
+  std::unique_lock<std::mutex> lock(pool_mutex_);
   RAY_CHECK(create_buffer_state_[object_id].chunk_state[chunk_index] ==
             CreateChunkState::REFERENCED);
+  if (create_buffer_state_[object_id].canceled) {
+    // The chunk was written, but the object is being discarded.
+    create_buffer_state_[object_id].chunk_state[chunk_index] =
+        CreateChunkState::AVAILABLE;
+    MaybeAbortCanceledCreate(object_id);
+    return;
+  }
   create_buffer_state_[object_id].chunk_state[chunk_index] = CreateChunkState::SEALED;
   create_buffer_state_[object_id].num_seals_remaining--;
   RAY_LOG(DEBUG) << "SealChunk" << object_id << " "
                  << create_buffer_state_[object_id].num_seals_remaining;
-  if (create_buffer_state_[object_id].num_seals_remaining == 0) {
+  // Readers can read the chunks up to the first one that has not arrived. This
+  // is done before the buffer is sealed and released below.
+  CreateBufferState &buffer_state = create_buffer_state_[object_id];
+  while (buffer_state.num_prefix_chunks_sealed < buffer_state.chunk_state.size() &&
+         buffer_state.chunk_state[buffer_state.num_prefix_chunks_sealed] ==
+             CreateChunkState::SEALED) {
+    buffer_state.num_prefix_chunks_sealed++;
+  }
+  InvokeReceivedRangeCallbacks(object_id, &ready);
+  if (buffer_state.num_seals_remaining == 0) {
     const plasma::ObjectID plasma_id = ObjectID(object_id).to_plasma_id();
     ARROW_CHECK_OK(store_client_.Seal(plasma_id));
-    ARROW_CHECK_OK(store_client_.Release(plasma_id));
+    if (buffer_state.num_pins > 0) {
+      // The create reference now pins the sealed object for its readers.
+      pinned_objects_[object_id] = buffer_state.num_pins;
+    } else {
+      ARROW_CHECK_OK(store_client_.Release(plasma_id));
+    }
     create_buffer_state_.erase(object_id);
   }
+  lock.unlock();
+  for (const auto &callback : ready) {
+    callback();
+  }
+}
+
+bool ObjectBufferPool::GetCreateProgress(const ObjectID &object_id,
+                                         uint64_t *num_chunks_sealed,
+                                         std::vector<uint64_t> *missing_chunks) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it == create_buffer_state_.end()) {
+    return false;
+  }
+  const CreateBufferState &buffer_state = it->second;
+  *num_chunks_sealed = buffer_state.chunk_state.size() - buffer_state.num_seals_remaining;
+  missing_chunks->clear();
+  for (uint64_t chunk_index = 0; chunk_index < buffer_state.chunk_state.size();
+       chunk_index++) {
+    if (buffer_state.chunk_state[chunk_index] == CreateChunkState::AVAILABLE) {
+      missing_chunks->push_back(chunk_index);
+    }
+  }
+  return true;
+}
+
+bool ObjectBufferPool::GetCreateSizes(const ObjectID &object_id, uint64_t *data_size,
+                                      uint64_t *metadata_size) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it == create_buffer_state_.end() || it->second.canceled) {
+    return false;
+  }
+  *data_size = it->second.data_size;
+  *metadata_size = it->second.metadata_size;
+  return true;
+}
+
+void ObjectBufferPool::CancelCreate(const ObjectID &object_id) {
+  ReadyCallbacks ready;
+  std::unique_lock<std::mutex> lock(pool_mutex_);
+  FailRangeCallbacks(object_id, ray::Status::IOError("Object create was canceled."),
+                     &ready);
+  auto it = create_buffer_state_.find(object_id);
+  if (it != create_buffer_state_.end()) {
+    it->second.canceled = true;
+    MaybeAbortCanceledCreate(object_id);
+  }
+  lock.unlock();
+  for (const auto &callback : ready) {
+    callback();
+  }
+}
+
+void ObjectBufferPool::MaybeAbortCanceledCreate(const ObjectID &object_id) {
+  if (create_buffer_state_[object_id].num_pins > 0) {
+    // The create is aborted when readers drop their references to the buffer.
+    return;
+  }
+  for (auto chunk_state : create_buffer_state_[object_id].chunk_state) {
+    if (chunk_state == CreateChunkState::REFERENCED) {
+      // A chunk is still being written to. The create is aborted when that
+      // chunk is sealed or aborted.
+      return;
+    }
+  }
+  AbortCreate(object_id);
 }
 
 void ObjectBufferPool::AbortCreate(const ObjectID &object_id) {
@@ -166,6 +276,157 @@ void ObjectBufferPool::AbortCreate(const ObjectID &object_id) {
   create_buffer_state_.erase(object_id);
 }
 
+void ObjectBufferPool::WaitForRange(const ObjectID &object_id, uint64_t offset,
+                                    uint64_t length, const RangeCallback &callback) {
+  ReadyCallbacks ready;
+  std::unique_lock<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it != create_buffer_state_.end() && it->second.canceled) {
+    lock.unlock();
+    callback(nullptr, ray::Status::IOError("Object create was canceled."));
+    return;
+  }
+  range_requests_[object_id].push_back({offset, length, callback});
+  if (it != create_buffer_state_.end()) {
+    InvokeReceivedRangeCallbacks(object_id, &ready);
+  } else {
+    // The object may have been sealed before the reader asked for it.
+    InvokeLocalRangeCallbacks(object_id, &ready);
+  }
+  lock.unlock();
+  for (const auto &ready_callback : ready) {
+    ready_callback();
+  }
+}
+
+void ObjectBufferPool::HandleObjectLocal(const ObjectID &object_id) {
+  ReadyCallbacks ready;
+  std::unique_lock<std::mutex> lock(pool_mutex_);
+  if (range_requests_.count(object_id) != 0 &&
+      create_buffer_state_.count(object_id) == 0) {
+    InvokeLocalRangeCallbacks(object_id, &ready);
+  }
+  lock.unlock();
+  for (const auto &callback : ready) {
+    callback();
+  }
+}
+
+void ObjectBufferPool::Unpin(const ObjectID &object_id) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto create_it = create_buffer_state_.find(object_id);
+  if (create_it != create_buffer_state_.end()) {
+    RAY_CHECK(create_it->second.num_pins > 0);
+    create_it->second.num_pins--;
+    if (create_it->second.canceled) {
+      MaybeAbortCanceledCreate(object_id);
+    }
+    return;
+  }
+  auto it = pinned_objects_.find(object_id);
+  RAY_CHECK(it != pinned_objects_.end());
+  it->second--;
+  if (it->second == 0) {
+    ARROW_CHECK_OK(store_client_.Release(ObjectID(object_id).to_plasma_id()));
+    pinned_objects_.erase(it);
+  }
+}
+
+uint64_t ObjectBufferPool::InvokeRangeCallbacks(const ObjectID &object_id,
+                                                const uint8_t *data,
+                                                uint64_t readable_size,
+                                                uint64_t data_size,
+                                                ReadyCallbacks *ready) {
+  auto it = range_requests_.find(object_id);
+  if (it == range_requests_.end()) {
+    return 0;
+  }
+  uint64_t num_pins = 0;
+  std::vector<RangeRequest> waiting;
+  for (auto &request : it->second) {
+    if (request.offset > data_size || request.length > data_size - request.offset) {
+      RangeCallback callback = std::move(request.callback);
+      ready->push_back([callback]() {
+        callback(nullptr, ray::Status::Invalid("Range ends past the end of the object."));
+      });
+    } else if (request.offset + request.length <= readable_size) {
+      // The reference unpins the buffer when the reader drops its last copy.
+      std::shared_ptr<const uint8_t> range(data + request.offset,
+                                           [this, object_id](const uint8_t *) {
+                                             Unpin(object_id);
+                                           });
+      num_pins++;
+      RangeCallback callback = std::move(request.callback);
+      ready->push_back([callback, range]() { callback(range, ray::Status::OK()); });
+    } else {
+      waiting.push_back(std::move(request));
+    }
+  }
+  if (waiting.empty()) {
+    range_requests_.erase(it);
+  } else {
+    it->second = std::move(waiting);
+  }
+  return num_pins;
+}
+
+void ObjectBufferPool::InvokeReceivedRangeCallbacks(const ObjectID &object_id,
+                                                    ReadyCallbacks *ready) {
+  if (range_requests_.count(object_id) == 0) {
+    return;
+  }
+  CreateBufferState &buffer_state = create_buffer_state_[object_id];
+  const std::vector<ChunkInfo> &chunks = buffer_state.chunk_info;
+  uint8_t *data = chunks.front().data;
+  uint64_t data_size = chunks.back().data + chunks.back().buffer_length - data;
+  uint64_t readable_size = 0;
+  if (buffer_state.num_prefix_chunks_sealed > 0) {
+    const ChunkInfo &last_sealed = chunks[buffer_state.num_prefix_chunks_sealed - 1];
+    readable_size = last_sealed.data + last_sealed.buffer_length - data;
+  }
+  buffer_state.num_pins +=
+      InvokeRangeCallbacks(object_id, data, readable_size, data_size, ready);
+}
+
+void ObjectBufferPool::InvokeLocalRangeCallbacks(const ObjectID &object_id,
+                                                 ReadyCallbacks *ready) {
+  plasma::ObjectBuffer object_buffer;
+  plasma::ObjectID plasma_id = ObjectID(object_id).to_plasma_id();
+  ARROW_CHECK_OK(store_client_.Get(&plasma_id, 1, 0, &object_buffer));
+  if (object_buffer.data == nullptr) {
+    return;
+  }
+  uint64_t data_size =
+      static_cast<uint64_t>(object_buffer.data->size() + object_buffer.metadata->size());
+  uint64_t num_pins = InvokeRangeCallbacks(object_id, object_buffer.data->data(),
+                                           data_size, data_size, ready);
+  uint64_t &pins = pinned_objects_[object_id];
+  if (pins == 0 && num_pins > 0) {
+    // Keep the reference from the Get to pin the object for its readers.
+    pins = num_pins;
+    return;
+  }
+  pins += num_pins;
+  if (pins == 0) {
+    pinned_objects_.erase(object_id);
+  }
+  ARROW_CHECK_OK(store_client_.Release(plasma_id));
+}
+
+void ObjectBufferPool::FailRangeCallbacks(const ObjectID &object_id,
+                                          const ray::Status &status,
+                                          ReadyCallbacks *ready) {
+  auto it = range_requests_.find(object_id);
+  if (it == range_requests_.end()) {
+    return;
+  }
+  for (const auto &request : it->second) {
+    RangeCallback callback = request.callback;
+    ready->push_back([callback, status]() { callback(nullptr, status); });
+  }
+  range_requests_.erase(it);
+}
+
 std::vector<ObjectBufferPool::ChunkInfo> ObjectBufferPool::BuildChunks(
     const ObjectID &object_id, uint8_t *data, uint64_t data_size) {
   uint64_t space_remaining = data_size;
@@ -1,6 +1,7 @@
 #ifndef RAY_OBJECT_MANAGER_OBJECT_BUFFER_POOL_H
 #define RAY_OBJECT_MANAGER_OBJECT_BUFFER_POOL_H
 
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -36,6 +37,14 @@ class ObjectBufferPool {
     uint64_t buffer_length;
   };
 
+  /// Invoked with a reference to the start of a byte range of an object once the
+  /// range can be read, or with a null reference and an error status if it cannot.
+  /// The reference pins the object's buffer: the range stays valid, and the object
+  /// stays in the store, until every copy of the reference is dropped. References
+  /// must be dropped before the pool is destroyed.
+  using RangeCallback =
+      std::function<void(std::shared_ptr<const uint8_t> data, const ray::Status &)>;
+
   /// Constructor.
   ///
   /// \param store_socket_name The socket name of the store to which plasma clients
@@ -124,6 +133,59 @@ class ObjectBufferPool {
   /// \param chunk_index The index of the chunk.
   void SealChunk(const ObjectID &object_id, uint64_t chunk_index);
 
+  /// Get the progress of the create operation associated with an object.
+  ///
+  /// \param[in] object_id The ObjectID.
+  /// \param[out] num_chunks_sealed The number of chunks that were sealed.
+  /// \param[out] missing_chunks The indices of the chunks that were neither sealed
+  /// nor are being written to.
+  /// \return Whether a create operation is in progress for the object. If not,
+  /// none of its chunks were received, or all of them were and the object is sealed.
+  bool GetCreateProgress(const ObjectID &object_id, uint64_t *num_chunks_sealed,
+                         std::vector<uint64_t> *missing_chunks);
+
+  /// Get the sizes of an object that is being received.
+  ///
+  /// \param[in] object_id The ObjectID.
+  /// \param[out] data_size The sum of the object size and metadata size.
+  /// \param[out] metadata_size The size of the metadata.
+  /// \return Whether a create operation that was not canceled is in progress for the
+  /// object.
+  bool GetCreateSizes(const ObjectID &object_id, uint64_t *data_size,
+                      uint64_t *metadata_size);
+
+  /// Cancel the create operation associated with an object, releasing the partially
+  /// written buffer. Chunks that are being written to when this is invoked are
+  /// aborted when they are sealed or aborted, and the buffer is released once
+  /// readers drop their references to its ranges. No new chunks can be created for
+  /// the object until then. This is a no-op if no create operation is in progress.
+  ///
+  /// \param object_id The ObjectID.
+  void CancelCreate(const ObjectID &object_id);
+
+  /// Wait until a byte range of an object can be read. The range of an object that
+  /// is being received can be read once every chunk up to its end is sealed, before
+  /// the rest of the object arrives. The callback is invoked right away if the range
+  /// can already be read or if the object is sealed in the store, and otherwise from
+  /// the thread that seals the chunk that completes the range. The callback is
+  /// invoked after the pool is unlocked, so it may call into the pool.
+  ///
+  /// \param object_id The ObjectID.
+  /// \param offset The offset of the range in the object's buffer, which holds its
+  /// data followed by its metadata.
+  /// \param length The length of the range in bytes.
+  /// \param callback Invoked with the range's data, with an Invalid status if the
+  /// range ends past the end of the object, or with an IOError if the object's create
+  /// operation is canceled first.
+  void WaitForRange(const ObjectID &object_id, uint64_t offset, uint64_t length,
+                    const RangeCallback &callback);
+
+  /// Invoke the range callbacks of an object that was sealed in the store by
+  /// another client, rather than received through this pool.
+  ///
+  /// \param object_id The ObjectID.
+  void HandleObjectLocal(const ObjectID &object_id);
+
  private:
   /// Abort the create operation associated with an object. This destroys the buffer
   /// state, including create operations in progress for all chunks of the object.
@@ -132,11 +194,43 @@ class ObjectBufferPool {
   /// Abort the get operation associated with an object.
   void AbortGet(const ObjectID &object_id);
 
+  /// Abort the create operation associated with a canceled object once none of its
+  /// chunks are being written to and no reader references its buffer.
+  void MaybeAbortCanceledCreate(const ObjectID &object_id);
+
+  /// Drop a reference to a range of an object that was handed to a reader.
+  void Unpin(const ObjectID &object_id);
+
+  /// Callbacks that are ready to be invoked once the pool is unlocked.
+  using ReadyCallbacks = std::vector<std::function<void()>>;
+
   /// Splits an object into ceil(data_size/chunk_size) chunks, which will
   /// either be read or written to in parallel.
   std::vector<ChunkInfo> BuildChunks(const ObjectID &object_id, uint8_t *data,
                                      uint64_t data_size);
 
+  /// Queue the callbacks of the ranges of an object that end within its first
+  /// readable_size bytes, and fail those that end past data_size. The other ranges
+  /// keep waiting.
+  ///
+  /// \return The number of references to the object's buffer that were handed out,
+  /// which the caller must pin the buffer for.
+  uint64_t InvokeRangeCallbacks(const ObjectID &object_id, const uint8_t *data,
+                                uint64_t readable_size, uint64_t data_size,
+                                ReadyCallbacks *ready);
+
+  /// Queue the callbacks of the ranges of an object that is being received that
+  /// lie within the sealed chunks at the start of its buffer.
+  void InvokeReceivedRangeCallbacks(const ObjectID &object_id, ReadyCallbacks *ready);
+
+  /// Queue the callbacks of the ranges of an object if it is sealed in the store.
+  void InvokeLocalRangeCallbacks(const ObjectID &object_id, ReadyCallbacks *ready);
+
+  /// Queue the callbacks of all the ranges of an object to fail with the given
+  /// status.
+  void FailRangeCallbacks(const ObjectID &object_id, const ray::Status &status,
+                          ReadyCallbacks *ready);
+
   /// Holds the state of a get buffer.
   struct GetBufferState {
     GetBufferState() {}
@@ -156,10 +250,13 @@ class ObjectBufferPool {
   /// Holds the state of a create buffer.
   struct CreateBufferState {
     CreateBufferState() {}
-    CreateBufferState(std::vector<ChunkInfo> chunk_info)
+    CreateBufferState(std::vector<ChunkInfo> chunk_info, uint64_t data_size,
+                      uint64_t metadata_size)
         : chunk_info(chunk_info),
           chunk_state(chunk_info.size(), CreateChunkState::AVAILABLE),
-          num_seals_remaining(chunk_info.size()) {}
+          num_seals_remaining(chunk_info.size()),
+          data_size(data_size),
+          metadata_size(metadata_size) {}
     /// A vector maintaining information about the chunks which comprise
     /// an object.
     std::vector<ChunkInfo> chunk_info;
@@ -168,6 +265,26 @@ class ObjectBufferPool {
     std::vector<CreateChunkState> chunk_state;
     /// The number of chunks left to seal before the buffer is sealed.
     uint64_t num_seals_remaining;
+    /// The sum of the object size and metadata size.
+    uint64_t data_size;
+    /// The size of the metadata.
+    uint64_t metadata_size;
+    /// Whether the create operation was canceled. The buffer is aborted once no
+    /// chunk is referenced.
+    bool canceled = false;
+    /// The number of chunks at the start of the buffer that are sealed. The bytes
+    /// in these chunks can be read before the buffer is sealed.
+    uint64_t num_prefix_chunks_sealed = 0;
+    /// The number of references to ranges of the buffer that readers hold. The
+    /// buffer is not released while any are held.
+    uint64_t num_pins = 0;
+  };
+
+  /// A byte range of an object that a reader is waiting for.
+  struct RangeRequest {
+    uint64_t offset;
+    uint64_t length;
+    RangeCallback callback;
   };
 
   /// Returned when GetChunk or CreateChunk fails.
@@ -182,6 +299,11 @@ class ObjectBufferPool {
   std::unordered_map<ray::ObjectID, GetBufferState> get_buffer_state_;
   /// The state of a buffer that's currently being used.
   std::unordered_map<ray::ObjectID, CreateBufferState> create_buffer_state_;
+  /// The byte ranges that readers are waiting for, by object.
+  std::unordered_map<ray::ObjectID, std::vector<RangeRequest>> range_requests_;
+  /// The number of references to ranges that readers hold, by sealed object. The
+  /// pool holds one store reference to each of these objects.
+  std::unordered_map<ray::ObjectID, uint64_t> pinned_objects_;
 
   /// Plasma client pool.
   plasma::PlasmaClient store_client_;
@@ -22,6 +22,7 @@ void ObjectDirectory::RegisterBackend() {
       ClientID client_id = ClientID::from_binary(object_table_data.manager);
       if (!object_table_data.is_eviction) {
         client_id_set.insert(client_id);
+        entry->second.object_size = object_table_data.object_size;
       } else {
         client_id_set.erase(client_id);
       }
@@ -30,7 +31,7 @@ void ObjectDirectory::RegisterBackend() {
       // Only call the callback if we have object locations.
       std::vector<ClientID> client_id_vec(client_id_set.begin(), client_id_set.end());
       auto callback = entry->second.locations_found_callback;
-      callback(client_id_vec, object_id);
+      callback(client_id_vec, object_id, entry->second.object_size);
     }
   };
   RAY_CHECK_OK(gcs_client_->object_table().Subscribe(
@@ -40,7 +41,7 @@ void ObjectDirectory::RegisterBackend() {
 
 ray::Status ObjectDirectory::ReportObjectAdded(const ObjectID &object_id,
                                                const ClientID &client_id,
-                                               const ObjectInfoT &object_info) {
+                                               const LocalObjectInfo &object_info) {
   // Append the addition entry to the object table.
   JobID job_id = JobID::nil();
   auto data = std::make_shared<ObjectTableDataT>();
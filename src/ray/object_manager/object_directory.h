@@ -9,6 +9,8 @@
 
 #include "ray/gcs/client.h"
 #include "ray/id.h"
+#include "ray/id_map.h"
+#include "ray/object_manager/local_object_info.h"
 #include "ray/status.h"
 
 namespace ray {
@@ -45,16 +47,19 @@ class ObjectDirectoryInterface {
                                      const InfoSuccessCallback &success_cb,
                                      const InfoFailureCallback &fail_cb) = 0;
 
-  /// Callback for object location notifications.
-  using OnLocationsFound = std::function<void(const std::vector<ray::ClientID> &v,
-                                              const ray::ObjectID &object_id)>;
+  /// Callback for object location notifications. The object size is 0 if it
+  /// is not known.
+  using OnLocationsFound =
+      std::function<void(const std::vector<ray::ClientID> &v,
+                         const ray::ObjectID &object_id, uint64_t object_size)>;
 
   /// Subscribe to be notified of locations (ClientID) of the given object.
   /// The callback will be invoked whenever locations are obtained for the
   /// specified object.
   ///
   /// \param object_id The required object's ObjectID.
-  /// \param success_cb Invoked with non-empty list of client ids and object_id.
+  /// \param success_cb Invoked with non-empty list of client ids, object_id and
+  /// the size of the object.
   /// \return Status of whether subscription succeeded.
   virtual ray::Status SubscribeObjectLocations(const ObjectID &object_id,
                                                const OnLocationsFound &callback) = 0;
@@ -73,7 +78,7 @@ class ObjectDirectoryInterface {
   /// \return Status of whether this method succeeded.
   virtual ray::Status ReportObjectAdded(const ObjectID &object_id,
                                         const ClientID &client_id,
-                                        const ObjectInfoT &object_info) = 0;
+                                        const LocalObjectInfo &object_info) = 0;
 
   /// Report objects removed from this client's store to the object directory.
   ///
@@ -101,7 +106,7 @@ class ObjectDirectory : public ObjectDirectoryInterface {
   ray::Status UnsubscribeObjectLocations(const ObjectID &object_id) override;
 
   ray::Status ReportObjectAdded(const ObjectID &object_id, const ClientID &client_id,
-                                const ObjectInfoT &object_info) override;
+                                const LocalObjectInfo &object_info) override;
   ray::Status ReportObjectRemoved(const ObjectID &object_id,
                                   const ClientID &client_id) override;
   /// Ray only (not part of the OD interface).
@@ -114,20 +119,23 @@ class ObjectDirectory : public ObjectDirectoryInterface {
   /// Callbacks associated with a call to GetLocations.
   struct LocationListenerState {
     LocationListenerState(const OnLocationsFound &locations_found_callback)
-        : locations_found_callback(locations_found_callback) {}
+        : locations_found_callback(locations_found_callback), object_size(0) {}
     /// The callback to invoke when object locations are found.
     OnLocationsFound locations_found_callback;
     /// The current set of known locations of this object.
     std::unordered_set<ClientID> client_ids;
+    /// The size of the object, as reported by the nodes that added it, or 0 if
+    /// no node reported it yet.
+    uint64_t object_size;
   };
 
   /// Info about subscribers to object locations.
-  std::unordered_map<ObjectID, LocationListenerState> listeners_;
+  IdMap<LocationListenerState> listeners_;
   /// Reference to the gcs client.
   std::shared_ptr<gcs::AsyncGcsClient> gcs_client_;
   /// Map from object ID to the number of times it's been evicted on this
   /// node before.
-  std::unordered_map<ObjectID, int> object_evictions_;
+  IdMap<int> object_evictions_;
 };
 
 }  // namespace ray
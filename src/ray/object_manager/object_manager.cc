@@ -4,6 +4,25 @@ namespace asio = boost::asio;
 
 namespace object_manager_protocol = ray::object_manager::protocol;
 
+namespace {
+
+/// Return the codec if this build supports it, and CompressionCodec_None
+/// otherwise.
+ray::CompressionCodec SupportedCodecOrNone(ray::CompressionCodec codec) {
+  if (codec == ray::CompressionCodec::CompressionCodec_None) {
+    return codec;
+  }
+  const auto codecs = ray::SupportedCompressionCodecs();
+  if (std::find(codecs.begin(), codecs.end(), codec) == codecs.end()) {
+    RAY_LOG(WARNING) << "Compression codec " << static_cast<int>(codec)
+                     << " is not supported by this build, sending chunks uncompressed.";
+    return ray::CompressionCodec::CompressionCodec_None;
+  }
+  return codec;
+}
+
+}  // namespace
+
 namespace ray {
 
 ObjectManager::ObjectManager(asio::io_service &main_service,
@@ -20,15 +39,25 @@ ObjectManager::ObjectManager(asio::io_service &main_service,
                    /*release_delay=*/2 * config_.max_sends),
       send_work_(send_service_),
       receive_work_(receive_service_),
-      connection_pool_() {
+      connection_pool_(),
+      pull_manager_(config_.max_inflight_pull_bytes, config_.max_pull_attempts),
+      pull_requests_posted_(false),
+      transfer_timer_(main_service),
+      transfer_timer_set_(false),
+      compression_codec_(SupportedCodecOrNone(config_.compression_codec)) {
   RAY_CHECK(config_.max_sends > 0);
   RAY_CHECK(config_.max_receives > 0);
   RAY_CHECK(config_.max_push_retries > 0);
+  RAY_CHECK(config_.max_pull_attempts > 0);
   main_service_ = &main_service;
   store_notification_.SubscribeObjAdded(
-      [this](const ObjectInfoT &object_info) { NotifyDirectoryObjectAdd(object_info); });
+      [this](const std::vector<LocalObjectInfo> &objects) {
+        NotifyDirectoryObjectsAdded(objects);
+      });
   store_notification_.SubscribeObjDeleted(
-      [this](const ObjectID &oid) { NotifyDirectoryObjectDeleted(oid); });
+      [this](const std::vector<ObjectID> &object_ids) {
+        NotifyDirectoryObjectsDeleted(object_ids);
+      });
   StartIOService();
 }
 
@@ -44,16 +73,26 @@ ObjectManager::ObjectManager(asio::io_service &main_service,
                    /*release_delay=*/2 * config_.max_sends),
       send_work_(send_service_),
       receive_work_(receive_service_),
-      connection_pool_() {
+      connection_pool_(),
+      pull_manager_(config_.max_inflight_pull_bytes, config_.max_pull_attempts),
+      pull_requests_posted_(false),
+      transfer_timer_(main_service),
+      transfer_timer_set_(false),
+      compression_codec_(SupportedCodecOrNone(config_.compression_codec)) {
   RAY_CHECK(config_.max_sends > 0);
   RAY_CHECK(config_.max_receives > 0);
   RAY_CHECK(config_.max_push_retries > 0);
+  RAY_CHECK(config_.max_pull_attempts > 0);
   // TODO(hme) Client ID is never set with this constructor.
   main_service_ = &main_service;
   store_notification_.SubscribeObjAdded(
-      [this](const ObjectInfoT &object_info) { NotifyDirectoryObjectAdd(object_info); });
+      [this](const std::vector<LocalObjectInfo> &objects) {
+        NotifyDirectoryObjectsAdded(objects);
+      });
   store_notification_.SubscribeObjDeleted(
-      [this](const ObjectID &oid) { NotifyDirectoryObjectDeleted(oid); });
+      [this](const std::vector<ObjectID> &object_ids) {
+        NotifyDirectoryObjectsDeleted(object_ids);
+      });
   StartIOService();
 }
 
@@ -85,53 +124,170 @@ void ObjectManager::StopIOService() {
   }
 }
 
-void ObjectManager::NotifyDirectoryObjectAdd(const ObjectInfoT &object_info) {
-  ObjectID object_id = ObjectID::from_binary(object_info.object_id);
-  local_objects_[object_id] = object_info;
-  ray::Status status =
-      object_directory_->ReportObjectAdded(object_id, client_id_, object_info);
+void ObjectManager::NotifyDirectoryObjectsAdded(
+    const std::vector<LocalObjectInfo> &objects) {
+  for (const auto &object_info : objects) {
+    const ObjectID &object_id = object_info.object_id;
+    local_objects_[object_id] = object_info;
+    ray::Status status =
+        object_directory_->ReportObjectAdded(object_id, client_id_, object_info);
+    // The object's pull, if any, is done, and its locations are no longer
+    // needed.
+    pull_manager_.HandleObjectLocal(object_id);
+    RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(object_id));
+    if (config_.streaming) {
+      // Readers may be waiting for an object that was put on this node.
+      buffer_pool_.HandleObjectLocal(object_id);
+    }
+  }
+  // The objects' bytes may let other pulls go. Schedule them once for the
+  // whole batch.
+  SchedulePullRequests();
 }
 
-void ObjectManager::NotifyDirectoryObjectDeleted(const ObjectID &object_id) {
-  local_objects_.erase(object_id);
-  ray::Status status = object_directory_->ReportObjectRemoved(object_id, client_id_);
+void ObjectManager::NotifyDirectoryObjectsDeleted(
+    const std::vector<ObjectID> &object_ids) {
+  for (const auto &object_id : object_ids) {
+    local_objects_.erase(object_id);
+    ray::Status status = object_directory_->ReportObjectRemoved(object_id, client_id_);
+  }
 }
 
 ray::Status ObjectManager::SubscribeObjAdded(
-    std::function<void(const ObjectInfoT &)> callback) {
-  store_notification_.SubscribeObjAdded(callback);
+    ObjectStoreNotificationManager::AddHandler callback) {
+  store_notification_.SubscribeObjAdded(std::move(callback));
   return ray::Status::OK();
 }
 
 ray::Status ObjectManager::SubscribeObjDeleted(
-    std::function<void(const ObjectID &)> callback) {
-  store_notification_.SubscribeObjDeleted(callback);
+    ObjectStoreNotificationManager::RemoveHandler callback) {
+  store_notification_.SubscribeObjDeleted(std::move(callback));
   return ray::Status::OK();
 }
 
 ray::Status ObjectManager::Pull(const ObjectID &object_id) {
+  return Pull(object_id, kDefaultPullPriority);
+}
+
+ray::Status ObjectManager::Pull(const ObjectID &object_id, int64_t priority) {
   // Check if object is already local.
   if (local_objects_.count(object_id) != 0) {
     RAY_LOG(ERROR) << object_id << " attempted to pull an object that's already local.";
     return ray::Status::OK();
   }
+  if (!pull_manager_.Pull(object_id, priority)) {
+    // The object is already being pulled.
+    return ray::Status::OK();
+  }
   ray::Status status_code = object_directory_->SubscribeObjectLocations(
-      object_id,
-      [this](const std::vector<ClientID> &client_ids, const ObjectID &object_id) {
-        RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(object_id));
-        GetLocationsSuccess(client_ids, object_id);
+      object_id, [this](const std::vector<ClientID> &client_ids,
+                        const ObjectID &object_id, uint64_t object_size) {
+        GetLocationsSuccess(client_ids, object_id, object_size);
       });
   return status_code;
 }
 
 void ObjectManager::GetLocationsSuccess(const std::vector<ray::ClientID> &client_ids,
-                                        const ray::ObjectID &object_id) {
-  if (local_objects_.count(object_id) == 0) {
+                                        const ray::ObjectID &object_id,
+                                        uint64_t object_size) {
+  if (local_objects_.count(object_id) != 0) {
     // Only pull objects that aren't local.
-    RAY_CHECK(!client_ids.empty());
-    ClientID client_id = client_ids.front();
-    ray::Status status_code = Pull(object_id, client_id);
-    RAY_CHECK_OK(status_code);
+    RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(object_id));
+    return;
+  }
+  // Never pull from this node.
+  std::vector<ClientID> remote_client_ids;
+  for (const auto &client_id : client_ids) {
+    if (!(client_id == client_id_)) {
+      remote_client_ids.push_back(client_id);
+    }
+  }
+  if (remote_client_ids.empty()) {
+    // Keep the subscription, so that the pull is requested once the object
+    // appears on a remote node, or completed once it appears on this one.
+    RAY_LOG(ERROR) << client_id_ << " attempted to pull an object from itself.";
+    return;
+  }
+  RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(object_id));
+  pull_manager_.SetLocations(object_id, remote_client_ids, object_size);
+  SchedulePullRequests();
+}
+
+void ObjectManager::SchedulePullRequests() {
+  if (pull_requests_posted_ || !pull_manager_.HasRequests()) {
+    return;
+  }
+  pull_requests_posted_ = true;
+  main_service_->post([this]() { SendPullRequests(); });
+}
+
+void ObjectManager::SendPullRequests() {
+  pull_requests_posted_ = false;
+  for (const auto &request : pull_manager_.TakeRequests()) {
+    RAY_CHECK_OK(PullEstablishConnection(request.second, request.first));
+  }
+  ScheduleTransferCheck();
+}
+
+void ObjectManager::ScheduleTransferCheck() {
+  if (transfer_timer_set_) {
+    return;
+  }
+  transfer_timer_.expires_from_now(
+      boost::posix_time::milliseconds(config_.chunk_timeout_ms));
+  transfer_timer_.async_wait([this](const boost::system::error_code &error) {
+    if (error == asio::error::operation_aborted) {
+      // The object manager is being destroyed.
+      return;
+    }
+    RAY_CHECK(!error);
+    transfer_timer_set_ = false;
+    CheckTransfers();
+  });
+  transfer_timer_set_ = true;
+}
+
+void ObjectManager::CheckTransfers() {
+  const std::vector<ObjectID> inflight_pulls = pull_manager_.InflightPulls();
+  size_t num_failed = 0;
+  std::vector<uint64_t> missing_chunks;
+  for (const auto &object_id : inflight_pulls) {
+    uint64_t num_chunks_sealed = 0;
+    bool receiving =
+        buffer_pool_.GetCreateProgress(object_id, &num_chunks_sealed, &missing_chunks);
+    ClientID client_id;
+    switch (pull_manager_.CheckProgress(object_id, num_chunks_sealed, &client_id)) {
+    case PullManager::PullCheck::WAIT:
+      break;
+    case PullManager::PullCheck::RETRY:
+      if (!receiving) {
+        // None of the object's chunks are held, so request all of them.
+        RAY_LOG(WARNING) << "Pull of " << object_id << " stalled, requesting it from "
+                         << client_id;
+        RAY_CHECK_OK(PullEstablishConnection({object_id}, client_id));
+      } else if (!missing_chunks.empty()) {
+        // Chunks that are being received are left to their connection, which
+        // aborts them if it fails.
+        RAY_LOG(WARNING) << "Pull of " << object_id << " stalled, requesting "
+                         << missing_chunks.size() << " missing chunks from "
+                         << client_id;
+        RAY_CHECK_OK(ChunkEstablishConnection(object_id, missing_chunks, client_id));
+      }
+      break;
+    case PullManager::PullCheck::FAIL:
+      RAY_LOG(ERROR) << "Failed to pull " << object_id << " after "
+                     << config_.max_pull_attempts << " attempts.";
+      buffer_pool_.CancelCreate(object_id);
+      num_failed++;
+      break;
+    }
+  }
+  if (num_failed > 0) {
+    // The failed pulls released their bytes, which may let other pulls go.
+    SchedulePullRequests();
+  }
+  if (inflight_pulls.size() > num_failed) {
+    ScheduleTransferCheck();
   }
 }
 
@@ -146,12 +302,32 @@ ray::Status ObjectManager::Pull(const ObjectID &object_id, const ClientID &clien
     RAY_LOG(ERROR) << client_id_ << " attempted to pull an object from itself.";
     return ray::Status::Invalid("A node cannot pull an object from itself.");
   }
-  return PullEstablishConnection(object_id, client_id);
+  return PullEstablishConnection({object_id}, client_id);
 };
 
-ray::Status ObjectManager::PullEstablishConnection(const ObjectID &object_id,
-                                                   const ClientID &client_id) {
-  // Acquire a message connection and send pull request.
+ray::Status ObjectManager::PullEstablishConnection(
+    const std::vector<ObjectID> &object_ids, const ClientID &client_id) {
+  return SendMessageRequest(
+      client_id, [this, object_ids](std::shared_ptr<SenderConnection> &conn) {
+        return PullSendRequest(object_ids, conn);
+      });
+}
+
+ray::Status ObjectManager::ChunkEstablishConnection(
+    const ObjectID &object_id, const std::vector<uint64_t> &chunk_indices,
+    const ClientID &client_id) {
+  return SendMessageRequest(
+      client_id,
+      [this, object_id, chunk_indices](std::shared_ptr<SenderConnection> &conn) {
+        return ChunkSendRequest(object_id, chunk_indices, conn);
+      });
+}
+
+ray::Status ObjectManager::SendMessageRequest(
+    const ClientID &client_id,
+    const std::function<ray::Status(std::shared_ptr<SenderConnection> &)>
+        &send_request) {
+  // Acquire a message connection and send the request.
   ray::Status status;
   std::shared_ptr<SenderConnection> conn;
   // TODO(hme): There is no cap on the number of pull request connections.
@@ -165,29 +341,34 @@ ray::Status ObjectManager::PullEstablishConnection(const ObjectID &object_id,
   if (conn == nullptr) {
     status = object_directory_->GetInformation(
         client_id,
-        [this, object_id, client_id](const RemoteConnectionInfo &connection_info) {
+        [this, send_request, client_id](const RemoteConnectionInfo &connection_info) {
           std::shared_ptr<SenderConnection> async_conn = CreateSenderConnection(
               ConnectionPool::ConnectionType::MESSAGE, connection_info);
           connection_pool_.RegisterSender(ConnectionPool::ConnectionType::MESSAGE,
                                           client_id, async_conn);
-          Status pull_send_status = PullSendRequest(object_id, async_conn);
-          RAY_CHECK_OK(pull_send_status);
+          Status send_status = send_request(async_conn);
+          RAY_CHECK_OK(send_status);
         },
         [](const Status &status) {
           RAY_LOG(ERROR) << "Failed to establish connection with remote object manager.";
           RAY_CHECK_OK(status);
         });
   } else {
-    status = PullSendRequest(object_id, conn);
+    status = send_request(conn);
   }
   return status;
 }
 
-ray::Status ObjectManager::PullSendRequest(const ObjectID &object_id,
+ray::Status ObjectManager::PullSendRequest(const std::vector<ObjectID> &object_ids,
                                            std::shared_ptr<SenderConnection> &conn) {
   flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> object_id_strings;
+  object_id_strings.reserve(object_ids.size());
+  for (const auto &object_id : object_ids) {
+    object_id_strings.push_back(fbb.CreateString(object_id.binary()));
+  }
   auto message = object_manager_protocol::CreatePullRequestMessage(
-      fbb, fbb.CreateString(client_id_.binary()), fbb.CreateString(object_id.binary()));
+      fbb, fbb.CreateString(client_id_.binary()), fbb.CreateVector(object_id_strings));
   fbb.Finish(message);
   RAY_CHECK_OK(conn->WriteMessage(object_manager_protocol::MessageType_PullRequest,
                                   fbb.GetSize(), fbb.GetBufferPointer()));
@@ -196,9 +377,39 @@ ray::Status ObjectManager::PullSendRequest(const ObjectID &object_id,
   return ray::Status::OK();
 }
 
+ray::Status ObjectManager::ChunkSendRequest(const ObjectID &object_id,
+                                            const std::vector<uint64_t> &chunk_indices,
+                                            std::shared_ptr<SenderConnection> &conn) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = object_manager_protocol::CreateChunkRequestMessage(
+      fbb, fbb.CreateString(client_id_.binary()), fbb.CreateString(object_id.binary()),
+      fbb.CreateVector(chunk_indices));
+  fbb.Finish(message);
+  RAY_CHECK_OK(conn->WriteMessage(object_manager_protocol::MessageType_ChunkRequest,
+                                  fbb.GetSize(), fbb.GetBufferPointer()));
+  RAY_CHECK_OK(
+      connection_pool_.ReleaseSender(ConnectionPool::ConnectionType::MESSAGE, conn));
+  return ray::Status::OK();
+}
+
 ray::Status ObjectManager::Push(const ObjectID &object_id, const ClientID &client_id,
                                 int retry) {
   if (local_objects_.count(object_id) == 0) {
+    uint64_t data_size;
+    uint64_t metadata_size;
+    if (config_.streaming &&
+        buffer_pool_.GetCreateSizes(object_id, &data_size, &metadata_size)) {
+      // Forward the chunks that have arrived, and the rest as they arrive.
+      return object_directory_->GetInformation(
+          client_id,
+          [this, client_id, object_id, data_size,
+           metadata_size](const RemoteConnectionInfo &info) {
+            ForwardChunks(client_id, object_id, data_size, metadata_size, 0, info);
+          },
+          [](const Status &status) {
+            // Push is best effort, so do nothing here.
+          });
+    }
     if (retry < 0) {
       retry = config_.max_push_retries;
     } else if (retry == 0) {
@@ -212,17 +423,54 @@ ray::Status ObjectManager::Push(const ObjectID &object_id, const ClientID &clien
     return ray::Status::OK();
   }
 
+  const LocalObjectInfo &object_info = local_objects_[object_id];
+  uint64_t num_chunks = buffer_pool_.GetNumChunks(
+      static_cast<uint64_t>(object_info.data_size + object_info.metadata_size));
+  std::vector<uint64_t> chunk_indices;
+  for (uint64_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+    chunk_indices.push_back(chunk_index);
+  }
+  return PushChunks(object_id, client_id, chunk_indices);
+}
+
+bool ObjectManager::IsReceiving(const ObjectID &object_id) {
+  uint64_t data_size;
+  uint64_t metadata_size;
+  return config_.streaming &&
+         buffer_pool_.GetCreateSizes(object_id, &data_size, &metadata_size);
+}
+
+ray::Status ObjectManager::PushChunks(const ObjectID &object_id,
+                                      const ClientID &client_id,
+                                      const std::vector<uint64_t> &chunk_indices) {
   // TODO(hme): Cache this data in ObjectDirectory.
   // Okay for now since the GCS client caches this data.
   Status status = object_directory_->GetInformation(
       client_id,
-      [this, object_id, client_id](const RemoteConnectionInfo &info) {
-        const ObjectInfoT &object_info = local_objects_[object_id];
+      [this, object_id, client_id, chunk_indices](const RemoteConnectionInfo &info) {
+        auto it = local_objects_.find(object_id);
+        if (it == local_objects_.end()) {
+          // The object was evicted. The remote object manager requests the
+          // chunks again from another node if it still needs them.
+          return;
+        }
+        const LocalObjectInfo &object_info = it->second;
         uint64_t data_size =
             static_cast<uint64_t>(object_info.data_size + object_info.metadata_size);
         uint64_t metadata_size = static_cast<uint64_t>(object_info.metadata_size);
-        uint64_t num_chunks = buffer_pool_.GetNumChunks(data_size);
-        for (uint64_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+        if (config_.streaming) {
+          // Send the chunks in order from a single thread, so that the receiver
+          // can read the start of the object while the rest is on its way.
+          send_service_.post([this, client_id, object_id, data_size, metadata_size,
+                              chunk_indices, info]() {
+            for (uint64_t chunk_index : chunk_indices) {
+              ExecuteSendObject(client_id, object_id, data_size, metadata_size,
+                                chunk_index, info);
+            }
+          });
+          return;
+        }
+        for (uint64_t chunk_index : chunk_indices) {
           send_service_.post([this, client_id, object_id, data_size, metadata_size,
                               chunk_index, info]() {
             ExecuteSendObject(client_id, object_id, data_size, metadata_size, chunk_index,
@@ -242,70 +490,179 @@ void ObjectManager::ExecuteSendObject(const ClientID &client_id,
                                       const RemoteConnectionInfo &connection_info) {
   RAY_LOG(DEBUG) << "ExecuteSendObject " << client_id << " " << object_id << " "
                  << chunk_index;
-  ray::Status status;
+  std::shared_ptr<SenderConnection> conn =
+      GetTransferConnection(client_id, connection_info);
+  std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
+      buffer_pool_.GetChunk(object_id, data_size, metadata_size, chunk_index);
+  ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+
+  // Fail on status not okay. The object is local, and there is
+  // no other anticipated error here.
+  RAY_CHECK_OK(chunk_status.second);
+
+  ray::Status status = SendObjectHeaders(object_id, data_size, metadata_size, chunk_info,
+                                         GetCompressionCodec(client_id), conn);
+  // Do this regardless of whether it failed or succeeded.
+  buffer_pool_.ReleaseGetChunk(object_id, chunk_info.chunk_index);
+  if (!status.ok()) {
+    // The connection was dropped. The remote object manager requests the chunk
+    // again if it still needs it.
+    RAY_LOG(WARNING) << "Failed to send chunk " << chunk_index << " of " << object_id
+                     << " to " << client_id << ": " << status.message();
+  }
+}
+
+void ObjectManager::ForwardChunks(const ClientID &client_id, const ObjectID &object_id,
+                                  uint64_t data_size, uint64_t metadata_size,
+                                  uint64_t chunk_index,
+                                  const RemoteConnectionInfo &connection_info) {
+  if (chunk_index == buffer_pool_.GetNumChunks(data_size)) {
+    return;
+  }
+  buffer_pool_.WaitForRange(
+      object_id, chunk_index * config_.object_chunk_size,
+      buffer_pool_.GetBufferLength(chunk_index, data_size),
+      [this, client_id, object_id, data_size, metadata_size, chunk_index,
+       connection_info](std::shared_ptr<const uint8_t> data, const ray::Status &status) {
+        if (!status.ok()) {
+          RAY_LOG(WARNING) << "Stopped forwarding " << object_id << " to " << client_id
+                           << ": " << status.message();
+          return;
+        }
+        // The callback may run on a receive thread, which must not block on
+        // the send.
+        send_service_.post([this, client_id, object_id, data_size, metadata_size,
+                            chunk_index, data, connection_info]() {
+          if (ExecuteForwardChunk(client_id, object_id, data_size, metadata_size,
+                                  chunk_index, data, connection_info)) {
+            ForwardChunks(client_id, object_id, data_size, metadata_size,
+                          chunk_index + 1, connection_info);
+          }
+        });
+      });
+}
+
+bool ObjectManager::ExecuteForwardChunk(const ClientID &client_id,
+                                        const ObjectID &object_id, uint64_t data_size,
+                                        uint64_t metadata_size, uint64_t chunk_index,
+                                        std::shared_ptr<const uint8_t> data,
+                                        const RemoteConnectionInfo &connection_info) {
+  RAY_LOG(DEBUG) << "ExecuteForwardChunk " << client_id << " " << object_id << " "
+                 << chunk_index;
+  std::shared_ptr<SenderConnection> conn =
+      GetTransferConnection(client_id, connection_info);
+  // The chunk is only read from.
+  ObjectBufferPool::ChunkInfo chunk_info(
+      chunk_index, const_cast<uint8_t *>(data.get()),
+      buffer_pool_.GetBufferLength(chunk_index, data_size));
+  ray::Status status = SendObjectHeaders(object_id, data_size, metadata_size, chunk_info,
+                                         GetCompressionCodec(client_id), conn);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to forward chunk " << chunk_index << " of " << object_id
+                     << " to " << client_id << ": " << status.message();
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<SenderConnection> ObjectManager::GetTransferConnection(
+    const ClientID &client_id, const RemoteConnectionInfo &connection_info) {
   std::shared_ptr<SenderConnection> conn;
-  status = connection_pool_.GetSender(ConnectionPool::ConnectionType::TRANSFER, client_id,
-                                      &conn);
+  RAY_CHECK_OK(connection_pool_.GetSender(ConnectionPool::ConnectionType::TRANSFER,
+                                          client_id, &conn));
   if (conn == nullptr) {
     conn =
         CreateSenderConnection(ConnectionPool::ConnectionType::TRANSFER, connection_info);
     connection_pool_.RegisterSender(ConnectionPool::ConnectionType::TRANSFER, client_id,
                                     conn);
   }
-  status = SendObjectHeaders(object_id, data_size, metadata_size, chunk_index, conn);
-  RAY_CHECK_OK(status);
+  return conn;
 }
 
-ray::Status ObjectManager::SendObjectHeaders(const ObjectID &object_id,
-                                             uint64_t data_size, uint64_t metadata_size,
-                                             uint64_t chunk_index,
-                                             std::shared_ptr<SenderConnection> &conn) {
-  std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
-      buffer_pool_.GetChunk(object_id, data_size, metadata_size, chunk_index);
-  ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+CompressionCodec ObjectManager::GetCompressionCodec(const ClientID &client_id) {
+  if (compression_codec_ == CompressionCodec::CompressionCodec_None) {
+    return compression_codec_;
+  }
+  std::lock_guard<std::mutex> lock(remote_codecs_mutex_);
+  auto it = remote_codecs_.find(client_id);
+  if (it == remote_codecs_.end() ||
+      std::find(it->second.begin(), it->second.end(), compression_codec_) ==
+          it->second.end()) {
+    return CompressionCodec::CompressionCodec_None;
+  }
+  return compression_codec_;
+}
 
-  // Fail on status not okay. The object is local, and there is
-  // no other anticipated error here.
-  RAY_CHECK_OK(chunk_status.second);
+ray::Status ObjectManager::SendObjectHeaders(
+    const ObjectID &object_id, uint64_t data_size, uint64_t metadata_size,
+    const ObjectBufferPool::ChunkInfo &chunk_info, CompressionCodec codec,
+    std::shared_ptr<SenderConnection> &conn) {
+  // Compress the chunk if it is large enough and its samples compress well.
+  // Each send thread reuses its own buffer for the compressed chunks.
+  static thread_local std::vector<uint8_t> compressed_chunk;
+  if (codec != CompressionCodec::CompressionCodec_None &&
+      !(chunk_info.buffer_length >= config_.compression_min_chunk_bytes &&
+        ShouldCompress(codec, chunk_info.data, chunk_info.buffer_length) &&
+        Compress(codec, chunk_info.data, chunk_info.buffer_length, &compressed_chunk)
+            .ok() &&
+        compressed_chunk.size() < chunk_info.buffer_length)) {
+    codec = CompressionCodec::CompressionCodec_None;
+  }
+  const bool compressed = codec != CompressionCodec::CompressionCodec_None;
 
   // Create buffer.
   flatbuffers::FlatBufferBuilder fbb;
   // TODO(hme): use to_flatbuf
   auto message = object_manager_protocol::CreatePushRequestMessage(
-      fbb, fbb.CreateString(object_id.binary()), chunk_index, data_size, metadata_size);
+      fbb, fbb.CreateString(object_id.binary()), chunk_info.chunk_index, data_size,
+      metadata_size, codec, compressed ? compressed_chunk.size() : 0);
   fbb.Finish(message);
   ray::Status status =
       conn->WriteMessage(object_manager_protocol::MessageType_PushRequest, fbb.GetSize(),
                          fbb.GetBufferPointer());
-  RAY_CHECK_OK(status);
-  return SendObjectData(object_id, chunk_info, conn);
+  if (!status.ok()) {
+    RAY_CHECK_OK(
+        connection_pool_.RemoveSender(ConnectionPool::ConnectionType::TRANSFER, conn));
+    return status;
+  }
+  return SendObjectData(object_id, chunk_info, compressed ? &compressed_chunk : nullptr,
+                        conn);
 }
 
 ray::Status ObjectManager::SendObjectData(const ObjectID &object_id,
                                           const ObjectBufferPool::ChunkInfo &chunk_info,
+                                          const std::vector<uint8_t> *compressed_chunk,
                                           std::shared_ptr<SenderConnection> &conn) {
   boost::system::error_code ec;
   std::vector<asio::const_buffer> buffer;
-  buffer.push_back(asio::buffer(chunk_info.data, chunk_info.buffer_length));
+  if (compressed_chunk != nullptr) {
+    buffer.push_back(asio::buffer(*compressed_chunk));
+  } else {
+    buffer.push_back(asio::buffer(chunk_info.data, chunk_info.buffer_length));
+  }
   conn->WriteBuffer(buffer, ec);
 
   ray::Status status = ray::Status::OK();
   if (ec.value() != 0) {
-    // Push failed. Deal with partial objects on the receiving end.
-    // TODO(hme): Try to invoke disconnect on sender connection, then remove it.
+    // Push failed. The receiving end aborts the partial chunk and requests it
+    // again. The connection is unusable, so drop it.
     status = ray::Status::IOError(ec.message());
+    RAY_CHECK_OK(
+        connection_pool_.RemoveSender(ConnectionPool::ConnectionType::TRANSFER, conn));
+  } else {
+    RAY_CHECK_OK(
+        connection_pool_.ReleaseSender(ConnectionPool::ConnectionType::TRANSFER, conn));
   }
-
-  // Do this regardless of whether it failed or succeeded.
-  buffer_pool_.ReleaseGetChunk(object_id, chunk_info.chunk_index);
-  RAY_CHECK_OK(
-      connection_pool_.ReleaseSender(ConnectionPool::ConnectionType::TRANSFER, conn));
   RAY_LOG(DEBUG) << "SendCompleted " << client_id_ << " " << object_id << " "
                  << config_.max_sends;
   return status;
 }
 
 ray::Status ObjectManager::Cancel(const ObjectID &object_id) {
+  pull_manager_.Cancel(object_id);
+  SchedulePullRequests();
+  // Nothing retries the chunks of a canceled pull, so discard any that arrived.
+  buffer_pool_.CancelCreate(object_id);
   ray::Status status = object_directory_->UnsubscribeObjectLocations(object_id);
   return status;
 }
@@ -317,6 +674,16 @@ ray::Status ObjectManager::Wait(const std::vector<ObjectID> &object_ids,
   return ray::Status::OK();
 }
 
+ray::Status ObjectManager::WaitForRange(const ObjectID &object_id, uint64_t offset,
+                                        uint64_t length,
+                                        const ObjectBufferPool::RangeCallback &callback) {
+  if (!config_.streaming) {
+    return ray::Status::Invalid("Object streaming is disabled.");
+  }
+  buffer_pool_.WaitForRange(object_id, offset, length, callback);
+  return ray::Status::OK();
+}
+
 std::shared_ptr<SenderConnection> ObjectManager::CreateSenderConnection(
     ConnectionPool::ConnectionType type, RemoteConnectionInfo info) {
   std::shared_ptr<SenderConnection> conn =
@@ -324,8 +691,14 @@ std::shared_ptr<SenderConnection> ObjectManager::CreateSenderConnection(
   // Prepare client connection info buffer
   flatbuffers::FlatBufferBuilder fbb;
   bool is_transfer = (type == ConnectionPool::ConnectionType::TRANSFER);
+  // Tell the remote object manager which codecs it may compress the chunks
+  // that it pushes to this one with.
+  std::vector<uint8_t> codecs;
+  for (CompressionCodec codec : SupportedCompressionCodecs()) {
+    codecs.push_back(static_cast<uint8_t>(codec));
+  }
   auto message = object_manager_protocol::CreateConnectClientMessage(
-      fbb, fbb.CreateString(client_id_.binary()), is_transfer);
+      fbb, fbb.CreateString(client_id_.binary()), is_transfer, fbb.CreateVector(codecs));
   fbb.Finish(message);
   // Send synchronously.
   RAY_CHECK_OK(conn->WriteMessage(object_manager_protocol::MessageType_ConnectClient,
@@ -349,6 +722,10 @@ void ObjectManager::ProcessClientMessage(std::shared_ptr<TcpClientConnection> &c
     ReceivePullRequest(conn, message);
     break;
   }
+  case object_manager_protocol::MessageType_ChunkRequest: {
+    ReceiveChunkRequest(conn, message);
+    break;
+  }
   case object_manager_protocol::MessageType_ConnectClient: {
     ConnectClient(conn, message);
     break;
@@ -370,6 +747,14 @@ void ObjectManager::ConnectClient(std::shared_ptr<TcpClientConnection> &conn,
   ClientID client_id = ObjectID::from_binary(info->client_id()->str());
   bool is_transfer = info->is_transfer();
   conn->SetClientID(client_id);
+  if (info->codecs() != nullptr) {
+    std::vector<CompressionCodec> codecs;
+    for (auto codec : *info->codecs()) {
+      codecs.push_back(static_cast<CompressionCodec>(codec));
+    }
+    std::lock_guard<std::mutex> lock(remote_codecs_mutex_);
+    remote_codecs_[client_id] = std::move(codecs);
+  }
   if (is_transfer) {
     connection_pool_.RegisterReceiver(ConnectionPool::ConnectionType::TRANSFER, client_id,
                                       conn);
@@ -387,11 +772,38 @@ void ObjectManager::DisconnectClient(std::shared_ptr<TcpClientConnection> &conn,
 
 void ObjectManager::ReceivePullRequest(std::shared_ptr<TcpClientConnection> &conn,
                                        const uint8_t *message) {
-  // Serialize and push object to requesting client.
+  // Serialize and push each requested object to the requesting client.
   auto pr = flatbuffers::GetRoot<object_manager_protocol::PullRequestMessage>(message);
-  ObjectID object_id = ObjectID::from_binary(pr->object_id()->str());
   ClientID client_id = ClientID::from_binary(pr->client_id()->str());
-  ray::Status push_status = Push(object_id, client_id);
+  for (const auto &object_id_string : *pr->object_ids()) {
+    ObjectID object_id = ObjectID::from_binary(object_id_string->str());
+    ray::Status push_status = Push(object_id, client_id);
+  }
+  conn->ProcessMessages();
+}
+
+void ObjectManager::ReceiveChunkRequest(std::shared_ptr<TcpClientConnection> &conn,
+                                        const uint8_t *message) {
+  auto cr = flatbuffers::GetRoot<object_manager_protocol::ChunkRequestMessage>(message);
+  ClientID client_id = ClientID::from_binary(cr->client_id()->str());
+  ObjectID object_id = ObjectID::from_binary(cr->object_id()->str());
+  auto it = local_objects_.find(object_id);
+  if (it == local_objects_.end()) {
+    // The requesting client asks another node once this request times out.
+    RAY_LOG(WARNING) << client_id << " requested chunks of " << object_id
+                     << ", which is not local.";
+  } else {
+    const LocalObjectInfo &object_info = it->second;
+    uint64_t num_chunks = buffer_pool_.GetNumChunks(
+        static_cast<uint64_t>(object_info.data_size + object_info.metadata_size));
+    std::vector<uint64_t> chunk_indices;
+    for (uint64_t chunk_index : *cr->chunk_indices()) {
+      if (chunk_index < num_chunks) {
+        chunk_indices.push_back(chunk_index);
+      }
+    }
+    ray::Status push_status = PushChunks(object_id, client_id, chunk_indices);
+  }
   conn->ProcessMessages();
 }
 
@@ -404,15 +816,19 @@ void ObjectManager::ReceivePushRequest(std::shared_ptr<TcpClientConnection> &con
   uint64_t chunk_index = object_header->chunk_index();
   uint64_t data_size = object_header->data_size();
   uint64_t metadata_size = object_header->metadata_size();
-  receive_service_.post([this, object_id, data_size, metadata_size, chunk_index, conn]() {
+  CompressionCodec codec = object_header->codec();
+  uint64_t compressed_size = object_header->compressed_size();
+  receive_service_.post([this, object_id, data_size, metadata_size, chunk_index, codec,
+                         compressed_size, conn]() {
     ExecuteReceiveObject(conn->GetClientID(), object_id, data_size, metadata_size,
-                         chunk_index, *conn);
+                         chunk_index, codec, compressed_size, *conn);
   });
 }
 
 void ObjectManager::ExecuteReceiveObject(const ClientID &client_id,
                                          const ObjectID &object_id, uint64_t data_size,
                                          uint64_t metadata_size, uint64_t chunk_index,
+                                         CompressionCodec codec, uint64_t compressed_size,
                                          TcpClientConnection &conn) {
   RAY_LOG(DEBUG) << "ExecuteReceiveObject " << client_id << " " << object_id << " "
                  << chunk_index;
@@ -420,23 +836,41 @@ void ObjectManager::ExecuteReceiveObject(const ClientID &client_id,
   std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
       buffer_pool_.CreateChunk(object_id, data_size, metadata_size, chunk_index);
   ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+  const bool compressed = codec != CompressionCodec::CompressionCodec_None;
   if (chunk_status.second.ok()) {
     // Avoid handling this chunk if it's already being handled by another process.
     std::vector<boost::asio::mutable_buffer> buffer;
-    buffer.push_back(asio::buffer(chunk_info.data, chunk_info.buffer_length));
+    // Each receive thread reuses its own buffer for the compressed chunks.
+    static thread_local std::vector<uint8_t> compressed_chunk;
+    if (compressed) {
+      compressed_chunk.resize(compressed_size);
+      buffer.push_back(asio::buffer(compressed_chunk));
+    } else {
+      buffer.push_back(asio::buffer(chunk_info.data, chunk_info.buffer_length));
+    }
     boost::system::error_code ec;
     conn.ReadBuffer(buffer, ec);
-    if (ec.value() == 0) {
+    ray::Status status = ec.value() == 0 ? ray::Status::OK()
+                                         : ray::Status::IOError(ec.message());
+    if (status.ok() && compressed) {
+      status = Decompress(codec, compressed_chunk.data(), compressed_chunk.size(),
+                          chunk_info.data, chunk_info.buffer_length);
+    }
+    if (status.ok()) {
       buffer_pool_.SealChunk(object_id, chunk_index);
     } else {
+      // The chunk is requested again if the pull stalls.
+      RAY_LOG(WARNING) << "Failed to receive chunk " << chunk_index << " of "
+                       << object_id << " from " << client_id << ": " << status.message();
       buffer_pool_.AbortCreateChunk(object_id, chunk_index);
-      // TODO(hme): This chunk failed, so create a pull request for this chunk.
     }
   } else {
     RAY_LOG(ERROR) << "Create Chunk Failed index = " << chunk_index << ": "
                    << chunk_status.second.message();
     // Read object into empty buffer.
-    uint64_t buffer_length = buffer_pool_.GetBufferLength(chunk_index, data_size);
+    uint64_t buffer_length = compressed
+                                 ? compressed_size
+                                 : buffer_pool_.GetBufferLength(chunk_index, data_size);
     std::vector<uint8_t> mutable_vec;
     mutable_vec.resize(buffer_length);
     std::vector<boost::asio::mutable_buffer> buffer;
@@ -446,7 +880,7 @@ void ObjectManager::ExecuteReceiveObject(const ClientID &client_id,
     if (ec.value() != 0) {
       RAY_LOG(ERROR) << ec.message();
     }
-    // TODO(hme): If the object isn't local, create a pull request for this chunk.
+    // If the object isn't local, the chunk is requested again if the pull stalls.
   }
   conn.ProcessMessages();
   RAY_LOG(DEBUG) << "ReceiveCompleted " << client_id_ << " " << object_id << " "
@@ -4,8 +4,10 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 #include <boost/asio.hpp>
@@ -20,12 +22,14 @@
 #include "ray/id.h"
 #include "ray/status.h"
 
+#include "ray/object_manager/compression.h"
 #include "ray/object_manager/connection_pool.h"
 #include "ray/object_manager/format/object_manager_generated.h"
 #include "ray/object_manager/object_buffer_pool.h"
 #include "ray/object_manager/object_directory.h"
 #include "ray/object_manager/object_manager_client_connection.h"
 #include "ray/object_manager/object_store_notification_manager.h"
+#include "ray/object_manager/pull_manager.h"
 
 namespace ray {
 
@@ -43,11 +47,34 @@ struct ObjectManagerConfig {
   std::string store_socket_name;
   /// Maximun number of push retries.
   int max_push_retries;
+  /// Maximum total size of the objects that were requested from remote object
+  /// managers but that have not arrived yet.
+  uint64_t max_inflight_pull_bytes;
+  /// The time in milliseconds after which a requested object that has received
+  /// no new chunks is requested again.
+  int chunk_timeout_ms;
+  /// Maximum number of times that an object is requested before its pull fails.
+  int max_pull_attempts;
+  /// The codec to compress the chunks that are sent with, if the receiving
+  /// object manager can decompress it.
+  CompressionCodec compression_codec;
+  /// Chunks smaller than this, in bytes, are sent uncompressed.
+  uint64_t compression_min_chunk_bytes;
+  /// Whether to send the chunks of each object in order, and let readers wait
+  /// for byte ranges of the objects that are being received.
+  bool streaming;
 };
 
+/// The priority of pulls for objects that a running task is blocked on. Pulls
+/// with lower priority values are requested first.
+constexpr int64_t kBlockedTaskPullPriority = std::numeric_limits<int64_t>::min();
+/// The priority of pulls that were not given one. These are requested after
+/// all other pulls.
+constexpr int64_t kDefaultPullPriority = std::numeric_limits<int64_t>::max();
+
 class ObjectManagerInterface {
  public:
-  virtual ray::Status Pull(const ObjectID &object_id) = 0;
+  virtual ray::Status Pull(const ObjectID &object_id, int64_t priority) = 0;
   virtual ray::Status Cancel(const ObjectID &object_id) = 0;
   virtual ~ObjectManagerInterface(){};
 };
@@ -84,18 +111,21 @@ class ObjectManager : public ObjectManagerInterface {
   /// Upon subscribing, the callback will be invoked for all objects that
   ///
   /// already exist in the local store.
-  /// \param callback The callback to invoke when objects are added to the local store.
+  /// \param callback The callback to invoke with each batch of objects that are added
+  /// to the local store.
   /// \return Status of whether adding the subscription succeeded.
-  ray::Status SubscribeObjAdded(std::function<void(const ObjectInfoT &)> callback);
+  ray::Status SubscribeObjAdded(ObjectStoreNotificationManager::AddHandler callback);
 
   /// Subscribe to notifications of objects deleted from local store.
   ///
-  /// \param callback The callback to invoke when objects are removed from the local
-  /// store.
+  /// \param callback The callback to invoke with each batch of objects that are
+  /// removed from the local store.
   /// \return Status of whether adding the subscription succeeded.
-  ray::Status SubscribeObjDeleted(std::function<void(const ray::ObjectID &)> callback);
+  ray::Status SubscribeObjDeleted(ObjectStoreNotificationManager::RemoveHandler callback);
 
   /// Push an object to to the node manager on the node corresponding to client id.
+  /// If streaming is enabled and the object is being received, its chunks are
+  /// forwarded in order as soon as they arrive, rather than once it is sealed.
   ///
   /// \param object_id The object's object id.
   /// \param client_id The remote node's client id.
@@ -103,8 +133,26 @@ class ObjectManager : public ObjectManagerInterface {
   /// \return Status of whether the push request successfully initiated.
   ray::Status Push(const ObjectID &object_id, const ClientID &client_id, int retry = -1);
 
-  /// Pull an object from ClientID. Returns UniqueID asociated with
-  /// an invocation of this method.
+  /// Whether an object that is not local yet can be pushed right away, because
+  /// streaming is enabled and the object is being received.
+  ///
+  /// \param object_id The object's object id.
+  /// \return Whether a push of the object would forward its chunks as they arrive.
+  bool IsReceiving(const ObjectID &object_id);
+
+  /// Pull an object from whichever remote object manager has it. Pulls are
+  /// requested in priority order, batched by remote object manager, and only
+  /// while the total size of the requested objects that have not arrived yet
+  /// is within the configured limit.
+  ///
+  /// \param object_id The object's object id.
+  /// \param priority The priority of the pull. Lower values are requested
+  /// first. Pulling an object that is already being pulled only raises its
+  /// priority.
+  /// \return Status of whether the pull request successfully initiated.
+  ray::Status Pull(const ObjectID &object_id, int64_t priority);
+
+  /// Pull an object with the default priority.
   ///
   /// \param object_id The object's object id.
   /// \return Status of whether the pull request successfully initiated.
@@ -158,6 +206,22 @@ class ObjectManager : public ObjectManagerInterface {
   ray::Status Wait(const std::vector<ObjectID> &object_ids, uint64_t timeout_ms,
                    int num_ready_objects, const WaitCallback &callback);
 
+  /// Wait until a byte range of an object can be read, so that a consumer can start
+  /// on an object that is being received before all of it has arrived. This requires
+  /// streaming to be enabled. See ObjectBufferPool::WaitForRange for when and on
+  /// which thread the callback is invoked. Only consumers in this process can wait
+  /// for ranges. Workers read objects through the plasma store, which hands out only
+  /// sealed objects, so they still wait for the whole object.
+  ///
+  /// \param object_id The object id, usually of an object that is being pulled.
+  /// \param offset The offset of the range in the object's data and metadata.
+  /// \param length The length of the range in bytes.
+  /// \param callback Invoked with the range's data, or with an error status if the
+  /// range is past the end of the object or the pull is canceled or fails.
+  /// \return Status::Invalid if streaming is disabled.
+  ray::Status WaitForRange(const ObjectID &object_id, uint64_t offset, uint64_t length,
+                           const ObjectBufferPool::RangeCallback &callback);
+
  private:
   ClientID client_id_;
   const ObjectManagerConfig config_;
@@ -192,7 +256,26 @@ class ObjectManager : public ObjectManagerInterface {
   ConnectionPool connection_pool_;
 
   /// Cache of locally available objects.
-  std::unordered_map<ObjectID, ObjectInfoT> local_objects_;
+  std::unordered_map<ObjectID, LocalObjectInfo> local_objects_;
+
+  /// Decides when to request the objects that are being pulled.
+  PullManager pull_manager_;
+  /// Whether a call to SendPullRequests is posted to main_service_.
+  bool pull_requests_posted_;
+  /// Timer for checking whether requested objects are still arriving.
+  boost::asio::deadline_timer transfer_timer_;
+  /// Whether transfer_timer_ is set.
+  bool transfer_timer_set_;
+
+  /// The codec to compress sent chunks with, or CompressionCodec_None if the
+  /// configured codec is not supported by this build.
+  CompressionCodec compression_codec_;
+  /// Protects remote_codecs_, which is written on the main thread and read on
+  /// the send threads.
+  std::mutex remote_codecs_mutex_;
+  /// The codecs that each remote object manager can decompress, as sent in its
+  /// ConnectClient messages.
+  std::unordered_map<ClientID, std::vector<CompressionCodec>> remote_codecs_;
 
   /// Handle starting, running, and stopping asio io_service.
   void StartIOService();
@@ -200,47 +283,141 @@ class ObjectManager : public ObjectManagerInterface {
   void RunReceiveService();
   void StopIOService();
 
-  /// Register object add with directory.
-  void NotifyDirectoryObjectAdd(const ObjectInfoT &object_info);
+  /// Register a batch of object adds with directory.
+  void NotifyDirectoryObjectsAdded(const std::vector<LocalObjectInfo> &objects);
 
-  /// Register object remove with directory.
-  void NotifyDirectoryObjectDeleted(const ObjectID &object_id);
+  /// Register a batch of object removes with directory.
+  void NotifyDirectoryObjectsDeleted(const std::vector<ObjectID> &object_ids);
 
   /// Part of an asynchronous sequence of Pull methods.
   /// Uses an existing connection or creates a connection to ClientID.
   /// Executes on main_service_ thread.
-  ray::Status PullEstablishConnection(const ObjectID &object_id,
+  ray::Status PullEstablishConnection(const std::vector<ObjectID> &object_ids,
                                       const ClientID &client_id);
 
+  /// Request some chunks of an object that is being received from a remote
+  /// object manager, using an existing connection or creating one.
+  /// Executes on main_service_ thread.
+  ray::Status ChunkEstablishConnection(const ObjectID &object_id,
+                                       const std::vector<uint64_t> &chunk_indices,
+                                       const ClientID &client_id);
+
+  /// Send a request via an existing message connection to ClientID, or via a new
+  /// one if none is available. Executes on main_service_ thread.
+  ///
+  /// \param client_id The remote object manager to send the request to.
+  /// \param send_request Synchronously sends the request via the given
+  /// connection, and releases the connection.
+  /// \return Status of whether the request was sent or the connection is being
+  /// established.
+  ray::Status SendMessageRequest(
+      const ClientID &client_id,
+      const std::function<ray::Status(std::shared_ptr<SenderConnection> &)>
+          &send_request);
+
   /// Private callback implementation for success on get location. Called from
-  /// ObjectDirectory.
+  /// ObjectDirectory. The object's locations stay subscribed until a remote
+  /// node has the object, so that a pull is never left without locations.
   void GetLocationsSuccess(const std::vector<ray::ClientID> &client_ids,
-                           const ray::ObjectID &object_id);
+                           const ray::ObjectID &object_id, uint64_t object_size);
+
+  /// Post a call to SendPullRequests if the pull manager has pulls that can be
+  /// requested and no call is posted yet. This way, the pulls that become
+  /// ready during one event loop iteration are sent together.
+  void SchedulePullRequests();
+
+  /// Send one pull request to each remote object manager for the pulls that
+  /// the pull manager allows now.
+  void SendPullRequests();
+
+  /// Set transfer_timer_ if it is not set and objects are being pulled.
+  void ScheduleTransferCheck();
+
+  /// Check whether the objects being pulled received chunks since the last
+  /// check. The chunks of a stalled object that have not arrived are requested
+  /// again, from the next remote object manager that has the object, until the
+  /// pull runs out of attempts and the partially received object is discarded.
+  void CheckTransfers();
 
   /// Synchronously send a pull request via remote object manager connection.
   /// Executes on main_service_ thread.
-  ray::Status PullSendRequest(const ObjectID &object_id,
+  ray::Status PullSendRequest(const std::vector<ObjectID> &object_ids,
                               std::shared_ptr<SenderConnection> &conn);
 
+  /// Synchronously send a chunk request via remote object manager connection.
+  /// Executes on main_service_ thread.
+  ray::Status ChunkSendRequest(const ObjectID &object_id,
+                               const std::vector<uint64_t> &chunk_indices,
+                               std::shared_ptr<SenderConnection> &conn);
+
+  /// Push some chunks of a local object to the remote object manager on the node
+  /// corresponding to client id.
+  ///
+  /// \param object_id The object's object id.
+  /// \param client_id The remote node's client id.
+  /// \param chunk_indices The indices of the chunks to push.
+  /// \return Status of whether the push request successfully initiated.
+  ray::Status PushChunks(const ObjectID &object_id, const ClientID &client_id,
+                         const std::vector<uint64_t> &chunk_indices);
+
+  /// Forward the chunks of an object that is being received to the remote object
+  /// manager on the node corresponding to client id, starting at the given chunk.
+  /// Each chunk is sent once it can be read, and the next one is waited for once it
+  /// is sent. Forwarding stops if the object's create is canceled or a send fails,
+  /// and the remote object manager requests the missing chunks again.
+  void ForwardChunks(const ClientID &client_id, const ObjectID &object_id,
+                     uint64_t data_size, uint64_t metadata_size, uint64_t chunk_index,
+                     const RemoteConnectionInfo &connection_info);
+
   std::shared_ptr<SenderConnection> CreateSenderConnection(
       ConnectionPool::ConnectionType type, RemoteConnectionInfo info);
 
+  /// Get a transfer connection to a remote object manager from the pool, or
+  /// create one. Executes on send_service_ thread pool.
+  std::shared_ptr<SenderConnection> GetTransferConnection(
+      const ClientID &client_id, const RemoteConnectionInfo &connection_info);
+
+  /// Get the codec to compress the chunks sent to a remote object manager with.
+  /// Executes on send_service_ thread pool.
+  ///
+  /// \param client_id The remote object manager.
+  /// \return The configured codec if the remote object manager can decompress
+  /// it, and CompressionCodec_None otherwise.
+  CompressionCodec GetCompressionCodec(const ClientID &client_id);
+
   /// Begin executing a send.
   /// Executes on send_service_ thread pool.
   void ExecuteSendObject(const ClientID &client_id, const ObjectID &object_id,
                          uint64_t data_size, uint64_t metadata_size, uint64_t chunk_index,
                          const RemoteConnectionInfo &connection_info);
+
+  /// Send a chunk of an object that is being received, which the given range pins.
+  /// Executes on send_service_ thread pool.
+  ///
+  /// \return Whether the chunk was sent.
+  bool ExecuteForwardChunk(const ClientID &client_id, const ObjectID &object_id,
+                           uint64_t data_size, uint64_t metadata_size,
+                           uint64_t chunk_index, std::shared_ptr<const uint8_t> data,
+                           const RemoteConnectionInfo &connection_info);
+
   /// This method synchronously sends the object id and object size
-  /// to the remote object manager.
+  /// to the remote object manager. The chunk is compressed with the given
+  /// codec first, unless it is too small or does not compress well.
   /// Executes on send_service_ thread pool.
   ray::Status SendObjectHeaders(const ObjectID &object_id, uint64_t data_size,
-                                uint64_t metadata_size, uint64_t chunk_index,
+                                uint64_t metadata_size,
+                                const ObjectBufferPool::ChunkInfo &chunk_info,
+                                CompressionCodec codec,
                                 std::shared_ptr<SenderConnection> &conn);
 
   /// This method initiates the actual object transfer.
   /// Executes on send_service_ thread pool.
+  ///
+  /// \param compressed_chunk The compressed chunk to send instead of the chunk's
+  /// data, or nullptr to send the data as is.
   ray::Status SendObjectData(const ObjectID &object_id,
                              const ObjectBufferPool::ChunkInfo &chunk_info,
+                             const std::vector<uint8_t> *compressed_chunk,
                              std::shared_ptr<SenderConnection> &conn);
 
   /// Invoked when a remote object manager pushes an object to this object manager.
@@ -248,14 +425,20 @@ class ObjectManager : public ObjectManagerInterface {
   void ReceivePushRequest(std::shared_ptr<TcpClientConnection> &conn,
                           const uint8_t *message);
   /// Execute a receive on the receive_service_ thread pool.
+  /// A compressed chunk is decompressed straight into the object's buffer.
   void ExecuteReceiveObject(const ClientID &client_id, const ObjectID &object_id,
                             uint64_t data_size, uint64_t metadata_size,
-                            uint64_t chunk_index, TcpClientConnection &conn);
+                            uint64_t chunk_index, CompressionCodec codec,
+                            uint64_t compressed_size, TcpClientConnection &conn);
 
   /// Handles receiving a pull request message.
   void ReceivePullRequest(std::shared_ptr<TcpClientConnection> &conn,
                           const uint8_t *message);
 
+  /// Handles receiving a chunk request message.
+  void ReceiveChunkRequest(std::shared_ptr<TcpClientConnection> &conn,
+                           const uint8_t *message);
+
   /// Handles connect message of a new client connection.
   void ConnectClient(std::shared_ptr<TcpClientConnection> &conn, const uint8_t *message);
   /// Handles disconnect message of an existing client connection.
@@ -10,7 +10,7 @@ std::shared_ptr<SenderConnection> SenderConnection::Create(
   boost::asio::ip::tcp::socket socket(io_service);
   RAY_CHECK_OK(TcpConnect(socket, ip, port));
   std::shared_ptr<TcpServerConnection> conn =
-      std::make_shared<TcpServerConnection>(std::move(socket));
+      TcpServerConnection::Create(std::move(socket));
   return std::make_shared<SenderConnection>(std::move(conn), client_id);
 };
 
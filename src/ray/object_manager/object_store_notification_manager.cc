@@ -1,3 +1,4 @@
+#include <cstring>
 #include <future>
 #include <iostream>
 
@@ -10,11 +11,23 @@
 
 #include "ray/object_manager/object_store_notification_manager.h"
 
+namespace {
+
+/// The number of bytes to read from the store's socket at a time. A
+/// notification is about a hundred bytes, so a burst of several hundred
+/// notifications is handled with one read.
+constexpr size_t kNotificationBufferSize = 64 * 1024;
+
+}  // namespace
+
 namespace ray {
 
 ObjectStoreNotificationManager::ObjectStoreNotificationManager(
     boost::asio::io_service &io_service, const std::string &store_socket_name)
-    : store_client_(), socket_(io_service) {
+    : store_client_(),
+      buffer_(kNotificationBufferSize),
+      buffer_size_(0),
+      socket_(io_service) {
   ARROW_CHECK_OK(store_client_.Connect(store_socket_name.c_str(), "",
                                        plasma::kPlasmaDefaultReleaseDelay));
 
@@ -30,57 +43,85 @@ ObjectStoreNotificationManager::~ObjectStoreNotificationManager() {
 }
 
 void ObjectStoreNotificationManager::NotificationWait() {
-  boost::asio::async_read(socket_, boost::asio::buffer(&length_, sizeof(length_)),
-                          boost::bind(&ObjectStoreNotificationManager::ProcessStoreLength,
-                                      this, boost::asio::placeholders::error));
-}
-
-void ObjectStoreNotificationManager::ProcessStoreLength(
-    const boost::system::error_code &error) {
-  notification_.resize(length_);
-  boost::asio::async_read(
-      socket_, boost::asio::buffer(notification_),
-      boost::bind(&ObjectStoreNotificationManager::ProcessStoreNotification, this,
-                  boost::asio::placeholders::error));
+  socket_.async_read_some(
+      boost::asio::buffer(buffer_.data() + buffer_size_, buffer_.size() - buffer_size_),
+      boost::bind(&ObjectStoreNotificationManager::ProcessStoreNotifications, this,
+                  boost::asio::placeholders::error,
+                  boost::asio::placeholders::bytes_transferred));
 }
 
-void ObjectStoreNotificationManager::ProcessStoreNotification(
-    const boost::system::error_code &error) {
+void ObjectStoreNotificationManager::ProcessStoreNotifications(
+    const boost::system::error_code &error, size_t bytes_transferred) {
   if (error) {
     RAY_LOG(FATAL) << error.message();
   }
-
-  const auto &object_info = flatbuffers::GetRoot<ObjectInfo>(notification_.data());
-  const auto &object_id = from_flatbuf(*object_info->object_id());
-  if (object_info->is_deletion()) {
-    ProcessStoreRemove(object_id);
-  } else {
-    ObjectInfoT result;
-    object_info->UnPackTo(&result);
-    ProcessStoreAdd(result);
+  buffer_size_ += bytes_transferred;
+
+  // Parse every complete notification in the buffer. Each one is a length
+  // followed by an ObjectInfo flatbuffer of that length.
+  int64_t length;
+  size_t offset = 0;
+  while (buffer_size_ - offset >= sizeof(length)) {
+    std::memcpy(&length, buffer_.data() + offset, sizeof(length));
+    if (buffer_size_ - offset - sizeof(length) < static_cast<size_t>(length)) {
+      break;
+    }
+    const auto object_info =
+        flatbuffers::GetRoot<ObjectInfo>(buffer_.data() + offset + sizeof(length));
+    const ObjectID object_id = from_flatbuf(*object_info->object_id());
+    // Dispatch the run of the other kind first, so that the subscribers see
+    // the additions and deletions of an object in order.
+    if (object_info->is_deletion()) {
+      ProcessStoreAdd();
+      removed_objects_.push_back(object_id);
+    } else {
+      ProcessStoreRemove();
+      added_objects_.push_back(
+          {object_id, object_info->data_size(), object_info->metadata_size()});
+    }
+    offset += sizeof(length) + length;
+  }
+  ProcessStoreAdd();
+  ProcessStoreRemove();
+
+  // Keep the partial notification at the end of the buffer, if any, for the
+  // next read, and make sure that the rest of it fits.
+  buffer_size_ -= offset;
+  std::memmove(buffer_.data(), buffer_.data() + offset, buffer_size_);
+  if (buffer_size_ >= sizeof(length)) {
+    std::memcpy(&length, buffer_.data(), sizeof(length));
+    if (sizeof(length) + length > buffer_.size()) {
+      buffer_.resize(sizeof(length) + length);
+    }
   }
   NotificationWait();
 }
 
-void ObjectStoreNotificationManager::ProcessStoreAdd(const ObjectInfoT &object_info) {
+void ObjectStoreNotificationManager::ProcessStoreAdd() {
+  if (added_objects_.empty()) {
+    return;
+  }
   for (auto &handler : add_handlers_) {
-    handler(object_info);
+    handler(added_objects_);
   }
+  added_objects_.clear();
 }
 
-void ObjectStoreNotificationManager::ProcessStoreRemove(const ObjectID &object_id) {
+void ObjectStoreNotificationManager::ProcessStoreRemove() {
+  if (removed_objects_.empty()) {
+    return;
+  }
   for (auto &handler : rem_handlers_) {
-    handler(object_id);
+    handler(removed_objects_);
   }
+  removed_objects_.clear();
 }
 
-void ObjectStoreNotificationManager::SubscribeObjAdded(
-    std::function<void(const ObjectInfoT &)> callback) {
+void ObjectStoreNotificationManager::SubscribeObjAdded(AddHandler callback) {
   add_handlers_.push_back(std::move(callback));
 }
 
-void ObjectStoreNotificationManager::SubscribeObjDeleted(
-    std::function<void(const ObjectID &)> callback) {
+void ObjectStoreNotificationManager::SubscribeObjDeleted(RemoveHandler callback) {
   rem_handlers_.push_back(std::move(callback));
 }
 
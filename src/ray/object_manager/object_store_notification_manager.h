@@ -16,15 +16,21 @@
 #include "ray/id.h"
 #include "ray/status.h"
 
-#include "ray/object_manager/object_directory.h"
+#include "ray/object_manager/local_object_info.h"
 
 namespace ray {
 
 /// \class ObjectStoreClientPool
 ///
-/// Encapsulates notification handling from the object store.
+/// Encapsulates notification handling from the object store. Notifications are
+/// read from the store's socket in large chunks, and every notification that is
+/// complete in a chunk is handed to the subscribers in one batch. Runs of
+/// additions and deletions are dispatched in the order that the store sent them.
 class ObjectStoreNotificationManager {
  public:
+  using AddHandler = std::function<void(const std::vector<LocalObjectInfo> &)>;
+  using RemoveHandler = std::function<void(const std::vector<ObjectID> &)>;
+
   /// Constructor.
   ///
   /// \param io_service The asio service to be used.
@@ -38,31 +44,40 @@ class ObjectStoreNotificationManager {
   /// Upon subscribing, the callback will be invoked for all objects that
   /// already exist in the local store
   ///
-  /// \param callback A callback expecting an ObjectID.
-  void SubscribeObjAdded(std::function<void(const ObjectInfoT &)> callback);
+  /// \param callback A callback expecting a batch of added objects.
+  void SubscribeObjAdded(AddHandler callback);
 
   /// Subscribe to notifications of objects deleted from local store.
   ///
-  /// \param callback A callback expecting an ObjectID.
-  void SubscribeObjDeleted(std::function<void(const ray::ObjectID &)> callback);
+  /// \param callback A callback expecting a batch of deleted ObjectIDs.
+  void SubscribeObjDeleted(RemoveHandler callback);
 
  private:
   /// Async loop for handling object store notifications.
   void NotificationWait();
-  void ProcessStoreLength(const boost::system::error_code &error);
-  void ProcessStoreNotification(const boost::system::error_code &error);
+  void ProcessStoreNotifications(const boost::system::error_code &error,
+                                 size_t bytes_transferred);
 
-  /// Support for rebroadcasting object add/rem events.
-  void ProcessStoreAdd(const ObjectInfoT &object_info);
-  void ProcessStoreRemove(const ObjectID &object_id);
+  /// Support for rebroadcasting batches of object add/rem events.
+  void ProcessStoreAdd();
+  void ProcessStoreRemove();
 
-  std::vector<std::function<void(const ObjectInfoT &)>> add_handlers_;
-  std::vector<std::function<void(const ray::ObjectID &)>> rem_handlers_;
+  std::vector<AddHandler> add_handlers_;
+  std::vector<RemoveHandler> rem_handlers_;
 
   plasma::PlasmaClient store_client_;
   int c_socket_;
-  int64_t length_;
-  std::vector<uint8_t> notification_;
+  /// The bytes read from the store that have not been parsed yet. This starts
+  /// with a partial notification, if the last read ended in the middle of one.
+  std::vector<uint8_t> buffer_;
+  /// The number of bytes at the front of buffer_ that hold data.
+  size_t buffer_size_;
+  /// The run of additions parsed from the current chunk that are not
+  /// dispatched yet.
+  std::vector<LocalObjectInfo> added_objects_;
+  /// The run of deletions parsed from the current chunk that are not
+  /// dispatched yet.
+  std::vector<ObjectID> removed_objects_;
   boost::asio::local::stream_protocol::socket socket_;
 };
 
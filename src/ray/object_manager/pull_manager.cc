@@ -0,0 +1,156 @@
+#include "ray/object_manager/pull_manager.h"
+
+#include <unordered_map>
+
+namespace ray {
+
+PullManager::PullManager(uint64_t max_inflight_bytes, int max_attempts)
+    : max_inflight_bytes_(max_inflight_bytes),
+      max_attempts_(max_attempts),
+      inflight_bytes_(0),
+      next_sequence_number_(0),
+      pulls_(),
+      queue_() {}
+
+bool PullManager::Pull(const ObjectID &object_id, int64_t priority) {
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end()) {
+    PullRequest request;
+    request.priority = priority;
+    request.sequence_number = next_sequence_number_++;
+    request.object_size = 0;
+    request.inflight = false;
+    request.attempts = 0;
+    request.client_index = 0;
+    request.num_chunks_received = 0;
+    request.checked = false;
+    pulls_.emplace(object_id, std::move(request));
+    return true;
+  }
+  PullRequest &request = it->second;
+  if (priority < request.priority) {
+    // Move the pull up in the queue if it is waiting to be requested.
+    if (queue_.erase(QueueKey(request.priority, request.sequence_number)) == 1) {
+      queue_.emplace(QueueKey(priority, request.sequence_number), object_id);
+    }
+    request.priority = priority;
+  }
+  return false;
+}
+
+void PullManager::Cancel(const ObjectID &object_id) {
+  // If the object was already requested, it may still arrive. Its bytes are
+  // released anyway, since nothing will complete the pull anymore.
+  HandleObjectLocal(object_id);
+}
+
+void PullManager::SetLocations(const ObjectID &object_id,
+                               const std::vector<ClientID> &client_ids,
+                               uint64_t object_size) {
+  RAY_CHECK(!client_ids.empty());
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end() || it->second.inflight) {
+    return;
+  }
+  PullRequest &request = it->second;
+  request.client_ids = client_ids;
+  request.object_size = object_size;
+  queue_.emplace(QueueKey(request.priority, request.sequence_number), object_id);
+}
+
+void PullManager::HandleObjectLocal(const ObjectID &object_id) {
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end()) {
+    return;
+  }
+  const PullRequest &request = it->second;
+  if (request.inflight) {
+    inflight_bytes_ -= request.object_size;
+  } else {
+    queue_.erase(QueueKey(request.priority, request.sequence_number));
+  }
+  pulls_.erase(it);
+}
+
+bool PullManager::HasRequests() const {
+  if (queue_.empty()) {
+    return false;
+  }
+  const PullRequest &next = pulls_.at(queue_.begin()->second);
+  return inflight_bytes_ == 0 ||
+         inflight_bytes_ + next.object_size <= max_inflight_bytes_;
+}
+
+std::vector<std::pair<ClientID, std::vector<ObjectID>>> PullManager::TakeRequests() {
+  std::vector<std::pair<ClientID, std::vector<ObjectID>>> requests;
+  // The position of each node's batch in requests.
+  std::unordered_map<ClientID, size_t> batch_index;
+  while (HasRequests()) {
+    auto next = queue_.begin();
+    const ObjectID object_id = next->second;
+    queue_.erase(next);
+    PullRequest &request = pulls_.at(object_id);
+    request.inflight = true;
+    request.attempts = 1;
+    inflight_bytes_ += request.object_size;
+    // Prefer a node that is already sent a request in this batch.
+    auto batch = batch_index.end();
+    for (request.client_index = 0; request.client_index < request.client_ids.size();
+         request.client_index++) {
+      batch = batch_index.find(request.client_ids[request.client_index]);
+      if (batch != batch_index.end()) {
+        break;
+      }
+    }
+    if (batch == batch_index.end()) {
+      request.client_index = 0;
+      const ClientID &client_id = request.client_ids.front();
+      batch = batch_index.emplace(client_id, requests.size()).first;
+      requests.emplace_back(client_id, std::vector<ObjectID>());
+    }
+    requests[batch->second].second.push_back(object_id);
+  }
+  return requests;
+}
+
+PullManager::PullCheck PullManager::CheckProgress(const ObjectID &object_id,
+                                                  uint64_t num_chunks_received,
+                                                  ClientID *client_id) {
+  auto it = pulls_.find(object_id);
+  RAY_CHECK(it != pulls_.end() && it->second.inflight);
+  PullRequest &request = it->second;
+  bool progressed = num_chunks_received > request.num_chunks_received;
+  request.num_chunks_received = num_chunks_received;
+  if (!request.checked || progressed) {
+    // Give the request a full period to make progress before retrying it.
+    request.checked = true;
+    return PullCheck::WAIT;
+  }
+  if (request.attempts >= max_attempts_) {
+    // Give up. Nothing will complete the pull, so release its bytes.
+    inflight_bytes_ -= request.object_size;
+    pulls_.erase(it);
+    return PullCheck::FAIL;
+  }
+  request.attempts++;
+  request.client_index = (request.client_index + 1) % request.client_ids.size();
+  request.checked = false;
+  *client_id = request.client_ids[request.client_index];
+  return PullCheck::RETRY;
+}
+
+std::vector<ObjectID> PullManager::InflightPulls() const {
+  std::vector<ObjectID> object_ids;
+  for (const auto &pull : pulls_) {
+    if (pull.second.inflight) {
+      object_ids.push_back(pull.first);
+    }
+  }
+  return object_ids;
+}
+
+uint64_t PullManager::InflightBytes() const { return inflight_bytes_; }
+
+size_t PullManager::NumPulls() const { return pulls_.size(); }
+
+}  // namespace ray
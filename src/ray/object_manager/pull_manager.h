@@ -0,0 +1,173 @@
+#ifndef RAY_OBJECT_MANAGER_PULL_MANAGER_H
+#define RAY_OBJECT_MANAGER_PULL_MANAGER_H
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ray/id.h"
+#include "ray/id_map.h"
+
+namespace ray {
+
+/// \class PullManager
+///
+/// Decides which of the objects that this node wants to pull are requested
+/// from remote object managers, and when. Each pull has a priority, and pulls
+/// with lower priority values are requested first. The total size of the
+/// objects that were requested but have not arrived yet is capped, so that the
+/// local object store is never asked to receive more than it was configured
+/// for. Requests are grouped by the remote node that they are sent to, so that
+/// many objects can be requested from the same node with a single message.
+///
+/// Requested pulls that stop making progress are retried from the next node
+/// that has the object, and fail after a bounded number of attempts.
+///
+/// The pull manager only does the bookkeeping; the object manager sends the
+/// requests that TakeRequests and CheckProgress return.
+class PullManager {
+ public:
+  /// What to do about a requested pull after checking its progress.
+  enum class PullCheck {
+    /// The pull is making progress, or was requested too recently to tell.
+    WAIT,
+    /// The pull stalled. The chunks that have not arrived should be requested
+    /// again.
+    RETRY,
+    /// The pull stalled and has no attempts left. It has been removed.
+    FAIL
+  };
+
+  /// Create a pull manager.
+  ///
+  /// \param max_inflight_bytes The maximum total size of the objects that have
+  /// been requested but that have not arrived yet. A single object that is
+  /// larger than this is still requested once nothing else is in flight.
+  /// \param max_attempts The number of times that an object is requested
+  /// before its pull fails.
+  PullManager(uint64_t max_inflight_bytes, int max_attempts);
+
+  /// Add a pull, or raise the priority of an existing one.
+  ///
+  /// \param object_id The object to pull.
+  /// \param priority The priority of the pull. Lower values are requested
+  /// first. If the object is already being pulled, its priority is lowered to
+  /// this value if it is lower.
+  /// \return Whether this is a new pull. The caller should then look up the
+  /// object's locations and pass them to SetLocations.
+  bool Pull(const ObjectID &object_id, int64_t priority);
+
+  /// Cancel a pull. This is a no-op if the object is not being pulled.
+  ///
+  /// \param object_id The object to stop pulling.
+  void Cancel(const ObjectID &object_id);
+
+  /// Record where a pulled object can be requested from. The pull becomes
+  /// eligible to be requested. This is a no-op if the object is not being
+  /// pulled or if it was already requested.
+  ///
+  /// \param object_id The object being pulled.
+  /// \param client_ids The remote nodes that have the object. Must be
+  /// non-empty.
+  /// \param object_size The size of the object in bytes, if known, or 0.
+  void SetLocations(const ObjectID &object_id, const std::vector<ClientID> &client_ids,
+                    uint64_t object_size);
+
+  /// Handle an object appearing in the local store. Its pull, if any, is
+  /// completed, and the bytes that it reserved are released.
+  ///
+  /// \param object_id The object that became local.
+  void HandleObjectLocal(const ObjectID &object_id);
+
+  /// Take the pulls that should be requested now. Pulls are taken in priority
+  /// order, until the next one would exceed the limit on in-flight bytes.
+  /// Each object is requested from a node that the returned batch already
+  /// sends a request to, if it has the object.
+  ///
+  /// \return The objects to request, grouped by the node to request them from.
+  /// The groups are in the order of their highest priority pull.
+  std::vector<std::pair<ClientID, std::vector<ObjectID>>> TakeRequests();
+
+  /// Check whether a requested pull made progress since it was last checked.
+  /// This should be called periodically for each pull returned by
+  /// InflightPulls. The first check after a pull is requested only records its
+  /// progress.
+  ///
+  /// \param[in] object_id The object being pulled.
+  /// \param[in] num_chunks_received The number of the object's chunks that
+  /// were received so far.
+  /// \param[out] client_id If the pull should be retried, the node to request
+  /// the object from. Successive attempts go to each node that has the object
+  /// in turn.
+  /// \return What to do about the pull.
+  PullCheck CheckProgress(const ObjectID &object_id, uint64_t num_chunks_received,
+                          ClientID *client_id);
+
+  /// Get the pulls that were requested and that have not completed.
+  ///
+  /// \return The objects being pulled from remote nodes.
+  std::vector<ObjectID> InflightPulls() const;
+
+  /// Whether TakeRequests would return any request.
+  ///
+  /// \return Whether a pull can be requested now.
+  bool HasRequests() const;
+
+  /// Get the total size of the objects that were requested but that have not
+  /// arrived yet.
+  ///
+  /// \return The number of in-flight bytes.
+  uint64_t InflightBytes() const;
+
+  /// Get the number of pulls that have not completed or been canceled.
+  ///
+  /// \return The number of pulls.
+  size_t NumPulls() const;
+
+ private:
+  /// The position of a pull in the queue of pulls that can be requested:
+  /// first by priority, then in the order that the pulls were added.
+  using QueueKey = std::pair<int64_t, uint64_t>;
+
+  /// The state of a pull.
+  struct PullRequest {
+    /// The priority of the pull.
+    int64_t priority;
+    /// The order in which the pull was added, used to break ties.
+    uint64_t sequence_number;
+    /// The remote nodes that have the object. Empty until the locations are
+    /// known.
+    std::vector<ClientID> client_ids;
+    /// The size of the object in bytes, or 0 if unknown.
+    uint64_t object_size;
+    /// Whether the object was requested from a remote node.
+    bool inflight;
+    /// The number of times that the object was requested.
+    int attempts;
+    /// The index in client_ids of the node that the object was last requested
+    /// from.
+    size_t client_index;
+    /// The number of chunks received when the pull was last checked.
+    uint64_t num_chunks_received;
+    /// Whether the pull was checked since it was last requested.
+    bool checked;
+  };
+
+  /// The maximum number of in-flight bytes.
+  const uint64_t max_inflight_bytes_;
+  /// The number of times that an object is requested before its pull fails.
+  const int max_attempts_;
+  /// The total size of the objects that were requested and have not arrived.
+  uint64_t inflight_bytes_;
+  /// The number of pulls added so far, used to order pulls of equal priority.
+  uint64_t next_sequence_number_;
+  /// All pulls that have not completed or been canceled.
+  IdMap<PullRequest> pulls_;
+  /// The pulls whose locations are known and that were not requested yet.
+  std::map<QueueKey, ObjectID> queue_;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_PULL_MANAGER_H
@@ -0,0 +1,261 @@
+// Measure how streaming affects the time until a node that an object is relayed to
+// can read the start of the object, and until it has all of it.
+//
+// Usage: streaming_benchmark store_executable
+//
+// Redis must be running on port 6379, as for object_manager_test. Three object
+// managers run in this process, each with its own plasma store. Node A puts a 64MiB
+// object, node B pulls it from A, and B pushes it on to node C, like a node that
+// forwards an actor task along with its arguments. Without streaming, B pushes the
+// object once it is sealed there. With streaming, B pushes it as soon as its first
+// chunk arrives, and forwards each chunk once it can read it. C reads the start of
+// the object with ObjectManager::WaitForRange when streaming, and once the object
+// is sealed otherwise. The links are loopback, so this measures the relaying rather
+// than a network.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ray/object_manager/object_manager.h"
+
+namespace ray {
+
+namespace {
+
+constexpr uint64_t kObjectSize = 64 * 1024 * 1024;
+constexpr uint64_t kChunkSize = 1024 * 1024;
+
+std::string store_executable;
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// An object manager with its own plasma store and GCS client, which accepts
+/// connections from the other object managers.
+class Node {
+ public:
+  Node(boost::asio::io_service &main_service, const ObjectManagerConfig &config,
+       const std::string &store_socket_name)
+      : acceptor_(main_service,
+                  boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 0)),
+        socket_(main_service),
+        gcs_client_(new gcs::AsyncGcsClient()),
+        object_manager_(main_service, config, gcs_client_) {
+    RAY_CHECK_OK(gcs_client_->Connect("127.0.0.1", 6379));
+    RAY_CHECK_OK(gcs_client_->Attach(main_service));
+    boost::asio::ip::tcp::endpoint endpoint = acceptor_.local_endpoint();
+    ClientTableDataT client_info = gcs_client_->client_table().GetLocalClient();
+    client_info.node_manager_address = endpoint.address().to_string();
+    client_info.node_manager_port = endpoint.port();
+    client_info.object_manager_port = endpoint.port();
+    RAY_CHECK_OK(gcs_client_->client_table().Connect(client_info));
+    object_manager_.RegisterGcs();
+    RAY_CHECK_OK(store_client_.Connect(store_socket_name, "",
+                                       plasma::kPlasmaDefaultReleaseDelay));
+    DoAccept();
+  }
+
+  ~Node() {
+    ARROW_CHECK_OK(store_client_.Disconnect());
+    RAY_CHECK_OK(gcs_client_->client_table().Disconnect());
+  }
+
+  ClientID GetClientId() { return gcs_client_->client_table().GetLocalClientId(); }
+
+  gcs::AsyncGcsClient &GetGcsClient() { return *gcs_client_; }
+
+  ObjectManager &GetObjectManager() { return object_manager_; }
+
+  /// Put an object of the given size into this node's store.
+  void PutObject(const ObjectID &object_id, uint64_t size) {
+    std::shared_ptr<Buffer> data;
+    ARROW_CHECK_OK(store_client_.Create(object_id.to_plasma_id(), size, nullptr, 0,
+                                        &data));
+    std::memset(data->mutable_data(), 1, size);
+    ARROW_CHECK_OK(store_client_.Seal(object_id.to_plasma_id()));
+    ARROW_CHECK_OK(store_client_.Release(object_id.to_plasma_id()));
+  }
+
+ private:
+  void DoAccept() {
+    acceptor_.async_accept(socket_, [this](const boost::system::error_code &error) {
+      if (error) {
+        return;
+      }
+      ClientHandler<boost::asio::ip::tcp> client_handler = [this](
+          TcpClientConnection &client) { object_manager_.ProcessNewClient(client); };
+      MessageHandler<boost::asio::ip::tcp> message_handler = [this](
+          std::shared_ptr<TcpClientConnection> client, int64_t message_type,
+          const uint8_t *message) {
+        object_manager_.ProcessClientMessage(client, message_type, message);
+      };
+      TcpClientConnection::Create(client_handler, message_handler, std::move(socket_));
+      DoAccept();
+    });
+  }
+
+  boost::asio::ip::tcp::acceptor acceptor_;
+  boost::asio::ip::tcp::socket socket_;
+  std::shared_ptr<gcs::AsyncGcsClient> gcs_client_;
+  ObjectManager object_manager_;
+  plasma::PlasmaClient store_client_;
+};
+
+/// The times, in milliseconds since node B started pulling the object, at which
+/// node C could read its first chunk and all of it.
+struct RelayTimes {
+  double first_chunk_ms;
+  double whole_object_ms;
+};
+
+std::string StartStore() {
+  std::string store_socket_name = "/tmp/store" + UniqueID::from_random().hex();
+  std::string command = store_executable + " -m 1000000000 -s " + store_socket_name +
+                        " 1> /dev/null 2> /dev/null & echo $! > " +
+                        store_socket_name + ".pid";
+  RAY_CHECK(system(command.c_str()) == 0);
+  sleep(1);
+  return store_socket_name;
+}
+
+void StopStore(const std::string &store_socket_name) {
+  std::string command = "kill -9 `cat " + store_socket_name + ".pid`";
+  RAY_CHECK(system(command.c_str()) == 0);
+}
+
+RelayTimes RelayObject(bool streaming) {
+  redisContext *context = redisConnect("127.0.0.1", 6379);
+  freeReplyObject(redisCommand(context, "FLUSHALL"));
+  redisFree(context);
+
+  boost::asio::io_service main_service;
+  std::vector<std::string> store_socket_names;
+  std::vector<std::unique_ptr<Node>> nodes;
+  for (int i = 0; i < 3; i++) {
+    store_socket_names.push_back(StartStore());
+    ObjectManagerConfig config;
+    config.store_socket_name = store_socket_names.back();
+    config.pull_timeout_ms = 1;
+    config.max_sends = 4;
+    config.max_receives = 4;
+    config.object_chunk_size = kChunkSize;
+    config.max_push_retries = 1000;
+    config.max_inflight_pull_bytes = 1000000000;
+    config.chunk_timeout_ms = 10000;
+    config.max_pull_attempts = 5;
+    config.compression_codec = CompressionCodec::CompressionCodec_None;
+    config.compression_min_chunk_bytes = 0;
+    config.streaming = streaming;
+    nodes.emplace_back(new Node(main_service, config, store_socket_names.back()));
+  }
+  Node &a = *nodes[0];
+  Node &b = *nodes[1];
+  Node &c = *nodes[2];
+  const ObjectID object_id = ObjectID::from_random();
+  const ClientID c_id = c.GetClientId();
+
+  std::mutex mutex;
+  Clock::time_point start;
+  RelayTimes times = {-1, -1};
+  auto record_first_chunk = [&mutex, &start, &times]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (times.first_chunk_ms < 0) {
+      times.first_chunk_ms = MillisecondsSince(start);
+    }
+  };
+
+  RAY_CHECK_OK(c.GetObjectManager().SubscribeObjAdded(
+      [&](const std::vector<LocalObjectInfo> &objects) {
+        for (const auto &object_info : objects) {
+          if (object_info.object_id == object_id) {
+            record_first_chunk();
+            std::lock_guard<std::mutex> lock(mutex);
+            times.whole_object_ms = MillisecondsSince(start);
+            main_service.stop();
+          }
+        }
+      }));
+  if (streaming) {
+    // Forward the object once its first chunk reaches B.
+    RAY_CHECK_OK(b.GetObjectManager().WaitForRange(
+        object_id, 0, 1,
+        [&](std::shared_ptr<const uint8_t> data, const ray::Status &status) {
+          RAY_CHECK_OK(status);
+          main_service.post(
+              [&]() { RAY_CHECK_OK(b.GetObjectManager().Push(object_id, c_id)); });
+        }));
+    RAY_CHECK_OK(c.GetObjectManager().WaitForRange(
+        object_id, 0, kChunkSize,
+        [&](std::shared_ptr<const uint8_t> data, const ray::Status &status) {
+          RAY_CHECK_OK(status);
+          record_first_chunk();
+        }));
+  } else {
+    // Forward the object once B has all of it.
+    RAY_CHECK_OK(b.GetObjectManager().SubscribeObjAdded(
+        [&](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            if (object_info.object_id == object_id) {
+              RAY_CHECK_OK(b.GetObjectManager().Push(object_id, c_id));
+            }
+          }
+        }));
+  }
+  RAY_CHECK_OK(a.GetObjectManager().SubscribeObjAdded(
+      [&](const std::vector<LocalObjectInfo> &objects) {
+        for (const auto &object_info : objects) {
+          if (object_info.object_id == object_id) {
+            start = Clock::now();
+            RAY_CHECK_OK(b.GetObjectManager().Pull(object_id));
+          }
+        }
+      }));
+
+  // Put the object once all three nodes know about each other.
+  int num_connected = 0;
+  a.GetGcsClient().client_table().RegisterClientAddedCallback(
+      [&](gcs::AsyncGcsClient *client, const ClientID &id, const ClientTableDataT &data) {
+        if (++num_connected == 3) {
+          a.PutObject(object_id, kObjectSize);
+        }
+      });
+  main_service.run();
+
+  nodes.clear();
+  for (const auto &store_socket_name : store_socket_names) {
+    StopStore(store_socket_name);
+  }
+  return times;
+}
+
+}  // namespace
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s store_executable\n", argv[0]);
+    return 1;
+  }
+  ray::store_executable = argv[1];
+  printf("Relaying a %lluMiB object in %lluMiB chunks from A through B to C\n",
+         static_cast<unsigned long long>(ray::kObjectSize >> 20),
+         static_cast<unsigned long long>(ray::kChunkSize >> 20));
+  printf("%-14s %18s %18s\n", "mode", "first chunk (ms)", "whole object (ms)");
+  for (bool streaming : {false, true}) {
+    ray::RelayTimes times = ray::RelayObject(streaming);
+    printf("%-14s %18.1f %18.1f\n", streaming ? "streaming" : "store-and-send",
+           times.first_chunk_ms, times.whole_object_ms);
+  }
+  return 0;
+}
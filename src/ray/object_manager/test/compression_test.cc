@@ -0,0 +1,90 @@
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/compression.h"
+
+namespace ray {
+
+namespace {
+
+/// Data that compresses well: runs of repeated words.
+std::vector<uint8_t> MakeCompressibleData(uint64_t size) {
+  const std::string words = "the object manager pushes chunks of plasma objects ";
+  std::vector<uint8_t> data(size);
+  for (uint64_t i = 0; i < size; i++) {
+    data[i] = words[(i / 3) % words.size()];
+  }
+  return data;
+}
+
+/// Data that does not compress at all.
+std::vector<uint8_t> MakeRandomData(uint64_t size) {
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> data(size);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(distribution(generator));
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(CompressionTest, TestRoundTrip) {
+  for (auto codec : SupportedCompressionCodecs()) {
+    for (uint64_t size : {1, 1000, 1024 * 1024}) {
+      auto data = MakeCompressibleData(size);
+      std::vector<uint8_t> compressed;
+      ASSERT_TRUE(Compress(codec, data.data(), data.size(), &compressed).ok());
+      std::vector<uint8_t> decompressed(size);
+      ASSERT_TRUE(Decompress(codec, compressed.data(), compressed.size(),
+                             decompressed.data(), decompressed.size())
+                      .ok());
+      ASSERT_EQ(data, decompressed);
+    }
+  }
+}
+
+TEST(CompressionTest, TestShouldCompress) {
+  for (auto codec : SupportedCompressionCodecs()) {
+    ASSERT_TRUE(ShouldCompress(codec, MakeCompressibleData(1024 * 1024).data(),
+                               1024 * 1024));
+    ASSERT_FALSE(ShouldCompress(codec, MakeRandomData(1024 * 1024).data(), 1024 * 1024));
+    ASSERT_FALSE(ShouldCompress(codec, nullptr, 0));
+  }
+}
+
+TEST(CompressionTest, TestCorruptData) {
+  for (auto codec : SupportedCompressionCodecs()) {
+    auto data = MakeCompressibleData(64 * 1024);
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE(Compress(codec, data.data(), data.size(), &compressed).ok());
+    std::vector<uint8_t> decompressed(data.size());
+    // The data must decompress to exactly the size of the chunk.
+    ASSERT_FALSE(Decompress(codec, compressed.data(), compressed.size(),
+                            decompressed.data(), decompressed.size() - 1)
+                     .ok());
+    // Truncated data is detected.
+    ASSERT_FALSE(Decompress(codec, compressed.data(), compressed.size() / 2,
+                            decompressed.data(), decompressed.size())
+                     .ok());
+  }
+}
+
+TEST(CompressionTest, TestUnsupportedCodec) {
+  auto data = MakeCompressibleData(1000);
+  std::vector<uint8_t> compressed;
+  ASSERT_TRUE(Compress(CompressionCodec::CompressionCodec_None, data.data(), data.size(),
+                       &compressed)
+                  .IsInvalid());
+  ASSERT_FALSE(ShouldCompress(CompressionCodec::CompressionCodec_None, data.data(),
+                              data.size()));
+  std::vector<uint8_t> decompressed(data.size());
+  ASSERT_TRUE(Decompress(static_cast<CompressionCodec>(100), data.data(), data.size(),
+                         decompressed.data(), decompressed.size())
+                  .IsIOError());
+}
+
+}  // namespace ray
@@ -0,0 +1,185 @@
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/object_buffer_pool.h"
+
+namespace ray {
+
+std::string store_executable;
+
+/// The readers of an object's byte ranges, which record what they read.
+struct RangeReader {
+  ObjectBufferPool::RangeCallback Callback() {
+    return [this](std::shared_ptr<const uint8_t> data, const ray::Status &status) {
+      if (status.ok()) {
+        data_.push_back(*data);
+      }
+      statuses_.push_back(status);
+    };
+  }
+
+  std::vector<uint8_t> data_;
+  std::vector<ray::Status> statuses_;
+};
+
+class ObjectBufferPoolTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    store_id_ = "/tmp/store" + UniqueID::from_random().hex();
+    std::string plasma_command = store_executable + " -m 100000000 -s " + store_id_ +
+                                 " 1> /dev/null 2> /dev/null &" + " echo $! > " +
+                                 store_id_ + ".pid";
+    ASSERT_EQ(system(plasma_command.c_str()), 0);
+    sleep(1);
+    pool_.reset(new ObjectBufferPool(store_id_, kChunkSize, 0));
+    ARROW_CHECK_OK(client_.Connect(store_id_, "", plasma::kPlasmaDefaultReleaseDelay));
+  }
+
+  void TearDown() {
+    ARROW_CHECK_OK(client_.Disconnect());
+    pool_.reset();
+    std::string kill_command = "kill -9 `cat " + store_id_ + ".pid`";
+    ASSERT_EQ(system(kill_command.c_str()), 0);
+  }
+
+  /// Receive a chunk of an object, whose bytes are all set to the chunk index.
+  void ReceiveChunk(const ObjectID &object_id, uint64_t chunk_index) {
+    auto chunk_status = pool_->CreateChunk(object_id, kDataSize, kMetadataSize,
+                                           chunk_index);
+    ASSERT_TRUE(chunk_status.second.ok());
+    ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+    std::memset(chunk_info.data, static_cast<int>(chunk_index), chunk_info.buffer_length);
+    pool_->SealChunk(object_id, chunk_index);
+  }
+
+ protected:
+  static constexpr uint64_t kChunkSize = 1000;
+  /// The size of an object's data and metadata, which is split into four chunks.
+  static constexpr uint64_t kDataSize = 3501;
+  static constexpr uint64_t kMetadataSize = 1;
+
+  std::string store_id_;
+  std::unique_ptr<ObjectBufferPool> pool_;
+  plasma::PlasmaClient client_;
+};
+
+TEST_F(ObjectBufferPoolTest, TestWaitForReceivedRange) {
+  ObjectID object_id = ObjectID::from_random();
+  RangeReader start, middle, end, past_end;
+  pool_->WaitForRange(object_id, 0, 500, start.Callback());
+  pool_->WaitForRange(object_id, 1500, 1000, middle.Callback());
+  pool_->WaitForRange(object_id, 3000, kDataSize - 3000, end.Callback());
+  // The chunks after the first one do not let any range be read.
+  ReceiveChunk(object_id, 1);
+  ASSERT_TRUE(start.statuses_.empty());
+  ReceiveChunk(object_id, 0);
+  ASSERT_EQ(start.data_, std::vector<uint8_t>({0}));
+  ASSERT_TRUE(middle.statuses_.empty());
+  // Ranges that can already be read, or never can, are handled right away.
+  pool_->WaitForRange(object_id, kDataSize, 1, past_end.Callback());
+  ASSERT_EQ(past_end.statuses_.size(), 1U);
+  ASSERT_TRUE(past_end.statuses_[0].IsInvalid());
+  pool_->WaitForRange(object_id, 1000, 10, start.Callback());
+  ASSERT_EQ(start.data_, std::vector<uint8_t>({0, 1}));
+  ReceiveChunk(object_id, 2);
+  ASSERT_EQ(middle.data_, std::vector<uint8_t>({1}));
+  ASSERT_TRUE(end.statuses_.empty());
+  // The last range is read before the object is sealed.
+  ReceiveChunk(object_id, 3);
+  ASSERT_EQ(end.data_, std::vector<uint8_t>({3}));
+  bool has_object = false;
+  ARROW_CHECK_OK(client_.Contains(object_id.to_plasma_id(), &has_object));
+  ASSERT_TRUE(has_object);
+}
+
+TEST_F(ObjectBufferPoolTest, TestWaitForLocalObject) {
+  ObjectID object_id = ObjectID::from_random();
+  RangeReader reader;
+  pool_->WaitForRange(object_id, 10, 10, reader.Callback());
+  // The object is put by another client.
+  std::shared_ptr<Buffer> data;
+  uint8_t metadata[] = {5};
+  ARROW_CHECK_OK(
+      client_.Create(object_id.to_plasma_id(), 100, metadata, sizeof(metadata), &data));
+  std::memset(data->mutable_data(), 7, 100);
+  ARROW_CHECK_OK(client_.Seal(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(client_.Release(object_id.to_plasma_id()));
+  ASSERT_TRUE(reader.statuses_.empty());
+  pool_->HandleObjectLocal(object_id);
+  ASSERT_EQ(reader.data_, std::vector<uint8_t>({7}));
+  // Later readers of the sealed object are handled right away.
+  pool_->WaitForRange(object_id, 100, 1, reader.Callback());
+  ASSERT_EQ(reader.data_, std::vector<uint8_t>({7, 5}));
+}
+
+TEST_F(ObjectBufferPoolTest, TestCancelWaitForRange) {
+  ObjectID object_id = ObjectID::from_random();
+  RangeReader reader;
+  pool_->WaitForRange(object_id, 0, kDataSize, reader.Callback());
+  ReceiveChunk(object_id, 0);
+  pool_->CancelCreate(object_id);
+  ASSERT_EQ(reader.statuses_.size(), 1U);
+  ASSERT_TRUE(reader.statuses_[0].IsIOError());
+  // Readers of objects whose pull is canceled before any chunk arrives fail too.
+  ObjectID other_object_id = ObjectID::from_random();
+  pool_->WaitForRange(other_object_id, 0, 1, reader.Callback());
+  pool_->CancelCreate(other_object_id);
+  ASSERT_EQ(reader.statuses_.size(), 2U);
+  ASSERT_TRUE(reader.statuses_[1].IsIOError());
+  ASSERT_TRUE(reader.data_.empty());
+}
+
+TEST_F(ObjectBufferPoolTest, TestGetCreateSizes) {
+  ObjectID object_id = ObjectID::from_random();
+  uint64_t data_size = 0;
+  uint64_t metadata_size = 0;
+  ASSERT_FALSE(pool_->GetCreateSizes(object_id, &data_size, &metadata_size));
+  ReceiveChunk(object_id, 2);
+  ASSERT_TRUE(pool_->GetCreateSizes(object_id, &data_size, &metadata_size));
+  ASSERT_TRUE(data_size == kDataSize);
+  ASSERT_TRUE(metadata_size == kMetadataSize);
+  // Objects whose pull is canceled, and sealed objects, are not being received.
+  pool_->CancelCreate(object_id);
+  ASSERT_FALSE(pool_->GetCreateSizes(object_id, &data_size, &metadata_size));
+  ObjectID other_object_id = ObjectID::from_random();
+  for (uint64_t chunk_index = 0; chunk_index < 4; chunk_index++) {
+    ReceiveChunk(other_object_id, chunk_index);
+  }
+  ASSERT_FALSE(pool_->GetCreateSizes(other_object_id, &data_size, &metadata_size));
+}
+
+TEST_F(ObjectBufferPoolTest, TestRangeReferencePinsBuffer) {
+  ObjectID object_id = ObjectID::from_random();
+  std::shared_ptr<const uint8_t> range;
+  RangeReader nested;
+  pool_->WaitForRange(object_id, 0, 10, [this, &range, &nested, object_id](
+                                            std::shared_ptr<const uint8_t> data,
+                                            const ray::Status &status) {
+    ASSERT_TRUE(status.ok());
+    range = data;
+    // The pool is not locked while the callback runs.
+    pool_->WaitForRange(object_id, 0, 1, nested.Callback());
+  });
+  ReceiveChunk(object_id, 0);
+  ASSERT_EQ(nested.data_, std::vector<uint8_t>({0}));
+  // The buffer is not released while the reference is held, even once the
+  // create is canceled, so no new chunks can be created for the object.
+  pool_->CancelCreate(object_id);
+  ASSERT_EQ(range.get()[9], 0);
+  ASSERT_FALSE(pool_->CreateChunk(object_id, kDataSize, kMetadataSize, 1).second.ok());
+  range.reset();
+  ReceiveChunk(object_id, 1);
+  pool_->CancelCreate(object_id);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ray::store_executable = std::string(argv[1]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,412 @@
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/object_manager.h"
+
+namespace ray {
+
+using boost::asio::ip::tcp;
+
+static inline void flushall_redis(void) {
+  redisContext *context = redisConnect("127.0.0.1", 6379);
+  freeReplyObject(redisCommand(context, "FLUSHALL"));
+  redisFree(context);
+}
+
+std::string store_executable;
+
+/// Forwards the connections that it accepts to a server, and drops some of them
+/// partway through, as if the network failed.
+class FaultyProxy {
+ public:
+  /// \param io_service The service that the proxy runs on.
+  /// \param drop_after_bytes The number of bytes to forward from the client on
+  /// each connection before dropping it, in the order that connections are
+  /// accepted. Connections beyond these are never dropped.
+  FaultyProxy(boost::asio::io_service &io_service,
+              const std::vector<size_t> &drop_after_bytes)
+      : io_service_(io_service),
+        acceptor_(io_service, tcp::endpoint(tcp::v4(), 0)),
+        drop_after_bytes_(drop_after_bytes),
+        num_accepted_(0),
+        num_dropped_(0) {}
+
+  /// Start forwarding connections to the server.
+  void Start(unsigned short server_port) {
+    server_endpoint_ =
+        tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), server_port);
+    DoAccept();
+  }
+
+  unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+  int num_dropped() const { return num_dropped_; }
+
+ private:
+  struct Session {
+    Session(boost::asio::io_service &io_service, bool drop, size_t drop_after_bytes)
+        : client(io_service),
+          server(io_service),
+          drop(drop),
+          drop_after_bytes(drop_after_bytes),
+          num_bytes_forwarded(0) {}
+    tcp::socket client;
+    tcp::socket server;
+    std::array<uint8_t, 4096> client_buffer;
+    std::array<uint8_t, 4096> server_buffer;
+    bool drop;
+    size_t drop_after_bytes;
+    size_t num_bytes_forwarded;
+  };
+
+  void DoAccept() {
+    size_t index = num_accepted_++;
+    bool drop = index < drop_after_bytes_.size();
+    auto session = std::make_shared<Session>(
+        io_service_, drop, drop ? drop_after_bytes_[index] : 0);
+    acceptor_.async_accept(session->client,
+                           [this, session](const boost::system::error_code &error) {
+                             if (error) {
+                               return;
+                             }
+                             session->server.connect(server_endpoint_);
+                             Forward(session, session->client, session->server,
+                                     session->client_buffer, true);
+                             Forward(session, session->server, session->client,
+                                     session->server_buffer, false);
+                             DoAccept();
+                           });
+  }
+
+  void Forward(std::shared_ptr<Session> session, tcp::socket &from, tcp::socket &to,
+               std::array<uint8_t, 4096> &buffer, bool from_client) {
+    from.async_read_some(
+        boost::asio::buffer(buffer), [this, session, &from, &to, &buffer, from_client](
+                                         const boost::system::error_code &error,
+                                         size_t num_bytes) {
+          if (error) {
+            Close(session);
+            return;
+          }
+          if (from_client && session->drop) {
+            session->num_bytes_forwarded += num_bytes;
+            if (session->num_bytes_forwarded > session->drop_after_bytes) {
+              num_dropped_++;
+              Close(session);
+              return;
+            }
+          }
+          boost::asio::async_write(
+              to, boost::asio::buffer(buffer, num_bytes),
+              [this, session, &from, &to, &buffer, from_client](
+                  const boost::system::error_code &error, size_t) {
+                if (error) {
+                  Close(session);
+                  return;
+                }
+                Forward(session, from, to, buffer, from_client);
+              });
+        });
+  }
+
+  void Close(std::shared_ptr<Session> session) {
+    boost::system::error_code ec;
+    session->client.close(ec);
+    session->server.close(ec);
+  }
+
+  boost::asio::io_service &io_service_;
+  tcp::acceptor acceptor_;
+  tcp::endpoint server_endpoint_;
+  const std::vector<size_t> drop_after_bytes_;
+  size_t num_accepted_;
+  int num_dropped_;
+};
+
+class MockServer {
+ public:
+  /// \param advertised_port The port that other object managers are told to
+  /// connect to, or 0 to use the port that the server listens on.
+  MockServer(boost::asio::io_service &main_service,
+             const ObjectManagerConfig &object_manager_config,
+             std::shared_ptr<gcs::AsyncGcsClient> gcs_client,
+             unsigned short advertised_port)
+      : object_manager_acceptor_(main_service, tcp::endpoint(tcp::v4(), 0)),
+        object_manager_socket_(main_service),
+        gcs_client_(gcs_client),
+        object_manager_(main_service, object_manager_config, gcs_client) {
+    RAY_CHECK_OK(RegisterGcs(main_service, advertised_port));
+    // Start listening for clients.
+    DoAcceptObjectManager();
+  }
+
+  ~MockServer() { RAY_CHECK_OK(gcs_client_->client_table().Disconnect()); }
+
+  unsigned short port() const { return object_manager_acceptor_.local_endpoint().port(); }
+
+ private:
+  ray::Status RegisterGcs(boost::asio::io_service &io_service,
+                          unsigned short advertised_port) {
+    RAY_RETURN_NOT_OK(gcs_client_->Connect("127.0.0.1", 6379));
+    RAY_RETURN_NOT_OK(gcs_client_->Attach(io_service));
+
+    tcp::endpoint endpoint = object_manager_acceptor_.local_endpoint();
+    std::string ip = endpoint.address().to_string();
+    unsigned short object_manager_port =
+        advertised_port != 0 ? advertised_port : endpoint.port();
+
+    ClientTableDataT client_info = gcs_client_->client_table().GetLocalClient();
+    client_info.node_manager_address = ip;
+    client_info.node_manager_port = object_manager_port;
+    client_info.object_manager_port = object_manager_port;
+    ray::Status status = gcs_client_->client_table().Connect(client_info);
+    object_manager_.RegisterGcs();
+    return status;
+  }
+
+  void DoAcceptObjectManager() {
+    object_manager_acceptor_.async_accept(
+        object_manager_socket_, boost::bind(&MockServer::HandleAcceptObjectManager, this,
+                                            boost::asio::placeholders::error));
+  }
+
+  void HandleAcceptObjectManager(const boost::system::error_code &error) {
+    ClientHandler<tcp> client_handler =
+        [this](TcpClientConnection &client) { object_manager_.ProcessNewClient(client); };
+    MessageHandler<tcp> message_handler = [this](
+        std::shared_ptr<TcpClientConnection> client, int64_t message_type,
+        const uint8_t *message) {
+      object_manager_.ProcessClientMessage(client, message_type, message);
+    };
+    // Accept a new local client and dispatch it to the node manager.
+    auto new_connection = TcpClientConnection::Create(client_handler, message_handler,
+                                                      std::move(object_manager_socket_));
+    DoAcceptObjectManager();
+  }
+
+  friend class TestObjectManagerFaults;
+
+  tcp::acceptor object_manager_acceptor_;
+  tcp::socket object_manager_socket_;
+  std::shared_ptr<gcs::AsyncGcsClient> gcs_client_;
+  ObjectManager object_manager_;
+};
+
+/// Transfers objects from server 1 to server 2 through a proxy that drops
+/// connections to server 2.
+class TestObjectManagerFaults : public ::testing::Test {
+ public:
+  TestObjectManagerFaults() : timer_(main_service), num_connected_clients_(0) {}
+
+  std::string StartStore(const std::string &id) {
+    std::string store_id = "/tmp/store";
+    store_id = store_id + id;
+    std::string store_pid = store_id + ".pid";
+    std::string plasma_command = store_executable + " -m 1000000000 -s " + store_id +
+                                 " 1> /dev/null 2> /dev/null &" + " echo $! > " +
+                                 store_pid;
+
+    RAY_LOG(DEBUG) << plasma_command;
+    int ec = system(plasma_command.c_str());
+    RAY_CHECK(ec == 0);
+    sleep(1);
+    return store_id;
+  }
+
+  void StopStore(std::string store_id) {
+    std::string store_pid = store_id + ".pid";
+    std::string kill_1 = "kill -9 `cat " + store_pid + "`";
+    ASSERT_TRUE(!system(kill_1.c_str()));
+  }
+
+  /// Start the servers, with the given connections to server 2 dropped.
+  void StartServers(const std::vector<size_t> &drop_after_bytes) {
+    flushall_redis();
+
+    store_id_1 = StartStore(UniqueID::from_random().hex());
+    store_id_2 = StartStore(UniqueID::from_random().hex());
+
+    ObjectManagerConfig om_config;
+    om_config.pull_timeout_ms = 1;
+    om_config.max_sends = 2;
+    om_config.max_receives = 2;
+    om_config.object_chunk_size = kChunkSize;
+    om_config.max_push_retries = 1000;
+    om_config.max_inflight_pull_bytes = static_cast<uint64_t>(std::pow(10, 9));
+    om_config.chunk_timeout_ms = kChunkTimeoutMs;
+    om_config.max_pull_attempts = kMaxPullAttempts;
+    om_config.compression_codec = CompressionCodec::CompressionCodec_None;
+    om_config.compression_min_chunk_bytes = 0;
+    om_config.streaming = false;
+
+    gcs_client_1 = std::shared_ptr<gcs::AsyncGcsClient>(new gcs::AsyncGcsClient());
+    om_config.store_socket_name = store_id_1;
+    server1.reset(new MockServer(main_service, om_config, gcs_client_1, 0));
+
+    proxy.reset(new FaultyProxy(main_service, drop_after_bytes));
+    gcs_client_2 = std::shared_ptr<gcs::AsyncGcsClient>(new gcs::AsyncGcsClient());
+    om_config.store_socket_name = store_id_2;
+    server2.reset(new MockServer(main_service, om_config, gcs_client_2, proxy->port()));
+    proxy->Start(server2->port());
+
+    ARROW_CHECK_OK(client1.Connect(store_id_1, "", plasma::kPlasmaDefaultReleaseDelay));
+    ARROW_CHECK_OK(client2.Connect(store_id_2, "", plasma::kPlasmaDefaultReleaseDelay));
+  }
+
+  void TearDown() {
+    arrow::Status client1_status = client1.Disconnect();
+    arrow::Status client2_status = client2.Disconnect();
+    ASSERT_TRUE(client1_status.ok() && client2_status.ok());
+
+    this->server1.reset();
+    this->server2.reset();
+    this->proxy.reset();
+
+    StopStore(store_id_1);
+    StopStore(store_id_2);
+  }
+
+  /// Run the test once both servers are connected to the GCS, and stop after
+  /// timeout_ms if the test has not stopped the main service by then.
+  void Run(std::function<void()> test, int64_t timeout_ms) {
+    client_id_1 = gcs_client_1->client_table().GetLocalClientId();
+    client_id_2 = gcs_client_2->client_table().GetLocalClientId();
+    gcs_client_1->client_table().RegisterClientAddedCallback([this, test](
+        gcs::AsyncGcsClient *client, const ClientID &id, const ClientTableDataT &data) {
+      ClientID parsed_id = ClientID::from_binary(data.client_id);
+      if (parsed_id == client_id_1 || parsed_id == client_id_2) {
+        num_connected_clients_ += 1;
+      }
+      if (num_connected_clients_ == 2) {
+        test();
+      }
+    });
+    timer_.expires_from_now(boost::posix_time::milliseconds(timeout_ms));
+    timer_.async_wait([this](const boost::system::error_code &error) {
+      if (!error) {
+        timed_out_ = true;
+        main_service.stop();
+      }
+    });
+    timed_out_ = false;
+    main_service.run();
+  }
+
+  /// Write an object whose data is different in every chunk.
+  ObjectID WriteObject(plasma::PlasmaClient &client, int64_t data_size) {
+    ObjectID object_id = ObjectID::from_random();
+    uint8_t metadata[] = {5};
+    std::shared_ptr<Buffer> data;
+    ARROW_CHECK_OK(client.Create(object_id.to_plasma_id(), data_size, metadata,
+                                 sizeof(metadata), &data));
+    for (int64_t i = 0; i < data_size; i++) {
+      data->mutable_data()[i] = static_cast<uint8_t>(i * 7 + i / kChunkSize);
+    }
+    ARROW_CHECK_OK(client.Seal(object_id.to_plasma_id()));
+    ARROW_CHECK_OK(client.Release(object_id.to_plasma_id()));
+    return object_id;
+  }
+
+  /// Write an object to the store of server 1, and pull it to server 2.
+  ObjectID WriteAndPullObject() {
+    ObjectID object_id = WriteObject(client1, kObjectSize);
+    RAY_CHECK_OK(server2->object_manager_.Pull(object_id));
+    return object_id;
+  }
+
+  /// Stop the main service once the given object is local to server 2.
+  void StopWhenLocal(const ObjectID *object_id) {
+    RAY_CHECK_OK(server2->object_manager_.SubscribeObjAdded(
+        [this, object_id](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            if (object_info.object_id == *object_id) {
+              main_service.stop();
+            }
+          }
+        }));
+  }
+
+  void CompareObjects(const ObjectID &object_id) {
+    plasma::ObjectBuffer object_buffer_1;
+    plasma::ObjectBuffer object_buffer_2;
+    plasma::ObjectID plasma_id = object_id.to_plasma_id();
+    ARROW_CHECK_OK(client1.Get(&plasma_id, 1, 0, &object_buffer_1));
+    ARROW_CHECK_OK(client2.Get(&plasma_id, 1, 0, &object_buffer_2));
+    ASSERT_EQ(object_buffer_1.data->size(), object_buffer_2.data->size());
+    ASSERT_EQ(object_buffer_1.metadata->size(), object_buffer_2.metadata->size());
+    ASSERT_EQ(std::memcmp(object_buffer_1.data->data(), object_buffer_2.data->data(),
+                          object_buffer_1.data->size()),
+              0);
+    ARROW_CHECK_OK(client1.Release(plasma_id));
+    ARROW_CHECK_OK(client2.Release(plasma_id));
+  }
+
+ protected:
+  static constexpr uint64_t kChunkSize = 1000;
+  static constexpr int64_t kObjectSize = 100 * kChunkSize;
+  static constexpr int kChunkTimeoutMs = 100;
+  static constexpr int kMaxPullAttempts = 3;
+
+  boost::asio::io_service main_service;
+  boost::asio::deadline_timer timer_;
+  bool timed_out_;
+  int num_connected_clients_;
+  std::shared_ptr<gcs::AsyncGcsClient> gcs_client_1;
+  std::shared_ptr<gcs::AsyncGcsClient> gcs_client_2;
+  std::unique_ptr<MockServer> server1;
+  std::unique_ptr<MockServer> server2;
+  std::unique_ptr<FaultyProxy> proxy;
+  ClientID client_id_1;
+  ClientID client_id_2;
+
+  plasma::PlasmaClient client1;
+  plasma::PlasmaClient client2;
+
+  std::string store_id_1;
+  std::string store_id_2;
+};
+
+TEST_F(TestObjectManagerFaults, TestResumeAfterDroppedConnection) {
+  // Drop the first transfer connection after part of the object was sent.
+  StartServers({kObjectSize / 4});
+  ObjectID object_id;
+  StopWhenLocal(&object_id);
+  Run([this, &object_id]() { object_id = WriteAndPullObject(); }, 10000);
+  ASSERT_FALSE(timed_out_);
+  ASSERT_EQ(proxy->num_dropped(), 1);
+  CompareObjects(object_id);
+}
+
+TEST_F(TestObjectManagerFaults, TestAbortAfterMaxAttempts) {
+  // Drop the first transfer connection after part of the object was sent, and
+  // drop every later connection before anything is forwarded.
+  std::vector<size_t> drop_after_bytes(10000, 0);
+  drop_after_bytes[0] = kObjectSize / 4;
+  StartServers(drop_after_bytes);
+  ObjectID object_id;
+  // Each attempt is given between one and two timeouts to make progress.
+  Run([this, &object_id]() { object_id = WriteAndPullObject(); },
+      (2 * kMaxPullAttempts + 20) * kChunkTimeoutMs);
+  ASSERT_TRUE(timed_out_);
+  bool has_object = true;
+  ARROW_CHECK_OK(client2.Contains(object_id.to_plasma_id(), &has_object));
+  ASSERT_FALSE(has_object);
+  // The partially received object was discarded, so it can be created again.
+  std::shared_ptr<Buffer> data;
+  ARROW_CHECK_OK(
+      client2.Create(object_id.to_plasma_id(), kObjectSize, nullptr, 0, &data));
+  ARROW_CHECK_OK(client2.Release(object_id.to_plasma_id()));
+  ARROW_CHECK_OK(client2.Abort(object_id.to_plasma_id()));
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ray::store_executable = std::string(argv[1]);
+  return RUN_ALL_TESTS();
+}
@@ -125,6 +125,9 @@ class TestObjectManagerBase : public ::testing::Test {
     int max_receives = 2;
     uint64_t object_chunk_size = static_cast<uint64_t>(std::pow(10, 3));
     int max_push_retries = 1000;
+    uint64_t max_inflight_pull_bytes = static_cast<uint64_t>(std::pow(10, 9));
+    int chunk_timeout_ms = 1000;
+    int max_pull_attempts = 5;
 
     // start first server
     gcs_client_1 = std::shared_ptr<gcs::AsyncGcsClient>(new gcs::AsyncGcsClient());
@@ -135,6 +138,12 @@ class TestObjectManagerBase : public ::testing::Test {
     om_config_1.max_receives = max_receives;
     om_config_1.object_chunk_size = object_chunk_size;
     om_config_1.max_push_retries = max_push_retries;
+    om_config_1.max_inflight_pull_bytes = max_inflight_pull_bytes;
+    om_config_1.chunk_timeout_ms = chunk_timeout_ms;
+    om_config_1.max_pull_attempts = max_pull_attempts;
+    om_config_1.compression_codec = CompressionCodec::CompressionCodec_None;
+    om_config_1.compression_min_chunk_bytes = 0;
+    om_config_1.streaming = false;
     server1.reset(new MockServer(main_service, om_config_1, gcs_client_1));
 
     // start second server
@@ -146,6 +155,12 @@ class TestObjectManagerBase : public ::testing::Test {
     om_config_2.max_receives = max_receives;
     om_config_2.object_chunk_size = object_chunk_size;
     om_config_2.max_push_retries = max_push_retries;
+    om_config_2.max_inflight_pull_bytes = max_inflight_pull_bytes;
+    om_config_2.chunk_timeout_ms = chunk_timeout_ms;
+    om_config_2.max_pull_attempts = max_pull_attempts;
+    om_config_2.compression_codec = CompressionCodec::CompressionCodec_None;
+    om_config_2.compression_min_chunk_bytes = 0;
+    om_config_2.streaming = false;
     server2.reset(new MockServer(main_service, om_config_2, gcs_client_2));
 
     // connect to stores.
@@ -253,18 +268,22 @@ class StressTestObjectManager : public TestObjectManagerBase {
   void AddTransferTestHandlers() {
     ray::Status status = ray::Status::OK();
     status = server1->object_manager_.SubscribeObjAdded(
-        [this](const ObjectInfoT &object_info) {
-          object_added_handler_1(ObjectID::from_binary(object_info.object_id));
-          if (v1.size() == num_expected_objects && v1.size() == v2.size()) {
-            TransferTestComplete();
+        [this](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            object_added_handler_1(object_info.object_id);
+            if (v1.size() == num_expected_objects && v1.size() == v2.size()) {
+              TransferTestComplete();
+            }
           }
         });
     RAY_CHECK_OK(status);
     status = server2->object_manager_.SubscribeObjAdded(
-        [this](const ObjectInfoT &object_info) {
-          object_added_handler_2(ObjectID::from_binary(object_info.object_id));
-          if (v2.size() == num_expected_objects && v1.size() == v2.size()) {
-            TransferTestComplete();
+        [this](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            object_added_handler_2(object_info.object_id);
+            if (v2.size() == num_expected_objects && v1.size() == v2.size()) {
+              TransferTestComplete();
+            }
           }
         });
     RAY_CHECK_OK(status);
@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/pull_manager.h"
+
+namespace ray {
+
+class PullManagerTest : public ::testing::Test {
+ public:
+  PullManagerTest() : pull_manager_(100, 3) {}
+
+  /// Add a pull whose locations are known.
+  ObjectID AddPull(int64_t priority, const ClientID &client_id, uint64_t size) {
+    ObjectID object_id = ObjectID::from_random();
+    EXPECT_TRUE(pull_manager_.Pull(object_id, priority));
+    pull_manager_.SetLocations(object_id, {client_id}, size);
+    return object_id;
+  }
+
+ protected:
+  PullManager pull_manager_;
+};
+
+TEST_F(PullManagerTest, TestBatchByClient) {
+  ClientID client1 = ClientID::from_random();
+  ClientID client2 = ClientID::from_random();
+  std::vector<ObjectID> client1_objects;
+  std::vector<ObjectID> client2_objects;
+  for (int i = 0; i < 3; i++) {
+    client1_objects.push_back(AddPull(2 * i, client1, 1));
+    client2_objects.push_back(AddPull(2 * i + 1, client2, 1));
+  }
+  // An object that both clients have is requested from a client that is
+  // already sent a request.
+  ObjectID shared_object = ObjectID::from_random();
+  ASSERT_TRUE(pull_manager_.Pull(shared_object, 10));
+  pull_manager_.SetLocations(shared_object, {ClientID::from_random(), client2}, 1);
+  client2_objects.push_back(shared_object);
+
+  auto requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 2);
+  ASSERT_EQ(requests[0].first, client1);
+  ASSERT_EQ(requests[0].second, client1_objects);
+  ASSERT_EQ(requests[1].first, client2);
+  ASSERT_EQ(requests[1].second, client2_objects);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 7);
+  ASSERT_FALSE(pull_manager_.HasRequests());
+  ASSERT_TRUE(pull_manager_.TakeRequests().empty());
+}
+
+TEST_F(PullManagerTest, TestPriority) {
+  ClientID client_id = ClientID::from_random();
+  ObjectID low = AddPull(2, client_id, 60);
+  ObjectID high = AddPull(1, client_id, 60);
+  // Only the higher priority object fits within the in-flight limit.
+  auto requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({high}));
+  ASSERT_FALSE(pull_manager_.HasRequests());
+  // Raising the priority of an object that was not requested yet moves it
+  // ahead of the others.
+  ObjectID urgent = AddPull(3, client_id, 60);
+  ASSERT_FALSE(pull_manager_.Pull(urgent, 0));
+  pull_manager_.HandleObjectLocal(high);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 0);
+  requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({urgent}));
+  pull_manager_.HandleObjectLocal(urgent);
+  requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({low}));
+}
+
+TEST_F(PullManagerTest, TestInflightLimit) {
+  ClientID client_id = ClientID::from_random();
+  // An object larger than the limit is requested once nothing is in flight.
+  ObjectID large = AddPull(0, client_id, 1000);
+  ObjectID small = AddPull(1, client_id, 1);
+  auto requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({large}));
+  ASSERT_EQ(pull_manager_.InflightBytes(), 1000);
+  ASSERT_FALSE(pull_manager_.HasRequests());
+  // Canceling the large object releases its bytes.
+  pull_manager_.Cancel(large);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 0);
+  requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({small}));
+  pull_manager_.HandleObjectLocal(small);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 0);
+  ASSERT_EQ(pull_manager_.NumPulls(), 0);
+}
+
+TEST_F(PullManagerTest, TestUnknownLocations) {
+  ClientID client_id = ClientID::from_random();
+  ObjectID object_id = ObjectID::from_random();
+  ASSERT_TRUE(pull_manager_.Pull(object_id, 0));
+  ASSERT_FALSE(pull_manager_.Pull(object_id, 0));
+  // Nothing is requested until the object's locations are known.
+  ASSERT_FALSE(pull_manager_.HasRequests());
+  ObjectID other = AddPull(1, client_id, 1);
+  auto requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({other}));
+  pull_manager_.SetLocations(object_id, {client_id}, 1);
+  requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].second, std::vector<ObjectID>({object_id}));
+  ASSERT_EQ(pull_manager_.NumPulls(), 2);
+}
+
+TEST_F(PullManagerTest, TestRetry) {
+  ClientID client1 = ClientID::from_random();
+  ClientID client2 = ClientID::from_random();
+  ObjectID object_id = ObjectID::from_random();
+  ASSERT_TRUE(pull_manager_.Pull(object_id, 0));
+  pull_manager_.SetLocations(object_id, {client1, client2}, 10);
+  auto requests = pull_manager_.TakeRequests();
+  ASSERT_EQ(requests.size(), 1);
+  ASSERT_EQ(requests[0].first, client1);
+  ASSERT_EQ(pull_manager_.InflightPulls(), std::vector<ObjectID>({object_id}));
+
+  ClientID client_id;
+  // The first check after a request only records the progress.
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 0, &client_id),
+            PullManager::PullCheck::WAIT);
+  // A pull that makes progress is not retried.
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::WAIT);
+  // A stalled pull is retried from the other node that has the object.
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::RETRY);
+  ASSERT_EQ(client_id, client2);
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::WAIT);
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::RETRY);
+  ASSERT_EQ(client_id, client1);
+  // Once all attempts stall, the pull fails and releases its bytes.
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::WAIT);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 10);
+  ASSERT_EQ(pull_manager_.CheckProgress(object_id, 2, &client_id),
+            PullManager::PullCheck::FAIL);
+  ASSERT_EQ(pull_manager_.InflightBytes(), 0);
+  ASSERT_EQ(pull_manager_.NumPulls(), 0);
+  ASSERT_TRUE(pull_manager_.InflightPulls().empty());
+  // The object can be pulled again.
+  ASSERT_TRUE(pull_manager_.Pull(object_id, 0));
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
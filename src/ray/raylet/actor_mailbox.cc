@@ -0,0 +1,83 @@
+#include "ray/raylet/actor_mailbox.h"
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace raylet {
+
+ActorMailbox::ActorMailbox() : handles_(), runnable_handles_(), num_tasks_(0) {}
+
+bool ActorMailbox::Push(const Task &task, int64_t next_counter) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  RAY_CHECK(spec.IsActorTask());
+  const ActorHandleID handle_id = spec.ActorHandleId();
+  auto it = handles_.find(handle_id);
+  if (it == handles_.end()) {
+    HandleQueue queue;
+    queue.next_counter = next_counter;
+    it = handles_.emplace(handle_id, std::move(queue)).first;
+  }
+  HandleQueue &queue = it->second;
+  if (spec.ActorCounter() < queue.next_counter) {
+    // The task was already taken out to be executed.
+    return false;
+  }
+  size_t index = spec.ActorCounter() - queue.next_counter;
+  if (index >= queue.slots.size()) {
+    queue.slots.resize(index + 1);
+  } else if (queue.slots[index] != nullptr) {
+    return false;
+  }
+  queue.slots[index].reset(new Task(task));
+  num_tasks_++;
+  if (index == 0) {
+    runnable_handles_.push_back(handle_id);
+  }
+  return true;
+}
+
+bool ActorMailbox::HasRunnableTask() const { return !runnable_handles_.empty(); }
+
+const Task &ActorMailbox::FrontRunnableTask() const {
+  RAY_CHECK(!runnable_handles_.empty());
+  return *handles_.find(runnable_handles_.front())->second.slots.front();
+}
+
+Task ActorMailbox::PopRunnableTask() {
+  RAY_CHECK(!runnable_handles_.empty());
+  const ActorHandleID handle_id = runnable_handles_.front();
+  runnable_handles_.pop_front();
+  HandleQueue &queue = handles_.find(handle_id)->second;
+  Task task(std::move(*queue.slots.front()));
+  queue.slots.pop_front();
+  queue.next_counter++;
+  num_tasks_--;
+  // If the handle's next task is already here, let the other handles go
+  // first.
+  if (!queue.slots.empty() && queue.slots.front() != nullptr) {
+    runnable_handles_.push_back(handle_id);
+  }
+  return task;
+}
+
+void ActorMailbox::Requeue(const Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  auto it = handles_.find(spec.ActorHandleId());
+  RAY_CHECK(it != handles_.end());
+  HandleQueue &queue = it->second;
+  RAY_CHECK(spec.ActorCounter() == queue.next_counter - 1);
+  bool was_runnable = !queue.slots.empty() && queue.slots.front() != nullptr;
+  queue.slots.emplace_front(new Task(task));
+  queue.next_counter--;
+  num_tasks_++;
+  if (!was_runnable) {
+    runnable_handles_.push_front(spec.ActorHandleId());
+  }
+}
+
+size_t ActorMailbox::NumTasks() const { return num_tasks_; }
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,97 @@
+#ifndef RAY_RAYLET_ACTOR_MAILBOX_H
+#define RAY_RAYLET_ACTOR_MAILBOX_H
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "ray/id.h"
+#include "ray/raylet/task.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// \class ActorMailbox
+///
+/// The tasks for a local actor whose arguments are ready. Each handle to the
+/// actor submits its tasks with consecutive counters, and the actor must
+/// execute them in that order, but their arguments may become ready in any
+/// order. The mailbox buffers each task until all of the handle's earlier
+/// tasks have been taken out, so that both adding a task and taking out the
+/// next one to execute take constant time. Tasks from different handles are
+/// taken out round-robin. Ordering a forked handle after its parent is left to
+/// the caller, which should only add the forked handle's first task once the
+/// tasks that the parent submitted before the fork have executed.
+class ActorMailbox {
+ public:
+  /// Create an empty mailbox.
+  ActorMailbox();
+
+  /// Add a task whose arguments are ready.
+  ///
+  /// \param task The actor task.
+  /// \param next_counter The counter of the first task from the task's handle
+  /// that the actor has not executed yet. This is only used if the mailbox has
+  /// not seen the handle before.
+  /// \return Whether the task was added. Tasks that were already added or
+  /// that were already taken out to be executed are dropped.
+  bool Push(const Task &task, int64_t next_counter);
+
+  /// Whether any task can be taken out, i.e., whether there is a task whose
+  /// handle's earlier tasks have all been taken out.
+  ///
+  /// \return Whether a task can be taken out.
+  bool HasRunnableTask() const;
+
+  /// Get the next task to execute without taking it out. There must be a
+  /// runnable task.
+  ///
+  /// \return The next task to execute.
+  const Task &FrontRunnableTask() const;
+
+  /// Take out the next task to execute. There must be a runnable task.
+  ///
+  /// \return The next task to execute.
+  Task PopRunnableTask();
+
+  /// Put back a task that was taken out but never executed, e.g. because it
+  /// was sent to an actor whose worker died. Tasks from the same handle must
+  /// be put back in the reverse of the order that they were taken out, and
+  /// they are taken out again before any other task.
+  ///
+  /// \param task The task to put back. It must be the last task from its
+  /// handle that was taken out.
+  void Requeue(const Task &task);
+
+  /// Get the number of tasks in the mailbox, including tasks that cannot be
+  /// taken out yet.
+  ///
+  /// \return The number of tasks.
+  size_t NumTasks() const;
+
+ private:
+  /// The tasks from a single handle.
+  struct HandleQueue {
+    /// The counter of the next task from the handle to take out.
+    int64_t next_counter;
+    /// The tasks from the handle, indexed by their counter minus
+    /// next_counter. A slot is empty if that task's arguments are not ready
+    /// yet.
+    std::deque<std::unique_ptr<Task>> slots;
+  };
+
+  /// The tasks, indexed by the handle that submitted them.
+  std::unordered_map<ActorHandleID, HandleQueue> handles_;
+  /// The handles whose next task is in the mailbox, in the order that their
+  /// tasks should be taken out.
+  std::deque<ActorHandleID> runnable_handles_;
+  /// The number of tasks in the mailbox.
+  size_t num_tasks_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_ACTOR_MAILBOX_H
@@ -0,0 +1,115 @@
+// Compare the cost of dispatching actor tasks in order through an ActorMailbox
+// against taking them out of a SchedulingQueue one at a time, which is how the
+// raylet dispatched actor tasks before they had a mailbox.
+//
+// Usage: actor_mailbox_benchmark [max_num_tasks]
+//
+// For each number of queued tasks from 10^3 up to max_num_tasks (10^5 by
+// default), this reports the average time per task to queue the tasks, in a
+// random order, and then to take all of them out in order.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ray/raylet/actor_mailbox.h"
+#include "ray/raylet/scheduling_queue.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+/// Create the tasks submitted by a single handle to an actor, in the order
+/// that their arguments become ready.
+std::vector<Task> MakeTasks(size_t num_tasks) {
+  std::unordered_map<std::string, double> required_resources;
+  std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  ActorID actor_id = ActorID::from_random();
+  std::vector<Task> tasks;
+  tasks.reserve(num_tasks);
+  for (size_t i = 0; i < num_tasks; i++) {
+    TaskSpecification spec(UniqueID::nil(), UniqueID::from_random(), 0, ActorID::nil(),
+                           ObjectID::nil(), actor_id, ActorHandleID::nil(), i,
+                           UniqueID::from_random(), task_arguments, 1,
+                           required_resources);
+    tasks.push_back(Task(TaskExecutionSpecification(std::vector<ObjectID>()), spec));
+  }
+  std::shuffle(tasks.begin(), tasks.end(), std::mt19937(0));
+  return tasks;
+}
+
+template <typename Function>
+double NanosPerOp(size_t num_ops, Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / num_ops;
+}
+
+void BenchmarkSchedulingQueue(const std::vector<Task> &tasks) {
+  SchedulingQueue queue;
+  std::vector<TaskID> task_ids(tasks.size());
+  size_t num_dispatched = 0;
+  double push = NanosPerOp(tasks.size(), [&]() {
+    for (const auto &task : tasks) {
+      queue.QueueReadyTasks({task});
+      const auto &spec = task.GetTaskSpecification();
+      task_ids[spec.ActorCounter()] = spec.TaskId();
+    }
+  });
+  double pop = NanosPerOp(tasks.size(), [&]() {
+    for (const auto &task_id : task_ids) {
+      num_dispatched += queue.RemoveTasks({task_id}).size();
+    }
+  });
+  if (num_dispatched != tasks.size()) {
+    std::abort();
+  }
+  printf("%10zu %-20s %10.1f %10.1f\n", tasks.size(), "SchedulingQueue", push, pop);
+}
+
+void BenchmarkActorMailbox(const std::vector<Task> &tasks) {
+  ActorMailbox mailbox;
+  int64_t next_counter = 0;
+  double push = NanosPerOp(tasks.size(), [&]() {
+    for (const auto &task : tasks) {
+      mailbox.Push(task, 0);
+    }
+  });
+  double pop = NanosPerOp(tasks.size(), [&]() {
+    while (mailbox.HasRunnableTask()) {
+      Task task = mailbox.PopRunnableTask();
+      if (task.GetTaskSpecification().ActorCounter() != next_counter) {
+        std::abort();
+      }
+      next_counter++;
+    }
+  });
+  if (static_cast<size_t>(next_counter) != tasks.size()) {
+    std::abort();
+  }
+  printf("%10zu %-20s %10.1f %10.1f\n", tasks.size(), "ActorMailbox", push, pop);
+}
+
+}  // namespace
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  size_t max_num_tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  printf("%10s %-20s %10s %10s\n", "tasks", "queue", "push", "dispatch");
+  printf("%10s %-20s %10s %10s\n", "", "", "(ns)", "(ns)");
+  for (size_t num_tasks = 1000; num_tasks <= max_num_tasks; num_tasks *= 10) {
+    auto tasks = ray::raylet::MakeTasks(num_tasks);
+    ray::raylet::BenchmarkSchedulingQueue(tasks);
+    ray::raylet::BenchmarkActorMailbox(tasks);
+  }
+  return 0;
+}
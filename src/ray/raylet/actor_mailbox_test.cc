@@ -0,0 +1,174 @@
+#include "gtest/gtest.h"
+
+#include "ray/raylet/actor_mailbox.h"
+
+namespace ray {
+
+namespace raylet {
+
+static inline Task ExampleActorTask(const ActorID &actor_id,
+                                    const ActorHandleID &actor_handle_id,
+                                    int64_t actor_counter) {
+  std::unordered_map<std::string, double> required_resources;
+  std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  auto spec = TaskSpecification(UniqueID::nil(), UniqueID::from_random(), 0,
+                                ActorID::nil(), ObjectID::nil(), actor_id,
+                                actor_handle_id, actor_counter, UniqueID::from_random(),
+                                task_arguments, 1, required_resources);
+  auto execution_spec = TaskExecutionSpecification(std::vector<ObjectID>());
+  return Task(execution_spec, spec);
+}
+
+class ActorMailboxTest : public ::testing::Test {
+ public:
+  ActorMailboxTest() : actor_id_(ActorID::from_random()), mailbox_() {}
+
+  std::vector<Task> MakeTasks(const ActorHandleID &handle_id, int64_t num_tasks) {
+    std::vector<Task> tasks;
+    for (int64_t i = 0; i < num_tasks; i++) {
+      tasks.push_back(ExampleActorTask(actor_id_, handle_id, i));
+    }
+    return tasks;
+  }
+
+  std::vector<TaskID> PopAll() {
+    std::vector<TaskID> task_ids;
+    while (mailbox_.HasRunnableTask()) {
+      TaskID front_id = mailbox_.FrontRunnableTask().GetTaskSpecification().TaskId();
+      Task task = mailbox_.PopRunnableTask();
+      EXPECT_EQ(task.GetTaskSpecification().TaskId(), front_id);
+      task_ids.push_back(front_id);
+    }
+    return task_ids;
+  }
+
+ protected:
+  ActorID actor_id_;
+  ActorMailbox mailbox_;
+};
+
+TEST_F(ActorMailboxTest, TestInOrder) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 10);
+  for (const auto &task : tasks) {
+    ASSERT_TRUE(mailbox_.Push(task, 0));
+  }
+  ASSERT_EQ(mailbox_.NumTasks(), tasks.size());
+  auto task_ids = PopAll();
+  ASSERT_EQ(task_ids.size(), tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    ASSERT_EQ(task_ids[i], tasks[i].GetTaskSpecification().TaskId());
+  }
+  ASSERT_EQ(mailbox_.NumTasks(), 0);
+}
+
+TEST_F(ActorMailboxTest, TestOutOfOrder) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 10);
+  // Every task but the first one is ready. None of them can run.
+  for (size_t i = tasks.size() - 1; i > 0; i--) {
+    ASSERT_TRUE(mailbox_.Push(tasks[i], 0));
+    ASSERT_FALSE(mailbox_.HasRunnableTask());
+  }
+  ASSERT_EQ(mailbox_.NumTasks(), tasks.size() - 1);
+  // Once the first task is ready, all of them run in order.
+  ASSERT_TRUE(mailbox_.Push(tasks[0], 0));
+  auto task_ids = PopAll();
+  ASSERT_EQ(task_ids.size(), tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    ASSERT_EQ(task_ids[i], tasks[i].GetTaskSpecification().TaskId());
+  }
+}
+
+TEST_F(ActorMailboxTest, TestGap) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 4);
+  ASSERT_TRUE(mailbox_.Push(tasks[0], 0));
+  ASSERT_TRUE(mailbox_.Push(tasks[1], 0));
+  ASSERT_TRUE(mailbox_.Push(tasks[3], 0));
+  // Only the tasks before the missing one can run.
+  ASSERT_EQ(PopAll().size(), 2);
+  ASSERT_EQ(mailbox_.NumTasks(), 1);
+  ASSERT_TRUE(mailbox_.Push(tasks[2], 0));
+  auto task_ids = PopAll();
+  ASSERT_EQ(task_ids.size(), 2);
+  ASSERT_EQ(task_ids[0], tasks[2].GetTaskSpecification().TaskId());
+  ASSERT_EQ(task_ids[1], tasks[3].GetTaskSpecification().TaskId());
+}
+
+TEST_F(ActorMailboxTest, TestDuplicates) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 3);
+  ASSERT_TRUE(mailbox_.Push(tasks[0], 0));
+  ASSERT_TRUE(mailbox_.Push(tasks[2], 0));
+  // Tasks that are already in the mailbox are dropped.
+  ASSERT_FALSE(mailbox_.Push(tasks[0], 0));
+  ASSERT_FALSE(mailbox_.Push(tasks[2], 0));
+  ASSERT_EQ(PopAll().size(), 1);
+  // Tasks that were already taken out are dropped.
+  ASSERT_FALSE(mailbox_.Push(tasks[0], 0));
+  ASSERT_TRUE(mailbox_.Push(tasks[1], 0));
+  ASSERT_EQ(PopAll().size(), 2);
+  ASSERT_EQ(mailbox_.NumTasks(), 0);
+}
+
+TEST_F(ActorMailboxTest, TestNextCounter) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 4);
+  // The actor already executed the first two tasks from the handle.
+  ASSERT_FALSE(mailbox_.Push(tasks[1], 2));
+  ASSERT_TRUE(mailbox_.Push(tasks[2], 2));
+  ASSERT_TRUE(mailbox_.Push(tasks[3], 2));
+  // The counter is only used the first time that the handle is seen.
+  ASSERT_FALSE(mailbox_.Push(tasks[0], 0));
+  ASSERT_EQ(PopAll().size(), 2);
+}
+
+TEST_F(ActorMailboxTest, TestMultipleHandles) {
+  auto handle1_tasks = MakeTasks(ActorHandleID::from_random(), 3);
+  auto handle2_tasks = MakeTasks(ActorHandleID::from_random(), 3);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(mailbox_.Push(handle1_tasks[i], 0));
+  }
+  // The second handle's tasks arrive in reverse order.
+  for (size_t i = 3; i > 0; i--) {
+    ASSERT_TRUE(mailbox_.Push(handle2_tasks[i - 1], 0));
+  }
+  // The handles take turns, and each handle's tasks run in order.
+  auto task_ids = PopAll();
+  ASSERT_EQ(task_ids.size(), 6);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(task_ids[2 * i], handle1_tasks[i].GetTaskSpecification().TaskId());
+    ASSERT_EQ(task_ids[2 * i + 1], handle2_tasks[i].GetTaskSpecification().TaskId());
+  }
+}
+
+TEST_F(ActorMailboxTest, TestRequeue) {
+  auto tasks = MakeTasks(ActorHandleID::nil(), 4);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(mailbox_.Push(tasks[i], 0));
+  }
+  // Take out the first two tasks, then put them back in reverse order.
+  Task first = mailbox_.PopRunnableTask();
+  Task second = mailbox_.PopRunnableTask();
+  mailbox_.Requeue(second);
+  mailbox_.Requeue(first);
+  ASSERT_EQ(mailbox_.NumTasks(), 3);
+  // A task that was put back is not taken out again through Push.
+  ASSERT_FALSE(mailbox_.Push(tasks[0], 0));
+  ASSERT_TRUE(mailbox_.Push(tasks[3], 0));
+  auto task_ids = PopAll();
+  ASSERT_EQ(task_ids.size(), tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    ASSERT_EQ(task_ids[i], tasks[i].GetTaskSpecification().TaskId());
+  }
+  // A task can be put back once its handle has no tasks left.
+  Task last(tasks[3]);
+  mailbox_.Requeue(last);
+  ASSERT_TRUE(mailbox_.HasRunnableTask());
+  ASSERT_EQ(PopAll().size(), 1);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,174 @@
+#include "ray/raylet/client_message_queue.h"
+
+#include "common_protocol.h"
+#include "format/common_generated.h"
+#include "ray/raylet/format/node_manager_generated.h"
+#include "ray/util/logging.h"
+
+namespace {
+
+/// Check that a task submission and the task specification inside of it are
+/// well-formed. The submission itself must already be verified.
+bool VerifySubmitTaskRequest(const ray::protocol::SubmitTaskRequest &request) {
+  const flatbuffers::String *task_spec = request.task_spec();
+  flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t *>(task_spec->data()),
+                                 task_spec->size());
+  return verifier.VerifyBuffer<TaskInfo>(nullptr);
+}
+
+}  // namespace
+
+namespace ray {
+
+namespace raylet {
+
+Task TaskFromSubmitRequest(const protocol::SubmitTaskRequest &message) {
+  TaskExecutionSpecification task_execution_spec(
+      from_flatbuf(*message.execution_dependencies()));
+  TaskSpecification task_spec(*message.task_spec());
+  return Task(task_execution_spec, task_spec);
+}
+
+ray::Status ParseClientMessage(const std::shared_ptr<LocalClientConnection> &client,
+                               int64_t message_type, const uint8_t *message_data,
+                               int64_t length, ClientMessage *message) {
+  message->client = client;
+  message->message_type = message_type;
+  message->message.clear();
+  message->tasks.clear();
+  message->read_socket = true;
+  message->drain_ring = nullptr;
+  bool valid = true;
+  switch (message_type) {
+  case protocol::MessageType_SubmitTask: {
+    flatbuffers::Verifier verifier(message_data, length);
+    valid = verifier.VerifyBuffer<protocol::SubmitTaskRequest>(nullptr);
+    if (valid) {
+      auto request = flatbuffers::GetRoot<protocol::SubmitTaskRequest>(message_data);
+      valid = VerifySubmitTaskRequest(*request);
+      if (valid) {
+        message->tasks.push_back(TaskFromSubmitRequest(*request));
+      }
+    }
+  } break;
+  case protocol::MessageType_SubmitTaskBatch: {
+    flatbuffers::Verifier verifier(message_data, length);
+    valid = verifier.VerifyBuffer<protocol::SubmitTaskBatchRequest>(nullptr);
+    if (valid) {
+      auto batch = flatbuffers::GetRoot<protocol::SubmitTaskBatchRequest>(message_data);
+      message->tasks.reserve(batch->tasks()->size());
+      for (const auto request : *batch->tasks()) {
+        if (!VerifySubmitTaskRequest(*request)) {
+          valid = false;
+          break;
+        }
+        message->tasks.push_back(TaskFromSubmitRequest(*request));
+      }
+    }
+  } break;
+  case protocol::MessageType_RegisterClientRequest: {
+    flatbuffers::Verifier verifier(message_data, length);
+    valid = verifier.VerifyBuffer<protocol::RegisterClientRequest>(nullptr);
+  } break;
+  case protocol::MessageType_RegisterSubmissionRing: {
+    flatbuffers::Verifier verifier(message_data, length);
+    valid = verifier.VerifyBuffer<protocol::RegisterSubmissionRingRequest>(nullptr);
+  } break;
+  case protocol::MessageType_ReconstructObject: {
+    flatbuffers::Verifier verifier(message_data, length);
+    valid = verifier.VerifyBuffer<protocol::ReconstructObject>(nullptr);
+  } break;
+  default:
+    // The other messages have no contents that the node manager reads.
+    break;
+  }
+  if (!valid) {
+    message->tasks.clear();
+    return ray::Status::Invalid("Malformed message of type " +
+                                std::to_string(message_type));
+  }
+  bool is_submission = message_type == protocol::MessageType_SubmitTask ||
+                       message_type == protocol::MessageType_SubmitTaskBatch;
+  if (!is_submission && length > 0) {
+    message->message.assign(message_data, message_data + length);
+  }
+  return ray::Status::OK();
+}
+
+bool ParseSubmissionRing(const std::shared_ptr<LocalClientConnection> &client,
+                         SubmissionRing &ring, int64_t max_messages,
+                         std::vector<std::unique_ptr<ClientMessage>> *messages) {
+  int64_t num_messages = 0;
+  do {
+    int64_t message_type;
+    int64_t length;
+    const uint8_t *message_data;
+    while (ring.Peek(&message_type, &length, &message_data)) {
+      if (num_messages == max_messages) {
+        // The ring is not marked as waiting, so the client does not ring the
+        // doorbell until the caller parses the rest.
+        return false;
+      }
+      num_messages++;
+      std::unique_ptr<ClientMessage> message(new ClientMessage());
+      auto status =
+          ParseClientMessage(client, message_type, message_data, length, message.get());
+      // The parsed message owns a copy of everything it needs. The client sends
+      // messages that are too large for the ring on its socket, but only once
+      // the ring is empty, and the caller reads the socket again only once the
+      // messages parsed here have been handled, so the order is kept.
+      ring.Pop();
+      if (!status.ok()) {
+        RAY_LOG(WARNING) << "Disconnecting client: " << status.ToString();
+        message->message_type = protocol::MessageType_DisconnectClient;
+        messages->push_back(std::move(message));
+        return true;
+      }
+      messages->push_back(std::move(message));
+    }
+  } while (!ring.PrepareToWait());
+  return true;
+}
+
+ClientMessageQueue::ClientMessageQueue(boost::asio::io_service &main_service,
+                                       int64_t batch_size,
+                                       const MessageHandler &message_handler)
+    : main_service_(main_service),
+      batch_size_(batch_size),
+      message_handler_(message_handler),
+      queue_(),
+      batch_pending_(false) {
+  RAY_CHECK(batch_size_ > 0);
+}
+
+void ClientMessageQueue::Push(std::unique_ptr<ClientMessage> message) {
+  queue_.Push(std::move(message));
+  // Only post a batch if none is pending. The flag is checked after the push
+  // is complete, so a pending batch that already cleared the flag is either
+  // going to see this message or is followed by the batch posted here.
+  if (!batch_pending_.exchange(true)) {
+    main_service_.post([this]() { HandleBatch(); });
+  }
+}
+
+void ClientMessageQueue::HandleBatch() {
+  // Clear the flag before popping, so that a message that is pushed after the
+  // last pop below posts another batch.
+  batch_pending_.store(false);
+  std::unique_ptr<ClientMessage> message;
+  for (int64_t i = 0; i < batch_size_; i++) {
+    if (!queue_.Pop(&message)) {
+      return;
+    }
+    message_handler_(*message);
+  }
+  // There may be more messages. Let the other events on the main thread run
+  // before handling them.
+  if (!batch_pending_.exchange(true)) {
+    main_service_.post([this]() { HandleBatch(); });
+  }
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,130 @@
+#ifndef RAY_RAYLET_CLIENT_MESSAGE_QUEUE_H
+#define RAY_RAYLET_CLIENT_MESSAGE_QUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "ray/common/client_connection.h"
+#include "ray/common/mpsc_queue.h"
+#include "ray/common/submission_ring.h"
+#include "ray/raylet/task.h"
+#include "ray/status.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// A message from a local client that was read and parsed on the I/O thread
+/// that owns the client's socket, and that is waiting to be handled on the
+/// main thread.
+struct ClientMessage {
+  /// The client that sent the message.
+  std::shared_ptr<LocalClientConnection> client;
+  /// The message type (e.g., a flatbuffer enum).
+  int64_t message_type;
+  /// The message data. This is empty for task submissions, which are parsed
+  /// into tasks instead.
+  std::vector<uint8_t> message;
+  /// The tasks of a SubmitTask or SubmitTaskBatch message, in submission order.
+  std::vector<Task> tasks;
+  /// Whether to read the next message from the client's socket once this
+  /// message has been handled. This is false for the messages from the
+  /// client's submission ring, except for the last one before the ring waits
+  /// for its doorbell again.
+  bool read_socket;
+  /// If set, run on the main thread once this message has been handled, to
+  /// parse the next messages from the client's submission ring.
+  std::function<void()> drain_ring;
+};
+
+/// Build a task from a worker's task submission.
+///
+/// \param message The submission.
+/// \return The submitted task.
+Task TaskFromSubmitRequest(const protocol::SubmitTaskRequest &message);
+
+/// Check that a message from a local client is well-formed, and do the work
+/// that does not need the node manager's state, such as building the tasks of
+/// a task submission. This may be called from any thread.
+///
+/// \param client The client that sent the message.
+/// \param message_type The message type (e.g., a flatbuffer enum).
+/// \param message_data A pointer to the message data.
+/// \param length The size in bytes of the message data.
+/// \param message The parsed message.
+/// \return Status::Invalid if the message is not a valid message of its type.
+ray::Status ParseClientMessage(const std::shared_ptr<LocalClientConnection> &client,
+                               int64_t message_type, const uint8_t *message_data,
+                               int64_t length, ClientMessage *message);
+
+/// Parse the messages in a client's submission ring, in order, and remove them
+/// from the ring. This stops after max_messages messages, or once the ring is
+/// empty and waiting for the client to ring its doorbell again. If a message is
+/// malformed, the parsed message for it disconnects the client, and nothing
+/// after it is parsed. This may be called from any thread, but only from one
+/// thread per ring.
+///
+/// \param client The client that owns the ring.
+/// \param ring The ring.
+/// \param max_messages The maximum number of messages to parse.
+/// \param messages The parsed messages are appended to this.
+/// \return True if the ring is waiting for the doorbell, or if the client must
+/// be disconnected. False if the ring may have more messages.
+bool ParseSubmissionRing(const std::shared_ptr<LocalClientConnection> &client,
+                         SubmissionRing &ring, int64_t max_messages,
+                         std::vector<std::unique_ptr<ClientMessage>> *messages);
+
+/// \class ClientMessageQueue
+///
+/// Hands the parsed messages of local clients from the I/O threads to the main
+/// thread. The I/O threads push messages without taking a lock, and the main
+/// thread handles them in batches: a push only posts a handler to the main
+/// thread when no batch is already pending, so a busy main thread picks up
+/// every message that arrived while it was handling the previous batch in one
+/// go.
+class ClientMessageQueue {
+ public:
+  using MessageHandler = std::function<void(const ClientMessage &)>;
+
+  /// Create a queue.
+  ///
+  /// \param main_service The event loop of the main thread.
+  /// \param batch_size The maximum number of messages to handle before
+  /// letting other events on the main thread run.
+  /// \param message_handler The handler to run on the main thread for each
+  /// message, in the order that the messages were pushed.
+  ClientMessageQueue(boost::asio::io_service &main_service, int64_t batch_size,
+                     const MessageHandler &message_handler);
+
+  /// Queue a message to be handled on the main thread. This may be called from
+  /// any thread.
+  ///
+  /// \param message The message.
+  void Push(std::unique_ptr<ClientMessage> message);
+
+ private:
+  /// Handle up to batch_size_ queued messages on the main thread.
+  void HandleBatch();
+
+  /// The event loop of the main thread.
+  boost::asio::io_service &main_service_;
+  /// The maximum number of messages to handle per batch.
+  const int64_t batch_size_;
+  /// The handler for each message.
+  const MessageHandler message_handler_;
+  /// The messages that have not been handled yet.
+  MpscQueue<std::unique_ptr<ClientMessage>> queue_;
+  /// Whether a call to HandleBatch is posted to the main thread and has not
+  /// started yet.
+  std::atomic<bool> batch_pending_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_CLIENT_MESSAGE_QUEUE_H
@@ -0,0 +1,280 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <boost/asio.hpp>
+
+#include "common/state/ray_config.h"
+#include "common_protocol.h"
+#include "ray/common/io_service_pool.h"
+#include "ray/raylet/client_message_queue.h"
+#include "ray/raylet/format/node_manager_generated.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+constexpr int kNumIoThreads = 4;
+constexpr int kNumWorkers = 500;
+/// The number of threads that drive the fake workers.
+constexpr int kNumDriverThreads = 10;
+constexpr int kNumTasksPerWorker = 20;
+
+/// Build a task that does nothing.
+TaskSpecification MakeNoopTask() {
+  std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  return TaskSpecification(UniqueID::nil(), UniqueID::from_random(), 0,
+                           FunctionID::nil(), task_arguments, 0, {{"CPU", 1}});
+}
+
+/// Build a SubmitTask message for a task.
+std::vector<uint8_t> MakeSubmitTaskMessage(const TaskSpecification &spec) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = protocol::CreateSubmitTaskRequest(
+      fbb, to_flatbuf(fbb, std::vector<ObjectID>()), spec.ToFlatbuffer(fbb));
+  fbb.Finish(message);
+  return std::vector<uint8_t>(fbb.GetBufferPointer(),
+                              fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+/// Write a message to a socket and block until it has been written.
+void WriteMessage(boost::asio::local::stream_protocol::socket &socket, int64_t type,
+                  const std::vector<uint8_t> &message) {
+  int64_t version = RayConfig::instance().ray_protocol_version();
+  uint64_t length = message.size();
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.push_back(boost::asio::buffer(&version, sizeof(version)));
+  buffers.push_back(boost::asio::buffer(&type, sizeof(type)));
+  buffers.push_back(boost::asio::buffer(&length, sizeof(length)));
+  buffers.push_back(boost::asio::buffer(message));
+  boost::asio::write(socket, buffers);
+}
+
+/// Read a message from a socket and return its type.
+int64_t ReadMessage(boost::asio::local::stream_protocol::socket &socket) {
+  int64_t version;
+  int64_t type;
+  uint64_t length;
+  std::vector<boost::asio::mutable_buffer> header;
+  header.push_back(boost::asio::buffer(&version, sizeof(version)));
+  header.push_back(boost::asio::buffer(&type, sizeof(type)));
+  header.push_back(boost::asio::buffer(&length, sizeof(length)));
+  boost::asio::read(socket, header);
+  std::vector<uint8_t> message(length);
+  boost::asio::read(socket, boost::asio::buffer(message));
+  return type;
+}
+
+}  // namespace
+
+TEST(ClientMessageQueueTest, ParseTest) {
+  std::shared_ptr<LocalClientConnection> client;
+  auto spec = MakeNoopTask();
+  auto submit_task = MakeSubmitTaskMessage(spec);
+  ClientMessage message;
+  // A task submission is parsed into its task.
+  RAY_CHECK_OK(ParseClientMessage(client, protocol::MessageType_SubmitTask,
+                                  submit_task.data(), submit_task.size(), &message));
+  ASSERT_EQ(message.tasks.size(), 1);
+  ASSERT_EQ(message.tasks[0].GetTaskSpecification().TaskId(), spec.TaskId());
+  ASSERT_TRUE(message.message.empty());
+  // Other messages keep their data.
+  std::vector<uint8_t> data = {1, 2, 3};
+  RAY_CHECK_OK(ParseClientMessage(client, protocol::MessageType_GetTask, data.data(),
+                                  data.size(), &message));
+  ASSERT_TRUE(message.tasks.empty());
+  ASSERT_EQ(message.message, data);
+  // Truncated and garbled submissions are rejected.
+  ASSERT_FALSE(ParseClientMessage(client, protocol::MessageType_SubmitTask,
+                                  submit_task.data(), submit_task.size() / 2, &message)
+                   .ok());
+  std::vector<uint8_t> garbage(submit_task.size(), 0xff);
+  ASSERT_FALSE(ParseClientMessage(client, protocol::MessageType_SubmitTask,
+                                  garbage.data(), garbage.size(), &message)
+                   .ok());
+  ASSERT_TRUE(message.tasks.empty());
+}
+
+TEST(ClientMessageQueueTest, ParseSubmissionRingTest) {
+  const std::string name =
+      "/ray_client_message_queue_test_" + std::to_string(getpid());
+  std::unique_ptr<SubmissionRing> producer;
+  std::unique_ptr<SubmissionRing> consumer;
+  RAY_CHECK_OK(SubmissionRing::Create(name, 1024 * 1024, &producer));
+  RAY_CHECK_OK(SubmissionRing::Open(name, &consumer));
+  std::shared_ptr<LocalClientConnection> client;
+  // Submit a few tasks and then ask for one, like a worker does.
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 5; i++) {
+    auto spec = MakeNoopTask();
+    task_ids.push_back(spec.TaskId());
+    auto submit_task = MakeSubmitTaskMessage(spec);
+    producer->Write(protocol::MessageType_SubmitTask, submit_task.size(),
+                    submit_task.data());
+  }
+  std::vector<uint8_t> data = {1, 2, 3};
+  producer->Write(protocol::MessageType_GetTask, data.size(), data.data());
+
+  // The messages are parsed in order, at most four at a time. The ring only
+  // waits for its doorbell once it is empty.
+  std::vector<std::unique_ptr<ClientMessage>> messages;
+  ASSERT_FALSE(ParseSubmissionRing(client, *consumer, 4, &messages));
+  ASSERT_EQ(messages.size(), 4);
+  ASSERT_TRUE(ParseSubmissionRing(client, *consumer, 4, &messages));
+  ASSERT_EQ(messages.size(), 6);
+  ASSERT_TRUE(consumer->IsEmpty());
+  for (int i = 0; i < 5; i++) {
+    ASSERT_EQ(messages[i]->message_type, protocol::MessageType_SubmitTask);
+    ASSERT_EQ(messages[i]->tasks.size(), 1);
+    ASSERT_EQ(messages[i]->tasks[0].GetTaskSpecification().TaskId(), task_ids[i]);
+  }
+  ASSERT_EQ(messages[5]->message_type, protocol::MessageType_GetTask);
+  ASSERT_EQ(messages[5]->message, data);
+
+  // The next message rings the doorbell. A malformed message disconnects the
+  // client, and the messages after it are not parsed.
+  std::vector<uint8_t> garbage(64, 0xff);
+  ASSERT_TRUE(producer->Write(protocol::MessageType_SubmitTask, garbage.size(),
+                              garbage.data()));
+  producer->Write(protocol::MessageType_GetTask, data.size(), data.data());
+  messages.clear();
+  ASSERT_TRUE(ParseSubmissionRing(client, *consumer, 4, &messages));
+  ASSERT_EQ(messages.size(), 1);
+  ASSERT_EQ(messages[0]->message_type, protocol::MessageType_DisconnectClient);
+  ASSERT_TRUE(messages[0]->tasks.empty());
+}
+
+/// Many fake workers that each submit a no-op task and then ask for a task to
+/// execute, as fast as they can. Their sockets are spread across a pool of I/O
+/// threads that parse the messages, and a fake scheduler on the main thread
+/// hands the submitted tasks back out, like the node manager does.
+class ClientMessageQueueLoadTest : public ::testing::Test {
+ public:
+  ClientMessageQueueLoadTest()
+      : main_service_(),
+        io_pool_(kNumIoThreads),
+        queue_(main_service_, RayConfig::instance().raylet_client_message_batch_size(),
+               [this](const ClientMessage &message) { HandleMessage(message); }),
+        num_assigned_(0) {}
+
+ protected:
+  /// Handle a message on the main thread.
+  void HandleMessage(const ClientMessage &message) {
+    switch (message.message_type) {
+    case protocol::MessageType_SubmitTask:
+      for (const auto &task : message.tasks) {
+        pending_tasks_.push_back(task);
+      }
+      break;
+    case protocol::MessageType_GetTask:
+      idle_workers_.push_back(message.client);
+      break;
+    default:
+      FAIL() << "Unexpected message of type " << message.message_type;
+    }
+    // Assign the pending tasks to the idle workers. The replies are written
+    // from the main thread while the I/O threads wait for the next message.
+    while (!pending_tasks_.empty() && !idle_workers_.empty()) {
+      flatbuffers::FlatBufferBuilder fbb;
+      auto reply = protocol::CreateGetTaskReply(
+          fbb, pending_tasks_.front().GetTaskSpecification().ToFlatbuffer(fbb),
+          fbb.CreateVector(std::vector<int>()));
+      fbb.Finish(reply);
+      RAY_CHECK_OK(idle_workers_.front()->WriteMessage(
+          protocol::MessageType_ExecuteTask, fbb.GetSize(), fbb.GetBufferPointer()));
+      pending_tasks_.pop_front();
+      idle_workers_.pop_front();
+      num_assigned_++;
+    }
+    message.client->ProcessMessages();
+    if (num_assigned_ == kNumWorkers * kNumTasksPerWorker) {
+      main_service_.stop();
+    }
+  }
+
+  boost::asio::io_service main_service_;
+  IoServicePool io_pool_;
+  ClientMessageQueue queue_;
+  std::deque<Task> pending_tasks_;
+  std::deque<std::shared_ptr<LocalClientConnection>> idle_workers_;
+  int64_t num_assigned_;
+};
+
+TEST_F(ClientMessageQueueLoadTest, NoopTaskTest) {
+  // Each worker needs two file descriptors, which is more than some systems
+  // allow by default.
+  struct rlimit limit;
+  ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &limit), 0);
+  limit.rlim_cur = limit.rlim_max;
+  ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &limit), 0);
+  ASSERT_GT(limit.rlim_cur, static_cast<rlim_t>(2 * kNumWorkers + 64));
+  ClientHandler<boost::asio::local::stream_protocol> client_handler =
+      [](LocalClientConnection &client) { client.ProcessMessages(); };
+  MessageHandler<boost::asio::local::stream_protocol> message_handler =
+      [this](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+             const uint8_t *message) {
+        std::unique_ptr<ClientMessage> parsed_message(new ClientMessage());
+        RAY_CHECK_OK(ParseClientMessage(client, message_type, message,
+                                        client->GetMessageLength(),
+                                        parsed_message.get()));
+        queue_.Push(std::move(parsed_message));
+      };
+  // Connect the workers. The server ends of their sockets are spread across
+  // the I/O threads.
+  boost::asio::io_service worker_service;
+  std::vector<std::unique_ptr<boost::asio::local::stream_protocol::socket>> workers;
+  std::vector<std::shared_ptr<LocalClientConnection>> connections;
+  for (int i = 0; i < kNumWorkers; i++) {
+    workers.emplace_back(new boost::asio::local::stream_protocol::socket(worker_service));
+    boost::asio::io_service &client_service = io_pool_.Next();
+    boost::asio::local::stream_protocol::socket server_socket(client_service);
+    boost::asio::local::connect_pair(*workers.back(), server_socket);
+    connections.push_back(LocalClientConnection::Create(
+        client_handler, message_handler, std::move(server_socket), &client_service));
+  }
+  const auto submit_task = MakeSubmitTaskMessage(MakeNoopTask());
+  auto start = std::chrono::steady_clock::now();
+  // Each driver thread runs its share of the workers in lockstep. Every
+  // worker submits a task before it asks for one, so there is always a task
+  // for every worker that is waiting.
+  std::vector<std::thread> drivers;
+  for (int d = 0; d < kNumDriverThreads; d++) {
+    drivers.emplace_back([this, d, &workers, &submit_task]() {
+      for (int round = 0; round < kNumTasksPerWorker; round++) {
+        for (int i = d; i < kNumWorkers; i += kNumDriverThreads) {
+          WriteMessage(*workers[i], protocol::MessageType_SubmitTask, submit_task);
+          WriteMessage(*workers[i], protocol::MessageType_GetTask, {});
+        }
+        for (int i = d; i < kNumWorkers; i += kNumDriverThreads) {
+          ASSERT_EQ(ReadMessage(*workers[i]), protocol::MessageType_ExecuteTask);
+        }
+      }
+    });
+  }
+  // Keep the main thread running while the queue is momentarily empty.
+  boost::asio::io_service::work main_work(main_service_);
+  main_service_.run();
+  for (auto &driver : drivers) {
+    driver.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+  ASSERT_EQ(num_assigned_, kNumWorkers * kNumTasksPerWorker);
+  ASSERT_TRUE(pending_tasks_.empty());
+  ASSERT_TRUE(idle_workers_.empty());
+  RAY_LOG(INFO) << kNumWorkers << " workers ran " << num_assigned_ << " no-op tasks in "
+                << elapsed.count() << "s with " << kNumIoThreads << " I/O threads";
+  // Stop reading before the connections are destroyed.
+  io_pool_.Stop();
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -103,7 +103,7 @@ boost::optional<LineageEntry> Lineage::PopEntry(const UniqueID &task_id) {
   }
 }
 
-const std::unordered_map<const UniqueID, LineageEntry> &Lineage::GetEntries() const {
+const IdMap<LineageEntry> &Lineage::GetEntries() const {
   return entries_;
 }
 
@@ -178,6 +178,14 @@ void LineageCache::AddWaitingTask(const Task &task, const Lineage &uncommitted_l
     return false;
   });
 
+  // If the task was committed before, then it is being re-executed to
+  // reconstruct its outputs. Drop the committed entry so that the task can go
+  // through the commit protocol again.
+  auto committed_entry = lineage_.GetEntry(task_id);
+  if (committed_entry && committed_entry->GetStatus() == GcsStatus_COMMITTED) {
+    lineage_.PopEntry(task_id);
+  }
+
   // Add the submitted task to the lineage cache as UNCOMMITTED_WAITING. It
   // should be marked as UNCOMMITTED_READY once the task starts execution.
   LineageEntry task_entry(task, GcsStatus_UNCOMMITTED_WAITING);
@@ -8,6 +8,7 @@
 #include "ray/raylet/task.h"
 #include "ray/gcs/tables.h"
 #include "ray/id.h"
+#include "ray/id_map.h"
 #include "ray/status.h"
 // clang-format on
 
@@ -138,7 +139,7 @@ class Lineage {
   /// Get all entries in the lineage.
   ///
   /// \return A const reference to the lineage entries.
-  const std::unordered_map<const TaskID, LineageEntry> &GetEntries() const;
+  const IdMap<LineageEntry> &GetEntries() const;
 
   /// Serialize this lineage to a ForwardTaskRequest flatbuffer.
   ///
@@ -151,7 +152,7 @@ class Lineage {
 
  private:
   /// The lineage entries.
-  std::unordered_map<const TaskID, LineageEntry> entries_;
+  IdMap<LineageEntry> entries_;
 };
 
 /// \class LineageCache
@@ -229,18 +230,18 @@ class LineageCache {
   // which tasks are flushable, to avoid iterating over tasks that are in
   // UNCOMMITTED_READY, but that have dependencies that have not been committed
   // yet.
-  std::unordered_set<TaskID> uncommitted_ready_tasks_;
+  IdSet uncommitted_ready_tasks_;
   /// A mapping from each task that hasn't been committed yet, to all dependent
   /// children tasks that are in UNCOMMITTED_READY state. This is used when the
   /// parent task is committed, for fast lookup of children that may now be
   /// flushed.
-  std::unordered_map<TaskID, std::unordered_set<TaskID>> uncommitted_ready_children_;
+  IdMap<IdSet> uncommitted_ready_children_;
   /// All tasks and objects that we are responsible for writing back to the
   /// GCS, and the tasks and objects in their lineage.
   Lineage lineage_;
   /// The tasks that we've subscribed to notifications for from the pubsub
   /// storage system. We will receive a notification for these tasks on commit.
-  std::unordered_set<TaskID> subscribed_tasks_;
+  IdSet subscribed_tasks_;
 };
 
 }  // namespace raylet
@@ -31,6 +31,19 @@ class MockGcs : public gcs::TableInterface<TaskID, protocol::Task>,
     return ray::Status::OK();
   }
 
+  Status Lookup(const JobID &job_id, const TaskID &task_id,
+                const gcs::TableInterface<TaskID, protocol::Task>::Callback &lookup,
+                const gcs::TableInterface<TaskID, protocol::Task>::FailureCallback
+                    &failure) {
+    auto it = task_table_.find(task_id);
+    if (it == task_table_.end()) {
+      failure(NULL, task_id);
+    } else {
+      lookup(NULL, task_id, *it->second);
+    }
+    return ray::Status::OK();
+  }
+
   Status RemoteAdd(const TaskID &task_id, std::shared_ptr<protocol::TaskT> task_data) {
     task_table_[task_id] = task_data;
     // Send a notification after the add if the lineage cache requested
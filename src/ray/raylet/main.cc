@@ -6,7 +6,9 @@
 
 #ifndef RAYLET_TEST
 int main(int argc, char *argv[]) {
-  RAY_CHECK(argc == 9);
+  RAY_CHECK(argc == 10);
+  // Keep writing log lines to stderr off the event loop.
+  ray::StartAsyncLogging();
 
   const std::string raylet_socket_name = std::string(argv[1]);
   const std::string store_socket_name = std::string(argv[2]);
@@ -16,6 +18,7 @@ int main(int argc, char *argv[]) {
   int num_initial_workers = std::stoi(argv[6]);
   const std::string worker_command = std::string(argv[7]);
   const std::string static_resource_list = std::string(argv[8]);
+  int64_t object_store_memory = std::stoll(argv[9]);
 
   // Configuration for the node manager.
   ray::raylet::NodeManagerConfig node_manager_config;
@@ -35,6 +38,8 @@ int main(int argc, char *argv[]) {
   RAY_LOG(INFO) << "Starting raylet with static resource configuration: "
                 << node_manager_config.resource_config.ToString();
   node_manager_config.num_initial_workers = num_initial_workers;
+  node_manager_config.object_store_memory = object_store_memory;
+  node_manager_config.store_socket_name = store_socket_name;
   // Use a default worker that can execute empty tasks with dependencies.
 
   std::stringstream worker_command_stream(worker_command);
@@ -58,6 +63,17 @@ int main(int argc, char *argv[]) {
       RayConfig::instance().object_manager_max_push_retries();
   object_manager_config.object_chunk_size =
       RayConfig::instance().object_manager_default_chunk_size();
+  object_manager_config.max_inflight_pull_bytes =
+      RayConfig::instance().object_manager_max_inflight_pull_bytes();
+  object_manager_config.chunk_timeout_ms =
+      RayConfig::instance().object_manager_chunk_timeout_ms();
+  object_manager_config.max_pull_attempts =
+      RayConfig::instance().object_manager_max_pull_attempts();
+  object_manager_config.compression_codec = static_cast<ray::CompressionCodec>(
+      RayConfig::instance().object_manager_compression_codec());
+  object_manager_config.compression_min_chunk_bytes =
+      RayConfig::instance().object_manager_compression_min_chunk_bytes();
+  object_manager_config.streaming = RayConfig::instance().object_manager_streaming();
 
   //  initialize mock gcs & object directory
   auto gcs_client = std::make_shared<ray::gcs::AsyncGcsClient>();
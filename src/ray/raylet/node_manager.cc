@@ -1,5 +1,6 @@
 #include "ray/raylet/node_manager.h"
 
+#include "common/state/ray_config.h"
 #include "common_protocol.h"
 #include "local_scheduler/format/local_scheduler_generated.h"
 #include "ray/raylet/format/node_manager_generated.h"
@@ -28,32 +29,30 @@ RAY_CHECK_ENUM(protocol::MessageType_GetActorFrontierRequest,
 RAY_CHECK_ENUM(protocol::MessageType_GetActorFrontierReply,
                MessageType_GetActorFrontierReply);
 RAY_CHECK_ENUM(protocol::MessageType_SetActorFrontier, MessageType_SetActorFrontier);
-
-/// A helper function to determine whether a given actor task has already been executed
-/// according to the given actor registry. Returns true if the task is a duplicate.
-bool CheckDuplicateActorTask(
+RAY_CHECK_ENUM(protocol::MessageType_SubmitTaskBatch, MessageType_SubmitTaskBatch);
+RAY_CHECK_ENUM(protocol::MessageType_RegisterSubmissionRing,
+               MessageType_RegisterSubmissionRing);
+RAY_CHECK_ENUM(protocol::MessageType_SubmissionRingDoorbell,
+               MessageType_SubmissionRingDoorbell);
+RAY_CHECK_ENUM(protocol::MessageType_PrefetchTask, MessageType_PrefetchTask);
+
+/// A helper function to get the counter of the first task from the given actor task's
+/// handle that the actor has not executed yet, according to the given actor registry.
+int64_t GetNextActorCounter(
     const std::unordered_map<ActorID, ray::raylet::ActorRegistration> &actor_registry,
     const ray::raylet::TaskSpecification &spec) {
   auto actor_entry = actor_registry.find(spec.ActorId());
   RAY_CHECK(actor_entry != actor_registry.end());
   const auto &frontier = actor_entry->second.GetFrontier();
-  int64_t expected_task_counter = 0;
   auto frontier_entry = frontier.find(spec.ActorHandleId());
-  if (frontier_entry != frontier.end()) {
-    expected_task_counter = frontier_entry->second.task_counter;
-  }
-  if (spec.ActorCounter() < expected_task_counter) {
-    // The assigned task counter is less than expected. The actor has already
-    // executed past this task, so do not assign the task again.
-    RAY_LOG(WARNING) << "A task was resubmitted, so we are ignoring it. This "
-                     << "should only happen during reconstruction.";
-    return true;
-  }
-  RAY_CHECK(spec.ActorCounter() == expected_task_counter)
-      << "Expected actor counter: " << expected_task_counter
-      << ", got: " << spec.ActorCounter();
-  return false;
-};
+  if (frontier_entry == frontier.end()) {
+    return 0;
+  }
+  return frontier_entry->second.task_counter;
+}
+
+/// The minimum time between two reports of the prefetch hits and misses.
+constexpr std::chrono::seconds kPrefetchReportPeriod(10);
 
 }  // namespace
 
@@ -72,26 +71,50 @@ NodeManager::NodeManager(boost::asio::io_service &io_service,
       local_resources_(config.resource_config),
       worker_pool_(config.num_initial_workers, config.worker_command),
       local_queues_(SchedulingQueue()),
-      scheduling_policy_(local_queues_),
-      reconstruction_policy_([this](const TaskID &task_id) { ResubmitTask(task_id); }),
-      task_dependency_manager_(object_manager),
+      object_store_memory_(config.object_store_memory,
+                           RayConfig::instance().object_store_default_output_bytes()),
+      scheduling_policy_(local_queues_, object_store_memory_),
+      reconstruction_policy_(
+          io_service_, [this](const Task &task) { ResubmitTask(task); },
+          RayConfig::instance().object_reconstruction_lease_milliseconds(),
+          gcs_client_->client_table().GetLocalClientId(), gcs_client->object_table(),
+          gcs_client->raylet_task_table(), gcs_client->task_reconstruction_log()),
+      task_dependency_manager_(object_manager, reconstruction_policy_,
+                               RayConfig::instance().prefetch_window_min_tasks(),
+                               RayConfig::instance().prefetch_window_max_tasks()),
+      ready_tasks_handler_posted_(false),
       lineage_cache_(gcs_client_->client_table().GetLocalClientId(),
                      gcs_client->raylet_task_table(), gcs_client->raylet_task_table()),
       remote_clients_(),
       remote_server_connections_(),
       actor_registry_() {
   RAY_CHECK(heartbeat_period_ms_ > 0);
+  ARROW_CHECK_OK(store_client_.Connect(config.store_socket_name.c_str(), "",
+                                       plasma::kPlasmaDefaultReleaseDelay));
   // Initialize the resource map with own cluster resource configuration.
   ClientID local_client_id = gcs_client_->client_table().GetLocalClientId();
   cluster_resource_map_.emplace(local_client_id,
                                 SchedulingResources(config.resource_config));
 
-  RAY_CHECK_OK(object_manager_.SubscribeObjAdded([this](const ObjectInfoT &object_info) {
-    ObjectID object_id = ObjectID::from_binary(object_info.object_id);
-    HandleObjectLocal(object_id);
-  }));
+  RAY_CHECK_OK(object_manager_.SubscribeObjAdded(
+      [this](const std::vector<LocalObjectInfo> &objects) {
+        // Sealed outputs use up the reservations of the tasks that created
+        // them.
+        bool reservations_lowered = object_store_memory_.HandleObjectsAdded(objects);
+        // The tasks that become ready are handled once for the whole batch.
+        for (const auto &object_info : objects) {
+          HandleObjectLocal(object_info.object_id);
+        }
+        if (reservations_lowered) {
+          // Scheduled tasks that were waiting for object store memory may fit
+          // now.
+          DispatchTasks();
+        }
+      }));
   RAY_CHECK_OK(object_manager_.SubscribeObjDeleted(
-      [this](const ObjectID &object_id) { HandleObjectMissing(object_id); }));
+      [this](const std::vector<ObjectID> &object_ids) {
+        HandleObjectsMissing(object_ids);
+      }));
 }
 
 ray::Status NodeManager::RegisterGcs() {
@@ -124,6 +147,15 @@ ray::Status NodeManager::RegisterGcs() {
   };
   gcs_client_->client_table().RegisterClientAddedCallback(node_manager_client_added);
 
+  // Register a callback on the client table for removed clients. Objects that
+  // were only on a removed client are lost and need to be reconstructed.
+  auto node_manager_client_removed = [this](gcs::AsyncGcsClient *client,
+                                            const UniqueID &id,
+                                            const ClientTableDataT &data) {
+    reconstruction_policy_.HandleClientRemoved(ClientID::from_binary(data.client_id));
+  };
+  gcs_client_->client_table().RegisterClientRemovedCallback(node_manager_client_removed);
+
   // Subscribe to node manager heartbeats.
   const auto heartbeat_added = [this](gcs::AsyncGcsClient *client, const ClientID &id,
                                       const HeartbeatTableDataT &heartbeat_data) {
@@ -158,6 +190,15 @@ void NodeManager::Heartbeat() {
     heartbeat_data->resources_total_label.push_back(resource_pair.first);
     heartbeat_data->resources_total_capacity.push_back(resource_pair.second);
   }
+  // Advertise the object store memory that is not reserved by running tasks,
+  // so that other nodes can place tasks with large outputs elsewhere.
+  if (object_store_memory_.Capacity() > 0) {
+    heartbeat_data->resources_available_label.push_back(kObjectStoreMemoryResourceLabel);
+    heartbeat_data->resources_available_capacity.push_back(
+        object_store_memory_.Headroom());
+    heartbeat_data->resources_total_label.push_back(kObjectStoreMemoryResourceLabel);
+    heartbeat_data->resources_total_capacity.push_back(object_store_memory_.Capacity());
+  }
 
   ray::Status status = heartbeat_table.Add(
       UniqueID::nil(), gcs_client_->client_table().GetLocalClientId(), heartbeat_data,
@@ -172,6 +213,24 @@ void NodeManager::Heartbeat() {
   }
   RAY_CHECK_OK(status);
 
+  // Report the prefetch hits and misses since the last report, at most once per
+  // report period.
+  const auto now = std::chrono::steady_clock::now();
+  if (now - last_prefetch_report_time_ >= kPrefetchReportPeriod) {
+    const PrefetchStats stats = task_dependency_manager_.GetPrefetchStats();
+    if (stats.num_hits != last_prefetch_stats_.num_hits ||
+        stats.num_misses != last_prefetch_stats_.num_misses) {
+      RAY_LOG(INFO) << "Prefetch window: " << stats.window_size << " tasks, "
+                    << stats.num_deferred_tasks << " deferred, "
+                    << stats.num_hits - last_prefetch_stats_.num_hits << " hits, "
+                    << stats.num_misses - last_prefetch_stats_.num_misses
+                    << " misses (" << stats.num_hits << " hits, " << stats.num_misses
+                    << " misses in total)";
+      last_prefetch_stats_ = stats;
+      last_prefetch_report_time_ = now;
+    }
+  }
+
   // Reset the timer.
   auto heartbeat_period = boost::posix_time::milliseconds(heartbeat_period_ms_);
   heartbeat_timer_.expires_from_now(heartbeat_period);
@@ -216,7 +275,7 @@ void NodeManager::ClientAdded(const ClientTableDataT &client_data) {
   boost::asio::ip::tcp::socket socket(io_service_);
   RAY_CHECK_OK(TcpConnect(socket, client_info.node_manager_address,
                           client_info.node_manager_port));
-  auto server_conn = TcpServerConnection(std::move(socket));
+  auto server_conn = TcpServerConnection::Create(std::move(socket));
   remote_server_connections_.emplace(client_id, std::move(server_conn));
 }
 
@@ -275,10 +334,10 @@ void NodeManager::HandleActorCreation(const ActorID &actor_id,
     // The actor's location is now known. Dequeue any methods that were
     // submitted before the actor's location was known.
     const auto &methods = local_queues_.GetUncreatedActorMethods();
-    std::unordered_set<TaskID> created_actor_method_ids;
+    std::vector<TaskID> created_actor_method_ids;
     for (const auto &method : methods) {
       if (method.GetTaskSpecification().ActorId() == actor_id) {
-        created_actor_method_ids.insert(method.GetTaskSpecification().TaskId());
+        created_actor_method_ids.push_back(method.GetTaskSpecification().TaskId());
       }
     }
     // Resubmit the methods that were submitted before the actor's location was
@@ -309,11 +368,24 @@ void NodeManager::DispatchTasks() {
   const ClientID &my_client_id = gcs_client_->client_table().GetLocalClientId();
 
   for (const auto &task : scheduled_tasks) {
+    if (!object_store_memory_.CanAdmit(task.GetTaskSpecification())) {
+      // The object store has no room for the task's outputs until the running
+      // tasks seal theirs or finish.
+      continue;
+    }
     const auto &local_resources =
         cluster_resource_map_[my_client_id].GetAvailableResources();
     const auto &task_resources = task.GetTaskSpecification().GetRequiredResources();
     if (!task_resources.IsSubset(local_resources)) {
-      // Not enough local resources for this task right now, skip this task.
+      // Not enough local resources for this task right now. If a worker will
+      // release enough resources once it finishes its current task, send the
+      // task to it ahead of time. Otherwise, skip this task.
+      auto worker = FindPrefetchingWorker(task_resources);
+      if (worker != nullptr) {
+        auto prefetched_task =
+            local_queues_.RemoveTasks({task.GetTaskSpecification().TaskId()});
+        PrefetchTask(worker, prefetched_task.front());
+      }
       continue;
     }
     // We have enough resources for this task. Assign task.
@@ -324,9 +396,111 @@ void NodeManager::DispatchTasks() {
   }
 }
 
+std::shared_ptr<Worker> NodeManager::FindPrefetchingWorker(
+    const ResourceSet &resources) const {
+  for (const auto &prefetching_worker : prefetching_workers_) {
+    if (resources.IsSubset(prefetching_worker.second)) {
+      return prefetching_worker.first;
+    }
+  }
+  return nullptr;
+}
+
+void NodeManager::PrefetchTask(const std::shared_ptr<Worker> &worker, Task &task) {
+  prefetching_workers_.erase(worker);
+  SendTaskToWorker(worker, task);
+  prefetched_tasks_.emplace(worker, task);
+}
+
+bool NodeManager::StartPrefetchedTask(const std::shared_ptr<Worker> &worker) {
+  prefetching_workers_.erase(worker);
+  auto prefetched_task = prefetched_tasks_.find(worker);
+  if (prefetched_task == prefetched_tasks_.end()) {
+    return false;
+  }
+  StartSentTask(*worker, prefetched_task->second);
+  prefetched_tasks_.erase(prefetched_task);
+  return true;
+}
+
 void NodeManager::ProcessClientMessage(
     const std::shared_ptr<LocalClientConnection> &client, int64_t message_type,
     const uint8_t *message_data) {
+  if (HandleClientMessage(client, message_type, message_data)) {
+    // Listen for more messages.
+    client->ProcessMessages();
+  }
+}
+
+void NodeManager::ProcessClientMessage(const ClientMessage &message) {
+  bool listen;
+  if (message.message_type == protocol::MessageType_SubmitTask ||
+      message.message_type == protocol::MessageType_SubmitTaskBatch) {
+    // The tasks were already built on the I/O thread. Submit them in order,
+    // exactly as if the message had been handled here.
+    for (const auto &task : message.tasks) {
+      SubmitTask(task, Lineage());
+    }
+    listen = true;
+  } else {
+    listen = HandleClientMessage(message.client, message.message_type,
+                                 message.message.data());
+  }
+  if (listen) {
+    if (message.drain_ring) {
+      // Parse the next messages from the client's submission ring.
+      message.drain_ring();
+    } else if (message.read_socket) {
+      // Listen for more messages. The read runs on the client's I/O thread.
+      message.client->ProcessMessages();
+    }
+  }
+}
+
+bool NodeManager::DrainSubmissionRing(
+    const std::shared_ptr<LocalClientConnection> &client) {
+  auto it = submission_rings_.find(client);
+  if (it == submission_rings_.end()) {
+    // The client disconnected before a posted drain ran.
+    return false;
+  }
+  // Hold a reference, since handling a message may disconnect the client and
+  // erase its ring.
+  std::shared_ptr<SubmissionRing> ring = it->second;
+  const int64_t max_messages = RayConfig::instance().raylet_submission_ring_max_drain();
+  int64_t num_messages = 0;
+  do {
+    int64_t message_type;
+    int64_t length;
+    const uint8_t *message_data;
+    while (ring->Peek(&message_type, &length, &message_data)) {
+      if (num_messages == max_messages) {
+        // Let other clients and events run, and drain the rest of the ring
+        // afterwards. The ring is not marked as waiting, so the client does not
+        // ring the doorbell in the meantime.
+        io_service_.post([this, client]() { DrainSubmissionRing(client); });
+        return true;
+      }
+      num_messages++;
+      if (!HandleClientMessage(client, message_type, message_data)) {
+        return false;
+      }
+      // Only pop the message once it has been handled. The client sends
+      // messages that are too large for the ring on the socket, but only once
+      // the ring is empty, so that all of its messages are handled in order.
+      ring->Pop();
+      if (submission_rings_.count(client) == 0) {
+        // The client was disconnected while handling the message.
+        return true;
+      }
+    }
+  } while (!ring->PrepareToWait());
+  return true;
+}
+
+bool NodeManager::HandleClientMessage(
+    const std::shared_ptr<LocalClientConnection> &client, int64_t message_type,
+    const uint8_t *message_data) {
   RAY_LOG(DEBUG) << "Message of type " << message_type;
 
   switch (message_type) {
@@ -346,8 +520,21 @@ void NodeManager::ProcessClientMessage(
     if (!worker->GetAssignedTaskId().is_nil()) {
       FinishAssignedTask(*worker);
     }
-    // Return the worker to the idle pool.
-    worker_pool_.PushWorker(std::move(worker));
+    const ActorID actor_id = worker->GetActorId();
+    // If the worker was already sent its next task, it reads that task right
+    // away, so it stays busy. Otherwise, return the worker to the idle pool.
+    bool started_next_task = actor_id.is_nil() ? StartPrefetchedTask(worker)
+                                               : StartPipelinedActorTask(*worker);
+    if (!started_next_task) {
+      worker_pool_.PushWorker(std::move(worker));
+    }
+    if (!actor_id.is_nil()) {
+      // Send the actor's next tasks to it.
+      DispatchActorTasks(actor_id);
+    }
+    // The finished task released its resources, so start the idle actors that
+    // were waiting for them.
+    DispatchWaitingActorTasks();
     // Call task dispatch to assign work to the new worker.
     DispatchTasks();
 
@@ -361,20 +548,79 @@ void NodeManager::ProcessClientMessage(
       // error to the driver.
       // RAY_CHECK(worker->GetAssignedTaskId().is_nil())
       //    << "Worker died while executing task: " << worker->GetAssignedTaskId();
+      // The task will not seal any more outputs.
+      if (!worker->GetAssignedTaskId().is_nil()) {
+        object_store_memory_.Release(worker->GetAssignedTaskId());
+      }
+      // The tasks that were pipelined to a dead actor were never executed.
+      // Put them back in the actor's mailbox, in order, so that they are
+      // still executed if the actor comes back, like the actor's other
+      // queued tasks.
+      auto pipeline = actor_pipelines_.find(worker->GetActorId());
+      if (pipeline != actor_pipelines_.end() && pipeline->second.worker == worker) {
+        auto &mailbox = actor_mailboxes_[worker->GetActorId()];
+        const auto &pipelined_tasks = pipeline->second.pipelined_tasks;
+        for (auto it = pipelined_tasks.rbegin(); it != pipelined_tasks.rend(); it++) {
+          mailbox.Requeue(*it);
+        }
+        actor_pipelines_.erase(pipeline);
+      }
+      // A task that was sent ahead to the worker was already removed from the
+      // queues, so queue it again for another worker.
+      prefetching_workers_.erase(worker);
+      auto prefetched_task = prefetched_tasks_.find(worker);
+      bool requeued_task = prefetched_task != prefetched_tasks_.end();
+      if (requeued_task) {
+        local_queues_.QueueScheduledTasks(
+            std::vector<Task>({std::move(prefetched_task->second)}));
+        prefetched_tasks_.erase(prefetched_task);
+        // Workers only ask for a task ahead once their current task has
+        // returned, so that task no longer uses its resources. Release them,
+        // so that the requeued task can take them over. The outputs that the
+        // worker did not store are reconstructed if they are needed.
+        if (!worker->GetAssignedTaskId().is_nil() && !worker->IsBlocked()) {
+          FinishAssignedTask(*worker);
+        }
+      }
       worker_pool_.DisconnectWorker(worker);
+      if (requeued_task) {
+        DispatchTasks();
+      }
     }
-    return;
+    submission_rings_.erase(client);
+    return false;
   } break;
   case protocol::MessageType_SubmitTask: {
     // Read the task submitted by the client.
     auto message = flatbuffers::GetRoot<protocol::SubmitTaskRequest>(message_data);
-    TaskExecutionSpecification task_execution_spec(
-        from_flatbuf(*message->execution_dependencies()));
-    TaskSpecification task_spec(*message->task_spec());
-    Task task(task_execution_spec, task_spec);
     // Submit the task to the local scheduler. Since the task was submitted
     // locally, there is no uncommitted lineage.
-    SubmitTask(task, Lineage());
+    SubmitTask(TaskFromSubmitRequest(*message), Lineage());
+  } break;
+  case protocol::MessageType_SubmitTaskBatch: {
+    // Submit each task in the batch in order, exactly as if it had been sent
+    // in its own SubmitTask message.
+    auto message = flatbuffers::GetRoot<protocol::SubmitTaskBatchRequest>(message_data);
+    for (const auto request : *message->tasks()) {
+      SubmitTask(TaskFromSubmitRequest(*request), Lineage());
+    }
+  } break;
+  case protocol::MessageType_RegisterSubmissionRing: {
+    auto message =
+        flatbuffers::GetRoot<protocol::RegisterSubmissionRingRequest>(message_data);
+    std::unique_ptr<SubmissionRing> ring;
+    auto status = SubmissionRing::Open(string_from_flatbuf(*message->name()), &ring);
+    if (!status.ok()) {
+      // The client will write its messages to the ring, so we cannot talk to it
+      // without one.
+      RAY_LOG(WARNING) << "Failed to open submission ring, disconnecting client: "
+                       << status.ToString();
+      return HandleClientMessage(client, protocol::MessageType_DisconnectClient, NULL);
+    }
+    submission_rings_[client] = std::move(ring);
+  } break;
+  case protocol::MessageType_SubmissionRingDoorbell: {
+    return DrainSubmissionRing(client);
   } break;
   case protocol::MessageType_ReconstructObject: {
     // TODO(hme): handle multiple object ids.
@@ -385,7 +631,7 @@ void NodeManager::ProcessClientMessage(
       // TODO(swang): Instead of calling Pull on the object directly, record the
       // fact that the blocked task is dependent on this object_id in the task
       // dependency manager.
-      RAY_CHECK_OK(object_manager_.Pull(object_id));
+      RAY_CHECK_OK(object_manager_.Pull(object_id, kBlockedTaskPullPriority));
     }
 
     // If the blocked client is a worker, and the worker isn't already blocked,
@@ -407,12 +653,26 @@ void NodeManager::ProcessClientMessage(
       RAY_CHECK(
           cluster_resource_map_[gcs_client_->client_table().GetLocalClientId()].Release(
               ResourceSet(cpu_resources)));
+      // The blocked task cannot seal its outputs until the objects it waits for
+      // are created, so do not let its reservation keep their tasks out of the
+      // object store either.
+      object_store_memory_.MarkBlocked(worker->GetAssignedTaskId());
       // Mark the task as blocked.
       local_queues_.QueueBlockedTasks(tasks);
       worker->MarkBlocked();
+      // The blocked task no longer holds its CPUs, so do not send a task ahead
+      // to the worker to take them over. Workers only ask for a task ahead
+      // once their current task has returned, so a blocked worker should not
+      // have been sent one yet. A task that was sent cannot be taken back,
+      // since it is already on the worker's socket.
+      if (prefetched_tasks_.count(worker) > 0) {
+        RAY_LOG(WARNING) << "Worker blocked after it was sent its next task";
+      }
+      prefetching_workers_.erase(worker);
 
       // Try to dispatch more tasks since the blocked worker released some
       // resources.
+      DispatchWaitingActorTasks();
       DispatchTasks();
     }
   } break;
@@ -442,18 +702,43 @@ void NodeManager::ProcessClientMessage(
         RAY_LOG(WARNING) << "Resources oversubscribed: "
                          << local_resources.GetAvailableResources().ToString();
       }
+      // Take back what is left of the task's object store reservation.
+      object_store_memory_.MarkUnblocked(worker->GetAssignedTaskId());
       // Mark the task as running again.
       local_queues_.QueueRunningTasks(tasks);
       worker->MarkUnblocked();
     }
   } break;
 
+  case protocol::MessageType_PrefetchTask: {
+    std::shared_ptr<Worker> worker = worker_pool_.GetRegisteredWorker(client);
+    // Actors are already sent their tasks ahead of time, through their
+    // pipeline.
+    if (!worker || worker->GetAssignedTaskId().is_nil() ||
+        !worker->GetActorId().is_nil() || worker->IsBlocked() ||
+        prefetched_tasks_.count(worker) > 0) {
+      break;
+    }
+    for (const auto &task : local_queues_.GetRunningTasks()) {
+      const TaskSpecification &spec = task.GetTaskSpecification();
+      if (!(spec.TaskId() == worker->GetAssignedTaskId())) {
+        continue;
+      }
+      // An actor creation task turns the worker into an actor, which cannot
+      // execute other tasks. Its resources are also held by the actor.
+      if (!spec.IsActorCreationTask()) {
+        prefetching_workers_[worker] = spec.GetRequiredResources();
+        // Send the worker a task that is waiting for resources, if any.
+        DispatchTasks();
+      }
+      break;
+    }
+  } break;
+
   default:
     RAY_LOG(FATAL) << "Received unexpected message type " << message_type;
   }
-
-  // Listen for more messages.
-  client->ProcessMessages();
+  return true;
 }
 
 void NodeManager::ProcessNewNodeManager(TcpClientConnection &node_manager_client) {
@@ -493,14 +778,24 @@ void NodeManager::ScheduleTasks() {
   }
 
   // Extract decision for this local scheduler.
-  std::unordered_set<TaskID> local_task_ids;
+  std::vector<TaskID> local_task_ids;
   // Iterate over (taskid, clientid) pairs, extract tasks assigned to the local node.
   for (const auto &task_schedule : policy_decision) {
     TaskID task_id = task_schedule.first;
     ClientID client_id = task_schedule.second;
     if (client_id == gcs_client_->client_table().GetLocalClientId()) {
-      local_task_ids.insert(task_id);
+      local_task_ids.push_back(task_id);
     } else {
+      auto connection = remote_server_connections_.find(client_id);
+      if (connection != remote_server_connections_.end() &&
+          connection->second->IsAboveHighWaterMark()) {
+        // The remote node manager is not keeping up with the tasks that we
+        // already forwarded to it. Leave the task in the placeable queue so
+        // that it is reconsidered once the connection drains.
+        RAY_LOG(DEBUG) << "Deferring forward of task " << task_id << " to " << client_id;
+        deferred_forward_clients_.insert(client_id);
+        continue;
+      }
       auto tasks = local_queues_.RemoveTasks({task_id});
       RAY_CHECK(1 == tasks.size());
       Task &task = tasks.front();
@@ -575,26 +870,37 @@ void NodeManager::SubmitTask(const Task &task, const Lineage &uncommitted_lineag
   }
 }
 
-void NodeManager::HandleRemoteDependencyRequired(const ObjectID &dependency_id) {
-  // Try to fetch the object from the object manager.
-  RAY_CHECK_OK(object_manager_.Pull(dependency_id));
-  // TODO(swang): Request reconstruction of the object, possibly after a
-  // timeout.
-}
-
-void NodeManager::HandleRemoteDependencyCanceled(const ObjectID &dependency_id) {
-  // Cancel the fetch request from the object manager.
-  RAY_CHECK_OK(object_manager_.Cancel(dependency_id));
-  // TODO(swang): Cancel reconstruction of the object.
-}
-
 void NodeManager::QueueTask(const Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  std::vector<ObjectID> dependencies;
+  if (spec.IsActorTask() && spec.ActorCounter() > 0) {
+    // An actor task's execution dependency is the dummy object returned by the
+    // previous task from the same handle. The actor's mailbox already orders
+    // the tasks from each handle, so only wait for the task's arguments. This
+    // lets consecutive tasks be sent to the actor before the previous ones
+    // finish. The first task from a handle still waits for its execution
+    // dependency. For a forked handle, that is the dummy object of the last
+    // task that the parent handle submitted before the fork, which the
+    // mailbox does not know about.
+    for (int i = 0; i < spec.NumArgs(); ++i) {
+      int count = spec.ArgIdCount(i);
+      for (int j = 0; j < count; j++) {
+        dependencies.push_back(spec.ArgId(i, j));
+      }
+    }
+  } else {
+    dependencies = task.GetDependencies();
+  }
   // Subscribe to the task's dependencies.
-  bool ready = task_dependency_manager_.SubscribeDependencies(
-      task.GetTaskSpecification().TaskId(), task.GetDependencies());
+  bool ready =
+      task_dependency_manager_.SubscribeDependencies(spec.TaskId(), dependencies);
   // Queue the task. If all dependencies are available, then the task is queued
   // in the READY state, else the WAITING.
   if (ready) {
+    if (spec.IsActorTask()) {
+      QueueReadyActorTasks({task});
+      return;
+    }
     local_queues_.QueueReadyTasks({task});
     // Try to schedule the newly ready task.
     ScheduleTasks();
@@ -603,82 +909,216 @@ void NodeManager::QueueTask(const Task &task) {
   }
 }
 
-void NodeManager::AssignTask(Task &task) {
-  const TaskSpecification &spec = task.GetTaskSpecification();
+void NodeManager::QueueReadyActorTasks(const std::vector<Task> &tasks) {
+  std::unordered_set<ActorID> actor_ids;
+  for (const auto &task : tasks) {
+    const TaskSpecification &spec = task.GetTaskSpecification();
+    // The task is ready to run, so we no longer need its arguments to be
+    // fetched. This is the same as for tasks that are scheduled locally.
+    task_dependency_manager_.UnsubscribeDependencies(spec.TaskId());
+    auto &mailbox = actor_mailboxes_[spec.ActorId()];
+    if (!mailbox.Push(task, GetNextActorCounter(actor_registry_, spec))) {
+      // Drop tasks that have already been queued or executed.
+      RAY_LOG(WARNING) << "A task was resubmitted, so we are ignoring it. This "
+                       << "should only happen during reconstruction.";
+      continue;
+    }
+    actor_ids.insert(spec.ActorId());
+  }
+  for (const auto &actor_id : actor_ids) {
+    DispatchActorTasks(actor_id);
+  }
+}
 
-  // If this is an actor task, check that the new task has the correct counter.
-  if (spec.IsActorTask()) {
-    if (CheckDuplicateActorTask(actor_registry_, spec)) {
-      // Drop tasks that have already been executed.
+void NodeManager::DispatchActorTasks(const ActorID &actor_id) {
+  auto mailbox_entry = actor_mailboxes_.find(actor_id);
+  if (mailbox_entry == actor_mailboxes_.end()) {
+    return;
+  }
+  ActorMailbox &mailbox = mailbox_entry->second;
+  const ClientID &my_client_id = gcs_client_->client_table().GetLocalClientId();
+  const size_t max_pipelined_tasks = RayConfig::instance().actor_max_pipelined_tasks();
+  while (mailbox.HasRunnableTask()) {
+    auto pipeline = actor_pipelines_.find(actor_id);
+    if (pipeline != actor_pipelines_.end()) {
+      // The actor is executing a task. Send it the next task right away, so
+      // that it does not have to wait for us once it finishes. The next task
+      // takes over the resources of the current one when it starts.
+      if (pipeline->second.pipelined_tasks.size() >= max_pipelined_tasks) {
+        return;
+      }
+      Task task = mailbox.FrontRunnableTask();
+      SendTaskToWorker(pipeline->second.worker, task);
+      mailbox.PopRunnableTask();
+      pipeline->second.pipelined_tasks.push_back(task);
+      continue;
+    }
+    // The actor is idle. Hold a copy of the task, since popping it from the
+    // mailbox below could otherwise free its resource demands.
+    Task task = mailbox.FrontRunnableTask();
+    const auto &task_resources = task.GetTaskSpecification().GetRequiredResources();
+    if (!task_resources.IsSubset(
+            cluster_resource_map_[my_client_id].GetAvailableResources())) {
+      // Not enough local resources for the task right now. Try again once a
+      // task releases its resources.
+      actors_waiting_for_resources_.insert(actor_id);
+      return;
+    }
+    std::shared_ptr<Worker> worker = worker_pool_.PopWorker(actor_id);
+    if (worker == nullptr) {
+      // The actor's worker is not connected.
       return;
     }
+    SendTaskToWorker(worker, task);
+    mailbox.PopRunnableTask();
+    RAY_CHECK(cluster_resource_map_[my_client_id].Acquire(task_resources));
+    object_store_memory_.Reserve(task.GetTaskSpecification());
+    worker->AssignTaskId(task.GetTaskSpecification().TaskId());
+    local_queues_.QueueRunningTasks(std::vector<Task>({task}));
+    actor_pipelines_[actor_id].worker = std::move(worker);
+  }
+}
+
+void NodeManager::DispatchWaitingActorTasks() {
+  // DispatchActorTasks adds the actors that still lack resources back.
+  std::unordered_set<ActorID> actor_ids;
+  actor_ids.swap(actors_waiting_for_resources_);
+  for (const auto &actor_id : actor_ids) {
+    DispatchActorTasks(actor_id);
   }
+}
+
+bool NodeManager::StartPipelinedActorTask(Worker &worker) {
+  auto pipeline = actor_pipelines_.find(worker.GetActorId());
+  if (pipeline == actor_pipelines_.end()) {
+    return false;
+  }
+  RAY_CHECK(pipeline->second.worker.get() == &worker);
+  auto &pipelined_tasks = pipeline->second.pipelined_tasks;
+  if (pipelined_tasks.empty()) {
+    actor_pipelines_.erase(pipeline);
+    return false;
+  }
+  StartSentTask(worker, pipelined_tasks.front());
+  pipelined_tasks.pop_front();
+  return true;
+}
+
+void NodeManager::StartSentTask(Worker &worker, const Task &task) {
+  // Acquire the resources that the previous task just released.
+  bool oversubscribed =
+      !cluster_resource_map_[gcs_client_->client_table().GetLocalClientId()].Acquire(
+          task.GetTaskSpecification().GetRequiredResources());
+  if (oversubscribed) {
+    const SchedulingResources &local_resources =
+        cluster_resource_map_[gcs_client_->client_table().GetLocalClientId()];
+    RAY_LOG(WARNING) << "Resources oversubscribed: "
+                     << local_resources.GetAvailableResources().ToString();
+  }
+  object_store_memory_.Reserve(task.GetTaskSpecification());
+  worker.AssignTaskId(task.GetTaskSpecification().TaskId());
+  local_queues_.QueueRunningTasks(std::vector<Task>({task}));
+}
+
+void NodeManager::AssignTask(Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  // Actor tasks are sent to the actor through its mailbox instead.
+  RAY_CHECK(!spec.IsActorTask());
 
   // Try to get an idle worker that can execute this task.
   std::shared_ptr<Worker> worker = worker_pool_.PopWorker(spec.ActorId());
   if (worker == nullptr) {
-    // There are no workers that can execute this task.
-    if (!spec.IsActorTask()) {
-      // There are no more non-actor workers available to execute this task.
-      // Start a new worker.
-      worker_pool_.StartWorker();
-    }
+    // There are no more non-actor workers available to execute this task.
+    // Start a new worker.
+    worker_pool_.StartWorker();
     // Queue this task for future assignment. The task will be assigned to a
     // worker once one becomes available.
     local_queues_.QueueScheduledTasks(std::vector<Task>({task}));
     return;
   }
 
+  SendTaskToWorker(worker, task);
+  // Resource accounting: acquire resources for the assigned task. If the task
+  // does not reach the worker, HandleTaskSendFailure undoes this.
+  const ClientID &my_client_id = gcs_client_->client_table().GetLocalClientId();
+  RAY_CHECK(
+      this->cluster_resource_map_[my_client_id].Acquire(spec.GetRequiredResources()));
+  object_store_memory_.Reserve(spec);
+
+  worker->AssignTaskId(spec.TaskId());
+  // Mark the task as running.
+  local_queues_.QueueRunningTasks(std::vector<Task>({task}));
+}
+
+void NodeManager::SendTaskToWorker(const std::shared_ptr<Worker> &worker, Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
   RAY_LOG(DEBUG) << "Assigning task to worker with pid " << worker->Pid();
   flatbuffers::FlatBufferBuilder fbb;
   auto message = protocol::CreateGetTaskReply(fbb, spec.ToFlatbuffer(fbb),
                                               fbb.CreateVector(std::vector<int>()));
   fbb.Finish(message);
-  auto status = worker->Connection()->WriteMessage(protocol::MessageType_ExecuteTask,
-                                                   fbb.GetSize(), fbb.GetBufferPointer());
-  if (status.ok()) {
-    // Resource accounting: acquire resources for the assigned task.
-    const ClientID &my_client_id = gcs_client_->client_table().GetLocalClientId();
-    RAY_CHECK(
-        this->cluster_resource_map_[my_client_id].Acquire(spec.GetRequiredResources()));
-
-    // We successfully assigned the task to the worker.
-    worker->AssignTaskId(spec.TaskId());
-    // If the task was an actor task, then record this execution to guarantee
-    // consistency in the case of reconstruction.
-    if (spec.IsActorTask()) {
-      auto actor_entry = actor_registry_.find(spec.ActorId());
-      RAY_CHECK(actor_entry != actor_registry_.end());
-      auto execution_dependency = actor_entry->second.GetExecutionDependency();
-      // The execution dependency is initialized to the actor creation task's
-      // return value, and is subsequently updated to the assigned tasks'
-      // return values, so it should never be nil.
-      RAY_CHECK(!execution_dependency.is_nil());
-      // Update the task's execution dependencies to reflect the actual
-      // execution order, to support deterministic reconstruction.
-      // NOTE(swang): The update of an actor task's execution dependencies is
-      // performed asynchronously. This means that if this node manager dies,
-      // we may lose updates that are in flight to the task table. We only
-      // guarantee deterministic reconstruction ordering for tasks whose
-      // updates are reflected in the task table.
-      TaskExecutionSpecification &mutable_spec = task.GetTaskExecutionSpec();
-      mutable_spec.SetExecutionDependencies({execution_dependency});
-      // Extend the frontier to include the executing task.
-      actor_entry->second.ExtendFrontier(spec.ActorHandleId(), spec.ActorDummyObject());
-    }
-    // We started running the task, so the task is ready to write to GCS.
-    lineage_cache_.AddReadyTask(task);
-    // Mark the task as running.
-    local_queues_.QueueRunningTasks(std::vector<Task>({task}));
-  } else {
-    RAY_LOG(WARNING) << "Failed to send task to worker, disconnecting client";
-    // We failed to send the task to the worker, so disconnect the worker.
-    ProcessClientMessage(worker->Connection(), protocol::MessageType_DisconnectClient,
-                         NULL);
-    // Queue this task for future assignment. The task will be assigned to a
-    // worker once one becomes available.
-    local_queues_.QueueScheduledTasks(std::vector<Task>({task}));
+
+  // If the task was an actor task, then record this execution to guarantee
+  // consistency in the case of reconstruction.
+  if (spec.IsActorTask()) {
+    auto actor_entry = actor_registry_.find(spec.ActorId());
+    RAY_CHECK(actor_entry != actor_registry_.end());
+    auto execution_dependency = actor_entry->second.GetExecutionDependency();
+    // The execution dependency is initialized to the actor creation task's
+    // return value, and is subsequently updated to the assigned tasks'
+    // return values, so it should never be nil.
+    RAY_CHECK(!execution_dependency.is_nil());
+    // Update the task's execution dependencies to reflect the actual
+    // execution order, to support deterministic reconstruction.
+    // NOTE(swang): The update of an actor task's execution dependencies is
+    // performed asynchronously. This means that if this node manager dies,
+    // we may lose updates that are in flight to the task table. We only
+    // guarantee deterministic reconstruction ordering for tasks whose
+    // updates are reflected in the task table.
+    TaskExecutionSpecification &mutable_spec = task.GetTaskExecutionSpec();
+    mutable_spec.SetExecutionDependencies({execution_dependency});
+    // Extend the frontier to include the executing task.
+    actor_entry->second.ExtendFrontier(spec.ActorHandleId(), spec.ActorDummyObject());
+  }
+
+  // Do not block on the worker's socket. The write completes on the thread
+  // that owns the connection, so handle the result back on this thread.
+  std::shared_ptr<LocalClientConnection> connection = worker->Connection();
+  connection->WriteMessageAsync(
+      protocol::MessageType_ExecuteTask, fbb.GetSize(), fbb.GetBufferPointer(),
+      [this, connection, task](const ray::Status &status) {
+        io_service_.post([this, connection, task, status]() {
+          if (status.ok()) {
+            // We started running the task, so the task is ready to write to GCS.
+            lineage_cache_.AddReadyTask(task);
+          } else {
+            HandleTaskSendFailure(connection, task.GetTaskSpecification().TaskId());
+          }
+        });
+      });
+}
+
+void NodeManager::HandleTaskSendFailure(
+    const std::shared_ptr<LocalClientConnection> &connection, const TaskID &task_id) {
+  RAY_LOG(WARNING) << "Failed to send task " << task_id
+                   << " to worker, disconnecting client";
+  const std::shared_ptr<Worker> worker = worker_pool_.GetRegisteredWorker(connection);
+  if (worker != nullptr && worker->GetAssignedTaskId() == task_id &&
+      worker->GetActorId().is_nil()) {
+    // The worker never received the task, so the task can run on another
+    // worker. Undo its assignment before disconnecting the worker, which
+    // would otherwise treat the task as lost. Tasks that were sent ahead of
+    // time or pipelined to the worker are requeued by the disconnect.
+    auto tasks = local_queues_.RemoveTasks({task_id});
+    const TaskSpecification &spec = tasks.front().GetTaskSpecification();
+    RAY_CHECK(this->cluster_resource_map_[gcs_client_->client_table().GetLocalClientId()]
+                  .Release(spec.GetRequiredResources()));
+    object_store_memory_.Release(task_id);
+    worker->AssignTaskId(TaskID::nil());
+    local_queues_.QueueScheduledTasks(tasks);
   }
+  ProcessClientMessage(connection, protocol::MessageType_DisconnectClient, NULL);
+  DispatchTasks();
 }
 
 void NodeManager::FinishAssignedTask(Worker &worker) {
@@ -725,6 +1165,9 @@ void NodeManager::FinishAssignedTask(Worker &worker) {
     HandleObjectLocal(dummy_object);
   }
 
+  // Release the object store memory that the task's outputs did not use up.
+  object_store_memory_.Release(task_id);
+
   // Notify the task dependency manager that this task has finished execution.
   task_dependency_manager_.TaskCanceled(task_id);
 
@@ -732,40 +1175,120 @@ void NodeManager::FinishAssignedTask(Worker &worker) {
   worker.AssignTaskId(TaskID::nil());
 }
 
-void NodeManager::ResubmitTask(const TaskID &task_id) {
-  throw std::runtime_error("Method not implemented");
+void NodeManager::ResubmitTask(const Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  if (spec.IsActorTask() || spec.IsActorCreationTask()) {
+    // Actor state is not checkpointed, so replaying a single actor task would
+    // not recreate its return values. Fail them instead, so that ray.get
+    // raises an error for them.
+    RAY_LOG(WARNING) << "Cannot reconstruct the return values of actor task "
+                     << spec.TaskId() << ", storing them as failed";
+    TreatTaskAsFailed(spec);
+    return;
+  }
+  // The task was already committed to the GCS, so its lineage is durable and
+  // does not need to be forwarded with it.
+  SubmitTask(task, Lineage());
+}
+
+void NodeManager::TreatTaskAsFailed(const TaskSpecification &spec) {
+  for (int64_t i = 0; i < spec.NumReturns(); i++) {
+    const ObjectID object_id = spec.ReturnId(i);
+    // This writes an invalid arrow object, which the worker deserializes into
+    // an error, like the local scheduler does for the tasks of a killed
+    // worker. The object store notifies the object manager, which makes the
+    // object available to the other nodes.
+    std::shared_ptr<Buffer> data;
+    arrow::Status status =
+        store_client_.Create(object_id.to_plasma_id(), 1, nullptr, 0, &data);
+    if (status.IsPlasmaObjectExists()) {
+      // The object was stored after all.
+      continue;
+    }
+    if (!status.ok()) {
+      RAY_LOG(WARNING) << "Failed to store object " << object_id
+                       << " as failed: " << status.ToString();
+      continue;
+    }
+    ARROW_CHECK_OK(store_client_.Seal(object_id.to_plasma_id()));
+    ARROW_CHECK_OK(store_client_.Release(object_id.to_plasma_id()));
+  }
 }
 
 void NodeManager::HandleObjectLocal(const ObjectID &object_id) {
   // Notify the task dependency manager that this object is local.
-  const auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(object_id);
+  task_dependency_manager_.HandleObjectLocal(object_id);
+  // Handle all of the tasks that become ready during this event loop iteration
+  // at once, so that they are moved between queues and scheduled in a single
+  // pass.
+  if (task_dependency_manager_.HasReadyTasks() && !ready_tasks_handler_posted_) {
+    ready_tasks_handler_posted_ = true;
+    io_service_.post([this]() { HandleReadyTasks(); });
+  }
+}
+
+void NodeManager::HandleReadyTasks() {
+  ready_tasks_handler_posted_ = false;
+  const auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
+  if (ready_task_ids.empty()) {
+    return;
+  }
   // Transition the tasks whose dependencies are now fulfilled to the ready
   // state.
-  if (ready_task_ids.size() > 0) {
-    std::unordered_set<TaskID> ready_task_id_set(ready_task_ids.begin(),
-                                                 ready_task_ids.end());
-    auto ready_tasks = local_queues_.RemoveTasks(ready_task_id_set);
-    local_queues_.QueueReadyTasks(std::vector<Task>(ready_tasks));
+  auto ready_tasks = local_queues_.RemoveTasks(ready_task_ids);
+  // Actor tasks go straight to their actor's mailbox.
+  std::vector<Task> ready_actor_tasks;
+  std::vector<Task> ready_non_actor_tasks;
+  for (auto &task : ready_tasks) {
+    if (task.GetTaskSpecification().IsActorTask()) {
+      ready_actor_tasks.push_back(std::move(task));
+    } else {
+      ready_non_actor_tasks.push_back(std::move(task));
+    }
+  }
+  if (!ready_actor_tasks.empty()) {
+    QueueReadyActorTasks(ready_actor_tasks);
+  }
+  if (!ready_non_actor_tasks.empty()) {
+    local_queues_.QueueReadyTasks(ready_non_actor_tasks);
     // Schedule the newly ready tasks.
     ScheduleTasks();
   }
 }
 
-void NodeManager::HandleObjectMissing(const ObjectID &object_id) {
-  // Notify the task dependency manager that this object is no longer local.
-  const auto waiting_task_ids = task_dependency_manager_.HandleObjectMissing(object_id);
+void NodeManager::HandleObjectsMissing(const std::vector<ObjectID> &object_ids) {
+  // Notify the task dependency manager that these objects are no longer local.
+  // A task is only returned for the first of its arguments that goes missing.
+  std::vector<TaskID> waiting_task_ids;
+  for (const auto &object_id : object_ids) {
+    const auto task_ids = task_dependency_manager_.HandleObjectMissing(object_id);
+    waiting_task_ids.insert(waiting_task_ids.end(), task_ids.begin(), task_ids.end());
+  }
   // Transition any tasks that were in the runnable state and are dependent on
-  // this object to the waiting state.
+  // these objects to the waiting state.
   if (!waiting_task_ids.empty()) {
     // Transition the tasks back to the waiting state. They will be made
     // runnable once the deleted object becomes available again.
-    std::unordered_set<TaskID> waiting_task_id_set(waiting_task_ids.begin(),
-                                                   waiting_task_ids.end());
-    auto waiting_tasks = local_queues_.RemoveTasks(waiting_task_id_set);
-    local_queues_.QueueWaitingTasks(std::vector<Task>(waiting_tasks));
+    auto waiting_tasks = local_queues_.RemoveTasks(waiting_task_ids);
+    local_queues_.QueueWaitingTasks(waiting_tasks);
   }
 }
 
+void NodeManager::HandleForwardTaskWritten(const ClientID &node_id) {
+  if (deferred_forward_clients_.count(node_id) == 0) {
+    return;
+  }
+  auto it = remote_server_connections_.find(node_id);
+  if (it != remote_server_connections_.end() && !it->second->IsBelowLowWaterMark()) {
+    return;
+  }
+  // The remote node manager caught up, so schedule the tasks that we deferred
+  // forwarding to it. Post this so that it does not run inside the
+  // connection's write handler.
+  deferred_forward_clients_.erase(node_id);
+  io_service_.post([this]() { ScheduleTasks(); });
+}
+
 ray::Status NodeManager::ForwardTask(const Task &task, const ClientID &node_id) {
   const auto &spec = task.GetTaskSpecification();
   auto task_id = spec.TaskId();
@@ -794,42 +1317,49 @@ ray::Status NodeManager::ForwardTask(const Task &task, const ClientID &node_id)
     return ray::Status::IOError("NodeManager connection not found");
   }
 
+  // Queue the request on the connection instead of blocking on it, so that a
+  // slow remote node manager does not stall scheduling on this node.
   auto &server_conn = it->second;
-  auto status = server_conn.WriteMessage(protocol::MessageType_ForwardTaskRequest,
-                                         fbb.GetSize(), fbb.GetBufferPointer());
-  if (status.ok()) {
-    // If we were able to forward the task, remove the forwarded task from the
-    // lineage cache since the receiving node is now responsible for writing
-    // the task to the GCS.
-    lineage_cache_.RemoveWaitingTask(task_id);
-    // Notify the task dependency manager that we are no longer responsible
-    // for executing this task.
-    task_dependency_manager_.TaskCanceled(task_id);
-    // Preemptively push any local arguments to the receiving node. For now, we
-    // only do this with actor tasks, since actor tasks must be executed by a
-    // specific process and therefore have affinity to the receiving node.
-    if (spec.IsActorTask()) {
-      // Iterate through the object's arguments. NOTE(swang): We do not include
-      // the execution dependencies here since those cannot be transferred
-      // between nodes.
-      for (int i = 0; i < spec.NumArgs(); ++i) {
-        int count = spec.ArgIdCount(i);
-        for (int j = 0; j < count; j++) {
-          ObjectID argument_id = spec.ArgId(i, j);
-          // If the argument is local, then push it to the receiving node.
-          if (task_dependency_manager_.CheckObjectLocal(argument_id)) {
-            RAY_CHECK_OK(object_manager_.Push(argument_id, node_id));
-          }
+  server_conn->WriteMessageAsync(
+      protocol::MessageType_ForwardTaskRequest, fbb.GetSize(), fbb.GetBufferPointer(),
+      [this, task_id, node_id](const ray::Status &status) {
+        if (!status.ok()) {
+          // TODO(atumanov): caller must handle ForwardTask failure to ensure
+          // tasks are not lost.
+          RAY_LOG(FATAL) << "[NodeManager][ForwardTask] failed to forward task "
+                         << task_id << " to node " << node_id;
+        }
+        HandleForwardTaskWritten(node_id);
+      });
+
+  // Remove the forwarded task from the lineage cache since the receiving node
+  // is now responsible for writing the task to the GCS.
+  lineage_cache_.RemoveWaitingTask(task_id);
+  // Notify the task dependency manager that we are no longer responsible
+  // for executing this task.
+  task_dependency_manager_.TaskCanceled(task_id);
+  // Preemptively push any local arguments to the receiving node. For now, we
+  // only do this with actor tasks, since actor tasks must be executed by a
+  // specific process and therefore have affinity to the receiving node.
+  if (spec.IsActorTask()) {
+    // Iterate through the object's arguments. NOTE(swang): We do not include
+    // the execution dependencies here since those cannot be transferred
+    // between nodes.
+    for (int i = 0; i < spec.NumArgs(); ++i) {
+      int count = spec.ArgIdCount(i);
+      for (int j = 0; j < count; j++) {
+        ObjectID argument_id = spec.ArgId(i, j);
+        // If the argument is local, then push it to the receiving node. With
+        // streaming, an argument that is still arriving is forwarded as its
+        // chunks arrive.
+        if (task_dependency_manager_.CheckObjectLocal(argument_id) ||
+            object_manager_.IsReceiving(argument_id)) {
+          RAY_CHECK_OK(object_manager_.Push(argument_id, node_id));
         }
       }
     }
-  } else {
-    // TODO(atumanov): caller must handle ForwardTask failure to ensure tasks are not
-    // lost.
-    RAY_LOG(FATAL) << "[NodeManager][ForwardTask] failed to forward task " << task_id
-                   << " to node " << node_id;
   }
-  return status;
+  return ray::Status::OK();
 }
 
 }  // namespace raylet
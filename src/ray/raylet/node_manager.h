@@ -1,12 +1,21 @@
 #ifndef RAY_RAYLET_NODE_MANAGER_H
 #define RAY_RAYLET_NODE_MANAGER_H
 
+#include <chrono>
+#include <unordered_set>
+
+#include "plasma/client.h"
+
 // clang-format off
 #include "ray/raylet/task.h"
 #include "ray/object_manager/object_manager.h"
 #include "ray/common/client_connection.h"
+#include "ray/common/submission_ring.h"
+#include "ray/raylet/actor_mailbox.h"
 #include "ray/raylet/actor_registration.h"
+#include "ray/raylet/client_message_queue.h"
 #include "ray/raylet/lineage_cache.h"
+#include "ray/raylet/object_store_memory.h"
 #include "ray/raylet/scheduling_policy.h"
 #include "ray/raylet/scheduling_queue.h"
 #include "ray/raylet/scheduling_resources.h"
@@ -24,6 +33,10 @@ struct NodeManagerConfig {
   int num_initial_workers;
   std::vector<std::string> worker_command;
   uint64_t heartbeat_period_ms;
+  /// The capacity of the local object store in bytes, or 0 if it is unknown.
+  int64_t object_store_memory;
+  /// The socket name of the local object store.
+  std::string store_socket_name;
 };
 
 class NodeManager {
@@ -49,6 +62,14 @@ class NodeManager {
   void ProcessClientMessage(const std::shared_ptr<LocalClientConnection> &client,
                             int64_t message_type, const uint8_t *message);
 
+  /// Process a message from a client that was already parsed on an I/O
+  /// thread. Like the method above, this listens for more messages from the
+  /// client if the client is still alive, either on the client's socket or in
+  /// its submission ring, as the message says.
+  ///
+  /// \param message The parsed message.
+  void ProcessClientMessage(const ClientMessage &message);
+
   void ProcessNewNodeManager(TcpClientConnection &node_manager_client);
 
   void ProcessNodeManagerMessage(TcpClientConnection &node_manager_client,
@@ -57,6 +78,26 @@ class NodeManager {
   ray::Status RegisterGcs();
 
  private:
+  /// Handle a message from a local client, which arrived either on its socket
+  /// or in its submission ring.
+  ///
+  /// \param client The client that sent the message.
+  /// \param message_type The message type (e.g., a flatbuffer enum).
+  /// \param message A pointer to the message data.
+  /// \return False if the client disconnected, true otherwise.
+  bool HandleClientMessage(const std::shared_ptr<LocalClientConnection> &client,
+                           int64_t message_type, const uint8_t *message);
+  /// Handle every message in a client's submission ring, until the ring is
+  /// empty and waiting for the client to ring the doorbell again. At most
+  /// raylet_submission_ring_max_drain messages are handled per call, and a call
+  /// for the rest is posted to the event loop. This is only used if the main
+  /// thread reads the messages of the local clients. Otherwise, the I/O threads
+  /// parse the rings, like the sockets.
+  ///
+  /// \param client The client that owns the ring.
+  /// \return False if the client disconnected, true otherwise.
+  bool DrainSubmissionRing(const std::shared_ptr<LocalClientConnection> &client);
+
   /// Methods for handling clients.
   /// Handler for the addition of a new GCS client.
   void ClientAdded(const ClientTableDataT &data);
@@ -73,38 +114,108 @@ class NodeManager {
   void SubmitTask(const Task &task, const Lineage &uncommitted_lineage);
   /// Assign a task. The task is assumed to not be queued in local_queues_.
   void AssignTask(Task &task);
+  /// Send a task to a worker to execute, and do the accounting for a task that
+  /// has started to execute. This does not mark the task as running. The task
+  /// is written to the worker asynchronously. If the write fails, the worker is
+  /// disconnected by HandleTaskSendFailure.
+  ///
+  /// \param worker The worker to send the task to.
+  /// \param task The task to send.
+  void SendTaskToWorker(const std::shared_ptr<Worker> &worker, Task &task);
+  /// Handle a task that could not be written to its worker. If the task was
+  /// assigned to the worker, it is queued again for another worker. The worker
+  /// is then disconnected.
+  ///
+  /// \param connection The connection to the worker.
+  /// \param task_id The ID of the task that was not sent.
+  void HandleTaskSendFailure(const std::shared_ptr<LocalClientConnection> &connection,
+                             const TaskID &task_id);
+  /// Start a task that was sent to a worker ahead of time, now that the
+  /// worker finished its previous task. The task takes over the resources
+  /// that the previous task released.
+  ///
+  /// \param worker The worker.
+  /// \param task The task that was sent to the worker.
+  void StartSentTask(Worker &worker, const Task &task);
   /// Handle a worker finishing its assigned task.
   void FinishAssignedTask(Worker &worker);
   /// Schedule tasks.
   void ScheduleTasks();
   /// Resubmit a task whose return value needs to be reconstructed.
-  void ResubmitTask(const TaskID &task_id);
+  ///
+  /// \param task The task to re-execute, as committed to the GCS.
+  void ResubmitTask(const Task &task);
+  /// Store an invalid object for each of a task's return values, so that the
+  /// workers that get them raise an error instead of waiting forever.
+  ///
+  /// \param spec The task that failed.
+  void TreatTaskAsFailed(const TaskSpecification &spec);
   /// Forward a task to another node to execute. The task is assumed to not be
   /// queued in local_queues_.
   ray::Status ForwardTask(const Task &task, const ClientID &node_id);
+  /// Handle a forwarded task having been written to a remote node manager. If
+  /// we deferred forwarding tasks to it and its connection has drained, this
+  /// schedules those tasks again.
+  ///
+  /// \param node_id The ID of the remote node manager.
+  void HandleForwardTaskWritten(const ClientID &node_id);
   /// Dispatch locally scheduled tasks. This attempts the transition from "scheduled" to
   /// "running" task state.
   void DispatchTasks();
+  /// Find a worker that asked for its next task ahead of time, and whose
+  /// current task holds enough resources for the given task.
+  ///
+  /// \param resources The resources required by the task to send ahead.
+  /// \return The worker, or nullptr if there is none.
+  std::shared_ptr<Worker> FindPrefetchingWorker(const ResourceSet &resources) const;
+  /// Send a task to a worker ahead of time. The worker starts the task, with
+  /// the resources of its current task, once it finishes its current task.
+  /// The task is assumed to not be queued in local_queues_.
+  ///
+  /// \param worker The worker, which is executing another task.
+  /// \param task The task to send.
+  void PrefetchTask(const std::shared_ptr<Worker> &worker, Task &task);
+  /// Start the task that was sent ahead to a worker, if any.
+  ///
+  /// \param worker The worker, which just finished its assigned task.
+  /// \return Whether the worker started a task.
+  bool StartPrefetchedTask(const std::shared_ptr<Worker> &worker);
 
   /// Methods for actor scheduling.
   /// Handler for the creation of an actor, possibly on a remote node.
   void HandleActorCreation(const ActorID &actor_id,
                            const std::vector<ActorTableDataT> &data);
+  /// Queue tasks for a local actor whose arguments are ready. These bypass the
+  /// scheduling policy, since they can only run on the actor's worker.
+  ///
+  /// \param tasks The actor tasks.
+  void QueueReadyActorTasks(const std::vector<Task> &tasks);
+  /// Send a local actor's ready tasks to its worker, in order, until the
+  /// worker has the maximum number of pipelined tasks.
+  ///
+  /// \param actor_id The ID of the actor.
+  void DispatchActorTasks(const ActorID &actor_id);
+  /// Dispatch the tasks of the idle local actors whose next task was waiting
+  /// for local resources. This is called whenever a task releases resources.
+  void DispatchWaitingActorTasks();
+  /// Start the next task that was pipelined to an actor's worker, if any.
+  ///
+  /// \param worker The actor's worker, which just finished its assigned task.
+  /// \return Whether the worker started a pipelined task.
+  bool StartPipelinedActorTask(Worker &worker);
 
   /// Methods for managing object dependencies.
-  /// Handle a dependency required by a queued task that is missing locally.
-  /// The dependency is (1) on a remote node, (2) pending creation on a remote
-  /// node, or (3) missing from all nodes and requires reconstruction.
-  void HandleRemoteDependencyRequired(const ObjectID &dependency_id);
-  /// Handle a dependency that was previously required by a queued task that is
-  /// no longer required.
-  void HandleRemoteDependencyCanceled(const ObjectID &dependency_id);
   /// Handle an object becoming local. This updates any local accounting, but
-  /// does not write to any global accounting in the GCS.
+  /// does not write to any global accounting in the GCS. The tasks that become
+  /// ready are handled in a batch, once the current event loop iteration is
+  /// done.
   void HandleObjectLocal(const ObjectID &object_id);
-  /// Handle an object that is no longer local. This updates any local
+  /// Move the batch of tasks whose dependencies became local to the ready
+  /// state, and schedule them.
+  void HandleReadyTasks();
+  /// Handle a batch of objects that are no longer local. This updates any local
   /// accounting, but does not write to any global accounting in the GCS.
-  void HandleObjectMissing(const ObjectID &object_id);
+  void HandleObjectsMissing(const std::vector<ObjectID> &object_ids);
 
   boost::asio::io_service &io_service_;
   ObjectManager &object_manager_;
@@ -120,17 +231,53 @@ class NodeManager {
   WorkerPool worker_pool_;
   /// A set of queues to maintain tasks.
   SchedulingQueue local_queues_;
+  /// The object store memory reserved for the outputs of the running tasks.
+  ObjectStoreMemory object_store_memory_;
   /// The scheduling policy in effect for this local scheduler.
   SchedulingPolicy scheduling_policy_;
   /// The reconstruction policy for deciding when to re-execute a task.
   ReconstructionPolicy reconstruction_policy_;
   /// A manager to make waiting tasks's missing object dependencies available.
   TaskDependencyManager task_dependency_manager_;
+  /// Whether a call to HandleReadyTasks is posted to the event loop.
+  bool ready_tasks_handler_posted_;
+  /// The prefetch statistics as of the last report, and the time of the report.
+  PrefetchStats last_prefetch_stats_;
+  std::chrono::steady_clock::time_point last_prefetch_report_time_;
   /// The lineage cache for the GCS object and task tables.
   LineageCache lineage_cache_;
   std::vector<ClientID> remote_clients_;
-  std::unordered_map<ClientID, TcpServerConnection> remote_server_connections_;
+  std::unordered_map<ClientID, std::shared_ptr<TcpServerConnection>>
+      remote_server_connections_;
+  /// The remote node managers that we deferred forwarding tasks to because
+  /// their connection was above its high-water mark.
+  std::unordered_set<ClientID> deferred_forward_clients_;
   std::unordered_map<ActorID, ActorRegistration> actor_registry_;
+  /// The tasks for each local actor that are ready to be sent to its worker.
+  std::unordered_map<ActorID, ActorMailbox> actor_mailboxes_;
+  /// A local actor's worker that is executing a task, and the tasks that were
+  /// already sent to it to execute next, in order.
+  struct ActorPipeline {
+    std::shared_ptr<Worker> worker;
+    std::deque<Task> pipelined_tasks;
+  };
+  /// The pipelines of the local actors whose worker is executing a task.
+  std::unordered_map<ActorID, ActorPipeline> actor_pipelines_;
+  /// The idle local actors whose next task is waiting for local resources.
+  std::unordered_set<ActorID> actors_waiting_for_resources_;
+  /// The workers that asked for their next task ahead of time, and the
+  /// resources that their current task will release.
+  std::unordered_map<std::shared_ptr<Worker>, ResourceSet> prefetching_workers_;
+  /// The tasks that were sent ahead to workers, by worker.
+  std::unordered_map<std::shared_ptr<Worker>, Task> prefetched_tasks_;
+  /// The shared memory submission rings of the local clients that registered
+  /// one.
+  std::unordered_map<std::shared_ptr<LocalClientConnection>,
+                     std::shared_ptr<SubmissionRing>>
+      submission_rings_;
+  /// A client connection to the local object store, for storing the return
+  /// values of tasks that failed.
+  plasma::PlasmaClient store_client_;
 };
 
 }  // namespace raylet
@@ -37,6 +37,8 @@ class TestObjectManagerBase : public ::testing::Test {
     node_manager_config.resource_config =
         ray::raylet::ResourceSet(std::move(static_resource_conf));
     node_manager_config.num_initial_workers = 0;
+    node_manager_config.object_store_memory = 1000000000;
+    node_manager_config.store_socket_name = store_socket_name;
     // Use a default worker that can execute empty tasks with dependencies.
     node_manager_config.worker_command.push_back("python");
     node_manager_config.worker_command.push_back(
@@ -56,6 +58,12 @@ class TestObjectManagerBase : public ::testing::Test {
     ObjectManagerConfig om_config_1;
     om_config_1.store_socket_name = store_sock_1;
     om_config_1.max_push_retries = 1000;
+    om_config_1.max_inflight_pull_bytes = 1000000000;
+    om_config_1.chunk_timeout_ms = 1000;
+    om_config_1.max_pull_attempts = 5;
+    om_config_1.compression_codec = CompressionCodec::CompressionCodec_None;
+    om_config_1.compression_min_chunk_bytes = 0;
+    om_config_1.streaming = false;
     server1.reset(new ray::raylet::Raylet(
         main_service, "raylet_1", "0.0.0.0", "127.0.0.1", 6379,
         GetNodeManagerConfig("raylet_1", store_sock_1), om_config_1, gcs_client_1));
@@ -65,6 +73,12 @@ class TestObjectManagerBase : public ::testing::Test {
     ObjectManagerConfig om_config_2;
     om_config_2.store_socket_name = store_sock_2;
     om_config_2.max_push_retries = 1000;
+    om_config_2.max_inflight_pull_bytes = 1000000000;
+    om_config_2.chunk_timeout_ms = 1000;
+    om_config_2.max_pull_attempts = 5;
+    om_config_2.compression_codec = CompressionCodec::CompressionCodec_None;
+    om_config_2.compression_min_chunk_bytes = 0;
+    om_config_2.streaming = false;
     server2.reset(new ray::raylet::Raylet(
         main_service, "raylet_2", "0.0.0.0", "127.0.0.1", 6379,
         GetNodeManagerConfig("raylet_2", store_sock_2), om_config_2, gcs_client_2));
@@ -151,18 +165,22 @@ class TestObjectManagerIntegration : public TestObjectManagerBase {
   void AddTransferTestHandlers() {
     ray::Status status = ray::Status::OK();
     status = server1->object_manager_.SubscribeObjAdded(
-        [this](const ObjectInfoT &object_info) {
-          v1.push_back(ObjectID::from_binary(object_info.object_id));
-          if (v1.size() == num_expected_objects && v1.size() == v2.size()) {
-            TestPushComplete();
+        [this](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            v1.push_back(object_info.object_id);
+            if (v1.size() == num_expected_objects && v1.size() == v2.size()) {
+              TestPushComplete();
+            }
           }
         });
     RAY_CHECK_OK(status);
     status = server2->object_manager_.SubscribeObjAdded(
-        [this](const ObjectInfoT &object_info) {
-          v2.push_back(ObjectID::from_binary(object_info.object_id));
-          if (v2.size() == num_expected_objects && v1.size() == v2.size()) {
-            TestPushComplete();
+        [this](const std::vector<LocalObjectInfo> &objects) {
+          for (const auto &object_info : objects) {
+            v2.push_back(object_info.object_id);
+            if (v2.size() == num_expected_objects && v1.size() == v2.size()) {
+              TestPushComplete();
+            }
           }
         });
     RAY_CHECK_OK(status);
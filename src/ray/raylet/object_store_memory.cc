@@ -0,0 +1,161 @@
+#include "ray/raylet/object_store_memory.h"
+
+#include <algorithm>
+
+#include "ray/util/logging.h"
+
+namespace {
+
+/// The weight of the newest sample in the moving average of a function's
+/// output size.
+constexpr double kOutputSizeSmoothing = 0.25;
+
+/// The maximum number of finished tasks that are remembered while they wait
+/// for their return values to be sealed.
+constexpr size_t kMaxFinishedTasks = 1024;
+
+}  // namespace
+
+namespace ray {
+
+namespace raylet {
+
+ObjectStoreMemory::ObjectStoreMemory(int64_t capacity, int64_t default_output_size)
+    : capacity_(capacity),
+      default_output_size_(default_output_size),
+      bytes_reserved_(0),
+      tasks_(),
+      finished_tasks_(),
+      output_sizes_() {
+  RAY_CHECK(capacity_ >= 0);
+  RAY_CHECK(default_output_size_ >= 0);
+}
+
+int64_t ObjectStoreMemory::EstimateOutputSize(const TaskSpecification &spec) const {
+  auto it = output_sizes_.find(spec.FunctionId());
+  if (it == output_sizes_.end()) {
+    return default_output_size_;
+  }
+  return static_cast<int64_t>(it->second);
+}
+
+bool ObjectStoreMemory::CanAdmit(const TaskSpecification &spec) const {
+  if (capacity_ == 0 || bytes_reserved_ == 0) {
+    return true;
+  }
+  return bytes_reserved_ + EstimateOutputSize(spec) <= capacity_;
+}
+
+void ObjectStoreMemory::Reserve(const TaskSpecification &spec) {
+  // A task that is executed again replaces what is left of its last execution.
+  Release(spec.TaskId());
+  TaskOutputs &outputs = tasks_[spec.TaskId()];
+  outputs.function_id = spec.FunctionId();
+  // The dummy return value of an actor task is never sealed in the store.
+  outputs.num_returns_remaining = spec.NumReturns();
+  if (spec.IsActorTask() || spec.IsActorCreationTask()) {
+    outputs.num_returns_remaining--;
+  }
+  outputs.bytes_sealed = 0;
+  outputs.bytes_reserved = EstimateOutputSize(spec);
+  outputs.running = true;
+  outputs.blocked = false;
+  bytes_reserved_ += outputs.bytes_reserved;
+}
+
+void ObjectStoreMemory::Release(const TaskID &task_id) {
+  auto it = tasks_.find(task_id);
+  if (it == tasks_.end() || !it->second.running) {
+    return;
+  }
+  TaskOutputs &outputs = it->second;
+  if (!outputs.blocked) {
+    bytes_reserved_ -= outputs.bytes_reserved;
+  }
+  outputs.bytes_reserved = 0;
+  outputs.running = false;
+  outputs.blocked = false;
+  if (outputs.num_returns_remaining <= 0) {
+    tasks_.erase(it);
+    return;
+  }
+  // Remember the task until its return values are sealed, but only for so
+  // many tasks.
+  finished_tasks_.push_back(task_id);
+  while (finished_tasks_.size() > kMaxFinishedTasks) {
+    auto oldest = tasks_.find(finished_tasks_.front());
+    if (oldest != tasks_.end() && !oldest->second.running) {
+      tasks_.erase(oldest);
+    }
+    finished_tasks_.pop_front();
+  }
+}
+
+void ObjectStoreMemory::MarkBlocked(const TaskID &task_id) {
+  auto it = tasks_.find(task_id);
+  if (it == tasks_.end() || !it->second.running || it->second.blocked) {
+    return;
+  }
+  it->second.blocked = true;
+  bytes_reserved_ -= it->second.bytes_reserved;
+}
+
+void ObjectStoreMemory::MarkUnblocked(const TaskID &task_id) {
+  auto it = tasks_.find(task_id);
+  if (it == tasks_.end() || !it->second.running || !it->second.blocked) {
+    return;
+  }
+  it->second.blocked = false;
+  bytes_reserved_ += it->second.bytes_reserved;
+}
+
+bool ObjectStoreMemory::HandleObjectsAdded(const std::vector<LocalObjectInfo> &objects) {
+  const int64_t bytes_reserved = bytes_reserved_;
+  for (const auto &object_info : objects) {
+    auto it = tasks_.find(ComputeTaskId(object_info.object_id));
+    if (it == tasks_.end()) {
+      // The object was created by a task on another node.
+      continue;
+    }
+    TaskOutputs &outputs = it->second;
+    const int64_t size = object_info.data_size + object_info.metadata_size;
+    outputs.bytes_sealed += size;
+    // The sealed object uses up its share of the reservation.
+    const int64_t used = std::min(size, outputs.bytes_reserved);
+    outputs.bytes_reserved -= used;
+    if (!outputs.blocked) {
+      bytes_reserved_ -= used;
+    }
+    // Only return values count towards completion, since the number of
+    // objects that a task puts is not known in advance.
+    if (ComputeObjectIndex(object_info.object_id) > 0) {
+      outputs.num_returns_remaining--;
+      if (outputs.num_returns_remaining == 0) {
+        LearnOutputSize(outputs.function_id, outputs.bytes_sealed);
+        if (!outputs.running) {
+          tasks_.erase(it);
+        }
+      }
+    }
+  }
+  return bytes_reserved_ < bytes_reserved;
+}
+
+int64_t ObjectStoreMemory::Capacity() const { return capacity_; }
+
+int64_t ObjectStoreMemory::Headroom() const {
+  return std::max<int64_t>(capacity_ - bytes_reserved_, 0);
+}
+
+void ObjectStoreMemory::LearnOutputSize(const FunctionID &function_id,
+                                        int64_t num_bytes) {
+  auto inserted = output_sizes_.emplace(function_id, num_bytes);
+  if (!inserted.second) {
+    double &output_size = inserted.first->second;
+    output_size += kOutputSizeSmoothing * (num_bytes - output_size);
+  }
+}
+
+}  // namespace raylet
+
+}  // namespace ray
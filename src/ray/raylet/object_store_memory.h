@@ -0,0 +1,141 @@
+#ifndef RAY_RAYLET_OBJECT_STORE_MEMORY_H
+#define RAY_RAYLET_OBJECT_STORE_MEMORY_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/id.h"
+#include "ray/object_manager/local_object_info.h"
+#include "ray/raylet/task_spec.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// The name under which a node advertises the object store memory that is not
+/// reserved by its running tasks, in bytes.
+const std::string kObjectStoreMemoryResourceLabel = "ObjectStoreMemory";
+
+/// \class ObjectStoreMemory
+///
+/// Treats the memory of the local object store as a schedulable resource. Each
+/// task that runs on the node reserves the number of bytes that its outputs
+/// are expected to take up in the store, as learned from the outputs of
+/// earlier tasks for the same function. The reservation shrinks as the task's
+/// outputs are sealed, and whatever is left of it is released when the task
+/// finishes. Sealed objects are not charged against the capacity, since the
+/// store evicts them as needed to make room for new objects.
+class ObjectStoreMemory {
+ public:
+  /// Create the accounting for an object store.
+  ///
+  /// \param capacity The capacity of the object store in bytes. If this is 0,
+  /// the capacity is unknown and every task is admitted.
+  /// \param default_output_size The estimated size in bytes of the outputs of
+  /// a task whose function has not completed on this node yet.
+  ObjectStoreMemory(int64_t capacity, int64_t default_output_size);
+
+  /// Estimate the total size of a task's outputs.
+  ///
+  /// \param spec The task.
+  /// \return The estimated size in bytes.
+  int64_t EstimateOutputSize(const TaskSpecification &spec) const;
+
+  /// Whether there is enough unreserved memory to run a task. A task is
+  /// always admitted if no memory is reserved, so that a task whose outputs
+  /// are estimated to be larger than the store still runs.
+  ///
+  /// \param spec The task.
+  /// \return Whether the task may run.
+  bool CanAdmit(const TaskSpecification &spec) const;
+
+  /// Reserve memory for the outputs of a task that started to run.
+  ///
+  /// \param spec The task.
+  void Reserve(const TaskSpecification &spec);
+
+  /// Release the rest of a task's reservation, because the task finished or
+  /// its worker died. Outputs of the task that are sealed afterwards are still
+  /// used to learn the size of the function's outputs.
+  ///
+  /// \param task_id The ID of the task.
+  void Release(const TaskID &task_id);
+
+  /// Stop counting a task's reservation against the store while its worker is
+  /// blocked, so that the tasks it waits for can be admitted. The reservation
+  /// still shrinks as the task's outputs are sealed.
+  ///
+  /// \param task_id The ID of the task.
+  void MarkBlocked(const TaskID &task_id);
+
+  /// Count what is left of a blocked task's reservation against the store
+  /// again, even if that oversubscribes the store.
+  ///
+  /// \param task_id The ID of the task.
+  void MarkUnblocked(const TaskID &task_id);
+
+  /// Handle objects that were sealed in the local object store.
+  ///
+  /// \param objects The sealed objects.
+  /// \return Whether the memory reserved by running tasks went down.
+  bool HandleObjectsAdded(const std::vector<LocalObjectInfo> &objects);
+
+  /// Get the capacity of the object store.
+  ///
+  /// \return The capacity in bytes, or 0 if it is unknown.
+  int64_t Capacity() const;
+
+  /// Get the memory that is not reserved by running tasks.
+  ///
+  /// \return The unreserved memory in bytes.
+  int64_t Headroom() const;
+
+ private:
+  /// The outputs of a task that ran on this node.
+  struct TaskOutputs {
+    /// The function that the task executed.
+    FunctionID function_id;
+    /// The number of return values that were not sealed yet.
+    int64_t num_returns_remaining;
+    /// The total size of the task's outputs that were sealed so far.
+    int64_t bytes_sealed;
+    /// The part of the task's reservation that is not used up yet.
+    int64_t bytes_reserved;
+    /// Whether the task is still running.
+    bool running;
+    /// Whether the task's worker is blocked. The reservation of a blocked task
+    /// is not counted in bytes_reserved_.
+    bool blocked;
+  };
+
+  /// Record the total size of the outputs of a task once all of its return
+  /// values are sealed.
+  ///
+  /// \param function_id The function that the task executed.
+  /// \param num_bytes The total size of the task's outputs.
+  void LearnOutputSize(const FunctionID &function_id, int64_t num_bytes);
+
+  /// The capacity of the store in bytes, or 0 if it is unknown.
+  const int64_t capacity_;
+  /// The estimated output size of functions that have not completed yet.
+  const int64_t default_output_size_;
+  /// The total memory reserved by running tasks that are not blocked.
+  int64_t bytes_reserved_;
+  /// The tasks that are running, and the finished tasks whose return values
+  /// were not all sealed yet.
+  std::unordered_map<TaskID, TaskOutputs> tasks_;
+  /// Finished tasks that may still wait for return values, oldest first. This
+  /// bounds the number of them that are remembered, since a return value
+  /// that already existed in the store is never sealed again.
+  std::deque<TaskID> finished_tasks_;
+  /// A moving average of the total size of the outputs of each function.
+  std::unordered_map<FunctionID, double> output_sizes_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_OBJECT_STORE_MEMORY_H
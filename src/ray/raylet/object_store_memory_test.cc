@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+
+#include "ray/raylet/object_store_memory.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+constexpr int64_t kCapacity = 1000;
+constexpr int64_t kDefaultOutputSize = 100;
+
+/// Build a task for a function that returns the given number of values.
+TaskSpecification MakeTask(const FunctionID &function_id, int64_t num_returns) {
+  std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  return TaskSpecification(UniqueID::nil(), UniqueID::from_random(), 0, function_id,
+                           task_arguments, num_returns, {{"CPU", 1}});
+}
+
+LocalObjectInfo MakeObject(const ObjectID &object_id, int64_t size) {
+  return LocalObjectInfo{object_id, size, 0};
+}
+
+}  // namespace
+
+TEST(ObjectStoreMemoryTest, TestAdmission) {
+  ObjectStoreMemory memory(kCapacity, kDefaultOutputSize);
+  const FunctionID function_id = FunctionID::from_random();
+  std::vector<TaskSpecification> tasks;
+  // Tasks are admitted until their reservations fill the store.
+  for (int i = 0; i < kCapacity / kDefaultOutputSize; i++) {
+    tasks.push_back(MakeTask(function_id, 1));
+    ASSERT_TRUE(memory.CanAdmit(tasks.back()));
+    memory.Reserve(tasks.back());
+  }
+  ASSERT_EQ(memory.Headroom(), 0);
+  auto task = MakeTask(function_id, 1);
+  ASSERT_FALSE(memory.CanAdmit(task));
+  // A sealed output uses up part of its task's reservation.
+  memory.HandleObjectsAdded({MakeObject(tasks[0].ReturnId(0), 40)});
+  ASSERT_EQ(memory.Headroom(), 40);
+  // A finished task releases the rest of its reservation.
+  memory.Release(tasks[1].TaskId());
+  ASSERT_EQ(memory.Headroom(), 140);
+  ASSERT_TRUE(memory.CanAdmit(task));
+  // Releasing a task twice has no effect.
+  memory.Release(tasks[1].TaskId());
+  ASSERT_EQ(memory.Headroom(), 140);
+  for (const auto &running_task : tasks) {
+    memory.Release(running_task.TaskId());
+  }
+  ASSERT_EQ(memory.Headroom(), kCapacity);
+}
+
+TEST(ObjectStoreMemoryTest, TestLargeTask) {
+  ObjectStoreMemory memory(kCapacity, 2 * kCapacity);
+  // A task whose outputs are larger than the store runs on its own.
+  auto large_task = MakeTask(FunctionID::from_random(), 1);
+  ASSERT_TRUE(memory.CanAdmit(large_task));
+  memory.Reserve(large_task);
+  ASSERT_EQ(memory.Headroom(), 0);
+  ASSERT_FALSE(memory.CanAdmit(MakeTask(FunctionID::from_random(), 1)));
+  memory.Release(large_task.TaskId());
+  ASSERT_EQ(memory.Headroom(), kCapacity);
+}
+
+TEST(ObjectStoreMemoryTest, TestUnknownCapacity) {
+  ObjectStoreMemory memory(0, kDefaultOutputSize);
+  const FunctionID function_id = FunctionID::from_random();
+  for (int i = 0; i < 100; i++) {
+    auto task = MakeTask(function_id, 1);
+    ASSERT_TRUE(memory.CanAdmit(task));
+    memory.Reserve(task);
+  }
+  ASSERT_EQ(memory.Headroom(), 0);
+}
+
+TEST(ObjectStoreMemoryTest, TestLearnOutputSize) {
+  ObjectStoreMemory memory(kCapacity, kDefaultOutputSize);
+  const FunctionID function_id = FunctionID::from_random();
+  auto task = MakeTask(function_id, 2);
+  ASSERT_EQ(memory.EstimateOutputSize(task), kDefaultOutputSize);
+  memory.Reserve(task);
+  // Objects that the task puts count towards its output size.
+  memory.HandleObjectsAdded({MakeObject(ComputePutId(task.TaskId(), 1), 100)});
+  memory.HandleObjectsAdded({MakeObject(task.ReturnId(0), 200)});
+  ASSERT_EQ(memory.EstimateOutputSize(task), kDefaultOutputSize);
+  // The task finishes before its last return value is sealed.
+  memory.Release(task.TaskId());
+  memory.HandleObjectsAdded({MakeObject(task.ReturnId(1), 300)});
+  ASSERT_EQ(memory.EstimateOutputSize(MakeTask(function_id, 2)), 600);
+  // Other functions keep the default estimate.
+  ASSERT_EQ(memory.EstimateOutputSize(MakeTask(FunctionID::from_random(), 2)),
+            kDefaultOutputSize);
+  // Later tasks move the estimate towards their output size.
+  auto next_task = MakeTask(function_id, 1);
+  memory.Reserve(next_task);
+  ASSERT_EQ(memory.Headroom(), kCapacity - 600);
+  memory.HandleObjectsAdded({MakeObject(next_task.ReturnId(0), 200)});
+  ASSERT_EQ(memory.Headroom(), kCapacity - 400);
+  ASSERT_EQ(memory.EstimateOutputSize(next_task), 500);
+  memory.Release(next_task.TaskId());
+  ASSERT_EQ(memory.Headroom(), kCapacity);
+}
+
+TEST(ObjectStoreMemoryTest, TestRemoteObjects) {
+  ObjectStoreMemory memory(kCapacity, kDefaultOutputSize);
+  auto task = MakeTask(FunctionID::from_random(), 1);
+  memory.Reserve(task);
+  // Objects created by tasks on other nodes do not affect the reservations.
+  memory.HandleObjectsAdded({MakeObject(ObjectID::from_random(), 50)});
+  ASSERT_EQ(memory.Headroom(), kCapacity - kDefaultOutputSize);
+}
+
+TEST(ObjectStoreMemoryTest, TestBlockedTask) {
+  ObjectStoreMemory memory(kCapacity, kCapacity / 2);
+  const FunctionID function_id = FunctionID::from_random();
+  auto task = MakeTask(function_id, 1);
+  memory.Reserve(task);
+  auto other_task = MakeTask(function_id, 1);
+  memory.Reserve(other_task);
+  auto nested_task = MakeTask(function_id, 1);
+  ASSERT_FALSE(memory.CanAdmit(nested_task));
+  // A blocked task's reservation does not keep the tasks that it waits for
+  // from running.
+  memory.MarkBlocked(task.TaskId());
+  ASSERT_EQ(memory.Headroom(), kCapacity / 2);
+  ASSERT_TRUE(memory.CanAdmit(nested_task));
+  memory.Reserve(nested_task);
+  // Sealing an output of the blocked task still uses up its reservation.
+  const ObjectID put_id = ComputePutId(task.TaskId(), 1);
+  ASSERT_FALSE(memory.HandleObjectsAdded({MakeObject(put_id, 100)}));
+  ASSERT_TRUE(memory.HandleObjectsAdded({MakeObject(nested_task.ReturnId(0), 100)}));
+  ASSERT_EQ(memory.Headroom(), 100);
+  // Once unblocked, the task takes back the rest of its reservation, even
+  // though that oversubscribes the store.
+  memory.MarkUnblocked(task.TaskId());
+  ASSERT_EQ(memory.Headroom(), 0);
+  memory.Release(task.TaskId());
+  memory.Release(other_task.TaskId());
+  memory.Release(nested_task.TaskId());
+  ASSERT_EQ(memory.Headroom(), kCapacity);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -5,6 +5,9 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <iostream>
 
+#include "common/state/ray_config.h"
+#include "common_protocol.h"
+#include "ray/raylet/format/node_manager_generated.h"
 #include "ray/status.h"
 
 namespace ray {
@@ -17,8 +20,18 @@ Raylet::Raylet(boost::asio::io_service &main_service, const std::string &socket_
                const ObjectManagerConfig &object_manager_config,
                std::shared_ptr<gcs::AsyncGcsClient> gcs_client)
     : gcs_client_(gcs_client),
+      client_io_pool_(RayConfig::instance().raylet_client_io_threads() > 0
+                          ? new IoServicePool(
+                                RayConfig::instance().raylet_client_io_threads())
+                          : nullptr),
+      client_service_(nullptr),
       object_manager_(main_service, object_manager_config, gcs_client),
       node_manager_(main_service, node_manager_config, object_manager_, gcs_client_),
+      client_message_queue_(
+          main_service, RayConfig::instance().raylet_client_message_batch_size(),
+          [this](const ClientMessage &message) {
+            node_manager_.ProcessClientMessage(message);
+          }),
       socket_name_(socket_name),
       acceptor_(main_service, boost::asio::local::stream_protocol::endpoint(socket_name)),
       socket_(main_service),
@@ -40,7 +53,14 @@ Raylet::Raylet(boost::asio::io_service &main_service, const std::string &socket_
   RAY_CHECK_OK(RegisterPeriodicTimer(main_service));
 }
 
-Raylet::~Raylet() { RAY_CHECK_OK(gcs_client_->client_table().Disconnect()); }
+Raylet::~Raylet() {
+  // Stop reading from the local clients before the node manager, which the
+  // I/O threads hand their messages to, is destroyed.
+  if (client_io_pool_) {
+    client_io_pool_->Stop();
+  }
+  RAY_CHECK_OK(gcs_client_->client_table().Disconnect());
+}
 
 ray::Status Raylet::RegisterPeriodicTimer(boost::asio::io_service &io_service) {
   boost::posix_time::milliseconds timer_period_ms(100);
@@ -122,6 +142,12 @@ void Raylet::HandleAcceptObjectManager(const boost::system::error_code &error) {
 }
 
 void Raylet::DoAccept() {
+  if (client_io_pool_) {
+    // Accept the next client onto the next I/O thread, so that reading and
+    // parsing its messages happens there.
+    client_service_ = &client_io_pool_->Next();
+    socket_ = boost::asio::local::stream_protocol::socket(*client_service_);
+  }
   acceptor_.async_accept(socket_, boost::bind(&Raylet::HandleAccept, this,
                                               boost::asio::placeholders::error));
 }
@@ -131,19 +157,97 @@ void Raylet::HandleAccept(const boost::system::error_code &error) {
     // TODO: typedef these handlers.
     ClientHandler<boost::asio::local::stream_protocol> client_handler =
         [this](LocalClientConnection &client) { node_manager_.ProcessNewClient(client); };
-    MessageHandler<boost::asio::local::stream_protocol> message_handler = [this](
-        std::shared_ptr<LocalClientConnection> client, int64_t message_type,
-        const uint8_t *message) {
-      node_manager_.ProcessClientMessage(client, message_type, message);
-    };
+    MessageHandler<boost::asio::local::stream_protocol> message_handler;
+    if (client_io_pool_) {
+      // The handler owns the client's submission ring, so that the ring lives
+      // as long as the connection.
+      auto client_ring = std::make_shared<LocalClientRing>();
+      client_ring->service = client_service_;
+      message_handler = [this, client_ring](std::shared_ptr<LocalClientConnection> client,
+                                            int64_t message_type,
+                                            const uint8_t *message) {
+        ParseAndQueueClientMessage(client, message_type, message, client_ring);
+      };
+    } else {
+      message_handler = [this](std::shared_ptr<LocalClientConnection> client,
+                               int64_t message_type, const uint8_t *message) {
+        node_manager_.ProcessClientMessage(client, message_type, message);
+      };
+    }
     // Accept a new local client and dispatch it to the node manager.
-    auto new_connection = LocalClientConnection::Create(client_handler, message_handler,
-                                                        std::move(socket_));
+    auto new_connection = LocalClientConnection::Create(
+        client_handler, message_handler, std::move(socket_), client_service_);
   }
   // We're ready to accept another client.
   DoAccept();
 }
 
+void Raylet::ParseAndQueueClientMessage(
+    const std::shared_ptr<LocalClientConnection> &client, int64_t message_type,
+    const uint8_t *message, const std::shared_ptr<LocalClientRing> &client_ring) {
+  if (message_type == protocol::MessageType_SubmissionRingDoorbell &&
+      client_ring->ring != nullptr) {
+    DrainSubmissionRing(client, client_ring);
+    return;
+  }
+  std::unique_ptr<ClientMessage> parsed_message(new ClientMessage());
+  auto status = ParseClientMessage(client, message_type, message,
+                                   client->GetMessageLength(), parsed_message.get());
+  if (!status.ok()) {
+    // The client is broken or is not a Ray worker, so stop talking to it.
+    RAY_LOG(WARNING) << "Disconnecting client: " << status.ToString();
+    parsed_message->message_type = protocol::MessageType_DisconnectClient;
+  } else if (message_type == protocol::MessageType_RegisterSubmissionRing) {
+    // Open the ring here, since this thread is the ring's consumer.
+    auto request = flatbuffers::GetRoot<protocol::RegisterSubmissionRingRequest>(
+        parsed_message->message.data());
+    status = SubmissionRing::Open(string_from_flatbuf(*request->name()),
+                                  &client_ring->ring);
+    if (!status.ok()) {
+      // The client will write its messages to the ring, so we cannot talk to it
+      // without one.
+      RAY_LOG(WARNING) << "Failed to open submission ring, disconnecting client: "
+                       << status.ToString();
+      parsed_message->message_type = protocol::MessageType_DisconnectClient;
+    } else {
+      // The main thread has nothing to do for the registration.
+      client->ProcessMessages();
+      return;
+    }
+  }
+  client_message_queue_.Push(std::move(parsed_message));
+}
+
+void Raylet::DrainSubmissionRing(const std::shared_ptr<LocalClientConnection> &client,
+                                 const std::shared_ptr<LocalClientRing> &client_ring) {
+  std::vector<std::unique_ptr<ClientMessage>> messages;
+  bool waiting = ParseSubmissionRing(
+      client, *client_ring->ring,
+      RayConfig::instance().raylet_submission_ring_max_drain(), &messages);
+  if (messages.empty()) {
+    // The client rang the doorbell, but we already parsed its messages.
+    client->ProcessMessages();
+    return;
+  }
+  // Parse no more messages from this client until the main thread has handled
+  // these, so that a client cannot queue up more work than the main thread
+  // keeps up with.
+  for (auto &message : messages) {
+    message->read_socket = false;
+  }
+  if (waiting) {
+    messages.back()->read_socket = true;
+  } else {
+    messages.back()->drain_ring = [this, client, client_ring]() {
+      client_ring->service->post(
+          [this, client, client_ring]() { DrainSubmissionRing(client, client_ring); });
+    };
+  }
+  for (auto &message : messages) {
+    client_message_queue_.Push(std::move(message));
+  }
+}
+
 }  // namespace raylet
 
 }  // namespace ray
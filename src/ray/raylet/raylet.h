@@ -7,6 +7,8 @@
 #include <boost/asio/error.hpp>
 
 // clang-format off
+#include "ray/common/io_service_pool.h"
+#include "ray/raylet/client_message_queue.h"
 #include "ray/raylet/node_manager.h"
 #include "ray/object_manager/object_manager.h"
 #include "ray/raylet/scheduling_resources.h"
@@ -65,12 +67,56 @@ class Raylet {
 
   friend class TestObjectManagerIntegration;
 
+  /// The submission ring of a local client whose messages are read on an I/O
+  /// thread. Only that thread uses the ring.
+  struct LocalClientRing {
+    /// The event loop of the I/O thread that owns the client's socket.
+    boost::asio::io_service *service;
+    /// The client's submission ring, or null if it did not register one.
+    std::unique_ptr<SubmissionRing> ring;
+  };
+
+  /// Handle a message from a local client on the I/O thread that owns the
+  /// client's socket, by parsing it and queueing it for the main thread. The
+  /// client's submission ring is registered and drained on the I/O thread too.
+  ///
+  /// \param client The client that sent the message.
+  /// \param message_type The message type (e.g., a flatbuffer enum).
+  /// \param message A pointer to the message data.
+  /// \param client_ring The client's submission ring.
+  void ParseAndQueueClientMessage(const std::shared_ptr<LocalClientConnection> &client,
+                                  int64_t message_type, const uint8_t *message,
+                                  const std::shared_ptr<LocalClientRing> &client_ring);
+
+  /// Parse up to raylet_submission_ring_max_drain messages from a local
+  /// client's submission ring on the I/O thread that owns the client's socket,
+  /// and queue them for the main thread. Once the main thread has handled the
+  /// last of them, it either asks for the next messages from the ring or reads
+  /// the next message from the socket, if the ring is waiting for its doorbell.
+  ///
+  /// \param client The client that owns the ring.
+  /// \param client_ring The client's submission ring.
+  void DrainSubmissionRing(const std::shared_ptr<LocalClientConnection> &client,
+                           const std::shared_ptr<LocalClientRing> &client_ring);
+
   /// A client connection to the GCS.
   std::shared_ptr<gcs::AsyncGcsClient> gcs_client_;
+  /// The I/O threads that read and parse the messages of local clients, or
+  /// null if the main thread reads them. Each client's socket is only used on
+  /// the I/O thread that owns it. The node manager's writes and reads are run
+  /// there by the connection. This must outlive the connections of the local
+  /// clients, whose sockets belong to its event loops.
+  std::unique_ptr<IoServicePool> client_io_pool_;
+  /// The event loop of the I/O thread that the next client is accepted onto,
+  /// or null if there are no I/O threads.
+  boost::asio::io_service *client_service_;
   /// Manages client requests for object transfers and availability.
   ObjectManager object_manager_;
   /// Manages client requests for task submission and execution.
   NodeManager node_manager_;
+  /// The messages that the I/O threads parsed, waiting to be handled by the
+  /// node manager on the main thread.
+  ClientMessageQueue client_message_queue_;
   /// The name of the socket this raylet listens on.
   std::string socket_name_;
 
@@ -1,11 +1,259 @@
 #include "reconstruction_policy.h"
 
+#include "ray/raylet/format/node_manager_generated.h"
+
 namespace ray {
 
 namespace raylet {
 
-void ReconstructionPolicy::CheckObjectReconstruction(const ObjectID &object) {
-  throw std::runtime_error("Method not implemented");
+ReconstructionPolicy::ReconstructionPolicy(
+    boost::asio::io_service &io_service,
+    std::function<void(const Task &)> reconstruction_handler,
+    int64_t reconstruction_lease_ms, const ClientID &client_id,
+    gcs::LogInterface<ObjectID, ObjectTableData> &object_table,
+    gcs::TableInterface<TaskID, protocol::Task> &task_table,
+    gcs::LogInterface<TaskID, TaskReconstructionData> &task_reconstruction_log)
+    : io_service_(io_service),
+      reconstruction_handler_(reconstruction_handler),
+      reconstruction_lease_(reconstruction_lease_ms),
+      client_id_(client_id),
+      object_table_(object_table),
+      task_table_(task_table),
+      task_reconstruction_log_(task_reconstruction_log),
+      lease_timer_(io_service),
+      lease_timer_set_(false) {}
+
+void ReconstructionPolicy::ListenAndMaybeReconstruct(const ObjectID &object_id) {
+  const TaskID task_id = ComputeTaskId(object_id);
+  auto it = listening_tasks_.find(task_id);
+  if (it == listening_tasks_.end()) {
+    ReconstructionTask task;
+    task.reconstruction_attempt = 0;
+    task.reconstruction_pending = false;
+    it = listening_tasks_.emplace(task_id, std::move(task)).first;
+    RenewLease(task_id, it->second);
+    // Check the object right away, since it may already be lost. Objects that
+    // start listening in the same event loop iteration are checked together.
+    if (new_tasks_.empty()) {
+      io_service_.post([this]() {
+        std::vector<TaskID> new_tasks;
+        new_tasks.swap(new_tasks_);
+        CheckTasks(new_tasks, /*lease_expired=*/false);
+      });
+    }
+    new_tasks_.push_back(task_id);
+    SetLeaseTimer();
+  }
+  it->second.created_objects.insert(object_id);
+}
+
+void ReconstructionPolicy::Cancel(const ObjectID &object_id) {
+  const TaskID task_id = ComputeTaskId(object_id);
+  auto it = listening_tasks_.find(task_id);
+  if (it == listening_tasks_.end()) {
+    return;
+  }
+  it->second.created_objects.erase(object_id);
+  if (it->second.created_objects.empty()) {
+    listening_tasks_.erase(it);
+  }
+}
+
+void ReconstructionPolicy::HandleClientRemoved(const ClientID &client_id) {
+  if (!dead_clients_.insert(client_id).second) {
+    return;
+  }
+  // Any object that we are waiting for may have been on the dead node, so
+  // check all of them now instead of waiting for their leases to run out.
+  std::vector<TaskID> task_ids;
+  task_ids.reserve(listening_tasks_.size());
+  for (const auto &task : listening_tasks_) {
+    task_ids.push_back(task.first);
+  }
+  CheckTasks(task_ids, /*lease_expired=*/false);
+}
+
+void ReconstructionPolicy::CheckTasks(const std::vector<TaskID> &task_ids,
+                                      bool lease_expired) {
+  std::vector<ObjectID> object_ids;
+  for (const auto &task_id : task_ids) {
+    auto it = listening_tasks_.find(task_id);
+    if (it == listening_tasks_.end() || it->second.reconstruction_pending) {
+      continue;
+    }
+    object_ids.insert(object_ids.end(), it->second.created_objects.begin(),
+                      it->second.created_objects.end());
+  }
+  for (const auto &object_id : object_ids) {
+    RAY_CHECK_OK(object_table_.Lookup(
+        JobID::nil(), object_id,
+        [this, lease_expired](gcs::AsyncGcsClient *client, const ObjectID &object_id,
+                              const std::vector<ObjectTableDataT> &locations) {
+          HandleObjectLocations(object_id, locations, lease_expired);
+        }));
+  }
+}
+
+void ReconstructionPolicy::HandleObjectLocations(
+    const ObjectID &object_id, const std::vector<ObjectTableDataT> &locations,
+    bool lease_expired) {
+  const TaskID task_id = ComputeTaskId(object_id);
+  auto it = listening_tasks_.find(task_id);
+  if (it == listening_tasks_.end() || it->second.created_objects.count(object_id) == 0) {
+    // We stopped listening for the object while looking it up.
+    return;
+  }
+  // Replay the log of object locations to find the nodes that hold the object
+  // now.
+  IdSet client_ids;
+  bool was_created = false;
+  for (const auto &location : locations) {
+    ClientID client_id = ClientID::from_binary(location.manager);
+    if (location.is_eviction) {
+      client_ids.erase(client_id);
+    } else {
+      client_ids.insert(client_id);
+      was_created = true;
+    }
+  }
+  for (const auto &client_id : client_ids) {
+    if (dead_clients_.count(client_id) == 0) {
+      // The object is on a live node, so the object manager can fetch it.
+      return;
+    }
+  }
+  // If the object was created but all of its copies are gone, it is lost. If
+  // it was never created, its creating task may still be pending or running
+  // somewhere, so only reconstruct it once the lease runs out.
+  if (was_created || lease_expired) {
+    AttemptReconstruction(task_id);
+  }
+}
+
+void ReconstructionPolicy::AttemptReconstruction(const TaskID &task_id) {
+  auto it = listening_tasks_.find(task_id);
+  if (it == listening_tasks_.end() || it->second.reconstruction_pending) {
+    return;
+  }
+  ReconstructionTask &task = it->second;
+  task.reconstruction_pending = true;
+  // Claim the next reconstruction of the task. If another node claimed it
+  // first, the append fails and that node resubmits the task instead.
+  auto data = std::make_shared<TaskReconstructionDataT>();
+  data->num_executions = task.reconstruction_attempt;
+  data->node_manager_id = client_id_.binary();
+  RAY_CHECK_OK(task_reconstruction_log_.AppendAt(
+      JobID::nil(), task_id, data,
+      [this](gcs::AsyncGcsClient *client, const TaskID &task_id,
+             const TaskReconstructionDataT &data) {
+        HandleReconstructionLogAppend(task_id, /*success=*/true);
+      },
+      [this](gcs::AsyncGcsClient *client, const TaskID &task_id,
+             const TaskReconstructionDataT &data) {
+        HandleReconstructionLogAppend(task_id, /*success=*/false);
+      },
+      task.reconstruction_attempt));
+}
+
+void ReconstructionPolicy::HandleReconstructionLogAppend(const TaskID &task_id,
+                                                         bool success) {
+  auto it = listening_tasks_.find(task_id);
+  if (it == listening_tasks_.end()) {
+    // We stopped listening for the task's outputs in the meantime. If we
+    // claimed the reconstruction, the next node to need the outputs will claim
+    // another one.
+    return;
+  }
+  // Give whichever node claimed the reconstruction a full lease to re-execute
+  // the task before we try again.
+  RenewLease(task_id, it->second);
+  if (!success) {
+    // Another node claimed this reconstruction. Find out how many
+    // reconstructions there have been so that the next claim can succeed.
+    RAY_CHECK_OK(task_reconstruction_log_.Lookup(
+        JobID::nil(), task_id,
+        [this](gcs::AsyncGcsClient *client, const TaskID &task_id,
+               const std::vector<TaskReconstructionDataT> &data) {
+          auto it = listening_tasks_.find(task_id);
+          if (it != listening_tasks_.end()) {
+            it->second.reconstruction_attempt = data.size();
+            it->second.reconstruction_pending = false;
+          }
+        }));
+    return;
+  }
+  it->second.reconstruction_attempt++;
+  RAY_CHECK_OK(task_table_.Lookup(
+      JobID::nil(), task_id,
+      [this](gcs::AsyncGcsClient *client, const TaskID &task_id,
+             const protocol::TaskT &task_data) {
+        auto it = listening_tasks_.find(task_id);
+        if (it == listening_tasks_.end()) {
+          return;
+        }
+        it->second.reconstruction_pending = false;
+        flatbuffers::FlatBufferBuilder fbb;
+        fbb.Finish(protocol::Task::Pack(fbb, &task_data));
+        Task task(*flatbuffers::GetRoot<protocol::Task>(fbb.GetBufferPointer()));
+        RAY_LOG(DEBUG) << "Reconstructing task " << task_id;
+        reconstruction_handler_(task);
+      },
+      [this](gcs::AsyncGcsClient *client, const TaskID &task_id) {
+        // The task has not been committed yet, or its lineage was lost. Try
+        // again when the lease runs out.
+        RAY_LOG(WARNING) << "Task " << task_id
+                         << " needs to be reconstructed but is not in the task table";
+        auto it = listening_tasks_.find(task_id);
+        if (it != listening_tasks_.end()) {
+          it->second.reconstruction_pending = false;
+        }
+      }));
+}
+
+void ReconstructionPolicy::RenewLease(const TaskID &task_id, ReconstructionTask &task) {
+  task.lease_expires_at = Clock::now() + reconstruction_lease_;
+  leases_.push_back(std::make_pair(task.lease_expires_at, task_id));
+}
+
+void ReconstructionPolicy::HandleLeaseTimer() {
+  lease_timer_set_ = false;
+  auto now = Clock::now();
+  std::vector<TaskID> expired_tasks;
+  while (!leases_.empty() && leases_.front().first <= now) {
+    const TaskID task_id = leases_.front().second;
+    const Clock::time_point expires_at = leases_.front().first;
+    leases_.pop_front();
+    auto it = listening_tasks_.find(task_id);
+    if (it == listening_tasks_.end() || it->second.lease_expires_at != expires_at) {
+      // The task stopped listening or renewed its lease since.
+      continue;
+    }
+    expired_tasks.push_back(task_id);
+    // Renew the lease now, so that the task is not checked again while the
+    // lookups are in flight.
+    RenewLease(task_id, it->second);
+  }
+  CheckTasks(expired_tasks, /*lease_expired=*/true);
+  SetLeaseTimer();
+}
+
+void ReconstructionPolicy::SetLeaseTimer() {
+  if (lease_timer_set_ || leases_.empty()) {
+    return;
+  }
+  auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+      leases_.front().first - Clock::now());
+  lease_timer_.expires_from_now(boost::posix_time::milliseconds(
+      std::max<int64_t>(delay.count(), 0)));
+  lease_timer_.async_wait([this](const boost::system::error_code &error) {
+    if (error == boost::asio::error::operation_aborted) {
+      // The reconstruction policy is being destroyed.
+      return;
+    }
+    RAY_CHECK(!error);
+    HandleLeaseTimer();
+  });
+  lease_timer_set_ = true;
 }
 
 }  // namespace raylet
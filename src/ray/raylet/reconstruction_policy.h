@@ -1,34 +1,162 @@
 #ifndef RAY_RAYLET_RECONSTRUCTION_POLICY_H
 #define RAY_RAYLET_RECONSTRUCTION_POLICY_H
 
+#include <chrono>
+#include <deque>
 #include <functional>
 
+#include <boost/asio.hpp>
+
+#include "ray/gcs/tables.h"
 #include "ray/id.h"
+#include "ray/id_map.h"
+#include "ray/raylet/task.h"
 
 namespace ray {
 
 namespace raylet {
 
-// TODO(swang): Use std::function instead of boost.
+/// \class ReconstructionPolicyInterface
+///
+/// The interface that the task dependency manager uses to ask for objects
+/// that it needs to be reconstructed if they are lost.
+class ReconstructionPolicyInterface {
+ public:
+  /// Listen for an object that a queued task needs, and reconstruct it if it
+  /// is lost. The policy keeps listening until the object is canceled.
+  ///
+  /// \param object_id The object to listen for.
+  virtual void ListenAndMaybeReconstruct(const ObjectID &object_id) = 0;
+
+  /// Stop listening for an object, because it is local or no longer needed.
+  ///
+  /// \param object_id The object to stop listening for.
+  virtual void Cancel(const ObjectID &object_id) = 0;
+
+  virtual ~ReconstructionPolicyInterface(){};
+};
 
-class ReconstructionPolicy {
+/// \class ReconstructionPolicy
+///
+/// Decides when the objects that queued tasks depend on have been lost, and
+/// re-executes the tasks that created them. The policy listens for objects
+/// that the local node needs but that are not local. An object is lost if
+/// every node that held it has died, or if nobody has created it by the time
+/// the lease on its creating task runs out. The policy then claims the next
+/// reconstruction of the creating task in the task reconstruction log, so that
+/// only one node re-executes the task, looks the task up in the task table and
+/// resubmits it locally.
+///
+/// Only the tasks whose outputs are needed are reconstructed. If a resubmitted
+/// task's arguments are lost too, the node will listen for them in turn, so the
+/// policy walks up the lineage only as far as the first surviving objects.
+class ReconstructionPolicy : public ReconstructionPolicyInterface {
  public:
   /// Create the reconstruction policy.
   ///
-  /// \param reconstruction_handler The handler to call if a task needs to be
-  /// re-executed.
-  // TODO(swang): This requires at minimum references to the Raylet's lineage
-  // cache and GCS client.
-  ReconstructionPolicy(std::function<void(const TaskID &)> reconstruction_handler) {}
-
-  /// Check whether an object requires reconstruction. If this object requires
-  /// reconstruction, the registered task reconstruction handler will be called
-  /// for each task that needs to be re-executed.
+  /// \param io_service The event loop to run the lease timer on.
+  /// \param reconstruction_handler The handler to call with a task that needs
+  /// to be re-executed.
+  /// \param reconstruction_lease_ms How long to wait for an object that has
+  /// never been created before reconstructing it.
+  /// \param client_id The ID of the local node.
+  /// \param object_table The GCS log of object locations.
+  /// \param task_table The GCS table of committed tasks.
+  /// \param task_reconstruction_log The GCS log of task reconstructions, used
+  /// to make sure that each reconstruction happens on only one node.
+  ReconstructionPolicy(
+      boost::asio::io_service &io_service,
+      std::function<void(const Task &)> reconstruction_handler,
+      int64_t reconstruction_lease_ms, const ClientID &client_id,
+      gcs::LogInterface<ObjectID, ObjectTableData> &object_table,
+      gcs::TableInterface<TaskID, protocol::Task> &task_table,
+      gcs::LogInterface<TaskID, TaskReconstructionData> &task_reconstruction_log);
+
+  void ListenAndMaybeReconstruct(const ObjectID &object_id) override;
+
+  void Cancel(const ObjectID &object_id) override;
+
+  /// Handle the death of a node. Objects that are only on dead nodes are lost,
+  /// so every object that the policy is listening for is checked again.
   ///
-  /// \param object_id The object to check for reconstruction.
-  void CheckObjectReconstruction(const ObjectID &object_id);
+  /// \param client_id The ID of the node that died.
+  void HandleClientRemoved(const ClientID &client_id);
+
+  /// \return The number of tasks whose outputs the policy is listening for.
+  size_t NumListeningTasks() const { return listening_tasks_.size(); }
 
  private:
+  using Clock = std::chrono::steady_clock;
+
+  /// A task whose outputs the policy is listening for.
+  struct ReconstructionTask {
+    /// The outputs of the task that the local node needs.
+    IdSet created_objects;
+    /// The time at which the task's lease runs out, after which its outputs
+    /// are reconstructed if nobody has created them.
+    Clock::time_point lease_expires_at;
+    /// The number of reconstructions of the task that have been claimed in the
+    /// task reconstruction log, as far as this node knows.
+    int reconstruction_attempt;
+    /// Whether the policy is in the middle of claiming a reconstruction.
+    bool reconstruction_pending;
+  };
+
+  /// Look up the locations of every object of the given tasks. This is how the
+  /// policy batches its GCS requests: all lookups that come due at the same
+  /// time are sent together.
+  ///
+  /// \param task_ids The tasks to check.
+  /// \param lease_expired Whether the tasks' leases have run out.
+  void CheckTasks(const std::vector<TaskID> &task_ids, bool lease_expired);
+  /// Handle the locations of an object.
+  void HandleObjectLocations(const ObjectID &object_id,
+                             const std::vector<ObjectTableDataT> &locations,
+                             bool lease_expired);
+  /// Claim the next reconstruction of a task, and resubmit the task if the
+  /// claim succeeds.
+  void AttemptReconstruction(const TaskID &task_id);
+  /// Handle the result of claiming a reconstruction in the log.
+  void HandleReconstructionLogAppend(const TaskID &task_id, bool success);
+  /// Start or renew the lease of a task, which runs out one lease duration
+  /// from now.
+  void RenewLease(const TaskID &task_id, ReconstructionTask &task);
+  /// Check the tasks whose leases have run out, and set the timer for the next
+  /// lease to run out.
+  void HandleLeaseTimer();
+  /// Set the lease timer for the earliest lease, if it is not already set.
+  void SetLeaseTimer();
+
+  /// The event loop.
+  boost::asio::io_service &io_service_;
+  /// The handler to call with a task that needs to be re-executed.
+  std::function<void(const Task &)> reconstruction_handler_;
+  /// How long a lease lasts.
+  const std::chrono::milliseconds reconstruction_lease_;
+  /// The ID of the local node.
+  const ClientID client_id_;
+  /// The GCS log of object locations.
+  gcs::LogInterface<ObjectID, ObjectTableData> &object_table_;
+  /// The GCS table of committed tasks.
+  gcs::TableInterface<TaskID, protocol::Task> &task_table_;
+  /// The GCS log of task reconstructions.
+  gcs::LogInterface<TaskID, TaskReconstructionData> &task_reconstruction_log_;
+  /// The tasks whose outputs the policy is listening for.
+  IdMap<ReconstructionTask> listening_tasks_;
+  /// Tasks that started listening in the current event loop iteration, whose
+  /// first check has not been sent yet.
+  std::vector<TaskID> new_tasks_;
+  /// The leases of the listening tasks, in the order that they run out. Leases
+  /// always last the same duration, so this is also the order in which they
+  /// were started or renewed. An entry whose task stopped listening or renewed
+  /// its lease since is skipped when it comes due.
+  std::deque<std::pair<Clock::time_point, TaskID>> leases_;
+  /// The nodes that are known to have died.
+  IdSet dead_clients_;
+  /// The timer for the earliest lease.
+  boost::asio::deadline_timer lease_timer_;
+  /// Whether the lease timer is set.
+  bool lease_timer_set_;
 };
 
 }  // namespace raylet
@@ -0,0 +1,379 @@
+#include <chrono>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <boost/asio.hpp>
+
+#include "ray/raylet/format/node_manager_generated.h"
+#include "ray/raylet/reconstruction_policy.h"
+
+namespace ray {
+
+namespace raylet {
+
+class MockObjectTable : public gcs::LogInterface<ObjectID, ObjectTableData> {
+ public:
+  MockObjectTable(boost::asio::io_service &io_service) : io_service_(io_service) {}
+
+  Status AppendAt(const JobID &job_id, const ObjectID &object_id,
+                  std::shared_ptr<ObjectTableDataT> &data, const WriteCallback &done,
+                  const WriteCallback &failure, int log_length) {
+    return Status::NotImplemented("AppendAt is not used for the object table");
+  }
+
+  Status Lookup(const JobID &job_id, const ObjectID &object_id, const Callback &lookup) {
+    // Reply on a later iteration of the event loop, like the real GCS.
+    std::vector<ObjectTableDataT> locations = locations_[object_id];
+    io_service_.post([lookup, object_id, locations]() {
+      lookup(nullptr, object_id, locations);
+    });
+    return Status::OK();
+  }
+
+  void AddLocation(const ObjectID &object_id, const ClientID &client_id,
+                   bool is_eviction) {
+    ObjectTableDataT data;
+    data.manager = client_id.binary();
+    data.is_eviction = is_eviction;
+    locations_[object_id].push_back(data);
+  }
+
+ private:
+  boost::asio::io_service &io_service_;
+  std::unordered_map<ObjectID, std::vector<ObjectTableDataT>> locations_;
+};
+
+class MockTaskTable : public gcs::TableInterface<TaskID, protocol::Task> {
+ public:
+  MockTaskTable(boost::asio::io_service &io_service) : io_service_(io_service) {}
+
+  Status Add(const JobID &job_id, const TaskID &task_id,
+             std::shared_ptr<protocol::TaskT> &task_data, const WriteCallback &done) {
+    task_table_[task_id] = task_data;
+    if (done != nullptr) {
+      io_service_.post(
+          [done, task_id, task_data]() { done(nullptr, task_id, *task_data); });
+    }
+    return Status::OK();
+  }
+
+  Status Lookup(const JobID &job_id, const TaskID &task_id, const Callback &lookup,
+                const FailureCallback &failure) {
+    auto it = task_table_.find(task_id);
+    if (it == task_table_.end()) {
+      io_service_.post([failure, task_id]() { failure(nullptr, task_id); });
+    } else {
+      auto task_data = it->second;
+      io_service_.post(
+          [lookup, task_id, task_data]() { lookup(nullptr, task_id, *task_data); });
+    }
+    return Status::OK();
+  }
+
+  void AddTask(const Task &task) {
+    flatbuffers::FlatBufferBuilder fbb;
+    fbb.Finish(task.ToFlatbuffer(fbb));
+    auto task_data = std::make_shared<protocol::TaskT>();
+    auto root = flatbuffers::GetRoot<protocol::Task>(fbb.GetBufferPointer());
+    root->UnPackTo(task_data.get());
+    RAY_CHECK_OK(
+        Add(JobID::nil(), task.GetTaskSpecification().TaskId(), task_data, nullptr));
+  }
+
+ private:
+  boost::asio::io_service &io_service_;
+  std::unordered_map<TaskID, std::shared_ptr<protocol::TaskT>> task_table_;
+};
+
+class MockReconstructionLog : public gcs::LogInterface<TaskID, TaskReconstructionData> {
+ public:
+  MockReconstructionLog(boost::asio::io_service &io_service) : io_service_(io_service) {}
+
+  Status AppendAt(const JobID &job_id, const TaskID &task_id,
+                  std::shared_ptr<TaskReconstructionDataT> &data,
+                  const WriteCallback &done, const WriteCallback &failure,
+                  int log_length) {
+    auto &log = log_[task_id];
+    TaskReconstructionDataT entry = *data;
+    if (static_cast<int>(log.size()) == log_length) {
+      log.push_back(entry);
+      io_service_.post([done, task_id, entry]() { done(nullptr, task_id, entry); });
+    } else {
+      io_service_.post(
+          [failure, task_id, entry]() { failure(nullptr, task_id, entry); });
+    }
+    return Status::OK();
+  }
+
+  Status Lookup(const JobID &job_id, const TaskID &task_id, const Callback &lookup) {
+    std::vector<TaskReconstructionDataT> log = log_[task_id];
+    io_service_.post([lookup, task_id, log]() { lookup(nullptr, task_id, log); });
+    return Status::OK();
+  }
+
+ private:
+  boost::asio::io_service &io_service_;
+  std::unordered_map<TaskID, std::vector<TaskReconstructionDataT>> log_;
+};
+
+class ReconstructionPolicyTest : public ::testing::Test {
+ public:
+  ReconstructionPolicyTest()
+      : io_service_(),
+        object_table_(io_service_),
+        task_table_(io_service_),
+        reconstruction_log_(io_service_),
+        reconstruction_lease_ms_(50),
+        timer_(io_service_) {}
+
+  std::unique_ptr<ReconstructionPolicy> CreatePolicy(
+      std::function<void(const Task &)> handler) {
+    return std::unique_ptr<ReconstructionPolicy>(new ReconstructionPolicy(
+        io_service_, handler, reconstruction_lease_ms_, ClientID::from_random(),
+        object_table_, task_table_, reconstruction_log_));
+  }
+
+  void CreatePolicy() {
+    policy_ = CreatePolicy([this](const Task &task) {
+      reconstructed_tasks_[task.GetTaskSpecification().TaskId()]++;
+    });
+  }
+
+  void Run(int64_t timeout_ms) {
+    timer_.expires_from_now(boost::posix_time::milliseconds(timeout_ms));
+    timer_.async_wait([this](const boost::system::error_code &error) {
+      if (!error) {
+        io_service_.stop();
+      }
+    });
+    io_service_.run();
+    io_service_.reset();
+  }
+
+ protected:
+  boost::asio::io_service io_service_;
+  MockObjectTable object_table_;
+  MockTaskTable task_table_;
+  MockReconstructionLog reconstruction_log_;
+  int64_t reconstruction_lease_ms_;
+  boost::asio::deadline_timer timer_;
+  std::unique_ptr<ReconstructionPolicy> policy_;
+  std::unordered_map<TaskID, int> reconstructed_tasks_;
+};
+
+static inline Task ExampleTask(const std::vector<ObjectID> &arguments,
+                               int64_t num_returns) {
+  std::unordered_map<std::string, double> required_resources;
+  std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  for (auto &argument : arguments) {
+    std::vector<ObjectID> references = {argument};
+    task_arguments.emplace_back(std::make_shared<TaskArgumentByReference>(references));
+  }
+  auto spec = TaskSpecification(UniqueID::nil(), UniqueID::from_random(), 0,
+                                UniqueID::from_random(), task_arguments, num_returns,
+                                required_resources);
+  auto execution_spec = TaskExecutionSpecification(std::vector<ObjectID>());
+  Task task = Task(execution_spec, spec);
+  return task;
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionLeaseExpired) {
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+
+  // The object was never created, so it is only reconstructed once the lease
+  // runs out.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ / 2);
+  ASSERT_TRUE(reconstructed_tasks_.empty());
+  Run(reconstruction_lease_ms_);
+  ASSERT_EQ(reconstructed_tasks_[task.GetTaskSpecification().TaskId()], 1);
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionCanceled) {
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+
+  // Cancel the object before its lease runs out. It should not be
+  // reconstructed.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ / 2);
+  policy_->Cancel(object_id);
+  ASSERT_EQ(policy_->NumListeningTasks(), 0);
+  Run(reconstruction_lease_ms_ * 2);
+  ASSERT_TRUE(reconstructed_tasks_.empty());
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionRelistened) {
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+
+  // Listening again after a cancel starts a new lease, so the object is not
+  // reconstructed when the first lease would have run out.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ / 2);
+  policy_->Cancel(object_id);
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ * 3 / 4);
+  ASSERT_TRUE(reconstructed_tasks_.empty());
+  Run(reconstruction_lease_ms_);
+  ASSERT_EQ(reconstructed_tasks_[task.GetTaskSpecification().TaskId()], 1);
+}
+
+TEST_F(ReconstructionPolicyTest, TestPolicyDestroyedWithLeasePending) {
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+
+  // Destroying the policy cancels its lease timer, which must not be treated
+  // as an error.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ / 2);
+  policy_.reset();
+  Run(reconstruction_lease_ms_ * 2);
+  ASSERT_TRUE(reconstructed_tasks_.empty());
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionSuppressed) {
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+  object_table_.AddLocation(object_id, ClientID::from_random(), false);
+
+  // The object is on a live node, so it is never reconstructed, even after
+  // its lease runs out.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(reconstruction_lease_ms_ * 3);
+  ASSERT_TRUE(reconstructed_tasks_.empty());
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionEvicted) {
+  reconstruction_lease_ms_ = 10000;
+  CreatePolicy();
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+  ClientID client_id = ClientID::from_random();
+  object_table_.AddLocation(object_id, client_id, false);
+  object_table_.AddLocation(object_id, client_id, true);
+
+  // The object was created and then evicted everywhere, so it is reconstructed
+  // without waiting for the lease.
+  policy_->ListenAndMaybeReconstruct(object_id);
+  Run(100);
+  ASSERT_EQ(reconstructed_tasks_[task.GetTaskSpecification().TaskId()], 1);
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructionDeduplicated) {
+  reconstruction_lease_ms_ = 10000;
+  Task task = ExampleTask({}, 1);
+  task_table_.AddTask(task);
+  ObjectID object_id = task.GetTaskSpecification().ReturnId(0);
+  ClientID client_id = ClientID::from_random();
+  object_table_.AddLocation(object_id, client_id, false);
+  object_table_.AddLocation(object_id, client_id, true);
+
+  // Two nodes need the same lost object. Only one of them should win the
+  // reconstruction in the log and re-execute the task.
+  int num_reconstructions = 0;
+  auto handler = [&num_reconstructions](const Task &task) { num_reconstructions++; };
+  auto policy1 = CreatePolicy(handler);
+  auto policy2 = CreatePolicy(handler);
+  policy1->ListenAndMaybeReconstruct(object_id);
+  policy2->ListenAndMaybeReconstruct(object_id);
+  Run(100);
+  ASSERT_EQ(num_reconstructions, 1);
+}
+
+TEST_F(ReconstructionPolicyTest, TestReconstructChainAfterNodeRemoved) {
+  // Leases never run out during this test, so every reconstruction is driven
+  // by the node's death.
+  reconstruction_lease_ms_ = 60000;
+  int chain_size = 10000;
+  int surviving_index = 1000;
+  ClientID dead_client_id = ClientID::from_random();
+  ClientID live_client_id = ClientID::from_random();
+
+  // Create a chain of tasks, where each task depends on the previous one. All
+  // of the objects were on a node that is about to die, except for one
+  // object in the middle of the chain that also has a copy on a live node.
+  std::vector<Task> tasks;
+  std::vector<ObjectID> arguments;
+  for (int i = 0; i < chain_size; i++) {
+    Task task = ExampleTask(arguments, 1);
+    task_table_.AddTask(task);
+    ObjectID return_id = task.GetTaskSpecification().ReturnId(0);
+    object_table_.AddLocation(return_id, dead_client_id, false);
+    if (i == surviving_index) {
+      object_table_.AddLocation(return_id, live_client_id, false);
+    }
+    tasks.push_back(task);
+    arguments = {return_id};
+  }
+
+  // When a task is resubmitted, do what the task dependency manager would:
+  // stop listening for the task's outputs, since they are now pending
+  // creation, and listen for its arguments, since they are remote.
+  const TaskID first_task_id = tasks[surviving_index + 1].GetTaskSpecification().TaskId();
+  std::chrono::steady_clock::time_point recovered_at;
+  policy_ = CreatePolicy([this, first_task_id, &recovered_at](const Task &task) {
+    const TaskSpecification &spec = task.GetTaskSpecification();
+    reconstructed_tasks_[spec.TaskId()]++;
+    for (int64_t i = 0; i < spec.NumReturns(); i++) {
+      policy_->Cancel(spec.ReturnId(i));
+    }
+    for (int64_t i = 0; i < spec.NumArgs(); i++) {
+      policy_->ListenAndMaybeReconstruct(spec.ArgId(i, 0));
+    }
+    if (spec.TaskId() == first_task_id) {
+      recovered_at = std::chrono::steady_clock::now();
+      io_service_.stop();
+    }
+  });
+
+  // Listen for the last object in the chain, then kill the node.
+  auto start = std::chrono::steady_clock::now();
+  policy_->ListenAndMaybeReconstruct(arguments.back());
+  policy_->HandleClientRemoved(dead_client_id);
+  Run(reconstruction_lease_ms_ / 2);
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(recovered_at - start);
+  RAY_LOG(INFO) << "Reconstructed " << reconstructed_tasks_.size() << " tasks in "
+                << elapsed.count() << "ms";
+  ASSERT_LT(elapsed.count(), reconstruction_lease_ms_ / 2);
+  // Make sure that nothing else gets reconstructed.
+  Run(100);
+
+  // Only the tasks after the surviving object were re-executed, each once.
+  ASSERT_EQ(reconstructed_tasks_.size(), chain_size - surviving_index - 1);
+  for (int i = 0; i < chain_size; i++) {
+    const TaskID task_id = tasks[i].GetTaskSpecification().TaskId();
+    auto it = reconstructed_tasks_.find(task_id);
+    if (i <= surviving_index) {
+      ASSERT_TRUE(it == reconstructed_tasks_.end());
+    } else {
+      ASSERT_EQ(it->second, 1);
+    }
+  }
+  // The policy is still listening for the surviving object, which the object
+  // manager can fetch from the live node.
+  ASSERT_EQ(policy_->NumListeningTasks(), 1);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
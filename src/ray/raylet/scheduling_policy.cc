@@ -6,22 +6,26 @@ namespace ray {
 
 namespace raylet {
 
-SchedulingPolicy::SchedulingPolicy(const SchedulingQueue &scheduling_queue)
-    : scheduling_queue_(scheduling_queue), gen_(rd_()) {}
+SchedulingPolicy::SchedulingPolicy(const SchedulingQueue &scheduling_queue,
+                                   const ObjectStoreMemory &object_store_memory)
+    : scheduling_queue_(scheduling_queue),
+      object_store_memory_(object_store_memory),
+      gen_(rd_()) {}
 
 std::unordered_map<TaskID, ClientID> SchedulingPolicy::Schedule(
     const std::unordered_map<ClientID, SchedulingResources> &cluster_resources,
     const ClientID &local_client_id, const std::vector<ClientID> &others) {
   // The policy decision to be returned.
   std::unordered_map<TaskID, ClientID> decision;
-  // TODO(atumanov): protect DEBUG code blocks with ifdef DEBUG
-  RAY_LOG(DEBUG) << "[Schedule] cluster resource map: ";
-  for (const auto &client_resource_pair : cluster_resources) {
-    // pair = ClientID, SchedulingResources
-    const ClientID &client_id = client_resource_pair.first;
-    const SchedulingResources &resources = client_resource_pair.second;
-    RAY_LOG(DEBUG) << "client_id: " << client_id << " "
-                   << resources.GetAvailableResources().ToString();
+  if (RAY_LOG_ENABLED(DEBUG)) {
+    RAY_LOG(DEBUG) << "[Schedule] cluster resource map: ";
+    for (const auto &client_resource_pair : cluster_resources) {
+      // pair = ClientID, SchedulingResources
+      const ClientID &client_id = client_resource_pair.first;
+      const SchedulingResources &resources = client_resource_pair.second;
+      RAY_LOG(DEBUG) << "client_id: " << client_id << " "
+                     << resources.GetAvailableResources().ToString();
+    }
   }
 
   // Iterate over running tasks, get their resource demand and try to schedule.
@@ -40,8 +44,12 @@ std::unordered_map<TaskID, ClientID> SchedulingPolicy::Schedule(
       continue;
     }
     // Construct a set of viable node candidates and randomly pick between them.
-    // Get all the client id keys and randomly pick.
+    // Get all the client id keys and randomly pick. Prefer the candidates that
+    // advertise enough object store memory for the task's outputs.
+    const double output_size =
+        object_store_memory_.EstimateOutputSize(t.GetTaskSpecification());
     std::vector<ClientID> client_keys;
+    std::vector<ClientID> client_keys_with_room;
     for (const auto &client_resource_pair : cluster_resources) {
       // pair = ClientID, SchedulingResources
       ClientID node_client_id = client_resource_pair.first;
@@ -51,9 +59,26 @@ std::unordered_map<TaskID, ClientID> SchedulingPolicy::Schedule(
       if (resource_demand.IsSubset(node_resources.GetTotalResources())) {
         // This node is a feasible candidate.
         client_keys.push_back(node_client_id);
+        double headroom = 0;
+        bool has_room;
+        if (node_client_id == local_client_id) {
+          has_room = object_store_memory_.CanAdmit(t.GetTaskSpecification());
+        } else {
+          // Nodes that do not advertise their object store memory are assumed
+          // to have room.
+          has_room = !node_resources.GetAvailableResources().GetResource(
+                         kObjectStoreMemoryResourceLabel, &headroom) ||
+                     headroom >= output_size;
+        }
+        if (has_room) {
+          client_keys_with_room.push_back(node_client_id);
+        }
       }
     }
     RAY_CHECK(!client_keys.empty());
+    if (!client_keys_with_room.empty()) {
+      client_keys.swap(client_keys_with_room);
+    }
 
     // Choose index at random.
     // Initialize a uniform integer distribution over the key space.
@@ -4,6 +4,7 @@
 #include <random>
 #include <unordered_map>
 
+#include "ray/raylet/object_store_memory.h"
 #include "ray/raylet/scheduling_queue.h"
 #include "ray/raylet/scheduling_resources.h"
 
@@ -19,11 +20,16 @@ class SchedulingPolicy {
   ///
   /// \param scheduling_queue: reference to a scheduler queues object for access to
   ///        tasks.
+  /// \param object_store_memory: reference to the local object store memory
+  ///        accounting, which estimates the size of the tasks' outputs.
   /// \return None.
-  SchedulingPolicy(const SchedulingQueue &scheduling_queue);
+  SchedulingPolicy(const SchedulingQueue &scheduling_queue,
+                   const ObjectStoreMemory &object_store_memory);
 
   /// Perform a scheduling operation, given a set of cluster resources and
-  /// producing a mapping of tasks to node managers.
+  /// producing a mapping of tasks to node managers. Among the nodes that can
+  /// run a task, the ones whose object stores have room for the task's
+  /// outputs are preferred.
   ///
   ///  \param cluster_resources: a set of cluster resources representing
   ///         configured and current resource capacity on each node.
@@ -38,6 +44,8 @@ class SchedulingPolicy {
  private:
   /// An immutable reference to the scheduling task queues.
   const SchedulingQueue &scheduling_queue_;
+  /// An immutable reference to the local object store memory accounting.
+  const ObjectStoreMemory &object_store_memory_;
   /// Internally maintained random number engine device.
   std::random_device rd_;
   /// Internally maintained random number generator.
@@ -2,10 +2,9 @@
 #define RAY_RAYLET_SCHEDULING_QUEUE_H
 
 #include <list>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "ray/id_map.h"
 #include "ray/raylet/task.h"
 
 namespace ray {
@@ -19,7 +18,9 @@ namespace raylet {
 /// to become available, (2) ready: object dependencies are available and the
 /// task is ready to be scheduled, (3) scheduled: the task has been scheduled
 /// but is waiting for a worker, or (4) running: the task has been scheduled
-/// and is running on a worker.
+/// and is running on a worker. Every queued task is indexed by its ID, so
+/// removing a set of tasks takes time proportional to the size of the set,
+/// not to the length of the queues.
 class SchedulingQueue {
  public:
   /// Create a scheduling queue.
@@ -74,10 +75,12 @@ class SchedulingQueue {
 
   /// Remove tasks from the task queue.
   ///
-  /// \param tasks The set of task IDs to remove from the queue. The
-  ///        corresponding tasks must be contained in the queue.
-  /// \return A vector of the tasks that were removed.
-  std::vector<Task> RemoveTasks(std::unordered_set<TaskID> tasks);
+  /// \param task_ids The IDs of the tasks to remove from the queue. The IDs
+  ///        must be distinct and the corresponding tasks must be contained in
+  ///        the queue.
+  /// \return A vector of the tasks that were removed, in the same order as
+  /// task_ids.
+  std::vector<Task> RemoveTasks(const std::vector<TaskID> &task_ids);
 
   /// Queue tasks that are destined for actors that have not yet been created.
   ///
@@ -113,6 +116,23 @@ class SchedulingQueue {
   void QueueBlockedTasks(const std::vector<Task> &tasks);
 
  private:
+  /// Append tasks to one of the queues and index them. Tasks that are already
+  /// queued are dropped.
+  ///
+  /// \param queue The queue to append the tasks to.
+  /// \param tasks The tasks to queue.
+  void QueueTasks(std::list<Task> &queue, const std::vector<Task> &tasks);
+
+  /// The location of a queued task.
+  struct QueuedTask {
+    /// The queue that contains the task.
+    std::list<Task> *queue;
+    /// The task's position in the queue.
+    std::list<Task>::iterator position;
+  };
+
+  /// The location of every queued task, indexed by task ID.
+  ray::IdMap<QueuedTask> task_index_;
   /// Tasks that are destined for actors that have not yet been created.
   std::list<Task> uncreated_actor_methods_;
   /// Tasks that are waiting for an object dependency to appear locally.
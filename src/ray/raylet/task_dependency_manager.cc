@@ -1,194 +1,388 @@
 #include "task_dependency_manager.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace ray {
 
 namespace raylet {
 
-TaskDependencyManager::TaskDependencyManager(ObjectManagerInterface &object_manager)
-    : object_manager_(object_manager) {}
+namespace {
+
+/// Remove an object ID from a list whose order does not matter, by moving the
+/// last ID into its place.
+void SwapRemove(std::vector<ObjectID> &object_ids, const ObjectID &object_id) {
+  auto it = std::find(object_ids.begin(), object_ids.end(), object_id);
+  RAY_CHECK(it != object_ids.end());
+  *it = object_ids.back();
+  object_ids.pop_back();
+}
+
+}  // namespace
+
+TaskDependencyManager::TaskDependencyManager(
+    ObjectManagerInterface &object_manager,
+    ReconstructionPolicyInterface &reconstruction_policy, int64_t min_prefetch_window,
+    int64_t max_prefetch_window)
+    : object_manager_(object_manager),
+      reconstruction_policy_(reconstruction_policy),
+      next_task_position_(0),
+      min_prefetch_window_(min_prefetch_window),
+      max_prefetch_window_(max_prefetch_window),
+      prefetch_window_(min_prefetch_window),
+      num_prefetch_hits_(0),
+      num_prefetch_misses_(0) {
+  RAY_CHECK(min_prefetch_window_ > 0 && min_prefetch_window_ <= max_prefetch_window_);
+}
 
 bool TaskDependencyManager::CheckObjectLocal(const ObjectID &object_id) const {
-  return local_objects_.count(object_id) == 1;
+  auto it = objects_.find(object_id);
+  return it != objects_.end() && it->second.local;
 }
 
-bool TaskDependencyManager::CheckObjectRequired(const ObjectID &object_id) const {
-  const TaskID task_id = ComputeTaskId(object_id);
-  auto task_entry = required_tasks_.find(task_id);
-  // If there are no subscribed tasks that are dependent on the object, then do
-  // nothing.
-  if (task_entry == required_tasks_.end()) {
-    return false;
-  }
-  if (task_entry->second.count(object_id) == 0) {
+bool TaskDependencyManager::CheckObjectRequired(const ObjectID &object_id,
+                                                const ObjectEntry &object_entry) const {
+  // If there are no tasks in the prefetch window that are dependent on the
+  // object, then do nothing. Tasks behind the window request the object once
+  // they enter it.
+  if (object_entry.num_window_dependents == 0) {
     return false;
   }
   // If the object is already local, then the dependency is fulfilled. Do
   // nothing.
-  if (local_objects_.count(object_id) == 1) {
+  if (object_entry.local) {
     return false;
   }
   // If the task that creates the object is pending execution, then the
   // dependency will be fulfilled locally. Do nothing.
-  if (pending_tasks_.count(task_id) == 1) {
+  if (pending_tasks_.count(ComputeTaskId(object_id)) == 1) {
     return false;
   }
   return true;
 }
 
-void TaskDependencyManager::HandleRemoteDependencyRequired(const ObjectID &object_id) {
-  bool required = CheckObjectRequired(object_id);
-  // If the object is required, then try to make the object available locally.
-  if (required) {
-    auto inserted = required_objects_.insert(object_id);
-    if (inserted.second) {
-      // If we haven't already, request the object manager to pull it from a
-      // remote node.
-      RAY_CHECK_OK(object_manager_.Pull(object_id));
-    }
+void TaskDependencyManager::UpdateObjectRequest(const ObjectID &object_id,
+                                                ObjectEntry &object_entry) {
+  bool required = CheckObjectRequired(object_id, object_entry);
+  if (required && !object_entry.requested) {
+    // Request the object manager to pull it from a remote node, and
+    // reconstruct it if it turns out to be lost.
+    RAY_CHECK_OK(object_manager_.Pull(object_id, object_entry.priority));
+    reconstruction_policy_.ListenAndMaybeReconstruct(object_id);
+    object_entry.requested = true;
+  } else if (!required && object_entry.requested) {
+    // The object is no longer required, so cancel any in-progress operations
+    // to make it local.
+    RAY_CHECK_OK(object_manager_.Cancel(object_id));
+    reconstruction_policy_.Cancel(object_id);
+    object_entry.requested = false;
   }
 }
 
-void TaskDependencyManager::HandleRemoteDependencyCanceled(const ObjectID &object_id) {
-  bool required = CheckObjectRequired(object_id);
-  // If the object is no longer required, then cancel the object.
-  if (!required) {
-    auto it = required_objects_.find(object_id);
-    if (it != required_objects_.end()) {
-      RAY_CHECK_OK(object_manager_.Cancel(object_id));
-      required_objects_.erase(it);
-    }
+void TaskDependencyManager::UpdateCreatedObjectRequests(const TaskID &task_id) {
+  auto creating_task_entry = required_tasks_.find(task_id);
+  if (creating_task_entry == required_tasks_.end()) {
+    return;
+  }
+  for (const auto &object_id : creating_task_entry->second) {
+    UpdateObjectRequest(object_id, objects_.at(object_id));
   }
 }
 
-std::vector<TaskID> TaskDependencyManager::HandleObjectLocal(
-    const ray::ObjectID &object_id) {
+void TaskDependencyManager::HandleObjectLocal(const ray::ObjectID &object_id) {
   RAY_LOG(DEBUG) << "object ready " << object_id.hex();
-  // Add the object to the table of locally available objects.
-  auto inserted = local_objects_.insert(object_id);
-  RAY_CHECK(inserted.second);
+  // Mark the object as locally available.
+  auto &object_entry = objects_[object_id];
+  RAY_CHECK(!object_entry.local);
+  object_entry.local = true;
+  const bool prefetched = object_entry.requested;
 
-  // Find any tasks that are dependent on the newly available object.
-  std::vector<TaskID> ready_task_ids;
-  auto creating_task_entry = required_tasks_.find(ComputeTaskId(object_id));
-  if (creating_task_entry != required_tasks_.end()) {
-    auto object_entry = creating_task_entry->second.find(object_id);
-    if (object_entry != creating_task_entry->second.end()) {
-      for (auto &dependent_task_id : object_entry->second) {
-        auto &task_entry = task_dependencies_[dependent_task_id];
-        task_entry.num_missing_dependencies--;
-        // If the dependent task now has all of its arguments ready, it's ready
-        // to run.
-        if (task_entry.num_missing_dependencies == 0) {
-          ready_task_ids.push_back(dependent_task_id);
-        }
+  // Any tasks that are dependent on the newly available object and that now
+  // have all of their arguments ready are ready to run.
+  std::vector<TaskEntry *> unblocked_tasks;
+  for (const auto &dependent_task : object_entry.dependent_tasks) {
+    TaskEntry *task_entry = dependent_task.task;
+    task_entry->num_missing_dependencies--;
+    if (task_entry->num_missing_dependencies == 0) {
+      unblocked_tasks.push_back(task_entry);
+      if (!task_entry->in_ready_batch) {
+        task_entry->in_ready_batch = true;
+        ready_tasks_.push_back(task_entry->task_id);
       }
     }
   }
+  // The tasks are no longer waiting, so they make room in the prefetch window.
+  for (TaskEntry *task_entry : unblocked_tasks) {
+    RemoveWaitingTask(task_entry);
+  }
+
+  // An object that was requested arrived in time. Try to prefetch for one
+  // more task.
+  if (prefetched) {
+    num_prefetch_hits_++;
+    if (prefetch_window_ < max_prefetch_window_) {
+      prefetch_window_++;
+      ResizeWindow();
+    }
+  }
 
   // The object is now local, so cancel any in-progress operations to make the
   // object local.
-  HandleRemoteDependencyCanceled(object_id);
-
-  return ready_task_ids;
+  UpdateObjectRequest(object_id, object_entry);
 }
 
 std::vector<TaskID> TaskDependencyManager::HandleObjectMissing(
     const ray::ObjectID &object_id) {
-  // Add the object to the table of locally available objects.
-  auto erased = local_objects_.erase(object_id);
-  RAY_CHECK(erased == 1);
+  // Mark the object as no longer locally available.
+  auto it = objects_.find(object_id);
+  RAY_CHECK(it != objects_.end() && it->second.local);
+  auto &object_entry = it->second;
+  object_entry.local = false;
 
   // Find any tasks that are dependent on the missing object.
   std::vector<TaskID> waiting_task_ids;
-  TaskID creating_task_id = ComputeTaskId(object_id);
-  auto creating_task_entry = required_tasks_.find(creating_task_id);
-  if (creating_task_entry != required_tasks_.end()) {
-    auto object_entry = creating_task_entry->second.find(object_id);
-    if (object_entry != creating_task_entry->second.end()) {
-      for (auto &dependent_task_id : object_entry->second) {
-        auto &task_entry = task_dependencies_[dependent_task_id];
-        // If the dependent task had all of its arguments ready, it was ready to
-        // run but must be switched to waiting since one of its arguments is now
-        // missing.
-        if (task_entry.num_missing_dependencies == 0) {
-          waiting_task_ids.push_back(dependent_task_id);
-        }
-        task_entry.num_missing_dependencies++;
+  std::vector<TaskEntry *> blocked_tasks;
+  for (const auto &dependent_task : object_entry.dependent_tasks) {
+    TaskEntry *task_entry = dependent_task.task;
+    if (task_entry->num_missing_dependencies == 0) {
+      blocked_tasks.push_back(task_entry);
+      // If the dependent task had all of its arguments ready, it was ready to
+      // run but must be switched to waiting since one of its arguments is now
+      // missing. Tasks in the ready batch were never reported as ready, and
+      // are filtered out when the batch is taken.
+      if (!task_entry->in_ready_batch) {
+        waiting_task_ids.push_back(task_entry->task_id);
       }
     }
+    task_entry->num_missing_dependencies++;
+  }
+
+  if (object_entry.dependent_tasks.empty()) {
+    // No task depends on the object, so there is nothing left to track.
+    objects_.erase(it);
+  } else {
+    // The object store evicted an object that is still needed, so it is
+    // holding more than it can. Prefetch for fewer tasks.
+    num_prefetch_misses_++;
+    prefetch_window_ = std::max(min_prefetch_window_, prefetch_window_ / 2);
+    ResizeWindow();
+    for (TaskEntry *task_entry : blocked_tasks) {
+      AddWaitingTask(task_entry);
+    }
+    // The object is no longer local. Try to make the object local if
+    // necessary.
+    UpdateObjectRequest(object_id, object_entry);
   }
-  // The object is no longer local. Try to make the object local if necessary.
-  HandleRemoteDependencyRequired(object_id);
-  // Process callbacks for all of the tasks dependent on the object that are
-  // now ready to run.
   return waiting_task_ids;
 }
 
+bool TaskDependencyManager::HasReadyTasks() const { return !ready_tasks_.empty(); }
+
+PrefetchStats TaskDependencyManager::GetPrefetchStats() const {
+  PrefetchStats stats;
+  stats.num_hits = num_prefetch_hits_;
+  stats.num_misses = num_prefetch_misses_;
+  stats.window_size = prefetch_window_;
+  stats.num_deferred_tasks = deferred_tasks_.size();
+  return stats;
+}
+
+void TaskDependencyManager::AddWaitingTask(TaskEntry *task_entry) {
+  RAY_CHECK(!task_entry->waiting);
+  task_entry->waiting = true;
+  if (static_cast<int64_t>(window_tasks_.size()) < prefetch_window_) {
+    // There is room in the window, so no task is deferred.
+    window_tasks_.emplace(task_entry->position, task_entry);
+    EnterWindow(task_entry);
+  } else if (task_entry->position < window_tasks_.rbegin()->first) {
+    // The task is older than the last task in the window, which is deferred to
+    // make room. The task enters the window first, so that the objects that
+    // both tasks depend on are not canceled and requested again.
+    window_tasks_.emplace(task_entry->position, task_entry);
+    EnterWindow(task_entry);
+    auto last = std::prev(window_tasks_.end());
+    TaskEntry *last_task = last->second;
+    window_tasks_.erase(last);
+    deferred_tasks_.emplace(last_task->position, last_task);
+    LeaveWindow(last_task);
+  } else {
+    deferred_tasks_.emplace(task_entry->position, task_entry);
+  }
+}
+
+void TaskDependencyManager::RemoveWaitingTask(TaskEntry *task_entry) {
+  RAY_CHECK(task_entry->waiting);
+  task_entry->waiting = false;
+  if (task_entry->in_window) {
+    window_tasks_.erase(task_entry->position);
+    LeaveWindow(task_entry);
+    ResizeWindow();
+  } else {
+    deferred_tasks_.erase(task_entry->position);
+  }
+}
+
+void TaskDependencyManager::EnterWindow(TaskEntry *task_entry) {
+  task_entry->in_window = true;
+  for (const auto &dependency : task_entry->object_dependencies) {
+    auto &object_entry = objects_.find(dependency.object_id)->second;
+    if (object_entry.num_window_dependents++ == 0) {
+      UpdateObjectRequest(dependency.object_id, object_entry);
+    }
+  }
+}
+
+void TaskDependencyManager::LeaveWindow(TaskEntry *task_entry) {
+  task_entry->in_window = false;
+  for (const auto &dependency : task_entry->object_dependencies) {
+    auto &object_entry = objects_.find(dependency.object_id)->second;
+    if (--object_entry.num_window_dependents == 0) {
+      UpdateObjectRequest(dependency.object_id, object_entry);
+    }
+  }
+}
+
+void TaskDependencyManager::ResizeWindow() {
+  while (static_cast<int64_t>(window_tasks_.size()) > prefetch_window_) {
+    auto last = std::prev(window_tasks_.end());
+    TaskEntry *task_entry = last->second;
+    window_tasks_.erase(last);
+    deferred_tasks_.emplace(task_entry->position, task_entry);
+    LeaveWindow(task_entry);
+  }
+  while (static_cast<int64_t>(window_tasks_.size()) < prefetch_window_ &&
+         !deferred_tasks_.empty()) {
+    auto first = deferred_tasks_.begin();
+    TaskEntry *task_entry = first->second;
+    deferred_tasks_.erase(first);
+    window_tasks_.emplace(task_entry->position, task_entry);
+    EnterWindow(task_entry);
+  }
+}
+
+std::vector<TaskID> TaskDependencyManager::TakeReadyTasks() {
+  // Drop the tasks that were unsubscribed, that appear in the batch more than
+  // once, or whose dependencies went missing again since they became ready.
+  size_t num_ready = 0;
+  for (const auto &task_id : ready_tasks_) {
+    auto it = task_dependencies_.find(task_id);
+    if (it == task_dependencies_.end() || !it->second->in_ready_batch) {
+      continue;
+    }
+    it->second->in_ready_batch = false;
+    if (it->second->num_missing_dependencies == 0) {
+      ready_tasks_[num_ready++] = task_id;
+    }
+  }
+  ready_tasks_.resize(num_ready);
+  std::vector<TaskID> ready_task_ids;
+  ready_task_ids.swap(ready_tasks_);
+  return ready_task_ids;
+}
+
 bool TaskDependencyManager::SubscribeDependencies(
     const TaskID &task_id, const std::vector<ObjectID> &required_objects) {
-  auto &task_entry = task_dependencies_[task_id];
+  auto &task_entry_ptr = task_dependencies_[task_id];
+  if (task_entry_ptr == nullptr) {
+    task_entry_ptr.reset(
+        new TaskEntry{task_id, next_task_position_++, {}, 0, false, false, false});
+  }
+  TaskEntry *task_entry = task_entry_ptr.get();
+  const auto num_subscribed = task_entry->object_dependencies.size();
 
   // Record the task's dependencies.
   for (const auto &object_id : required_objects) {
-    auto inserted = task_entry.object_dependencies.insert(object_id);
-    if (inserted.second) {
-      // Get the ID of the task that creates the dependency.
-      TaskID creating_task_id = ComputeTaskId(object_id);
-      // Determine whether the dependency can be fulfilled by the local node.
-      if (local_objects_.count(object_id) == 0) {
-        // The object is not local.
-        task_entry.num_missing_dependencies++;
+    auto &object_entry = objects_[object_id];
+    auto &dependent_tasks = object_entry.dependent_tasks;
+    // Skip objects that the task already depends on. A duplicate within this
+    // call is always the object's most recent dependent, so only objects from
+    // a previous call need to be searched for.
+    if (!dependent_tasks.empty() && dependent_tasks.back().task == task_entry) {
+      continue;
+    }
+    auto subscribed_end = task_entry->object_dependencies.begin() + num_subscribed;
+    if (num_subscribed > 0 &&
+        std::find_if(task_entry->object_dependencies.begin(), subscribed_end,
+                     [&object_id](const Dependency &dependency) {
+                       return dependency.object_id == object_id;
+                     }) != subscribed_end) {
+      continue;
+    }
+    if (!object_entry.local) {
+      task_entry->num_missing_dependencies++;
+    }
+    if (dependent_tasks.empty()) {
+      // This is the first subscribed task that depends on the object. Record
+      // the object under the task that creates it.
+      required_tasks_[ComputeTaskId(object_id)].push_back(object_id);
+      object_entry.priority = task_entry->position;
+    } else if (task_entry->position < object_entry.priority) {
+      // An older task now depends on the object, so pull it sooner.
+      object_entry.priority = task_entry->position;
+      if (object_entry.requested) {
+        RAY_CHECK_OK(object_manager_.Pull(object_id, object_entry.priority));
       }
-      // Add the subscribed task to the mapping from object ID to list of
-      // dependent tasks.
-      required_tasks_[creating_task_id][object_id].push_back(task_id);
     }
+    task_entry->object_dependencies.push_back({object_id, dependent_tasks.size()});
+    dependent_tasks.push_back({task_entry, task_entry->object_dependencies.size() - 1});
+    if (task_entry->in_window) {
+      object_entry.num_window_dependents++;
+    }
+    // The dependency is required by the given task. Try to make it local if
+    // necessary.
+    UpdateObjectRequest(object_id, object_entry);
   }
-
-  // These dependencies are required by the given task. Try to make them local
-  // if necessary.
-  for (const auto &object_id : required_objects) {
-    HandleRemoteDependencyRequired(object_id);
+  // A task that is missing an object waits for it in the prefetch window, or
+  // behind it.
+  if (task_entry->num_missing_dependencies > 0 && !task_entry->waiting) {
+    AddWaitingTask(task_entry);
   }
 
   // Return whether all dependencies are local.
-  return (task_entry.num_missing_dependencies == 0);
+  return (task_entry->num_missing_dependencies == 0);
 }
 
 void TaskDependencyManager::UnsubscribeDependencies(const TaskID &task_id) {
   // Remove the task from the table of subscribed tasks.
   auto it = task_dependencies_.find(task_id);
   RAY_CHECK(it != task_dependencies_.end());
-  const TaskDependencies task_entry = std::move(it->second);
+  std::unique_ptr<TaskEntry> task_entry = std::move(it->second);
   task_dependencies_.erase(it);
+  if (task_entry->waiting) {
+    RemoveWaitingTask(task_entry.get());
+  }
 
   // Remove the task's dependencies.
-  for (const auto &object_id : task_entry.object_dependencies) {
+  for (const auto &dependency : task_entry->object_dependencies) {
+    const ObjectID &object_id = dependency.object_id;
+    auto object_it = objects_.find(object_id);
+    auto &object_entry = object_it->second;
     // Remove the task from the list of tasks that are dependent on this
-    // object.
-    // Get the ID of the task that creates the dependency.
+    // object, by moving the last dependent task into its place.
+    auto &dependent_tasks = object_entry.dependent_tasks;
+    const DependentTask &last = dependent_tasks.back();
+    last.task->object_dependencies[last.dependency_index].dependent_index =
+        dependency.dependent_index;
+    dependent_tasks[dependency.dependent_index] = last;
+    dependent_tasks.pop_back();
+    if (!dependent_tasks.empty()) {
+      continue;
+    }
+    // The unsubscribed task was the only task dependent on the object. Remove
+    // the object from the task that creates it, and remove that task if there
+    // are no more object dependencies created by it.
     TaskID creating_task_id = ComputeTaskId(object_id);
     auto creating_task_entry = required_tasks_.find(creating_task_id);
-    std::vector<TaskID> &dependent_tasks = creating_task_entry->second[object_id];
-    auto it = std::find(dependent_tasks.begin(), dependent_tasks.end(), task_id);
-    RAY_CHECK(it != dependent_tasks.end());
-    dependent_tasks.erase(it);
-    // If the unsubscribed task was the only task dependent on the object, then
-    // erase the object entry.
-    if (dependent_tasks.empty()) {
-      creating_task_entry->second.erase(object_id);
-      // Remove the task that creates this object if there are no more object
-      // dependencies created by the task.
-      if (creating_task_entry->second.empty()) {
-        required_tasks_.erase(creating_task_entry);
-      }
+    SwapRemove(creating_task_entry->second, object_id);
+    if (creating_task_entry->second.empty()) {
+      required_tasks_.erase(creating_task_entry);
+    }
+    // The dependency is no longer required. Cancel any in-progress operations
+    // to make it local.
+    UpdateObjectRequest(object_id, object_entry);
+    if (!object_entry.local) {
+      objects_.erase(object_it);
     }
-  }
-
-  // These dependencies are no longer required by the given task. Cancel any
-  // in-progress operations to make them local.
-  for (const auto &object_id : task_entry.object_dependencies) {
-    HandleRemoteDependencyCanceled(object_id);
   }
 }
 
@@ -197,32 +391,19 @@ void TaskDependencyManager::TaskPending(const Task &task) {
 
   // Record that the task is pending execution.
   pending_tasks_.insert(task_id);
-  // Find any subscribed tasks that are dependent on objects created by the
-  // pending task.
-  auto remote_task_entry = required_tasks_.find(task_id);
-  if (remote_task_entry != required_tasks_.end()) {
-    for (const auto &object_entry : remote_task_entry->second) {
-      // This object created by the pending task will appear locally once the
-      // task completes execution. Cancel any in-progress operations to make
-      // the object local.
-      HandleRemoteDependencyCanceled(object_entry.first);
-    }
-  }
+  // Any objects created by the pending task that subscribed tasks depend on
+  // will appear locally once the task completes execution. Cancel any
+  // in-progress operations to make the objects local.
+  UpdateCreatedObjectRequests(task_id);
 }
 
 void TaskDependencyManager::TaskCanceled(const TaskID &task_id) {
   // Record that the task is no longer pending execution.
   pending_tasks_.erase(task_id);
-  // Find any subscribed tasks that are dependent on objects created by the
-  // canceled task.
-  auto remote_task_entry = required_tasks_.find(task_id);
-  if (remote_task_entry != required_tasks_.end()) {
-    for (const auto &object_entry : remote_task_entry->second) {
-      // This object created by the task will no longer appear locally since
-      // the task is canceled.  Try to make the object local if necessary.
-      HandleRemoteDependencyRequired(object_entry.first);
-    }
-  }
+  // Any objects created by the canceled task that subscribed tasks depend on
+  // will no longer appear locally. Try to make the objects local if
+  // necessary.
+  UpdateCreatedObjectRequests(task_id);
 }
 
 }  // namespace raylet
@@ -1,8 +1,13 @@
 #ifndef RAY_RAYLET_TASK_DEPENDENCY_MANAGER_H
 #define RAY_RAYLET_TASK_DEPENDENCY_MANAGER_H
 
+#include <map>
+#include <memory>
+#include <vector>
+
 // clang-format off
 #include "ray/id.h"
+#include "ray/id_map.h"
 #include "ray/raylet/task.h"
 #include "ray/object_manager/object_manager.h"
 #include "ray/raylet/reconstruction_policy.h"
@@ -12,7 +17,21 @@ namespace ray {
 
 namespace raylet {
 
-class ReconstructionPolicy;
+/// Counters that describe how well the prefetch window of a
+/// TaskDependencyManager matches the object store's capacity.
+struct PrefetchStats {
+  /// The number of requested objects that became local while a task in the
+  /// prefetch window still needed them.
+  int64_t num_hits = 0;
+  /// The number of objects that were evicted from the local store while a
+  /// subscribed task still needed them, so that they must be made local again.
+  int64_t num_misses = 0;
+  /// The current size of the prefetch window, in tasks.
+  int64_t window_size = 0;
+  /// The number of waiting tasks behind the prefetch window, whose remote
+  /// dependencies are not requested yet.
+  int64_t num_deferred_tasks = 0;
+};
 
 /// \class TaskDependencyManager
 ///
@@ -24,10 +43,36 @@ class ReconstructionPolicy;
 /// made available locally, either by object transfer from a remote node or
 /// reconstruction. The task manager will also cancel these objects if they are
 /// no longer needed by any task.
+///
+/// Dependencies are stored as a flat index from each object to the tasks that
+/// wait on it, and each task keeps a count of its missing objects, so that an
+/// object becoming local costs one lookup plus one decrement per waiting task.
+/// Tasks that become ready are collected into a batch, which the caller takes
+/// with TakeReadyTasks, e.g., once per event loop iteration. Remote objects
+/// are pulled in the order that the earliest task that depends on them was
+/// subscribed, so that older tasks get all of their arguments first.
+///
+/// Only the tasks in a prefetch window have their remote dependencies
+/// requested. The window holds the oldest subscribed tasks that are waiting for
+/// an object, in the order that the tasks would be dispatched. The remote
+/// dependencies of the tasks behind the window are requested once the tasks
+/// enter the window, so that a deep queue does not fill the object store with
+/// objects that are not needed for a long time. The window grows by one task
+/// for every requested object that arrives, and is halved whenever an object
+/// that a subscribed task needs is evicted from the object store.
 class TaskDependencyManager {
  public:
   /// Create a task dependency manager.
-  TaskDependencyManager(ObjectManagerInterface &object_manager);
+  ///
+  /// \param object_manager The object manager to pull remote objects from.
+  /// \param reconstruction_policy The policy to reconstruct lost objects with.
+  /// \param min_prefetch_window The smallest number of waiting tasks whose
+  /// remote dependencies are requested. This is also the initial window.
+  /// \param max_prefetch_window The largest number of waiting tasks whose
+  /// remote dependencies are requested.
+  TaskDependencyManager(ObjectManagerInterface &object_manager,
+                        ReconstructionPolicyInterface &reconstruction_policy,
+                        int64_t min_prefetch_window, int64_t max_prefetch_window);
 
   /// Check whether an object is locally available.
   ///
@@ -40,9 +85,9 @@ class TaskDependencyManager {
   /// until UnsubscribeDependencies is called on the same task ID. If any
   /// dependencies are remote, then they will be requested. When the last
   /// remote dependency later appears locally via a call to HandleObjectLocal,
-  /// the subscribed task will be returned by the HandleObjectLocal call,
-  /// signifying that it is ready to run. This method may be called multiple
-  /// times per task.
+  /// the subscribed task will be added to the batch of ready tasks, signifying
+  /// that it is ready to run. This method may be called multiple times per
+  /// task.
   ///
   /// \param task_id The ID of the task whose dependencies to subscribe to.
   /// \param required_objects The objects required by the task.
@@ -53,7 +98,8 @@ class TaskDependencyManager {
 
   /// Unsubscribe from the object dependencies required by this task. If the
   /// objects were remote and are no longer required by any subscribed task,
-  /// then they will be canceled.
+  /// then they will be canceled. If the task is in the batch of ready tasks,
+  /// it is dropped from the batch.
   ///
   /// \param task_id The ID of the task whose dependencies to unsubscribe from.
   void UnsubscribeDependencies(const TaskID &task_id);
@@ -74,14 +120,13 @@ class TaskDependencyManager {
   void TaskCanceled(const TaskID &task_id);
 
   /// Handle an object becoming locally available. If there are any subscribed
-  /// tasks that depend on this object, then the object will be canceled.
+  /// tasks that depend on this object, then the object will be canceled. All
+  /// subscribed tasks that now have all of their dependencies fulfilled are
+  /// added to the batch of ready tasks.
   ///
   /// \param object_id The object ID of the object to mark as locally
   /// available.
-  /// \return A list of task IDs. This contains all subscribed tasks that now
-  /// have all of their dependencies fulfilled, once this object was made
-  /// local.
-  std::vector<TaskID> HandleObjectLocal(const ray::ObjectID &object_id);
+  void HandleObjectLocal(const ray::ObjectID &object_id);
 
   /// Handle an object that is no longer locally available. If there are any
   /// subscribed tasks that depend on this object, then the object will be
@@ -91,53 +136,151 @@ class TaskDependencyManager {
   /// available.
   /// \return A list of task IDs. This contains all subscribed tasks that
   /// previously had all of their dependencies fulfilled, but are now missing
-  /// this object dependency.
+  /// this object dependency. Tasks in the batch of ready tasks that was not
+  /// taken yet are not included; they are dropped from the batch instead.
   std::vector<TaskID> HandleObjectMissing(const ray::ObjectID &object_id);
 
+  /// Whether any task became ready since the last call to TakeReadyTasks.
+  ///
+  /// \return Whether the batch of ready tasks may be non-empty.
+  bool HasReadyTasks() const;
+
+  /// Take the batch of tasks that became ready through HandleObjectLocal since
+  /// the last call. Each task is included at most once, and only if it is
+  /// still subscribed and all of its dependencies are still local.
+  ///
+  /// \return The IDs of the ready tasks, in the order that they became ready.
+  std::vector<TaskID> TakeReadyTasks();
+
+  /// Get the counters of the prefetch window.
+  ///
+  /// \return The prefetch hits and misses so far, and the current state of
+  /// the window.
+  PrefetchStats GetPrefetchStats() const;
+
  private:
-  using ObjectDependencyMap = std::unordered_map<ray::ObjectID, std::vector<ray::TaskID>>;
+  struct TaskEntry;
+
+  /// A subscribed task that depends on an object.
+  struct DependentTask {
+    /// The task.
+    TaskEntry *task;
+    /// The position of the object in the task's list of dependencies.
+    size_t dependency_index;
+  };
 
-  /// A struct to represent the object dependencies of a task.
-  struct TaskDependencies {
-    /// The objects that the task is dependent on. These must be local before
-    /// the task is ready to execute.
-    std::unordered_set<ObjectID> object_dependencies;
+  /// An object that a subscribed task depends on.
+  struct Dependency {
+    /// The object.
+    ObjectID object_id;
+    /// The position of the task in the object's list of dependent tasks.
+    size_t dependent_index;
+  };
+
+  /// The object dependencies of a subscribed task. Each dependency and the
+  /// matching entry in the object's list of dependent tasks store each other's
+  /// positions, so that either can be removed in constant time. Entries are
+  /// heap-allocated so that the objects can point to them directly.
+  struct TaskEntry {
+    /// The ID of the task.
+    TaskID task_id;
+    /// The order in which the task was first subscribed.
+    int64_t position;
+    /// The distinct objects that the task is dependent on. These must be local
+    /// before the task is ready to execute.
+    std::vector<Dependency> object_dependencies;
     /// The number of object arguments that are not available locally. This
     /// must be zero before the task is ready to execute.
     int64_t num_missing_dependencies;
+    /// Whether the task is in the batch of ready tasks that was not taken yet.
+    bool in_ready_batch;
+    /// Whether the task is waiting for an object, i.e., whether it is in the
+    /// prefetch window or deferred behind it.
+    bool waiting;
+    /// Whether the task is in the prefetch window.
+    bool in_window;
+  };
+
+  /// An object that is local, or that a subscribed task depends on.
+  struct ObjectEntry {
+    /// The subscribed tasks that are dependent on the object, in no particular
+    /// order.
+    std::vector<DependentTask> dependent_tasks;
+    /// Whether the object is locally available.
+    bool local = false;
+    /// Whether there are pending operations to make the object available
+    /// through object transfer or reconstruction.
+    bool requested = false;
+    /// The lowest position of a task that depends on the object, used as the
+    /// priority of the object's pull.
+    int64_t priority = 0;
+    /// The number of tasks in the prefetch window that depend on the object.
+    int64_t num_window_dependents = 0;
   };
 
   /// Check whether the given object needs to be made available through object
   /// transfer or reconstruction. These are objects for which: (1) there is a
-  /// subscribed task dependent on it, (2) the object is not local, and (3) the
-  /// task that creates the object is not pending execution locally.
-  bool CheckObjectRequired(const ObjectID &object_id) const;
-  /// If the given object is required, then request that the object be made
-  /// available through object transfer or reconstruction.
-  void HandleRemoteDependencyRequired(const ObjectID &object_id);
-  /// If the given object is no longer required, then cancel any in-progress
-  /// operations to make the object available through object transfer or
-  /// reconstruction.
-  void HandleRemoteDependencyCanceled(const ObjectID &object_id);
+  /// task in the prefetch window dependent on it, (2) the object is not local,
+  /// and (3) the task that creates the object is not pending execution locally.
+  bool CheckObjectRequired(const ObjectID &object_id,
+                           const ObjectEntry &object_entry) const;
+  /// Request the given object if it is required and was not requested yet,
+  /// through object transfer or reconstruction, or cancel any in-progress
+  /// operations to make the object available if it is no longer required.
+  void UpdateObjectRequest(const ObjectID &object_id, ObjectEntry &object_entry);
+  /// Call UpdateObjectRequest on each object created by the given task that a
+  /// subscribed task depends on.
+  void UpdateCreatedObjectRequests(const TaskID &task_id);
+  /// Add a task that started waiting for an object to the prefetch window, or
+  /// defer it if the window is full of older tasks.
+  void AddWaitingTask(TaskEntry *task_entry);
+  /// Remove a task that is no longer waiting for an object, and move the next
+  /// deferred task into the window.
+  void RemoveWaitingTask(TaskEntry *task_entry);
+  /// Request the task's dependencies that are now required because the task
+  /// entered the prefetch window.
+  void EnterWindow(TaskEntry *task_entry);
+  /// Cancel the task's dependencies that are no longer required because the
+  /// task left the prefetch window.
+  void LeaveWindow(TaskEntry *task_entry);
+  /// Move tasks between the prefetch window and the deferred tasks until the
+  /// window has prefetch_window_ tasks, or there are no deferred tasks left.
+  void ResizeWindow();
 
   ObjectManagerInterface &object_manager_;
-  /// A mapping from task ID of each subscribed task to its list of object
+  ReconstructionPolicyInterface &reconstruction_policy_;
+  /// A mapping from task ID of each subscribed task to its object
   /// dependencies.
-  std::unordered_map<ray::TaskID, TaskDependencies> task_dependencies_;
+  ray::IdMap<std::unique_ptr<TaskEntry>> task_dependencies_;
+  /// The objects that are local or that a subscribed task depends on. An entry
+  /// is erased once the object is neither.
+  ray::IdMap<ObjectEntry> objects_;
   /// All tasks whose outputs are required by a subscribed task. This is a
-  /// mapping from task ID to information about the objects that the task
-  /// creates, either by return value or by `ray.put`. For each object, we
-  /// store the IDs of the subscribed tasks that are dependent on the object.
-  std::unordered_map<ray::TaskID, ObjectDependencyMap> required_tasks_;
-  /// Objects that are required by a subscribed task, are not local, and are
-  /// not created by a pending task. For these objects, there are pending
-  /// operations to make the object available.
-  std::unordered_set<ray::ObjectID> required_objects_;
-  /// The set of locally available objects.
-  std::unordered_set<ray::ObjectID> local_objects_;
+  /// mapping from task ID to the objects that the task creates, either by
+  /// return value or by `ray.put`, that a subscribed task depends on.
+  ray::IdMap<std::vector<ObjectID>> required_tasks_;
   /// The set of tasks that are pending execution. Any objects created by these
   /// tasks that are not already local are pending creation.
-  std::unordered_set<ray::TaskID> pending_tasks_;
+  ray::IdSet pending_tasks_;
+  /// The position to give the next task that is subscribed.
+  int64_t next_task_position_;
+  /// The tasks that became ready since the last call to TakeReadyTasks. This
+  /// may contain tasks that were since unsubscribed or whose dependencies went
+  /// missing again; those are filtered out when the batch is taken.
+  std::vector<TaskID> ready_tasks_;
+  /// The waiting tasks in the prefetch window, by position. Every task in the
+  /// window is older than every deferred task.
+  std::map<int64_t, TaskEntry *> window_tasks_;
+  /// The waiting tasks behind the prefetch window, by position.
+  std::map<int64_t, TaskEntry *> deferred_tasks_;
+  /// The bounds of the prefetch window.
+  const int64_t min_prefetch_window_;
+  const int64_t max_prefetch_window_;
+  /// The number of waiting tasks to request remote dependencies for.
+  int64_t prefetch_window_;
+  /// The prefetch hits and misses so far.
+  int64_t num_prefetch_hits_;
+  int64_t num_prefetch_misses_;
 };
 
 }  // namespace raylet
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <list>
 
 #include "gmock/gmock.h"
@@ -5,6 +6,7 @@
 
 #include <boost/asio.hpp>
 
+#include "common/state/ray_config.h"
 #include "ray/raylet/task_dependency_manager.h"
 
 namespace ray {
@@ -12,20 +14,35 @@ namespace ray {
 namespace raylet {
 
 using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Mock;
+using ::testing::Return;
+using ::testing::SaveArg;
 
 class MockObjectManager : public ObjectManagerInterface {
  public:
-  MOCK_METHOD1(Pull, ray::Status(const ObjectID &object_id));
+  MOCK_METHOD2(Pull, ray::Status(const ObjectID &object_id, int64_t priority));
   MOCK_METHOD1(Cancel, ray::Status(const ObjectID &object_id));
 };
 
+class MockReconstructionPolicy : public ReconstructionPolicyInterface {
+ public:
+  MOCK_METHOD1(ListenAndMaybeReconstruct, void(const ObjectID &object_id));
+  MOCK_METHOD1(Cancel, void(const ObjectID &object_id));
+};
+
 class TaskDependencyManagerTest : public ::testing::Test {
  public:
   TaskDependencyManagerTest()
-      : object_manager_mock_(), task_dependency_manager_(object_manager_mock_) {}
+      : object_manager_mock_(),
+        reconstruction_policy_mock_(),
+        task_dependency_manager_(object_manager_mock_, reconstruction_policy_mock_,
+                                 RayConfig::instance().prefetch_window_min_tasks(),
+                                 RayConfig::instance().prefetch_window_max_tasks()) {}
 
  protected:
   MockObjectManager object_manager_mock_;
+  MockReconstructionPolicy reconstruction_policy_mock_;
   TaskDependencyManager task_dependency_manager_;
 };
 
@@ -73,7 +90,8 @@ TEST_F(TaskDependencyManagerTest, TestSimpleTask) {
   // No objects have been registered in the task dependency manager, so all
   // arguments should be remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   // Subscribe to the task's dependencies.
   bool ready = task_dependency_manager_.SubscribeDependencies(task_id, arguments);
@@ -82,17 +100,20 @@ TEST_F(TaskDependencyManagerTest, TestSimpleTask) {
   // All arguments should be canceled as they become available locally.
   for (const auto &argument_id : arguments) {
     EXPECT_CALL(object_manager_mock_, Cancel(argument_id));
+    EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id));
   }
   // For each argument except the last, tell the task dependency manager that
   // the argument is local.
   int i = 0;
   for (; i < num_arguments - 1; i++) {
-    auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
     ASSERT_TRUE(ready_task_ids.empty());
   }
   // Tell the task dependency manager that the last argument is local. Now the
   // task should be ready to run.
-  auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+  task_dependency_manager_.HandleObjectLocal(arguments[i]);
+  auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
   ASSERT_EQ(ready_task_ids.size(), 1);
   ASSERT_EQ(ready_task_ids.front(), task_id);
 }
@@ -109,7 +130,8 @@ TEST_F(TaskDependencyManagerTest, TestDuplicateSubscribe) {
     // Subscribe to the task's dependencies. All arguments except the last are
     // duplicates of previous subscription calls. Each argument should only be
     // requested from the node manager once.
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
     bool ready = task_dependency_manager_.SubscribeDependencies(task_id, arguments);
     ASSERT_FALSE(ready);
   }
@@ -117,17 +139,20 @@ TEST_F(TaskDependencyManagerTest, TestDuplicateSubscribe) {
   // All arguments should be canceled as they become available locally.
   for (const auto &argument_id : arguments) {
     EXPECT_CALL(object_manager_mock_, Cancel(argument_id));
+    EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id));
   }
   // For each argument except the last, tell the task dependency manager that
   // the argument is local.
   int i = 0;
   for (; i < num_arguments - 1; i++) {
-    auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
     ASSERT_TRUE(ready_task_ids.empty());
   }
   // Tell the task dependency manager that the last argument is local. Now the
   // task should be ready to run.
-  auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+  task_dependency_manager_.HandleObjectLocal(arguments[i]);
+  auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
   ASSERT_EQ(ready_task_ids.size(), 1);
   ASSERT_EQ(ready_task_ids.front(), task_id);
 }
@@ -139,7 +164,8 @@ TEST_F(TaskDependencyManagerTest, TestMultipleTasks) {
   int num_dependent_tasks = 3;
   // The object should only be requested from the object manager once for all
   // three tasks.
-  EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   for (int i = 0; i < num_dependent_tasks; i++) {
     TaskID task_id = TaskID::from_random();
     dependent_tasks.push_back(task_id);
@@ -150,7 +176,9 @@ TEST_F(TaskDependencyManagerTest, TestMultipleTasks) {
 
   // Tell the task dependency manager that the object is local.
   EXPECT_CALL(object_manager_mock_, Cancel(argument_id));
-  auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(argument_id);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id));
+  task_dependency_manager_.HandleObjectLocal(argument_id);
+  auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
   // Check that all tasks are now ready to run.
   ASSERT_EQ(ready_task_ids.size(), dependent_tasks.size());
   for (const auto &task_id : ready_task_ids) {
@@ -168,8 +196,10 @@ TEST_F(TaskDependencyManagerTest, TestTaskChain) {
   int i = 0;
   // No objects should be remote or canceled since each task depends on a
   // locally queued task.
-  EXPECT_CALL(object_manager_mock_, Pull(_)).Times(0);
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(0);
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(0);
   EXPECT_CALL(object_manager_mock_, Cancel(_)).Times(0);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(_)).Times(0);
   for (const auto &task : tasks) {
     // Subscribe to each of the tasks' arguments.
     auto arguments = task.GetDependencies();
@@ -199,7 +229,8 @@ TEST_F(TaskDependencyManagerTest, TestTaskChain) {
 
     task_dependency_manager_.UnsubscribeDependencies(task_id);
     // Simulate the object notifications for the task's return values.
-    auto ready_tasks = task_dependency_manager_.HandleObjectLocal(return_id);
+    task_dependency_manager_.HandleObjectLocal(return_id);
+    auto ready_tasks = task_dependency_manager_.TakeReadyTasks();
     if (tasks.empty()) {
       // If there are no more tasks, then there should be no more tasks that
       // become ready to run.
@@ -223,7 +254,8 @@ TEST_F(TaskDependencyManagerTest, TestDependentPut) {
 
   // No objects have been registered in the task dependency manager, so the put
   // object should be remote.
-  EXPECT_CALL(object_manager_mock_, Pull(put_id));
+  EXPECT_CALL(object_manager_mock_, Pull(put_id, _));
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(put_id));
   // Subscribe to the task's dependencies.
   bool ready = task_dependency_manager_.SubscribeDependencies(
       task2.GetTaskSpecification().TaskId(), {put_id});
@@ -232,6 +264,7 @@ TEST_F(TaskDependencyManagerTest, TestDependentPut) {
   // The put object should be considered local as soon as the task that creates
   // it is pending execution.
   EXPECT_CALL(object_manager_mock_, Cancel(put_id));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(put_id));
   task_dependency_manager_.TaskPending(task1);
 }
 
@@ -255,13 +288,16 @@ TEST_F(TaskDependencyManagerTest, TestTaskForwarding) {
   task_dependency_manager_.UnsubscribeDependencies(task_id);
   // The object returned by the first task should be considered remote once we
   // cancel the forwarded task, since the second task depends on it.
-  EXPECT_CALL(object_manager_mock_, Pull(return_id));
+  EXPECT_CALL(object_manager_mock_, Pull(return_id, _));
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(return_id));
   task_dependency_manager_.TaskCanceled(task_id);
 
   // Simulate the task executing on a remote node and its return value
   // appearing locally.
   EXPECT_CALL(object_manager_mock_, Cancel(return_id));
-  auto ready_tasks = task_dependency_manager_.HandleObjectLocal(return_id);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(return_id));
+  task_dependency_manager_.HandleObjectLocal(return_id);
+  auto ready_tasks = task_dependency_manager_.TakeReadyTasks();
   // Check that the task that we kept is now ready to run.
   ASSERT_EQ(ready_tasks.size(), 1);
   ASSERT_EQ(ready_tasks.front(), tasks.back().GetTaskSpecification().TaskId());
@@ -278,7 +314,8 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // No objects have been registered in the task dependency manager, so all
   // arguments should be remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   // Subscribe to the task's dependencies.
   bool ready = task_dependency_manager_.SubscribeDependencies(task_id, arguments);
@@ -288,10 +325,11 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // available.
   for (const auto &argument_id : arguments) {
     EXPECT_CALL(object_manager_mock_, Cancel(argument_id));
+    EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id));
   }
   for (size_t i = 0; i < arguments.size(); i++) {
-    std::vector<TaskID> ready_tasks;
-    ready_tasks = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    auto ready_tasks = task_dependency_manager_.TakeReadyTasks();
     if (i == arguments.size() - 1) {
       ASSERT_EQ(ready_tasks.size(), 1);
       ASSERT_EQ(ready_tasks.front(), task_id);
@@ -303,7 +341,8 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // Simulate each of the arguments getting evicted. Each object should now be
   // considered remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   for (size_t i = 0; i < arguments.size(); i++) {
     std::vector<TaskID> waiting_tasks;
@@ -324,10 +363,11 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // again.
   for (const auto &argument_id : arguments) {
     EXPECT_CALL(object_manager_mock_, Cancel(argument_id));
+    EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id));
   }
   for (size_t i = 0; i < arguments.size(); i++) {
-    std::vector<TaskID> ready_tasks;
-    ready_tasks = task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    task_dependency_manager_.HandleObjectLocal(arguments[i]);
+    auto ready_tasks = task_dependency_manager_.TakeReadyTasks();
     if (i == arguments.size() - 1) {
       ASSERT_EQ(ready_tasks.size(), 1);
       ASSERT_EQ(ready_tasks.front(), task_id);
@@ -337,6 +377,240 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   }
 }
 
+TEST_F(TaskDependencyManagerTest, TestReadyBatch) {
+  // Create 2 tasks that depend on the same object, and one that depends on
+  // another object.
+  ObjectID argument_id1 = ObjectID::from_random();
+  ObjectID argument_id2 = ObjectID::from_random();
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 3; i++) {
+    task_ids.push_back(TaskID::from_random());
+  }
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(2);
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(2);
+  EXPECT_CALL(object_manager_mock_, Cancel(_)).Times(2);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(_)).Times(2);
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_ids[0],
+                                                              {argument_id1}));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(
+      task_ids[1], {argument_id1, argument_id2}));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_ids[2],
+                                                              {argument_id2}));
+  ASSERT_FALSE(task_dependency_manager_.HasReadyTasks());
+
+  // Both objects become local before the batch is taken. Each task is
+  // returned once, in the order that it became ready.
+  task_dependency_manager_.HandleObjectLocal(argument_id1);
+  task_dependency_manager_.HandleObjectLocal(argument_id2);
+  ASSERT_TRUE(task_dependency_manager_.HasReadyTasks());
+  auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
+  ASSERT_EQ(ready_task_ids, task_ids);
+  ASSERT_FALSE(task_dependency_manager_.HasReadyTasks());
+  ASSERT_TRUE(task_dependency_manager_.TakeReadyTasks().empty());
+}
+
+TEST_F(TaskDependencyManagerTest, TestReadyBatchFiltering) {
+  ObjectID argument_id = ObjectID::from_random();
+  TaskID task_id1 = TaskID::from_random();
+  TaskID task_id2 = TaskID::from_random();
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id, _)).Times(2);
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id))
+      .Times(2);
+  EXPECT_CALL(object_manager_mock_, Cancel(argument_id)).Times(2);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_id)).Times(2);
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_id1, {argument_id}));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_id2, {argument_id}));
+
+  // The object is evicted again before the batch is taken. The tasks were
+  // never reported as ready, so they are not reported as waiting either.
+  task_dependency_manager_.HandleObjectLocal(argument_id);
+  ASSERT_TRUE(task_dependency_manager_.HandleObjectMissing(argument_id).empty());
+  ASSERT_TRUE(task_dependency_manager_.TakeReadyTasks().empty());
+
+  // A task that is unsubscribed before the batch is taken is dropped from the
+  // batch.
+  task_dependency_manager_.HandleObjectLocal(argument_id);
+  task_dependency_manager_.UnsubscribeDependencies(task_id1);
+  auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
+  ASSERT_EQ(ready_task_ids.size(), 1);
+  ASSERT_EQ(ready_task_ids.front(), task_id2);
+}
+
+TEST_F(TaskDependencyManagerTest, TestPullPriority) {
+  ObjectID argument_id1 = ObjectID::from_random();
+  ObjectID argument_id2 = ObjectID::from_random();
+  TaskID task_id1 = TaskID::from_random();
+  TaskID task_id2 = TaskID::from_random();
+  int64_t priority1;
+  int64_t priority2;
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(2);
+  // Objects needed by an earlier task are pulled with a lower priority value.
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id1, _))
+      .WillOnce(DoAll(SaveArg<1>(&priority1), Return(ray::Status::OK())));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_id1, {argument_id1}));
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id2, _))
+      .WillOnce(DoAll(SaveArg<1>(&priority2), Return(ray::Status::OK())));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_id2, {argument_id2}));
+  ASSERT_LT(priority1, priority2);
+
+  // Once the earlier task also depends on the later task's object, the object
+  // is pulled again with the earlier task's priority.
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id2, priority1));
+  ASSERT_FALSE(task_dependency_manager_.SubscribeDependencies(task_id1, {argument_id2}));
+}
+
+TEST_F(TaskDependencyManagerTest, TestPrefetchWindow) {
+  // A window of 2 to 4 tasks, and 4 tasks that each depend on a remote object.
+  TaskDependencyManager task_dependency_manager(object_manager_mock_,
+                                                reconstruction_policy_mock_, 2, 4);
+  std::vector<TaskID> task_ids;
+  std::vector<ObjectID> argument_ids;
+  for (int i = 0; i < 4; i++) {
+    task_ids.push_back(TaskID::from_random());
+    argument_ids.push_back(ObjectID::from_random());
+  }
+  // Only the objects of the 2 oldest tasks are requested.
+  for (int i = 0; i < 2; i++) {
+    EXPECT_CALL(object_manager_mock_, Pull(argument_ids[i], _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_ids[i]));
+  }
+  for (int i = 0; i < 4; i++) {
+    ASSERT_FALSE(
+        task_dependency_manager.SubscribeDependencies(task_ids[i], {argument_ids[i]}));
+  }
+  auto stats = task_dependency_manager.GetPrefetchStats();
+  ASSERT_EQ(stats.window_size, 2);
+  ASSERT_EQ(stats.num_deferred_tasks, 2);
+  Mock::VerifyAndClearExpectations(&object_manager_mock_);
+  Mock::VerifyAndClearExpectations(&reconstruction_policy_mock_);
+
+  // The first object arrives. Its task leaves the window, and the window grows
+  // by one, so both deferred tasks enter it.
+  EXPECT_CALL(object_manager_mock_, Cancel(argument_ids[0]));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_ids[0]));
+  for (int i = 2; i < 4; i++) {
+    EXPECT_CALL(object_manager_mock_, Pull(argument_ids[i], _));
+    EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_ids[i]));
+  }
+  task_dependency_manager.HandleObjectLocal(argument_ids[0]);
+  ASSERT_EQ(task_dependency_manager.TakeReadyTasks(),
+            std::vector<TaskID>({task_ids[0]}));
+  stats = task_dependency_manager.GetPrefetchStats();
+  ASSERT_EQ(stats.num_hits, 1);
+  ASSERT_EQ(stats.num_misses, 0);
+  ASSERT_EQ(stats.window_size, 3);
+  ASSERT_EQ(stats.num_deferred_tasks, 0);
+  Mock::VerifyAndClearExpectations(&object_manager_mock_);
+  Mock::VerifyAndClearExpectations(&reconstruction_policy_mock_);
+
+  // The second object arrives and is then evicted. The window is halved, and
+  // the second task, which is older than the others, takes the place of the
+  // youngest task in the window.
+  EXPECT_CALL(object_manager_mock_, Cancel(argument_ids[1]));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_ids[1]));
+  task_dependency_manager.HandleObjectLocal(argument_ids[1]);
+  ASSERT_EQ(task_dependency_manager.TakeReadyTasks(),
+            std::vector<TaskID>({task_ids[1]}));
+  ASSERT_EQ(task_dependency_manager.GetPrefetchStats().window_size, 4);
+  Mock::VerifyAndClearExpectations(&object_manager_mock_);
+  Mock::VerifyAndClearExpectations(&reconstruction_policy_mock_);
+  EXPECT_CALL(object_manager_mock_, Pull(argument_ids[1], _));
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_ids[1]));
+  EXPECT_CALL(object_manager_mock_, Cancel(argument_ids[3]));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_ids[3]));
+  ASSERT_EQ(task_dependency_manager.HandleObjectMissing(argument_ids[1]),
+            std::vector<TaskID>({task_ids[1]}));
+  stats = task_dependency_manager.GetPrefetchStats();
+  ASSERT_EQ(stats.num_hits, 2);
+  ASSERT_EQ(stats.num_misses, 1);
+  ASSERT_EQ(stats.window_size, 2);
+  ASSERT_EQ(stats.num_deferred_tasks, 1);
+  Mock::VerifyAndClearExpectations(&object_manager_mock_);
+  Mock::VerifyAndClearExpectations(&reconstruction_policy_mock_);
+
+  // Unsubscribing a task in the window lets the deferred task back in.
+  EXPECT_CALL(object_manager_mock_, Cancel(argument_ids[2]));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(argument_ids[2]));
+  EXPECT_CALL(object_manager_mock_, Pull(argument_ids[3], _));
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_ids[3]));
+  task_dependency_manager.UnsubscribeDependencies(task_ids[2]);
+  ASSERT_EQ(task_dependency_manager.GetPrefetchStats().num_deferred_tasks, 0);
+}
+
+TEST_F(TaskDependencyManagerTest, TestLargeDag) {
+  // Create a DAG of layers of tasks, where each task depends on the return
+  // values of num_arguments tasks in the previous layer, for 1M edges in
+  // total. The first layer has no arguments.
+  const int num_layers = 11;
+  const int layer_size = 1000;
+  const int num_arguments = 100;
+  std::vector<std::vector<Task>> layers;
+  std::vector<ObjectID> arguments;
+  for (int i = 0; i < num_layers; i++) {
+    std::vector<Task> layer;
+    for (int j = 0; j < layer_size; j++) {
+      std::vector<ObjectID> task_arguments;
+      for (size_t k = 0; k < arguments.size(); k += layer_size / num_arguments) {
+        task_arguments.push_back(arguments[(j + k) % arguments.size()]);
+      }
+      layer.push_back(ExampleTask(task_arguments, 1));
+    }
+    arguments.clear();
+    for (const auto &task : layer) {
+      arguments.push_back(task.GetTaskSpecification().ReturnId(0));
+    }
+    layers.push_back(std::move(layer));
+  }
+  // No objects should be remote or canceled since each task depends on a
+  // locally queued task.
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(0);
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(0);
+  EXPECT_CALL(object_manager_mock_, Cancel(_)).Times(0);
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(_)).Times(0);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t num_edges = 0;
+  for (const auto &layer : layers) {
+    for (const auto &task : layer) {
+      auto task_arguments = task.GetDependencies();
+      num_edges += task_arguments.size();
+      bool ready = task_dependency_manager_.SubscribeDependencies(
+          task.GetTaskSpecification().TaskId(), task_arguments);
+      ASSERT_EQ(ready, task_arguments.empty());
+      task_dependency_manager_.TaskPending(task);
+    }
+  }
+  ASSERT_EQ(num_edges, (num_layers - 1) * layer_size * num_arguments);
+
+  // Simulate executing each layer. The whole next layer should become ready in
+  // a single batch once the last task in the layer finishes.
+  for (size_t i = 0; i < layers.size(); i++) {
+    for (const auto &task : layers[i]) {
+      TaskID task_id = task.GetTaskSpecification().TaskId();
+      task_dependency_manager_.UnsubscribeDependencies(task_id);
+      task_dependency_manager_.HandleObjectLocal(task.GetTaskSpecification().ReturnId(0));
+      task_dependency_manager_.TaskCanceled(task_id);
+    }
+    auto ready_task_ids = task_dependency_manager_.TakeReadyTasks();
+    if (i + 1 == layers.size()) {
+      ASSERT_TRUE(ready_task_ids.empty());
+    } else {
+      ASSERT_EQ(ready_task_ids.size(), layer_size);
+      std::unordered_set<TaskID> next_layer;
+      for (const auto &task : layers[i + 1]) {
+        next_layer.insert(task.GetTaskSpecification().TaskId());
+      }
+      for (const auto &task_id : ready_task_ids) {
+        ASSERT_EQ(next_layer.erase(task_id), 1);
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  RAY_LOG(INFO) << "Resolved " << num_edges << " dependencies in "
+                << std::chrono::duration<double, std::milli>(end - start).count()
+                << " ms";
+}
+
 }  // namespace raylet
 
 }  // namespace ray
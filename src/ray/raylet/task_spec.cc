@@ -30,7 +30,24 @@ flatbuffers::Offset<Arg> TaskArgumentByValue::ToFlatbuffer(
 }
 
 void TaskSpecification::AssignSpecification(const uint8_t *spec, size_t spec_size) {
-  spec_.assign(spec, spec + spec_size);
+  auto shared_spec = std::make_shared<SharedSpec>();
+  shared_spec->spec.assign(spec, spec + spec_size);
+
+  auto message = flatbuffers::GetRoot<TaskInfo>(shared_spec->spec.data());
+  shared_spec->task_id = from_flatbuf(*message->task_id());
+  auto args = message->args();
+  shared_spec->arg_id_offsets.reserve(args->size() + 1);
+  for (size_t i = 0; i < args->size(); i++) {
+    shared_spec->arg_id_offsets.push_back(shared_spec->arg_ids.size());
+    for (auto const &object_id : *args->Get(i)->object_ids()) {
+      shared_spec->arg_ids.push_back(from_flatbuf(*object_id));
+    }
+  }
+  shared_spec->arg_id_offsets.push_back(shared_spec->arg_ids.size());
+  shared_spec->return_ids = from_flatbuf(*message->returns());
+  shared_spec->required_resources =
+      ResourceSet(map_from_flatbuf(*message->required_resources()));
+  spec_ = std::move(shared_spec);
 }
 
 TaskSpecification::TaskSpecification(const flatbuffers::String &string) {
@@ -53,7 +70,7 @@ TaskSpecification::TaskSpecification(
     const FunctionID &function_id,
     const std::vector<std::shared_ptr<TaskArgument>> &task_arguments, int64_t num_returns,
     const std::unordered_map<std::string, double> &required_resources)
-    : spec_() {
+    : spec_(nullptr) {
   flatbuffers::FlatBufferBuilder fbb;
 
   // Compute hashes.
@@ -102,17 +119,14 @@ flatbuffers::Offset<flatbuffers::String> TaskSpecification::ToFlatbuffer(
 
 // TODO(atumanov): copy/paste most TaskSpec_* methods from task.h and make them
 // methods of this class.
-const uint8_t *TaskSpecification::data() const { return spec_.data(); }
+const uint8_t *TaskSpecification::data() const { return spec_->spec.data(); }
 
-size_t TaskSpecification::size() const { return spec_.size(); }
+size_t TaskSpecification::size() const { return spec_->spec.size(); }
 
 // Task specification getter methods.
-TaskID TaskSpecification::TaskId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  return from_flatbuf(*message->task_id());
-}
+TaskID TaskSpecification::TaskId() const { return spec_->task_id; }
 UniqueID TaskSpecification::DriverId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return from_flatbuf(*message->driver_id());
 }
 TaskID TaskSpecification::ParentTaskId() const {
@@ -126,18 +140,13 @@ FunctionID TaskSpecification::FunctionId() const {
 }
 
 int64_t TaskSpecification::NumArgs() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  return message->args()->size();
+  return spec_->arg_id_offsets.size() - 1;
 }
 
-int64_t TaskSpecification::NumReturns() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  return message->returns()->size();
-}
+int64_t TaskSpecification::NumReturns() const { return spec_->return_ids.size(); }
 
 ObjectID TaskSpecification::ReturnId(int64_t return_index) const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  return from_flatbuf(*message->returns()->Get(return_index));
+  return spec_->return_ids[return_index];
 }
 
 bool TaskSpecification::ArgByRef(int64_t arg_index) const {
@@ -145,14 +154,11 @@ bool TaskSpecification::ArgByRef(int64_t arg_index) const {
 }
 
 int TaskSpecification::ArgIdCount(int64_t arg_index) const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  auto ids = message->args()->Get(arg_index)->object_ids();
-  return ids->size();
+  return spec_->arg_id_offsets[arg_index + 1] - spec_->arg_id_offsets[arg_index];
 }
 
 ObjectID TaskSpecification::ArgId(int64_t arg_index, int64_t id_index) const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  return from_flatbuf(*message->args()->Get(arg_index)->object_ids()->Get(id_index));
+  return spec_->arg_ids[spec_->arg_id_offsets[arg_index] + id_index];
 }
 const uint8_t *TaskSpecification::ArgVal(int64_t arg_index) const {
   throw std::runtime_error("Method not implemented");
@@ -163,10 +169,8 @@ size_t TaskSpecification::ArgValLength(int64_t arg_index) const {
 double TaskSpecification::GetRequiredResource(const std::string &resource_name) const {
   throw std::runtime_error("Method not implemented");
 }
-const ResourceSet TaskSpecification::GetRequiredResources() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
-  auto required_resources = map_from_flatbuf(*message->required_resources());
-  return ResourceSet(required_resources);
+const ResourceSet &TaskSpecification::GetRequiredResources() const {
+  return spec_->required_resources;
 }
 
 bool TaskSpecification::IsActorCreationTask() const {
@@ -176,27 +180,27 @@ bool TaskSpecification::IsActorCreationTask() const {
 bool TaskSpecification::IsActorTask() const { return !ActorId().is_nil(); }
 
 ActorID TaskSpecification::ActorCreationId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return from_flatbuf(*message->actor_creation_id());
 }
 
 ObjectID TaskSpecification::ActorCreationDummyObjectId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return from_flatbuf(*message->actor_creation_dummy_object_id());
 }
 
 ActorID TaskSpecification::ActorId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return from_flatbuf(*message->actor_id());
 }
 
 ActorHandleID TaskSpecification::ActorHandleId() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return from_flatbuf(*message->actor_handle_id());
 }
 
 int64_t TaskSpecification::ActorCounter() const {
-  auto message = flatbuffers::GetRoot<TaskInfo>(spec_.data());
+  auto message = flatbuffers::GetRoot<TaskInfo>(data());
   return message->actor_counter();
 }
 
@@ -2,6 +2,7 @@
 #define RAY_RAYLET_TASK_SPECIFICATION_H
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -75,6 +76,10 @@ class TaskArgumentByValue : public TaskArgument {
 /// The task specification encapsulates all immutable information about the
 /// task. These fields are determined at submission time, converse to the
 /// TaskExecutionSpecification that may change at execution time.
+///
+/// Since the specification is immutable, copies of a TaskSpecification share
+/// a single reference-counted buffer, and the fields that are read on the
+/// scheduling path are decoded once when the buffer is created.
 class TaskSpecification {
  public:
   /// Deserialize a task specification from a flatbuffer.
@@ -133,7 +138,12 @@ class TaskSpecification {
   const uint8_t *ArgVal(int64_t arg_index) const;
   size_t ArgValLength(int64_t arg_index) const;
   double GetRequiredResource(const std::string &resource_name) const;
-  const ResourceSet GetRequiredResources() const;
+  /// Get the task's resource demands.
+  ///
+  /// \return A reference into the data shared by all copies of this task
+  /// specification. It is only valid while some copy is alive, so callers that
+  /// may drop or move the task they read it from must copy the result.
+  const ResourceSet &GetRequiredResources() const;
 
   // Methods specific to actor tasks.
   bool IsActorCreationTask() const;
@@ -146,15 +156,35 @@ class TaskSpecification {
   ObjectID ActorDummyObject() const;
 
  private:
-  /// Assign the specification data from a pointer.
+  /// The serialized task specification, together with the fields decoded from
+  /// it. This is never modified after construction.
+  struct SharedSpec {
+    /// The task specification data.
+    std::vector<uint8_t> spec;
+    /// The ID of the task.
+    TaskID task_id;
+    /// The object IDs of all arguments passed by reference, in argument order.
+    std::vector<ObjectID> arg_ids;
+    /// For each argument, the index of its first object ID in arg_ids. This
+    /// has one more entry than there are arguments.
+    std::vector<size_t> arg_id_offsets;
+    /// The object IDs of the task's return values.
+    std::vector<ObjectID> return_ids;
+    /// The task's resource demands.
+    ResourceSet required_resources;
+  };
+
+  /// Assign the specification data from a pointer and decode the cached
+  /// fields.
   void AssignSpecification(const uint8_t *spec, size_t spec_size);
   /// Get a pointer to the byte data.
   const uint8_t *data() const;
   /// Get the size in bytes of the task specification.
   size_t size() const;
 
-  /// The task specification data.
-  std::vector<uint8_t> spec_;
+  /// The task specification data, shared between all copies of this task
+  /// specification.
+  std::shared_ptr<const SharedSpec> spec_;
 };
 
 }  // namespace raylet
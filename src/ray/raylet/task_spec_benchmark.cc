@@ -0,0 +1,145 @@
+// Measure the heap allocations and the memory that task specifications cost the
+// raylet as tasks move through it.
+//
+// Usage: task_spec_benchmark [num_tasks]
+//
+// This submits num_tasks tasks (1000000 by default) with no arguments, one return
+// value and a CPU demand, and takes each of them through the steps that copy or read
+// a task in the node manager: adding it to the lineage, queueing it as waiting,
+// moving it to the ready queue, and reading its resource demand as the scheduling
+// policy does. It reports the heap allocations per task for each step, and the
+// growth in resident memory once all of the tasks are queued and in the lineage.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/raylet/lineage_cache.h"
+#include "ray/raylet/scheduling_queue.h"
+
+namespace {
+
+std::atomic<size_t> num_allocations(0);
+
+}  // namespace
+
+void *operator new(size_t size) {
+  num_allocations++;
+  void *ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+/// Return the resident set size of this process in bytes.
+size_t ResidentBytes() {
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+  if (fscanf(statm, "%zu %zu", &total_pages, &resident_pages) != 2) {
+    resident_pages = 0;
+  }
+  fclose(statm);
+  return resident_pages * sysconf(_SC_PAGESIZE);
+}
+
+/// Reports the heap allocations per task made by each step.
+class AllocationCounter {
+ public:
+  explicit AllocationCounter(size_t num_tasks)
+      : num_tasks_(num_tasks), last_(num_allocations) {}
+
+  /// Print the allocations per task since the last step.
+  void Report(const char *step) {
+    size_t current = num_allocations;
+    printf("%-24s %12.2f\n", step, static_cast<double>(current - last_) / num_tasks_);
+    last_ = current;
+  }
+
+ private:
+  const size_t num_tasks_;
+  size_t last_;
+};
+
+}  // namespace
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  using namespace ray::raylet;
+  size_t num_tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const std::unordered_map<std::string, double> required_resources = {{"CPU", 1}};
+  const std::vector<std::shared_ptr<TaskArgument>> task_arguments;
+  const ray::UniqueID driver_id = ray::UniqueID::from_random();
+  const ray::FunctionID function_id = ray::FunctionID::from_random();
+  Lineage lineage;
+  SchedulingQueue queue;
+  size_t start_bytes = ResidentBytes();
+  printf("%-24s %12s\n", "step", "allocs/task");
+  AllocationCounter counter(num_tasks);
+
+  std::vector<Task> tasks;
+  tasks.reserve(num_tasks);
+  for (size_t i = 0; i < num_tasks; i++) {
+    TaskSpecification spec(driver_id, ray::TaskID::nil(), i, function_id, task_arguments,
+                           1, required_resources);
+    tasks.push_back(Task(TaskExecutionSpecification(std::vector<ray::ObjectID>()), spec));
+  }
+  counter.Report("submit");
+
+  for (const auto &task : tasks) {
+    lineage.SetEntry(LineageEntry(task, GcsStatus_UNCOMMITTED_WAITING));
+  }
+  counter.Report("add to lineage");
+
+  std::vector<ray::TaskID> task_ids;
+  task_ids.reserve(num_tasks);
+  for (const auto &task : tasks) {
+    task_ids.push_back(task.GetTaskSpecification().TaskId());
+  }
+
+  queue.QueueWaitingTasks(tasks);
+  tasks = std::vector<Task>();
+  counter.Report("queue as waiting");
+
+  queue.QueueReadyTasks(queue.RemoveTasks(task_ids));
+  counter.Report("move to ready");
+
+  double total_cpus = 0;
+  for (const auto &task : queue.GetReadyTasks()) {
+    const auto &resource_demand = task.GetTaskSpecification().GetRequiredResources();
+    double cpus = 0;
+    resource_demand.GetResource("CPU", &cpus);
+    total_cpus += cpus;
+  }
+  counter.Report("read resource demand");
+  if (static_cast<size_t>(total_cpus) != num_tasks) {
+    return 1;
+  }
+
+  size_t queued_bytes = ResidentBytes() - start_bytes;
+  printf("resident memory with %zu tasks queued: %.1f MiB (%.0f bytes/task)\n",
+         num_tasks, queued_bytes / 1048576.0,
+         static_cast<double>(queued_bytes) / num_tasks);
+  return 0;
+}
@@ -2,6 +2,8 @@
 
 #include "ray/raylet/task_spec.h"
 
+#include "common_protocol.h"
+
 namespace ray {
 
 namespace raylet {
@@ -35,6 +37,43 @@ TEST(TaskSpecTest, TestTaskReturnIds) {
   TestTaskPutId(task_id, kMaxTaskPuts);
 }
 
+TEST(TaskSpecTest, TestDecodedFields) {
+  std::vector<ObjectID> first_arg = {ObjectID::from_random(), ObjectID::from_random()};
+  std::vector<ObjectID> third_arg = {ObjectID::from_random()};
+  std::string value = "value";
+  std::vector<std::shared_ptr<TaskArgument>> arguments = {
+      std::make_shared<TaskArgumentByReference>(first_arg),
+      std::make_shared<TaskArgumentByValue>(
+          reinterpret_cast<const uint8_t *>(value.data()), value.size()),
+      std::make_shared<TaskArgumentByReference>(third_arg)};
+  std::unordered_map<std::string, double> required_resources = {{"CPU", 2}};
+  TaskSpecification spec(UniqueID::from_random(), TaskID::from_random(), 0,
+                         FunctionID::from_random(), arguments, 3, required_resources);
+
+  // The fields must survive serialization, and copies must agree with the
+  // original.
+  flatbuffers::FlatBufferBuilder fbb;
+  fbb.Finish(spec.ToFlatbuffer(fbb));
+  auto serialized = flatbuffers::GetRoot<flatbuffers::String>(fbb.GetBufferPointer());
+  TaskSpecification deserialized(*serialized);
+  TaskSpecification copy = deserialized;
+  for (const TaskSpecification *s : {&spec, &deserialized, &copy}) {
+    ASSERT_EQ(s->TaskId(), spec.TaskId());
+    ASSERT_EQ(s->NumArgs(), 3);
+    ASSERT_EQ(s->ArgIdCount(0), 2);
+    ASSERT_FALSE(s->ArgByRef(1));
+    ASSERT_EQ(s->ArgIdCount(2), 1);
+    ASSERT_EQ(s->ArgId(0, 0), first_arg[0]);
+    ASSERT_EQ(s->ArgId(0, 1), first_arg[1]);
+    ASSERT_EQ(s->ArgId(2, 0), third_arg[0]);
+    ASSERT_EQ(s->NumReturns(), 3);
+    for (int64_t i = 0; i < 3; i++) {
+      ASSERT_EQ(s->ReturnId(i), ComputeReturnId(spec.TaskId(), i + 1));
+    }
+    ASSERT_TRUE(s->GetRequiredResources() == ResourceSet(required_resources));
+  }
+}
+
 }  // namespace raylet
 
 }  // namespace ray
@@ -45,6 +45,10 @@ sleep 1s
 $CORE_DIR/src/ray/object_manager/object_manager_stress_test $STORE_EXEC
 sleep 1s
 $CORE_DIR/src/ray/object_manager/object_manager_test $STORE_EXEC
+sleep 1s
+$CORE_DIR/src/ray/object_manager/object_manager_fault_test $STORE_EXEC
+sleep 1s
+$CORE_DIR/src/ray/object_manager/object_buffer_pool_test $STORE_EXEC
 $REDIS_DIR/redis-cli -p 6379 shutdown
 sleep 1s
 
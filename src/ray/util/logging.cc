@@ -0,0 +1,176 @@
+#include "ray/util/logging.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ray {
+
+namespace {
+
+// How often the background thread writes out buffered log lines.
+constexpr std::chrono::milliseconds kLogFlushInterval(10);
+// Once a thread has buffered this many bytes, the background thread is woken
+// up to write them.
+constexpr size_t kLogBufferWakeBytes = 64 * 1024;
+// Once a thread has buffered this many bytes, it writes them itself instead
+// of waiting for the background thread.
+constexpr size_t kLogBufferMaxBytes = 4 * 1024 * 1024;
+
+// Parse a log level name from the environment.
+int LogLevelFromEnv() {
+  const char *name = std::getenv("RAY_BACKEND_LOG_LEVEL");
+  if (name == nullptr) {
+    return RAY_INFO;
+  }
+  std::string level(name);
+  std::transform(level.begin(), level.end(), level.begin(), ::tolower);
+  if (level == "debug") {
+    return RAY_DEBUG;
+  } else if (level == "warning") {
+    return RAY_WARNING;
+  } else if (level == "error") {
+    return RAY_ERROR;
+  } else if (level == "fatal") {
+    return RAY_FATAL;
+  }
+  return RAY_INFO;
+}
+
+void WriteToStderr(const std::string &lines) {
+  if (!lines.empty()) {
+    fwrite(lines.data(), 1, lines.size(), stderr);
+    fflush(stderr);
+  }
+}
+
+// The log lines that one thread has written since the last flush.
+struct ThreadLogBuffer {
+  std::mutex mutex;
+  std::string lines;
+};
+
+// Writes the lines buffered by each thread to stderr.
+class AsyncLogWriter {
+ public:
+  AsyncLogWriter() : thread_([this]() { Run(); }) { thread_.detach(); }
+
+  // Append a line to the calling thread's buffer.
+  void Append(const std::string &line) {
+    thread_local std::shared_ptr<ThreadLogBuffer> buffer;
+    if (buffer == nullptr) {
+      buffer = std::make_shared<ThreadLogBuffer>();
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.push_back(buffer);
+    }
+    std::string overflow;
+    size_t buffered_bytes;
+    {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      buffer->lines.append(line);
+      buffered_bytes = buffer->lines.size();
+      if (buffered_bytes >= kLogBufferMaxBytes) {
+        overflow.swap(buffer->lines);
+      }
+    }
+    if (!overflow.empty()) {
+      // The background thread is falling behind, so slow this thread down.
+      std::lock_guard<std::mutex> lock(mutex_);
+      WriteToStderr(overflow);
+    } else if (buffered_bytes >= kLogBufferWakeBytes) {
+      wake_.notify_one();
+    }
+  }
+
+  // Write out every thread's buffered lines, followed by the given line.
+  void Flush(const std::string &last_line = "") {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string lines;
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+      {
+        std::lock_guard<std::mutex> buffer_lock((*it)->mutex);
+        lines.swap((*it)->lines);
+      }
+      WriteToStderr(lines);
+      lines.clear();
+      if (it->use_count() == 1) {
+        // The thread has exited and its last lines were just written.
+        it = buffers_.erase(it);
+      } else {
+        it++;
+      }
+    }
+    WriteToStderr(last_line);
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (true) {
+      wake_.wait_for(lock, kLogFlushInterval);
+      Flush();
+    }
+  }
+
+  // Protects buffers_ and serializes writes to stderr.
+  std::mutex mutex_;
+  // The buffer of each thread that has logged.
+  std::vector<std::shared_ptr<ThreadLogBuffer>> buffers_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+};
+
+// The async writer, once started. It is never destroyed, so that threads can
+// still log while the process exits.
+std::atomic<AsyncLogWriter *> async_writer(nullptr);
+
+void FlushAtExit() { FlushLogs(); }
+
+}  // namespace
+
+namespace internal {
+
+// Until this is initialized, it is zero, which is RAY_INFO.
+std::atomic<int> log_threshold(LogLevelFromEnv());
+
+void WriteLogLine(int severity, const std::string &line) {
+  AsyncLogWriter *writer = async_writer.load();
+  if (writer == nullptr) {
+    WriteToStderr(line);
+  } else if (severity == RAY_FATAL) {
+    // The process is about to abort, so write everything out now.
+    writer->Flush(line);
+  } else {
+    writer->Append(line);
+  }
+}
+
+}  // namespace internal
+
+void SetLogLevel(int level) {
+  internal::log_threshold.store(std::min(level, RAY_FATAL));
+}
+
+void StartAsyncLogging() {
+  static std::once_flag started;
+  std::call_once(started, []() {
+    async_writer.store(new AsyncLogWriter());
+    std::atexit(FlushAtExit);
+  });
+}
+
+void FlushLogs() {
+  AsyncLogWriter *writer = async_writer.load();
+  if (writer != nullptr) {
+    writer->Flush();
+  }
+}
+
+}  // namespace ray
@@ -5,8 +5,11 @@
 #include <execinfo.h>
 #endif
 
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 #include "ray/util/macros.h"
 
@@ -17,7 +20,7 @@ namespace ray {
 //
 // Add more as needed.
 
-// Log levels. LOG ignores them, so their values are abitrary.
+// Log levels, from least to most severe.
 
 #define RAY_DEBUG (-1)
 #define RAY_INFO 0
@@ -25,14 +28,35 @@ namespace ray {
 #define RAY_ERROR 2
 #define RAY_FATAL 3
 
+// Log statements below this level are compiled out. Build with, for example,
+// -DRAY_LOG_MIN_LEVEL=RAY_INFO to strip all debug logging.
+#ifndef RAY_LOG_MIN_LEVEL
+#define RAY_LOG_MIN_LEVEL RAY_DEBUG
+#endif
+
+#if RAY_LOG_MIN_LEVEL > RAY_FATAL
+#error "RAY_LOG_MIN_LEVEL must not compile out fatal log statements."
+#endif
+
+// Whether a log statement at this level is written. Besides guarding RAY_LOG,
+// this can guard code that only exists to build a log message.
+#define RAY_LOG_ENABLED(level) \
+  (RAY_##level >= RAY_LOG_MIN_LEVEL && ::ray::internal::IsLevelEnabled(RAY_##level))
+
 #define RAY_LOG_INTERNAL(level) \
   ::ray::internal::CerrLog(level) << __FILE__ << ":" << __LINE__ << ": "
 
-#define RAY_LOG(level) RAY_LOG_INTERNAL(RAY_##level)
+// The operands of a disabled log statement are not evaluated.
+#define RAY_LOG(level)              \
+  !RAY_LOG_ENABLED(level) ? (void)0 \
+                          : ::ray::internal::Voidify() & RAY_LOG_INTERNAL(RAY_##level)
+
 #define RAY_IGNORE_EXPR(expr) ((void) (expr));
 
 #define RAY_CHECK(condition)                             \
-  (condition) ? 0 : ::ray::internal::FatalLog(RAY_FATAL) \
+  (condition) ? (void)0                                  \
+              : ::ray::internal::Voidify() &             \
+                    ::ray::internal::FatalLog(RAY_FATAL) \
                         << __FILE__ << ":" << __LINE__   \
                         << " Check failed: " #condition " "
 
@@ -48,8 +72,35 @@ namespace ray {
 
 #endif  // NDEBUG
 
+// Set the least severe level that is logged. This is RAY_INFO by default, or
+// the level named by the RAY_BACKEND_LOG_LEVEL environment variable ("debug",
+// "info", "warning", "error" or "fatal"). Levels below RAY_LOG_MIN_LEVEL stay
+// compiled out.
+void SetLogLevel(int level);
+
+// Write log lines from a background thread. After this is called, each thread
+// appends its lines to its own buffer, which the background thread writes to
+// stderr every few milliseconds. Lines from one thread stay in order. Fatal
+// lines are still written synchronously, after everything buffered so far.
+// Buffered lines are written at exit, but lost if the process is killed.
+void StartAsyncLogging();
+
+// Write all buffered log lines to stderr.
+void FlushLogs();
+
 namespace internal {
 
+// The least severe level that is logged.
+extern std::atomic<int> log_threshold;
+
+inline bool IsLevelEnabled(int level) {
+  return level >= log_threshold.load(std::memory_order_relaxed);
+}
+
+// Write a complete log line, either directly to stderr or through the
+// calling thread's buffer.
+void WriteLogLine(int severity, const std::string &line);
+
 class NullLog {
  public:
   template <class T>
@@ -63,11 +114,12 @@ class CerrLog {
  public:
   CerrLog(int severity)  // NOLINT(runtime/explicit)
       : severity_(severity),
-        has_logged_(false) {}
+        has_logged_(false),
+        stream_() {}
 
   virtual ~CerrLog() {
     if (has_logged_) {
-      std::cerr << std::endl;
+      Flush();
     }
     // This code is duplicated in the FatalLog class.
     if (severity_ == RAY_FATAL) {
@@ -82,16 +134,21 @@ class CerrLog {
 
   template <class T>
   CerrLog &operator<<(const T &t) {
-    if (severity_ != RAY_DEBUG) {
-      has_logged_ = true;
-      std::cerr << t;
-    }
+    has_logged_ = true;
+    stream_ << t;
     return *this;
   }
 
  protected:
+  // Write out the message as a single line.
+  void Flush() {
+    stream_ << '\n';
+    WriteLogLine(severity_, stream_.str());
+  }
+
   const int severity_;
   bool has_logged_;
+  std::ostringstream stream_;
 };
 
 // Clang-tidy isn't smart enough to determine that DCHECK using CerrLog doesn't
@@ -103,7 +160,7 @@ class FatalLog : public CerrLog {
 
   RAY_NORETURN ~FatalLog() {
     if (has_logged_) {
-      std::cerr << std::endl;
+      Flush();
 #if defined(_EXECINFO_H) || !defined(_WIN32)
       void *buffer[255];
       const int calls = backtrace(buffer, sizeof(buffer) / sizeof(void *));
@@ -114,6 +171,14 @@ class FatalLog : public CerrLog {
   }
 };
 
+// Turns the stream expression of RAY_LOG or RAY_CHECK into void, so that it
+// can be the other branch of the conditional that skips it. The & operator
+// binds more loosely than << and more tightly than ?:.
+class Voidify {
+ public:
+  void operator&(CerrLog &) {}
+};
+
 }  // namespace internal
 
 }  // namespace ray
@@ -2,7 +2,10 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
 import pytest
+import time
+
 import ray
 
 test_values = [1, 1.0, "test", b"test", (0, 1), [0, 1], {0: 1}]
@@ -73,3 +76,77 @@ def test_actor_api(ray_start):
     x = 1
     f = Foo.remote(x)
     assert (ray.get(f.get.remote()) == x)
+
+
+@pytest.fixture
+def ray_start_custom_resource():
+    # Start the Ray processes with one unit of a custom resource, so that only
+    # one task that requires it can run at a time.
+    ray.init(num_cpus=2, resources={"Custom": 1}, use_raylet=True)
+    yield None
+    # The code after the yield will run as teardown code.
+    ray.worker.cleanup()
+
+
+def test_worker_killed_with_prefetched_task(ray_start_custom_resource):
+    class ExitWhenStored(object):
+        pass
+
+    def exit_when_stored(obj):
+        # The worker asks for its next task before it stores the outputs of
+        # the current one. Give the local scheduler time to send the next task
+        # ahead, then kill the worker before it starts that task.
+        time.sleep(1)
+        os._exit(0)
+
+    ray.register_custom_serializer(
+        ExitWhenStored,
+        serializer=exit_when_stored,
+        deserializer=lambda serialized_obj: ExitWhenStored())
+
+    @ray.remote(resources={"Custom": 1})
+    def exit_after_returning():
+        return ExitWhenStored()
+
+    @ray.remote(resources={"Custom": 1})
+    def f():
+        return 1
+
+    exit_after_returning.remote()
+    # This task waits for the first task's resources, so it is sent ahead to
+    # the first task's worker. It should run on another worker once that
+    # worker dies.
+    x_id = f.remote()
+    ready_ids, _ = ray.wait([x_id], timeout=30000)
+    assert ready_ids == [x_id]
+    assert ray.get(x_id) == 1
+
+
+def test_forked_actor_handle_order(ray_start_custom_resource):
+    @ray.remote
+    class Log(object):
+        def __init__(self):
+            self.entries = []
+
+        def append(self, entry):
+            self.entries.append(entry)
+
+        def get(self):
+            return self.entries
+
+    @ray.remote
+    def slow_value():
+        time.sleep(1)
+        return "parent"
+
+    @ray.remote
+    def append_from_fork(log):
+        ray.get(log.append.remote("fork"))
+
+    log = Log.remote()
+    # The parent handle's task waits for its argument, while the forked
+    # handle's first task could run right away. It must still run after the
+    # tasks that the parent handle submitted before the fork.
+    log.append.remote(slow_value.remote())
+    ray.get(append_from_fork.remote(log))
+    assert ray.get(log.get.remote()) == ["parent", "fork"]